@@ -0,0 +1,705 @@
+#include "spdk/stdinc.h"
+#include "spdk/bdev.h"
+#include "spdk/env.h"
+#include "spdk/event.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+
+#include "ourdemo_client.h"
+
+/*
+ * End to end benchmark of the ourdemo storage path, in the spirit of
+ * ucx_perftest. Every job keeps 'queue_depth' I/Os in flight against either
+ * the remote server (one ourdemo client and one thread per job) or, with -L,
+ * the same bdev opened locally (one spdk_thread per job), so the two results
+ * show what the network layer costs.
+ */
+
+#define DEFAULT_RUN_TIME       5
+#define DEFAULT_IO_SIZE        4096
+#define DEFAULT_READ_PCT       50
+#define IO_BUF_ALIGN           0x1000
+#define MAX_SERVER_ADDRS       8
+
+typedef struct bench_job bench_job_t;
+
+typedef struct bench_io {
+    bench_job_t     *job;
+    void            *buf;
+    uint64_t        start_ns;
+    int             is_read;
+    struct bench_io *next_free;
+    struct spdk_bdev_io_wait_entry bdev_io_wait;
+} bench_io_t;
+
+struct bench_job {
+    unsigned                index;
+    pthread_t               pthread;
+    struct spdk_thread      *thread;
+    struct spdk_io_channel  *ch;
+    struct spdk_poller      *poller;
+    ourdemo_client_t        *client;
+    ourdemo_mem_t           *mem;
+    char                    *bufs;
+    bench_io_t              *ios;
+    bench_io_t              *free_ios;
+    unsigned                outstanding;
+    unsigned                seed;
+    uint64_t                next_seq;
+    uint64_t                num_slots;
+    uint64_t                end_ns;
+    uint64_t                next_submit_ns;
+    int                     stopping;
+    int                     error;
+
+    /* Results */
+    uint64_t                reads;
+    uint64_t                writes;
+    uint64_t                *lat_ns;
+    size_t                  num_lat;
+    size_t                  lat_cap;
+};
+
+static struct {
+    const char              *server_addrs[MAX_SERVER_ADDRS];
+    unsigned                num_server_addrs;
+    uint16_t                port;
+    const char              *bdev_name;
+    int                     local;
+    unsigned                num_jobs;
+    unsigned                queue_depth;
+    unsigned                batch_max;
+    long                    rma_thresh;
+    unsigned                num_lanes;
+    uint32_t                stripe_size;
+    uint32_t                io_size;
+    unsigned                read_pct;
+    int                     sequential;
+    unsigned                run_time;
+    uint64_t                think_ns;
+} g_opts = {
+    .port        = OURDEMO_DEFAULT_PORT,
+    .bdev_name   = "Malloc0",
+    .num_jobs    = 1,
+    .queue_depth = OURDEMO_CLIENT_DEFAULT_QD,
+    .num_lanes   = 1,
+    .stripe_size = OURDEMO_CLIENT_DEFAULT_STRIPE,
+    .batch_max   = OURDEMO_CLIENT_DEFAULT_BATCH,
+    .rma_thresh  = OURDEMO_CLIENT_DEFAULT_RMA_THRESH,
+    .io_size     = DEFAULT_IO_SIZE,
+    .read_pct    = DEFAULT_READ_PCT,
+    .run_time    = DEFAULT_RUN_TIME
+};
+
+static bench_job_t           *g_jobs;
+static uint64_t              g_start_ns;
+static uint64_t              g_end_ns;
+
+/* Local mode */
+static struct spdk_thread    *g_main_thread;
+static struct spdk_bdev_desc *g_desc;
+static struct spdk_bdev      *g_bdev;
+static unsigned              g_jobs_running;
+static int                   g_rc;
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int job_init(bench_job_t *job, uint32_t block_size, uint64_t num_blocks)
+{
+    unsigned i;
+
+    job->num_slots = num_blocks * block_size / g_opts.io_size;
+    if ((g_opts.io_size % block_size) || (job->num_slots == 0)) {
+        fprintf(stderr, "I/O size %u does not fit the device\n", g_opts.io_size);
+        return -EINVAL;
+    }
+
+    job->seed     = job->index + 1;
+    job->next_seq = job->index * (job->num_slots / g_opts.num_jobs);
+    job->ios      = calloc(g_opts.queue_depth, sizeof(*job->ios));
+    job->lat_cap  = 1 << 16;
+    job->lat_ns   = malloc(job->lat_cap * sizeof(*job->lat_ns));
+    if ((job->ios == NULL) || (job->lat_ns == NULL)) {
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < g_opts.queue_depth; i++) {
+        job->ios[i].job       = job;
+        job->ios[i].buf       = job->bufs + (size_t)i * g_opts.io_size;
+        job->ios[i].next_free = job->free_ios;
+        job->free_ios         = &job->ios[i];
+    }
+    return 0;
+}
+
+static void job_fini(bench_job_t *job)
+{
+    free(job->ios);
+    job->ios = NULL;
+}
+
+/**
+ * Pick the next operation and offset of 'io' according to the workload.
+ */
+static uint64_t job_next_offset(bench_job_t *job, bench_io_t *io)
+{
+    uint64_t slot;
+
+    io->is_read = (rand_r(&job->seed) % 100) < g_opts.read_pct;
+    if (g_opts.sequential) {
+        slot = job->next_seq++ % job->num_slots;
+    } else {
+        slot = (((uint64_t)rand_r(&job->seed) << 31) ^ rand_r(&job->seed)) %
+               job->num_slots;
+    }
+    return slot * g_opts.io_size;
+}
+
+static void job_record(bench_job_t *job, bench_io_t *io, int status)
+{
+    uint64_t now = get_time_ns();
+    uint64_t *lat;
+
+    job->outstanding--;
+    if (status != 0) {
+        fprintf(stderr, "job %u: I/O failed (%d)\n", job->index, status);
+        job->error    = status;
+        job->stopping = 1;
+    } else {
+        if (io->is_read) {
+            job->reads++;
+        } else {
+            job->writes++;
+        }
+
+        if (job->num_lat == job->lat_cap) {
+            lat = realloc(job->lat_ns, 2 * job->lat_cap * sizeof(*lat));
+            if (lat != NULL) {
+                job->lat_ns   = lat;
+                job->lat_cap *= 2;
+            }
+        }
+        if (job->num_lat < job->lat_cap) {
+            job->lat_ns[job->num_lat++] = now - io->start_ns;
+        }
+    }
+
+    if (now >= job->end_ns) {
+        job->stopping = 1;
+    }
+}
+
+/*
+ * Remote jobs
+ */
+
+static void remote_io_done(void *arg, int status)
+{
+    bench_io_t  *io  = arg;
+    bench_job_t *job = io->job;
+
+    job_record(job, io, status);
+    io->next_free = job->free_ios;
+    job->free_ios = io;
+    if (g_opts.think_ns) {
+        job->next_submit_ns = get_time_ns() + g_opts.think_ns;
+    }
+}
+
+static void *remote_job_run(void *arg)
+{
+    bench_job_t             *job = arg;
+    ourdemo_client_params_t params;
+    const ourdemo_info_t    *info;
+    size_t                  buf_size = (size_t)g_opts.queue_depth * g_opts.io_size;
+    bench_io_t              *io;
+    uint64_t                offset;
+    int                     ret;
+
+    ourdemo_client_params_init(&params);
+    params.server_addr      = g_opts.server_addrs[0];
+    params.server_addrs     = g_opts.server_addrs;
+    params.num_server_addrs = g_opts.num_server_addrs;
+    params.port             = g_opts.port;
+    params.queue_depth      = g_opts.queue_depth;
+    params.batch_max        = g_opts.batch_max;
+    params.rma_thresh       = g_opts.rma_thresh;
+    params.num_lanes        = g_opts.num_lanes;
+    params.stripe_size      = g_opts.stripe_size;
+
+    ret = ourdemo_client_create(&params, &job->client);
+    if (ret != 0) {
+        job->error = ret;
+        return NULL;
+    }
+    info = ourdemo_client_get_info(job->client);
+
+    job->bufs = malloc(buf_size);
+    if (job->bufs == NULL) {
+        job->error = -ENOMEM;
+        goto out_destroy;
+    }
+    memset(job->bufs, 0x5a, buf_size);
+
+    ret = job_init(job, info->block_size, info->num_blocks);
+    if (ret == 0) {
+        ret = ourdemo_client_mem_reg(job->client, job->bufs, buf_size, &job->mem);
+    }
+    if (ret != 0) {
+        job->error = ret;
+        goto out_free;
+    }
+
+    /* All jobs run for the same wall clock window */
+    job->end_ns = g_end_ns;
+    while (!job->stopping || job->outstanding) {
+        while (!job->stopping && (job->free_ios != NULL)) {
+            if (g_opts.think_ns && (get_time_ns() < job->next_submit_ns)) {
+                break;
+            }
+            io             = job->free_ios;
+            offset         = job_next_offset(job, io);
+            io->start_ns   = get_time_ns();
+            if (io->is_read) {
+                ret = ourdemo_client_read(job->client, io->buf, offset,
+                                          g_opts.io_size, remote_io_done, io);
+            } else {
+                ret = ourdemo_client_write(job->client, io->buf, offset,
+                                           g_opts.io_size, remote_io_done, io);
+            }
+            if (ret == -EAGAIN) {
+                break;
+            } else if (ret != 0) {
+                fprintf(stderr, "job %u: submit failed (%d)\n", job->index, ret);
+                job->error    = ret;
+                job->stopping = 1;
+                break;
+            }
+            job->free_ios = io->next_free;
+            job->outstanding++;
+        }
+        ourdemo_client_progress(job->client);
+        if (get_time_ns() >= job->end_ns) {
+            job->stopping = 1;
+        }
+    }
+
+    ourdemo_client_mem_dereg(job->client, job->mem);
+out_free:
+    job_fini(job);
+    free(job->bufs);
+out_destroy:
+    ourdemo_client_destroy(job->client);
+    return NULL;
+}
+
+/*
+ * Local jobs, the same workload straight on the bdev
+ */
+
+static void local_io_submit(void *arg);
+
+static void local_io_done(struct spdk_bdev_io *bdev_io, bool success, void *arg)
+{
+    bench_io_t  *io  = arg;
+    bench_job_t *job = io->job;
+
+    spdk_bdev_free_io(bdev_io);
+    job_record(job, io, success ? 0 : -EIO);
+    if (!job->stopping) {
+        local_io_submit(io);
+    }
+}
+
+static void local_io_submit(void *arg)
+{
+    bench_io_t  *io  = arg;
+    bench_job_t *job = io->job;
+    uint64_t    offset;
+    int         rc;
+
+    offset       = job_next_offset(job, io);
+    io->start_ns = get_time_ns();
+    if (io->is_read) {
+        rc = spdk_bdev_read(g_desc, job->ch, io->buf, offset, g_opts.io_size,
+                            local_io_done, io);
+    } else {
+        rc = spdk_bdev_write(g_desc, job->ch, io->buf, offset, g_opts.io_size,
+                             local_io_done, io);
+    }
+
+    if (rc == -ENOMEM) {
+        io->bdev_io_wait.bdev   = g_bdev;
+        io->bdev_io_wait.cb_fn  = local_io_submit;
+        io->bdev_io_wait.cb_arg = io;
+        spdk_bdev_queue_io_wait(g_bdev, job->ch, &io->bdev_io_wait);
+        job->outstanding++;
+    } else if (rc != 0) {
+        fprintf(stderr, "job %u: submit failed (%s)\n", job->index, spdk_strerror(-rc));
+        job->error    = rc;
+        job->stopping = 1;
+    } else {
+        job->outstanding++;
+    }
+}
+
+static void bench_report(void);
+
+static void local_job_done(void *arg)
+{
+    if (--g_jobs_running > 0) {
+        return;
+    }
+
+    g_end_ns = get_time_ns();
+    bench_report();
+    spdk_bdev_close(g_desc);
+    spdk_app_stop(g_rc);
+}
+
+static int local_job_poll(void *arg)
+{
+    bench_job_t *job = arg;
+
+    if (get_time_ns() >= job->end_ns) {
+        job->stopping = 1;
+    }
+    if (!job->stopping || job->outstanding) {
+        return SPDK_POLLER_IDLE;
+    }
+
+    if (job->error) {
+        g_rc = -1;
+    }
+    spdk_poller_unregister(&job->poller);
+    spdk_put_io_channel(job->ch);
+    job_fini(job);
+    spdk_dma_free(job->bufs);
+    spdk_thread_send_msg(g_main_thread, local_job_done, NULL);
+    spdk_thread_exit(spdk_get_thread());
+    return SPDK_POLLER_BUSY;
+}
+
+static void local_job_start(void *arg)
+{
+    bench_job_t *job = arg;
+    unsigned    i;
+
+    job->end_ns = g_end_ns;
+    job->bufs   = spdk_dma_zmalloc((size_t)g_opts.queue_depth * g_opts.io_size,
+                                   IO_BUF_ALIGN, NULL);
+    job->ch     = spdk_bdev_get_io_channel(g_desc);
+    if ((job->bufs == NULL) || (job->ch == NULL) ||
+        (job_init(job, spdk_bdev_get_block_size(g_bdev),
+                  spdk_bdev_get_num_blocks(g_bdev)) != 0)) {
+        fprintf(stderr, "job %u: failed to start\n", job->index);
+        spdk_app_stop(-1);
+        return;
+    }
+
+    for (i = 0; i < g_opts.queue_depth; i++) {
+        local_io_submit(&job->ios[i]);
+    }
+
+    /* Reaped from a poller so the job can exit once its I/Os drained */
+    job->poller = spdk_poller_register(local_job_poll, job, 1000);
+}
+
+static void local_bdev_event_cb(enum spdk_bdev_event_type type,
+                                struct spdk_bdev *bdev, void *ctx)
+{
+}
+
+static void local_start(void *arg)
+{
+    char     name[32];
+    unsigned i;
+    int      rc;
+
+    g_main_thread = spdk_get_thread();
+    rc = spdk_bdev_open_ext(g_opts.bdev_name, true, local_bdev_event_cb, NULL,
+                            &g_desc);
+    if (rc != 0) {
+        fprintf(stderr, "could not open bdev %s (%s)\n", g_opts.bdev_name,
+                spdk_strerror(-rc));
+        spdk_app_stop(-1);
+        return;
+    }
+    g_bdev = spdk_bdev_desc_get_bdev(g_desc);
+
+    g_start_ns     = get_time_ns();
+    g_end_ns       = g_start_ns + g_opts.run_time * 1000000000ull;
+    g_jobs_running = g_opts.num_jobs;
+    for (i = 0; i < g_opts.num_jobs; i++) {
+        snprintf(name, sizeof(name), "bench_job_%u", i);
+        g_jobs[i].thread = spdk_thread_create(name, NULL);
+        if (g_jobs[i].thread == NULL) {
+            spdk_app_stop(-1);
+            return;
+        }
+        spdk_thread_send_msg(g_jobs[i].thread, local_job_start, &g_jobs[i]);
+    }
+}
+
+/*
+ * Reporting
+ */
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const uint64_t *lat, size_t n, double pct)
+{
+    size_t idx;
+
+    if (n == 0) {
+        return 0;
+    }
+    idx = (size_t)(pct / 100.0 * (n - 1) + 0.5);
+    return lat[idx] / 1000.0;
+}
+
+static void bench_report(void)
+{
+    uint64_t reads = 0, writes = 0, *lat, sum = 0;
+    size_t   n = 0, i;
+    double   elapsed;
+    unsigned j;
+
+    for (j = 0; j < g_opts.num_jobs; j++) {
+        reads  += g_jobs[j].reads;
+        writes += g_jobs[j].writes;
+        n      += g_jobs[j].num_lat;
+    }
+
+    lat = malloc((n ? n : 1) * sizeof(*lat));
+    if (lat == NULL) {
+        fprintf(stderr, "out of memory for the latency report\n");
+        return;
+    }
+    for (n = 0, j = 0; j < g_opts.num_jobs; j++) {
+        memcpy(lat + n, g_jobs[j].lat_ns, g_jobs[j].num_lat * sizeof(*lat));
+        n += g_jobs[j].num_lat;
+    }
+    qsort(lat, n, sizeof(*lat), cmp_u64);
+    for (i = 0; i < n; i++) {
+        sum += lat[i];
+    }
+
+    elapsed = (g_end_ns - g_start_ns) / 1e9;
+    printf("+--------+------+------+---------+----------+----------+"
+           "----------+----------+----------+----------+\n");
+    printf("| target | jobs |  qd  |  size   |   IOPS   |   MB/s   |"
+           " avg (us) | p50 (us) | p99 (us) |p99.9 (us)|\n");
+    printf("+--------+------+------+---------+----------+----------+"
+           "----------+----------+----------+----------+\n");
+    printf("| %-6s | %4u | %4u | %7u | %8.0f | %8.1f | %8.2f | %8.2f | %8.2f | %8.2f |\n",
+           g_opts.local ? "local" : "remote", g_opts.num_jobs, g_opts.queue_depth,
+           g_opts.io_size, (reads + writes) / elapsed,
+           (reads + writes) * (double)g_opts.io_size / elapsed / 1e6,
+           n ? sum / (double)n / 1000.0 : 0.0,
+           percentile_us(lat, n, 50), percentile_us(lat, n, 99),
+           percentile_us(lat, n, 99.9));
+    printf("+--------+------+------+---------+----------+----------+"
+           "----------+----------+----------+----------+\n");
+    printf("%lu reads, %lu writes in %.2f s\n", (unsigned long)reads,
+           (unsigned long)writes, elapsed);
+    free(lat);
+}
+
+static int run_remote(void)
+{
+    unsigned j;
+    int      rc = 0;
+
+    g_start_ns = get_time_ns();
+    g_end_ns   = g_start_ns + g_opts.run_time * 1000000000ull;
+    for (j = 0; j < g_opts.num_jobs; j++) {
+        if (pthread_create(&g_jobs[j].pthread, NULL, remote_job_run, &g_jobs[j])) {
+            fprintf(stderr, "failed to start job %u\n", j);
+            return -1;
+        }
+    }
+    for (j = 0; j < g_opts.num_jobs; j++) {
+        pthread_join(g_jobs[j].pthread, NULL);
+        if (g_jobs[j].error) {
+            rc = -1;
+        }
+    }
+    g_end_ns = get_time_ns();
+
+    bench_report();
+    return rc;
+}
+
+static int spdk_parse_arg(int ch, char *arg)
+{
+    return -EINVAL;
+}
+
+static void usage(void)
+{
+    printf("Usage: ourdemo_bench [parameters] [-- <SPDK app parameters>]\n");
+    printf("ourdemo storage benchmark, reports IOPS, bandwidth and latency\n");
+    printf("\nParameters are:\n");
+    printf(" -a <addr>     IP address of the server (remote mode), may be repeated\n"
+           "               to spread the lanes over up to %d addresses\n",
+           MAX_SERVER_ADDRS);
+    printf(" -p <port>     port of the server (default = %d)\n", OURDEMO_DEFAULT_PORT);
+    printf(" -L            run against the local bdev instead of the server, the\n"
+           "               SPDK parameters (e.g. --json) follow '--'\n");
+    printf(" -b <bdev>     bdev to use in local mode (default = %s)\n", g_opts.bdev_name);
+    printf(" -c <count>    number of jobs, clients in remote mode (default = %u)\n",
+           g_opts.num_jobs);
+    printf(" -q <depth>    queue depth of every job (default = %u)\n", g_opts.queue_depth);
+    printf(" -s <size>     I/O size in bytes (default = %u)\n", g_opts.io_size);
+    printf(" -M <pct>      percentage of reads (default = %u)\n", g_opts.read_pct);
+    printf(" -S            sequential instead of random offsets\n");
+    printf(" -t <sec>      run time (default = %u)\n", g_opts.run_time);
+    printf(" -d <usec>     think time after every completion, lets the server\n"
+           "               go idle between I/Os (remote mode only)\n");
+    printf(" -B <count>    max commands per send (default = %u)\n", g_opts.batch_max);
+    printf(" -z <size>     RMA threshold, -1 disables RMA (default = %ld)\n",
+           g_opts.rma_thresh);
+    printf(" -l <count>    lanes (endpoints) of every client (default = %u)\n",
+           g_opts.num_lanes);
+    printf(" -w <size>     I/Os larger than this are split over the lanes, 0\n"
+           "               disables (default = %u)\n", g_opts.stripe_size);
+}
+
+static int parse_cmd(int argc, char **argv)
+{
+    int c, port;
+
+    while ((c = getopt(argc, argv, "a:p:Lb:c:q:s:M:St:d:B:z:l:w:h")) != -1) {
+        switch (c) {
+        case 'a':
+            if (g_opts.num_server_addrs == MAX_SERVER_ADDRS) {
+                fprintf(stderr, "too many server addresses\n");
+                return -1;
+            }
+            g_opts.server_addrs[g_opts.num_server_addrs++] = optarg;
+            break;
+        case 'p':
+            port = atoi(optarg);
+            if ((port < 0) || (port > UINT16_MAX)) {
+                fprintf(stderr, "Wrong server port number %d\n", port);
+                return -1;
+            }
+            g_opts.port = port;
+            break;
+        case 'L':
+            g_opts.local = 1;
+            break;
+        case 'b':
+            g_opts.bdev_name = optarg;
+            break;
+        case 'c':
+            g_opts.num_jobs = atoi(optarg);
+            break;
+        case 'q':
+            g_opts.queue_depth = atoi(optarg);
+            break;
+        case 's':
+            g_opts.io_size = atoi(optarg);
+            break;
+        case 'M':
+            g_opts.read_pct = atoi(optarg);
+            break;
+        case 'S':
+            g_opts.sequential = 1;
+            break;
+        case 't':
+            g_opts.run_time = atoi(optarg);
+            break;
+        case 'd':
+            g_opts.think_ns = atol(optarg) * 1000ull;
+            break;
+        case 'B':
+            g_opts.batch_max = atoi(optarg);
+            break;
+        case 'z':
+            g_opts.rma_thresh = atol(optarg);
+            break;
+        case 'l':
+            g_opts.num_lanes = atoi(optarg);
+            break;
+        case 'w':
+            g_opts.stripe_size = atoi(optarg);
+            break;
+        default:
+            usage();
+            return -1;
+        }
+    }
+
+    if ((g_opts.num_jobs == 0) || (g_opts.queue_depth == 0) ||
+        (g_opts.io_size == 0) || (g_opts.io_size > OURDEMO_MAX_IO_SIZE) ||
+        (g_opts.read_pct > 100) || (g_opts.run_time == 0) ||
+        (g_opts.num_lanes == 0)) {
+        usage();
+        return -1;
+    }
+    if (g_opts.local && g_opts.think_ns) {
+        fprintf(stderr, "think time is not supported in local mode\n");
+        return -1;
+    }
+    if (!g_opts.local && (g_opts.num_server_addrs == 0)) {
+        fprintf(stderr, "the server address is required in remote mode\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct spdk_app_opts opts = {};
+    int                  rc;
+
+    rc = parse_cmd(argc, argv);
+    if (rc != 0) {
+        return rc;
+    }
+
+    g_jobs = calloc(g_opts.num_jobs, sizeof(*g_jobs));
+    if (g_jobs == NULL) {
+        return -1;
+    }
+    for (unsigned j = 0; j < g_opts.num_jobs; j++) {
+        g_jobs[j].index = j;
+    }
+
+    if (!g_opts.local) {
+        rc = run_remote();
+    } else {
+        /* Hand whatever follows '--' to the SPDK application framework */
+        argv[optind - 1] = argv[0];
+        argc            -= optind - 1;
+        argv            += optind - 1;
+        optind           = 1;
+        spdk_app_opts_init(&opts);
+        opts.name = "ourdemo_bench";
+        rc = spdk_app_parse_args(argc, argv, &opts, "", NULL, spdk_parse_arg,
+                                 NULL);
+        if (rc == SPDK_APP_PARSE_ARGS_SUCCESS) {
+            rc = spdk_app_start(&opts, local_start, NULL);
+            spdk_app_fini();
+        }
+    }
+
+    for (unsigned j = 0; j < g_opts.num_jobs; j++) {
+        free(g_jobs[j].lat_ns);
+    }
+    free(g_jobs);
+    return rc;
+}
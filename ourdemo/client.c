@@ -1,139 +1,75 @@
-#include <ucp/api/ucp.h>
+#include "ourdemo_client.h"
 
 #include <string.h>    /* memset */
-#include <arpa/inet.h> /* inet_addr */
 #include <unistd.h>    /* getopt */
 #include <stdlib.h>    /* atoi */
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
 
-#define TEST_STRING_LEN        sizeof(test_message)
-#define DEFAULT_PORT           13337
-#define IP_STRING_LEN          50
-#define PORT_STRING_LEN        8
-#define TAG                    0xCAFE
-#define COMM_TYPE_DEFAULT      "STREAM"
 #define PRINT_INTERVAL         2000
 #define DEFAULT_NUM_ITERATIONS 1
+#define DEFAULT_IO_SIZE        4096
+#define MAX_SERVER_ADDRS       8
 
-const  char test_message[]           = "UCX Client-Server Hello World";
-static uint16_t server_port          = DEFAULT_PORT;
 static int num_iterations            = DEFAULT_NUM_ITERATIONS;
-
-
-typedef enum {
-    CLIENT_SERVER_SEND_RECV_STREAM  = UCS_BIT(0),
-    CLIENT_SERVER_SEND_RECV_TAG     = UCS_BIT(1),
-    CLIENT_SERVER_SEND_RECV_DEFAULT = CLIENT_SERVER_SEND_RECV_STREAM
-} send_recv_type_t;
+static uint32_t io_size              = DEFAULT_IO_SIZE;
+static const char *server_addrs[MAX_SERVER_ADDRS];
 
 
 /**
- * Server's application context to be used in the user's connection request
- * callback.
- * It holds the server's listener and the handle to an incoming connection request.
+ * One slot of the I/O queue, each owns a part of the write and read buffers.
  */
-typedef struct ucx_server_ctx {
-    volatile ucp_conn_request_h conn_request;
-    ucp_listener_h              listener;
-} ucx_server_ctx_t;
-
+typedef struct client_io {
+    char     *wbuf;
+    char     *rbuf;
+    uint64_t offset;
+    int      status;
+    int      done;
+} client_io_t;
 
-/**
- * Stream request context. Holds a value to indicate whether or not the
- * request is completed.
- */
-typedef struct test_req {
-    int complete;
-} test_req_t;
-
-
-static void tag_recv_cb(void *request, ucs_status_t status,
-                        ucp_tag_recv_info_t *info)
-{
-    test_req_t *req = request;
-
-    req->complete = 1;
-}
-
-/**
- * The callback on the receiving side, which is invoked upon receiving the
- * stream message.
- */
-static void stream_recv_cb(void *request, ucs_status_t status, size_t length)
-{
-    test_req_t *req = request;
-
-    req->complete = 1;
-}
-
-/**
- * The callback on the sending side, which is invoked after finishing sending
- * the message.
- */
-static void send_cb(void *request, ucs_status_t status)
-{
-    test_req_t *req = request;
-
-    req->complete = 1;
-}
-
-/**
- * Error handling callback.
- */
-static void err_cb(void *arg, ucp_ep_h ep, ucs_status_t status)
-{
-    printf("error handling callback was invoked with status %d (%s)\n",
-           status, ucs_status_string(status));
-}
 
 static void usage(){
-    fprintf(stderr, "Usage: ucp_client_server [parameters]\n");
-    fprintf(stderr, "UCP client-server example utility\n");
+    fprintf(stderr, "Usage: ucp_client [parameters]\n");
+    fprintf(stderr, "ourdemo block client, writes and reads back blocks of the "
+                    "remote device\n");
     fprintf(stderr, "\nParameters are:\n");
-    fprintf(stderr, " -a Set IP address of the server "
-                    "(required for client and should not be specified "
-                    "for the server)\n");
-    fprintf(stderr, " -l Set IP address where server listens "
-                    "(If not specified, server uses INADDR_ANY; "
-                    "Irrelevant at client)\n");
-    fprintf(stderr, " -p Port number to listen/connect to (default = %d). "
-                    "0 on the server side means select a random port and print it\n",
-                    DEFAULT_PORT);
-    fprintf(stderr, " -c Communication type for the client and server. "
-                    " Valid values are:\n"
-                    "     'stream' : Stream API\n"
-                    "     'tag'    : Tag API\n"
-                    "    If not specified, %s API will be used.\n", COMM_TYPE_DEFAULT);
-    fprintf(stderr, " -i Number of iterations to run. Client and server must "
-                    "have the same value. (default = %d).\n",
-                    num_iterations);
+    fprintf(stderr, " -a Set IP address of the server (required), may be repeated "
+                    "to spread the lanes over up to %d addresses\n", MAX_SERVER_ADDRS);
+    fprintf(stderr, " -p Port number to connect to (default = %d)\n",
+                    OURDEMO_DEFAULT_PORT);
+    fprintf(stderr, " -s I/O size in bytes (default = %d)\n", DEFAULT_IO_SIZE);
+    fprintf(stderr, " -q Queue depth (default = %d)\n", OURDEMO_CLIENT_DEFAULT_QD);
+    fprintf(stderr, " -b Max commands coalesced into one send (default = %d)\n",
+                    OURDEMO_CLIENT_DEFAULT_BATCH);
+    fprintf(stderr, " -z I/Os of at least this many bytes are moved by the server "
+                    "with RMA instead of the stream, -1 disables RMA (default = %d)\n",
+                    OURDEMO_CLIENT_DEFAULT_RMA_THRESH);
+    fprintf(stderr, " -l Number of lanes (endpoints) to the server (default = 1)\n");
+    fprintf(stderr, " -w I/Os larger than this many bytes are split over the lanes, "
+                    "0 disables (default = %d)\n", OURDEMO_CLIENT_DEFAULT_STRIPE);
+    fprintf(stderr, " -i Number of write/read rounds over the queue to run "
+                    "(default = %d).\n", num_iterations);
     fprintf(stderr, "\n");
 }
 
-static int parse_cmd(int argc, char *const argv[], char **server_addr, char **listen_addr, send_recv_type_t *send_recv_type){
-    
+static int parse_cmd(int argc, char *const argv[], ourdemo_client_params_t *params){
+
     int c = 0;
     int port;
 
     opterr = 0;
 
-    while ((c = getopt(argc, argv, "a:l:p:c:i:")) != -1) {
+    while ((c = getopt(argc, argv, "a:p:s:q:b:z:l:w:i:")) != -1) {
         switch (c) {
         case 'a':
-            *server_addr = optarg;
-            break;
-        case 'c':
-            if (!strcasecmp(optarg, "stream")) {
-                *send_recv_type = CLIENT_SERVER_SEND_RECV_STREAM;
-            } else if (!strcasecmp(optarg, "tag")) {
-                *send_recv_type = CLIENT_SERVER_SEND_RECV_TAG;
-            } else {
-                fprintf(stderr, "Wrong communication type %s. "
-                        "Using %s as default\n", optarg, COMM_TYPE_DEFAULT);
-                *send_recv_type = CLIENT_SERVER_SEND_RECV_DEFAULT;
+            if (params->num_server_addrs == MAX_SERVER_ADDRS) {
+                fprintf(stderr, "Too many server addresses\n");
+                return -1;
             }
-            break;
-        case 'l':
-            *listen_addr = optarg;
+            server_addrs[params->num_server_addrs++] = optarg;
+            params->server_addrs = server_addrs;
+            params->server_addr  = server_addrs[0];
             break;
         case 'p':
             port = atoi(optarg);
@@ -141,7 +77,29 @@ static int parse_cmd(int argc, char *const argv[], char **server_addr, char **li
                 fprintf(stderr, "Wrong server port number %d\n", port);
                 return -1;
             }
-            server_port = port;
+            params->port = port;
+            break;
+        case 's':
+            io_size = atoi(optarg);
+            if ((io_size == 0) || (io_size > OURDEMO_MAX_IO_SIZE)) {
+                fprintf(stderr, "Wrong I/O size %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'q':
+            params->queue_depth = atoi(optarg);
+            break;
+        case 'b':
+            params->batch_max = atoi(optarg);
+            break;
+        case 'z':
+            params->rma_thresh = atol(optarg);
+            break;
+        case 'l':
+            params->num_lanes = atoi(optarg);
+            break;
+        case 'w':
+            params->stripe_size = atoi(optarg);
             break;
         case 'i':
             num_iterations = atoi(optarg);
@@ -152,349 +110,181 @@ static int parse_cmd(int argc, char *const argv[], char **server_addr, char **li
         }
     }
 
-    return 0;
-}
-
-static int init_worker(ucp_context_h ucp_context, ucp_worker_h *ucp_worker){
-    ucp_worker_params_t worker_params;
-    ucs_status_t status;
-    int ret = 0;
-
-    memset(&worker_params, 0, sizeof(worker_params));
-
-    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
-    worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
-
-    status = ucp_worker_create(ucp_context, &worker_params, ucp_worker);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to ucp_worker_create (%s)\n", ucs_status_string(status));
-        ret = -1;
-    }
-
-    return ret;
-}
-
-static int init_context(ucp_context_h *ucp_context , ucp_worker_h *ucp_worker){
-    
-    ucp_params_t ucp_params;
-    ucs_status_t status;
-    
-    int ret = 0;
-    memset(&ucp_params , 0 , sizeof(ucp_params));
-    ucp_params.field_mask = UCP_PARAM_FIELD_FEATURES;
-    ucp_params.features   = UCP_FEATURE_STREAM;
-    status = ucp_init(&ucp_params , NULL , ucp_context);
-    if (status != UCS_OK){
-        goto err;
-    }
-    ret = init_worker(*ucp_context , ucp_worker);
-    if (ret !=0){
-        goto err_cleanup;
+    if ((params->server_addr == NULL) || (params->queue_depth == 0) ||
+        (params->batch_max == 0) || (params->num_lanes == 0)) {
+        usage();
+        return -1;
     }
-    return ret;
-    err_cleanup:
-        ucp_cleanup(*ucp_context);
-    err:
-        printf("GG!\n");
-        return ret;
 
+    return 0;
 }
 
-void set_connect_addr(const char *address_str, struct sockaddr_in *connect_addr){
-    memset(connect_addr, 0, sizeof(struct sockaddr_in));
-    connect_addr->sin_family      = AF_INET;
-    connect_addr->sin_addr.s_addr = inet_addr(address_str);
-    connect_addr->sin_port        = htons(server_port);
-}
-
-static ucs_status_t start_client(ucp_worker_h ucp_worker, const char *ip, ucp_ep_h *client_ep){
-    ucp_ep_params_t ep_params;
-    struct sockaddr_in connect_addr;
-    ucs_status_t status;
-
-    set_connect_addr(ip, &connect_addr);
-
-    /*
-     * Endpoint field mask bits:
-     * UCP_EP_PARAM_FIELD_FLAGS             - Use the value of the 'flags' field.
-     * UCP_EP_PARAM_FIELD_SOCK_ADDR         - Use a remote sockaddr to connect
-     *                                        to the remote peer.
-     * UCP_EP_PARAM_FIELD_ERR_HANDLING_MODE - Error handling mode - this flag
-     *                                        is temporarily required since the
-     *                                        endpoint will be closed with
-     *                                        UCP_EP_CLOSE_MODE_FORCE which
-     *                                        requires this mode.
-     *                                        Once UCP_EP_CLOSE_MODE_FORCE is
-     *                                        removed, the error handling mode
-     *                                        will be removed.
-     */
-    ep_params.field_mask       = UCP_EP_PARAM_FIELD_FLAGS       |
-                                 UCP_EP_PARAM_FIELD_SOCK_ADDR   |
-                                 UCP_EP_PARAM_FIELD_ERR_HANDLER |
-                                 UCP_EP_PARAM_FIELD_ERR_HANDLING_MODE;
-    ep_params.err_mode         = UCP_ERR_HANDLING_MODE_PEER;
-    ep_params.err_handler.cb   = err_cb;
-    ep_params.err_handler.arg  = NULL;
-    ep_params.flags            = UCP_EP_PARAMS_FLAGS_CLIENT_SERVER;
-    ep_params.sockaddr.addr    = (struct sockaddr*)&connect_addr;
-    ep_params.sockaddr.addrlen = sizeof(connect_addr);
-
-    status = ucp_ep_create(ucp_worker, &ep_params, client_ep);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to connect to %s (%s)\n", ip, ucs_status_string(status));
-    }
-
-    return status;
-}
+static void io_done(void *arg, int status)
+{
+    client_io_t *io = arg;
 
-static void print_result(int is_server, char *recv_message, int current_iter){
-    if (is_server) {
-        printf("Server: iteration #%d\n", (current_iter + 1));
-        printf("UCX data message was received\n");
-        printf("\n\n----- UCP TEST SUCCESS -------\n\n");
-        printf("%s", recv_message);
-        printf("\n\n------------------------------\n\n");
-    } else {
-        printf("Client: iteration #%d\n", (current_iter + 1));
-        printf("\n\n-----------------------------------------\n\n");
-        printf("Client sent message: \n%s.\nlength: %ld\n",
-               test_message, TEST_STRING_LEN);
-        printf("\n-----------------------------------------\n\n");
-    }
+    io->status = status;
+    io->done   = 1;
 }
 
 /**
- * Progress the request until it completes.
+ * Submit one command per queue slot, then progress until all completed.
  */
-static ucs_status_t request_wait(ucp_worker_h ucp_worker, test_req_t *request){
-    ucs_status_t status;
+static int run_round(ourdemo_client_t *client, client_io_t *ios, unsigned qd,
+                     int write){
+    unsigned submitted = 0, i;
+    int      ret;
 
-    /* if operation was completed immediately */
-    if (request == NULL) {
-        return UCS_OK;
+    for (i = 0; i < qd; i++) {
+        ios[i].done = 0;
     }
-    
-    if (UCS_PTR_IS_ERR(request)) {
-        return UCS_PTR_STATUS(request);
-    }
-    
-    while (request->complete == 0) {
-        ucp_worker_progress(ucp_worker);
-    }
-    status = ucp_request_check_status(request);
-
-    /* This request may be reused so initialize it for next time */
-    request->complete = 0;
-    ucp_request_free(request);
-
-    return status;
-}
 
-static int request_finalize(ucp_worker_h ucp_worker, test_req_t *request, int is_server, char *recv_message, int current_iter){
-    ucs_status_t status;
-    int ret = 0;
+    while (submitted < qd) {
+        client_io_t *io = &ios[submitted];
 
-    status = request_wait(ucp_worker, request);
-    if (status != UCS_OK) {
-        fprintf(stderr, "unable to %s UCX message (%s)\n",
-                is_server ? "receive": "send", ucs_status_string(status));
-        return -1;
+        if (write) {
+            ret = ourdemo_client_write(client, io->wbuf, io->offset, io_size,
+                                       io_done, io);
+        } else {
+            ret = ourdemo_client_read(client, io->rbuf, io->offset, io_size,
+                                      io_done, io);
+        }
+        if (ret == -EAGAIN) {
+            ourdemo_client_progress(client);
+        } else if (ret != 0) {
+            fprintf(stderr, "failed to submit I/O (%d)\n", ret);
+            return ret;
+        } else {
+            submitted++;
+        }
     }
 
-    /* Print the output of the first, last and every PRINT_INTERVAL iteration */
-    if ((current_iter == 0) || (current_iter == (num_iterations - 1)) ||
-        !((current_iter + 1) % (PRINT_INTERVAL))) {
-        print_result(is_server, recv_message, current_iter);
+    while (ourdemo_client_outstanding(client) > 0) {
+        ourdemo_client_progress(client);
     }
 
-    return ret;
-}
-
-static int send_recv_stream(ucp_worker_h ucp_worker, ucp_ep_h ep, int is_server, int current_iter){
-    char recv_message[TEST_STRING_LEN]= "";
-    test_req_t *request;
-    size_t length;
-
-    if (!is_server) {
-        /* Client sends a message to the server using the stream API */
-        request = ucp_stream_send_nb(ep, test_message, 1,
-                                     ucp_dt_make_contig(TEST_STRING_LEN),
-                                     send_cb, 0);
-    } else {
-        /* Server receives a message from the client using the stream API */
-        request = ucp_stream_recv_nb(ep, &recv_message, 1,
-                                     ucp_dt_make_contig(TEST_STRING_LEN),
-                                     stream_recv_cb, &length,
-                                     UCP_STREAM_RECV_FLAG_WAITALL);
+    for (i = 0; i < qd; i++) {
+        if (ios[i].status != 0) {
+            fprintf(stderr, "I/O at offset %lu failed (%d)\n",
+                    (unsigned long)ios[i].offset, ios[i].status);
+            return ios[i].status;
+        }
     }
-
-    return request_finalize(ucp_worker, request, is_server, recv_message,
-                            current_iter);
+    return 0;
 }
 
-/**
- * Send and receive a message using the Tag-Matching API.
- * The client sends a message to the server and waits until the send it completed.
- * The server receives a message from the client and waits for its completion.
- */
-static int send_recv_tag(ucp_worker_h ucp_worker, ucp_ep_h ep, int is_server, int current_iter){
-    char recv_message[TEST_STRING_LEN]= "";
-    test_req_t *request;
-
-    if (!is_server) {
-        /* Client sends a message to the server using the Tag-Matching API */
-        request = ucp_tag_send_nb(ep, test_message, 1,
-                                  ucp_dt_make_contig(TEST_STRING_LEN), TAG,
-                                  send_cb);
-    } else {
-        /* Server receives a message from the client using the Tag-Matching API */
-        request = ucp_tag_recv_nb(ucp_worker, &recv_message, 1,
-                                  ucp_dt_make_contig(TEST_STRING_LEN),
-                                  TAG, 0, tag_recv_cb);
+static int client_do_work(ourdemo_client_t *client, unsigned qd){
+    const ourdemo_info_t *info = ourdemo_client_get_info(client);
+    struct timespec      start, end;
+    ourdemo_mem_t        *mem = NULL;
+    client_io_t          *ios;
+    uint64_t             num_ios;
+    char                 *bufs;
+    double               elapsed;
+    unsigned             j;
+    int                  i, ret = 0;
+
+    printf("remote device: %lu blocks of %u bytes\n",
+           (unsigned long)info->num_blocks, info->block_size);
+
+    if ((io_size % info->block_size) || (io_size > info->max_io_size)) {
+        fprintf(stderr, "I/O size %u is not a multiple of the block size or too large\n",
+                io_size);
+        return -1;
     }
-
-    return request_finalize(ucp_worker, request, is_server, recv_message,
-                            current_iter);
-}
-
-/**
- * Close the given endpoint.
- * Currently closing the endpoint with UCP_EP_CLOSE_MODE_FORCE since we currently
- * cannot rely on the client side to be present during the server's endpoint
- * closing process.
- */
-static void ep_close(ucp_worker_h ucp_worker, ucp_ep_h ep){
-    ucs_status_t status;
-    void *close_req;
-
-    close_req = ucp_ep_close_nb(ep, UCP_EP_CLOSE_MODE_FORCE);
-    if (UCS_PTR_IS_PTR(close_req)) {
-        do {
-            ucp_worker_progress(ucp_worker);
-            status = ucp_request_check_status(close_req);
-        } while (status == UCS_INPROGRESS);
-
-        ucp_request_free(close_req);
-    } else if (UCS_PTR_STATUS(close_req) != UCS_OK) {
-        fprintf(stderr, "failed to close ep %p\n", (void*)ep);
+    num_ios = info->num_blocks * info->block_size / io_size;
+    if (num_ios < qd) {
+        fprintf(stderr, "device too small for %u I/Os of %u bytes\n", qd, io_size);
+        return -1;
     }
-}
 
-static int client_server_communication(ucp_worker_h worker, ucp_ep_h ep, send_recv_type_t send_recv_type,int is_server, int current_iter){
-    int ret = 0;
-
-    switch (send_recv_type) {
-    case CLIENT_SERVER_SEND_RECV_STREAM:
-        /* Client-Server communication via Stream API */
-        ret = send_recv_stream(worker, ep, is_server, current_iter);
-        break;
-    case CLIENT_SERVER_SEND_RECV_TAG:
-        /* Client-Server communication via Tag-Matching API */
-        ret = send_recv_tag(worker, ep, is_server, current_iter);
-        break;
-    default:
-        fprintf(stderr, "unknown send-recv type %d\n", send_recv_type);
-        return -1;
+    ios  = calloc(qd, sizeof(*ios));
+    bufs = malloc(2 * (size_t)qd * io_size);
+    if ((ios == NULL) || (bufs == NULL)) {
+        ret = -1;
+        goto out;
     }
 
-    return ret;
-}
+    /* Harmless if RMA is disabled, the buffers are then never looked up */
+    ret = ourdemo_client_mem_reg(client, bufs, 2 * (size_t)qd * io_size, &mem);
+    if (ret != 0) {
+        goto out;
+    }
 
-static int client_server_do_work(ucp_worker_h ucp_worker, ucp_ep_h ep, send_recv_type_t send_recv_type, int is_server){
-    int i, ret = 0;
+    for (j = 0; j < qd; j++) {
+        ios[j].wbuf = bufs + (2 * (size_t)j) * io_size;
+        ios[j].rbuf = ios[j].wbuf + io_size;
+    }
 
+    clock_gettime(CLOCK_MONOTONIC, &start);
     for (i = 0; i < num_iterations; i++) {
-        ret = client_server_communication(ucp_worker, ep, send_recv_type,
-                                          is_server, i);
+        for (j = 0; j < qd; j++) {
+            ios[j].offset = ((i * qd + j) % num_ios) * io_size;
+            memset(ios[j].wbuf, 'a' + ((i + j) % 26), io_size);
+            memset(ios[j].rbuf, 0, io_size);
+        }
+
+        ret = run_round(client, ios, qd, 1);
+        if (ret == 0) {
+            ret = run_round(client, ios, qd, 0);
+        }
         if (ret != 0) {
-            fprintf(stderr, "%s failed on iteration #%d\n",
-                    (is_server ? "server": "client"), i);
+            fprintf(stderr, "I/O failed on iteration #%d (%d)\n", i, ret);
             goto out;
         }
-    }
-
-out:
-    return ret;
-}
 
-static int our_send_recv_stream(ucp_worker_h ucp_worker, ucp_ep_h ep, void* buffer, int comm_size, int t){
-    test_req_t *request;
-    size_t length;
-    if (!t) {
-        /* Client sends a message to the server using the stream API */
-        request = ucp_stream_send_nb(ep, buffer, 1,
-                                     ucp_dt_make_contig(comm_size),
-                                     send_cb, 0);
-    } else {
-        /* Server receives a message from the client using the stream API */
-        request = ucp_stream_recv_nb(ep, buffer, 1,
-                                     ucp_dt_make_contig(comm_size),
-                                     stream_recv_cb, &length,
-                                     UCP_STREAM_RECV_FLAG_WAITALL);
-    }
-    request_wait(ucp_worker, request);
-    printf("Client Done\n");
-    return 0;
-}
+        for (j = 0; j < qd; j++) {
+            if (memcmp(ios[j].wbuf, ios[j].rbuf, io_size)) {
+                fprintf(stderr, "data mismatch on iteration #%d at offset %lu\n",
+                        i, (unsigned long)ios[j].offset);
+                ret = -1;
+                goto out;
+            }
+        }
 
-static int run_client(ucp_worker_h ucp_worker, char *server_addr, send_recv_type_t send_recv_type){
-    
-    ucp_ep_h     client_ep;
-    ucs_status_t status;
-    int          ret = 0;
-    char buff[100] = "Hello World";  
-    int comm_size = 100;
-
-    status = start_client(ucp_worker, server_addr, &client_ep);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to start client (%s)\n", ucs_status_string(status));
-        ret = -1;
-        goto out;
+        /* Print the output of the first, last and every PRINT_INTERVAL iteration */
+        if ((i == 0) || (i == (num_iterations - 1)) ||
+            !((i + 1) % (PRINT_INTERVAL))) {
+            printf("Client: iteration #%d, %u x %u bytes verified\n",
+                   i + 1, qd, io_size);
+        }
     }
-    //
-    //ret = our_send_recv_stream(ucp_worker, client_ep,buff,comm_size,0);
-    //ret = client_server_do_work(ucp_worker, client_ep, send_recv_type, 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
 
-    /* Close the endpoint to the server */
-    ep_close(ucp_worker, client_ep);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf("%d I/Os in %.3f s: %.0f IOPS, %.1f MB/s\n", 2 * num_iterations * qd,
+           elapsed, 2 * num_iterations * qd / elapsed,
+           2.0 * num_iterations * qd * io_size / elapsed / 1e6);
 
 out:
+    if (mem != NULL) {
+        ourdemo_client_mem_dereg(client, mem);
+    }
+    free(bufs);
+    free(ios);
     return ret;
 }
 
 
+int main(int argc, char **argv){
 
-int begin_client(int argc, char *const argv[]){
-
-    send_recv_type_t send_recv_type = CLIENT_SERVER_SEND_RECV_DEFAULT;
-    char *server_addr = NULL;
-    char *listen_addr = NULL;
-    int ret = 0;
+    ourdemo_client_params_t params;
+    ourdemo_client_t        *client;
+    int                     ret;
 
+    ourdemo_client_params_init(&params);
+    ret = parse_cmd(argc, argv, &params);
+    if (ret != 0) {
+        return ret;
+    }
 
-    /* UCP objects */
-    ucp_context_h ucp_context;
-    ucp_worker_h  ucp_worker;
-    ucp_ep_h     client_ep;
-    
-    ret = parse_cmd(argc, argv, &server_addr, &listen_addr, &send_recv_type);
-    ret = init_context(&ucp_context, &ucp_worker);
+    ret = ourdemo_client_create(&params, &client);
     if (ret != 0) {
-        goto err;
+        fprintf(stderr, "failed to start client (%d)\n", ret);
+        return ret;
     }
-    ret = run_client(ucp_worker, server_addr, send_recv_type);
-  err:
+
+    ret = client_do_work(client, params.queue_depth);
+    ourdemo_client_destroy(client);
     return ret;
 }
-
-
-
-
-int main(int argc, char **argv){
-
-  int ret = 0;
-
-  ret = begin_client(argc, argv);
-  return ret;
-
-}
\ No newline at end of file
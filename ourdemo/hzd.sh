@@ -1,3 +1,10 @@
 module add cosmo/changa/3.3-ucxml-2.4.0-intel-2018.5.274
-export LD_LIBRARY_PATH=/global/home/users/rdmaworkshop12/SPDK/ourdemo/ucx-1.8.1/install/lib
-gcc server.c -lm -lucp -lucs -o ucp_client_server -I/global/home/users/rdmaworkshop12/SPDK/ourdemo/ucx-1.8.1/src -I/global/home/users/rdmaworkshop12/SPDK/ourdemo/ucx-1.8.1/install/include -L/global/home/users/rdmaworkshop12/SPDK/ourdemo/ucx-1.8.1/install/lib
+OURDEMO=/global/home/users/rdmaworkshop12/SPDK/ourdemo
+export LD_LIBRARY_PATH=$OURDEMO/ucx-1.8.1/install/lib
+SPDK_LIB=$OURDEMO/spdk/build/lib
+DPDK_LIB=$OURDEMO/spdk/dpdk/build/lib
+SPDK_LIBS="-Wl,--whole-archive $SPDK_LIB/libspdk_bdev_malloc.a $SPDK_LIB/libspdk_bdev_aio.a $SPDK_LIB/libspdk_event_bdev.a $SPDK_LIB/libspdk_event_accel.a $SPDK_LIB/libspdk_event_vmd.a $SPDK_LIB/libspdk_event_sock.a $SPDK_LIB/libspdk_sock_posix.a $SPDK_LIB/libspdk_env_dpdk.a -Wl,--no-whole-archive"
+SPDK_LIBS="$SPDK_LIBS -L$SPDK_LIB -lspdk_bdev_rpc -lspdk_bdev -lspdk_accel -lspdk_vmd -lspdk_event -lspdk_thread -lspdk_util -lspdk_conf -lspdk_trace -lspdk_log -lspdk_jsonrpc -lspdk_json -lspdk_rpc -lspdk_sock -lspdk_notify -lspdk_app_rpc -lspdk_log_rpc -lspdk_env_dpdk_rpc"
+DPDK_LIBS="-Wl,--whole-archive $DPDK_LIB/librte_eal.a $DPDK_LIB/librte_mempool.a $DPDK_LIB/librte_ring.a $DPDK_LIB/librte_mempool_ring.a $DPDK_LIB/librte_bus_pci.a $DPDK_LIB/librte_pci.a $DPDK_LIB/librte_kvargs.a $DPDK_LIB/librte_telemetry.a -Wl,--no-whole-archive"
+gcc server.c -o ucp_client_server -I$OURDEMO/spdk/include -I$OURDEMO/ucx-1.8.1/src -I$OURDEMO/ucx-1.8.1/install/include -L$OURDEMO/ucx-1.8.1/install/lib $SPDK_LIBS $DPDK_LIBS -lucp -lucs -lnuma -laio -luuid -ldl -lrt -lpthread -lm
+gcc bench.c ourdemo_client.c -o ourdemo_bench -I$OURDEMO/spdk/include -I$OURDEMO/ucx-1.8.1/src -I$OURDEMO/ucx-1.8.1/install/include -L$OURDEMO/ucx-1.8.1/install/lib $SPDK_LIBS $DPDK_LIBS -lucp -lucs -lnuma -laio -luuid -ldl -lrt -lpthread -lm
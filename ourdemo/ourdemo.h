@@ -0,0 +1,61 @@
+#ifndef OURDEMO_H_
+#define OURDEMO_H_
+
+#include <stdint.h>
+
+/*
+ * Wire protocol spoken between the ourdemo client and server over a UCP
+ * stream endpoint.
+ *
+ * Every request starts with an ourdemo_cmd_t. A WRITE command is followed by
+ * 'length' bytes of payload. Every command is answered by an ourdemo_rsp_t
+ * carrying the same 'id'; a successful READ response is followed by 'length'
+ * bytes of payload and an INFO response by an ourdemo_info_t. Responses may
+ * come back in any order.
+ *
+ * With OURDEMO_CMD_FLAG_RMA the payload does not travel in the stream at all:
+ * the command is followed by 'rkey_length' bytes of a packed rkey covering
+ * 'remote_addr' in the client, and the server moves the data with ucp_get
+ * (WRITE) or ucp_put (READ). A READ response is only sent once the put is
+ * remotely complete, so the client buffer is valid when it arrives.
+ */
+
+#define OURDEMO_DEFAULT_PORT   13337
+#define OURDEMO_MAX_IO_SIZE    (1024 * 1024)
+#define OURDEMO_MAX_RKEY_SIZE  1024
+
+typedef enum {
+    OURDEMO_OP_INFO       = 1, /* query the exported device geometry */
+    OURDEMO_OP_READ       = 2,
+    OURDEMO_OP_WRITE      = 3,
+    OURDEMO_OP_DISCONNECT = 4  /* no response, the server closes the endpoint */
+} ourdemo_opcode_t;
+
+typedef enum {
+    OURDEMO_CMD_FLAG_RMA  = 1 << 0  /* payload is moved with RMA by the server */
+} ourdemo_cmd_flags_t;
+
+typedef struct ourdemo_cmd {
+    uint16_t opcode;
+    uint16_t flags;
+    uint32_t length;       /* payload length in bytes */
+    uint64_t id;           /* echoed back in the response */
+    uint64_t offset;       /* device offset in bytes, block aligned */
+    uint64_t remote_addr;  /* OURDEMO_CMD_FLAG_RMA: client buffer address */
+    uint32_t rkey_length;  /* OURDEMO_CMD_FLAG_RMA: packed rkey that follows */
+    uint32_t reserved;
+} ourdemo_cmd_t;
+
+typedef struct ourdemo_rsp {
+    uint64_t id;
+    int32_t  status;   /* 0 or a negative errno */
+    uint32_t length;   /* payload length following the response */
+} ourdemo_rsp_t;
+
+typedef struct ourdemo_info {
+    uint32_t block_size;
+    uint32_t max_io_size;
+    uint64_t num_blocks;
+} ourdemo_info_t;
+
+#endif
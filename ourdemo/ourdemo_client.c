@@ -0,0 +1,1218 @@
+#include "ourdemo_client.h"
+
+#include <ucp/api/ucp.h>
+
+#include <string.h>    /* memset */
+#include <arpa/inet.h> /* inet_addr */
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+
+#define CONNECT_TIMEOUT_SEC    10
+#define CLOSE_TIMEOUT_SEC      5      /* for the server to drain the lanes */
+#define NUM_BATCHES            4
+#define BATCH_BUF_SIZE         16384
+#define BATCH_MAX_IOV          64
+#define INLINE_WRITE_MAX       1024   /* smaller WRITE payloads are copied */
+
+typedef struct client_cmd  client_cmd_t;
+typedef struct client_lane client_lane_t;
+
+/**
+ * A command sent to the server, or an I/O striped over several lanes whose
+ * chunks are commands of their own. The parameters are kept so that a READ
+ * or INFO can be sent again on another lane.
+ */
+struct client_cmd {
+    ourdemo_cb_t  cb;
+    void          *arg;
+    void          *buffer;    /* where a READ or INFO payload is stored */
+    uint64_t      offset;
+    uint32_t      length;
+    uint16_t      opcode;
+    uint32_t      gen;        /* bumped on reuse, part of the wire id */
+    int           in_use;
+    client_lane_t *lane;      /* carrying the command, NULL if not sent */
+    client_cmd_t  *parent;    /* striped I/O this command is a chunk of */
+    unsigned      chunks_left;
+    int           status;     /* first error of the chunks */
+    client_cmd_t  *next;      /* free or retry list */
+};
+
+/**
+ * Commands gathered into one stream send. Headers, rkeys and small WRITE
+ * payloads are copied into 'data', larger payloads are sent from the user
+ * buffer.
+ */
+typedef struct client_batch {
+    client_lane_t    *lane;
+    int              in_flight;
+    unsigned         ncmds;
+    size_t           data_len;
+    size_t           iovcnt;
+    ucp_dt_iov_t     iov[BATCH_MAX_IOV];
+    char             data[BATCH_BUF_SIZE];
+} client_batch_t;
+
+struct ourdemo_mem {
+    char         *addr;
+    size_t       length;
+    ucp_mem_h    memh;
+    void         *rkey_buffer;
+    size_t       rkey_size;
+    ourdemo_mem_t *next;
+};
+
+/**
+ * Private area of every UCP request.
+ */
+typedef struct client_req {
+    client_batch_t *batch;
+} client_req_t;
+
+/**
+ * One endpoint to the server, with its own batches and response stream.
+ */
+struct client_lane {
+    ourdemo_client_t        *client;
+    ucp_ep_h                ep;
+    const char              *server_addr;
+    int                     failed;
+    int                     timed_out;     /* failed by client_check_lanes() */
+    int                     closed;        /* ep released or never created */
+    int                     picked;
+    unsigned                outstanding;   /* commands sent, not answered */
+    struct timespec         last_active;   /* last send or receive */
+
+    client_batch_t          batches[NUM_BATCHES];
+    client_batch_t          *cur_batch;    /* being filled, NULL if all in flight */
+    unsigned                batches_in_flight;
+
+    /* Response parser state, responses may be split anywhere */
+    ourdemo_rsp_t           rsp;
+    size_t                  rsp_offset;
+    client_cmd_t            *rx_cmd;       /* response header done, payload left */
+    size_t                  rx_offset;
+};
+
+struct ourdemo_client {
+    ourdemo_client_params_t params;
+    ucp_context_h           ucp_context;
+    ucp_worker_h            ucp_worker;
+    ourdemo_info_t          info;
+    int                     failed;        /* no lane left */
+
+    client_lane_t           *lanes;
+    client_lane_t           **picked;      /* scratch for client_pick_lanes() */
+    unsigned                num_lanes;
+    unsigned                healthy_lanes;
+    unsigned                next_lane;
+
+    client_cmd_t            *cmds;
+    unsigned                num_cmds;
+    client_cmd_t            *free_cmds;
+    client_cmd_t            *retry_head;   /* waiting to be sent again */
+    client_cmd_t            **retry_tail;
+    unsigned                outstanding;
+    unsigned                completions;
+
+    ourdemo_mem_t           *mems;
+};
+
+static int timed_out(const struct timespec *start, time_t timeout_sec)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) > timeout_sec;
+}
+
+static long elapsed_ms(const struct timespec *since, const struct timespec *now)
+{
+    return (now->tv_sec - since->tv_sec) * 1000 +
+           (now->tv_nsec - since->tv_nsec) / 1000000;
+}
+
+void ourdemo_client_params_init(ourdemo_client_params_t *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->port        = OURDEMO_DEFAULT_PORT;
+    params->queue_depth = OURDEMO_CLIENT_DEFAULT_QD;
+    params->batch_max   = OURDEMO_CLIENT_DEFAULT_BATCH;
+    params->rma_thresh  = OURDEMO_CLIENT_DEFAULT_RMA_THRESH;
+    params->num_lanes   = 1;
+    params->stripe_size = OURDEMO_CLIENT_DEFAULT_STRIPE;
+    params->lane_timeout_ms = OURDEMO_CLIENT_DEFAULT_LANE_TMO;
+}
+
+static client_batch_t *client_get_batch(client_lane_t *lane)
+{
+    unsigned i;
+
+    if (lane->cur_batch != NULL) {
+        return lane->cur_batch;
+    }
+
+    for (i = 0; i < NUM_BATCHES; i++) {
+        if (!lane->batches[i].in_flight) {
+            lane->cur_batch = &lane->batches[i];
+            return lane->cur_batch;
+        }
+    }
+    return NULL;
+}
+
+static void client_batch_reset(client_batch_t *batch)
+{
+    batch->in_flight = 0;
+    batch->ncmds     = 0;
+    batch->data_len  = 0;
+    batch->iovcnt    = 0;
+}
+
+static void send_cb(void *request, ucs_status_t status)
+{
+    client_req_t   *req    = request;
+    client_batch_t *batch  = req->batch;
+
+    ucp_request_free(request);
+    if (status != UCS_OK) {
+        fprintf(stderr, "unable to send commands (%s)\n", ucs_status_string(status));
+        batch->lane->failed = 1;
+    }
+    batch->lane->batches_in_flight--;
+    client_batch_reset(batch);
+}
+
+/**
+ * Send the batch being filled, if any.
+ */
+static void client_flush_batch(client_lane_t *lane)
+{
+    client_batch_t *batch = lane->cur_batch;
+    client_req_t   *req;
+
+    if (lane->failed || (batch == NULL) || (batch->ncmds == 0)) {
+        return;
+    }
+
+    lane->cur_batch = NULL;
+    clock_gettime(CLOCK_MONOTONIC, &lane->last_active);
+    req = ucp_stream_send_nb(lane->ep, batch->iov, batch->iovcnt,
+                             ucp_dt_make_iov(), send_cb, 0);
+    if (req == NULL) {
+        client_batch_reset(batch);
+    } else if (UCS_PTR_IS_ERR(req)) {
+        fprintf(stderr, "unable to send commands (%s)\n",
+                ucs_status_string(UCS_PTR_STATUS(req)));
+        lane->failed = 1;
+        client_batch_reset(batch);
+    } else {
+        req->batch       = batch;
+        batch->in_flight = 1;
+        lane->batches_in_flight++;
+    }
+}
+
+/**
+ * Append to the batch, copying 'data' or, with 'copy' unset, referencing it.
+ * The caller checked there is room.
+ */
+static void client_batch_append(client_batch_t *batch, const void *data,
+                                size_t length, int copy)
+{
+    ucp_dt_iov_t *last = batch->iovcnt ? &batch->iov[batch->iovcnt - 1] : NULL;
+    char         *dst;
+
+    if (!copy) {
+        batch->iov[batch->iovcnt].buffer = (void*)data;
+        batch->iov[batch->iovcnt].length = length;
+        batch->iovcnt++;
+        return;
+    }
+
+    dst = batch->data + batch->data_len;
+    memcpy(dst, data, length);
+    batch->data_len += length;
+
+    /* Extend the previous entry if it ends right where the copy went */
+    if ((last != NULL) && ((char*)last->buffer + last->length == dst)) {
+        last->length += length;
+    } else {
+        batch->iov[batch->iovcnt].buffer = dst;
+        batch->iov[batch->iovcnt].length = length;
+        batch->iovcnt++;
+    }
+}
+
+/**
+ * Find a batch with room for a command of 'copy_len' copied bytes and
+ * 'ref_iovs' referenced buffers, sending the current one if it is full.
+ */
+static client_batch_t *client_batch_reserve(client_lane_t *lane,
+                                            size_t copy_len, size_t ref_iovs)
+{
+    client_batch_t *batch = client_get_batch(lane);
+
+    if ((batch != NULL) &&
+        ((batch->ncmds >= lane->client->params.batch_max) ||
+         (batch->data_len + copy_len > BATCH_BUF_SIZE) ||
+         (batch->iovcnt + 1 + ref_iovs > BATCH_MAX_IOV))) {
+        client_flush_batch(lane);
+        batch = client_get_batch(lane);
+    }
+    return batch;
+}
+
+static ourdemo_mem_t *client_find_mem(ourdemo_client_t *client,
+                                      const void *buffer, size_t length)
+{
+    const char    *addr = buffer;
+    ourdemo_mem_t *mem;
+
+    for (mem = client->mems; mem != NULL; mem = mem->next) {
+        if ((addr >= mem->addr) && (addr + length <= mem->addr + mem->length)) {
+            return mem;
+        }
+    }
+    return NULL;
+}
+
+static client_cmd_t *client_cmd_get(ourdemo_client_t *client)
+{
+    client_cmd_t *cmd = client->free_cmds;
+
+    if (cmd != NULL) {
+        client->free_cmds = cmd->next;
+        cmd->in_use       = 1;
+        cmd->lane         = NULL;
+        cmd->parent       = NULL;
+        cmd->chunks_left  = 0;
+        cmd->status       = 0;
+    }
+    return cmd;
+}
+
+static void client_cmd_put(ourdemo_client_t *client, client_cmd_t *cmd)
+{
+    cmd->in_use       = 0;
+    cmd->gen++;
+    cmd->next         = client->free_cmds;
+    client->free_cmds = cmd;
+}
+
+static void client_cmd_complete(ourdemo_client_t *client, client_cmd_t *cmd,
+                                int status)
+{
+    client_cmd_t *parent = cmd->parent;
+    ourdemo_cb_t cb      = cmd->cb;
+    void         *arg    = cmd->arg;
+
+    if (cmd->lane != NULL) {
+        cmd->lane->outstanding--;
+    }
+    client_cmd_put(client, cmd);
+
+    if (parent != NULL) {
+        if ((status != 0) && (parent->status == 0)) {
+            parent->status = status;
+        }
+        if (--parent->chunks_left == 0) {
+            client_cmd_complete(client, parent, parent->status);
+        }
+        return;
+    }
+
+    client->outstanding--;
+    client->completions++;
+    if (cb != NULL) {
+        cb(arg, status);
+    }
+}
+
+/**
+ * How a command is laid out in a batch: the registered memory its payload
+ * is moved with by RMA, if any, the bytes copied and the buffers referenced.
+ */
+static ourdemo_mem_t *client_cmd_layout(ourdemo_client_t *client,
+                                        uint16_t opcode, const void *buffer,
+                                        uint32_t length, size_t *copy_len_p,
+                                        size_t *ref_iovs_p)
+{
+    ourdemo_mem_t *mem = NULL;
+
+    *copy_len_p = sizeof(ourdemo_cmd_t);
+    *ref_iovs_p = 0;
+
+    if ((opcode != OURDEMO_OP_INFO) && (client->params.rma_thresh >= 0) &&
+        (length >= client->params.rma_thresh)) {
+        mem = client_find_mem(client, buffer, length);
+    }
+
+    if (mem != NULL) {
+        *copy_len_p += mem->rkey_size;
+    } else if (opcode == OURDEMO_OP_WRITE) {
+        if (length <= INLINE_WRITE_MAX) {
+            *copy_len_p += length;
+        } else {
+            (*ref_iovs_p)++;
+        }
+    }
+    return mem;
+}
+
+static client_batch_t *client_lane_reserve(client_lane_t *lane, uint16_t opcode,
+                                           const void *buffer, uint32_t length)
+{
+    size_t copy_len, ref_iovs;
+
+    client_cmd_layout(lane->client, opcode, buffer, length, &copy_len, &ref_iovs);
+    return client_batch_reserve(lane, copy_len, ref_iovs);
+}
+
+/**
+ * Queue a command on a lane. Returns -EAGAIN if the lane has no room for it.
+ */
+static int client_cmd_send(client_lane_t *lane, client_cmd_t *cmd)
+{
+    ourdemo_client_t *client = lane->client;
+    ourdemo_cmd_t    hdr;
+    ourdemo_mem_t    *mem;
+    client_batch_t   *batch;
+    size_t           copy_len, ref_iovs;
+
+    mem = client_cmd_layout(client, cmd->opcode, cmd->buffer, cmd->length,
+                            &copy_len, &ref_iovs);
+    batch = client_batch_reserve(lane, copy_len, ref_iovs);
+    if (batch == NULL) {
+        return -EAGAIN;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.opcode = cmd->opcode;
+    hdr.offset = cmd->offset;
+    hdr.length = cmd->length;
+    hdr.id     = ((uint64_t)cmd->gen << 32) | (cmd - client->cmds);
+    if (mem != NULL) {
+        hdr.flags       = OURDEMO_CMD_FLAG_RMA;
+        hdr.remote_addr = (uintptr_t)cmd->buffer;
+        hdr.rkey_length = mem->rkey_size;
+    }
+
+    cmd->lane = lane;
+    lane->outstanding++;
+
+    client_batch_append(batch, &hdr, sizeof(hdr), 1);
+    if (mem != NULL) {
+        client_batch_append(batch, mem->rkey_buffer, mem->rkey_size, 1);
+    } else if (cmd->opcode == OURDEMO_OP_WRITE) {
+        client_batch_append(batch, cmd->buffer, cmd->length,
+                            cmd->length <= INLINE_WRITE_MAX);
+    }
+    batch->ncmds++;
+
+    if (batch->ncmds >= client->params.batch_max) {
+        client_flush_batch(lane);
+    }
+    return 0;
+}
+
+static int client_lane_usable(ourdemo_client_t *client, client_lane_t *lane)
+{
+    unsigned depth = client->params.lane_depth ? client->params.lane_depth :
+                                                 client->params.queue_depth;
+
+    return !lane->failed && !lane->closed && (lane->outstanding < depth);
+}
+
+/**
+ * Pick up to 'max' distinct lanes with room for a command, least loaded
+ * first. Returns the number of lanes stored in client->picked.
+ */
+static unsigned client_pick_lanes(ourdemo_client_t *client, unsigned max)
+{
+    client_lane_t *lane, *best;
+    unsigned      count, i;
+
+    for (count = 0; count < max; count++) {
+        best = NULL;
+        /* Start from a rotating lane so that ties spread the load */
+        for (i = 0; i < client->num_lanes; i++) {
+            lane = &client->lanes[(client->next_lane + i) % client->num_lanes];
+            if (!lane->picked && client_lane_usable(client, lane) &&
+                ((best == NULL) || (lane->outstanding < best->outstanding))) {
+                best = lane;
+            }
+        }
+        if (best == NULL) {
+            break;
+        }
+        best->picked           = 1;
+        client->picked[count]  = best;
+    }
+
+    for (i = 0; i < count; i++) {
+        client->picked[i]->picked = 0;
+    }
+    client->next_lane = (client->next_lane + 1) % client->num_lanes;
+    return count;
+}
+
+static int client_submit(ourdemo_client_t *client, uint16_t opcode,
+                         void *buffer, uint64_t offset, uint32_t length,
+                         ourdemo_cb_t cb, void *arg)
+{
+    client_cmd_t *cmd, *chunk;
+    uint32_t     stripe = client->params.stripe_size;
+    uint32_t     block_size = client->info.block_size ? client->info.block_size : 1;
+    uint32_t     chunk_len, done;
+    unsigned     nchunks, i;
+
+    if (client->failed) {
+        return -ECONNRESET;
+    }
+    if ((length == 0) || (length > client->info.max_io_size)) {
+        return -EINVAL;
+    }
+    if (client->outstanding >= client->params.queue_depth) {
+        return -EAGAIN;
+    }
+
+    nchunks = 1;
+    if ((opcode != OURDEMO_OP_INFO) && (stripe > 0) && (length > stripe)) {
+        nchunks = (length + stripe - 1) / stripe;
+    }
+    nchunks = client_pick_lanes(client, nchunks);
+    if (nchunks == 0) {
+        return -EAGAIN;
+    }
+
+    /* Chunks are whole blocks, the last one takes the rest */
+    chunk_len = (length + nchunks - 1) / nchunks;
+    chunk_len = (chunk_len + block_size - 1) / block_size * block_size;
+    nchunks   = (length + chunk_len - 1) / chunk_len;
+
+    /* Make sure every chunk fits before queueing any of them */
+    for (i = 0; i < nchunks; i++) {
+        done = i * chunk_len;
+        if (client_lane_reserve(client->picked[i], opcode, (char*)buffer + done,
+                                (length - done < chunk_len) ?
+                                length - done : chunk_len) == NULL) {
+            return -EAGAIN;
+        }
+    }
+
+    cmd = client_cmd_get(client);
+    if (cmd == NULL) {
+        return -EAGAIN;
+    }
+    cmd->cb     = cb;
+    cmd->arg    = arg;
+    cmd->opcode = opcode;
+    cmd->buffer = buffer;
+    cmd->offset = offset;
+    cmd->length = length;
+    client->outstanding++;
+
+    if (nchunks == 1) {
+        if (client_cmd_send(client->picked[0], cmd) != 0) {
+            client_cmd_put(client, cmd);
+            client->outstanding--;
+            return -EAGAIN;
+        }
+        return 0;
+    }
+
+    /* The command pool has room for a chunk per lane of every I/O */
+    cmd->chunks_left = nchunks;
+    for (i = 0; i < nchunks; i++) {
+        done          = i * chunk_len;
+        chunk         = client_cmd_get(client);
+        chunk->cb     = NULL;
+        chunk->arg    = NULL;
+        chunk->parent = cmd;
+        chunk->opcode = opcode;
+        chunk->buffer = (char*)buffer + done;
+        chunk->offset = offset + done;
+        chunk->length = (length - done < chunk_len) ? length - done : chunk_len;
+        client_cmd_send(client->picked[i], chunk);
+    }
+    return 0;
+}
+
+int ourdemo_client_read(ourdemo_client_t *client, void *buffer, uint64_t offset,
+                        uint32_t length, ourdemo_cb_t cb, void *arg)
+{
+    return client_submit(client, OURDEMO_OP_READ, buffer, offset, length, cb, arg);
+}
+
+int ourdemo_client_write(ourdemo_client_t *client, const void *buffer,
+                         uint64_t offset, uint32_t length, ourdemo_cb_t cb,
+                         void *arg)
+{
+    return client_submit(client, OURDEMO_OP_WRITE, (void*)buffer, offset, length,
+                         cb, arg);
+}
+
+/**
+ * Consume response bytes of a lane. Returns -1 on a protocol error.
+ */
+static int client_parse(client_lane_t *lane, const char *data, size_t length)
+{
+    ourdemo_client_t *client = lane->client;
+    client_cmd_t     *cmd;
+    size_t           chunk;
+    uint32_t         idx;
+
+    while (length > 0) {
+        if (lane->rx_cmd == NULL) {
+            chunk = sizeof(lane->rsp) - lane->rsp_offset;
+            chunk = (chunk < length) ? chunk : length;
+            memcpy((char*)&lane->rsp + lane->rsp_offset, data, chunk);
+            lane->rsp_offset += chunk;
+            data             += chunk;
+            length           -= chunk;
+            if (lane->rsp_offset < sizeof(lane->rsp)) {
+                break;
+            }
+
+            lane->rsp_offset = 0;
+            idx = lane->rsp.id & UINT32_MAX;
+            if ((idx >= client->num_cmds) ||
+                !client->cmds[idx].in_use ||
+                (client->cmds[idx].lane != lane) ||
+                (client->cmds[idx].gen != (lane->rsp.id >> 32)) ||
+                (lane->rsp.length > client->cmds[idx].length)) {
+                fprintf(stderr, "unexpected response id %lu length %u\n",
+                        (unsigned long)lane->rsp.id, lane->rsp.length);
+                return -1;
+            }
+
+            cmd = &client->cmds[idx];
+            if (lane->rsp.length == 0) {
+                client_cmd_complete(client, cmd, lane->rsp.status);
+                continue;
+            }
+            lane->rx_cmd    = cmd;
+            lane->rx_offset = 0;
+        }
+
+        cmd   = lane->rx_cmd;
+        chunk = lane->rsp.length - lane->rx_offset;
+        chunk = (chunk < length) ? chunk : length;
+        memcpy((char*)cmd->buffer + lane->rx_offset, data, chunk);
+        lane->rx_offset += chunk;
+        data            += chunk;
+        length          -= chunk;
+        if (lane->rx_offset == lane->rsp.length) {
+            lane->rx_cmd = NULL;
+            client_cmd_complete(client, cmd, lane->rsp.status);
+        }
+    }
+    return 0;
+}
+
+static void client_lane_recv(client_lane_t *lane)
+{
+    ucs_status_ptr_t data;
+    size_t           length;
+
+    while (!lane->failed && !lane->closed) {
+        data = ucp_stream_recv_data_nb(lane->ep, &length);
+        if (data == NULL) {
+            break;
+        } else if (UCS_PTR_IS_ERR(data)) {
+            fprintf(stderr, "unable to receive responses (%s)\n",
+                    ucs_status_string(UCS_PTR_STATUS(data)));
+            lane->failed = 1;
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &lane->last_active);
+
+        if (client_parse(lane, data, length) != 0) {
+            lane->failed = 1;
+        }
+        ucp_stream_data_release(lane->ep, data);
+    }
+}
+
+/**
+ * Release a failed lane and queue its READ and INFO commands to be sent again
+ * on the other lanes. WRITEs fail instead: the server may still execute the
+ * one it got, e.g. when the lane timed out on a slow server, after a newer
+ * WRITE to the same blocks completed, and bring the old data back.
+ */
+static void client_lane_fail(ourdemo_client_t *client, client_lane_t *lane)
+{
+    int          status = lane->timed_out ? -ETIMEDOUT : -ECONNRESET;
+    client_cmd_t *cmd;
+    void         *close_req;
+    unsigned     i;
+
+    fprintf(stderr, "lane to %s failed with %u commands in flight\n",
+            lane->server_addr, lane->outstanding);
+
+    for (i = 0; i < client->num_cmds; i++) {
+        cmd = &client->cmds[i];
+        if (!cmd->in_use || (cmd->lane != lane)) {
+            continue;
+        }
+
+        cmd->lane = NULL;
+        if (cmd->opcode == OURDEMO_OP_WRITE) {
+            client_cmd_complete(client, cmd, status);
+        } else {
+            cmd->next           = NULL;
+            *client->retry_tail = cmd;
+            client->retry_tail  = &cmd->next;
+        }
+    }
+    lane->outstanding = 0;
+    lane->rx_cmd      = NULL;
+    lane->rsp_offset  = 0;
+    if (lane->cur_batch != NULL) {
+        client_batch_reset(lane->cur_batch);
+        lane->cur_batch = NULL;
+    }
+
+    /* Sends in flight complete with an error, the lane outlives the worker */
+    close_req = ucp_ep_close_nb(lane->ep, UCP_EP_CLOSE_MODE_FORCE);
+    if (UCS_PTR_IS_PTR(close_req)) {
+        ucp_request_free(close_req);
+    }
+    lane->closed = 1;
+
+    if (--client->healthy_lanes == 0) {
+        fprintf(stderr, "no lane left to the server\n");
+        client->failed = 1;
+    }
+}
+
+static void client_resend(ourdemo_client_t *client)
+{
+    client_cmd_t *cmd;
+    unsigned     i;
+
+    while ((cmd = client->retry_head) != NULL) {
+        if ((client_pick_lanes(client, 1) == 0) ||
+            (client_cmd_send(client->picked[0], cmd) != 0)) {
+            break;
+        }
+        client->retry_head = cmd->next;
+        if (client->retry_head == NULL) {
+            client->retry_tail = &client->retry_head;
+        }
+    }
+
+    for (i = 0; i < client->num_lanes; i++) {
+        client_flush_batch(&client->lanes[i]);
+    }
+}
+
+static void client_fail_all(ourdemo_client_t *client)
+{
+    client_cmd_t *cmd;
+    unsigned     i;
+
+    client->retry_head = NULL;
+    client->retry_tail = &client->retry_head;
+    for (i = 0; i < client->num_lanes; i++) {
+        client->lanes[i].rx_cmd = NULL;
+    }
+
+    /* Striped I/Os complete with their last chunk */
+    for (i = 0; i < client->num_cmds; i++) {
+        cmd = &client->cmds[i];
+        if (cmd->in_use && (cmd->chunks_left == 0)) {
+            client_cmd_complete(client, cmd, -ECONNRESET);
+        }
+    }
+}
+
+/**
+ * Fail the lanes whose server stopped answering. Endpoints are created
+ * without peer failure detection, which tcp and shm do not support, so UCX
+ * does not report a server that died or hung.
+ */
+static void client_check_lanes(ourdemo_client_t *client)
+{
+    struct timespec now;
+    client_lane_t   *lane;
+    unsigned        i;
+    int             have_now = 0;
+
+    for (i = 0; i < client->num_lanes; i++) {
+        lane = &client->lanes[i];
+        if (lane->failed || lane->closed || (lane->outstanding == 0)) {
+            continue;
+        }
+
+        if (!have_now) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            have_now = 1;
+        }
+        if (elapsed_ms(&lane->last_active, &now) >
+            (long)client->params.lane_timeout_ms) {
+            fprintf(stderr, "no response on the lane to %s for %u ms\n",
+                    lane->server_addr, client->params.lane_timeout_ms);
+            lane->failed    = 1;
+            lane->timed_out = 1;
+        }
+    }
+}
+
+/**
+ * Give up on the server: fail every lane, which completes the commands left
+ * with an error.
+ */
+static void client_abort(ourdemo_client_t *client)
+{
+    unsigned i;
+
+    for (i = 0; i < client->num_lanes; i++) {
+        if (!client->lanes[i].closed) {
+            client->lanes[i].failed = 1;
+        }
+    }
+    ourdemo_client_progress(client);
+}
+
+unsigned ourdemo_client_progress(ourdemo_client_t *client)
+{
+    client_lane_t *lane;
+    unsigned      completions, i;
+
+    client->completions = 0;
+    for (i = 0; i < client->num_lanes; i++) {
+        client_flush_batch(&client->lanes[i]);
+    }
+    ucp_worker_progress(client->ucp_worker);
+
+    for (i = 0; i < client->num_lanes; i++) {
+        client_lane_recv(&client->lanes[i]);
+    }
+
+    if (client->params.lane_timeout_ms > 0) {
+        client_check_lanes(client);
+    }
+
+    for (i = 0; i < client->num_lanes; i++) {
+        lane = &client->lanes[i];
+        if (lane->failed && !lane->closed) {
+            client_lane_fail(client, lane);
+        }
+    }
+
+    if (client->failed) {
+        if (client->outstanding) {
+            client_fail_all(client);
+        }
+    } else if (client->retry_head != NULL) {
+        client_resend(client);
+    }
+
+    completions         = client->completions;
+    client->completions = 0;
+    return completions;
+}
+
+unsigned ourdemo_client_outstanding(ourdemo_client_t *client)
+{
+    return client->outstanding;
+}
+
+const ourdemo_info_t *ourdemo_client_get_info(ourdemo_client_t *client)
+{
+    return &client->info;
+}
+
+int ourdemo_client_mem_reg(ourdemo_client_t *client, void *buffer, size_t length,
+                           ourdemo_mem_t **mem_p)
+{
+    ucp_mem_map_params_t params;
+    ourdemo_mem_t        *mem;
+    ucs_status_t         status;
+
+    mem = calloc(1, sizeof(*mem));
+    if (mem == NULL) {
+        return -ENOMEM;
+    }
+
+    params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+                        UCP_MEM_MAP_PARAM_FIELD_LENGTH;
+    params.address    = buffer;
+    params.length     = length;
+    status = ucp_mem_map(client->ucp_context, &params, &mem->memh);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to ucp_mem_map (%s)\n", ucs_status_string(status));
+        goto err_free;
+    }
+
+    status = ucp_rkey_pack(client->ucp_context, mem->memh, &mem->rkey_buffer,
+                           &mem->rkey_size);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to ucp_rkey_pack (%s)\n", ucs_status_string(status));
+        goto err_unmap;
+    }
+    if (mem->rkey_size > OURDEMO_MAX_RKEY_SIZE) {
+        fprintf(stderr, "packed rkey of %zu bytes is too large\n", mem->rkey_size);
+        goto err_release;
+    }
+
+    mem->addr     = buffer;
+    mem->length   = length;
+    mem->next     = client->mems;
+    client->mems  = mem;
+    *mem_p        = mem;
+    return 0;
+
+err_release:
+    ucp_rkey_buffer_release(mem->rkey_buffer);
+err_unmap:
+    ucp_mem_unmap(client->ucp_context, mem->memh);
+err_free:
+    free(mem);
+    return -EIO;
+}
+
+void ourdemo_client_mem_dereg(ourdemo_client_t *client, ourdemo_mem_t *mem)
+{
+    ourdemo_mem_t **p;
+
+    for (p = &client->mems; *p != NULL; p = &(*p)->next) {
+        if (*p == mem) {
+            *p = mem->next;
+            break;
+        }
+    }
+
+    ucp_rkey_buffer_release(mem->rkey_buffer);
+    ucp_mem_unmap(client->ucp_context, mem->memh);
+    free(mem);
+}
+
+static int init_context(ourdemo_client_t *client)
+{
+    ucp_params_t        ucp_params;
+    ucp_worker_params_t worker_params;
+    ucs_status_t        status;
+
+    memset(&ucp_params, 0, sizeof(ucp_params));
+    ucp_params.field_mask   = UCP_PARAM_FIELD_FEATURES |
+                              UCP_PARAM_FIELD_REQUEST_SIZE;
+    ucp_params.features     = UCP_FEATURE_STREAM | UCP_FEATURE_RMA;
+    ucp_params.request_size = sizeof(client_req_t);
+    status = ucp_init(&ucp_params, NULL, &client->ucp_context);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to ucp_init (%s)\n", ucs_status_string(status));
+        return -1;
+    }
+
+    memset(&worker_params, 0, sizeof(worker_params));
+    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+    worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+    status = ucp_worker_create(client->ucp_context, &worker_params,
+                               &client->ucp_worker);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to ucp_worker_create (%s)\n", ucs_status_string(status));
+        ucp_cleanup(client->ucp_context);
+        return -1;
+    }
+    return 0;
+}
+
+static int start_lane(ourdemo_client_t *client, client_lane_t *lane)
+{
+    ucp_ep_params_t    ep_params;
+    struct sockaddr_in connect_addr;
+    ucs_status_t       status;
+
+    memset(&connect_addr, 0, sizeof(connect_addr));
+    connect_addr.sin_family      = AF_INET;
+    connect_addr.sin_addr.s_addr = inet_addr(lane->server_addr);
+    connect_addr.sin_port        = htons(client->params.port);
+
+    /* No peer failure mode, tcp and shm do not support it, and without it
+     * UCX never invokes an error handler. Send and receive errors fail the
+     * lane, a server which stops answering is caught by client_check_lanes() */
+    ep_params.field_mask       = UCP_EP_PARAM_FIELD_FLAGS       |
+                                 UCP_EP_PARAM_FIELD_SOCK_ADDR;
+    ep_params.flags            = UCP_EP_PARAMS_FLAGS_CLIENT_SERVER;
+    ep_params.sockaddr.addr    = (struct sockaddr*)&connect_addr;
+    ep_params.sockaddr.addrlen = sizeof(connect_addr);
+
+    status = ucp_ep_create(client->ucp_worker, &ep_params, &lane->ep);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to connect to %s (%s)\n", lane->server_addr,
+                ucs_status_string(status));
+        return -1;
+    }
+    lane->closed = 0;
+    client->healthy_lanes++;
+    return 0;
+}
+
+/**
+ * Open the lanes, spread round robin over the server addresses. All lanes
+ * share the worker of the client, which is progressed by a single thread.
+ */
+static int start_client(ourdemo_client_t *client)
+{
+    const ourdemo_client_params_t *params = &client->params;
+    client_lane_t                 *lane;
+    unsigned                      i;
+
+    for (i = 0; i < client->num_lanes; i++) {
+        lane              = &client->lanes[i];
+        lane->server_addr = (params->num_server_addrs > 0) ?
+                            params->server_addrs[i % params->num_server_addrs] :
+                            params->server_addr;
+        if (start_lane(client, lane) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void info_cb(void *arg, int status)
+{
+    if ((status != 0) && (*(int*)arg == 0)) {
+        *(int*)arg = status;
+    }
+}
+
+/**
+ * Query the device geometry on every lane, which also waits for the
+ * connections to be established.
+ */
+static int client_query_info(ourdemo_client_t *client)
+{
+    struct timespec start;
+    client_cmd_t    *cmd;
+    int             status = 0;
+    unsigned        i;
+
+    /* Allow the INFO response before max_io_size is known */
+    client->info.max_io_size = sizeof(client->info);
+    for (i = 0; i < client->num_lanes; i++) {
+        cmd         = client_cmd_get(client);
+        cmd->cb     = info_cb;
+        cmd->arg    = &status;
+        cmd->opcode = OURDEMO_OP_INFO;
+        cmd->buffer = &client->info;
+        cmd->offset = 0;
+        cmd->length = sizeof(client->info);
+        client->outstanding++;
+        client_cmd_send(&client->lanes[i], cmd);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (client->outstanding > 0) {
+        ourdemo_client_progress(client);
+        if (timed_out(&start, CONNECT_TIMEOUT_SEC)) {
+            fprintf(stderr, "no answer from the server on port %u\n",
+                    client->params.port);
+            /* The commands refer to 'status', complete them before leaving */
+            client_abort(client);
+            return -ETIMEDOUT;
+        }
+    }
+
+    /* A command of a lane which did not come up was answered on another */
+    if ((status == 0) && (client->healthy_lanes < client->num_lanes)) {
+        status = -ECONNREFUSED;
+    }
+    return status;
+}
+
+int ourdemo_client_create(const ourdemo_client_params_t *params,
+                          ourdemo_client_t **client_p)
+{
+    ourdemo_client_t *client;
+    client_lane_t    *lane;
+    unsigned         i, j;
+    int              ret;
+
+    if ((params->queue_depth == 0) || (params->batch_max == 0) ||
+        ((params->num_server_addrs > 0) ? (params->server_addrs == NULL) :
+                                          (params->server_addr == NULL))) {
+        return -EINVAL;
+    }
+
+    client = calloc(1, sizeof(*client));
+    if (client == NULL) {
+        return -ENOMEM;
+    }
+    client->params     = *params;
+    client->num_lanes  = params->num_lanes ? params->num_lanes : 1;
+    client->retry_tail = &client->retry_head;
+
+    /* A striped I/O takes a command and one per chunk, at most one per lane */
+    client->num_cmds = params->queue_depth;
+    if (client->num_lanes > 1) {
+        client->num_cmds *= client->num_lanes + 1;
+    }
+
+    client->cmds   = calloc(client->num_cmds, sizeof(*client->cmds));
+    client->lanes  = calloc(client->num_lanes, sizeof(*client->lanes));
+    client->picked = calloc(client->num_lanes, sizeof(*client->picked));
+    if ((client->cmds == NULL) || (client->lanes == NULL) ||
+        (client->picked == NULL)) {
+        ret = -ENOMEM;
+        goto err_free;
+    }
+    for (i = client->num_cmds; i > 0; i--) {
+        client->cmds[i - 1].next = client->free_cmds;
+        client->free_cmds        = &client->cmds[i - 1];
+    }
+    for (i = 0; i < client->num_lanes; i++) {
+        lane         = &client->lanes[i];
+        lane->client = client;
+        lane->closed = 1;
+        for (j = 0; j < NUM_BATCHES; j++) {
+            lane->batches[j].lane = lane;
+        }
+    }
+
+    if (init_context(client) != 0) {
+        ret = -EIO;
+        goto err_free;
+    }
+
+    if (start_client(client) != 0) {
+        ourdemo_client_destroy(client);
+        return -ECONNREFUSED;
+    }
+
+    ret = client_query_info(client);
+    if (ret != 0) {
+        fprintf(stderr, "failed to query the remote device (%d)\n", ret);
+        ourdemo_client_destroy(client);
+        return ret;
+    }
+
+    *client_p = client;
+    return 0;
+
+err_free:
+    free(client->picked);
+    free(client->lanes);
+    free(client->cmds);
+    free(client);
+    return ret;
+}
+
+static void flush_cb(void *request, ucs_status_t status)
+{
+}
+
+/**
+ * Close the ep of a lane. It is closed gracefully only if everything sent on
+ * it was flushed before the deadline: a server which died without the
+ * transport noticing never acknowledges, and a close in flush mode cannot be
+ * forced once started.
+ */
+static void client_lane_close(ourdemo_client_t *client, client_lane_t *lane,
+                              const struct timespec *start)
+{
+    unsigned     mode = UCP_EP_CLOSE_MODE_FORCE;
+    ucs_status_t status;
+    void         *req;
+
+    if (!lane->failed) {
+        req = ucp_ep_flush_nb(lane->ep, 0, flush_cb);
+        if (UCS_PTR_IS_PTR(req)) {
+            do {
+                ucp_worker_progress(client->ucp_worker);
+                status = ucp_request_check_status(req);
+            } while ((status == UCS_INPROGRESS) &&
+                     !timed_out(start, CLOSE_TIMEOUT_SEC));
+
+            /* A flush left in progress is purged by the forced close */
+            ucp_request_free(req);
+        } else {
+            status = UCS_PTR_STATUS(req);
+        }
+
+        if ((status == UCS_OK) && !lane->failed) {
+            mode = UCP_EP_CLOSE_MODE_FLUSH;
+        } else {
+            fprintf(stderr, "lane to %s was not flushed, closing it forcibly\n",
+                    lane->server_addr);
+        }
+    }
+
+    req = ucp_ep_close_nb(lane->ep, mode);
+    if (UCS_PTR_IS_PTR(req)) {
+        do {
+            ucp_worker_progress(client->ucp_worker);
+            status = ucp_request_check_status(req);
+        } while (status == UCS_INPROGRESS);
+
+        ucp_request_free(req);
+    } else if (UCS_PTR_STATUS(req) != UCS_OK) {
+        fprintf(stderr, "failed to close ep %p\n", (void*)lane->ep);
+    }
+    lane->closed = 1;
+}
+
+void ourdemo_client_destroy(ourdemo_client_t *client)
+{
+    struct timespec start;
+    ourdemo_cmd_t   hdr;
+    client_lane_t   *lane;
+    client_batch_t  *batch;
+    unsigned        i;
+
+    /* The server gets CLOSE_TIMEOUT_SEC to answer and drain the lanes, then
+     * the commands left fail and the lanes are closed forcibly */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (client->outstanding > 0) {
+        if (timed_out(&start, CLOSE_TIMEOUT_SEC)) {
+            fprintf(stderr, "%u commands were not answered by the server\n",
+                    client->outstanding);
+            client_abort(client);
+            break;
+        }
+        ourdemo_client_progress(client);
+    }
+
+    /* Let the server release the connections, it does not answer */
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.opcode = OURDEMO_OP_DISCONNECT;
+    for (i = 0; i < client->num_lanes; i++) {
+        lane = &client->lanes[i];
+        while (!lane->failed && !lane->closed &&
+               !timed_out(&start, CLOSE_TIMEOUT_SEC)) {
+            batch = client_batch_reserve(lane, sizeof(hdr), 0);
+            if (batch != NULL) {
+                client_batch_append(batch, &hdr, sizeof(hdr), 1);
+                batch->ncmds++;
+                client_flush_batch(lane);
+                break;
+            }
+            ourdemo_client_progress(client);
+        }
+    }
+
+    for (i = 0; i < client->num_lanes; i++) {
+        lane = &client->lanes[i];
+        while (!lane->failed && !lane->closed && (lane->batches_in_flight > 0) &&
+               !timed_out(&start, CLOSE_TIMEOUT_SEC)) {
+            ucp_worker_progress(client->ucp_worker);
+        }
+        if (!lane->closed) {
+            client_lane_close(client, lane, &start);
+        }
+    }
+
+    /* Lanes are released last, a forced close may still complete sends */
+    ucp_worker_destroy(client->ucp_worker);
+    ucp_cleanup(client->ucp_context);
+    free(client->picked);
+    free(client->lanes);
+    free(client->cmds);
+    free(client);
+}
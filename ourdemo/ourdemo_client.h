@@ -0,0 +1,116 @@
+#ifndef OURDEMO_CLIENT_H_
+#define OURDEMO_CLIENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ourdemo.h"
+
+/*
+ * Asynchronous client for the ourdemo block server.
+ *
+ * Up to 'queue_depth' commands may be outstanding on a client. Commands are
+ * not sent right away: they are gathered and go out together, as a single
+ * stream send, on the next ourdemo_client_progress() call or when the batch
+ * fills up. Completion callbacks are only invoked from
+ * ourdemo_client_progress(), never from a submit call.
+ *
+ * A client may open several endpoints ("lanes") to the server, possibly to
+ * different addresses of it. Commands go to the least loaded lane, and I/Os
+ * larger than 'stripe_size' are split into chunks sent in parallel on
+ * several lanes, the payload of every chunk landing at its place in the
+ * user buffer. When a lane fails, its READs are sent again on the remaining
+ * ones and only fail once no lane is left. Its WRITEs are never sent again
+ * and fail right away, since the server may still execute them later and
+ * overwrite newer data; a striped WRITE fails if any of its chunks does. A
+ * lane also fails when it has commands in flight and nothing arrived on it
+ * for 'lane_timeout_ms' since the last send, which is how a server that
+ * stopped answering is detected.
+ *
+ * A client is not thread safe, use one per thread.
+ */
+
+#define OURDEMO_CLIENT_DEFAULT_QD         32
+#define OURDEMO_CLIENT_DEFAULT_BATCH      16
+#define OURDEMO_CLIENT_DEFAULT_RMA_THRESH 8192
+#define OURDEMO_CLIENT_DEFAULT_STRIPE     65536
+#define OURDEMO_CLIENT_DEFAULT_LANE_TMO   10000
+
+typedef struct ourdemo_client ourdemo_client_t;
+typedef struct ourdemo_mem    ourdemo_mem_t;
+
+/**
+ * Completion callback. 'status' is 0 or a negative errno, either returned by
+ * the server, -ECONNRESET when the connection failed or -ETIMEDOUT for a
+ * WRITE whose lane stopped answering. A failed WRITE may or may not have
+ * reached the device.
+ */
+typedef void (*ourdemo_cb_t)(void *arg, int status);
+
+typedef struct ourdemo_client_params {
+    const char *server_addr;
+    const char *const *server_addrs; /* optional, lanes are spread over these
+                                        addresses instead of server_addr */
+    unsigned   num_server_addrs;
+    uint16_t   port;
+    unsigned   queue_depth;  /* max outstanding commands */
+    unsigned   batch_max;    /* max commands coalesced into one send, 1 disables */
+    long       rma_thresh;   /* I/Os of at least this size in registered memory
+                                use RMA, negative disables RMA */
+    unsigned   num_lanes;    /* endpoints opened to the server */
+    unsigned   lane_depth;   /* max commands in flight on one lane, 0 is
+                                queue_depth */
+    uint32_t   stripe_size;  /* larger I/Os are split over the lanes in chunks
+                                of about this size, 0 disables */
+    unsigned   lane_timeout_ms; /* a busy lane with no response for this long
+                                   is failed, 0 disables */
+} ourdemo_client_params_t;
+
+void ourdemo_client_params_init(ourdemo_client_params_t *params);
+
+/**
+ * Connect all lanes to the server and query the device geometry. Blocks
+ * until the server answered on every lane.
+ */
+int ourdemo_client_create(const ourdemo_client_params_t *params,
+                          ourdemo_client_t **client_p);
+
+/**
+ * Tell the server to disconnect, wait for outstanding commands and release
+ * the client. Memory registered on the client must be released before.
+ */
+void ourdemo_client_destroy(ourdemo_client_t *client);
+
+const ourdemo_info_t *ourdemo_client_get_info(ourdemo_client_t *client);
+
+/**
+ * Register a buffer so that I/Os inside it can be served with RMA.
+ */
+int ourdemo_client_mem_reg(ourdemo_client_t *client, void *buffer, size_t length,
+                           ourdemo_mem_t **mem_p);
+void ourdemo_client_mem_dereg(ourdemo_client_t *client, ourdemo_mem_t *mem);
+
+/**
+ * Queue a read or a write. Returns 0 when queued, -EAGAIN when 'queue_depth'
+ * commands are already outstanding and a negative errno on failure, -EINVAL
+ * for an empty I/O. The buffer must stay valid until the callback was
+ * invoked.
+ */
+int ourdemo_client_read(ourdemo_client_t *client, void *buffer, uint64_t offset,
+                        uint32_t length, ourdemo_cb_t cb, void *arg);
+int ourdemo_client_write(ourdemo_client_t *client, const void *buffer,
+                         uint64_t offset, uint32_t length, ourdemo_cb_t cb,
+                         void *arg);
+
+/**
+ * Send queued commands, progress the connection and invoke the callbacks of
+ * completed commands. Returns the number of completions.
+ */
+unsigned ourdemo_client_progress(ourdemo_client_t *client);
+
+/**
+ * Number of commands submitted and not completed yet.
+ */
+unsigned ourdemo_client_outstanding(ourdemo_client_t *client);
+
+#endif
@@ -1,370 +1,1412 @@
-#include <ucp/api/ucp.h>
-#include <string.h>    /* memset */
-#include <arpa/inet.h> /* inet_addr */
-#include <unistd.h>    /* getopt */
-#include <stdlib.h>    /* atoi */
-
-#define TEST_STRING_LEN        sizeof(test_message)
-#define DEFAULT_PORT           13337
-#define IP_STRING_LEN          50
-#define PORT_STRING_LEN        8
-#define TAG                    0xCAFE
-#define COMM_TYPE_DEFAULT      "STREAM"
-#define PRINT_INTERVAL         2000
-#define DEFAULT_NUM_ITERATIONS 1
-
-const  char test_message[]           = "UCX Client-Server Hello World";
-static uint16_t server_port          = DEFAULT_PORT;
-static int num_iterations            = DEFAULT_NUM_ITERATIONS;
-
-typedef enum {
-    CLIENT_SERVER_SEND_RECV_STREAM  = UCS_BIT(0),
-    CLIENT_SERVER_SEND_RECV_TAG     = UCS_BIT(1),
-    CLIENT_SERVER_SEND_RECV_DEFAULT = CLIENT_SERVER_SEND_RECV_STREAM
-} send_recv_type_t;
-
-typedef struct ucx_server_ctx {
-    volatile ucp_conn_request_h conn_request;
-    ucp_listener_h              listener;
-} ucx_server_ctx_t;
-
-typedef struct test_req {
-    int complete;
-} test_req_t;
-
-
-static void usage(void);
-
-static void tag_recv_cb(void *request, ucs_status_t status,
-                        const ucp_tag_recv_info_t *info, void *user_data)
-{
-    test_req_t *ctx = user_data;
-    ctx->complete = 1;
-}
-
-static void stream_recv_cb(void *request, ucs_status_t status, size_t length)
-{
-    test_req_t *req = request;
-    req->complete = 1;
-}
-
-static void send_cb(void *request, ucs_status_t status)
-{
-    test_req_t *req = request;
-    req->complete = 1;
-}
-
-static void err_cb(void *arg, ucp_ep_h ep, ucs_status_t status)
-{
-    printf("error handling callback was invoked with status %d (%s)\n",
-           status, ucs_status_string(status));
-}
-
-typedef struct
-{
-    ucp_worker_h ucp_data_worker;
-    ucp_ep_h server_ep;
-} mire_struct;
-
-static char* sockaddr_get_ip_str(const struct sockaddr_storage *sock_addr,
-                                 char *ip_str, size_t max_size)
-{
-    struct sockaddr_in  addr_in;
-    struct sockaddr_in6 addr_in6;
-
-    switch (sock_addr->ss_family) {
-    case AF_INET:
-        memcpy(&addr_in, sock_addr, sizeof(struct sockaddr_in));
-        inet_ntop(AF_INET, &addr_in.sin_addr, ip_str, max_size);
-        return ip_str;
-    case AF_INET6:
-        memcpy(&addr_in6, sock_addr, sizeof(struct sockaddr_in6));
-        inet_ntop(AF_INET6, &addr_in6.sin6_addr, ip_str, max_size);
-        return ip_str;
-    default:
-        return "Invalid address family";
-    }
-}
-
-static char* sockaddr_get_port_str(const struct sockaddr_storage *sock_addr,
-                                   char *port_str, size_t max_size)
-{
-    struct sockaddr_in  addr_in;
-    struct sockaddr_in6 addr_in6;
-
-    switch (sock_addr->ss_family) {
-    case AF_INET:
-        memcpy(&addr_in, sock_addr, sizeof(struct sockaddr_in));
-        snprintf(port_str, max_size, "%d", ntohs(addr_in.sin_port));
-        return port_str;
-    case AF_INET6:
-        memcpy(&addr_in6, sock_addr, sizeof(struct sockaddr_in6));
-        snprintf(port_str, max_size, "%d", ntohs(addr_in6.sin6_port));
-        return port_str;
-    default:
-        return "Invalid address family";
-    }
-}
-
-static int init_worker(ucp_context_h ucp_context, ucp_worker_h *ucp_worker)
-{
-    ucp_worker_params_t worker_params;
-    ucs_status_t status;
-    int ret = 0;
-    memset(&worker_params, 0, sizeof(worker_params));
-    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
-    worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
-    status = ucp_worker_create(ucp_context, &worker_params, ucp_worker);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to ucp_worker_create (%s)\n", ucs_status_string(status));
-        ret = -1;
-    }
-    return ret;
-}
-
-static void request_init(void *request)
-{
-    test_req_t *req = request;
-    req->complete = 0;
-}
-
-static int init_context(ucp_context_h *ucp_context, ucp_worker_h *ucp_worker)
-{
-    /* UCP objects */
-    ucp_params_t ucp_params;
-    ucs_status_t status;
-    int ret = 0;
-    memset(&ucp_params, 0, sizeof(ucp_params));
-    /* UCP initialization */
-    ucp_params.field_mask   = UCP_PARAM_FIELD_FEATURES     |
-                              UCP_PARAM_FIELD_REQUEST_SIZE |
-                              UCP_PARAM_FIELD_REQUEST_INIT;
-    ucp_params.features     = UCP_FEATURE_STREAM | UCP_FEATURE_TAG;
-    ucp_params.request_size = sizeof(test_req_t);
-    ucp_params.request_init = request_init;
-    status = ucp_init(&ucp_params, NULL, ucp_context);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to ucp_init (%s)\n", ucs_status_string(status));
-        ret = -1;
-        goto err;
-    }
-    ret = init_worker(*ucp_context, ucp_worker);
-    if (ret != 0) {
-        goto err_cleanup;
-    }
-    return ret;
-err_cleanup:
-    ucp_cleanup(*ucp_context);
-err:
-    printf("GG!\n");
-    return ret;
-}
-
-void set_listen_addr(const char *address_str, struct sockaddr_in *listen_addr)
-{
-    /* The server will listen on INADDR_ANY */
-    memset(listen_addr, 0, sizeof(struct sockaddr_in));
-    listen_addr->sin_family      = AF_INET;
-    listen_addr->sin_addr.s_addr = (address_str) ? inet_addr(address_str) : INADDR_ANY;
-    listen_addr->sin_port        = htons(server_port);
-}
-
-static void server_conn_handle_cb(ucp_conn_request_h conn_request, void *arg)
-{
-    ucx_server_ctx_t *context = arg;
-    ucs_status_t status;
-
-    if (context->conn_request == NULL) {
-        context->conn_request = conn_request;
-    } else {
-        /* The server is already handling a connection request from a client,
-         * reject this new one */
-        printf("Rejecting a connection request. "
-               "Only one client at a time is supported.\n");
-        status = ucp_listener_reject(context->listener, conn_request);
-        if (status != UCS_OK) {
-            fprintf(stderr, "server failed to reject a connection request: (%s)\n",
-                    ucs_status_string(status));
-        }
-    }
-}
-
-static ucs_status_t server_create_ep(ucp_worker_h data_worker,
-                                     ucp_conn_request_h conn_request,
-                                     ucp_ep_h *server_ep)
-{
-    ucp_ep_params_t ep_params;
-    ucs_status_t    status;
-    /* Server creates an ep to the client on the data worker.
-     * This is not the worker the listener was created on.
-     * The client side should have initiated the connection, leading
-     * to this ep's creation */
-    ep_params.field_mask      = UCP_EP_PARAM_FIELD_ERR_HANDLER |
-                                UCP_EP_PARAM_FIELD_CONN_REQUEST;
-    ep_params.conn_request    = conn_request;
-    ep_params.err_handler.cb  = err_cb;
-    ep_params.err_handler.arg = NULL;
-    status = ucp_ep_create(data_worker, &ep_params, server_ep);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to create an endpoint on the server: (%s)\n",
-                ucs_status_string(status));
-    }
-    return status;
-}
-
-static ucs_status_t server_listen(ucp_worker_h ucp_worker,
-                                 ucx_server_ctx_t *context,
-                                 ucp_listener_h *listener_p, const char *ip)
-{
-    struct sockaddr_in listen_addr;
-    ucp_listener_params_t params;
-    ucp_listener_attr_t attr;
-    ucs_status_t status;
-    char ip_str[IP_STRING_LEN];
-    char port_str[PORT_STRING_LEN];
-    set_listen_addr(ip, &listen_addr);
-    params.field_mask         = UCP_LISTENER_PARAM_FIELD_SOCK_ADDR |
-                                UCP_LISTENER_PARAM_FIELD_CONN_HANDLER;
-    params.sockaddr.addr      = (const struct sockaddr*)&listen_addr;
-    params.sockaddr.addrlen   = sizeof(listen_addr);
-    params.conn_handler.cb    = server_conn_handle_cb;
-    params.conn_handler.arg   = context;
-    /* Create a listener on the server side to listen on the given address.*/
-    status = ucp_listener_create(ucp_worker, &params, listener_p);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to listen (%s)\n", ucs_status_string(status));
-        goto out;
-    }
-    /* Query the created listener to get the port it is listening on. */
-    attr.field_mask = UCP_LISTENER_ATTR_FIELD_SOCKADDR;
-    status = ucp_listener_query(*listener_p, &attr);
-    if (status != UCS_OK) {
-        fprintf(stderr, "failed to query the listener (%s)\n",
-                ucs_status_string(status));
-        ucp_listener_destroy(*listener_p);
-        goto out;
-    }
-    fprintf(stderr, "server is listening on IP %s port %s\n",
-            sockaddr_get_ip_str(&attr.sockaddr, ip_str, IP_STRING_LEN),
-            sockaddr_get_port_str(&attr.sockaddr, port_str, PORT_STRING_LEN));
-
-    printf("Waiting for connection...\n");
-out:
-    return status;
-}
-
-mire_struct start_server(const char* listen_addr)
-{
-    mire_struct mire;
-    ucs_status_t     status;
-    ucx_server_ctx_t context;
-    ucp_listener_attr_t attr;
-    send_recv_type_t send_recv_type = CLIENT_SERVER_SEND_RECV_DEFAULT;
-    char *server_addr = NULL;
-    ucp_context_h ucp_context;
-    ucp_worker_h  ucp_worker;
-    ucp_worker_h  ucp_data_worker;
-    ucp_ep_h         server_ep;
-    int ret = init_context(&ucp_context, &ucp_worker);
-    ret = init_worker(ucp_context, &ucp_data_worker);
-    context.conn_request = NULL;
-
-    status = server_listen(ucp_worker, &context, &context.listener, listen_addr);
-
-    // ucp_listener_params_t params;
-    // params.field_mask         = UCP_LISTENER_PARAM_FIELD_SOCK_ADDR |
-    //                             UCP_LISTENER_PARAM_FIELD_CONN_HANDLER;
-    // params.sockaddr.addr      = (const struct sockaddr*)&listen_addr;
-    // params.sockaddr.addrlen   = sizeof(listen_addr);
-    // params.conn_handler.cb    = server_conn_handle_cb;
-    // params.conn_handler.arg   = context;
-
-    // status = ucp_listener_create(ucp_worker, &params, listener_p);
-    if (status != UCS_OK) {
-        printf("mire gg!\n");
-        goto err;
-    }
-    // attr.field_mask = UCP_LISTENER_ATTR_FIELD_SOCKADDR;
-    // status = ucp_listener_query(*listener_p, &attr);
-    // fprintf(stderr, "server is listening on IP %s port %s\n",
-    //         sockaddr_get_ip_str(&attr.sockaddr, ip_str, IP_STRING_LEN),
-    //         sockaddr_get_port_str(&attr.sockaddr, port_str, PORT_STRING_LEN));
-    // printf("Waiting for connection...\n");
-
-    while (context.conn_request == NULL) {
-        ucp_worker_progress(ucp_worker);
-    }
-    status = server_create_ep(ucp_data_worker, context.conn_request,
-                                  &server_ep);
-    //ret = client_server_do_work(ucp_data_worker, server_ep, send_recv_type, 1);
-    mire.ucp_data_worker = ucp_data_worker;
-    mire.server_ep = server_ep;
-    return mire;
-
-err_ep:
-    ep_close(ucp_data_worker, server_ep);
-err_listener:
-    ucp_listener_destroy(context.listener);
-err_worker:
-    ucp_worker_destroy(ucp_data_worker);
-err:
-    printf("ggle\n!");
-    return mire;
-}
-
-static ucs_status_t request_wait(ucp_worker_h ucp_worker, test_req_t *request){
-    ucs_status_t status;
-    /* if operation was completed immediately */
-    if (request == NULL) {
-        return UCS_OK;
-    }
-    while (request->complete == 0) {
-        ucp_worker_progress(ucp_worker);
-    }
-    status = ucp_request_check_status(request);
-    /* This request may be reused so initialize it for next time */
-    request->complete = 0;
-    ucp_request_free(request);
-    return status;
-}
-
-static int send_recv_stream(ucp_worker_h ucp_worker, ucp_ep_h ep, void* buffer, int comm_size, int t)
-
-{
-    test_req_t *request;
-    size_t length;
-    if (!t) {
-        /* Client sends a message to the server using the stream API */
-        request = ucp_stream_send_nb(ep, buffer, 1,
-                                     ucp_dt_make_contig(comm_size),
-                                     send_cb, 0);
-    } else {
-        /* Server receives a message from the client using the stream API */
-        request = ucp_stream_recv_nb(ep, buffer, 1,
-                                     ucp_dt_make_contig(comm_size),
-                                     stream_recv_cb, &length,
-                                     UCP_STREAM_RECV_FLAG_WAITALL);
-    }
-    printf("waiting\n");
-    request_wait(ucp_worker, request);
-    printf("Done waiting\n");
-    printf("%d\n", length);
-    return 0;
-}
-
-//0 send 1 recv
-int server_send_recv(mire_struct mire_t, void* buffer, int comm_size, int t)
-{
-    send_recv_stream(mire_t.ucp_data_worker, mire_t.server_ep, buffer, comm_size, t);
-}
-
-int main()
-{
-    char buffer[100];
-    int comm_size = 100;
-    mire_struct mire = start_server(NULL); //start_client()
-    printf("shoudaola!\n");
-    server_send_recv(mire, buffer, comm_size, 1); //client_send()
-    printf("%s\n", buffer);
-}
-
+#include "spdk/stdinc.h"
+#include "spdk/bdev.h"
+#include "spdk/env.h"
+#include "spdk/event.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+
+#include <sys/epoll.h>
+
+#include <ucp/api/ucp.h>
+
+#include "ourdemo.h"
+
+#define IP_STRING_LEN          50
+#define PORT_STRING_LEN        8
+#define IO_BUF_ALIGN           0x1000
+#define RKEY_CACHE_SIZE        4
+#define DEFAULT_MAX_SLEEP_MS   1
+
+typedef enum {
+    SERVER_POLICY_ROUND_ROBIN,
+    SERVER_POLICY_LEAST_LOADED
+} server_policy_t;
+
+static const char *bdev_name         = "Malloc0";
+static const char *listen_addr_str   = NULL;
+static uint16_t server_port          = OURDEMO_DEFAULT_PORT;
+static server_policy_t server_policy = SERVER_POLICY_LEAST_LOADED;
+static uint64_t idle_usec            = 0;   /* 0: always poll */
+static int max_sleep_ms              = DEFAULT_MAX_SLEEP_MS;
+
+typedef struct server_worker server_worker_t;
+typedef struct server_conn   server_conn_t;
+typedef struct server_io     server_io_t;
+typedef struct server_req    server_req_t;
+
+/**
+ * Unpacked remote key of a client buffer. A connection keeps the last few of
+ * them, clients usually register one region and send the same packed key
+ * with every command.
+ */
+typedef struct server_rkey {
+    ucp_rkey_h                  rkey;
+    unsigned                    refs;
+    int                         cached;
+    uint32_t                    packed_length;
+    char                        packed[OURDEMO_MAX_RKEY_SIZE];
+} server_rkey_t;
+
+/**
+ * One UCP data worker per SPDK reactor. The worker, its bdev channel and all
+ * the connections accepted on it are only touched from 'thread'.
+ */
+struct server_worker {
+    uint32_t                    index;
+    struct spdk_thread          *thread;
+    ucp_worker_h                ucp_worker;
+    struct spdk_io_channel      *ch;
+    struct spdk_poller          *poller;
+    TAILQ_HEAD(, server_conn)   conns;
+    uint32_t                    num_closing;
+    uint32_t                    num_ios;    /* I/Os not completed yet */
+    int                         stopping;
+    /* Updated by the worker thread, read by the listener to balance load */
+    uint32_t                    num_conns;
+
+    /* Adaptive polling, see server_worker_idle() */
+    int                         epfd;       /* -1 when always polling */
+    uint64_t                    start_tsc;
+    uint64_t                    last_busy_tsc;
+    uint64_t                    num_sleeps;
+    uint64_t                    num_wakeups;
+    uint64_t                    sleep_tsc;
+    uint64_t                    wakeup_tsc;
+    uint64_t                    max_wakeup_tsc;
+};
+
+struct server_conn {
+    server_worker_t             *worker;
+    ucp_ep_h                    ep;
+    ourdemo_cmd_t               cmd;        /* command header being received */
+    unsigned                    refs;       /* ep + posted requests + ios */
+    int                         closing;
+    void                        *close_req;
+    TAILQ_HEAD(, server_req)    recvs;      /* posted stream receives */
+    server_rkey_t               rkeys[RKEY_CACHE_SIZE];
+    unsigned                    rkey_victim;
+    TAILQ_ENTRY(server_conn)    link;
+};
+
+struct server_io {
+    server_conn_t               *conn;
+    ourdemo_cmd_t               cmd;
+    ourdemo_rsp_t               rsp;
+    ourdemo_info_t              info;
+    void                        *buf;
+    char                        *packed_rkey;  /* received with the command */
+    server_rkey_t               *rkey;
+    ucp_dt_iov_t                iov[2];
+    struct spdk_bdev_io_wait_entry bdev_io_wait;
+};
+
+/**
+ * Private area of every UCP request. Filled in after the _nb call returned
+ * a request, UCP never invokes the callback before that. Both pointers are
+ * cleared when a receive is abandoned at close.
+ */
+struct server_req {
+    server_conn_t               *conn;
+    server_io_t                 *io;
+    TAILQ_ENTRY(server_req)     link;
+};
+
+typedef struct server_accept_ctx {
+    server_worker_t             *worker;
+    ucp_conn_request_h          conn_request;
+} server_accept_ctx_t;
+
+static struct {
+    struct spdk_thread          *main_thread;
+    struct spdk_bdev            *bdev;
+    struct spdk_bdev_desc       *desc;
+    ucp_context_h               ucp_context;
+    ucp_worker_h                listen_worker;
+    ucp_listener_h              listener;
+    struct spdk_poller          *listen_poller;
+    server_worker_t             *workers;
+    uint32_t                    num_workers;
+    uint32_t                    num_running;
+    uint32_t                    next_worker;
+    int                         stopping;
+} g_server;
+
+static void server_conn_recv_cmd(server_conn_t *conn);
+static void server_io_send_rsp(server_io_t *io);
+static void server_io_free(server_io_t *io);
+static void server_io_submit(void *arg);
+
+static char* sockaddr_get_ip_str(const struct sockaddr_storage *sock_addr,
+                                 char *ip_str, size_t max_size)
+{
+    struct sockaddr_in  addr_in;
+    struct sockaddr_in6 addr_in6;
+
+    switch (sock_addr->ss_family) {
+    case AF_INET:
+        memcpy(&addr_in, sock_addr, sizeof(struct sockaddr_in));
+        inet_ntop(AF_INET, &addr_in.sin_addr, ip_str, max_size);
+        return ip_str;
+    case AF_INET6:
+        memcpy(&addr_in6, sock_addr, sizeof(struct sockaddr_in6));
+        inet_ntop(AF_INET6, &addr_in6.sin6_addr, ip_str, max_size);
+        return ip_str;
+    default:
+        return "Invalid address family";
+    }
+}
+
+static char* sockaddr_get_port_str(const struct sockaddr_storage *sock_addr,
+                                   char *port_str, size_t max_size)
+{
+    struct sockaddr_in  addr_in;
+    struct sockaddr_in6 addr_in6;
+
+    switch (sock_addr->ss_family) {
+    case AF_INET:
+        memcpy(&addr_in, sock_addr, sizeof(struct sockaddr_in));
+        snprintf(port_str, max_size, "%d", ntohs(addr_in.sin_port));
+        return port_str;
+    case AF_INET6:
+        memcpy(&addr_in6, sock_addr, sizeof(struct sockaddr_in6));
+        snprintf(port_str, max_size, "%d", ntohs(addr_in6.sin6_port));
+        return port_str;
+    default:
+        return "Invalid address family";
+    }
+}
+
+static int init_worker(ucp_context_h ucp_context, ucp_worker_h *ucp_worker)
+{
+    ucp_worker_params_t worker_params;
+    ucs_status_t status;
+    int ret = 0;
+
+    memset(&worker_params, 0, sizeof(worker_params));
+    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+    worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+    status = ucp_worker_create(ucp_context, &worker_params, ucp_worker);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to ucp_worker_create (%s)\n", ucs_status_string(status));
+        ret = -1;
+    }
+    return ret;
+}
+
+static int init_context(ucp_context_h *ucp_context, ucp_worker_h *ucp_worker)
+{
+    ucp_params_t ucp_params;
+    ucs_status_t status;
+    int ret = 0;
+
+    memset(&ucp_params, 0, sizeof(ucp_params));
+    /* Data workers live on different reactors but share the context */
+    ucp_params.field_mask        = UCP_PARAM_FIELD_FEATURES     |
+                                   UCP_PARAM_FIELD_REQUEST_SIZE |
+                                   UCP_PARAM_FIELD_MT_WORKERS_SHARED;
+    ucp_params.features          = UCP_FEATURE_STREAM | UCP_FEATURE_RMA;
+    if (idle_usec > 0) {
+        ucp_params.features     |= UCP_FEATURE_WAKEUP;
+    }
+    ucp_params.request_size      = sizeof(server_req_t);
+    ucp_params.mt_workers_shared = 1;
+    status = ucp_init(&ucp_params, NULL, ucp_context);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to ucp_init (%s)\n", ucs_status_string(status));
+        ret = -1;
+        goto err;
+    }
+    ret = init_worker(*ucp_context, ucp_worker);
+    if (ret != 0) {
+        goto err_cleanup;
+    }
+    return ret;
+err_cleanup:
+    ucp_cleanup(*ucp_context);
+err:
+    return ret;
+}
+
+static void set_listen_addr(const char *address_str, struct sockaddr_in *listen_addr)
+{
+    /* The server will listen on INADDR_ANY */
+    memset(listen_addr, 0, sizeof(struct sockaddr_in));
+    listen_addr->sin_family      = AF_INET;
+    listen_addr->sin_addr.s_addr = (address_str) ? inet_addr(address_str) : INADDR_ANY;
+    listen_addr->sin_port        = htons(server_port);
+}
+
+/**
+ * Drop a reference to the connection, freeing it once the endpoint is
+ * closed and no request or bdev I/O refers to it anymore.
+ */
+static void server_conn_put(server_conn_t *conn)
+{
+    server_worker_t *worker = conn->worker;
+    unsigned        i;
+
+    assert(conn->refs > 0);
+    if (--conn->refs > 0) {
+        return;
+    }
+
+    for (i = 0; i < RKEY_CACHE_SIZE; i++) {
+        if (conn->rkeys[i].rkey != NULL) {
+            ucp_rkey_destroy(conn->rkeys[i].rkey);
+        }
+    }
+
+    TAILQ_REMOVE(&worker->conns, conn, link);
+    __atomic_sub_fetch(&worker->num_conns, 1, __ATOMIC_RELAXED);
+    free(conn);
+}
+
+/**
+ * Find or unpack the remote key a command was sent with. Cache entries in use
+ * by other I/Os are never evicted, when all of them are busy the key is
+ * unpacked just for this I/O.
+ */
+static server_rkey_t *server_conn_get_rkey(server_conn_t *conn,
+                                           const char *packed, uint32_t length)
+{
+    server_rkey_t *rkey = NULL;
+    ucs_status_t  status;
+    unsigned      i, idx;
+
+    for (i = 0; i < RKEY_CACHE_SIZE; i++) {
+        rkey = &conn->rkeys[i];
+        if ((rkey->rkey != NULL) && (rkey->packed_length == length) &&
+            !memcmp(rkey->packed, packed, length)) {
+            rkey->refs++;
+            return rkey;
+        }
+    }
+
+    rkey = NULL;
+    for (i = 0; i < RKEY_CACHE_SIZE; i++) {
+        idx = (conn->rkey_victim + i) % RKEY_CACHE_SIZE;
+        if (conn->rkeys[idx].refs == 0) {
+            rkey = &conn->rkeys[idx];
+            conn->rkey_victim = idx + 1;
+            break;
+        }
+    }
+
+    if (rkey != NULL) {
+        if (rkey->rkey != NULL) {
+            ucp_rkey_destroy(rkey->rkey);
+            rkey->rkey = NULL;
+        }
+        rkey->cached = 1;
+    } else {
+        rkey = malloc(sizeof(*rkey));
+        if (rkey == NULL) {
+            return NULL;
+        }
+        rkey->cached = 0;
+    }
+
+    status = ucp_ep_rkey_unpack(conn->ep, packed, &rkey->rkey);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to unpack rkey (%s)\n", ucs_status_string(status));
+        rkey->rkey = NULL;
+        if (!rkey->cached) {
+            free(rkey);
+        }
+        return NULL;
+    }
+
+    memcpy(rkey->packed, packed, length);
+    rkey->packed_length = length;
+    rkey->refs          = 1;
+    return rkey;
+}
+
+static void server_conn_put_rkey(server_rkey_t *rkey)
+{
+    if ((--rkey->refs == 0) && !rkey->cached) {
+        ucp_rkey_destroy(rkey->rkey);
+        free(rkey);
+    }
+}
+
+/**
+ * The endpoint is closed. UCP does not complete stream receives still posted
+ * on it, so drop what they hold here and leave the requests to be released
+ * by UCP, should they ever complete.
+ */
+static void server_conn_closed(server_conn_t *conn)
+{
+    server_req_t *req;
+
+    conn->refs++;
+    while ((req = TAILQ_FIRST(&conn->recvs)) != NULL) {
+        TAILQ_REMOVE(&conn->recvs, req, link);
+        if (req->io != NULL) {
+            server_io_free(req->io);
+        } else {
+            server_conn_put(conn);
+        }
+        req->conn = NULL;
+        req->io   = NULL;
+        ucp_request_free(req);
+    }
+
+    /* Once for the endpoint and once for the loop */
+    server_conn_put(conn);
+    server_conn_put(conn);
+}
+
+/**
+ * Start closing the endpoint without blocking the reactor. The close request
+ * is reaped by the worker poller.
+ */
+static void server_conn_close(server_conn_t *conn, unsigned mode)
+{
+    void *close_req;
+
+    if (conn->closing) {
+        return;
+    }
+    conn->closing = 1;
+
+    /* May cancel posted stream receives, their callbacks see 'closing' */
+    close_req = ucp_ep_close_nb(conn->ep, mode);
+    if ((mode == UCP_EP_CLOSE_MODE_FORCE) &&
+        (UCS_PTR_STATUS(close_req) == UCS_ERR_INVALID_PARAM)) {
+        /* Forced close needs peer failure mode, which tcp and shm lack */
+        close_req = ucp_ep_close_nb(conn->ep, UCP_EP_CLOSE_MODE_FLUSH);
+    }
+    if (UCS_PTR_IS_PTR(close_req)) {
+        conn->close_req = close_req;
+        conn->worker->num_closing++;
+        return;
+    }
+
+    if (UCS_PTR_STATUS(close_req) != UCS_OK) {
+        fprintf(stderr, "failed to close ep %p (%s)\n", (void*)conn->ep,
+                ucs_status_string(UCS_PTR_STATUS(close_req)));
+    }
+    server_conn_closed(conn);
+}
+
+static void err_cb(void *arg, ucp_ep_h ep, ucs_status_t status)
+{
+    server_conn_t *conn = arg;
+
+    fprintf(stderr, "error handling callback was invoked with status %d (%s)\n",
+            status, ucs_status_string(status));
+    server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+}
+
+static server_io_t *server_io_alloc(server_conn_t *conn, const ourdemo_cmd_t *cmd)
+{
+    server_io_t *io;
+
+    io = calloc(1, sizeof(*io));
+    if (io == NULL) {
+        return NULL;
+    }
+
+    /* An empty I/O gets no buffer, server_io_validate() rejects it */
+    if (((cmd->opcode == OURDEMO_OP_READ) || (cmd->opcode == OURDEMO_OP_WRITE)) &&
+        (cmd->length > 0)) {
+        io->buf = spdk_dma_malloc(cmd->length, IO_BUF_ALIGN, NULL);
+        if (io->buf == NULL) {
+            free(io);
+            return NULL;
+        }
+    }
+
+    if (cmd->flags & OURDEMO_CMD_FLAG_RMA) {
+        io->packed_rkey = malloc(cmd->rkey_length);
+        if (io->packed_rkey == NULL) {
+            spdk_dma_free(io->buf);
+            free(io);
+            return NULL;
+        }
+    }
+
+    io->conn   = conn;
+    io->cmd    = *cmd;
+    io->rsp.id = cmd->id;
+    conn->refs++;
+    conn->worker->num_ios++;
+    return io;
+}
+
+static void server_io_free(server_io_t *io)
+{
+    server_conn_t *conn = io->conn;
+
+    if (io->rkey != NULL) {
+        server_conn_put_rkey(io->rkey);
+    }
+    free(io->packed_rkey);
+    spdk_dma_free(io->buf);
+    free(io);
+    conn->worker->num_ios--;
+    server_conn_put(conn);
+}
+
+static void send_cb(void *request, ucs_status_t status)
+{
+    server_req_t *req = request;
+    server_io_t  *io  = req->io;
+
+    ucp_request_free(request);
+    if (status != UCS_OK) {
+        server_conn_close(io->conn, UCP_EP_CLOSE_MODE_FORCE);
+    }
+    server_io_free(io);
+}
+
+static void server_io_send_rsp(server_io_t *io)
+{
+    server_conn_t *conn = io->conn;
+    server_req_t  *req;
+    size_t        iovcnt = 1;
+
+    if (conn->closing) {
+        server_io_free(io);
+        return;
+    }
+
+    io->iov[0].buffer = &io->rsp;
+    io->iov[0].length = sizeof(io->rsp);
+    if (io->rsp.status == 0) {
+        if ((io->cmd.opcode == OURDEMO_OP_READ) &&
+            !(io->cmd.flags & OURDEMO_CMD_FLAG_RMA)) {
+            io->rsp.length    = io->cmd.length;
+            io->iov[1].buffer = io->buf;
+            io->iov[1].length = io->cmd.length;
+            iovcnt++;
+        } else if (io->cmd.opcode == OURDEMO_OP_INFO) {
+            io->rsp.length    = sizeof(io->info);
+            io->iov[1].buffer = &io->info;
+            io->iov[1].length = sizeof(io->info);
+            iovcnt++;
+        }
+    }
+
+    /* The response header and its payload leave in a single send */
+    req = ucp_stream_send_nb(conn->ep, io->iov, iovcnt, ucp_dt_make_iov(),
+                             send_cb, 0);
+    if (req == NULL) {
+        server_io_free(io);
+    } else if (UCS_PTR_IS_ERR(req)) {
+        fprintf(stderr, "unable to send response (%s)\n",
+                ucs_status_string(UCS_PTR_STATUS(req)));
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+        server_io_free(io);
+    } else {
+        req->io = io;
+    }
+}
+
+static void server_io_rma_done(server_io_t *io, ucs_status_t status)
+{
+    if (status != UCS_OK) {
+        fprintf(stderr, "RMA %s failed (%s)\n",
+                (io->cmd.opcode == OURDEMO_OP_READ) ? "put" : "get",
+                ucs_status_string(status));
+        io->rsp.status = -EIO;
+        server_io_send_rsp(io);
+        return;
+    }
+
+    if (io->cmd.opcode == OURDEMO_OP_READ) {
+        server_io_send_rsp(io);
+    } else {
+        server_io_submit(io);
+    }
+}
+
+static void rma_done_cb(void *request, ucs_status_t status)
+{
+    server_req_t *req = request;
+    server_io_t  *io  = req->io;
+
+    ucp_request_free(request);
+    server_io_rma_done(io, status);
+}
+
+/**
+ * Move the payload between the client buffer and the DMA buffer. A WRITE
+ * gets the data before it is submitted to the bdev; a READ puts it after the
+ * bdev completed and flushes the endpoint, so the response cannot overtake
+ * the data.
+ */
+static void server_io_rma(server_io_t *io)
+{
+    server_conn_t *conn = io->conn;
+    server_req_t  *req;
+    ucs_status_t  status;
+
+    if (conn->closing) {
+        server_io_free(io);
+        return;
+    }
+
+    if (io->cmd.opcode == OURDEMO_OP_READ) {
+        status = ucp_put_nbi(conn->ep, io->buf, io->cmd.length,
+                             io->cmd.remote_addr, io->rkey->rkey);
+        if (UCS_STATUS_IS_ERR(status)) {
+            req = UCS_STATUS_PTR(status);
+        } else {
+            req = ucp_ep_flush_nb(conn->ep, 0, rma_done_cb);
+        }
+    } else {
+        req = ucp_get_nb(conn->ep, io->buf, io->cmd.length,
+                         io->cmd.remote_addr, io->rkey->rkey, rma_done_cb);
+    }
+
+    if (req == NULL) {
+        server_io_rma_done(io, UCS_OK);
+    } else if (UCS_PTR_IS_ERR(req)) {
+        fprintf(stderr, "unable to start RMA (%s)\n",
+                ucs_status_string(UCS_PTR_STATUS(req)));
+        io->rsp.status = -EIO;
+        server_io_send_rsp(io);
+    } else {
+        req->io = io;
+    }
+}
+
+static void server_bdev_io_done(struct spdk_bdev_io *bdev_io, bool success, void *arg)
+{
+    server_io_t *io = arg;
+
+    spdk_bdev_free_io(bdev_io);
+    io->rsp.status = success ? 0 : -EIO;
+    if (success && (io->cmd.flags & OURDEMO_CMD_FLAG_RMA) &&
+        (io->cmd.opcode == OURDEMO_OP_READ)) {
+        server_io_rma(io);
+        return;
+    }
+    server_io_send_rsp(io);
+}
+
+static void server_io_submit(void *arg)
+{
+    server_io_t     *io     = arg;
+    server_worker_t *worker = io->conn->worker;
+    int             rc;
+
+    if (io->cmd.opcode == OURDEMO_OP_READ) {
+        rc = spdk_bdev_read(g_server.desc, worker->ch, io->buf, io->cmd.offset,
+                            io->cmd.length, server_bdev_io_done, io);
+    } else {
+        rc = spdk_bdev_write(g_server.desc, worker->ch, io->buf, io->cmd.offset,
+                             io->cmd.length, server_bdev_io_done, io);
+    }
+
+    if (rc == -ENOMEM) {
+        /* Out of bdev_io structures, retry once one is released */
+        io->bdev_io_wait.bdev   = g_server.bdev;
+        io->bdev_io_wait.cb_fn  = server_io_submit;
+        io->bdev_io_wait.cb_arg = io;
+        spdk_bdev_queue_io_wait(g_server.bdev, worker->ch, &io->bdev_io_wait);
+    } else if (rc != 0) {
+        io->rsp.status = rc;
+        server_io_send_rsp(io);
+    }
+}
+
+/**
+ * Check the command against the device geometry. Failures are reported to
+ * the client in the response, the connection stays usable.
+ */
+static int server_io_validate(const ourdemo_cmd_t *cmd)
+{
+    uint32_t block_size = spdk_bdev_get_block_size(g_server.bdev);
+    uint64_t dev_size   = spdk_bdev_get_num_blocks(g_server.bdev) * block_size;
+
+    if ((cmd->length == 0) || (cmd->length % block_size) ||
+        (cmd->offset % block_size)) {
+        return -EINVAL;
+    }
+    if ((cmd->offset >= dev_size) || (cmd->length > dev_size - cmd->offset)) {
+        return -ERANGE;
+    }
+    return 0;
+}
+
+static void server_io_start(server_io_t *io)
+{
+    if (io->conn->closing) {
+        server_io_free(io);
+        return;
+    }
+
+    io->rsp.status = server_io_validate(&io->cmd);
+    if (io->rsp.status != 0) {
+        server_io_send_rsp(io);
+        return;
+    }
+
+    server_io_submit(io);
+}
+
+/**
+ * The remote key of an RMA command arrived: check the command, then fetch
+ * the WRITE payload or read the bdev.
+ */
+static void server_io_start_rma(server_io_t *io)
+{
+    if (io->conn->closing) {
+        server_io_free(io);
+        return;
+    }
+
+    io->rsp.status = server_io_validate(&io->cmd);
+    if (io->rsp.status != 0) {
+        server_io_send_rsp(io);
+        return;
+    }
+
+    io->rkey = server_conn_get_rkey(io->conn, io->packed_rkey,
+                                    io->cmd.rkey_length);
+    if (io->rkey == NULL) {
+        io->rsp.status = -EINVAL;
+        server_io_send_rsp(io);
+    } else if (io->cmd.opcode == OURDEMO_OP_WRITE) {
+        server_io_rma(io);
+    } else {
+        server_io_submit(io);
+    }
+}
+
+static void server_io_recv_done(server_io_t *io)
+{
+    if (io->cmd.flags & OURDEMO_CMD_FLAG_RMA) {
+        server_io_start_rma(io);
+    } else {
+        server_io_start(io);
+    }
+}
+
+static void payload_recv_cb(void *request, ucs_status_t status, size_t length)
+{
+    server_req_t *req = request;
+    server_io_t  *io  = req->io;
+
+    if (io == NULL) {
+        return;
+    }
+
+    TAILQ_REMOVE(&io->conn->recvs, req, link);
+    ucp_request_free(request);
+    if (status != UCS_OK) {
+        server_conn_close(io->conn, UCP_EP_CLOSE_MODE_FORCE);
+        server_io_free(io);
+        return;
+    }
+    server_io_recv_done(io);
+}
+
+/**
+ * Post the receive of what follows the command header: the payload of a
+ * WRITE, or the packed rkey of an RMA command. It is queued on the endpoint
+ * ahead of the next command header, so the stream order is preserved.
+ */
+static int server_io_recv_payload(server_io_t *io)
+{
+    server_req_t *req;
+    size_t       length;
+    void         *buffer;
+
+    if (io->cmd.flags & OURDEMO_CMD_FLAG_RMA) {
+        buffer = io->packed_rkey;
+        length = io->cmd.rkey_length;
+    } else {
+        buffer = io->buf;
+        length = io->cmd.length;
+    }
+
+    req = ucp_stream_recv_nb(io->conn->ep, buffer, 1, ucp_dt_make_contig(length),
+                             payload_recv_cb, &length,
+                             UCP_STREAM_RECV_FLAG_WAITALL);
+    if (req == NULL) {
+        server_io_recv_done(io);
+    } else if (UCS_PTR_IS_ERR(req)) {
+        fprintf(stderr, "unable to receive payload (%s)\n",
+                ucs_status_string(UCS_PTR_STATUS(req)));
+        server_io_free(io);
+        return -1;
+    } else {
+        req->conn = NULL;
+        req->io   = io;
+        TAILQ_INSERT_TAIL(&io->conn->recvs, req, link);
+    }
+    return 0;
+}
+
+/**
+ * Dispatch a received command header. Returns nonzero if the connection
+ * should not receive any further commands.
+ */
+static int server_conn_handle_cmd(server_conn_t *conn)
+{
+    ourdemo_cmd_t *cmd = &conn->cmd;
+    server_io_t   *io;
+
+    switch (cmd->opcode) {
+    case OURDEMO_OP_INFO:
+    case OURDEMO_OP_READ:
+    case OURDEMO_OP_WRITE:
+        break;
+    case OURDEMO_OP_DISCONNECT:
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FLUSH);
+        return -1;
+    default:
+        fprintf(stderr, "unknown opcode %u, closing connection\n", cmd->opcode);
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+        return -1;
+    }
+
+    if (cmd->length > OURDEMO_MAX_IO_SIZE) {
+        /* Cannot resynchronize the stream past a payload we will not take */
+        fprintf(stderr, "command length %u exceeds %u, closing connection\n",
+                cmd->length, OURDEMO_MAX_IO_SIZE);
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+        return -1;
+    }
+
+    if ((cmd->flags & OURDEMO_CMD_FLAG_RMA) &&
+        ((cmd->opcode == OURDEMO_OP_INFO) || (cmd->rkey_length == 0) ||
+         (cmd->rkey_length > OURDEMO_MAX_RKEY_SIZE))) {
+        fprintf(stderr, "malformed RMA command, closing connection\n");
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+        return -1;
+    }
+
+    io = server_io_alloc(conn, cmd);
+    if (io == NULL) {
+        fprintf(stderr, "failed to allocate I/O, closing connection\n");
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+        return -1;
+    }
+
+    switch (cmd->opcode) {
+    case OURDEMO_OP_INFO:
+        io->info.block_size  = spdk_bdev_get_block_size(g_server.bdev);
+        io->info.max_io_size = OURDEMO_MAX_IO_SIZE;
+        io->info.num_blocks  = spdk_bdev_get_num_blocks(g_server.bdev);
+        server_io_send_rsp(io);
+        break;
+    case OURDEMO_OP_READ:
+        if (!(cmd->flags & OURDEMO_CMD_FLAG_RMA)) {
+            server_io_start(io);
+            break;
+        }
+        /* fall through */
+    case OURDEMO_OP_WRITE:
+        if (!(cmd->flags & OURDEMO_CMD_FLAG_RMA) && (cmd->length == 0)) {
+            /* Nothing follows on the stream, answer with -EINVAL */
+            server_io_start(io);
+            break;
+        }
+        if (server_io_recv_payload(io) != 0) {
+            server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+            return -1;
+        }
+        break;
+    }
+    return 0;
+}
+
+static void cmd_recv_cb(void *request, ucs_status_t status, size_t length)
+{
+    server_req_t  *req  = request;
+    server_conn_t *conn = req->conn;
+
+    if (conn == NULL) {
+        return;
+    }
+
+    TAILQ_REMOVE(&conn->recvs, req, link);
+    ucp_request_free(request);
+    if (conn->closing) {
+        server_conn_put(conn);
+        return;
+    }
+
+    if (status != UCS_OK) {
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+    } else if (server_conn_handle_cmd(conn) == 0) {
+        server_conn_recv_cmd(conn);
+    }
+    server_conn_put(conn);
+}
+
+/**
+ * Receive and handle command headers until one does not complete inline.
+ */
+static void server_conn_recv_cmd(server_conn_t *conn)
+{
+    server_req_t *req;
+    size_t       length;
+
+    while (!conn->closing) {
+        req = ucp_stream_recv_nb(conn->ep, &conn->cmd, 1,
+                                 ucp_dt_make_contig(sizeof(conn->cmd)),
+                                 cmd_recv_cb, &length,
+                                 UCP_STREAM_RECV_FLAG_WAITALL);
+        if (req == NULL) {
+            if (server_conn_handle_cmd(conn) != 0) {
+                return;
+            }
+            continue;
+        }
+
+        if (UCS_PTR_IS_ERR(req)) {
+            fprintf(stderr, "unable to receive command (%s)\n",
+                    ucs_status_string(UCS_PTR_STATUS(req)));
+            server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+        } else {
+            req->conn = conn;
+            req->io   = NULL;
+            TAILQ_INSERT_TAIL(&conn->recvs, req, link);
+            conn->refs++;
+        }
+        return;
+    }
+}
+
+static void server_worker_accept(void *arg)
+{
+    server_accept_ctx_t *ctx    = arg;
+    server_worker_t     *worker = ctx->worker;
+    ucp_ep_params_t     ep_params;
+    server_conn_t       *conn;
+    ucs_status_t        status;
+
+    conn = calloc(1, sizeof(*conn));
+    if (conn == NULL) {
+        fprintf(stderr, "failed to allocate a connection\n");
+        ucp_listener_reject(g_server.listener, ctx->conn_request);
+        __atomic_sub_fetch(&worker->num_conns, 1, __ATOMIC_RELAXED);
+        free(ctx);
+        return;
+    }
+
+    /* The endpoint is created on the data worker of this reactor, not on the
+     * worker the listener was created on */
+    ep_params.field_mask      = UCP_EP_PARAM_FIELD_ERR_HANDLER |
+                                UCP_EP_PARAM_FIELD_CONN_REQUEST;
+    ep_params.conn_request    = ctx->conn_request;
+    ep_params.err_handler.cb  = err_cb;
+    ep_params.err_handler.arg = conn;
+    status = ucp_ep_create(worker->ucp_worker, &ep_params, &conn->ep);
+    free(ctx);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to create an endpoint on the server: (%s)\n",
+                ucs_status_string(status));
+        __atomic_sub_fetch(&worker->num_conns, 1, __ATOMIC_RELAXED);
+        free(conn);
+        return;
+    }
+
+    conn->worker = worker;
+    conn->refs   = 1;
+    TAILQ_INIT(&conn->recvs);
+    TAILQ_INSERT_TAIL(&worker->conns, conn, link);
+    server_conn_recv_cmd(conn);
+}
+
+/**
+ * Pick the data worker for a new connection: either strictly in turn, or the
+ * one with the fewest connections, breaking ties in turn.
+ */
+static server_worker_t *server_pick_worker(void)
+{
+    server_worker_t *best = NULL;
+    uint32_t        i, idx, load, best_load = UINT32_MAX;
+
+    if (server_policy == SERVER_POLICY_ROUND_ROBIN) {
+        best = &g_server.workers[g_server.next_worker];
+    } else {
+        for (i = 0; i < g_server.num_workers; i++) {
+            idx  = (g_server.next_worker + i) % g_server.num_workers;
+            load = __atomic_load_n(&g_server.workers[idx].num_conns, __ATOMIC_RELAXED);
+            if (load < best_load) {
+                best      = &g_server.workers[idx];
+                best_load = load;
+            }
+        }
+    }
+
+    g_server.next_worker = (best->index + 1) % g_server.num_workers;
+    return best;
+}
+
+static void server_conn_handle_cb(ucp_conn_request_h conn_request, void *arg)
+{
+    server_accept_ctx_t *ctx;
+    ucs_status_t        status;
+
+    ctx = malloc(sizeof(*ctx));
+    if ((ctx == NULL) || g_server.stopping) {
+        free(ctx);
+        status = ucp_listener_reject(g_server.listener, conn_request);
+        if (status != UCS_OK) {
+            fprintf(stderr, "server failed to reject a connection request: (%s)\n",
+                    ucs_status_string(status));
+        }
+        return;
+    }
+
+    ctx->worker       = server_pick_worker();
+    ctx->conn_request = conn_request;
+    __atomic_add_fetch(&ctx->worker->num_conns, 1, __ATOMIC_RELAXED);
+    spdk_thread_send_msg(ctx->worker->thread, server_worker_accept, ctx);
+}
+
+static int server_listen_poll(void *arg)
+{
+    return ucp_worker_progress(g_server.listen_worker) ? SPDK_POLLER_BUSY :
+                                                         SPDK_POLLER_IDLE;
+}
+
+static ucs_status_t server_listen(ucp_worker_h ucp_worker,
+                                  ucp_listener_h *listener_p, const char *ip)
+{
+    struct sockaddr_in listen_addr;
+    ucp_listener_params_t params;
+    ucp_listener_attr_t attr;
+    ucs_status_t status;
+    char ip_str[IP_STRING_LEN];
+    char port_str[PORT_STRING_LEN];
+
+    set_listen_addr(ip, &listen_addr);
+    params.field_mask         = UCP_LISTENER_PARAM_FIELD_SOCK_ADDR |
+                                UCP_LISTENER_PARAM_FIELD_CONN_HANDLER;
+    params.sockaddr.addr      = (const struct sockaddr*)&listen_addr;
+    params.sockaddr.addrlen   = sizeof(listen_addr);
+    params.conn_handler.cb    = server_conn_handle_cb;
+    params.conn_handler.arg   = NULL;
+    /* Create a listener on the server side to listen on the given address.*/
+    status = ucp_listener_create(ucp_worker, &params, listener_p);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to listen (%s)\n", ucs_status_string(status));
+        goto out;
+    }
+    /* Query the created listener to get the port it is listening on. */
+    attr.field_mask = UCP_LISTENER_ATTR_FIELD_SOCKADDR;
+    status = ucp_listener_query(*listener_p, &attr);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to query the listener (%s)\n",
+                ucs_status_string(status));
+        ucp_listener_destroy(*listener_p);
+        goto out;
+    }
+    fprintf(stderr, "server is listening on IP %s port %s, %u workers, bdev %s\n",
+            sockaddr_get_ip_str(&attr.sockaddr, ip_str, IP_STRING_LEN),
+            sockaddr_get_port_str(&attr.sockaddr, port_str, PORT_STRING_LEN),
+            g_server.num_workers, bdev_name);
+    if (idle_usec > 0) {
+        fprintf(stderr, "workers sleep after %lu us without traffic, for at "
+                "most %d ms at a time\n", (unsigned long)idle_usec, max_sleep_ms);
+    }
+out:
+    return status;
+}
+
+/**
+ * Block on the event fd of the UCP worker until traffic arrives. The reactor
+ * cannot run anything else meanwhile, so the sleep is bounded by
+ * 'max_sleep_ms' to let the other SPDK threads on this core make progress.
+ */
+static unsigned server_worker_sleep(server_worker_t *worker)
+{
+    struct epoll_event event;
+    uint64_t           start, woken, now;
+    ucs_status_t       status;
+    unsigned           count;
+    int                ret;
+
+    status = ucp_worker_arm(worker->ucp_worker);
+    if (status == UCS_ERR_BUSY) {
+        /* Events arrived since the last progress */
+        return ucp_worker_progress(worker->ucp_worker);
+    } else if (status != UCS_OK) {
+        fprintf(stderr, "failed to arm worker %u (%s), polling from now on\n",
+                worker->index, ucs_status_string(status));
+        close(worker->epfd);
+        worker->epfd = -1;
+        return 0;
+    }
+
+    worker->num_sleeps++;
+    start = spdk_get_ticks();
+    ret   = epoll_wait(worker->epfd, &event, 1, max_sleep_ms);
+    woken = spdk_get_ticks();
+    worker->sleep_tsc += woken - start;
+    if (ret <= 0) {
+        return 0;
+    }
+
+    /* Time from the wakeup until the events were progressed */
+    count = ucp_worker_progress(worker->ucp_worker);
+    now   = spdk_get_ticks();
+    worker->num_wakeups++;
+    worker->wakeup_tsc    += now - woken;
+    worker->max_wakeup_tsc = spdk_max(worker->max_wakeup_tsc, now - woken);
+    return count;
+}
+
+/**
+ * Poll while there is traffic, and sleep on the event fd once the worker has
+ * been idle for 'idle_usec'. Only a worker without any I/O or close in flight
+ * is idle, so nothing but the network can wake it up.
+ */
+static unsigned server_worker_idle(server_worker_t *worker, unsigned count)
+{
+    uint64_t now = spdk_get_ticks();
+
+    if ((count > 0) || (worker->num_ios > 0) || (worker->num_closing > 0) ||
+        worker->stopping) {
+        worker->last_busy_tsc = now;
+        return 0;
+    }
+
+    if ((now - worker->last_busy_tsc) < (idle_usec * spdk_get_ticks_hz() / 1000000)) {
+        return 0;
+    }
+
+    count = server_worker_sleep(worker);
+    if (count > 0) {
+        worker->last_busy_tsc = spdk_get_ticks();
+    }
+    return count;
+}
+
+static void server_worker_report(server_worker_t *worker)
+{
+    double hz    = spdk_get_ticks_hz();
+    double total = spdk_get_ticks() - worker->start_tsc;
+
+    fprintf(stderr, "worker %u: %lu sleeps after %lu us idle (max %d ms each), "
+            "asleep %.1f%% of the time, %lu woken by events, wakeup to "
+            "progress avg %.2f us max %.2f us\n", worker->index,
+            (unsigned long)worker->num_sleeps, (unsigned long)idle_usec,
+            max_sleep_ms, total ? 100.0 * worker->sleep_tsc / total : 0.0,
+            (unsigned long)worker->num_wakeups,
+            worker->num_wakeups ?
+                1e6 * worker->wakeup_tsc / worker->num_wakeups / hz : 0.0,
+            1e6 * worker->max_wakeup_tsc / hz);
+}
+
+static int server_worker_poll(void *arg)
+{
+    server_worker_t *worker = arg;
+    server_conn_t   *conn, *tmp;
+    unsigned        count;
+
+    count = ucp_worker_progress(worker->ucp_worker);
+
+    if (worker->num_closing > 0) {
+        TAILQ_FOREACH_SAFE(conn, &worker->conns, link, tmp) {
+            if ((conn->close_req == NULL) ||
+                (ucp_request_check_status(conn->close_req) == UCS_INPROGRESS)) {
+                continue;
+            }
+            ucp_request_free(conn->close_req);
+            conn->close_req = NULL;
+            worker->num_closing--;
+            server_conn_closed(conn);
+        }
+    }
+
+    if (worker->epfd >= 0) {
+        count += server_worker_idle(worker, count);
+    }
+
+    return count ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static void server_start_listener(void *arg)
+{
+    ucs_status_t status;
+
+    if (++g_server.num_running < g_server.num_workers) {
+        return;
+    }
+
+    status = server_listen(g_server.listen_worker, &g_server.listener,
+                           listen_addr_str);
+    if (status != UCS_OK) {
+        spdk_app_stop(-1);
+        return;
+    }
+    g_server.listen_poller = spdk_poller_register(server_listen_poll, NULL, 0);
+}
+
+/**
+ * Get the event fd of the UCP worker into an epoll set of its own.
+ */
+static int server_worker_init_efd(server_worker_t *worker)
+{
+    struct epoll_event event;
+    ucs_status_t       status;
+    int                efd;
+
+    status = ucp_worker_get_efd(worker->ucp_worker, &efd);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to get the event fd of worker %u (%s)\n",
+                worker->index, ucs_status_string(status));
+        return -1;
+    }
+
+    worker->epfd = epoll_create(1);
+    if (worker->epfd < 0) {
+        fprintf(stderr, "failed to create epoll set (%s)\n", spdk_strerror(errno));
+        return -1;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events  = EPOLLIN;
+    event.data.fd = efd;
+    if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, efd, &event) != 0) {
+        fprintf(stderr, "failed to add event fd to epoll set (%s)\n",
+                spdk_strerror(errno));
+        close(worker->epfd);
+        worker->epfd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void server_worker_start(void *arg)
+{
+    server_worker_t *worker = arg;
+
+    TAILQ_INIT(&worker->conns);
+    worker->epfd = -1;
+    if (init_worker(g_server.ucp_context, &worker->ucp_worker) != 0) {
+        spdk_app_stop(-1);
+        return;
+    }
+
+    worker->start_tsc     = spdk_get_ticks();
+    worker->last_busy_tsc = worker->start_tsc;
+    if ((idle_usec > 0) && (server_worker_init_efd(worker) != 0)) {
+        spdk_app_stop(-1);
+        return;
+    }
+
+    worker->ch = spdk_bdev_get_io_channel(g_server.desc);
+    if (worker->ch == NULL) {
+        fprintf(stderr, "failed to get a bdev channel on worker %u\n", worker->index);
+        spdk_app_stop(-1);
+        return;
+    }
+
+    worker->poller = spdk_poller_register(server_worker_poll, worker, 0);
+    spdk_thread_send_msg(g_server.main_thread, server_start_listener, NULL);
+}
+
+static void server_finish(void *arg)
+{
+    if (--g_server.num_running > 0) {
+        return;
+    }
+
+    ucp_worker_destroy(g_server.listen_worker);
+    ucp_cleanup(g_server.ucp_context);
+    spdk_bdev_close(g_server.desc);
+    free(g_server.workers);
+    spdk_app_stop(0);
+}
+
+static int server_worker_drain(void *arg)
+{
+    server_worker_t *worker = arg;
+
+    server_worker_poll(worker);
+    if (!TAILQ_EMPTY(&worker->conns)) {
+        return SPDK_POLLER_BUSY;
+    }
+
+    spdk_poller_unregister(&worker->poller);
+    spdk_put_io_channel(worker->ch);
+    if (worker->epfd >= 0) {
+        server_worker_report(worker);
+        close(worker->epfd);
+    }
+    ucp_worker_destroy(worker->ucp_worker);
+    spdk_thread_send_msg(g_server.main_thread, server_finish, NULL);
+    spdk_thread_exit(worker->thread);
+    return SPDK_POLLER_BUSY;
+}
+
+static void server_worker_stop(void *arg)
+{
+    server_worker_t *worker = arg;
+    server_conn_t   *conn, *tmp;
+
+    worker->stopping = 1;
+    TAILQ_FOREACH_SAFE(conn, &worker->conns, link, tmp) {
+        server_conn_close(conn, UCP_EP_CLOSE_MODE_FORCE);
+    }
+
+    spdk_poller_unregister(&worker->poller);
+    worker->poller = spdk_poller_register(server_worker_drain, worker, 0);
+}
+
+static void server_shutdown(void)
+{
+    uint32_t i;
+
+    if (g_server.stopping) {
+        return;
+    }
+    g_server.stopping = 1;
+
+    spdk_poller_unregister(&g_server.listen_poller);
+    if (g_server.listener != NULL) {
+        ucp_listener_destroy(g_server.listener);
+    }
+
+    for (i = 0; i < g_server.num_workers; i++) {
+        spdk_thread_send_msg(g_server.workers[i].thread, server_worker_stop,
+                             &g_server.workers[i]);
+    }
+}
+
+static void server_bdev_event_cb(enum spdk_bdev_event_type type,
+                                 struct spdk_bdev *bdev, void *ctx)
+{
+    fprintf(stderr, "unsupported bdev event: type %d\n", type);
+}
+
+static void server_start(void *arg)
+{
+    struct spdk_cpuset cpumask;
+    char               thread_name[32];
+    uint32_t           core, i = 0;
+    int                rc;
+
+    g_server.main_thread = spdk_get_thread();
+
+    rc = spdk_bdev_open_ext(bdev_name, true, server_bdev_event_cb, NULL,
+                            &g_server.desc);
+    if (rc != 0) {
+        fprintf(stderr, "could not open bdev %s (%s)\n", bdev_name, spdk_strerror(-rc));
+        spdk_app_stop(-1);
+        return;
+    }
+    g_server.bdev = spdk_bdev_desc_get_bdev(g_server.desc);
+
+    if (init_context(&g_server.ucp_context, &g_server.listen_worker) != 0) {
+        spdk_app_stop(-1);
+        return;
+    }
+
+    g_server.num_workers = spdk_env_get_core_count();
+    g_server.workers     = calloc(g_server.num_workers, sizeof(server_worker_t));
+    if (g_server.workers == NULL) {
+        spdk_app_stop(-1);
+        return;
+    }
+
+    /* One data worker pinned to every reactor of the core mask */
+    SPDK_ENV_FOREACH_CORE(core) {
+        server_worker_t *worker = &g_server.workers[i];
+
+        spdk_cpuset_zero(&cpumask);
+        spdk_cpuset_set_cpu(&cpumask, core, true);
+        snprintf(thread_name, sizeof(thread_name), "ourdemo_%u", core);
+        worker->index  = i++;
+        worker->thread = spdk_thread_create(thread_name, &cpumask);
+        if (worker->thread == NULL) {
+            fprintf(stderr, "failed to create thread on core %u\n", core);
+            spdk_app_stop(-1);
+            return;
+        }
+        spdk_thread_send_msg(worker->thread, server_worker_start, worker);
+    }
+}
+
+static void server_usage(void)
+{
+    printf(" -b <bdev>     name of the bdev to export (default = %s)\n", bdev_name);
+    printf(" -l <addr>     IP address to listen on (default = INADDR_ANY)\n");
+    printf(" -P <port>     port number to listen on (default = %d)\n", OURDEMO_DEFAULT_PORT);
+    printf(" -t <policy>   connection placement, 'rr' (round-robin) or "
+           "'ll' (least-loaded, default)\n");
+    printf(" -I <usec>     idle time after which a worker sleeps on its event fd "
+           "instead of polling, 0 always polls (default = 0)\n");
+    printf(" -M <msec>     longest sleep before the reactor polls again "
+           "(default = %d)\n", DEFAULT_MAX_SLEEP_MS);
+}
+
+static int server_parse_arg(int ch, char *arg)
+{
+    int port;
+
+    switch (ch) {
+    case 'b':
+        bdev_name = arg;
+        break;
+    case 'l':
+        listen_addr_str = arg;
+        break;
+    case 'P':
+        port = atoi(arg);
+        if ((port < 0) || (port > UINT16_MAX)) {
+            fprintf(stderr, "Wrong server port number %d\n", port);
+            return -EINVAL;
+        }
+        server_port = port;
+        break;
+    case 't':
+        if (!strcasecmp(arg, "rr")) {
+            server_policy = SERVER_POLICY_ROUND_ROBIN;
+        } else if (!strcasecmp(arg, "ll")) {
+            server_policy = SERVER_POLICY_LEAST_LOADED;
+        } else {
+            fprintf(stderr, "Wrong placement policy %s\n", arg);
+            return -EINVAL;
+        }
+        break;
+    case 'I':
+        idle_usec = spdk_strtoll(arg, 10);
+        if ((int64_t)idle_usec < 0) {
+            fprintf(stderr, "Wrong idle time %s\n", arg);
+            return -EINVAL;
+        }
+        break;
+    case 'M':
+        max_sleep_ms = spdk_strtol(arg, 10);
+        if (max_sleep_ms <= 0) {
+            fprintf(stderr, "Wrong sleep time %s\n", arg);
+            return -EINVAL;
+        }
+        break;
+    default:
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct spdk_app_opts opts = {};
+    int rc;
+
+    spdk_app_opts_init(&opts);
+    opts.name        = "ourdemo_server";
+    opts.shutdown_cb = server_shutdown;
+
+    rc = spdk_app_parse_args(argc, argv, &opts, "b:l:P:t:I:M:", NULL,
+                             server_parse_arg, server_usage);
+    if (rc != SPDK_APP_PARSE_ARGS_SUCCESS) {
+        return rc;
+    }
+
+    rc = spdk_app_start(&opts, server_start, NULL);
+    spdk_app_fini();
+    return rc;
+}
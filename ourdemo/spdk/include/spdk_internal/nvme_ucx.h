@@ -0,0 +1,76 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Wire format shared by the NVMe-oF UCX transports of the host and the target.
+ *
+ * Every queue pair is one UCP endpoint. Command capsules and completions are
+ * UCP active messages sent with UCP_AM_SEND_REPLY, so that the receiving side
+ * can tell the queue pair from the endpoint handed to the AM handler. Data
+ * that does not fit into the capsule is moved by the target with RMA: the
+ * host describes its buffer with a keyed SGL whose address is the virtual
+ * address of the buffer, and appends the packed rkey to the capsule.
+ */
+
+#ifndef SPDK_INTERNAL_NVME_UCX_H
+#define SPDK_INTERNAL_NVME_UCX_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/assert.h"
+#include "spdk/nvme_spec.h"
+
+/* Active message ids */
+enum nvme_ucx_am_id {
+	/* Host to target, struct nvme_ucx_capsule_cmd followed by its payload */
+	NVME_UCX_AM_ID_CAPSULE_CMD	= 0x10,
+	/* Target to host, struct spdk_nvme_cpl */
+	NVME_UCX_AM_ID_CAPSULE_RESP	= 0x11,
+	/* Either side, the queue pair is going away. No payload. */
+	NVME_UCX_AM_ID_TERM		= 0x12,
+};
+
+#define NVME_UCX_MAX_RKEY_SIZE		1024
+
+struct nvme_ucx_capsule_cmd {
+	struct spdk_nvme_cmd	ccsqe;
+	/*
+	 * Size of the packed rkey that follows, non-zero only for a keyed SGL.
+	 * Otherwise in-capsule data follows, if any.
+	 */
+	uint32_t		rkey_len;
+	uint32_t		reserved;
+};
+SPDK_STATIC_ASSERT(sizeof(struct nvme_ucx_capsule_cmd) == 72, "Incorrect size");
+
+#endif /* SPDK_INTERNAL_NVME_UCX_H */
@@ -0,0 +1,86 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SPDK_UCX_H
+#define SPDK_UCX_H
+
+#include "spdk/stdinc.h"
+
+#include <ucp/api/ucp.h>
+
+struct spdk_ucx_mem_map;
+
+struct spdk_ucx_memory_translation {
+	/* Registration of the memory region the buffer lies in */
+	ucp_mem_h	memh;
+	/* Packed rkey of the region, owned by the memory map */
+	const void	*rkey_buf;
+	size_t		rkey_size;
+};
+
+/**
+ * Get a memory map that keeps all memory registered with SPDK mapped to the
+ * given UCP context. Every region is mapped with ucp_mem_map() and its rkey
+ * packed once, when it is registered with SPDK. Maps are shared by all users
+ * of a context and reference counted.
+ *
+ * The context must have been created with mt_workers_shared set, memory may
+ * be registered with SPDK from any thread.
+ *
+ * \param context UCP context to map the memory to
+ * \return Pointer to the memory map on success or NULL on failure
+ */
+struct spdk_ucx_mem_map *spdk_ucx_create_mem_map(ucp_context_h context);
+
+/**
+ * Drop a reference to a memory map, unmapping all regions once the last one
+ * is gone.
+ *
+ * \param map Pointer to the memory map, set to NULL
+ */
+void spdk_ucx_free_mem_map(struct spdk_ucx_mem_map **map);
+
+/**
+ * Look up the registration of a buffer.
+ *
+ * \param map Memory map
+ * \param address Start of the buffer
+ * \param length Length of the buffer
+ * \param translation Filled with the registration of the buffer
+ * \return 0 on success, -EINVAL if the buffer is not SPDK memory, -ERANGE if
+ * it spans more than one region
+ */
+int spdk_ucx_get_translation(struct spdk_ucx_mem_map *map, void *address, size_t length,
+			     struct spdk_ucx_memory_translation *translation);
+
+#endif /* SPDK_UCX_H */
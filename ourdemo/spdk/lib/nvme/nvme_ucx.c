@@ -0,0 +1,1224 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * NVMe over UCX transport, see spdk_internal/nvme_ucx.h
+ */
+
+#include "nvme_internal.h"
+
+#include <ucp/api/ucp.h>
+
+#include "spdk/likely.h"
+#include "spdk/stdinc.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+
+#include "spdk_internal/nvme_ucx.h"
+#include "spdk_internal/ucx.h"
+
+#define NVME_UCX_IN_CAPSULE_DATA_MAX_SIZE	8192
+/* Bound on how long a disconnect waits for the endpoint to flush */
+#define NVME_UCX_CLOSE_TIMEOUT_US		(1000 * 1000)
+
+/* Lives in the private area of every UCP request issued by this transport. */
+struct nvme_ucx_ucp_req {
+	/* NULL once the request was abandoned */
+	struct nvme_ucx_qpair			*tqpair;
+	/* NULL for requests not issued on behalf of an NVMe request */
+	struct nvme_ucx_req			*ucx_req;
+	TAILQ_ENTRY(nvme_ucx_ucp_req)		link;
+};
+
+/* NVMe UCX transport extensions for spdk_nvme_ctrlr */
+struct nvme_ucx_ctrlr {
+	struct spdk_nvme_ctrlr			ctrlr;
+};
+
+struct nvme_ucx_poll_group {
+	struct spdk_nvme_transport_poll_group	group;
+};
+
+/* NVMe UCX qpair extensions for spdk_nvme_qpair */
+struct nvme_ucx_qpair {
+	struct spdk_nvme_qpair			qpair;
+
+	/* Every queue pair progresses its own worker */
+	ucp_worker_h				worker;
+	ucp_ep_h				ep;
+
+	TAILQ_HEAD(, nvme_ucx_req)		free_reqs;
+	TAILQ_HEAD(, nvme_ucx_req)		outstanding_reqs;
+	/* Requests done with UCP, to be completed by process_completions */
+	TAILQ_HEAD(, nvme_ucx_req)		completed_reqs;
+
+	TAILQ_HEAD(, nvme_ucx_ucp_req)		ucp_reqs;
+
+	struct nvme_ucx_req			*ucx_reqs;
+
+	uint16_t				num_entries;
+
+	/* The endpoint failed, or the target terminated the connection */
+	bool					failed;
+	bool					peer_term;
+};
+
+enum nvme_ucx_req_state {
+	NVME_UCX_REQ_FREE,
+	NVME_UCX_REQ_ACTIVE,
+	NVME_UCX_REQ_COMPLETED,
+};
+
+struct nvme_ucx_req {
+	struct nvme_request			*req;
+	enum nvme_ucx_req_state			state;
+	uint16_t				cid;
+	/* The capsule send and the response, until both are done */
+	uint32_t				pending;
+	bool					failed;
+	struct spdk_nvme_cpl			rsp;
+
+	/* Registration of a data buffer that is not SPDK memory */
+	ucp_mem_h				memh;
+
+	struct nvme_ucx_capsule_cmd		capsule;
+	ucp_dt_iov_t				iov[2];
+	uint32_t				iovcnt;
+	uint8_t					packed_rkey[NVME_UCX_MAX_RKEY_SIZE];
+
+	struct nvme_ucx_qpair			*tqpair;
+	TAILQ_ENTRY(nvme_ucx_req)		link;
+	TAILQ_ENTRY(nvme_ucx_req)		completed_link;
+};
+
+/* Shared by all queue pairs of the process, created on first use */
+static ucp_context_h g_ucx_context;
+static struct spdk_ucx_mem_map *g_ucx_mem_map;
+static pthread_mutex_t g_ucx_context_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline struct nvme_ucx_qpair *
+nvme_ucx_qpair(struct spdk_nvme_qpair *qpair)
+{
+	assert(qpair->trtype == SPDK_NVME_TRANSPORT_CUSTOM);
+	return SPDK_CONTAINEROF(qpair, struct nvme_ucx_qpair, qpair);
+}
+
+static inline struct nvme_ucx_ctrlr *
+nvme_ucx_ctrlr(struct spdk_nvme_ctrlr *ctrlr)
+{
+	assert(ctrlr->trid.trtype == SPDK_NVME_TRANSPORT_CUSTOM);
+	return SPDK_CONTAINEROF(ctrlr, struct nvme_ucx_ctrlr, ctrlr);
+}
+
+static ucp_context_h
+nvme_ucx_get_context(void)
+{
+	ucp_params_t params = {};
+	ucs_status_t status;
+
+	pthread_mutex_lock(&g_ucx_context_lock);
+	if (g_ucx_context == NULL) {
+		params.field_mask = UCP_PARAM_FIELD_FEATURES |
+				    UCP_PARAM_FIELD_REQUEST_SIZE |
+				    UCP_PARAM_FIELD_MT_WORKERS_SHARED;
+		params.features = UCP_FEATURE_AM | UCP_FEATURE_RMA;
+		params.request_size = sizeof(struct nvme_ucx_ucp_req);
+		/* Queue pairs of different threads share the context */
+		params.mt_workers_shared = 1;
+		status = ucp_init(&params, NULL, &g_ucx_context);
+		if (status != UCS_OK) {
+			SPDK_ERRLOG("ucp_init() failed: %s\n", ucs_status_string(status));
+			g_ucx_context = NULL;
+		} else {
+			/* Without it every I/O buffer is registered on its own */
+			g_ucx_mem_map = spdk_ucx_create_mem_map(g_ucx_context);
+		}
+	}
+	pthread_mutex_unlock(&g_ucx_context_lock);
+
+	return g_ucx_context;
+}
+
+static struct nvme_ucx_req *
+nvme_ucx_req_get(struct nvme_ucx_qpair *tqpair)
+{
+	struct nvme_ucx_req *ucx_req;
+
+	ucx_req = TAILQ_FIRST(&tqpair->free_reqs);
+	if (!ucx_req) {
+		return NULL;
+	}
+
+	assert(ucx_req->state == NVME_UCX_REQ_FREE);
+	ucx_req->state = NVME_UCX_REQ_ACTIVE;
+	TAILQ_REMOVE(&tqpair->free_reqs, ucx_req, link);
+	ucx_req->req = NULL;
+	ucx_req->pending = 0;
+	ucx_req->failed = false;
+	ucx_req->memh = NULL;
+	ucx_req->iovcnt = 0;
+	memset(&ucx_req->capsule, 0, sizeof(ucx_req->capsule));
+	TAILQ_INSERT_TAIL(&tqpair->outstanding_reqs, ucx_req, link);
+
+	return ucx_req;
+}
+
+static void
+nvme_ucx_req_put(struct nvme_ucx_qpair *tqpair, struct nvme_ucx_req *ucx_req)
+{
+	assert(ucx_req->state != NVME_UCX_REQ_FREE);
+	if (ucx_req->memh != NULL) {
+		ucp_mem_unmap(g_ucx_context, ucx_req->memh);
+		ucx_req->memh = NULL;
+	}
+	ucx_req->state = NVME_UCX_REQ_FREE;
+	TAILQ_INSERT_HEAD(&tqpair->free_reqs, ucx_req, link);
+}
+
+static int
+nvme_ucx_parse_addr(struct sockaddr_storage *sa, socklen_t *salen, int family, const char *addr,
+		    const char *service)
+{
+	struct addrinfo *res;
+	struct addrinfo hints;
+	int ret;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = family;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = 0;
+
+	ret = getaddrinfo(addr, service, &hints, &res);
+	if (ret) {
+		SPDK_ERRLOG("getaddrinfo failed: %s (%d)\n", gai_strerror(ret), ret);
+		return ret;
+	}
+
+	if (res->ai_addrlen > sizeof(*sa)) {
+		SPDK_ERRLOG("getaddrinfo() ai_addrlen %zu too large\n", (size_t)res->ai_addrlen);
+		ret = EINVAL;
+	} else {
+		memcpy(sa, res->ai_addr, res->ai_addrlen);
+		*salen = res->ai_addrlen;
+	}
+
+	freeaddrinfo(res);
+	return ret;
+}
+
+/**
+ * Complete the request once both the capsule send and the response are done.
+ * Completions are deferred to process_completions so that user callbacks
+ * never run from within UCP progress.
+ */
+static void
+nvme_ucx_req_done(struct nvme_ucx_qpair *tqpair, struct nvme_ucx_req *ucx_req)
+{
+	assert(ucx_req->pending > 0);
+	if (--ucx_req->pending == 0) {
+		ucx_req->state = NVME_UCX_REQ_COMPLETED;
+		TAILQ_INSERT_TAIL(&tqpair->completed_reqs, ucx_req, completed_link);
+	}
+}
+
+static void
+nvme_ucx_ucp_req_cb(void *request, ucs_status_t status)
+{
+	struct nvme_ucx_ucp_req *ucp_req = request;
+	struct nvme_ucx_qpair *tqpair = ucp_req->tqpair;
+	struct nvme_ucx_req *ucx_req = ucp_req->ucx_req;
+
+	if (tqpair == NULL) {
+		return;
+	}
+
+	TAILQ_REMOVE(&tqpair->ucp_reqs, ucp_req, link);
+	ucp_request_free(request);
+
+	if (spdk_unlikely(status != UCS_OK)) {
+		SPDK_ERRLOG("UCP operation on tqpair=%p failed: %s\n", tqpair, ucs_status_string(status));
+		tqpair->failed = true;
+	}
+
+	if (ucx_req != NULL) {
+		nvme_ucx_req_done(tqpair, ucx_req);
+	}
+}
+
+/**
+ * Account for a UCP operation just posted. Operations that completed in place
+ * are done right away.
+ */
+static int
+nvme_ucx_track(struct nvme_ucx_qpair *tqpair, struct nvme_ucx_req *ucx_req, ucs_status_ptr_t ptr)
+{
+	struct nvme_ucx_ucp_req *ucp_req;
+
+	if (UCS_PTR_IS_ERR(ptr)) {
+		SPDK_ERRLOG("UCP operation on tqpair=%p failed: %s\n", tqpair,
+			    ucs_status_string(UCS_PTR_STATUS(ptr)));
+		tqpair->failed = true;
+		return -EIO;
+	}
+
+	if (ptr == NULL) {
+		if (ucx_req != NULL) {
+			nvme_ucx_req_done(tqpair, ucx_req);
+		}
+		return 0;
+	}
+
+	ucp_req = ptr;
+	ucp_req->tqpair = tqpair;
+	ucp_req->ucx_req = ucx_req;
+	TAILQ_INSERT_TAIL(&tqpair->ucp_reqs, ucp_req, link);
+	return 0;
+}
+
+/**
+ * Abandon every UCP request still in flight. Their callbacks may run later
+ * and must not touch the queue pair.
+ */
+static void
+nvme_ucx_qpair_orphan_reqs(struct nvme_ucx_qpair *tqpair)
+{
+	struct nvme_ucx_ucp_req *ucp_req;
+
+	while ((ucp_req = TAILQ_FIRST(&tqpair->ucp_reqs)) != NULL) {
+		TAILQ_REMOVE(&tqpair->ucp_reqs, ucp_req, link);
+		ucp_req->tqpair = NULL;
+		ucp_req->ucx_req = NULL;
+		ucp_request_free(ucp_req);
+	}
+}
+
+static ucs_status_t
+nvme_ucx_capsule_resp_handler(void *arg, void *data, size_t length, ucp_ep_h reply_ep,
+			      unsigned flags)
+{
+	struct nvme_ucx_qpair *tqpair = arg;
+	const struct spdk_nvme_cpl *rsp = data;
+	struct nvme_ucx_req *ucx_req;
+
+	if (spdk_unlikely(length != sizeof(*rsp))) {
+		SPDK_ERRLOG("Response of %zu bytes on tqpair=%p\n", length, tqpair);
+		tqpair->failed = true;
+		return UCS_OK;
+	}
+
+	if (spdk_unlikely(rsp->cid >= tqpair->num_entries ||
+			  tqpair->ucx_reqs[rsp->cid].state != NVME_UCX_REQ_ACTIVE)) {
+		SPDK_ERRLOG("no ucx_req is found with cid=%u for tqpair=%p\n", rsp->cid, tqpair);
+		tqpair->failed = true;
+		return UCS_OK;
+	}
+
+	ucx_req = &tqpair->ucx_reqs[rsp->cid];
+	ucx_req->rsp = *rsp;
+	nvme_ucx_req_done(tqpair, ucx_req);
+
+	return UCS_OK;
+}
+
+static ucs_status_t
+nvme_ucx_term_handler(void *arg, void *data, size_t length, ucp_ep_h reply_ep, unsigned flags)
+{
+	struct nvme_ucx_qpair *tqpair = arg;
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVME, "Target terminated tqpair=%p\n", tqpair);
+	tqpair->peer_term = true;
+	tqpair->failed = true;
+
+	return UCS_OK;
+}
+
+static void
+nvme_ucx_err_cb(void *arg, ucp_ep_h ep, ucs_status_t status)
+{
+	struct nvme_ucx_qpair *tqpair = arg;
+
+	SPDK_ERRLOG("UCX endpoint of tqpair=%p failed: %s\n", tqpair, ucs_status_string(status));
+	tqpair->failed = true;
+}
+
+static void
+nvme_ucx_free_reqs(struct nvme_ucx_qpair *tqpair)
+{
+	free(tqpair->ucx_reqs);
+	tqpair->ucx_reqs = NULL;
+}
+
+static int
+nvme_ucx_alloc_reqs(struct nvme_ucx_qpair *tqpair)
+{
+	uint16_t i;
+	struct nvme_ucx_req	*ucx_req;
+
+	tqpair->ucx_reqs = calloc(tqpair->num_entries, sizeof(struct nvme_ucx_req));
+	if (tqpair->ucx_reqs == NULL) {
+		SPDK_ERRLOG("Failed to allocate ucx_reqs on tqpair=%p\n", tqpair);
+		return -ENOMEM;
+	}
+
+	TAILQ_INIT(&tqpair->free_reqs);
+	TAILQ_INIT(&tqpair->outstanding_reqs);
+	TAILQ_INIT(&tqpair->completed_reqs);
+	TAILQ_INIT(&tqpair->ucp_reqs);
+	for (i = 0; i < tqpair->num_entries; i++) {
+		ucx_req = &tqpair->ucx_reqs[i];
+		ucx_req->cid = i;
+		ucx_req->tqpair = tqpair;
+		TAILQ_INSERT_TAIL(&tqpair->free_reqs, ucx_req, link);
+	}
+
+	return 0;
+}
+
+static void
+nvme_ucx_ctrlr_disconnect_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_ucx_qpair *tqpair = nvme_ucx_qpair(qpair);
+	ucs_status_ptr_t close_req;
+	uint64_t deadline_tsc;
+
+	if (tqpair->ep == NULL) {
+		return;
+	}
+
+	if (!tqpair->failed) {
+		nvme_ucx_track(tqpair, NULL, ucp_am_send_nb(tqpair->ep, NVME_UCX_AM_ID_TERM, NULL, 0,
+				ucp_dt_make_contig(1), nvme_ucx_ucp_req_cb,
+				UCP_AM_SEND_REPLY));
+	}
+
+	/* There is nothing left to flush on a failed endpoint */
+	close_req = ucp_ep_close_nb(tqpair->ep, tqpair->failed ? UCP_EP_CLOSE_MODE_FORCE :
+				    UCP_EP_CLOSE_MODE_FLUSH);
+	if (UCS_PTR_IS_PTR(close_req)) {
+		deadline_tsc = spdk_get_ticks() +
+			       NVME_UCX_CLOSE_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+		while (ucp_request_check_status(close_req) == UCS_INPROGRESS &&
+		       spdk_get_ticks() < deadline_tsc) {
+			ucp_worker_progress(tqpair->worker);
+		}
+		ucp_request_free(close_req);
+	} else if (UCS_PTR_IS_ERR(close_req)) {
+		SPDK_ERRLOG("ucp_ep_close_nb() failed: %s\n", ucs_status_string(UCS_PTR_STATUS(close_req)));
+	}
+	tqpair->ep = NULL;
+
+	/* The outstanding requests are aborted by the caller */
+	nvme_ucx_qpair_orphan_reqs(tqpair);
+}
+
+static void nvme_ucx_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr);
+
+static int
+nvme_ucx_ctrlr_delete_io_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_ucx_qpair *tqpair;
+
+	if (!qpair) {
+		return -1;
+	}
+
+	nvme_transport_ctrlr_disconnect_qpair(ctrlr, qpair);
+	nvme_ucx_qpair_abort_reqs(qpair, 1);
+	nvme_qpair_deinit(qpair);
+	tqpair = nvme_ucx_qpair(qpair);
+	nvme_ucx_free_reqs(tqpair);
+	if (tqpair->worker != NULL) {
+		ucp_worker_destroy(tqpair->worker);
+	}
+	free(tqpair);
+
+	return 0;
+}
+
+static int
+nvme_ucx_ctrlr_enable(struct spdk_nvme_ctrlr *ctrlr)
+{
+	return 0;
+}
+
+static int
+nvme_ucx_ctrlr_destruct(struct spdk_nvme_ctrlr *ctrlr)
+{
+	struct nvme_ucx_ctrlr *tctrlr = nvme_ucx_ctrlr(ctrlr);
+
+	if (ctrlr->adminq) {
+		nvme_ucx_ctrlr_delete_io_qpair(ctrlr, ctrlr->adminq);
+	}
+
+	nvme_ctrlr_destruct_finish(ctrlr);
+
+	free(tctrlr);
+
+	return 0;
+}
+
+/**
+ * Look up the one buffer the payload of the request lives in.
+ */
+static int
+nvme_ucx_req_get_buf(struct nvme_request *req, void **buf)
+{
+	uint32_t length;
+
+	if (nvme_payload_type(&req->payload) == NVME_PAYLOAD_TYPE_CONTIG) {
+		*buf = (uint8_t *)req->payload.contig_or_cb_arg + req->payload_offset;
+		return 0;
+	}
+
+	if (nvme_payload_type(&req->payload) != NVME_PAYLOAD_TYPE_SGL) {
+		return -EINVAL;
+	}
+
+	assert(req->payload.reset_sgl_fn != NULL);
+	assert(req->payload.next_sge_fn != NULL);
+	req->payload.reset_sgl_fn(req->payload.contig_or_cb_arg, req->payload_offset);
+	if (req->payload.next_sge_fn(req->payload.contig_or_cb_arg, buf, &length) != 0) {
+		return -EINVAL;
+	}
+
+	/* The transport reports a single SGE, see nvme_ucx_ctrlr_get_max_sges() */
+	if (length < req->payload_size) {
+		SPDK_ERRLOG("SGE of %u bytes is too short for %u bytes\n", length, req->payload_size);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/**
+ * Register a buffer that is not SPDK memory for the duration of the request.
+ */
+static int
+nvme_ucx_req_map_buf(struct nvme_ucx_req *ucx_req, void *buf)
+{
+	struct nvme_request *req = ucx_req->req;
+	ucp_mem_map_params_t params = {};
+	void *rkey_buf;
+	size_t rkey_size;
+	ucs_status_t status;
+
+	params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+			    UCP_MEM_MAP_PARAM_FIELD_LENGTH;
+	params.address = buf;
+	params.length = req->payload_size;
+	status = ucp_mem_map(g_ucx_context, &params, &ucx_req->memh);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_mem_map() failed: %s\n", ucs_status_string(status));
+		ucx_req->memh = NULL;
+		return -EIO;
+	}
+
+	status = ucp_rkey_pack(g_ucx_context, ucx_req->memh, &rkey_buf, &rkey_size);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_rkey_pack() failed: %s\n", ucs_status_string(status));
+		return -EIO;
+	}
+
+	if (rkey_size > NVME_UCX_MAX_RKEY_SIZE) {
+		SPDK_ERRLOG("Packed rkey of %zu bytes is too large\n", rkey_size);
+		ucp_rkey_buffer_release(rkey_buf);
+		return -EIO;
+	}
+
+	memcpy(ucx_req->packed_rkey, rkey_buf, rkey_size);
+	ucp_rkey_buffer_release(rkey_buf);
+
+	ucx_req->iov[1].buffer = ucx_req->packed_rkey;
+	ucx_req->iov[1].length = rkey_size;
+	return 0;
+}
+
+/**
+ * Describe the data buffer with a keyed SGL. The target moves the data
+ * itself with RMA.
+ */
+static int
+nvme_ucx_build_keyed_request(struct nvme_ucx_req *ucx_req, void *buf)
+{
+	struct nvme_request *req = ucx_req->req;
+	struct spdk_ucx_memory_translation translation;
+	int rc;
+
+	if (g_ucx_mem_map != NULL &&
+	    spdk_ucx_get_translation(g_ucx_mem_map, buf, req->payload_size, &translation) == 0 &&
+	    translation.rkey_size <= NVME_UCX_MAX_RKEY_SIZE) {
+		/* SPDK memory was mapped once when it got registered */
+		ucx_req->iov[1].buffer = (void *)translation.rkey_buf;
+		ucx_req->iov[1].length = translation.rkey_size;
+	} else {
+		rc = nvme_ucx_req_map_buf(ucx_req, buf);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	req->cmd.dptr.sgl1.keyed.type = SPDK_NVME_SGL_TYPE_KEYED_DATA_BLOCK;
+	req->cmd.dptr.sgl1.keyed.subtype = SPDK_NVME_SGL_SUBTYPE_ADDRESS;
+	req->cmd.dptr.sgl1.keyed.length = req->payload_size;
+	req->cmd.dptr.sgl1.keyed.key = 0;
+	req->cmd.dptr.sgl1.address = (uint64_t)buf;
+
+	ucx_req->capsule.rkey_len = ucx_req->iov[1].length;
+	ucx_req->iovcnt = 2;
+
+	return 0;
+}
+
+static int
+nvme_ucx_req_init(struct nvme_ucx_qpair *tqpair, struct nvme_request *req,
+		  struct nvme_ucx_req *ucx_req)
+{
+	struct spdk_nvme_ctrlr *ctrlr = tqpair->qpair.ctrlr;
+	enum spdk_nvme_data_transfer xfer;
+	uint32_t max_incapsule_data_size;
+	void *buf = NULL;
+	int rc;
+
+	ucx_req->req = req;
+	req->cmd.cid = ucx_req->cid;
+	req->cmd.psdt = SPDK_NVME_PSDT_SGL_MPTR_CONTIG;
+
+	ucx_req->iov[0].buffer = &ucx_req->capsule;
+	ucx_req->iov[0].length = sizeof(ucx_req->capsule);
+	ucx_req->iovcnt = 1;
+
+	if (req->payload_size != 0) {
+		rc = nvme_ucx_req_get_buf(req, &buf);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	if (req->cmd.opc == SPDK_NVME_OPC_FABRIC) {
+		struct spdk_nvmf_capsule_cmd *nvmf_cmd = (struct spdk_nvmf_capsule_cmd *)&req->cmd;
+
+		xfer = spdk_nvme_opc_get_data_transfer(nvmf_cmd->fctype);
+	} else {
+		xfer = spdk_nvme_opc_get_data_transfer(req->cmd.opc);
+	}
+
+	max_incapsule_data_size = 0;
+	if (xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER) {
+		max_incapsule_data_size = ctrlr->ioccsz_bytes;
+		if ((req->cmd.opc == SPDK_NVME_OPC_FABRIC) || nvme_qpair_is_admin_queue(&tqpair->qpair)) {
+			max_incapsule_data_size = spdk_min(max_incapsule_data_size, NVME_UCX_IN_CAPSULE_DATA_MAX_SIZE);
+		}
+	}
+
+	if (req->payload_size == 0 || req->payload_size <= max_incapsule_data_size) {
+		req->cmd.dptr.sgl1.unkeyed.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
+		req->cmd.dptr.sgl1.unkeyed.subtype = SPDK_NVME_SGL_SUBTYPE_OFFSET;
+		req->cmd.dptr.sgl1.unkeyed.length = req->payload_size;
+		req->cmd.dptr.sgl1.address = 0;
+		if (req->payload_size != 0) {
+			ucx_req->iov[1].buffer = buf;
+			ucx_req->iov[1].length = req->payload_size;
+			ucx_req->iovcnt = 2;
+		}
+	} else {
+		rc = nvme_ucx_build_keyed_request(ucx_req, buf);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	ucx_req->capsule.ccsqe = req->cmd;
+	return 0;
+}
+
+static int
+nvme_ucx_qpair_capsule_cmd_send(struct nvme_ucx_qpair *tqpair,
+				struct nvme_ucx_req *ucx_req)
+{
+	ucs_status_ptr_t ptr;
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVME, "capsule_cmd cid=%u on tqpair(%p)\n", ucx_req->req->cmd.cid, tqpair);
+
+	/* Done once the send and the response both are */
+	ucx_req->pending = 2;
+	ptr = ucp_am_send_nb(tqpair->ep, NVME_UCX_AM_ID_CAPSULE_CMD, ucx_req->iov, ucx_req->iovcnt,
+			     ucp_dt_make_iov(), nvme_ucx_ucp_req_cb, UCP_AM_SEND_REPLY);
+	if (nvme_ucx_track(tqpair, ucx_req, ptr) != 0) {
+		/* No response comes for a capsule never sent */
+		ucx_req->pending = 0;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int
+nvme_ucx_qpair_submit_request(struct spdk_nvme_qpair *qpair,
+			      struct nvme_request *req)
+{
+	struct nvme_ucx_qpair *tqpair;
+	struct nvme_ucx_req *ucx_req;
+
+	tqpair = nvme_ucx_qpair(qpair);
+	assert(tqpair != NULL);
+	assert(req != NULL);
+
+	if (spdk_unlikely(tqpair->ep == NULL || tqpair->failed)) {
+		return -ENXIO;
+	}
+
+	ucx_req = nvme_ucx_req_get(tqpair);
+	if (!ucx_req) {
+		/* Inform the upper layer to try again later. */
+		return -EAGAIN;
+	}
+
+	if (nvme_ucx_req_init(tqpair, req, ucx_req) ||
+	    nvme_ucx_qpair_capsule_cmd_send(tqpair, ucx_req)) {
+		SPDK_ERRLOG("Unable to submit the request on tqpair=%p\n", tqpair);
+		TAILQ_REMOVE(&tqpair->outstanding_reqs, ucx_req, link);
+		nvme_ucx_req_put(tqpair, ucx_req);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+nvme_ucx_qpair_reset(struct spdk_nvme_qpair *qpair)
+{
+	return 0;
+}
+
+static void
+nvme_ucx_req_complete(struct nvme_ucx_req *ucx_req,
+		      struct spdk_nvme_cpl *rsp)
+{
+	struct nvme_request *req;
+
+	assert(ucx_req->req != NULL);
+	req = ucx_req->req;
+
+	TAILQ_REMOVE(&ucx_req->tqpair->outstanding_reqs, ucx_req, link);
+	if (ucx_req->state == NVME_UCX_REQ_COMPLETED) {
+		TAILQ_REMOVE(&ucx_req->tqpair->completed_reqs, ucx_req, completed_link);
+	}
+	nvme_complete_request(req->cb_fn, req->cb_arg, req->qpair, req, rsp);
+	nvme_free_request(req);
+}
+
+static void
+nvme_ucx_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr)
+{
+	struct nvme_ucx_req *ucx_req, *tmp;
+	struct spdk_nvme_cpl cpl;
+	struct nvme_ucx_qpair *tqpair = nvme_ucx_qpair(qpair);
+
+	cpl.status.sc = SPDK_NVME_SC_ABORTED_SQ_DELETION;
+	cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+	cpl.status.dnr = dnr;
+
+	TAILQ_FOREACH_SAFE(ucx_req, &tqpair->outstanding_reqs, link, tmp) {
+		nvme_ucx_req_complete(ucx_req, &cpl);
+		nvme_ucx_req_put(tqpair, ucx_req);
+	}
+}
+
+static void
+nvme_ucx_qpair_check_timeout(struct spdk_nvme_qpair *qpair)
+{
+	uint64_t t02;
+	struct nvme_ucx_req *ucx_req, *tmp;
+	struct nvme_ucx_qpair *tqpair = nvme_ucx_qpair(qpair);
+	struct spdk_nvme_ctrlr *ctrlr = qpair->ctrlr;
+	struct spdk_nvme_ctrlr_process *active_proc;
+
+	/* Don't check timeouts during controller initialization. */
+	if (ctrlr->state != NVME_CTRLR_STATE_READY) {
+		return;
+	}
+
+	if (nvme_qpair_is_admin_queue(qpair)) {
+		active_proc = nvme_ctrlr_get_current_process(ctrlr);
+	} else {
+		active_proc = qpair->active_proc;
+	}
+
+	/* Only check timeouts if the current process has a timeout callback. */
+	if (active_proc == NULL || active_proc->timeout_cb_fn == NULL) {
+		return;
+	}
+
+	t02 = spdk_get_ticks();
+	TAILQ_FOREACH_SAFE(ucx_req, &tqpair->outstanding_reqs, link, tmp) {
+		assert(ucx_req->req != NULL);
+
+		if (nvme_request_check_timeout(ucx_req->req, ucx_req->cid, active_proc, t02)) {
+			/*
+			 * The requests are in order, so as soon as one has not timed out,
+			 * stop iterating.
+			 */
+			break;
+		}
+	}
+}
+
+static int
+nvme_ucx_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_completions)
+{
+	struct nvme_ucx_qpair *tqpair = nvme_ucx_qpair(qpair);
+	struct nvme_ucx_req *ucx_req;
+	uint32_t reaped;
+
+	if (spdk_unlikely(tqpair->ep == NULL)) {
+		return -ENXIO;
+	}
+
+	if (max_completions == 0) {
+		max_completions = tqpair->num_entries;
+	} else {
+		max_completions = spdk_min(max_completions, tqpair->num_entries);
+	}
+
+	ucp_worker_progress(tqpair->worker);
+
+	reaped = 0;
+	while (reaped < max_completions &&
+	       (ucx_req = TAILQ_FIRST(&tqpair->completed_reqs)) != NULL) {
+		nvme_ucx_req_complete(ucx_req, &ucx_req->rsp);
+		nvme_ucx_req_put(tqpair, ucx_req);
+		reaped++;
+	}
+
+	if (spdk_unlikely(tqpair->failed)) {
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "tqpair=%p failed\n", tqpair);
+		goto fail;
+	}
+
+	if (spdk_unlikely(tqpair->qpair.ctrlr->timeout_enabled)) {
+		nvme_ucx_qpair_check_timeout(qpair);
+	}
+
+	return reaped;
+fail:
+
+	/*
+	 * Since admin queues take the ctrlr_lock before entering this function,
+	 * we can call nvme_transport_ctrlr_disconnect_qpair. For other qpairs we need
+	 * to call the generic function which will take the lock for us.
+	 */
+	qpair->transport_failure_reason = SPDK_NVME_QPAIR_FAILURE_UNKNOWN;
+
+	if (nvme_qpair_is_admin_queue(qpair)) {
+		nvme_transport_ctrlr_disconnect_qpair(qpair->ctrlr, qpair);
+	} else {
+		nvme_ctrlr_disconnect_qpair(qpair);
+	}
+	return -ENXIO;
+}
+
+static int
+nvme_ucx_ctrlr_connect_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpair *qpair)
+{
+	struct sockaddr_storage dst_addr;
+	socklen_t dst_addrlen;
+	ucp_ep_params_t ep_params = {};
+	ucs_status_t status;
+	int rc;
+	struct nvme_ucx_qpair *tqpair;
+	int family;
+
+	tqpair = nvme_ucx_qpair(qpair);
+
+	switch (ctrlr->trid.adrfam) {
+	case SPDK_NVMF_ADRFAM_IPV4:
+		family = AF_INET;
+		break;
+	case SPDK_NVMF_ADRFAM_IPV6:
+		family = AF_INET6;
+		break;
+	default:
+		SPDK_ERRLOG("Unhandled ADRFAM %d\n", ctrlr->trid.adrfam);
+		return -1;
+	}
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVME, "adrfam %d ai_family %d\n", ctrlr->trid.adrfam, family);
+
+	memset(&dst_addr, 0, sizeof(dst_addr));
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVME, "trsvcid is %s\n", ctrlr->trid.trsvcid);
+	rc = nvme_ucx_parse_addr(&dst_addr, &dst_addrlen, family, ctrlr->trid.traddr,
+				 ctrlr->trid.trsvcid);
+	if (rc != 0) {
+		SPDK_ERRLOG("dst_addr nvme_ucx_parse_addr() failed\n");
+		return -1;
+	}
+
+	tqpair->failed = false;
+	tqpair->peer_term = false;
+
+	ep_params.field_mask = UCP_EP_PARAM_FIELD_FLAGS |
+			       UCP_EP_PARAM_FIELD_SOCK_ADDR |
+			       UCP_EP_PARAM_FIELD_ERR_HANDLER;
+	ep_params.flags = UCP_EP_PARAMS_FLAGS_CLIENT_SERVER;
+	ep_params.sockaddr.addr = (const struct sockaddr *)&dst_addr;
+	ep_params.sockaddr.addrlen = dst_addrlen;
+	ep_params.err_handler.cb = nvme_ucx_err_cb;
+	ep_params.err_handler.arg = tqpair;
+	status = ucp_ep_create(tqpair->worker, &ep_params, &tqpair->ep);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("connection error of tqpair=%p with addr=%s, port=%s: %s\n",
+			    tqpair, ctrlr->trid.traddr, ctrlr->trid.trsvcid, ucs_status_string(status));
+		tqpair->ep = NULL;
+		return -1;
+	}
+
+	rc = nvme_fabric_qpair_connect(&tqpair->qpair, tqpair->num_entries);
+	if (rc < 0) {
+		SPDK_ERRLOG("Failed to send an NVMe-oF Fabric CONNECT command\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static struct spdk_nvme_qpair *
+nvme_ucx_ctrlr_create_qpair(struct spdk_nvme_ctrlr *ctrlr,
+			    uint16_t qid, uint32_t qsize,
+			    enum spdk_nvme_qprio qprio,
+			    uint32_t num_requests)
+{
+	struct nvme_ucx_qpair *tqpair;
+	struct spdk_nvme_qpair *qpair;
+	ucp_worker_params_t worker_params = {};
+	ucs_status_t status;
+	int rc;
+
+	if (nvme_ucx_get_context() == NULL) {
+		return NULL;
+	}
+
+	tqpair = calloc(1, sizeof(struct nvme_ucx_qpair));
+	if (!tqpair) {
+		SPDK_ERRLOG("failed to get create tqpair\n");
+		return NULL;
+	}
+
+	tqpair->num_entries = qsize;
+	qpair = &tqpair->qpair;
+	rc = nvme_qpair_init(qpair, qid, ctrlr, qprio, num_requests);
+	if (rc != 0) {
+		free(tqpair);
+		return NULL;
+	}
+
+	rc = nvme_ucx_alloc_reqs(tqpair);
+	if (rc) {
+		nvme_ucx_ctrlr_delete_io_qpair(ctrlr, qpair);
+		return NULL;
+	}
+
+	/* A queue pair is only ever polled by one thread at a time */
+	worker_params.field_mask = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+	worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+	status = ucp_worker_create(g_ucx_context, &worker_params, &tqpair->worker);
+	if (status == UCS_OK) {
+		status = ucp_worker_set_am_handler(tqpair->worker, NVME_UCX_AM_ID_CAPSULE_RESP,
+						   nvme_ucx_capsule_resp_handler, tqpair,
+						   UCP_AM_FLAG_WHOLE_MSG);
+	} else {
+		tqpair->worker = NULL;
+	}
+	if (status == UCS_OK) {
+		status = ucp_worker_set_am_handler(tqpair->worker, NVME_UCX_AM_ID_TERM,
+						   nvme_ucx_term_handler, tqpair, UCP_AM_FLAG_WHOLE_MSG);
+	}
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("failed to set up the UCP worker of tqpair=%p: %s\n", tqpair,
+			    ucs_status_string(status));
+		nvme_ucx_ctrlr_delete_io_qpair(ctrlr, qpair);
+		return NULL;
+	}
+
+	return qpair;
+}
+
+static struct spdk_nvme_qpair *
+nvme_ucx_ctrlr_create_io_qpair(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid,
+			       const struct spdk_nvme_io_qpair_opts *opts)
+{
+	return nvme_ucx_ctrlr_create_qpair(ctrlr, qid, opts->io_queue_size, opts->qprio,
+					   opts->io_queue_requests);
+}
+
+static struct spdk_nvme_ctrlr *nvme_ucx_ctrlr_construct(const struct spdk_nvme_transport_id *trid,
+		const struct spdk_nvme_ctrlr_opts *opts,
+		void *devhandle)
+{
+	struct nvme_ucx_ctrlr *tctrlr;
+	union spdk_nvme_cap_register cap;
+	union spdk_nvme_vs_register vs;
+	int rc;
+
+	tctrlr = calloc(1, sizeof(*tctrlr));
+	if (tctrlr == NULL) {
+		SPDK_ERRLOG("could not allocate ctrlr\n");
+		return NULL;
+	}
+
+	tctrlr->ctrlr.opts = *opts;
+	tctrlr->ctrlr.trid = *trid;
+
+	rc = nvme_ctrlr_construct(&tctrlr->ctrlr);
+	if (rc != 0) {
+		free(tctrlr);
+		return NULL;
+	}
+
+	tctrlr->ctrlr.adminq = nvme_ucx_ctrlr_create_qpair(&tctrlr->ctrlr, 0,
+			       tctrlr->ctrlr.opts.admin_queue_size, 0,
+			       tctrlr->ctrlr.opts.admin_queue_size);
+	if (!tctrlr->ctrlr.adminq) {
+		SPDK_ERRLOG("failed to create admin qpair\n");
+		nvme_ucx_ctrlr_destruct(&tctrlr->ctrlr);
+		return NULL;
+	}
+
+	rc = nvme_transport_ctrlr_connect_qpair(&tctrlr->ctrlr, tctrlr->ctrlr.adminq);
+	if (rc < 0) {
+		SPDK_ERRLOG("failed to connect admin qpair\n");
+		nvme_ucx_ctrlr_destruct(&tctrlr->ctrlr);
+		return NULL;
+	}
+
+	if (nvme_ctrlr_get_cap(&tctrlr->ctrlr, &cap)) {
+		SPDK_ERRLOG("get_cap() failed\n");
+		nvme_ctrlr_destruct(&tctrlr->ctrlr);
+		return NULL;
+	}
+
+	if (nvme_ctrlr_get_vs(&tctrlr->ctrlr, &vs)) {
+		SPDK_ERRLOG("get_vs() failed\n");
+		nvme_ctrlr_destruct(&tctrlr->ctrlr);
+		return NULL;
+	}
+
+	if (nvme_ctrlr_add_process(&tctrlr->ctrlr, 0) != 0) {
+		SPDK_ERRLOG("nvme_ctrlr_add_process() failed\n");
+		nvme_ctrlr_destruct(&tctrlr->ctrlr);
+		return NULL;
+	}
+
+	nvme_ctrlr_init_cap(&tctrlr->ctrlr, &cap, &vs);
+
+	return &tctrlr->ctrlr;
+}
+
+static uint32_t
+nvme_ucx_ctrlr_get_max_xfer_size(struct spdk_nvme_ctrlr *ctrlr)
+{
+	/* Bound by the 24 bit length of a keyed SGL descriptor */
+	return (1 << 24) - 1;
+}
+
+static uint16_t
+nvme_ucx_ctrlr_get_max_sges(struct spdk_nvme_ctrlr *ctrlr)
+{
+	/* A keyed SGL describes one registered buffer */
+	return 1;
+}
+
+static int
+nvme_ucx_qpair_iterate_requests(struct spdk_nvme_qpair *qpair,
+				int (*iter_fn)(struct nvme_request *req, void *arg),
+				void *arg)
+{
+	struct nvme_ucx_qpair *tqpair = nvme_ucx_qpair(qpair);
+	struct nvme_ucx_req *ucx_req, *tmp;
+	int rc;
+
+	assert(iter_fn != NULL);
+
+	TAILQ_FOREACH_SAFE(ucx_req, &tqpair->outstanding_reqs, link, tmp) {
+		assert(ucx_req->req != NULL);
+
+		rc = iter_fn(ucx_req->req, arg);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+static void
+nvme_ucx_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_ucx_req *ucx_req, *tmp;
+	struct spdk_nvme_cpl cpl;
+	struct nvme_ucx_qpair *tqpair = nvme_ucx_qpair(qpair);
+
+	cpl.status.sc = SPDK_NVME_SC_ABORTED_SQ_DELETION;
+	cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+
+	TAILQ_FOREACH_SAFE(ucx_req, &tqpair->outstanding_reqs, link, tmp) {
+		assert(ucx_req->req != NULL);
+		if (ucx_req->req->cmd.opc != SPDK_NVME_OPC_ASYNC_EVENT_REQUEST) {
+			continue;
+		}
+
+		nvme_ucx_req_complete(ucx_req, &cpl);
+		nvme_ucx_req_put(tqpair, ucx_req);
+	}
+}
+
+static struct spdk_nvme_transport_poll_group *
+nvme_ucx_poll_group_create(void)
+{
+	struct nvme_ucx_poll_group *group = calloc(1, sizeof(*group));
+
+	if (group == NULL) {
+		SPDK_ERRLOG("Unable to allocate poll group.\n");
+		return NULL;
+	}
+
+	return &group->group;
+}
+
+static int
+nvme_ucx_poll_group_connect_qpair(struct spdk_nvme_qpair *qpair)
+{
+	return 0;
+}
+
+static int
+nvme_ucx_poll_group_disconnect_qpair(struct spdk_nvme_qpair *qpair)
+{
+	return 0;
+}
+
+static int
+nvme_ucx_poll_group_add(struct spdk_nvme_transport_poll_group *tgroup,
+			struct spdk_nvme_qpair *qpair)
+{
+	return 0;
+}
+
+static int
+nvme_ucx_poll_group_remove(struct spdk_nvme_transport_poll_group *tgroup,
+			   struct spdk_nvme_qpair *qpair)
+{
+	if (qpair->poll_group_tailq_head == &tgroup->connected_qpairs) {
+		return nvme_poll_group_disconnect_qpair(qpair);
+	}
+
+	return 0;
+}
+
+static int64_t
+nvme_ucx_poll_group_process_completions(struct spdk_nvme_transport_poll_group *tgroup,
+					uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
+{
+	struct spdk_nvme_qpair *qpair, *tmp_qpair;
+	int32_t local_completions;
+	int64_t total_completions = 0;
+
+	/* Each queue pair progresses its own worker */
+	STAILQ_FOREACH_SAFE(qpair, &tgroup->connected_qpairs, poll_group_stailq, tmp_qpair) {
+		local_completions = spdk_nvme_qpair_process_completions(qpair, completions_per_qpair);
+		if (local_completions < 0) {
+			total_completions = -ENXIO;
+		} else if (total_completions >= 0) {
+			total_completions += local_completions;
+		}
+	}
+
+	STAILQ_FOREACH_SAFE(qpair, &tgroup->disconnected_qpairs, poll_group_stailq, tmp_qpair) {
+		disconnected_qpair_cb(qpair, tgroup->group->ctx);
+	}
+
+	return total_completions;
+}
+
+static int
+nvme_ucx_poll_group_destroy(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	struct nvme_ucx_poll_group *group = SPDK_CONTAINEROF(tgroup, struct nvme_ucx_poll_group, group);
+
+	if (!STAILQ_EMPTY(&tgroup->connected_qpairs) || !STAILQ_EMPTY(&tgroup->disconnected_qpairs)) {
+		return -EBUSY;
+	}
+
+	free(group);
+
+	return 0;
+}
+
+const struct spdk_nvme_transport_ops ucx_ops = {
+	.name = "UCX",
+	.type = SPDK_NVME_TRANSPORT_CUSTOM,
+	.ctrlr_construct = nvme_ucx_ctrlr_construct,
+	.ctrlr_scan = nvme_fabric_ctrlr_scan,
+	.ctrlr_destruct = nvme_ucx_ctrlr_destruct,
+	.ctrlr_enable = nvme_ucx_ctrlr_enable,
+
+	.ctrlr_set_reg_4 = nvme_fabric_ctrlr_set_reg_4,
+	.ctrlr_set_reg_8 = nvme_fabric_ctrlr_set_reg_8,
+	.ctrlr_get_reg_4 = nvme_fabric_ctrlr_get_reg_4,
+	.ctrlr_get_reg_8 = nvme_fabric_ctrlr_get_reg_8,
+
+	.ctrlr_get_max_xfer_size = nvme_ucx_ctrlr_get_max_xfer_size,
+	.ctrlr_get_max_sges = nvme_ucx_ctrlr_get_max_sges,
+
+	.ctrlr_create_io_qpair = nvme_ucx_ctrlr_create_io_qpair,
+	.ctrlr_delete_io_qpair = nvme_ucx_ctrlr_delete_io_qpair,
+	.ctrlr_connect_qpair = nvme_ucx_ctrlr_connect_qpair,
+	.ctrlr_disconnect_qpair = nvme_ucx_ctrlr_disconnect_qpair,
+
+	.qpair_abort_reqs = nvme_ucx_qpair_abort_reqs,
+	.qpair_reset = nvme_ucx_qpair_reset,
+	.qpair_submit_request = nvme_ucx_qpair_submit_request,
+	.qpair_process_completions = nvme_ucx_qpair_process_completions,
+	.qpair_iterate_requests = nvme_ucx_qpair_iterate_requests,
+	.admin_qpair_abort_aers = nvme_ucx_admin_qpair_abort_aers,
+
+	.poll_group_create = nvme_ucx_poll_group_create,
+	.poll_group_connect_qpair = nvme_ucx_poll_group_connect_qpair,
+	.poll_group_disconnect_qpair = nvme_ucx_poll_group_disconnect_qpair,
+	.poll_group_add = nvme_ucx_poll_group_add,
+	.poll_group_remove = nvme_ucx_poll_group_remove,
+	.poll_group_process_completions = nvme_ucx_poll_group_process_completions,
+	.poll_group_destroy = nvme_ucx_poll_group_destroy,
+};
+
+SPDK_NVME_TRANSPORT_REGISTER(ucx, &ucx_ops);
@@ -0,0 +1,1886 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * NVMe-oF transport over UCX. Capsules travel as UCP active messages, data
+ * that is not carried in the capsule is moved with UCP RMA straight from and
+ * into the host buffer, see spdk_internal/nvme_ucx.h.
+ */
+
+#include "spdk/stdinc.h"
+
+#include <ucp/api/ucp.h>
+
+#include "spdk/assert.h"
+#include "spdk/env.h"
+#include "spdk/likely.h"
+#include "spdk/nvmf_transport.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk_internal/log.h"
+#include "spdk_internal/nvme_ucx.h"
+
+#include "nvmf_internal.h"
+
+#define NVMF_UCX_RKEY_CACHE_SIZE	8
+/* Bound on how long a closing queue pair waits for its endpoint to flush */
+#define NVMF_UCX_CLOSE_TIMEOUT_US	(1000 * 1000)
+
+const struct spdk_nvmf_transport_ops spdk_nvmf_transport_ucx;
+
+enum spdk_nvmf_ucx_req_state {
+
+	/* The request is not currently in use */
+	UCX_REQUEST_STATE_FREE = 0,
+
+	/* Initial state when request first received */
+	UCX_REQUEST_STATE_NEW,
+
+	/* The request is queued until a data buffer is available. */
+	UCX_REQUEST_STATE_NEED_BUFFER,
+
+	/* The request is reading the data from the host buffer. */
+	UCX_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER,
+
+	/* The request is ready to execute at the block device */
+	UCX_REQUEST_STATE_READY_TO_EXECUTE,
+
+	/* The request is currently executing at the block device */
+	UCX_REQUEST_STATE_EXECUTING,
+
+	/* The request finished executing at the block device */
+	UCX_REQUEST_STATE_EXECUTED,
+
+	/* The request is ready to send a completion */
+	UCX_REQUEST_STATE_READY_TO_COMPLETE,
+
+	/* The request is writing the data into the host buffer and sending the completion. */
+	UCX_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST,
+
+	/* The request completed and can be marked free. */
+	UCX_REQUEST_STATE_COMPLETED,
+
+	/* Terminator */
+	UCX_REQUEST_NUM_STATES,
+};
+
+struct spdk_nvmf_ucx_qpair;
+struct spdk_nvmf_ucx_req;
+
+/* Lives in the private area of every UCP request issued by this transport. */
+struct nvmf_ucx_request {
+	/* NULL once the request was abandoned */
+	struct spdk_nvmf_ucx_qpair		*tqpair;
+	/* NULL for requests not issued on behalf of an NVMe request */
+	struct spdk_nvmf_ucx_req		*ucx_req;
+	TAILQ_ENTRY(nvmf_ucx_request)		link;
+};
+
+struct nvmf_ucx_rkey {
+	ucp_rkey_h				rkey;
+	uint32_t				refs;
+	bool					cached;
+	uint32_t				packed_len;
+	uint8_t					packed[NVME_UCX_MAX_RKEY_SIZE];
+};
+
+struct spdk_nvmf_ucx_req  {
+	struct spdk_nvmf_request		req;
+	struct spdk_nvme_cpl			rsp;
+	struct spdk_nvme_cmd			cmd;
+
+	enum spdk_nvmf_ucx_req_state		state;
+
+	/* In-capsule data buffer and the number of bytes the capsule carried */
+	uint8_t					*buf;
+	uint32_t				incapsule_len;
+
+	/* Packed rkey of the host buffer of a keyed SGL */
+	uint8_t					*packed_rkey;
+	uint32_t				packed_rkey_len;
+	struct nvmf_ucx_rkey			*rkey;
+	uint64_t				remote_addr;
+
+	/* UCP operations in flight */
+	uint32_t				pending;
+	bool					xfer_failed;
+	bool					rsp_sent;
+	/* Queued to be advanced by the poll group */
+	bool					ready;
+
+	TAILQ_ENTRY(spdk_nvmf_ucx_req)		state_link;
+	TAILQ_ENTRY(spdk_nvmf_ucx_req)		ready_link;
+};
+
+struct spdk_nvmf_ucx_transport;
+
+struct spdk_nvmf_ucx_port {
+	struct spdk_nvmf_ucx_transport		*ttransport;
+	const struct spdk_nvme_transport_id	*trid;
+	ucp_listener_h				listener;
+	TAILQ_ENTRY(spdk_nvmf_ucx_port)		link;
+};
+
+struct spdk_nvmf_ucx_qpair {
+	struct spdk_nvmf_qpair			qpair;
+	struct spdk_nvmf_ucx_poll_group		*group;
+	struct spdk_nvmf_ucx_port		*port;
+
+	/* Consumed by the endpoint creation */
+	ucp_conn_request_h			conn_request;
+	ucp_ep_h				ep;
+
+	/* The endpoint failed, or the host terminated the connection */
+	bool					failed;
+	bool					peer_term;
+	bool					disconnecting;
+	bool					in_group;
+
+	/* Pending close of the endpoint, once released by the generic layer */
+	void					*close_req;
+	uint64_t				close_timeout_tsc;
+
+	void					*bufs;
+	uint8_t					*packed_rkeys;
+	struct spdk_nvmf_ucx_req		*reqs;
+	uint32_t				resource_count;
+
+	/* Queues to track the requests in all states */
+	TAILQ_HEAD(, spdk_nvmf_ucx_req)		state_queue[UCX_REQUEST_NUM_STATES];
+	/* Number of requests in each state */
+	uint32_t				state_cntr[UCX_REQUEST_NUM_STATES];
+
+	struct nvmf_ucx_rkey			rkeys[NVMF_UCX_RKEY_CACHE_SIZE];
+	uint32_t				rkey_victim;
+
+	TAILQ_HEAD(, nvmf_ucx_request)		ucp_reqs;
+
+	TAILQ_ENTRY(spdk_nvmf_ucx_qpair)	link;
+};
+
+struct spdk_nvmf_ucx_poll_group {
+	struct spdk_nvmf_transport_poll_group	group;
+	/* All endpoints of the group's queue pairs live on this worker */
+	ucp_worker_h				worker;
+
+	TAILQ_HEAD(, spdk_nvmf_ucx_qpair)	qpairs;
+	/* Released queue pairs whose endpoint is still being closed */
+	TAILQ_HEAD(, spdk_nvmf_ucx_qpair)	closing;
+	/* Requests advanced outside of UCP callbacks */
+	TAILQ_HEAD(, spdk_nvmf_ucx_req)		ready_reqs;
+	/* Last queue pair a message was received for */
+	struct spdk_nvmf_ucx_qpair		*last_qpair;
+};
+
+struct spdk_nvmf_ucx_transport {
+	struct spdk_nvmf_transport		transport;
+
+	pthread_mutex_t				lock;
+
+	ucp_context_h				context;
+	/* Connection requests arrive on this worker, progressed by accept */
+	ucp_worker_h				listen_worker;
+	uint32_t				num_accepted;
+
+	TAILQ_HEAD(, spdk_nvmf_ucx_port)	ports;
+};
+
+static bool nvmf_ucx_req_process(struct spdk_nvmf_ucx_transport *ttransport,
+				 struct spdk_nvmf_ucx_req *ucx_req);
+
+static void
+nvmf_ucx_req_set_state(struct spdk_nvmf_ucx_req *ucx_req,
+		       enum spdk_nvmf_ucx_req_state state)
+{
+	struct spdk_nvmf_ucx_qpair *tqpair;
+
+	tqpair = SPDK_CONTAINEROF(ucx_req->req.qpair, struct spdk_nvmf_ucx_qpair, qpair);
+
+	TAILQ_REMOVE(&tqpair->state_queue[ucx_req->state], ucx_req, state_link);
+	assert(tqpair->state_cntr[ucx_req->state] > 0);
+	tqpair->state_cntr[ucx_req->state]--;
+
+	TAILQ_INSERT_TAIL(&tqpair->state_queue[state], ucx_req, state_link);
+	tqpair->state_cntr[state]++;
+
+	ucx_req->state = state;
+}
+
+static struct spdk_nvmf_ucx_req *
+nvmf_ucx_req_get(struct spdk_nvmf_ucx_qpair *tqpair)
+{
+	struct spdk_nvmf_ucx_req *ucx_req;
+
+	ucx_req = TAILQ_FIRST(&tqpair->state_queue[UCX_REQUEST_STATE_FREE]);
+	if (!ucx_req) {
+		return NULL;
+	}
+
+	memset(&ucx_req->rsp, 0, sizeof(ucx_req->rsp));
+	ucx_req->incapsule_len = 0;
+	ucx_req->packed_rkey_len = 0;
+	ucx_req->remote_addr = 0;
+	ucx_req->xfer_failed = false;
+	ucx_req->rsp_sent = false;
+	ucx_req->req.dif.dif_insert_or_strip = false;
+
+	nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_NEW);
+	return ucx_req;
+}
+
+/**
+ * Hand the request to the poll group, which advances it once the UCP
+ * progress that led here returned.
+ */
+static void
+nvmf_ucx_req_ready(struct spdk_nvmf_ucx_qpair *tqpair, struct spdk_nvmf_ucx_req *ucx_req)
+{
+	if (!ucx_req->ready) {
+		ucx_req->ready = true;
+		TAILQ_INSERT_TAIL(&tqpair->group->ready_reqs, ucx_req, ready_link);
+	}
+}
+
+static int
+nvmf_ucx_req_free(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_ucx_req *ucx_req = SPDK_CONTAINEROF(req, struct spdk_nvmf_ucx_req, req);
+	struct spdk_nvmf_ucx_transport *ttransport;
+
+	ttransport = SPDK_CONTAINEROF(req->qpair->transport, struct spdk_nvmf_ucx_transport, transport);
+	nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_COMPLETED);
+	nvmf_ucx_req_process(ttransport, ucx_req);
+
+	return 0;
+}
+
+static struct nvmf_ucx_rkey *
+nvmf_ucx_qpair_get_rkey(struct spdk_nvmf_ucx_qpair *tqpair, const uint8_t *packed, uint32_t len)
+{
+	struct nvmf_ucx_rkey *rkey = NULL;
+	ucs_status_t status;
+	uint32_t i, idx;
+
+	/* A host that registers its memory once sends the same few rkeys over and over */
+	for (i = 0; i < NVMF_UCX_RKEY_CACHE_SIZE; i++) {
+		rkey = &tqpair->rkeys[i];
+		if (rkey->rkey != NULL && rkey->packed_len == len &&
+		    memcmp(rkey->packed, packed, len) == 0) {
+			rkey->refs++;
+			return rkey;
+		}
+	}
+
+	rkey = NULL;
+	for (i = 0; i < NVMF_UCX_RKEY_CACHE_SIZE; i++) {
+		idx = (tqpair->rkey_victim + i) % NVMF_UCX_RKEY_CACHE_SIZE;
+		if (tqpair->rkeys[idx].refs == 0) {
+			rkey = &tqpair->rkeys[idx];
+			tqpair->rkey_victim = idx + 1;
+			break;
+		}
+	}
+
+	if (rkey != NULL) {
+		if (rkey->rkey != NULL) {
+			ucp_rkey_destroy(rkey->rkey);
+			rkey->rkey = NULL;
+		}
+		rkey->cached = true;
+	} else {
+		rkey = calloc(1, sizeof(*rkey));
+		if (rkey == NULL) {
+			return NULL;
+		}
+		rkey->cached = false;
+	}
+
+	status = ucp_ep_rkey_unpack(tqpair->ep, packed, &rkey->rkey);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_ep_rkey_unpack() failed: %s\n", ucs_status_string(status));
+		rkey->rkey = NULL;
+		if (!rkey->cached) {
+			free(rkey);
+		}
+		return NULL;
+	}
+
+	memcpy(rkey->packed, packed, len);
+	rkey->packed_len = len;
+	rkey->refs = 1;
+	return rkey;
+}
+
+static void
+nvmf_ucx_qpair_put_rkey(struct nvmf_ucx_rkey *rkey)
+{
+	assert(rkey->refs > 0);
+	if (--rkey->refs == 0 && !rkey->cached) {
+		ucp_rkey_destroy(rkey->rkey);
+		free(rkey);
+	}
+}
+
+static void
+nvmf_ucx_ucp_req_cb(void *request, ucs_status_t status)
+{
+	struct nvmf_ucx_request *ucp_req = request;
+	struct spdk_nvmf_ucx_qpair *tqpair = ucp_req->tqpair;
+	struct spdk_nvmf_ucx_req *ucx_req = ucp_req->ucx_req;
+
+	if (tqpair == NULL) {
+		return;
+	}
+
+	TAILQ_REMOVE(&tqpair->ucp_reqs, ucp_req, link);
+	ucp_request_free(request);
+
+	if (spdk_unlikely(status != UCS_OK)) {
+		SPDK_ERRLOG("UCP operation on tqpair=%p failed: %s\n", tqpair, ucs_status_string(status));
+		tqpair->failed = true;
+	}
+
+	if (ucx_req == NULL) {
+		return;
+	}
+
+	if (status != UCS_OK) {
+		ucx_req->xfer_failed = true;
+	}
+
+	assert(ucx_req->pending > 0);
+	if (--ucx_req->pending == 0) {
+		nvmf_ucx_req_ready(tqpair, ucx_req);
+	}
+}
+
+/**
+ * Account for a UCP operation just posted. Operations that completed in place
+ * need no tracking.
+ */
+static int
+nvmf_ucx_track(struct spdk_nvmf_ucx_qpair *tqpair, struct spdk_nvmf_ucx_req *ucx_req,
+	       ucs_status_ptr_t ptr)
+{
+	struct nvmf_ucx_request *ucp_req;
+
+	if (ptr == NULL) {
+		return 0;
+	}
+
+	if (UCS_PTR_IS_ERR(ptr)) {
+		SPDK_ERRLOG("UCP operation on tqpair=%p failed: %s\n", tqpair,
+			    ucs_status_string(UCS_PTR_STATUS(ptr)));
+		tqpair->failed = true;
+		return -EIO;
+	}
+
+	ucp_req = ptr;
+	ucp_req->tqpair = tqpair;
+	ucp_req->ucx_req = ucx_req;
+	TAILQ_INSERT_TAIL(&tqpair->ucp_reqs, ucp_req, link);
+	if (ucx_req != NULL) {
+		ucx_req->pending++;
+	}
+
+	return 0;
+}
+
+/**
+ * Abandon every UCP request still in flight. Their callbacks may run later
+ * and must not touch the queue pair.
+ */
+static void
+nvmf_ucx_qpair_orphan_reqs(struct spdk_nvmf_ucx_qpair *tqpair)
+{
+	struct nvmf_ucx_request *ucp_req;
+
+	while ((ucp_req = TAILQ_FIRST(&tqpair->ucp_reqs)) != NULL) {
+		TAILQ_REMOVE(&tqpair->ucp_reqs, ucp_req, link);
+		if (ucp_req->ucx_req != NULL) {
+			assert(ucp_req->ucx_req->pending > 0);
+			ucp_req->ucx_req->pending--;
+			ucp_req->ucx_req->xfer_failed = true;
+		}
+		ucp_req->tqpair = NULL;
+		ucp_req->ucx_req = NULL;
+		ucp_request_free(ucp_req);
+	}
+}
+
+static void
+nvmf_ucx_dump_qpair_req_contents(struct spdk_nvmf_ucx_qpair *tqpair)
+{
+	int i;
+	struct spdk_nvmf_ucx_req *ucx_req;
+
+	SPDK_ERRLOG("Dumping contents of queue pair (QID %d)\n", tqpair->qpair.qid);
+	for (i = 1; i < UCX_REQUEST_NUM_STATES; i++) {
+		SPDK_ERRLOG("\tNum of requests in state[%d] = %u\n", i, tqpair->state_cntr[i]);
+		TAILQ_FOREACH(ucx_req, &tqpair->state_queue[i], state_link) {
+			SPDK_ERRLOG("\t\tRequest Data From Pool: %d\n", ucx_req->req.data_from_pool);
+			SPDK_ERRLOG("\t\tRequest opcode: %d\n", ucx_req->req.cmd->nvmf_cmd.opcode);
+		}
+	}
+}
+
+static void
+nvmf_ucx_qpair_destroy(struct spdk_nvmf_ucx_qpair *tqpair)
+{
+	uint32_t i;
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "enter\n");
+
+	nvmf_ucx_qpair_orphan_reqs(tqpair);
+
+	if (tqpair->state_cntr[UCX_REQUEST_STATE_FREE] != tqpair->resource_count) {
+		SPDK_ERRLOG("tqpair(%p) free ucx request num is %u but should be %u\n", tqpair,
+			    tqpair->state_cntr[UCX_REQUEST_STATE_FREE],
+			    tqpair->resource_count);
+		nvmf_ucx_dump_qpair_req_contents(tqpair);
+	}
+
+	if (tqpair->conn_request != NULL) {
+		ucp_listener_reject(tqpair->port->listener, tqpair->conn_request);
+	}
+
+	/* None of the requests may be advanced by the group anymore */
+	for (i = 0; tqpair->reqs != NULL && i < tqpair->resource_count; i++) {
+		if (tqpair->reqs[i].ready) {
+			TAILQ_REMOVE(&tqpair->group->ready_reqs, &tqpair->reqs[i], ready_link);
+		}
+	}
+
+	for (i = 0; i < NVMF_UCX_RKEY_CACHE_SIZE; i++) {
+		if (tqpair->rkeys[i].rkey != NULL) {
+			ucp_rkey_destroy(tqpair->rkeys[i].rkey);
+		}
+	}
+
+	free(tqpair->reqs);
+	free(tqpair->packed_rkeys);
+	spdk_free(tqpair->bufs);
+	free(tqpair);
+	SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Leave\n");
+}
+
+static int
+nvmf_ucx_destroy(struct spdk_nvmf_transport *transport)
+{
+	struct spdk_nvmf_ucx_transport	*ttransport;
+
+	assert(transport != NULL);
+	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_ucx_transport, transport);
+
+	if (ttransport->listen_worker != NULL) {
+		ucp_worker_destroy(ttransport->listen_worker);
+	}
+	if (ttransport->context != NULL) {
+		ucp_cleanup(ttransport->context);
+	}
+
+	pthread_mutex_destroy(&ttransport->lock);
+	free(ttransport);
+	return 0;
+}
+
+static struct spdk_nvmf_transport *
+nvmf_ucx_create(struct spdk_nvmf_transport_opts *opts)
+{
+	struct spdk_nvmf_ucx_transport *ttransport;
+	ucp_params_t params = {};
+	ucp_worker_params_t worker_params = {};
+	ucs_status_t status;
+	uint32_t sge_count;
+	uint32_t min_shared_buffers;
+
+	ttransport = calloc(1, sizeof(*ttransport));
+	if (!ttransport) {
+		return NULL;
+	}
+
+	TAILQ_INIT(&ttransport->ports);
+	pthread_mutex_init(&ttransport->lock, NULL);
+
+	ttransport->transport.ops = &spdk_nvmf_transport_ucx;
+
+	SPDK_NOTICELOG("*** UCX Transport Init ***\n");
+
+	SPDK_INFOLOG(SPDK_LOG_NVMF_UCX, "*** UCX Transport Init ***\n"
+		     "  Transport opts:  max_ioq_depth=%d, max_io_size=%d,\n"
+		     "  max_io_qpairs_per_ctrlr=%d, io_unit_size=%d,\n"
+		     "  in_capsule_data_size=%d, max_aq_depth=%d\n"
+		     "  num_shared_buffers=%d, abort_timeout_sec=%d\n",
+		     opts->max_queue_depth,
+		     opts->max_io_size,
+		     opts->max_qpairs_per_ctrlr - 1,
+		     opts->io_unit_size,
+		     opts->in_capsule_data_size,
+		     opts->max_aq_depth,
+		     opts->num_shared_buffers,
+		     opts->abort_timeout_sec);
+
+	if (opts->dif_insert_or_strip) {
+		SPDK_ERRLOG("DIF insert/strip is not supported by the UCX transport\n");
+		nvmf_ucx_destroy(&ttransport->transport);
+		return NULL;
+	}
+
+	/* I/O unit size cannot be larger than max I/O size */
+	if (opts->io_unit_size > opts->max_io_size) {
+		opts->io_unit_size = opts->max_io_size;
+	}
+
+	sge_count = opts->max_io_size / opts->io_unit_size;
+	if (sge_count > SPDK_NVMF_MAX_SGL_ENTRIES) {
+		SPDK_ERRLOG("Unsupported IO Unit size specified, %d bytes\n", opts->io_unit_size);
+		nvmf_ucx_destroy(&ttransport->transport);
+		return NULL;
+	}
+
+	min_shared_buffers = spdk_thread_get_count() * opts->buf_cache_size;
+	if (min_shared_buffers > opts->num_shared_buffers) {
+		SPDK_ERRLOG("There are not enough buffers to satisfy"
+			    "per-poll group caches for each thread. (%" PRIu32 ")"
+			    "supplied. (%" PRIu32 ") required\n", opts->num_shared_buffers, min_shared_buffers);
+		SPDK_ERRLOG("Please specify a larger number of shared buffers\n");
+		nvmf_ucx_destroy(&ttransport->transport);
+		return NULL;
+	}
+
+	params.field_mask = UCP_PARAM_FIELD_FEATURES |
+			    UCP_PARAM_FIELD_REQUEST_SIZE |
+			    UCP_PARAM_FIELD_MT_WORKERS_SHARED;
+	params.features = UCP_FEATURE_AM | UCP_FEATURE_RMA;
+	params.request_size = sizeof(struct nvmf_ucx_request);
+	/* Every poll group drives a worker of its own on its own thread */
+	params.mt_workers_shared = 1;
+
+	/*
+	 * Transports are selected through the usual UCX_TLS/UCX_NET_DEVICES
+	 * variables. Local buffers are registered by UCX on first use, and
+	 * cached in its registration cache.
+	 */
+	status = ucp_init(&params, NULL, &ttransport->context);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_init() failed: %s\n", ucs_status_string(status));
+		ttransport->context = NULL;
+		nvmf_ucx_destroy(&ttransport->transport);
+		return NULL;
+	}
+
+	worker_params.field_mask = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+	worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+	status = ucp_worker_create(ttransport->context, &worker_params, &ttransport->listen_worker);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_worker_create() failed: %s\n", ucs_status_string(status));
+		ttransport->listen_worker = NULL;
+		nvmf_ucx_destroy(&ttransport->transport);
+		return NULL;
+	}
+
+	return &ttransport->transport;
+}
+
+static int
+nvmf_ucx_trsvcid_to_int(const char *trsvcid)
+{
+	unsigned long long ull;
+	char *end = NULL;
+
+	ull = strtoull(trsvcid, &end, 10);
+	if (end == NULL || end == trsvcid || *end != '\0') {
+		return -1;
+	}
+
+	/* Valid TCP/IP port numbers are in [0, 65535] */
+	if (ull > 65535) {
+		return -1;
+	}
+
+	return (int)ull;
+}
+
+/**
+ * Find an existing listening port.
+ *
+ * Caller must hold ttransport->lock.
+ */
+static struct spdk_nvmf_ucx_port *
+nvmf_ucx_find_port(struct spdk_nvmf_ucx_transport *ttransport,
+		   const struct spdk_nvme_transport_id *trid)
+{
+	struct spdk_nvmf_ucx_port *port;
+
+	TAILQ_FOREACH(port, &ttransport->ports, link) {
+		if (spdk_nvme_transport_id_compare(trid, port->trid) == 0) {
+			return port;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+nvmf_ucx_conn_handler(ucp_conn_request_h conn_request, void *arg)
+{
+	struct spdk_nvmf_ucx_port *port = arg;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "New connection accepted on %s port %s\n",
+		      port->trid->traddr, port->trid->trsvcid);
+
+	tqpair = calloc(1, sizeof(struct spdk_nvmf_ucx_qpair));
+	if (tqpair == NULL) {
+		SPDK_ERRLOG("Could not allocate new connection.\n");
+		ucp_listener_reject(port->listener, conn_request);
+		return;
+	}
+
+	tqpair->conn_request = conn_request;
+	tqpair->port = port;
+	tqpair->qpair.transport = &port->ttransport->transport;
+	port->ttransport->num_accepted++;
+
+	spdk_nvmf_tgt_new_qpair(tqpair->qpair.transport->tgt, &tqpair->qpair);
+}
+
+static int
+nvmf_ucx_parse_addr(struct sockaddr_storage *sa, socklen_t *salen,
+		    const struct spdk_nvme_transport_id *trid)
+{
+	struct addrinfo *res;
+	struct addrinfo hints;
+	int ret;
+
+	memset(&hints, 0, sizeof(hints));
+	switch (trid->adrfam) {
+	case SPDK_NVMF_ADRFAM_IPV4:
+		hints.ai_family = AF_INET;
+		break;
+	case SPDK_NVMF_ADRFAM_IPV6:
+		hints.ai_family = AF_INET6;
+		break;
+	default:
+		SPDK_ERRLOG("Unhandled ADRFAM %d\n", trid->adrfam);
+		return -EINVAL;
+	}
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+
+	ret = getaddrinfo(trid->traddr, trid->trsvcid, &hints, &res);
+	if (ret) {
+		SPDK_ERRLOG("getaddrinfo failed: %s (%d)\n", gai_strerror(ret), ret);
+		return -EINVAL;
+	}
+
+	if (res->ai_addrlen > sizeof(*sa)) {
+		SPDK_ERRLOG("getaddrinfo() ai_addrlen %zu too large\n", (size_t)res->ai_addrlen);
+		ret = -EINVAL;
+	} else {
+		memcpy(sa, res->ai_addr, res->ai_addrlen);
+		*salen = res->ai_addrlen;
+	}
+
+	freeaddrinfo(res);
+	return ret;
+}
+
+static int
+nvmf_ucx_listen(struct spdk_nvmf_transport *transport,
+		const struct spdk_nvme_transport_id *trid)
+{
+	struct spdk_nvmf_ucx_transport *ttransport;
+	struct spdk_nvmf_ucx_port *port;
+	ucp_listener_params_t params = {};
+	struct sockaddr_storage sa;
+	socklen_t salen;
+	ucs_status_t status;
+	int rc;
+
+	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_ucx_transport, transport);
+
+	if (nvmf_ucx_trsvcid_to_int(trid->trsvcid) < 0) {
+		SPDK_ERRLOG("Invalid trsvcid '%s'\n", trid->trsvcid);
+		return -EINVAL;
+	}
+
+	rc = nvmf_ucx_parse_addr(&sa, &salen, trid);
+	if (rc != 0) {
+		return rc;
+	}
+
+	pthread_mutex_lock(&ttransport->lock);
+	port = calloc(1, sizeof(*port));
+	if (!port) {
+		SPDK_ERRLOG("Port allocation failed\n");
+		pthread_mutex_unlock(&ttransport->lock);
+		return -ENOMEM;
+	}
+
+	port->ttransport = ttransport;
+	port->trid = trid;
+
+	params.field_mask = UCP_LISTENER_PARAM_FIELD_SOCK_ADDR |
+			    UCP_LISTENER_PARAM_FIELD_CONN_HANDLER;
+	params.sockaddr.addr = (const struct sockaddr *)&sa;
+	params.sockaddr.addrlen = salen;
+	params.conn_handler.cb = nvmf_ucx_conn_handler;
+	params.conn_handler.arg = port;
+	status = ucp_listener_create(ttransport->listen_worker, &params, &port->listener);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_listener_create(%s, %s) failed: %s\n",
+			    trid->traddr, trid->trsvcid, ucs_status_string(status));
+		free(port);
+		pthread_mutex_unlock(&ttransport->lock);
+		return -EIO;
+	}
+
+	SPDK_NOTICELOG("*** NVMe/UCX Target Listening on %s port %s ***\n",
+		       trid->traddr, trid->trsvcid);
+
+	TAILQ_INSERT_TAIL(&ttransport->ports, port, link);
+	pthread_mutex_unlock(&ttransport->lock);
+	return 0;
+}
+
+static void
+nvmf_ucx_stop_listen(struct spdk_nvmf_transport *transport,
+		     const struct spdk_nvme_transport_id *trid)
+{
+	struct spdk_nvmf_ucx_transport *ttransport;
+	struct spdk_nvmf_ucx_port *port;
+
+	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_ucx_transport, transport);
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Removing listen address %s port %s\n",
+		      trid->traddr, trid->trsvcid);
+
+	pthread_mutex_lock(&ttransport->lock);
+	port = nvmf_ucx_find_port(ttransport, trid);
+	if (port) {
+		TAILQ_REMOVE(&ttransport->ports, port, link);
+		ucp_listener_destroy(port->listener);
+		free(port);
+	}
+
+	pthread_mutex_unlock(&ttransport->lock);
+}
+
+static uint32_t
+nvmf_ucx_accept(struct spdk_nvmf_transport *transport)
+{
+	struct spdk_nvmf_ucx_transport *ttransport;
+	uint32_t count;
+
+	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_ucx_transport, transport);
+
+	/* Connection requests are handed over from nvmf_ucx_conn_handler() */
+	ttransport->num_accepted = 0;
+	while (ucp_worker_progress(ttransport->listen_worker)) {
+	}
+	count = ttransport->num_accepted;
+
+	return count;
+}
+
+static void
+nvmf_ucx_discover(struct spdk_nvmf_transport *transport,
+		  struct spdk_nvme_transport_id *trid,
+		  struct spdk_nvmf_discovery_log_page_entry *entry)
+{
+	/*
+	 * No NVMe-oF transport type is assigned to UCX. Hosts find the
+	 * address here but have to be told the transport out of band.
+	 */
+	entry->trtype = SPDK_NVMF_TRTYPE_INTRA_HOST;
+	entry->adrfam = trid->adrfam;
+	entry->treq.secure_channel = SPDK_NVMF_TREQ_SECURE_CHANNEL_NOT_REQUIRED;
+
+	spdk_strcpy_pad(entry->trsvcid, trid->trsvcid, sizeof(entry->trsvcid), ' ');
+	spdk_strcpy_pad(entry->traddr, trid->traddr, sizeof(entry->traddr), ' ');
+}
+
+static struct spdk_nvmf_ucx_qpair *
+nvmf_ucx_group_find_qpair(struct spdk_nvmf_ucx_poll_group *tgroup, ucp_ep_h ep)
+{
+	struct spdk_nvmf_ucx_qpair *tqpair;
+
+	if (tgroup->last_qpair != NULL && tgroup->last_qpair->ep == ep) {
+		return tgroup->last_qpair;
+	}
+
+	TAILQ_FOREACH(tqpair, &tgroup->qpairs, link) {
+		if (tqpair->ep == ep) {
+			tgroup->last_qpair = tqpair;
+			return tqpair;
+		}
+	}
+
+	/* Closing queue pairs only need to learn about failures */
+	TAILQ_FOREACH(tqpair, &tgroup->closing, link) {
+		if (tqpair->ep == ep) {
+			return tqpair;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Store a received capsule in a free request. The data is only valid during
+ * the callback, so the command, the in-capsule data and the packed rkey are
+ * copied; the request is processed once progress returned.
+ */
+static ucs_status_t
+nvmf_ucx_capsule_cmd_handler(void *arg, void *data, size_t length, ucp_ep_h reply_ep,
+			     unsigned flags)
+{
+	struct spdk_nvmf_ucx_poll_group *tgroup = arg;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	struct spdk_nvmf_ucx_req *ucx_req;
+	const struct nvme_ucx_capsule_cmd *capsule = data;
+	uint32_t payload_len;
+
+	tqpair = nvmf_ucx_group_find_qpair(tgroup, reply_ep);
+	if (spdk_unlikely(tqpair == NULL || !tqpair->in_group || tqpair->failed)) {
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Dropping capsule from ep=%p\n", reply_ep);
+		return UCS_OK;
+	}
+
+	if (spdk_unlikely(length < sizeof(*capsule))) {
+		SPDK_ERRLOG("Capsule of %zu bytes on tqpair=%p is too short\n", length, tqpair);
+		tqpair->failed = true;
+		return UCS_OK;
+	}
+	payload_len = length - sizeof(*capsule);
+
+	if (spdk_unlikely(capsule->rkey_len != 0 &&
+			  (capsule->rkey_len != payload_len || capsule->rkey_len > NVME_UCX_MAX_RKEY_SIZE))) {
+		SPDK_ERRLOG("Invalid rkey of %u bytes on tqpair=%p\n", capsule->rkey_len, tqpair);
+		tqpair->failed = true;
+		return UCS_OK;
+	}
+
+	if (spdk_unlikely(capsule->rkey_len == 0 &&
+			  payload_len > tqpair->qpair.transport->opts.in_capsule_data_size)) {
+		SPDK_ERRLOG("In-capsule data of %u bytes on tqpair=%p exceeds 0x%x\n", payload_len, tqpair,
+			    tqpair->qpair.transport->opts.in_capsule_data_size);
+		tqpair->failed = true;
+		return UCS_OK;
+	}
+
+	ucx_req = nvmf_ucx_req_get(tqpair);
+	if (spdk_unlikely(ucx_req == NULL)) {
+		/* The host submitted more commands than the queue holds */
+		SPDK_ERRLOG("No free request on tqpair=%p\n", tqpair);
+		tqpair->failed = true;
+		return UCS_OK;
+	}
+
+	ucx_req->cmd = capsule->ccsqe;
+	if (capsule->rkey_len != 0) {
+		memcpy(ucx_req->packed_rkey, capsule + 1, payload_len);
+		ucx_req->packed_rkey_len = payload_len;
+	} else if (payload_len != 0) {
+		memcpy(ucx_req->buf, capsule + 1, payload_len);
+		ucx_req->incapsule_len = payload_len;
+	}
+
+	nvmf_ucx_req_ready(tqpair, ucx_req);
+	return UCS_OK;
+}
+
+static ucs_status_t
+nvmf_ucx_term_handler(void *arg, void *data, size_t length, ucp_ep_h reply_ep, unsigned flags)
+{
+	struct spdk_nvmf_ucx_poll_group *tgroup = arg;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+
+	tqpair = nvmf_ucx_group_find_qpair(tgroup, reply_ep);
+	if (tqpair != NULL) {
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Host terminated tqpair=%p\n", tqpair);
+		tqpair->peer_term = true;
+		tqpair->failed = true;
+	}
+
+	return UCS_OK;
+}
+
+static void
+nvmf_ucx_err_cb(void *arg, ucp_ep_h ep, ucs_status_t status)
+{
+	struct spdk_nvmf_ucx_poll_group *tgroup = arg;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+
+	tqpair = nvmf_ucx_group_find_qpair(tgroup, ep);
+	if (tqpair != NULL) {
+		SPDK_ERRLOG("UCX endpoint of tqpair=%p failed: %s\n", tqpair, ucs_status_string(status));
+		tqpair->failed = true;
+	}
+}
+
+static struct spdk_nvmf_transport_poll_group *
+nvmf_ucx_poll_group_create(struct spdk_nvmf_transport *transport)
+{
+	struct spdk_nvmf_ucx_transport *ttransport;
+	struct spdk_nvmf_ucx_poll_group *tgroup;
+	ucp_worker_params_t worker_params = {};
+	ucs_status_t status;
+
+	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_ucx_transport, transport);
+
+	tgroup = calloc(1, sizeof(*tgroup));
+	if (!tgroup) {
+		return NULL;
+	}
+
+	worker_params.field_mask = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+	worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+	status = ucp_worker_create(ttransport->context, &worker_params, &tgroup->worker);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_worker_create() failed: %s\n", ucs_status_string(status));
+		goto cleanup;
+	}
+
+	status = ucp_worker_set_am_handler(tgroup->worker, NVME_UCX_AM_ID_CAPSULE_CMD,
+					   nvmf_ucx_capsule_cmd_handler, tgroup, UCP_AM_FLAG_WHOLE_MSG);
+	if (status == UCS_OK) {
+		status = ucp_worker_set_am_handler(tgroup->worker, NVME_UCX_AM_ID_TERM,
+						   nvmf_ucx_term_handler, tgroup, UCP_AM_FLAG_WHOLE_MSG);
+	}
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_worker_set_am_handler() failed: %s\n", ucs_status_string(status));
+		ucp_worker_destroy(tgroup->worker);
+		goto cleanup;
+	}
+
+	TAILQ_INIT(&tgroup->qpairs);
+	TAILQ_INIT(&tgroup->closing);
+	TAILQ_INIT(&tgroup->ready_reqs);
+
+	return &tgroup->group;
+
+cleanup:
+	free(tgroup);
+	return NULL;
+}
+
+static void nvmf_ucx_qpair_check_closed(struct spdk_nvmf_ucx_qpair *tqpair, bool force);
+
+static void
+nvmf_ucx_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
+{
+	struct spdk_nvmf_ucx_poll_group *tgroup;
+	struct spdk_nvmf_ucx_qpair *tqpair, *tmp;
+	uint64_t deadline_tsc;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_ucx_poll_group, group);
+
+	/* Give the endpoints still closing a bounded chance to flush */
+	deadline_tsc = spdk_get_ticks() +
+		       NVMF_UCX_CLOSE_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	while (!TAILQ_EMPTY(&tgroup->closing) && spdk_get_ticks() < deadline_tsc) {
+		ucp_worker_progress(tgroup->worker);
+		TAILQ_FOREACH_SAFE(tqpair, &tgroup->closing, link, tmp) {
+			nvmf_ucx_qpair_check_closed(tqpair, false);
+		}
+	}
+
+	TAILQ_FOREACH_SAFE(tqpair, &tgroup->closing, link, tmp) {
+		nvmf_ucx_qpair_check_closed(tqpair, true);
+	}
+
+	ucp_worker_destroy(tgroup->worker);
+	free(tgroup);
+}
+
+static int
+nvmf_ucx_qpair_init_mem_resource(struct spdk_nvmf_ucx_qpair *tqpair)
+{
+	uint32_t i;
+	struct spdk_nvmf_transport_opts *opts;
+	uint32_t in_capsule_data_size;
+
+	opts = &tqpair->qpair.transport->opts;
+
+	in_capsule_data_size = opts->in_capsule_data_size;
+
+	tqpair->resource_count = opts->max_queue_depth;
+
+	tqpair->reqs = calloc(tqpair->resource_count, sizeof(*tqpair->reqs));
+	if (!tqpair->reqs) {
+		SPDK_ERRLOG("Unable to allocate reqs on tqpair=%p\n", tqpair);
+		return -1;
+	}
+
+	tqpair->packed_rkeys = calloc(tqpair->resource_count, NVME_UCX_MAX_RKEY_SIZE);
+	if (!tqpair->packed_rkeys) {
+		SPDK_ERRLOG("Unable to allocate rkey buffers on tqpair=%p\n", tqpair);
+		return -1;
+	}
+
+	if (in_capsule_data_size) {
+		tqpair->bufs = spdk_zmalloc(tqpair->resource_count * in_capsule_data_size, 0x1000,
+					    NULL, SPDK_ENV_LCORE_ID_ANY,
+					    SPDK_MALLOC_DMA);
+		if (!tqpair->bufs) {
+			SPDK_ERRLOG("Unable to allocate bufs on tqpair=%p.\n", tqpair);
+			return -1;
+		}
+	}
+
+	for (i = 0; i < UCX_REQUEST_NUM_STATES; i++) {
+		TAILQ_INIT(&tqpair->state_queue[i]);
+	}
+
+	for (i = 0; i < tqpair->resource_count; i++) {
+		struct spdk_nvmf_ucx_req *ucx_req = &tqpair->reqs[i];
+
+		ucx_req->req.qpair = &tqpair->qpair;
+
+		/* Set up memory to receive commands */
+		if (tqpair->bufs) {
+			ucx_req->buf = (void *)((uintptr_t)tqpair->bufs + (i * in_capsule_data_size));
+		}
+		ucx_req->packed_rkey = tqpair->packed_rkeys + i * NVME_UCX_MAX_RKEY_SIZE;
+
+		/* Set the cmdn and rsp */
+		ucx_req->req.rsp = (union nvmf_c2h_msg *)&ucx_req->rsp;
+		ucx_req->req.cmd = (union nvmf_h2c_msg *)&ucx_req->cmd;
+
+		/* Initialize request state to FREE */
+		ucx_req->state = UCX_REQUEST_STATE_FREE;
+		TAILQ_INSERT_TAIL(&tqpair->state_queue[ucx_req->state], ucx_req, state_link);
+		tqpair->state_cntr[UCX_REQUEST_STATE_FREE]++;
+	}
+
+	return 0;
+}
+
+static int
+nvmf_ucx_poll_group_add(struct spdk_nvmf_transport_poll_group *group,
+			struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_ucx_poll_group	*tgroup;
+	struct spdk_nvmf_ucx_qpair	*tqpair;
+	ucp_ep_params_t			ep_params = {};
+	ucs_status_t			status;
+	int				rc;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_ucx_poll_group, group);
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_ucx_qpair, qpair);
+
+	TAILQ_INIT(&tqpair->ucp_reqs);
+
+	rc = nvmf_ucx_qpair_init_mem_resource(tqpair);
+	if (rc < 0) {
+		SPDK_ERRLOG("Cannot init memory resource info for tqpair=%p\n", tqpair);
+		return -1;
+	}
+
+	/*
+	 * The endpoint is created on the worker of the group, not on the one the
+	 * listener runs on. No peer failure mode, tcp and shm do not support it;
+	 * a host going away says so with NVME_UCX_AM_ID_TERM.
+	 */
+	ep_params.field_mask = UCP_EP_PARAM_FIELD_CONN_REQUEST |
+			       UCP_EP_PARAM_FIELD_ERR_HANDLER;
+	ep_params.conn_request = tqpair->conn_request;
+	ep_params.err_handler.cb = nvmf_ucx_err_cb;
+	ep_params.err_handler.arg = tgroup;
+	status = ucp_ep_create(tgroup->worker, &ep_params, &tqpair->ep);
+	/* The connection request is released either way */
+	tqpair->conn_request = NULL;
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_ep_create() failed for tqpair=%p: %s\n", tqpair,
+			    ucs_status_string(status));
+		tqpair->ep = NULL;
+		return -1;
+	}
+
+	tqpair->group = tgroup;
+	tqpair->in_group = true;
+	TAILQ_INSERT_TAIL(&tgroup->qpairs, tqpair, link);
+
+	return 0;
+}
+
+static int
+nvmf_ucx_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
+			   struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_ucx_poll_group	*tgroup;
+	struct spdk_nvmf_ucx_qpair	*tqpair;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_ucx_poll_group, group);
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_ucx_qpair, qpair);
+
+	if (!tqpair->in_group) {
+		return 0;
+	}
+
+	assert(tqpair->group == tgroup);
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "remove tqpair=%p from the tgroup=%p\n", tqpair, tgroup);
+	TAILQ_REMOVE(&tgroup->qpairs, tqpair, link);
+	tqpair->in_group = false;
+	if (tgroup->last_qpair == tqpair) {
+		tgroup->last_qpair = NULL;
+	}
+
+	return 0;
+}
+
+static int
+nvmf_ucx_req_parse_sgl(struct spdk_nvmf_ucx_req *ucx_req,
+		       struct spdk_nvmf_transport *transport,
+		       struct spdk_nvmf_transport_poll_group *group)
+{
+	struct spdk_nvmf_request		*req = &ucx_req->req;
+	struct spdk_nvmf_ucx_qpair		*tqpair;
+	struct spdk_nvme_cmd			*cmd;
+	struct spdk_nvme_cpl			*rsp;
+	struct spdk_nvme_sgl_descriptor		*sgl;
+	uint32_t				length;
+
+	tqpair = SPDK_CONTAINEROF(req->qpair, struct spdk_nvmf_ucx_qpair, qpair);
+	cmd = &req->cmd->nvme_cmd;
+	rsp = &req->rsp->nvme_cpl;
+	sgl = &cmd->dptr.sgl1;
+
+	if (sgl->generic.type == SPDK_NVME_SGL_TYPE_KEYED_DATA_BLOCK &&
+	    (sgl->keyed.subtype == SPDK_NVME_SGL_SUBTYPE_ADDRESS ||
+	     sgl->keyed.subtype == SPDK_NVME_SGL_SUBTYPE_INVALIDATE_KEY)) {
+		length = sgl->keyed.length;
+		if (length > transport->opts.max_io_size) {
+			SPDK_ERRLOG("SGL length 0x%x exceeds max io size 0x%x\n",
+				    length, transport->opts.max_io_size);
+			rsp->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+			return -1;
+		}
+
+		if (ucx_req->packed_rkey_len == 0) {
+			SPDK_ERRLOG("Keyed SGL without an rkey on tqpair=%p\n", tqpair);
+			rsp->status.sc = SPDK_NVME_SC_SGL_DESCRIPTOR_TYPE_INVALID;
+			return -1;
+		}
+
+		/* fill request length and populate iovs */
+		req->length = length;
+
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Data requested length= 0x%x\n", length);
+
+		if (spdk_nvmf_request_get_buffers(req, group, transport, length)) {
+			/* No available buffers. Queue this request up. */
+			SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "No available large data buffers. Queueing request %p\n",
+				      ucx_req);
+			return 0;
+		}
+
+		ucx_req->rkey = nvmf_ucx_qpair_get_rkey(tqpair, ucx_req->packed_rkey,
+							ucx_req->packed_rkey_len);
+		if (ucx_req->rkey == NULL) {
+			spdk_nvmf_request_free_buffers(req, group, transport);
+			rsp->status.sc = SPDK_NVME_SC_DATA_TRANSFER_ERROR;
+			return -1;
+		}
+		ucx_req->remote_addr = sgl->address;
+
+		/* backward compatible */
+		req->data = req->iov[0].iov_base;
+
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Request %p took %d buffer/s from central pool, and data=%p\n",
+			      ucx_req, req->iovcnt, req->data);
+
+		return 0;
+	} else if (sgl->generic.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK &&
+		   sgl->unkeyed.subtype == SPDK_NVME_SGL_SUBTYPE_OFFSET) {
+		uint64_t offset = sgl->address;
+		uint32_t max_len = ucx_req->incapsule_len;
+
+		length = sgl->unkeyed.length;
+
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "In-capsule data: offset 0x%" PRIx64 ", length 0x%x\n",
+			      offset, length);
+
+		if (offset > max_len) {
+			SPDK_ERRLOG("In-capsule offset 0x%" PRIx64 " exceeds capsule length 0x%x\n",
+				    offset, max_len);
+			rsp->status.sc = SPDK_NVME_SC_INVALID_SGL_OFFSET;
+			return -1;
+		}
+		max_len -= (uint32_t)offset;
+
+		if (length > max_len) {
+			SPDK_ERRLOG("In-capsule data length 0x%x exceeds capsule length 0x%x\n",
+				    length, max_len);
+			rsp->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+			return -1;
+		}
+
+		req->data = ucx_req->buf + offset;
+		req->data_from_pool = false;
+		req->length = length;
+
+		req->iov[0].iov_base = req->data;
+		req->iov[0].iov_len = length;
+		req->iovcnt = 1;
+
+		return 0;
+	}
+
+	SPDK_ERRLOG("Invalid NVMf I/O Command SGL:  Type 0x%x, Subtype 0x%x\n",
+		    sgl->generic.type, sgl->generic.subtype);
+	rsp->status.sc = SPDK_NVME_SC_SGL_DESCRIPTOR_TYPE_INVALID;
+	return -1;
+}
+
+/**
+ * Read the data of a keyed SGL from the host buffer, one get per buffer of
+ * the request.
+ */
+static void
+nvmf_ucx_read_host_data(struct spdk_nvmf_ucx_qpair *tqpair, struct spdk_nvmf_ucx_req *ucx_req)
+{
+	struct spdk_nvmf_request *req = &ucx_req->req;
+	uint64_t remote_addr = ucx_req->remote_addr;
+	ucs_status_ptr_t ptr;
+	uint32_t i;
+
+	for (i = 0; i < req->iovcnt; i++) {
+		ptr = ucp_get_nb(tqpair->ep, req->iov[i].iov_base, req->iov[i].iov_len,
+				 remote_addr, ucx_req->rkey->rkey, nvmf_ucx_ucp_req_cb);
+		if (nvmf_ucx_track(tqpair, ucx_req, ptr) != 0) {
+			ucx_req->xfer_failed = true;
+			break;
+		}
+		remote_addr += req->iov[i].iov_len;
+	}
+}
+
+/**
+ * Write the data into the host buffer. The completion is only sent once the
+ * flush reported the puts done, see nvmf_ucx_req_process().
+ */
+static void
+nvmf_ucx_write_host_data(struct spdk_nvmf_ucx_qpair *tqpair, struct spdk_nvmf_ucx_req *ucx_req)
+{
+	struct spdk_nvmf_request *req = &ucx_req->req;
+	uint64_t remote_addr = ucx_req->remote_addr;
+	ucs_status_t status;
+	ucs_status_ptr_t ptr;
+	uint32_t remaining = req->length;
+	size_t len;
+	uint32_t i;
+
+	for (i = 0; i < req->iovcnt && remaining > 0; i++) {
+		len = spdk_min(req->iov[i].iov_len, remaining);
+		status = ucp_put_nbi(tqpair->ep, req->iov[i].iov_base, len, remote_addr,
+				     ucx_req->rkey->rkey);
+		if (UCS_STATUS_IS_ERR(status)) {
+			SPDK_ERRLOG("ucp_put_nbi() on tqpair=%p failed: %s\n", tqpair,
+				    ucs_status_string(status));
+			tqpair->failed = true;
+			ucx_req->xfer_failed = true;
+			return;
+		}
+		remote_addr += len;
+		remaining -= len;
+	}
+
+	ptr = ucp_ep_flush_nb(tqpair->ep, 0, nvmf_ucx_ucp_req_cb);
+	if (nvmf_ucx_track(tqpair, ucx_req, ptr) != 0) {
+		ucx_req->xfer_failed = true;
+	}
+}
+
+static void
+nvmf_ucx_send_capsule_resp(struct spdk_nvmf_ucx_qpair *tqpair, struct spdk_nvmf_ucx_req *ucx_req)
+{
+	ucs_status_ptr_t ptr;
+
+	ucx_req->rsp_sent = true;
+	ptr = ucp_am_send_nb(tqpair->ep, NVME_UCX_AM_ID_CAPSULE_RESP, &ucx_req->rsp,
+			     sizeof(ucx_req->rsp), ucp_dt_make_contig(1), nvmf_ucx_ucp_req_cb,
+			     UCP_AM_SEND_REPLY);
+	if (nvmf_ucx_track(tqpair, ucx_req, ptr) != 0) {
+		ucx_req->xfer_failed = true;
+	}
+}
+
+static int
+request_transfer_out(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_ucx_req	*ucx_req;
+	struct spdk_nvmf_qpair		*qpair;
+	struct spdk_nvmf_ucx_qpair	*tqpair;
+	struct spdk_nvme_cpl		*rsp;
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "enter\n");
+
+	qpair = req->qpair;
+	rsp = &req->rsp->nvme_cpl;
+	ucx_req = SPDK_CONTAINEROF(req, struct spdk_nvmf_ucx_req, req);
+
+	/* Advance our sq_head pointer */
+	if (qpair->sq_head == qpair->sq_head_max) {
+		qpair->sq_head = 0;
+	} else {
+		qpair->sq_head++;
+	}
+	rsp->sqhd = qpair->sq_head;
+
+	tqpair = SPDK_CONTAINEROF(ucx_req->req.qpair, struct spdk_nvmf_ucx_qpair, qpair);
+	nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	if (rsp->status.sc == SPDK_NVME_SC_SUCCESS && req->xfer == SPDK_NVME_DATA_CONTROLLER_TO_HOST &&
+	    ucx_req->rkey != NULL) {
+		nvmf_ucx_write_host_data(tqpair, ucx_req);
+	} else {
+		nvmf_ucx_send_capsule_resp(tqpair, ucx_req);
+	}
+
+	return 0;
+}
+
+static bool
+nvmf_ucx_req_process(struct spdk_nvmf_ucx_transport *ttransport,
+		     struct spdk_nvmf_ucx_req *ucx_req)
+{
+	struct spdk_nvmf_ucx_qpair		*tqpair;
+	int					rc;
+	enum spdk_nvmf_ucx_req_state		prev_state;
+	bool					progress = false;
+	struct spdk_nvmf_transport		*transport = &ttransport->transport;
+	struct spdk_nvmf_transport_poll_group	*group;
+
+	tqpair = SPDK_CONTAINEROF(ucx_req->req.qpair, struct spdk_nvmf_ucx_qpair, qpair);
+	group = &tqpair->group->group;
+	assert(ucx_req->state != UCX_REQUEST_STATE_FREE);
+
+	/*
+	 * If the qpair is not active, we need to abort the outstanding requests.
+	 * Requests with UCP operations in flight wait for them, their buffers
+	 * may still be written to.
+	 */
+	if (tqpair->qpair.state != SPDK_NVMF_QPAIR_ACTIVE && ucx_req->pending == 0 &&
+	    ucx_req->state != UCX_REQUEST_STATE_EXECUTING) {
+		if (ucx_req->state == UCX_REQUEST_STATE_NEED_BUFFER) {
+			STAILQ_REMOVE(&group->pending_buf_queue, &ucx_req->req, spdk_nvmf_request, buf_link);
+		}
+		nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_COMPLETED);
+	}
+
+	/* The loop here is to allow for several back-to-back state changes. */
+	do {
+		prev_state = ucx_req->state;
+
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Request %p entering state %d on tqpair=%p\n", ucx_req,
+			      prev_state, tqpair);
+
+		switch (ucx_req->state) {
+		case UCX_REQUEST_STATE_FREE:
+			/* Some external code must kick a request into UCX_REQUEST_STATE_NEW
+			 * to escape this state. */
+			break;
+		case UCX_REQUEST_STATE_NEW:
+			/* The next state transition depends on the data transfer needs of this request. */
+			ucx_req->req.xfer = spdk_nvmf_req_get_xfer(&ucx_req->req);
+
+			/* If no data to transfer, ready to execute. */
+			if (ucx_req->req.xfer == SPDK_NVME_DATA_NONE) {
+				nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_READY_TO_EXECUTE);
+				break;
+			}
+
+			nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_NEED_BUFFER);
+			STAILQ_INSERT_TAIL(&group->pending_buf_queue, &ucx_req->req, buf_link);
+			break;
+		case UCX_REQUEST_STATE_NEED_BUFFER:
+			assert(ucx_req->req.xfer != SPDK_NVME_DATA_NONE);
+
+			if (ucx_req->incapsule_len == 0 && (&ucx_req->req != STAILQ_FIRST(&group->pending_buf_queue))) {
+				SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX,
+					      "Not the first element to wait for the buf for ucx_req(%p) on tqpair=%p\n",
+					      ucx_req, tqpair);
+				/* This request needs to wait in line to obtain a buffer */
+				break;
+			}
+
+			/* Try to get a data buffer */
+			rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, group);
+			if (rc < 0) {
+				STAILQ_REMOVE(&group->pending_buf_queue, &ucx_req->req, spdk_nvmf_request, buf_link);
+				nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_READY_TO_COMPLETE);
+				break;
+			}
+
+			if (!ucx_req->req.data) {
+				SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "No buffer allocated for ucx_req(%p) on tqpair(%p\n)",
+					      ucx_req, tqpair);
+				/* No buffers available. */
+				break;
+			}
+
+			STAILQ_REMOVE(&group->pending_buf_queue, &ucx_req->req, spdk_nvmf_request, buf_link);
+
+			/* If data is transferring from host to controller, we need to do a transfer from the host. */
+			if (ucx_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER && ucx_req->req.data_from_pool) {
+				nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+				nvmf_ucx_read_host_data(tqpair, ucx_req);
+				break;
+			}
+
+			nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_READY_TO_EXECUTE);
+			break;
+		case UCX_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER:
+			/* Completion of the last get kicks the request out of this state. */
+			if (ucx_req->pending > 0) {
+				break;
+			}
+
+			if (spdk_unlikely(ucx_req->xfer_failed)) {
+				ucx_req->rsp.status.sct = SPDK_NVME_SCT_GENERIC;
+				ucx_req->rsp.status.sc = SPDK_NVME_SC_DATA_TRANSFER_ERROR;
+				nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_READY_TO_COMPLETE);
+				break;
+			}
+
+			nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_READY_TO_EXECUTE);
+			break;
+		case UCX_REQUEST_STATE_READY_TO_EXECUTE:
+			nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_EXECUTING);
+			spdk_nvmf_request_exec(&ucx_req->req);
+			break;
+		case UCX_REQUEST_STATE_EXECUTING:
+			/* Some external code must kick a request into UCX_REQUEST_STATE_EXECUTED
+			 * to escape this state. */
+			break;
+		case UCX_REQUEST_STATE_EXECUTED:
+			nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_READY_TO_COMPLETE);
+			break;
+		case UCX_REQUEST_STATE_READY_TO_COMPLETE:
+			rc = request_transfer_out(&ucx_req->req);
+			assert(rc == 0); /* No good way to handle this currently */
+			break;
+		case UCX_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST:
+			/* Completion of the flush, then of the response send, kicks
+			 * the request on. */
+			if (ucx_req->pending > 0) {
+				break;
+			}
+
+			if (!ucx_req->rsp_sent && !ucx_req->xfer_failed) {
+				nvmf_ucx_send_capsule_resp(tqpair, ucx_req);
+				break;
+			}
+
+			nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_COMPLETED);
+			break;
+		case UCX_REQUEST_STATE_COMPLETED:
+			if (ucx_req->req.data_from_pool) {
+				spdk_nvmf_request_free_buffers(&ucx_req->req, group, transport);
+			}
+			if (ucx_req->rkey != NULL) {
+				nvmf_ucx_qpair_put_rkey(ucx_req->rkey);
+				ucx_req->rkey = NULL;
+			}
+			ucx_req->req.length = 0;
+			ucx_req->req.iovcnt = 0;
+			ucx_req->req.data = NULL;
+
+			nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_FREE);
+			break;
+		case UCX_REQUEST_NUM_STATES:
+		default:
+			assert(0);
+			break;
+		}
+
+		if (ucx_req->state != prev_state) {
+			progress = true;
+		}
+	} while (ucx_req->state != prev_state);
+
+	return progress;
+}
+
+static int
+nvmf_ucx_req_complete(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_ucx_transport *ttransport;
+	struct spdk_nvmf_ucx_req *ucx_req;
+
+	ttransport = SPDK_CONTAINEROF(req->qpair->transport, struct spdk_nvmf_ucx_transport, transport);
+	ucx_req = SPDK_CONTAINEROF(req, struct spdk_nvmf_ucx_req, req);
+
+	nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_EXECUTED);
+	nvmf_ucx_req_process(ttransport, ucx_req);
+
+	return 0;
+}
+
+/**
+ * Destroy a released queue pair once its endpoint is closed and no request
+ * waits for UCP anymore, or unconditionally when forced.
+ */
+static void
+nvmf_ucx_qpair_check_closed(struct spdk_nvmf_ucx_qpair *tqpair, bool force)
+{
+	struct spdk_nvmf_ucx_transport *ttransport;
+	struct spdk_nvmf_ucx_req *ucx_req, *tmp;
+	ucs_status_t status;
+	int i;
+
+	if (tqpair->close_req != NULL) {
+		status = ucp_request_check_status(tqpair->close_req);
+		if (status == UCS_INPROGRESS && !force && spdk_get_ticks() < tqpair->close_timeout_tsc) {
+			return;
+		}
+		if (status == UCS_INPROGRESS) {
+			SPDK_ERRLOG("timed out closing UCX endpoint of tqpair=%p\n", tqpair);
+		}
+		ucp_request_free(tqpair->close_req);
+	}
+	tqpair->close_req = NULL;
+
+	if (!TAILQ_EMPTY(&tqpair->ucp_reqs)) {
+		if (!force && spdk_get_ticks() < tqpair->close_timeout_tsc) {
+			/* A closed endpoint completes its operations, eventually */
+			return;
+		}
+		nvmf_ucx_qpair_orphan_reqs(tqpair);
+	}
+
+	/* Release whatever waited for UCP */
+	ttransport = SPDK_CONTAINEROF(tqpair->qpair.transport, struct spdk_nvmf_ucx_transport, transport);
+	for (i = UCX_REQUEST_STATE_NEW; i < UCX_REQUEST_NUM_STATES; i++) {
+		TAILQ_FOREACH_SAFE(ucx_req, &tqpair->state_queue[i], state_link, tmp) {
+			nvmf_ucx_req_process(ttransport, ucx_req);
+		}
+	}
+
+	TAILQ_REMOVE(&tqpair->group->closing, tqpair, link);
+	nvmf_ucx_qpair_destroy(tqpair);
+}
+
+static void
+nvmf_ucx_close_qpair(struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	struct spdk_nvmf_ucx_transport *ttransport;
+	struct spdk_nvmf_ucx_req *ucx_req, *tmp;
+	ucs_status_ptr_t ptr;
+	int i;
+
+	SPDK_DEBUGLOG(SPDK_LOG_NVMF_UCX, "Qpair: %p\n", qpair);
+
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_ucx_qpair, qpair);
+	if (tqpair->ep == NULL) {
+		/* Never made it into a poll group */
+		nvmf_ucx_qpair_destroy(tqpair);
+		return;
+	}
+
+	/* Requests not waiting for UCP are released right away */
+	ttransport = SPDK_CONTAINEROF(qpair->transport, struct spdk_nvmf_ucx_transport, transport);
+	for (i = UCX_REQUEST_STATE_NEW; i < UCX_REQUEST_NUM_STATES; i++) {
+		TAILQ_FOREACH_SAFE(ucx_req, &tqpair->state_queue[i], state_link, tmp) {
+			if (ucx_req->pending == 0) {
+				nvmf_ucx_req_process(ttransport, ucx_req);
+			}
+		}
+	}
+
+	if (!tqpair->peer_term && !tqpair->failed) {
+		ptr = ucp_am_send_nb(tqpair->ep, NVME_UCX_AM_ID_TERM, NULL, 0, ucp_dt_make_contig(1),
+				     nvmf_ucx_ucp_req_cb, UCP_AM_SEND_REPLY);
+		nvmf_ucx_track(tqpair, NULL, ptr);
+	}
+
+	/* There is nothing left to flush on a failed endpoint */
+	ptr = ucp_ep_close_nb(tqpair->ep, tqpair->failed ? UCP_EP_CLOSE_MODE_FORCE :
+			      UCP_EP_CLOSE_MODE_FLUSH);
+	if (UCS_PTR_IS_ERR(ptr)) {
+		SPDK_ERRLOG("ucp_ep_close_nb() failed: %s\n", ucs_status_string(UCS_PTR_STATUS(ptr)));
+	}
+	tqpair->close_req = UCS_PTR_IS_PTR(ptr) ? ptr : NULL;
+	tqpair->close_timeout_tsc = spdk_get_ticks() +
+				    NVMF_UCX_CLOSE_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+
+	TAILQ_INSERT_TAIL(&tqpair->group->closing, tqpair, link);
+	nvmf_ucx_qpair_check_closed(tqpair, false);
+}
+
+static int
+nvmf_ucx_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
+{
+	struct spdk_nvmf_ucx_poll_group *tgroup;
+	struct spdk_nvmf_request *req, *req_tmp;
+	struct spdk_nvmf_ucx_req *ucx_req;
+	struct spdk_nvmf_ucx_qpair *tqpair, *tqpair_tmp;
+	struct spdk_nvmf_ucx_transport *ttransport = SPDK_CONTAINEROF(group->transport,
+			struct spdk_nvmf_ucx_transport, transport);
+	int count = 0;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_ucx_poll_group, group);
+
+	if (spdk_unlikely(TAILQ_EMPTY(&tgroup->qpairs) && TAILQ_EMPTY(&tgroup->closing))) {
+		return 0;
+	}
+
+	STAILQ_FOREACH_SAFE(req, &group->pending_buf_queue, buf_link, req_tmp) {
+		ucx_req = SPDK_CONTAINEROF(req, struct spdk_nvmf_ucx_req, req);
+		if (nvmf_ucx_req_process(ttransport, ucx_req) == false) {
+			break;
+		}
+	}
+
+	count += ucp_worker_progress(tgroup->worker);
+
+	/* New capsules and finished transfers, in the order they got ready */
+	while ((ucx_req = TAILQ_FIRST(&tgroup->ready_reqs)) != NULL) {
+		TAILQ_REMOVE(&tgroup->ready_reqs, ucx_req, ready_link);
+		ucx_req->ready = false;
+		if (ucx_req->state != UCX_REQUEST_STATE_FREE) {
+			nvmf_ucx_req_process(ttransport, ucx_req);
+		}
+		count++;
+	}
+
+	TAILQ_FOREACH_SAFE(tqpair, &tgroup->qpairs, link, tqpair_tmp) {
+		if (spdk_unlikely(tqpair->failed && !tqpair->disconnecting)) {
+			tqpair->disconnecting = true;
+			/* This will end up calling nvmf_ucx_close_qpair */
+			spdk_nvmf_qpair_disconnect(&tqpair->qpair, NULL, NULL);
+		}
+	}
+
+	TAILQ_FOREACH_SAFE(tqpair, &tgroup->closing, link, tqpair_tmp) {
+		nvmf_ucx_qpair_check_closed(tqpair, false);
+	}
+
+	return count;
+}
+
+static int
+nvmf_ucx_qpair_get_trid(struct spdk_nvmf_qpair *qpair,
+			struct spdk_nvme_transport_id *trid, bool peer)
+{
+	struct spdk_nvmf_ucx_qpair *tqpair;
+
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_ucx_qpair, qpair);
+	*trid = *tqpair->port->trid;
+
+	if (peer) {
+		/* UCX does not tell the address a connection request came from */
+		trid->traddr[0] = '\0';
+		trid->trsvcid[0] = '\0';
+	}
+
+	return 0;
+}
+
+static int
+nvmf_ucx_qpair_get_local_trid(struct spdk_nvmf_qpair *qpair,
+			      struct spdk_nvme_transport_id *trid)
+{
+	return nvmf_ucx_qpair_get_trid(qpair, trid, 0);
+}
+
+static int
+nvmf_ucx_qpair_get_peer_trid(struct spdk_nvmf_qpair *qpair,
+			     struct spdk_nvme_transport_id *trid)
+{
+	return nvmf_ucx_qpair_get_trid(qpair, trid, 1);
+}
+
+static int
+nvmf_ucx_qpair_get_listen_trid(struct spdk_nvmf_qpair *qpair,
+			       struct spdk_nvme_transport_id *trid)
+{
+	return nvmf_ucx_qpair_get_trid(qpair, trid, 0);
+}
+
+static void
+nvmf_ucx_req_set_abort_status(struct spdk_nvmf_request *req,
+			      struct spdk_nvmf_ucx_req *ucx_req_to_abort)
+{
+	ucx_req_to_abort->req.rsp->nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+	ucx_req_to_abort->req.rsp->nvme_cpl.status.sc = SPDK_NVME_SC_ABORTED_BY_REQUEST;
+
+	nvmf_ucx_req_set_state(ucx_req_to_abort, UCX_REQUEST_STATE_READY_TO_COMPLETE);
+
+	req->rsp->nvme_cpl.cdw0 &= ~1U; /* Command was successfully aborted. */
+}
+
+static int
+_nvmf_ucx_qpair_abort_request(void *ctx)
+{
+	struct spdk_nvmf_request *req = ctx;
+	struct spdk_nvmf_ucx_req *ucx_req_to_abort = SPDK_CONTAINEROF(req->req_to_abort,
+			struct spdk_nvmf_ucx_req, req);
+	struct spdk_nvmf_ucx_qpair *tqpair = SPDK_CONTAINEROF(req->req_to_abort->qpair,
+					     struct spdk_nvmf_ucx_qpair, qpair);
+	struct spdk_nvmf_ucx_transport *ttransport = SPDK_CONTAINEROF(tqpair->qpair.transport,
+			struct spdk_nvmf_ucx_transport, transport);
+	int rc;
+
+	spdk_poller_unregister(&req->poller);
+
+	switch (ucx_req_to_abort->state) {
+	case UCX_REQUEST_STATE_EXECUTING:
+		rc = nvmf_ctrlr_abort_request(req);
+		if (rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS) {
+			return SPDK_POLLER_BUSY;
+		}
+		break;
+
+	case UCX_REQUEST_STATE_NEED_BUFFER:
+		STAILQ_REMOVE(&tqpair->group->group.pending_buf_queue,
+			      &ucx_req_to_abort->req, spdk_nvmf_request, buf_link);
+
+		nvmf_ucx_req_set_abort_status(req, ucx_req_to_abort);
+		nvmf_ucx_req_process(ttransport, ucx_req_to_abort);
+		break;
+
+	case UCX_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER:
+		if (spdk_get_ticks() < req->timeout_tsc) {
+			req->poller = SPDK_POLLER_REGISTER(_nvmf_ucx_qpair_abort_request, req, 0);
+			return SPDK_POLLER_BUSY;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	spdk_nvmf_request_complete(req);
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+nvmf_ucx_qpair_abort_request(struct spdk_nvmf_qpair *qpair,
+			     struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	struct spdk_nvmf_transport *transport;
+	uint16_t cid;
+	uint32_t i;
+	struct spdk_nvmf_ucx_req *ucx_req_to_abort = NULL;
+
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_ucx_qpair, qpair);
+	transport = qpair->transport;
+
+	cid = req->cmd->nvme_cmd.cdw10_bits.abort.cid;
+
+	for (i = 0; i < tqpair->resource_count; i++) {
+		if (tqpair->reqs[i].state != UCX_REQUEST_STATE_FREE &&
+		    tqpair->reqs[i].req.cmd->nvme_cmd.cid == cid) {
+			ucx_req_to_abort = &tqpair->reqs[i];
+			break;
+		}
+	}
+
+	if (ucx_req_to_abort == NULL) {
+		spdk_nvmf_request_complete(req);
+		return;
+	}
+
+	req->req_to_abort = &ucx_req_to_abort->req;
+	req->timeout_tsc = spdk_get_ticks() +
+			   transport->opts.abort_timeout_sec * spdk_get_ticks_hz();
+	req->poller = NULL;
+
+	_nvmf_ucx_qpair_abort_request(req);
+}
+
+#define SPDK_NVMF_UCX_DEFAULT_MAX_QUEUE_DEPTH 128
+#define SPDK_NVMF_UCX_DEFAULT_AQ_DEPTH 128
+#define SPDK_NVMF_UCX_DEFAULT_MAX_QPAIRS_PER_CTRLR 128
+#define SPDK_NVMF_UCX_DEFAULT_IN_CAPSULE_DATA_SIZE 4096
+#define SPDK_NVMF_UCX_DEFAULT_MAX_IO_SIZE 131072
+#define SPDK_NVMF_UCX_DEFAULT_IO_UNIT_SIZE 131072
+#define SPDK_NVMF_UCX_DEFAULT_NUM_SHARED_BUFFERS 511
+#define SPDK_NVMF_UCX_DEFAULT_BUFFER_CACHE_SIZE 32
+#define SPDK_NVMF_UCX_DEFAULT_DIF_INSERT_OR_STRIP false
+#define SPDK_NVMF_UCX_DEFAULT_ABORT_TIMEOUT_SEC 1
+
+static void
+nvmf_ucx_opts_init(struct spdk_nvmf_transport_opts *opts)
+{
+	opts->max_queue_depth =		SPDK_NVMF_UCX_DEFAULT_MAX_QUEUE_DEPTH;
+	opts->max_qpairs_per_ctrlr =	SPDK_NVMF_UCX_DEFAULT_MAX_QPAIRS_PER_CTRLR;
+	opts->in_capsule_data_size =	SPDK_NVMF_UCX_DEFAULT_IN_CAPSULE_DATA_SIZE;
+	opts->max_io_size =		SPDK_NVMF_UCX_DEFAULT_MAX_IO_SIZE;
+	opts->io_unit_size =		SPDK_NVMF_UCX_DEFAULT_IO_UNIT_SIZE;
+	opts->max_aq_depth =		SPDK_NVMF_UCX_DEFAULT_AQ_DEPTH;
+	opts->num_shared_buffers =	SPDK_NVMF_UCX_DEFAULT_NUM_SHARED_BUFFERS;
+	opts->buf_cache_size =		SPDK_NVMF_UCX_DEFAULT_BUFFER_CACHE_SIZE;
+	opts->dif_insert_or_strip =	SPDK_NVMF_UCX_DEFAULT_DIF_INSERT_OR_STRIP;
+	opts->abort_timeout_sec =	SPDK_NVMF_UCX_DEFAULT_ABORT_TIMEOUT_SEC;
+}
+
+const struct spdk_nvmf_transport_ops spdk_nvmf_transport_ucx = {
+	.name = "UCX",
+	.type = SPDK_NVME_TRANSPORT_CUSTOM,
+	.opts_init = nvmf_ucx_opts_init,
+	.create = nvmf_ucx_create,
+	.destroy = nvmf_ucx_destroy,
+
+	.listen = nvmf_ucx_listen,
+	.stop_listen = nvmf_ucx_stop_listen,
+	.accept = nvmf_ucx_accept,
+
+	.listener_discover = nvmf_ucx_discover,
+
+	.poll_group_create = nvmf_ucx_poll_group_create,
+	.poll_group_destroy = nvmf_ucx_poll_group_destroy,
+	.poll_group_add = nvmf_ucx_poll_group_add,
+	.poll_group_remove = nvmf_ucx_poll_group_remove,
+	.poll_group_poll = nvmf_ucx_poll_group_poll,
+
+	.req_free = nvmf_ucx_req_free,
+	.req_complete = nvmf_ucx_req_complete,
+
+	.qpair_fini = nvmf_ucx_close_qpair,
+	.qpair_get_local_trid = nvmf_ucx_qpair_get_local_trid,
+	.qpair_get_peer_trid = nvmf_ucx_qpair_get_peer_trid,
+	.qpair_get_listen_trid = nvmf_ucx_qpair_get_listen_trid,
+	.qpair_abort_request = nvmf_ucx_qpair_abort_request,
+};
+
+SPDK_NVMF_TRANSPORT_REGISTER(ucx, &spdk_nvmf_transport_ucx);
+SPDK_LOG_REGISTER_COMPONENT("nvmf_ucx", SPDK_LOG_NVMF_UCX)
@@ -0,0 +1,223 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/env.h"
+#include "spdk/queue.h"
+
+#include "spdk_internal/assert.h"
+#include "spdk_internal/ucx.h"
+#include "spdk_internal/log.h"
+
+/* The translation of every page of a region, see ucx_mem_notify() */
+struct ucx_mem_region {
+	ucp_mem_h				memh;
+	void					*rkey_buf;
+	size_t					rkey_size;
+};
+
+struct spdk_ucx_mem_map {
+	struct spdk_mem_map			*map;
+	ucp_context_h				context;
+	uint32_t				ref;
+	LIST_ENTRY(spdk_ucx_mem_map)		link;
+};
+
+static LIST_HEAD(, spdk_ucx_mem_map) g_ucx_mr_maps = LIST_HEAD_INITIALIZER(&g_ucx_mr_maps);
+static pthread_mutex_t g_ucx_mr_maps_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+ucx_mem_region_free(ucp_context_h context, struct ucx_mem_region *region)
+{
+	if (region->rkey_buf != NULL) {
+		ucp_rkey_buffer_release(region->rkey_buf);
+	}
+	if (region->memh != NULL) {
+		ucp_mem_unmap(context, region->memh);
+	}
+	free(region);
+}
+
+static int
+ucx_mem_notify(void *cb_ctx, struct spdk_mem_map *map,
+	       enum spdk_mem_map_notify_action action,
+	       void *vaddr, size_t size)
+{
+	ucp_context_h context = cb_ctx;
+	struct ucx_mem_region *region;
+	ucp_mem_map_params_t params = {};
+	ucs_status_t status;
+	int rc;
+
+	switch (action) {
+	case SPDK_MEM_MAP_NOTIFY_REGISTER:
+		region = calloc(1, sizeof(*region));
+		if (region == NULL) {
+			return -ENOMEM;
+		}
+
+		params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+				    UCP_MEM_MAP_PARAM_FIELD_LENGTH;
+		params.address = vaddr;
+		params.length = size;
+		status = ucp_mem_map(context, &params, &region->memh);
+		if (status == UCS_OK) {
+			status = ucp_rkey_pack(context, region->memh, &region->rkey_buf, &region->rkey_size);
+		} else {
+			region->memh = NULL;
+		}
+		if (status != UCS_OK) {
+			SPDK_ERRLOG("Failed to map %p, %zu bytes: %s\n", vaddr, size, ucs_status_string(status));
+			ucx_mem_region_free(context, region);
+			return -EFAULT;
+		}
+
+		rc = spdk_mem_map_set_translation(map, (uint64_t)vaddr, size, (uint64_t)region);
+		if (rc != 0) {
+			ucx_mem_region_free(context, region);
+		}
+		break;
+	case SPDK_MEM_MAP_NOTIFY_UNREGISTER:
+		region = (struct ucx_mem_region *)spdk_mem_map_translate(map, (uint64_t)vaddr, NULL);
+		if (region) {
+			ucx_mem_region_free(context, region);
+		}
+		rc = spdk_mem_map_clear_translation(map, (uint64_t)vaddr, size);
+		break;
+	default:
+		SPDK_UNREACHABLE();
+	}
+
+	return rc;
+}
+
+static int
+ucx_check_contiguous_entries(uint64_t addr_1, uint64_t addr_2)
+{
+	/* All pages of a region translate to the same region. */
+	return addr_1 == addr_2;
+}
+
+const struct spdk_mem_map_ops g_ucx_map_ops = {
+	.notify_cb = ucx_mem_notify,
+	.are_contiguous = ucx_check_contiguous_entries
+};
+
+struct spdk_ucx_mem_map *
+spdk_ucx_create_mem_map(ucp_context_h context)
+{
+	struct spdk_ucx_mem_map *map;
+
+	pthread_mutex_lock(&g_ucx_mr_maps_mutex);
+
+	/* Look up existing mem map registration for this context */
+	LIST_FOREACH(map, &g_ucx_mr_maps, link) {
+		if (map->context == context) {
+			map->ref++;
+			pthread_mutex_unlock(&g_ucx_mr_maps_mutex);
+			return map;
+		}
+	}
+
+	map = calloc(1, sizeof(*map));
+	if (map == NULL) {
+		SPDK_ERRLOG("Failed to allocate ucx mem map\n");
+		pthread_mutex_unlock(&g_ucx_mr_maps_mutex);
+		return NULL;
+	}
+
+	map->ref = 1;
+	map->context = context;
+	map->map = spdk_mem_map_alloc(0, &g_ucx_map_ops, context);
+	if (map->map == NULL) {
+		SPDK_ERRLOG("spdk_mem_map_alloc() failed\n");
+		free(map);
+		pthread_mutex_unlock(&g_ucx_mr_maps_mutex);
+		return NULL;
+	}
+
+	LIST_INSERT_HEAD(&g_ucx_mr_maps, map, link);
+
+	pthread_mutex_unlock(&g_ucx_mr_maps_mutex);
+
+	return map;
+}
+
+void
+spdk_ucx_free_mem_map(struct spdk_ucx_mem_map **_map)
+{
+	struct spdk_ucx_mem_map *map;
+
+	if (_map == NULL || *_map == NULL) {
+		return;
+	}
+
+	map = *_map;
+	*_map = NULL;
+
+	pthread_mutex_lock(&g_ucx_mr_maps_mutex);
+
+	assert(map->ref > 0);
+	map->ref--;
+	if (map->ref == 0) {
+		LIST_REMOVE(map, link);
+		spdk_mem_map_free(&map->map);
+		free(map);
+	}
+
+	pthread_mutex_unlock(&g_ucx_mr_maps_mutex);
+}
+
+int
+spdk_ucx_get_translation(struct spdk_ucx_mem_map *map, void *address, size_t length,
+			 struct spdk_ucx_memory_translation *translation)
+{
+	struct ucx_mem_region *region;
+	uint64_t size = length;
+
+	region = (struct ucx_mem_region *)spdk_mem_map_translate(map->map, (uint64_t)address, &size);
+	if (region == NULL) {
+		return -EINVAL;
+	}
+
+	if (size < length) {
+		return -ERANGE;
+	}
+
+	translation->memh = region->memh;
+	translation->rkey_buf = region->rkey_buf;
+	translation->rkey_size = region->rkey_size;
+
+	return 0;
+}
@@ -129,6 +129,10 @@ CONFIG_REDUCE?=n
 CONFIG_VPP?=n
 CONFIG_VPP_DIR?=
 
+# Build with UCX
+CONFIG_UCX?=n
+CONFIG_UCX_DIR?=
+
 # Requires libiscsi development libraries.
 CONFIG_ISCSI_INITIATOR?=n
 
@@ -46,4 +46,8 @@ ifeq ($(CONFIG_RDMA),y)
 SPDK_LIB_LIST += rdma
 endif
 
+ifeq ($(CONFIG_UCX),y)
+SPDK_LIB_LIST += ucx
+endif
+
 include $(SPDK_ROOT_DIR)/mk/spdk.app.mk
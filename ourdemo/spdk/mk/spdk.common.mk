@@ -153,6 +153,15 @@ ifeq ($(CONFIG_RDMA),y)
 SYS_LIBS += -libverbs -lrdmacm
 endif
 
+ifeq ($(CONFIG_UCX),y)
+SYS_LIBS += -lucp -lucs
+endif
+
+ifneq ($(CONFIG_UCX_DIR),)
+LIBS += -L$(CONFIG_UCX_DIR)/lib
+COMMON_CFLAGS += -I$(CONFIG_UCX_DIR)/include
+endif
+
 ifeq ($(CONFIG_URING),y)
 SYS_LIBS += -luring
 ifneq ($(strip $(CONFIG_URING_PATH)),)
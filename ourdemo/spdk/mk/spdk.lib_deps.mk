@@ -53,6 +53,7 @@ DEPDIRS-vmd := log
 DEPDIRS-conf := log util
 DEPDIRS-json := log util
 DEPDIRS-rdma := log util
+DEPDIRS-ucx := log
 DEPDIRS-reduce := log util
 DEPDIRS-thread := log util
 
@@ -60,6 +61,9 @@ DEPDIRS-nvme := log sock util
 ifeq ($(CONFIG_RDMA),y)
 DEPDIRS-nvme += rdma
 endif
+ifeq ($(CONFIG_UCX),y)
+DEPDIRS-nvme += ucx
+endif
 
 DEPDIRS-blob := log util thread
 DEPDIRS-accel := log util thread json
@@ -120,6 +124,7 @@ DEPDIRS-env_dpdk_rpc := log $(JSON_LIBS)
 DEPDIRS-sock_posix := log sock util
 DEPDIRS-sock_uring := log sock util
 DEPDIRS-sock_vpp := log sock util thread
+DEPDIRS-sock_ucx := log sock util
 
 # module/bdev
 DEPDIRS-bdev_gpt := bdev conf json log thread util
@@ -148,6 +153,7 @@ DEPDIRS-bdev_passthru := $(BDEV_DEPS_CONF_THREAD)
 DEPDIRS-bdev_pmem := $(BDEV_DEPS_CONF_THREAD)
 DEPDIRS-bdev_raid := $(BDEV_DEPS_CONF_THREAD)
 DEPDIRS-bdev_rbd := $(BDEV_DEPS_CONF_THREAD)
+DEPDIRS-bdev_ucx := $(BDEV_DEPS_CONF_THREAD) ucx
 DEPDIRS-bdev_uring := $(BDEV_DEPS_CONF_THREAD)
 DEPDIRS-bdev_virtio := $(BDEV_DEPS_CONF_THREAD) virtio
 
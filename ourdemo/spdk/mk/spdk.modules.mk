@@ -109,6 +109,12 @@ SYS_LIBS += -Wl,--no-whole-archive
 SOCK_MODULES_LIST += sock_vpp
 endif
 
+ifeq ($(CONFIG_UCX),y)
+SYS_LIBS += -lucp -lucs
+SOCK_MODULES_LIST += sock_ucx
+BLOCKDEV_MODULES_LIST += bdev_ucx ucx
+endif
+
 ACCEL_MODULES_LIST = accel_ioat ioat
 ifeq ($(CONFIG_IDXD),y)
 ACCEL_MODULES_LIST += accel_idxd idxd
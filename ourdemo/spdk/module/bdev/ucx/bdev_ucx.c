@@ -0,0 +1,1355 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include <ucp/api/ucp.h>
+
+#include "spdk/assert.h"
+#include "spdk/bdev.h"
+#include "spdk/env.h"
+#include "spdk/json.h"
+#include "spdk/likely.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk_internal/log.h"
+#include "spdk_internal/ucx.h"
+#include "spdk/bdev_module.h"
+
+#include "bdev_ucx.h"
+
+/*
+ * Wire format of the ourdemo block server, see ourdemo/ourdemo.h. Commands and
+ * responses travel on a UCP stream endpoint; payloads either follow them in
+ * the stream or are moved by the server with RMA into the buffer described by
+ * the packed rkey that follows the command.
+ */
+#define BDEV_UCX_OP_INFO	1
+#define BDEV_UCX_OP_READ	2
+#define BDEV_UCX_OP_WRITE	3
+#define BDEV_UCX_OP_DISCONNECT	4
+
+#define BDEV_UCX_CMD_FLAG_RMA	(1 << 0)
+
+#define BDEV_UCX_MAX_RKEY_SIZE	1024
+
+/* Command id of the INFO exchanged when a channel connects */
+#define BDEV_UCX_INFO_ID	UINT64_MAX
+
+struct bdev_ucx_cmd {
+	uint16_t	opcode;
+	uint16_t	flags;
+	uint32_t	length;
+	uint64_t	id;
+	uint64_t	offset;
+	uint64_t	remote_addr;
+	uint32_t	rkey_length;
+	uint32_t	reserved;
+};
+SPDK_STATIC_ASSERT(sizeof(struct bdev_ucx_cmd) == 40, "Incorrect size");
+
+struct bdev_ucx_rsp {
+	uint64_t	id;
+	int32_t		status;
+	uint32_t	length;
+};
+SPDK_STATIC_ASSERT(sizeof(struct bdev_ucx_rsp) == 16, "Incorrect size");
+
+struct bdev_ucx_info {
+	uint32_t	block_size;
+	uint32_t	max_io_size;
+	uint64_t	num_blocks;
+};
+SPDK_STATIC_ASSERT(sizeof(struct bdev_ucx_info) == 16, "Incorrect size");
+
+/* bdev iovecs are handed to UCP as-is, without any translation */
+SPDK_STATIC_ASSERT(sizeof(ucp_dt_iov_t) == sizeof(struct iovec), "Incorrect size");
+SPDK_STATIC_ASSERT(offsetof(ucp_dt_iov_t, buffer) == offsetof(struct iovec, iov_base),
+		   "Incorrect offset");
+SPDK_STATIC_ASSERT(offsetof(ucp_dt_iov_t, length) == offsetof(struct iovec, iov_len),
+		   "Incorrect offset");
+
+#define BDEV_UCX_QUEUE_DEPTH		128
+#define BDEV_UCX_IOV_INLINE		8
+#define BDEV_UCX_CONN_POLL_US		100
+#define BDEV_UCX_CONN_TIMEOUT_US	(10 * 1000 * 1000)
+#define BDEV_UCX_CLOSE_TIMEOUT_US	(1000 * 1000)
+/* A channel with commands outstanding and no response for this long is failed */
+#define BDEV_UCX_IO_TIMEOUT_US		(30 * 1000 * 1000)
+
+struct bdev_ucx_io_channel;
+struct bdev_ucx_io;
+
+/* Lives in the private area of every UCP request issued by this module. */
+struct bdev_ucx_request {
+	/* Both NULL once the request was abandoned */
+	struct bdev_ucx_io_channel	*ch;
+	/* NULL for the receive of a response header */
+	struct bdev_ucx_io		*io;
+	TAILQ_ENTRY(bdev_ucx_request)	link;
+};
+
+struct bdev_ucx_io {
+	struct bdev_ucx_cmd		cmd;
+	uint32_t			slot;
+	/* The send, and the response with its payload */
+	int				pending;
+	int				status;
+	/* Registration of a buffer that is not SPDK memory */
+	ucp_mem_h			memh;
+	void				*rkey_buf;
+	/* Packed rkey sent along with the command */
+	const void			*rkey;
+	ucp_dt_iov_t			*iov;
+	ucp_dt_iov_t			iov_inline[BDEV_UCX_IOV_INLINE];
+	TAILQ_ENTRY(bdev_ucx_io)	link;
+};
+
+struct bdev_ucx_disk {
+	struct spdk_bdev		bdev;
+	char				*address;
+	uint16_t			port;
+	int32_t				rma_threshold;
+	struct sockaddr_storage		addr;
+	socklen_t			addrlen;
+};
+
+struct bdev_ucx_slot {
+	struct bdev_ucx_io		*io;
+	uint32_t			gen;
+};
+
+struct bdev_ucx_io_channel {
+	struct bdev_ucx_disk		*disk;
+
+	/* Every channel has a connection of its own, driven by its thread only */
+	ucp_worker_h			worker;
+	ucp_ep_h			ep;
+	struct spdk_poller		*poller;
+	int				error;
+	bool				failed;
+
+	/*
+	 * I/O is held back until the server answered the INFO sent on connect.
+	 * UCX 1.8 corrupts multi-entry iov sends queued while the endpoint
+	 * is still being wired up.
+	 */
+	bool				connected;
+	struct bdev_ucx_cmd		info_cmd;
+	struct bdev_ucx_info		info;
+
+	/* tcp and shm do not report a vanished server, responses just stop */
+	uint64_t			last_rsp_tsc;
+	uint64_t			io_timeout_ticks;
+
+	/* Response header being received */
+	struct bdev_ucx_rsp		rsp;
+
+	struct bdev_ucx_slot		slots[BDEV_UCX_QUEUE_DEPTH];
+	uint32_t			free_slots[BDEV_UCX_QUEUE_DEPTH];
+	uint32_t			num_free_slots;
+
+	/* Waiting for a free slot */
+	TAILQ_HEAD(, bdev_ucx_io)	queued_ios;
+	/* Done, completed to the bdev layer outside of UCP callbacks */
+	TAILQ_HEAD(, bdev_ucx_io)	completed_ios;
+	TAILQ_HEAD(, bdev_ucx_request)	reqs;
+};
+
+struct bdev_ucx_conn_req {
+	struct spdk_bdev_ucx_opts	opts;
+	struct sockaddr_storage		addr;
+	socklen_t			addrlen;
+	ucp_worker_h			worker;
+	ucp_ep_h			ep;
+	struct bdev_ucx_cmd		cmd;
+	struct {
+		struct bdev_ucx_rsp	rsp;
+		struct bdev_ucx_info	info;
+	} reply;
+	void				*send_req;
+	void				*recv_req;
+	uint64_t			timeout_tsc;
+	int				status;
+	spdk_bdev_ucx_create_cb		cb_fn;
+	void				*cb_arg;
+	TAILQ_ENTRY(bdev_ucx_conn_req)	link;
+};
+
+static TAILQ_HEAD(, bdev_ucx_conn_req) g_ucx_conn_reqs = TAILQ_HEAD_INITIALIZER(g_ucx_conn_reqs);
+static struct spdk_poller *g_conn_poller;
+static ucp_context_h g_ucx_context;
+static struct spdk_ucx_mem_map *g_ucx_mem_map;
+
+static int bdev_ucx_initialize(void);
+static void bdev_ucx_finish(void);
+
+static int
+bdev_ucx_get_ctx_size(void)
+{
+	return sizeof(struct bdev_ucx_io);
+}
+
+static struct spdk_bdev_module g_ucx_bdev_module = {
+	.name		= "ucx",
+	.module_init	= bdev_ucx_initialize,
+	.module_fini	= bdev_ucx_finish,
+	.get_ctx_size	= bdev_ucx_get_ctx_size,
+};
+
+SPDK_BDEV_MODULE_REGISTER(ucx, &g_ucx_bdev_module);
+
+static int
+bdev_ucx_status_to_errno(ucs_status_t status)
+{
+	switch (status) {
+	case UCS_OK:
+		return 0;
+	case UCS_ERR_CONNECTION_RESET:
+	case UCS_ERR_ENDPOINT_TIMEOUT:
+		return -ECONNRESET;
+	case UCS_ERR_CANCELED:
+		return -ECANCELED;
+	case UCS_ERR_NO_MEMORY:
+		return -ENOMEM;
+	case UCS_ERR_UNREACHABLE:
+		return -EHOSTUNREACH;
+	default:
+		return -EIO;
+	}
+}
+
+static ucp_context_h
+bdev_ucx_get_context(void)
+{
+	ucp_params_t params = {};
+	ucs_status_t status;
+
+	if (g_ucx_context != NULL) {
+		return g_ucx_context;
+	}
+
+	params.field_mask = UCP_PARAM_FIELD_FEATURES |
+			    UCP_PARAM_FIELD_REQUEST_SIZE |
+			    UCP_PARAM_FIELD_MT_WORKERS_SHARED;
+	params.features = UCP_FEATURE_STREAM | UCP_FEATURE_RMA;
+	params.request_size = sizeof(struct bdev_ucx_request);
+	/* Channels of different threads create their workers on the same context */
+	params.mt_workers_shared = 1;
+
+	/* Transports are selected through the usual UCX_TLS/UCX_NET_DEVICES variables */
+	status = ucp_init(&params, NULL, &g_ucx_context);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_init() failed: %s\n", ucs_status_string(status));
+		g_ucx_context = NULL;
+		return NULL;
+	}
+
+	/* Without it every RMA buffer is registered on its own */
+	g_ucx_mem_map = spdk_ucx_create_mem_map(g_ucx_context);
+
+	return g_ucx_context;
+}
+
+static void
+bdev_ucx_empty_send_cb(void *request, ucs_status_t status)
+{
+}
+
+static void
+bdev_ucx_err_cb(void *arg, ucp_ep_h ep, ucs_status_t status)
+{
+	int *error = arg;
+
+	SPDK_ERRLOG("UCX endpoint %p failed: %s\n", ep, ucs_status_string(status));
+	*error = bdev_ucx_status_to_errno(status);
+}
+
+/**
+ * Create a worker driven by the calling thread only and start connecting it
+ * to the server. Commands may be sent right away, UCP queues them until the
+ * connection is established.
+ */
+static int
+bdev_ucx_connect(const struct sockaddr_storage *addr, socklen_t addrlen, int *error,
+		 ucp_worker_h *worker_p, ucp_ep_h *ep_p)
+{
+	ucp_worker_params_t worker_params = {};
+	ucp_ep_params_t ep_params = {};
+	ucp_context_h context;
+	ucs_status_t status;
+
+	context = bdev_ucx_get_context();
+	if (context == NULL) {
+		return -ENODEV;
+	}
+
+	worker_params.field_mask = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+	worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+	status = ucp_worker_create(context, &worker_params, worker_p);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_worker_create() failed: %s\n", ucs_status_string(status));
+		return bdev_ucx_status_to_errno(status);
+	}
+
+	/* No peer failure mode, tcp and shm do not support it */
+	ep_params.field_mask = UCP_EP_PARAM_FIELD_FLAGS |
+			       UCP_EP_PARAM_FIELD_SOCK_ADDR |
+			       UCP_EP_PARAM_FIELD_ERR_HANDLER;
+	ep_params.flags = UCP_EP_PARAMS_FLAGS_CLIENT_SERVER;
+	ep_params.sockaddr.addr = (const struct sockaddr *)addr;
+	ep_params.sockaddr.addrlen = addrlen;
+	ep_params.err_handler.cb = bdev_ucx_err_cb;
+	ep_params.err_handler.arg = error;
+	status = ucp_ep_create(*worker_p, &ep_params, ep_p);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_ep_create() failed: %s\n", ucs_status_string(status));
+		ucp_worker_destroy(*worker_p);
+		*worker_p = NULL;
+		return bdev_ucx_status_to_errno(status);
+	}
+
+	return 0;
+}
+
+/**
+ * Progress the worker until the request completed or the deadline passed.
+ * The request is released either way.
+ */
+static ucs_status_t
+bdev_ucx_wait(ucp_worker_h worker, void *req, uint64_t deadline_tsc)
+{
+	ucs_status_t status;
+
+	while ((status = ucp_request_check_status(req)) == UCS_INPROGRESS &&
+	       spdk_get_ticks() < deadline_tsc) {
+		ucp_worker_progress(worker);
+	}
+
+	ucp_request_free(req);
+	return status;
+}
+
+/**
+ * Tell the server to drop the connection and close the endpoint. Requests
+ * still posted on the endpoint must have been abandoned before.
+ *
+ * A dead peer is not reported by every transport, so the close is bounded;
+ * whatever is left is reclaimed when the worker is destroyed.
+ */
+static void
+bdev_ucx_disconnect(ucp_worker_h worker, ucp_ep_h ep, bool failed)
+{
+	static const struct bdev_ucx_cmd cmd = { .opcode = BDEV_UCX_OP_DISCONNECT };
+	ucs_status_ptr_t req;
+	uint64_t deadline_tsc;
+
+	deadline_tsc = spdk_get_ticks() +
+		       BDEV_UCX_CLOSE_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+
+	if (!failed) {
+		req = ucp_stream_send_nb(ep, &cmd, 1, ucp_dt_make_contig(sizeof(cmd)),
+					 bdev_ucx_empty_send_cb, 0);
+		if (UCS_PTR_IS_PTR(req) && bdev_ucx_wait(worker, req, deadline_tsc) == UCS_INPROGRESS) {
+			failed = true;
+		}
+	}
+
+	req = ucp_ep_close_nb(ep, failed ? UCP_EP_CLOSE_MODE_FORCE : UCP_EP_CLOSE_MODE_FLUSH);
+	if (failed && UCS_PTR_STATUS(req) == UCS_ERR_INVALID_PARAM) {
+		/* Forced close needs peer failure mode */
+		req = ucp_ep_close_nb(ep, UCP_EP_CLOSE_MODE_FLUSH);
+	}
+	if (UCS_PTR_IS_PTR(req)) {
+		if (bdev_ucx_wait(worker, req, deadline_tsc) == UCS_INPROGRESS) {
+			SPDK_ERRLOG("timed out closing UCX endpoint %p\n", ep);
+		}
+	} else if (UCS_PTR_STATUS(req) != UCS_OK) {
+		SPDK_ERRLOG("ucp_ep_close_nb() failed: %s\n", ucs_status_string(UCS_PTR_STATUS(req)));
+	}
+}
+
+static void
+bdev_ucx_req_track(struct bdev_ucx_io_channel *ch, struct bdev_ucx_request *req,
+		   struct bdev_ucx_io *io)
+{
+	req->ch = ch;
+	req->io = io;
+	TAILQ_INSERT_TAIL(&ch->reqs, req, link);
+}
+
+/**
+ * Abandon every request still posted on the channel. UCP does not complete
+ * stream receives once the endpoint is closed, and their callbacks must not
+ * touch the channel should they run later.
+ */
+static void
+bdev_ucx_orphan_reqs(struct bdev_ucx_io_channel *ch)
+{
+	struct bdev_ucx_request *req;
+
+	while ((req = TAILQ_FIRST(&ch->reqs)) != NULL) {
+		TAILQ_REMOVE(&ch->reqs, req, link);
+		req->ch = NULL;
+		req->io = NULL;
+		ucp_request_free(req);
+	}
+}
+
+static void
+bdev_ucx_io_release(struct bdev_ucx_io_channel *ch, struct bdev_ucx_io *io)
+{
+	if (io->rkey_buf != NULL) {
+		ucp_rkey_buffer_release(io->rkey_buf);
+		io->rkey_buf = NULL;
+	}
+	if (io->memh != NULL) {
+		ucp_mem_unmap(g_ucx_context, io->memh);
+		io->memh = NULL;
+	}
+	if (io->iov != io->iov_inline) {
+		free(io->iov);
+	}
+	io->iov = NULL;
+}
+
+/**
+ * Drop one of the events an I/O waits for, it is done once the send and the
+ * response both completed.
+ */
+static void
+bdev_ucx_io_put(struct bdev_ucx_io_channel *ch, struct bdev_ucx_io *io, int status)
+{
+	if (status != 0 && io->status == 0) {
+		io->status = status;
+	}
+
+	assert(io->pending > 0);
+	if (--io->pending > 0) {
+		return;
+	}
+
+	ch->slots[io->slot].io = NULL;
+	ch->free_slots[ch->num_free_slots++] = io->slot;
+	TAILQ_INSERT_TAIL(&ch->completed_ios, io, link);
+}
+
+static void
+bdev_ucx_send_cb(void *request, ucs_status_t status)
+{
+	struct bdev_ucx_request *req = request;
+	struct bdev_ucx_io_channel *ch = req->ch;
+	struct bdev_ucx_io *io = req->io;
+
+	if (ch == NULL) {
+		return;
+	}
+
+	TAILQ_REMOVE(&ch->reqs, req, link);
+	ucp_request_free(request);
+	if (status != UCS_OK) {
+		ch->error = bdev_ucx_status_to_errno(status);
+	}
+	if (io != NULL) {
+		bdev_ucx_io_put(ch, io, bdev_ucx_status_to_errno(status));
+	}
+}
+
+/**
+ * Describe the bdev buffer of a large I/O with a packed rkey so that the
+ * server moves the payload with RMA.
+ */
+static int
+bdev_ucx_io_map(struct bdev_ucx_io *io, struct iovec *iov)
+{
+	struct spdk_ucx_memory_translation translation;
+	ucp_mem_map_params_t params = {};
+	size_t rkey_size;
+	ucs_status_t status;
+
+	if (g_ucx_mem_map != NULL &&
+	    spdk_ucx_get_translation(g_ucx_mem_map, iov->iov_base, iov->iov_len, &translation) == 0) {
+		/* Buffers from SPDK memory were mapped when it got registered */
+		rkey_size = translation.rkey_size;
+		io->rkey = translation.rkey_buf;
+		goto done;
+	}
+
+	params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+			    UCP_MEM_MAP_PARAM_FIELD_LENGTH;
+	params.address = iov->iov_base;
+	params.length = iov->iov_len;
+	status = ucp_mem_map(g_ucx_context, &params, &io->memh);
+	if (status != UCS_OK) {
+		io->memh = NULL;
+		return bdev_ucx_status_to_errno(status);
+	}
+
+	status = ucp_rkey_pack(g_ucx_context, io->memh, &io->rkey_buf, &rkey_size);
+	if (status != UCS_OK) {
+		return bdev_ucx_status_to_errno(status);
+	}
+	io->rkey = io->rkey_buf;
+
+done:
+	if (rkey_size > BDEV_UCX_MAX_RKEY_SIZE) {
+		return -E2BIG;
+	}
+
+	io->cmd.flags |= BDEV_UCX_CMD_FLAG_RMA;
+	io->cmd.remote_addr = (uintptr_t)iov->iov_base;
+	io->cmd.rkey_length = rkey_size;
+	return 0;
+}
+
+static void
+bdev_ucx_io_send(struct bdev_ucx_io_channel *ch, struct bdev_ucx_io *io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(io);
+	struct bdev_ucx_disk *disk = ch->disk;
+	struct bdev_ucx_request *req;
+	size_t iovcnt = 1;
+	int i, rc;
+
+	if (ch->num_free_slots == BDEV_UCX_QUEUE_DEPTH) {
+		/* Nothing was outstanding, do not count the idle time */
+		ch->last_rsp_tsc = spdk_get_ticks();
+	}
+	io->slot = ch->free_slots[--ch->num_free_slots];
+	ch->slots[io->slot].io = io;
+	ch->slots[io->slot].gen++;
+
+	io->cmd.id = ((uint64_t)ch->slots[io->slot].gen << 32) | io->slot;
+	io->cmd.opcode = bdev_io->type == SPDK_BDEV_IO_TYPE_READ ? BDEV_UCX_OP_READ :
+			 BDEV_UCX_OP_WRITE;
+	io->cmd.length = bdev_io->u.bdev.num_blocks * disk->bdev.blocklen;
+	io->cmd.offset = bdev_io->u.bdev.offset_blocks * disk->bdev.blocklen;
+	/* Waits for the response */
+	io->pending = 1;
+
+	io->iov = io->iov_inline;
+	if (bdev_io->u.bdev.iovcnt + 1 > BDEV_UCX_IOV_INLINE) {
+		io->iov = calloc(bdev_io->u.bdev.iovcnt + 1, sizeof(*io->iov));
+		if (io->iov == NULL) {
+			io->iov = io->iov_inline;
+			bdev_ucx_io_put(ch, io, -ENOMEM);
+			return;
+		}
+	}
+	io->iov[0].buffer = &io->cmd;
+	io->iov[0].length = sizeof(io->cmd);
+
+	if (disk->rma_threshold >= 0 && io->cmd.length >= (uint32_t)disk->rma_threshold &&
+	    bdev_io->u.bdev.iovcnt == 1) {
+		rc = bdev_ucx_io_map(io, &bdev_io->u.bdev.iovs[0]);
+		if (rc != 0) {
+			SPDK_ERRLOG("failed to register I/O buffer: %s\n", spdk_strerror(-rc));
+			bdev_ucx_io_put(ch, io, rc);
+			return;
+		}
+		io->iov[iovcnt].buffer = (void *)io->rkey;
+		io->iov[iovcnt++].length = io->cmd.rkey_length;
+	} else if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		for (i = 0; i < bdev_io->u.bdev.iovcnt; i++) {
+			io->iov[iovcnt++] = *(ucp_dt_iov_t *)&bdev_io->u.bdev.iovs[i];
+		}
+	}
+
+	req = ucp_stream_send_nb(ch->ep, io->iov, iovcnt, ucp_dt_make_iov(), bdev_ucx_send_cb, 0);
+	if (req == NULL) {
+		return;
+	} else if (UCS_PTR_IS_ERR(req)) {
+		SPDK_ERRLOG("ucp_stream_send_nb() failed: %s\n",
+			    ucs_status_string(UCS_PTR_STATUS(req)));
+		ch->error = bdev_ucx_status_to_errno(UCS_PTR_STATUS(req));
+		bdev_ucx_io_put(ch, io, ch->error);
+		return;
+	}
+
+	io->pending++;
+	bdev_ucx_req_track(ch, req, io);
+}
+
+static void
+bdev_ucx_payload_recv_cb(void *request, ucs_status_t status, size_t length)
+{
+	struct bdev_ucx_request *req = request;
+	struct bdev_ucx_io_channel *ch = req->ch;
+	struct bdev_ucx_io *io = req->io;
+
+	if (ch == NULL) {
+		return;
+	}
+
+	TAILQ_REMOVE(&ch->reqs, req, link);
+	ucp_request_free(request);
+	if (status != UCS_OK) {
+		ch->error = bdev_ucx_status_to_errno(status);
+	}
+	bdev_ucx_io_put(ch, io, bdev_ucx_status_to_errno(status));
+}
+
+static int
+bdev_ucx_check_info(struct bdev_ucx_io_channel *ch)
+{
+	struct spdk_bdev *bdev = &ch->disk->bdev;
+
+	if (ch->info.block_size != bdev->blocklen || ch->info.num_blocks != bdev->blockcnt) {
+		SPDK_ERRLOG("geometry of %s changed on the server\n", bdev->name);
+		return -ENODEV;
+	}
+
+	ch->connected = true;
+	return 0;
+}
+
+static void
+bdev_ucx_info_recv_cb(void *request, ucs_status_t status, size_t length)
+{
+	struct bdev_ucx_request *req = request;
+	struct bdev_ucx_io_channel *ch = req->ch;
+	int rc;
+
+	if (ch == NULL) {
+		return;
+	}
+
+	TAILQ_REMOVE(&ch->reqs, req, link);
+	ucp_request_free(request);
+	if (status != UCS_OK) {
+		ch->error = bdev_ucx_status_to_errno(status);
+		return;
+	}
+	rc = bdev_ucx_check_info(ch);
+	if (rc != 0) {
+		ch->error = rc;
+	}
+}
+
+static int
+bdev_ucx_handle_info_rsp(struct bdev_ucx_io_channel *ch)
+{
+	struct bdev_ucx_request *req;
+	size_t length;
+
+	if (ch->connected || ch->rsp.status != 0 || ch->rsp.length != sizeof(ch->info)) {
+		SPDK_ERRLOG("unexpected INFO response\n");
+		return -EPROTO;
+	}
+
+	req = ucp_stream_recv_nb(ch->ep, &ch->info, 1, ucp_dt_make_contig(sizeof(ch->info)),
+				 bdev_ucx_info_recv_cb, &length, UCP_STREAM_RECV_FLAG_WAITALL);
+	if (req == NULL) {
+		return bdev_ucx_check_info(ch);
+	} else if (UCS_PTR_IS_ERR(req)) {
+		SPDK_ERRLOG("ucp_stream_recv_nb() failed: %s\n",
+			    ucs_status_string(UCS_PTR_STATUS(req)));
+		return bdev_ucx_status_to_errno(UCS_PTR_STATUS(req));
+	}
+
+	bdev_ucx_req_track(ch, req, NULL);
+	return 0;
+}
+
+/**
+ * Match a received response to its I/O. A successful READ that did not use
+ * RMA has its payload follow in the stream, it is received straight into the
+ * bdev buffers ahead of the next response header.
+ */
+static int
+bdev_ucx_handle_rsp(struct bdev_ucx_io_channel *ch)
+{
+	struct bdev_ucx_rsp *rsp = &ch->rsp;
+	struct bdev_ucx_slot *slot;
+	struct bdev_ucx_io *io;
+	struct spdk_bdev_io *bdev_io;
+	struct bdev_ucx_request *req;
+	size_t length;
+
+	ch->last_rsp_tsc = spdk_get_ticks();
+	if (rsp->id == BDEV_UCX_INFO_ID) {
+		return bdev_ucx_handle_info_rsp(ch);
+	}
+
+	slot = &ch->slots[(uint32_t)rsp->id % BDEV_UCX_QUEUE_DEPTH];
+	io = slot->io;
+	if ((uint32_t)rsp->id >= BDEV_UCX_QUEUE_DEPTH || io == NULL ||
+	    slot->gen != (uint32_t)(rsp->id >> 32)) {
+		SPDK_ERRLOG("response for unknown command %#" PRIx64 "\n", rsp->id);
+		return -EPROTO;
+	}
+
+	if (rsp->status != 0 || io->cmd.opcode != BDEV_UCX_OP_READ ||
+	    (io->cmd.flags & BDEV_UCX_CMD_FLAG_RMA)) {
+		bdev_ucx_io_put(ch, io, rsp->status);
+		return 0;
+	}
+
+	if (rsp->length != io->cmd.length) {
+		SPDK_ERRLOG("READ response of %u bytes, expected %u\n", rsp->length, io->cmd.length);
+		return -EPROTO;
+	}
+
+	bdev_io = spdk_bdev_io_from_ctx(io);
+	req = ucp_stream_recv_nb(ch->ep, bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+				 ucp_dt_make_iov(), bdev_ucx_payload_recv_cb, &length,
+				 UCP_STREAM_RECV_FLAG_WAITALL);
+	if (req == NULL) {
+		bdev_ucx_io_put(ch, io, 0);
+	} else if (UCS_PTR_IS_ERR(req)) {
+		SPDK_ERRLOG("ucp_stream_recv_nb() failed: %s\n",
+			    ucs_status_string(UCS_PTR_STATUS(req)));
+		return bdev_ucx_status_to_errno(UCS_PTR_STATUS(req));
+	} else {
+		bdev_ucx_req_track(ch, req, io);
+	}
+	return 0;
+}
+
+static void bdev_ucx_recv_rsp(struct bdev_ucx_io_channel *ch);
+
+static void
+bdev_ucx_rsp_recv_cb(void *request, ucs_status_t status, size_t length)
+{
+	struct bdev_ucx_request *req = request;
+	struct bdev_ucx_io_channel *ch = req->ch;
+	int rc;
+
+	if (ch == NULL) {
+		return;
+	}
+
+	TAILQ_REMOVE(&ch->reqs, req, link);
+	ucp_request_free(request);
+	if (status != UCS_OK) {
+		ch->error = bdev_ucx_status_to_errno(status);
+		return;
+	}
+
+	rc = bdev_ucx_handle_rsp(ch);
+	if (rc != 0) {
+		ch->error = rc;
+		return;
+	}
+	bdev_ucx_recv_rsp(ch);
+}
+
+/**
+ * Receive and handle response headers until one does not complete inline.
+ */
+static void
+bdev_ucx_recv_rsp(struct bdev_ucx_io_channel *ch)
+{
+	struct bdev_ucx_request *req;
+	size_t length;
+	int rc;
+
+	while (ch->error == 0) {
+		req = ucp_stream_recv_nb(ch->ep, &ch->rsp, 1, ucp_dt_make_contig(sizeof(ch->rsp)),
+					 bdev_ucx_rsp_recv_cb, &length, UCP_STREAM_RECV_FLAG_WAITALL);
+		if (req == NULL) {
+			rc = bdev_ucx_handle_rsp(ch);
+			if (rc != 0) {
+				ch->error = rc;
+			}
+			continue;
+		}
+
+		if (UCS_PTR_IS_ERR(req)) {
+			SPDK_ERRLOG("ucp_stream_recv_nb() failed: %s\n",
+				    ucs_status_string(UCS_PTR_STATUS(req)));
+			ch->error = bdev_ucx_status_to_errno(UCS_PTR_STATUS(req));
+		} else {
+			bdev_ucx_req_track(ch, req, NULL);
+		}
+		return;
+	}
+}
+
+static void
+bdev_ucx_io_complete(struct bdev_ucx_io_channel *ch, struct bdev_ucx_io *io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(io);
+
+	bdev_ucx_io_release(ch, io);
+	if (io->status != 0) {
+		SPDK_DEBUGLOG(SPDK_LOG_BDEV_UCX, "I/O at offset %" PRIu64 " failed: %s\n",
+			      io->cmd.offset, spdk_strerror(-io->status));
+	}
+	spdk_bdev_io_complete(bdev_io, io->status == 0 ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+/**
+ * The connection is unusable: close it, then fail every I/O on the channel.
+ */
+static void
+bdev_ucx_ch_fail(struct bdev_ucx_io_channel *ch)
+{
+	struct bdev_ucx_io *io;
+	uint32_t i;
+
+	SPDK_ERRLOG("connection to %s:%u failed: %s\n", ch->disk->address, ch->disk->port,
+		    spdk_strerror(-ch->error));
+	ch->failed = true;
+
+	/* Once closed, UCP does not touch the I/O buffers anymore */
+	bdev_ucx_orphan_reqs(ch);
+	bdev_ucx_disconnect(ch->worker, ch->ep, true);
+	ch->ep = NULL;
+
+	for (i = 0; i < BDEV_UCX_QUEUE_DEPTH; i++) {
+		io = ch->slots[i].io;
+		if (io != NULL) {
+			io->pending = 1;
+			bdev_ucx_io_put(ch, io, ch->error);
+		}
+	}
+	while ((io = TAILQ_FIRST(&ch->queued_ios)) != NULL) {
+		TAILQ_REMOVE(&ch->queued_ios, io, link);
+		io->status = ch->error;
+		TAILQ_INSERT_TAIL(&ch->completed_ios, io, link);
+	}
+}
+
+static int
+bdev_ucx_ch_poll(void *arg)
+{
+	struct bdev_ucx_io_channel *ch = arg;
+	struct bdev_ucx_io *io;
+	int count = 0;
+
+	if (spdk_likely(!ch->failed)) {
+		count = ucp_worker_progress(ch->worker);
+		if (count == 0 && (!ch->connected || ch->num_free_slots < BDEV_UCX_QUEUE_DEPTH) &&
+		    spdk_get_ticks() - ch->last_rsp_tsc > ch->io_timeout_ticks) {
+			ch->error = -ETIMEDOUT;
+		}
+		if (spdk_unlikely(ch->error != 0)) {
+			bdev_ucx_ch_fail(ch);
+		}
+	}
+
+	/* Completions may submit new I/O, they are never run inside UCP callbacks */
+	while ((io = TAILQ_FIRST(&ch->completed_ios)) != NULL) {
+		TAILQ_REMOVE(&ch->completed_ios, io, link);
+		bdev_ucx_io_complete(ch, io);
+		count++;
+	}
+
+	while (ch->connected && !ch->failed && ch->num_free_slots > 0 &&
+	       (io = TAILQ_FIRST(&ch->queued_ios)) != NULL) {
+		TAILQ_REMOVE(&ch->queued_ios, io, link);
+		bdev_ucx_io_send(ch, io);
+		count++;
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static void
+bdev_ucx_io_submit(struct bdev_ucx_io_channel *ch, struct bdev_ucx_io *io)
+{
+	memset(io, 0, offsetof(struct bdev_ucx_io, iov_inline));
+
+	if (spdk_unlikely(ch->failed)) {
+		io->status = -ECONNRESET;
+		TAILQ_INSERT_TAIL(&ch->completed_ios, io, link);
+	} else if (!ch->connected || ch->num_free_slots == 0 || !TAILQ_EMPTY(&ch->queued_ios)) {
+		TAILQ_INSERT_TAIL(&ch->queued_ios, io, link);
+	} else {
+		bdev_ucx_io_send(ch, io);
+	}
+}
+
+static void
+bdev_ucx_get_buf_cb(struct spdk_io_channel *_ch, struct spdk_bdev_io *bdev_io, bool success)
+{
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	bdev_ucx_io_submit(spdk_io_channel_get_ctx(_ch), (struct bdev_ucx_io *)bdev_io->driver_ctx);
+}
+
+static void
+bdev_ucx_submit_request(struct spdk_io_channel *_ch, struct spdk_bdev_io *bdev_io)
+{
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		spdk_bdev_io_get_buf(bdev_io, bdev_ucx_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		bdev_ucx_io_submit(spdk_io_channel_get_ctx(_ch),
+				   (struct bdev_ucx_io *)bdev_io->driver_ctx);
+		break;
+	default:
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static bool
+bdev_ucx_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int
+bdev_ucx_create_cb(void *io_device, void *ctx_buf)
+{
+	struct bdev_ucx_io_channel *ch = ctx_buf;
+	struct bdev_ucx_disk *disk = io_device;
+	struct bdev_ucx_request *req;
+	uint32_t i;
+	int rc;
+
+	ch->disk = disk;
+	TAILQ_INIT(&ch->queued_ios);
+	TAILQ_INIT(&ch->completed_ios);
+	TAILQ_INIT(&ch->reqs);
+	for (i = 0; i < BDEV_UCX_QUEUE_DEPTH; i++) {
+		ch->free_slots[i] = BDEV_UCX_QUEUE_DEPTH - 1 - i;
+	}
+	ch->num_free_slots = BDEV_UCX_QUEUE_DEPTH;
+	ch->io_timeout_ticks = BDEV_UCX_IO_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	ch->last_rsp_tsc = spdk_get_ticks();
+
+	rc = bdev_ucx_connect(&disk->addr, disk->addrlen, &ch->error, &ch->worker, &ch->ep);
+	if (rc != 0) {
+		SPDK_ERRLOG("failed to connect to %s:%u: %s\n", disk->address, disk->port,
+			    spdk_strerror(-rc));
+		return rc;
+	}
+
+	ch->info_cmd.opcode = BDEV_UCX_OP_INFO;
+	ch->info_cmd.id = BDEV_UCX_INFO_ID;
+	req = ucp_stream_send_nb(ch->ep, &ch->info_cmd, 1, ucp_dt_make_contig(sizeof(ch->info_cmd)),
+				 bdev_ucx_send_cb, 0);
+	if (UCS_PTR_IS_ERR(req)) {
+		SPDK_ERRLOG("ucp_stream_send_nb() failed: %s\n",
+			    ucs_status_string(UCS_PTR_STATUS(req)));
+		bdev_ucx_disconnect(ch->worker, ch->ep, true);
+		ucp_worker_destroy(ch->worker);
+		return bdev_ucx_status_to_errno(UCS_PTR_STATUS(req));
+	} else if (req != NULL) {
+		bdev_ucx_req_track(ch, req, NULL);
+	}
+
+	bdev_ucx_recv_rsp(ch);
+	ch->poller = SPDK_POLLER_REGISTER(bdev_ucx_ch_poll, ch, 0);
+	return 0;
+}
+
+static void
+bdev_ucx_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct bdev_ucx_io_channel *ch = ctx_buf;
+
+	assert(TAILQ_EMPTY(&ch->queued_ios));
+	assert(TAILQ_EMPTY(&ch->completed_ios));
+
+	spdk_poller_unregister(&ch->poller);
+	bdev_ucx_orphan_reqs(ch);
+	if (ch->ep != NULL) {
+		bdev_ucx_disconnect(ch->worker, ch->ep, false);
+	}
+	ucp_worker_destroy(ch->worker);
+}
+
+static struct spdk_io_channel *
+bdev_ucx_get_io_channel(void *ctx)
+{
+	return spdk_get_io_channel(ctx);
+}
+
+static void
+bdev_ucx_free_disk(struct bdev_ucx_disk *disk)
+{
+	free(disk->bdev.name);
+	free(disk->address);
+	free(disk);
+}
+
+static void
+_bdev_ucx_free_disk(void *arg)
+{
+	struct bdev_ucx_disk *disk = arg;
+
+	spdk_bdev_destruct_done(&disk->bdev, 0);
+	bdev_ucx_free_disk(disk);
+}
+
+static int
+bdev_ucx_destruct(void *ctx)
+{
+	struct bdev_ucx_disk *disk = ctx;
+
+	spdk_io_device_unregister(disk, _bdev_ucx_free_disk);
+	return 1;
+}
+
+static int
+bdev_ucx_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct bdev_ucx_disk *disk = ctx;
+
+	spdk_json_write_named_object_begin(w, "ucx");
+	spdk_json_write_named_string(w, "address", disk->address);
+	spdk_json_write_named_uint32(w, "port", disk->port);
+	spdk_json_write_named_int32(w, "rma_threshold", disk->rma_threshold);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+static void
+bdev_ucx_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	struct bdev_ucx_disk *disk = bdev->ctxt;
+
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_string(w, "method", "bdev_ucx_create");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_string(w, "name", bdev->name);
+	spdk_json_write_named_string(w, "address", disk->address);
+	spdk_json_write_named_uint32(w, "port", disk->port);
+	spdk_json_write_named_int32(w, "rma_threshold", disk->rma_threshold);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+}
+
+static const struct spdk_bdev_fn_table ucx_fn_table = {
+	.destruct		= bdev_ucx_destruct,
+	.submit_request		= bdev_ucx_submit_request,
+	.io_type_supported	= bdev_ucx_io_type_supported,
+	.get_io_channel		= bdev_ucx_get_io_channel,
+	.dump_info_json		= bdev_ucx_dump_info_json,
+	.write_config_json	= bdev_ucx_write_config_json,
+};
+
+static int
+create_ucx_bdev(struct bdev_ucx_conn_req *req, struct spdk_bdev **bdev)
+{
+	struct bdev_ucx_info *info = &req->reply.info;
+	struct bdev_ucx_disk *disk;
+	int rc;
+
+	if (info->block_size == 0 || info->num_blocks == 0 ||
+	    info->max_io_size < info->block_size) {
+		SPDK_ERRLOG("server reported an invalid device geometry\n");
+		return -EINVAL;
+	}
+
+	disk = calloc(1, sizeof(*disk));
+	if (disk == NULL) {
+		return -ENOMEM;
+	}
+
+	disk->bdev.name = strdup(req->opts.name);
+	disk->address = strdup(req->opts.address);
+	if (disk->bdev.name == NULL || disk->address == NULL) {
+		bdev_ucx_free_disk(disk);
+		return -ENOMEM;
+	}
+	disk->port = req->opts.port;
+	disk->rma_threshold = req->opts.rma_threshold;
+	disk->addr = req->addr;
+	disk->addrlen = req->addrlen;
+
+	disk->bdev.product_name = "UCX disk";
+	disk->bdev.module = &g_ucx_bdev_module;
+	disk->bdev.blocklen = info->block_size;
+	disk->bdev.blockcnt = info->num_blocks;
+	/* The server rejects larger commands */
+	disk->bdev.optimal_io_boundary = info->max_io_size / info->block_size;
+	disk->bdev.split_on_optimal_io_boundary = true;
+	disk->bdev.ctxt = disk;
+	disk->bdev.fn_table = &ucx_fn_table;
+
+	spdk_io_device_register(disk, bdev_ucx_create_cb, bdev_ucx_destroy_cb,
+				sizeof(struct bdev_ucx_io_channel), req->opts.name);
+	rc = spdk_bdev_register(&disk->bdev);
+	if (rc != 0) {
+		spdk_io_device_unregister(disk, NULL);
+		bdev_ucx_free_disk(disk);
+		return rc;
+	}
+
+	*bdev = &disk->bdev;
+	return 0;
+}
+
+static void
+bdev_ucx_conn_req_free(struct bdev_ucx_conn_req *req)
+{
+	if (req->send_req != NULL) {
+		ucp_request_free(req->send_req);
+	}
+	if (req->recv_req != NULL) {
+		ucp_request_free(req->recv_req);
+	}
+	if (req->ep != NULL) {
+		bdev_ucx_disconnect(req->worker, req->ep, req->status != 0);
+	}
+	if (req->worker != NULL) {
+		ucp_worker_destroy(req->worker);
+	}
+	free((char *)req->opts.name);
+	free((char *)req->opts.address);
+	free(req);
+}
+
+static void
+bdev_ucx_conn_req_complete(struct bdev_ucx_conn_req *req)
+{
+	struct spdk_bdev *bdev = NULL;
+
+	if (req->status == 0) {
+		req->status = create_ucx_bdev(req, &bdev);
+		if (req->status != 0) {
+			SPDK_ERRLOG("Unable to create UCX bdev: %s\n", spdk_strerror(-req->status));
+		}
+	}
+
+	TAILQ_REMOVE(&g_ucx_conn_reqs, req, link);
+	req->cb_fn(req->cb_arg, bdev, req->status);
+	bdev_ucx_conn_req_free(req);
+
+	if (TAILQ_EMPTY(&g_ucx_conn_reqs)) {
+		spdk_poller_unregister(&g_conn_poller);
+	}
+}
+
+static void
+bdev_ucx_conn_req_recv_cb(void *request, ucs_status_t status, size_t length)
+{
+}
+
+/**
+ * Drive the connections of the bdevs being created until the server answered
+ * their INFO command.
+ */
+static int
+bdev_ucx_conn_poll(void *arg)
+{
+	struct bdev_ucx_conn_req *req, *tmp;
+	ucs_status_t status;
+
+	TAILQ_FOREACH_SAFE(req, &g_ucx_conn_reqs, link, tmp) {
+		ucp_worker_progress(req->worker);
+
+		if (req->send_req != NULL) {
+			status = ucp_request_check_status(req->send_req);
+			if (status != UCS_INPROGRESS) {
+				ucp_request_free(req->send_req);
+				req->send_req = NULL;
+				req->status = bdev_ucx_status_to_errno(status);
+			}
+		}
+		if (req->recv_req != NULL && req->status == 0) {
+			status = ucp_request_check_status(req->recv_req);
+			if (status != UCS_INPROGRESS) {
+				ucp_request_free(req->recv_req);
+				req->recv_req = NULL;
+				req->status = bdev_ucx_status_to_errno(status);
+			}
+		}
+
+		if (req->status == 0 && req->recv_req == NULL && req->send_req == NULL) {
+			if (req->reply.rsp.status != 0) {
+				req->status = req->reply.rsp.status;
+			}
+		} else if (req->status == 0 && spdk_get_ticks() > req->timeout_tsc) {
+			SPDK_ERRLOG("no answer from %s:%u\n", req->opts.address, req->opts.port);
+			req->status = -ETIMEDOUT;
+		} else if (req->status == 0) {
+			continue;
+		}
+
+		bdev_ucx_conn_req_complete(req);
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
+static int
+bdev_ucx_parse_addr(const char *ip, uint16_t port, struct sockaddr_storage *sa,
+		    socklen_t *salen)
+{
+	char portnum[16];
+	struct addrinfo hints, *res;
+	int rc;
+
+	snprintf(portnum, sizeof(portnum), "%u", port);
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = PF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_NUMERICSERV | AI_NUMERICHOST;
+	rc = getaddrinfo(ip, portnum, &hints, &res);
+	if (rc != 0) {
+		SPDK_ERRLOG("invalid address %s: %s\n", ip, gai_strerror(rc));
+		return -EINVAL;
+	}
+
+	memset(sa, 0, sizeof(*sa));
+	*salen = spdk_min(res->ai_addrlen, sizeof(*sa));
+	memcpy(sa, res->ai_addr, *salen);
+	freeaddrinfo(res);
+
+	return 0;
+}
+
+int
+create_ucx_disk(const struct spdk_bdev_ucx_opts *opts, spdk_bdev_ucx_create_cb cb_fn,
+		void *cb_arg)
+{
+	struct bdev_ucx_conn_req *req;
+	size_t length;
+	int rc;
+
+	if (opts->name == NULL || opts->address == NULL || cb_fn == NULL) {
+		return -EINVAL;
+	}
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL) {
+		SPDK_ERRLOG("Cannot allocate struct bdev_ucx_conn_req\n");
+		return -ENOMEM;
+	}
+
+	req->opts = *opts;
+	req->opts.name = strdup(opts->name);
+	req->opts.address = strdup(opts->address);
+	if (req->opts.name == NULL || req->opts.address == NULL) {
+		rc = -ENOMEM;
+		goto err;
+	}
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+
+	rc = bdev_ucx_parse_addr(opts->address, opts->port, &req->addr, &req->addrlen);
+	if (rc != 0) {
+		goto err;
+	}
+
+	rc = bdev_ucx_connect(&req->addr, req->addrlen, &req->status, &req->worker, &req->ep);
+	if (rc != 0) {
+		goto err;
+	}
+
+	req->cmd.opcode = BDEV_UCX_OP_INFO;
+	req->send_req = ucp_stream_send_nb(req->ep, &req->cmd, 1,
+					   ucp_dt_make_contig(sizeof(req->cmd)),
+					   bdev_ucx_empty_send_cb, 0);
+	if (UCS_PTR_IS_ERR(req->send_req)) {
+		rc = bdev_ucx_status_to_errno(UCS_PTR_STATUS(req->send_req));
+		req->send_req = NULL;
+		goto err;
+	}
+
+	req->recv_req = ucp_stream_recv_nb(req->ep, &req->reply, 1,
+					   ucp_dt_make_contig(sizeof(req->reply)),
+					   bdev_ucx_conn_req_recv_cb, &length,
+					   UCP_STREAM_RECV_FLAG_WAITALL);
+	if (UCS_PTR_IS_ERR(req->recv_req)) {
+		rc = bdev_ucx_status_to_errno(UCS_PTR_STATUS(req->recv_req));
+		req->recv_req = NULL;
+		goto err;
+	}
+
+	req->timeout_tsc = spdk_get_ticks() +
+			   BDEV_UCX_CONN_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	TAILQ_INSERT_TAIL(&g_ucx_conn_reqs, req, link);
+	if (g_conn_poller == NULL) {
+		g_conn_poller = SPDK_POLLER_REGISTER(bdev_ucx_conn_poll, NULL, BDEV_UCX_CONN_POLL_US);
+	}
+
+	return 0;
+
+err:
+	req->status = rc;
+	bdev_ucx_conn_req_free(req);
+	return rc;
+}
+
+void
+delete_ucx_disk(struct spdk_bdev *bdev, spdk_delete_ucx_complete cb_fn, void *cb_arg)
+{
+	if (!bdev || bdev->module != &g_ucx_bdev_module) {
+		cb_fn(cb_arg, -ENODEV);
+		return;
+	}
+
+	spdk_bdev_unregister(bdev, cb_fn, cb_arg);
+}
+
+static int
+bdev_ucx_initialize(void)
+{
+	return 0;
+}
+
+static void
+bdev_ucx_finish(void)
+{
+	struct bdev_ucx_conn_req *req;
+
+	while ((req = TAILQ_FIRST(&g_ucx_conn_reqs)) != NULL) {
+		TAILQ_REMOVE(&g_ucx_conn_reqs, req, link);
+		req->status = -ECANCELED;
+		bdev_ucx_conn_req_free(req);
+	}
+	spdk_poller_unregister(&g_conn_poller);
+
+	spdk_ucx_free_mem_map(&g_ucx_mem_map);
+	if (g_ucx_context != NULL) {
+		ucp_cleanup(g_ucx_context);
+		g_ucx_context = NULL;
+	}
+}
+
+SPDK_LOG_REGISTER_COMPONENT("bdev_ucx", SPDK_LOG_BDEV_UCX)
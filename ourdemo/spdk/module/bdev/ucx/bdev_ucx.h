@@ -0,0 +1,87 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SPDK_BDEV_UCX_H
+#define SPDK_BDEV_UCX_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+
+typedef void (*spdk_delete_ucx_complete)(void *cb_arg, int bdeverrno);
+
+/**
+ * SPDK bdev UCX create callback type.
+ *
+ * \param cb_arg Completion callback custom arguments
+ * \param bdev created bdev
+ * \param status operation status. Zero on success.
+ */
+typedef void (*spdk_bdev_ucx_create_cb)(void *cb_arg, struct spdk_bdev *bdev, int status);
+
+struct spdk_bdev_ucx_opts {
+	/* Name of the new bdev */
+	const char *name;
+	/* Address and port of the ourdemo block server */
+	const char *address;
+	uint16_t port;
+	/*
+	 * I/Os of at least this many bytes into a single buffer have their
+	 * payload moved by the server with RMA instead of the stream.
+	 * Negative disables RMA.
+	 */
+	int32_t rma_threshold;
+};
+
+/**
+ * Connect to an ourdemo block server and expose its device as a new bdev.
+ * The bdev is registered once the server reported the device geometry.
+ *
+ * \param opts bdev options, copied.
+ * \param cb_fn Completion callback
+ * \param cb_arg Completion callback custom arguments
+ * \return 0 if the connection was started, negative errno otherwise.
+ */
+int create_ucx_disk(const struct spdk_bdev_ucx_opts *opts, spdk_bdev_ucx_create_cb cb_fn,
+		    void *cb_arg);
+
+/**
+ * Delete UCX bdev.
+ *
+ * \param bdev Pointer to UCX bdev.
+ * \param cb_fn Completion callback
+ * \param cb_arg Completion callback custom arguments
+ */
+void delete_ucx_disk(struct spdk_bdev *bdev, spdk_delete_ucx_complete cb_fn, void *cb_arg);
+
+#endif /* SPDK_BDEV_UCX_H */
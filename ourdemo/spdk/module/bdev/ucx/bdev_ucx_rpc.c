@@ -0,0 +1,170 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bdev_ucx.h"
+#include "spdk/rpc.h"
+#include "spdk/util.h"
+#include "spdk/string.h"
+
+#include "spdk_internal/log.h"
+
+#define BDEV_UCX_DEFAULT_PORT		13337
+#define BDEV_UCX_DEFAULT_RMA_THRESHOLD	8192
+
+struct rpc_bdev_ucx_create {
+	char *name;
+	char *address;
+	uint16_t port;
+	int32_t rma_threshold;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_ucx_create_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_ucx_create, name), spdk_json_decode_string},
+	{"address", offsetof(struct rpc_bdev_ucx_create, address), spdk_json_decode_string},
+	{"port", offsetof(struct rpc_bdev_ucx_create, port), spdk_json_decode_uint16, true},
+	{"rma_threshold", offsetof(struct rpc_bdev_ucx_create, rma_threshold), spdk_json_decode_int32, true},
+};
+
+static void
+free_rpc_bdev_ucx_create(struct rpc_bdev_ucx_create *req)
+{
+	free(req->name);
+	free(req->address);
+}
+
+static void
+rpc_bdev_ucx_create_cb(void *cb_arg, struct spdk_bdev *bdev, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+	struct spdk_json_write_ctx *w;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 spdk_strerror(-status));
+	} else {
+		w = spdk_jsonrpc_begin_result(request);
+		spdk_json_write_string(w, spdk_bdev_get_name(bdev));
+		spdk_jsonrpc_end_result(request, w);
+	}
+}
+
+static void
+rpc_bdev_ucx_create(struct spdk_jsonrpc_request *request,
+		    const struct spdk_json_val *params)
+{
+	struct rpc_bdev_ucx_create req = {
+		.port = BDEV_UCX_DEFAULT_PORT,
+		.rma_threshold = BDEV_UCX_DEFAULT_RMA_THRESHOLD,
+	};
+	struct spdk_bdev_ucx_opts opts = {};
+	int rc = 0;
+
+	if (spdk_json_decode_object(params, rpc_bdev_ucx_create_decoders,
+				    SPDK_COUNTOF(rpc_bdev_ucx_create_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	if (spdk_bdev_get_by_name(req.name) != NULL) {
+		spdk_jsonrpc_send_error_response(request, -EEXIST, spdk_strerror(EEXIST));
+		goto cleanup;
+	}
+
+	opts.name = req.name;
+	opts.address = req.address;
+	opts.port = req.port;
+	opts.rma_threshold = req.rma_threshold;
+	rc = create_ucx_disk(&opts, rpc_bdev_ucx_create_cb, request);
+	if (rc) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+	}
+
+cleanup:
+	free_rpc_bdev_ucx_create(&req);
+}
+SPDK_RPC_REGISTER("bdev_ucx_create", rpc_bdev_ucx_create, SPDK_RPC_RUNTIME)
+
+struct rpc_delete_ucx {
+	char *name;
+};
+
+static void
+free_rpc_delete_ucx(struct rpc_delete_ucx *r)
+{
+	free(r->name);
+}
+
+static const struct spdk_json_object_decoder rpc_delete_ucx_decoders[] = {
+	{"name", offsetof(struct rpc_delete_ucx, name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_ucx_delete_cb(void *cb_arg, int bdeverrno)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+	struct spdk_json_write_ctx *w = spdk_jsonrpc_begin_result(request);
+
+	spdk_json_write_bool(w, bdeverrno == 0);
+	spdk_jsonrpc_end_result(request, w);
+}
+
+static void
+rpc_bdev_ucx_delete(struct spdk_jsonrpc_request *request,
+		    const struct spdk_json_val *params)
+{
+	struct rpc_delete_ucx req = {NULL};
+	struct spdk_bdev *bdev;
+
+	if (spdk_json_decode_object(params, rpc_delete_ucx_decoders,
+				    SPDK_COUNTOF(rpc_delete_ucx_decoders),
+				    &req)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	bdev = spdk_bdev_get_by_name(req.name);
+	if (bdev == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+		goto cleanup;
+	}
+
+	delete_ucx_disk(bdev, rpc_bdev_ucx_delete_cb, request);
+
+cleanup:
+	free_rpc_delete_ucx(&req);
+}
+SPDK_RPC_REGISTER("bdev_ucx_delete", rpc_bdev_ucx_delete, SPDK_RPC_RUNTIME)
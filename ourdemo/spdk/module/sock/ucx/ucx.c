@@ -0,0 +1,1227 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include <ucp/api/ucp.h>
+
+#include "spdk/assert.h"
+#include "spdk/env.h"
+#include "spdk/likely.h"
+#include "spdk/log.h"
+#include "spdk/sock.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+
+#include "spdk_internal/log.h"
+#include "spdk_internal/sock.h"
+
+#define MAX_TMPBUF 1024
+#define PORTNUMLEN 32
+
+/* How long a close waits for the peer to acknowledge the data sent so far */
+#define UCX_SOCK_CLOSE_FLUSH_TIMEOUT_MS 1000
+
+/* spdk_sock_request iovecs are handed to UCP as-is, without any translation */
+SPDK_STATIC_ASSERT(sizeof(ucp_dt_iov_t) == sizeof(struct iovec), "Incorrect size");
+SPDK_STATIC_ASSERT(offsetof(ucp_dt_iov_t, buffer) == offsetof(struct iovec, iov_base),
+		   "Incorrect offset");
+SPDK_STATIC_ASSERT(offsetof(ucp_dt_iov_t, length) == offsetof(struct iovec, iov_len),
+		   "Incorrect offset");
+
+struct spdk_ucx_sock;
+
+/* Lives in the private area of every UCP send request issued by this module. */
+struct spdk_ucx_sock_request {
+	struct spdk_ucx_sock			*sock;
+	/* NULL for requests issued by the synchronous writev path */
+	struct spdk_sock_request		*req;
+	void					*bounce_buf;
+	ucs_status_t				status;
+	TAILQ_ENTRY(spdk_ucx_sock_request)	link;
+};
+
+struct spdk_ucx_conn_request {
+	ucp_conn_request_h			conn_request;
+	STAILQ_ENTRY(spdk_ucx_conn_request)	link;
+};
+
+struct spdk_ucx_sock {
+	struct spdk_sock			base;
+
+	/*
+	 * Every connection gets a worker of its own. UCP endpoints cannot be moved
+	 * between workers, while SPDK accepts a socket on one thread and then hands
+	 * it to a poll group that may run on any other thread. The price is that a
+	 * group poll progresses every worker, idle or not: an idle tcp worker costs
+	 * an epoll_wait() call per poll, an idle shared memory one a few FIFO reads.
+	 */
+	ucp_worker_h				worker;
+	ucp_ep_h				ep;
+
+	/* Listening sockets only */
+	ucp_listener_h				listener;
+	STAILQ_HEAD(, spdk_ucx_conn_request)	conn_requests;
+
+	struct sockaddr_storage			local_addr;
+	struct sockaddr_storage			peer_addr;
+
+	/* Stream data returned by ucp_stream_recv_data_nb() which is not fully consumed yet */
+	uint8_t					*recv_data;
+	size_t					recv_data_len;
+	size_t					recv_data_offset;
+
+	int					connection_status;
+	bool					pending_recv;
+
+	TAILQ_HEAD(, spdk_ucx_sock_request)	inflight_reqs;
+	TAILQ_HEAD(, spdk_ucx_sock_request)	completed_reqs;
+	TAILQ_ENTRY(spdk_ucx_sock)		link;
+};
+
+struct spdk_ucx_sock_group_impl {
+	struct spdk_sock_group_impl		base;
+	TAILQ_HEAD(, spdk_ucx_sock)		pending_recv;
+};
+
+static pthread_mutex_t g_ucx_context_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ucp_context_h g_ucx_context;
+
+#define __ucx_sock(sock) (struct spdk_ucx_sock *)sock
+#define __ucx_group_impl(group) (struct spdk_ucx_sock_group_impl *)group
+
+static int
+get_addr_str(struct sockaddr *sa, char *host, size_t hlen)
+{
+	const char *result = NULL;
+
+	if (sa == NULL || host == NULL) {
+		return -1;
+	}
+
+	switch (sa->sa_family) {
+	case AF_INET:
+		result = inet_ntop(AF_INET, &(((struct sockaddr_in *)sa)->sin_addr),
+				   host, hlen);
+		break;
+	case AF_INET6:
+		result = inet_ntop(AF_INET6, &(((struct sockaddr_in6 *)sa)->sin6_addr),
+				   host, hlen);
+		break;
+	default:
+		break;
+	}
+
+	if (result != NULL) {
+		return 0;
+	} else {
+		return -1;
+	}
+}
+
+static uint16_t
+get_addr_port(struct sockaddr_storage *sa)
+{
+	if (sa->ss_family == AF_INET) {
+		return ntohs(((struct sockaddr_in *)sa)->sin_port);
+	} else if (sa->ss_family == AF_INET6) {
+		return ntohs(((struct sockaddr_in6 *)sa)->sin6_port);
+	}
+
+	return 0;
+}
+
+static socklen_t
+get_addr_len(struct sockaddr_storage *sa)
+{
+	return sa->ss_family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+}
+
+static int
+ucx_status_to_errno(ucs_status_t status)
+{
+	switch (status) {
+	case UCS_OK:
+		return 0;
+	case UCS_ERR_CONNECTION_RESET:
+	case UCS_ERR_ENDPOINT_TIMEOUT:
+		return -ECONNRESET;
+	case UCS_ERR_CANCELED:
+		return -ECANCELED;
+	case UCS_ERR_NO_MEMORY:
+		return -ENOMEM;
+	case UCS_ERR_UNREACHABLE:
+		return -EHOSTUNREACH;
+	default:
+		return -EIO;
+	}
+}
+
+static ucp_context_h
+ucx_sock_get_context(void)
+{
+	ucp_params_t params = {};
+	ucs_status_t status;
+
+	pthread_mutex_lock(&g_ucx_context_mutex);
+	if (g_ucx_context == NULL) {
+		params.field_mask = UCP_PARAM_FIELD_FEATURES |
+				    UCP_PARAM_FIELD_REQUEST_SIZE |
+				    UCP_PARAM_FIELD_MT_WORKERS_SHARED;
+		params.features = UCP_FEATURE_STREAM;
+		params.request_size = sizeof(struct spdk_ucx_sock_request);
+		/* Workers are created on the acceptor thread and progressed on the poll groups */
+		params.mt_workers_shared = 1;
+
+		/* Transports are selected through the usual UCX_TLS/UCX_NET_DEVICES variables */
+		status = ucp_init(&params, NULL, &g_ucx_context);
+		if (status != UCS_OK) {
+			SPDK_ERRLOG("ucp_init() failed: %s\n", ucs_status_string(status));
+			g_ucx_context = NULL;
+		}
+	}
+	pthread_mutex_unlock(&g_ucx_context_mutex);
+
+	return g_ucx_context;
+}
+
+static ucp_worker_h
+ucx_sock_worker_create(void)
+{
+	ucp_worker_params_t params = {};
+	ucp_context_h context;
+	ucp_worker_h worker;
+	ucs_status_t status;
+
+	context = ucx_sock_get_context();
+	if (context == NULL) {
+		return NULL;
+	}
+
+	/* A socket is only ever driven by one thread at a time, but not always the same one */
+	params.field_mask = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+	params.thread_mode = UCS_THREAD_MODE_SERIALIZED;
+
+	status = ucp_worker_create(context, &params, &worker);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_worker_create() failed: %s\n", ucs_status_string(status));
+		return NULL;
+	}
+
+	return worker;
+}
+
+static int
+ucx_sock_parse_addr(const char *ip, int port, struct sockaddr_storage *sa)
+{
+	char buf[MAX_TMPBUF];
+	char portnum[PORTNUMLEN];
+	char *p;
+	struct addrinfo hints, *res;
+	int rc;
+
+	if (ip == NULL) {
+		return -EINVAL;
+	}
+	if (ip[0] == '[') {
+		snprintf(buf, sizeof(buf), "%s", ip + 1);
+		p = strchr(buf, ']');
+		if (p != NULL) {
+			*p = '\0';
+		}
+		ip = (const char *) &buf[0];
+	}
+
+	snprintf(portnum, sizeof portnum, "%d", port);
+	memset(&hints, 0, sizeof hints);
+	hints.ai_family = PF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_NUMERICSERV;
+	hints.ai_flags |= AI_PASSIVE;
+	hints.ai_flags |= AI_NUMERICHOST;
+	rc = getaddrinfo(ip, portnum, &hints, &res);
+	if (rc != 0) {
+		SPDK_ERRLOG("getaddrinfo() failed (errno=%d)\n", errno);
+		return -EINVAL;
+	}
+
+	memset(sa, 0, sizeof(*sa));
+	memcpy(sa, res->ai_addr, spdk_min(res->ai_addrlen, sizeof(*sa)));
+	freeaddrinfo(res);
+
+	return 0;
+}
+
+static struct spdk_ucx_sock *
+ucx_sock_alloc(void)
+{
+	struct spdk_ucx_sock *sock;
+
+	sock = calloc(1, sizeof(*sock));
+	if (sock == NULL) {
+		SPDK_ERRLOG("sock allocation failed\n");
+		return NULL;
+	}
+
+	STAILQ_INIT(&sock->conn_requests);
+	TAILQ_INIT(&sock->inflight_reqs);
+	TAILQ_INIT(&sock->completed_reqs);
+
+	return sock;
+}
+
+static void
+ucx_sock_free(struct spdk_ucx_sock *sock)
+{
+	if (sock->worker != NULL) {
+		ucp_worker_destroy(sock->worker);
+	}
+	free(sock);
+}
+
+static void
+ucx_sock_err_cb(void *arg, ucp_ep_h ep, ucs_status_t status)
+{
+	struct spdk_ucx_sock *sock = arg;
+
+	SPDK_DEBUGLOG(SPDK_SOCK_UCX, "sock %p: endpoint error: %s\n", sock,
+		      ucs_status_string(status));
+
+	if (sock->connection_status == 0) {
+		sock->connection_status = ucx_status_to_errno(status);
+	}
+}
+
+static void
+ucx_sock_conn_handler(ucp_conn_request_h conn_request, void *arg)
+{
+	struct spdk_ucx_sock *sock = arg;
+	struct spdk_ucx_conn_request *creq;
+
+	creq = calloc(1, sizeof(*creq));
+	if (creq == NULL) {
+		SPDK_ERRLOG("Unable to allocate connection request, rejecting it\n");
+		ucp_listener_reject(sock->listener, conn_request);
+		return;
+	}
+
+	creq->conn_request = conn_request;
+	STAILQ_INSERT_TAIL(&sock->conn_requests, creq, link);
+}
+
+static int
+ucx_sock_getaddr(struct spdk_sock *_sock, char *saddr, int slen, uint16_t *sport,
+		 char *caddr, int clen, uint16_t *cport)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	int rc;
+
+	assert(sock != NULL);
+
+	rc = get_addr_str((struct sockaddr *)&sock->local_addr, saddr, slen);
+	if (rc != 0) {
+		return -1;
+	}
+
+	if (sport) {
+		*sport = get_addr_port(&sock->local_addr);
+	}
+
+	rc = get_addr_str((struct sockaddr *)&sock->peer_addr, caddr, clen);
+	if (rc != 0) {
+		return -1;
+	}
+
+	if (cport) {
+		*cport = get_addr_port(&sock->peer_addr);
+	}
+
+	return 0;
+}
+
+static struct spdk_sock *
+ucx_sock_listen(const char *ip, int port, struct spdk_sock_opts *opts)
+{
+	struct spdk_ucx_sock *sock;
+	ucp_listener_params_t params = {};
+	ucp_listener_attr_t attr = {};
+	ucs_status_t status;
+
+	sock = ucx_sock_alloc();
+	if (sock == NULL) {
+		return NULL;
+	}
+
+	if (ucx_sock_parse_addr(ip, port, &sock->local_addr) != 0) {
+		goto err;
+	}
+
+	sock->worker = ucx_sock_worker_create();
+	if (sock->worker == NULL) {
+		goto err;
+	}
+
+	params.field_mask = UCP_LISTENER_PARAM_FIELD_SOCK_ADDR |
+			    UCP_LISTENER_PARAM_FIELD_CONN_HANDLER;
+	params.sockaddr.addr = (const struct sockaddr *)&sock->local_addr;
+	params.sockaddr.addrlen = get_addr_len(&sock->local_addr);
+	params.conn_handler.cb = ucx_sock_conn_handler;
+	params.conn_handler.arg = sock;
+
+	status = ucp_listener_create(sock->worker, &params, &sock->listener);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_listener_create() failed at %s:%d: %s\n", ip, port,
+			    ucs_status_string(status));
+		goto err;
+	}
+
+	/* Pick up the actual port if an ephemeral one was requested */
+	attr.field_mask = UCP_LISTENER_ATTR_FIELD_SOCKADDR;
+	status = ucp_listener_query(sock->listener, &attr);
+	if (status == UCS_OK) {
+		memcpy(&sock->local_addr, &attr.sockaddr, sizeof(sock->local_addr));
+	}
+
+	return &sock->base;
+
+err:
+	if (sock->listener != NULL) {
+		ucp_listener_destroy(sock->listener);
+	}
+	ucx_sock_free(sock);
+	return NULL;
+}
+
+static struct spdk_sock *
+ucx_sock_connect(const char *ip, int port, struct spdk_sock_opts *opts)
+{
+	struct spdk_ucx_sock *sock;
+	ucp_ep_params_t params = {};
+	ucs_status_t status;
+
+	sock = ucx_sock_alloc();
+	if (sock == NULL) {
+		return NULL;
+	}
+
+	if (ucx_sock_parse_addr(ip, port, &sock->peer_addr) != 0) {
+		goto err;
+	}
+
+	/* UCP does not expose the local address of a client endpoint */
+	sock->local_addr.ss_family = sock->peer_addr.ss_family;
+
+	sock->worker = ucx_sock_worker_create();
+	if (sock->worker == NULL) {
+		goto err;
+	}
+
+	params.field_mask = UCP_EP_PARAM_FIELD_FLAGS |
+			    UCP_EP_PARAM_FIELD_SOCK_ADDR |
+			    UCP_EP_PARAM_FIELD_ERR_HANDLER;
+	params.flags = UCP_EP_PARAMS_FLAGS_CLIENT_SERVER;
+	params.sockaddr.addr = (const struct sockaddr *)&sock->peer_addr;
+	params.sockaddr.addrlen = get_addr_len(&sock->peer_addr);
+	/*
+	 * Peer failure mode is not requested: tcp and shm have no peer failure
+	 * handler. Remote disconnects still reach the error callback when the
+	 * connection manager is enabled (UCX_SOCKADDR_CM_ENABLE=y).
+	 */
+	params.err_handler.cb = ucx_sock_err_cb;
+	params.err_handler.arg = sock;
+
+	/* Wireup completes in the background; sends posted before that are queued by UCP */
+	status = ucp_ep_create(sock->worker, &params, &sock->ep);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_ep_create() failed for %s:%d: %s\n", ip, port,
+			    ucs_status_string(status));
+		goto err;
+	}
+
+	return &sock->base;
+
+err:
+	ucx_sock_free(sock);
+	return NULL;
+}
+
+static struct spdk_sock *
+ucx_sock_accept(struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	struct spdk_ucx_sock *new_sock;
+	struct spdk_ucx_conn_request *creq;
+	ucp_ep_params_t params = {};
+	ucs_status_t status;
+
+	assert(sock != NULL);
+	assert(sock->listener != NULL);
+
+	ucp_worker_progress(sock->worker);
+
+	creq = STAILQ_FIRST(&sock->conn_requests);
+	if (creq == NULL) {
+		errno = EAGAIN;
+		return NULL;
+	}
+	STAILQ_REMOVE_HEAD(&sock->conn_requests, link);
+
+	new_sock = ucx_sock_alloc();
+	if (new_sock == NULL) {
+		goto err;
+	}
+
+	/* The initiator address is not reported by UCP, only its family is known */
+	memcpy(&new_sock->local_addr, &sock->local_addr, sizeof(new_sock->local_addr));
+	new_sock->peer_addr.ss_family = sock->local_addr.ss_family;
+
+	new_sock->worker = ucx_sock_worker_create();
+	if (new_sock->worker == NULL) {
+		goto err;
+	}
+
+	/* The error handling mode is inherited from the connecting side */
+	params.field_mask = UCP_EP_PARAM_FIELD_CONN_REQUEST |
+			    UCP_EP_PARAM_FIELD_ERR_HANDLER;
+	params.conn_request = creq->conn_request;
+	params.err_handler.cb = ucx_sock_err_cb;
+	params.err_handler.arg = new_sock;
+
+	status = ucp_ep_create(new_sock->worker, &params, &new_sock->ep);
+	if (status != UCS_OK) {
+		SPDK_ERRLOG("ucp_ep_create() failed on accept: %s\n", ucs_status_string(status));
+		/* UCP already consumed the connection request */
+		free(creq);
+		ucx_sock_free(new_sock);
+		return NULL;
+	}
+
+	free(creq);
+	return &new_sock->base;
+
+err:
+	ucp_listener_reject(sock->listener, creq->conn_request);
+	free(creq);
+	if (new_sock != NULL) {
+		ucx_sock_free(new_sock);
+	}
+	return NULL;
+}
+
+static void
+ucx_sock_release_req(struct spdk_ucx_sock_request *ctx)
+{
+	free(ctx->bounce_buf);
+	ctx->bounce_buf = NULL;
+	ucp_request_free(ctx);
+}
+
+/*
+ * Detach every UCP request from its spdk_sock_request. It is done right before
+ * the generic layer aborts the queued and pending requests, so that a late UCP
+ * completion does not touch a request which was already given back to the user.
+ */
+static void
+ucx_sock_orphan_reqs(struct spdk_ucx_sock *sock)
+{
+	struct spdk_ucx_sock_request *ctx, *tmp;
+
+	TAILQ_FOREACH(ctx, &sock->inflight_reqs, link) {
+		ctx->req = NULL;
+	}
+
+	TAILQ_FOREACH_SAFE(ctx, &sock->completed_reqs, link, tmp) {
+		TAILQ_REMOVE(&sock->completed_reqs, ctx, link);
+		ucx_sock_release_req(ctx);
+	}
+}
+
+static void
+ucx_sock_flush_cb(void *request, ucs_status_t status)
+{
+}
+
+/*
+ * Wait until everything sent on the endpoint has reached the peer, but for a limited
+ * time only: a peer which died without the transport noticing never acknowledges.
+ * Returns false if the endpoint could not be flushed in time.
+ */
+static bool
+ucx_sock_ep_flush(struct spdk_ucx_sock *sock)
+{
+	ucs_status_ptr_t flush_req;
+	ucs_status_t status;
+	uint64_t deadline;
+
+	flush_req = ucp_ep_flush_nb(sock->ep, 0, ucx_sock_flush_cb);
+	if (!UCS_PTR_IS_PTR(flush_req)) {
+		return UCS_PTR_STATUS(flush_req) == UCS_OK;
+	}
+
+	deadline = spdk_get_ticks() + UCX_SOCK_CLOSE_FLUSH_TIMEOUT_MS * spdk_get_ticks_hz() / 1000;
+	do {
+		ucp_worker_progress(sock->worker);
+		status = ucp_request_check_status(flush_req);
+	} while (status == UCS_INPROGRESS && spdk_get_ticks() < deadline);
+
+	/* A flush left in progress is purged by the forced close of the endpoint */
+	ucp_request_free(flush_req);
+
+	return status == UCS_OK;
+}
+
+static void
+ucx_sock_ep_close(struct spdk_ucx_sock *sock)
+{
+	struct spdk_ucx_sock_request *ctx;
+	ucs_status_ptr_t close_req;
+	ucs_status_t status;
+	unsigned mode = UCP_EP_CLOSE_MODE_FORCE;
+
+	ucx_sock_orphan_reqs(sock);
+
+	/*
+	 * Lanes are flushed beforehand, so that the close itself completes locally. A close
+	 * in flush mode cannot be turned into a forced one once it has been started.
+	 */
+	if (sock->connection_status == 0) {
+		if (ucx_sock_ep_flush(sock)) {
+			mode = UCP_EP_CLOSE_MODE_FLUSH;
+		} else {
+			SPDK_WARNLOG("sock %p: outstanding data could not be flushed, "
+				     "closing the endpoint forcibly\n", sock);
+		}
+	}
+
+	close_req = ucp_ep_close_nb(sock->ep, mode);
+	if (UCS_PTR_IS_PTR(close_req)) {
+		do {
+			ucp_worker_progress(sock->worker);
+			status = ucp_request_check_status(close_req);
+		} while (status == UCS_INPROGRESS);
+
+		ucp_request_free(close_req);
+	} else if (UCS_PTR_STATUS(close_req) != UCS_OK) {
+		SPDK_ERRLOG("sock %p: ucp_ep_close_nb() failed: %s\n", sock,
+			    ucs_status_string(UCS_PTR_STATUS(close_req)));
+	}
+	sock->ep = NULL;
+
+	/* Everything still in flight has been either flushed or purged by now */
+	while ((ctx = TAILQ_FIRST(&sock->completed_reqs)) != NULL) {
+		TAILQ_REMOVE(&sock->completed_reqs, ctx, link);
+		ucx_sock_release_req(ctx);
+	}
+	assert(TAILQ_EMPTY(&sock->inflight_reqs));
+}
+
+static int
+ucx_sock_close(struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	struct spdk_ucx_conn_request *creq;
+
+	assert(TAILQ_EMPTY(&_sock->pending_reqs));
+	assert(_sock->group_impl == NULL);
+
+	if (sock->listener != NULL) {
+		while ((creq = STAILQ_FIRST(&sock->conn_requests)) != NULL) {
+			STAILQ_REMOVE_HEAD(&sock->conn_requests, link);
+			ucp_listener_reject(sock->listener, creq->conn_request);
+			free(creq);
+		}
+		ucp_listener_destroy(sock->listener);
+	}
+
+	if (sock->ep != NULL) {
+		if (sock->recv_data != NULL) {
+			ucp_stream_data_release(sock->ep, sock->recv_data);
+			sock->recv_data = NULL;
+		}
+		ucx_sock_ep_close(sock);
+	}
+
+	ucx_sock_free(sock);
+
+	return 0;
+}
+
+static void
+ucx_sock_send_cb(void *request, ucs_status_t status)
+{
+	struct spdk_ucx_sock_request *ctx = request;
+	struct spdk_ucx_sock *sock = ctx->sock;
+
+	/* The user callbacks may close the socket, so they run outside of the UCP progress */
+	ctx->status = status;
+	TAILQ_REMOVE(&sock->inflight_reqs, ctx, link);
+	TAILQ_INSERT_TAIL(&sock->completed_reqs, ctx, link);
+}
+
+/*
+ * ucx_sock_abort(), ucx_sock_complete_reqs() and ucx_sock_flush_reqs() call back
+ * into the user. They return 1 if the socket was closed from one of the callbacks,
+ * in which case it must not be touched anymore.
+ */
+static int
+ucx_sock_abort(struct spdk_ucx_sock *sock, int status)
+{
+	if (sock->connection_status == 0) {
+		sock->connection_status = status;
+	}
+
+	ucx_sock_orphan_reqs(sock);
+
+	return spdk_sock_abort_requests(&sock->base) ? 1 : 0;
+}
+
+static int
+ucx_sock_complete_reqs(struct spdk_ucx_sock *sock)
+{
+	struct spdk_ucx_sock_request *ctx;
+	struct spdk_sock_request *req;
+	int status, rc;
+
+	while ((ctx = TAILQ_FIRST(&sock->completed_reqs)) != NULL) {
+		TAILQ_REMOVE(&sock->completed_reqs, ctx, link);
+		req = ctx->req;
+		status = ucx_status_to_errno(ctx->status);
+		ucx_sock_release_req(ctx);
+
+		if (spdk_unlikely(status != 0 && sock->connection_status == 0)) {
+			sock->connection_status = status;
+		}
+
+		if (req == NULL) {
+			continue;
+		}
+
+		rc = spdk_sock_request_put(&sock->base, req, status);
+		if (rc) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+ucx_sock_flush_reqs(struct spdk_ucx_sock *sock)
+{
+	struct spdk_sock *_sock = &sock->base;
+	struct spdk_ucx_sock_request *ctx;
+	struct spdk_sock_request *req;
+	ucs_status_ptr_t status_ptr;
+	int rc;
+
+	/* Can't flush from within a callback or we end up with recursive calls */
+	if (_sock->cb_cnt > 0) {
+		return 0;
+	}
+
+	while ((req = TAILQ_FIRST(&_sock->queued_reqs)) != NULL) {
+		/* UCP stream sends are all-or-nothing, so there is never a partial request to resume */
+		assert(req->internal.offset == 0);
+
+		if (req->iovcnt == 1) {
+			status_ptr = ucp_stream_send_nb(sock->ep, SPDK_SOCK_REQUEST_IOV(req, 0)->iov_base,
+							SPDK_SOCK_REQUEST_IOV(req, 0)->iov_len,
+							ucp_dt_make_contig(1), ucx_sock_send_cb, 0);
+		} else {
+			status_ptr = ucp_stream_send_nb(sock->ep, SPDK_SOCK_REQUEST_IOV(req, 0),
+							req->iovcnt, ucp_dt_make_iov(),
+							ucx_sock_send_cb, 0);
+		}
+
+		if (spdk_unlikely(UCS_PTR_IS_ERR(status_ptr))) {
+			SPDK_ERRLOG("sock %p: ucp_stream_send_nb() failed: %s\n", sock,
+				    ucs_status_string(UCS_PTR_STATUS(status_ptr)));
+			return ucx_status_to_errno(UCS_PTR_STATUS(status_ptr));
+		}
+
+		spdk_sock_request_pend(_sock, req);
+
+		if (status_ptr == NULL) {
+			/* Completed in place */
+			rc = spdk_sock_request_put(_sock, req, 0);
+			if (rc) {
+				return 1;
+			}
+			continue;
+		}
+
+		ctx = status_ptr;
+		ctx->sock = sock;
+		ctx->req = req;
+		ctx->bounce_buf = NULL;
+		TAILQ_INSERT_TAIL(&sock->inflight_reqs, ctx, link);
+	}
+
+	return 0;
+}
+
+static int
+ucx_sock_recv_data(struct spdk_ucx_sock *sock)
+{
+	ucs_status_ptr_t data;
+	size_t length;
+
+	assert(sock->recv_data == NULL);
+
+	data = ucp_stream_recv_data_nb(sock->ep, &length);
+	if (data == NULL) {
+		return -EAGAIN;
+	}
+
+	if (spdk_unlikely(UCS_PTR_IS_ERR(data))) {
+		if (sock->connection_status == 0) {
+			sock->connection_status = ucx_status_to_errno(UCS_PTR_STATUS(data));
+		}
+		return sock->connection_status;
+	}
+
+	sock->recv_data = data;
+	sock->recv_data_len = length;
+	sock->recv_data_offset = 0;
+
+	return 0;
+}
+
+static void
+ucx_sock_consume(struct spdk_ucx_sock *sock, void *buf, size_t len)
+{
+	memcpy(buf, sock->recv_data + sock->recv_data_offset, len);
+	sock->recv_data_offset += len;
+
+	if (sock->recv_data_offset == sock->recv_data_len) {
+		ucp_stream_data_release(sock->ep, sock->recv_data);
+		sock->recv_data = NULL;
+	}
+}
+
+static ssize_t
+ucx_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	size_t len, offset, bytes;
+	ssize_t total = 0;
+	int i;
+
+	if (sock->recv_data == NULL && _sock->group_impl == NULL) {
+		/* Nobody else drives this worker */
+		ucp_worker_progress(sock->worker);
+	}
+
+	len = 0;
+	for (i = 0; i < iovcnt; i++) {
+		len += iov[i].iov_len;
+
+		/* Keep pulling stream fragments until the user buffers are full */
+		for (offset = 0; offset < iov[i].iov_len; offset += bytes) {
+			if (sock->recv_data == NULL && ucx_sock_recv_data(sock) != 0) {
+				goto out;
+			}
+
+			bytes = spdk_min(iov[i].iov_len - offset,
+					 sock->recv_data_len - sock->recv_data_offset);
+			ucx_sock_consume(sock, (uint8_t *)iov[i].iov_base + offset, bytes);
+			total += bytes;
+		}
+	}
+
+out:
+	if (total > 0) {
+		return total;
+	}
+
+	if (len == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (sock->connection_status != 0) {
+		/* Report the peer going away the same way as an orderly shutdown */
+		return 0;
+	}
+
+	errno = EAGAIN;
+	return -1;
+}
+
+static ssize_t
+ucx_sock_recv(struct spdk_sock *sock, void *buf, size_t len)
+{
+	struct iovec iov[1];
+
+	iov[0].iov_base = buf;
+	iov[0].iov_len = len;
+
+	return ucx_sock_readv(sock, iov, 1);
+}
+
+static ssize_t
+ucx_sock_writev(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	struct spdk_ucx_sock_request *ctx;
+	ucs_status_ptr_t status_ptr;
+	struct iovec diov;
+	void *buf;
+	size_t len;
+	int i;
+
+	if (spdk_unlikely(sock->connection_status)) {
+		errno = -sock->connection_status;
+		return -1;
+	}
+
+	len = 0;
+	for (i = 0; i < iovcnt; i++) {
+		len += iov[i].iov_len;
+	}
+
+	if (len == 0) {
+		return 0;
+	}
+
+	/* The caller may reuse its buffers as soon as we return, so the data is staged */
+	buf = malloc(len);
+	if (buf == NULL) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	diov.iov_base = buf;
+	diov.iov_len = len;
+	spdk_iovcpy(iov, iovcnt, &diov, 1);
+
+	status_ptr = ucp_stream_send_nb(sock->ep, buf, len, ucp_dt_make_contig(1),
+					ucx_sock_send_cb, 0);
+	if (status_ptr == NULL) {
+		free(buf);
+	} else if (spdk_unlikely(UCS_PTR_IS_ERR(status_ptr))) {
+		free(buf);
+		errno = -ucx_status_to_errno(UCS_PTR_STATUS(status_ptr));
+		return -1;
+	} else {
+		ctx = status_ptr;
+		ctx->sock = sock;
+		ctx->req = NULL;
+		ctx->bounce_buf = buf;
+		TAILQ_INSERT_TAIL(&sock->inflight_reqs, ctx, link);
+	}
+
+	if (_sock->group_impl == NULL) {
+		ucp_worker_progress(sock->worker);
+	}
+
+	return len;
+}
+
+static int
+ucx_sock_flush(struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	int rc;
+
+	if (_sock->group_impl != NULL) {
+		/* The poll group flushes its sockets */
+		return 0;
+	}
+
+	ucp_worker_progress(sock->worker);
+
+	rc = ucx_sock_complete_reqs(sock);
+	if (rc) {
+		return 0;
+	}
+
+	if (spdk_unlikely(sock->connection_status)) {
+		ucx_sock_abort(sock, sock->connection_status);
+		return 0;
+	}
+
+	rc = ucx_sock_flush_reqs(sock);
+	if (rc < 0) {
+		ucx_sock_abort(sock, rc);
+		return rc;
+	}
+
+	return 0;
+}
+
+static void
+ucx_sock_writev_async(struct spdk_sock *_sock, struct spdk_sock_request *req)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+
+	if (spdk_unlikely(sock->connection_status)) {
+		req->cb_fn(req->cb_arg, sock->connection_status);
+		return;
+	}
+
+	spdk_sock_request_queue(_sock, req);
+}
+
+static int
+ucx_sock_set_recvlowat(struct spdk_sock *_sock, int nbytes)
+{
+	/* Readiness is reported as soon as any stream data arrives */
+	return 0;
+}
+
+static int
+ucx_sock_set_recvbuf(struct spdk_sock *_sock, int sz)
+{
+	/* UCP keeps received stream data in its own descriptors, there is no buffer to size */
+	return 0;
+}
+
+static int
+ucx_sock_set_sendbuf(struct spdk_sock *_sock, int sz)
+{
+	return 0;
+}
+
+static bool
+ucx_sock_is_ipv6(struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+
+	return sock->local_addr.ss_family == AF_INET6;
+}
+
+static bool
+ucx_sock_is_ipv4(struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+
+	return sock->local_addr.ss_family == AF_INET;
+}
+
+static bool
+ucx_sock_is_connected(struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+
+	return sock->ep != NULL && sock->connection_status == 0;
+}
+
+static int
+ucx_sock_get_placement_id(struct spdk_sock *_sock, int *placement_id)
+{
+	return -1;
+}
+
+static struct spdk_sock_group_impl *
+ucx_sock_group_impl_create(void)
+{
+	struct spdk_ucx_sock_group_impl *group_impl;
+
+	group_impl = calloc(1, sizeof(*group_impl));
+	if (group_impl == NULL) {
+		SPDK_ERRLOG("group_impl allocation failed\n");
+		return NULL;
+	}
+
+	TAILQ_INIT(&group_impl->pending_recv);
+
+	return &group_impl->base;
+}
+
+static int
+ucx_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group, struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	struct spdk_ucx_sock_group_impl *group = __ucx_group_impl(_group);
+
+	if (sock->listener != NULL) {
+		/* Listening sockets are driven by spdk_sock_accept() */
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	/* switched from another polling group due to scheduling */
+	if (spdk_unlikely(sock->recv_data != NULL)) {
+		assert(sock->pending_recv == false);
+		sock->pending_recv = true;
+		TAILQ_INSERT_TAIL(&group->pending_recv, sock, link);
+	}
+
+	return 0;
+}
+
+static int
+ucx_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group, struct spdk_sock *_sock)
+{
+	struct spdk_ucx_sock *sock = __ucx_sock(_sock);
+	struct spdk_ucx_sock_group_impl *group = __ucx_group_impl(_group);
+
+	if (sock->pending_recv) {
+		TAILQ_REMOVE(&group->pending_recv, sock, link);
+		sock->pending_recv = false;
+	}
+
+	return 0;
+}
+
+static bool
+ucx_sock_readable(struct spdk_ucx_sock *sock)
+{
+	if (sock->recv_data != NULL) {
+		return true;
+	}
+
+	if (ucx_sock_recv_data(sock) == 0) {
+		return true;
+	}
+
+	/* Let the owner see the EOF */
+	return sock->connection_status != 0;
+}
+
+static int
+ucx_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
+			 struct spdk_sock **socks)
+{
+	struct spdk_ucx_sock_group_impl *group = __ucx_group_impl(_group);
+	struct spdk_sock *_sock, *tmp;
+	struct spdk_ucx_sock *sock, *stmp;
+	int num_events, i, rc;
+
+	TAILQ_FOREACH_SAFE(_sock, &group->base.socks, link, tmp) {
+		sock = __ucx_sock(_sock);
+
+		ucp_worker_progress(sock->worker);
+
+		rc = ucx_sock_complete_reqs(sock);
+		if (rc || _sock->group_impl != _group) {
+			/* The socket was closed or removed from this group by a callback */
+			continue;
+		}
+
+		if (spdk_likely(sock->connection_status == 0)) {
+			rc = ucx_sock_flush_reqs(sock);
+			if (rc < 0) {
+				rc = ucx_sock_abort(sock, rc);
+			}
+		} else if (!TAILQ_EMPTY(&_sock->queued_reqs) || !TAILQ_EMPTY(&_sock->pending_reqs)) {
+			rc = ucx_sock_abort(sock, sock->connection_status);
+		}
+
+		if (rc > 0 || _sock->group_impl != _group || sock->pending_recv) {
+			continue;
+		}
+
+		if (ucx_sock_readable(sock)) {
+			sock->pending_recv = true;
+			TAILQ_INSERT_TAIL(&group->pending_recv, sock, link);
+		}
+	}
+
+	num_events = 0;
+	TAILQ_FOREACH_SAFE(sock, &group->pending_recv, link, stmp) {
+		if (num_events == max_events) {
+			break;
+		}
+
+		socks[num_events++] = &sock->base;
+	}
+
+	/* Cycle the pending_recv list so that each time we poll things aren't
+	 * in the same order. Sockets that still have data stay on the list
+	 * since UCP only signals new arrivals. */
+	for (i = 0; i < num_events; i++) {
+		sock = __ucx_sock(socks[i]);
+
+		TAILQ_REMOVE(&group->pending_recv, sock, link);
+
+		if (sock->recv_data == NULL && sock->connection_status == 0) {
+			sock->pending_recv = false;
+		} else {
+			TAILQ_INSERT_TAIL(&group->pending_recv, sock, link);
+		}
+	}
+
+	return num_events;
+}
+
+static int
+ucx_sock_group_impl_close(struct spdk_sock_group_impl *_group)
+{
+	struct spdk_ucx_sock_group_impl *group = __ucx_group_impl(_group);
+
+	assert(TAILQ_EMPTY(&group->pending_recv));
+	free(group);
+
+	return 0;
+}
+
+static struct spdk_net_impl g_ucx_net_impl = {
+	.name		= "ucx",
+	.getaddr	= ucx_sock_getaddr,
+	.connect	= ucx_sock_connect,
+	.listen		= ucx_sock_listen,
+	.accept		= ucx_sock_accept,
+	.close		= ucx_sock_close,
+	.recv		= ucx_sock_recv,
+	.readv		= ucx_sock_readv,
+	.writev		= ucx_sock_writev,
+	.writev_async	= ucx_sock_writev_async,
+	.flush		= ucx_sock_flush,
+	.set_recvlowat	= ucx_sock_set_recvlowat,
+	.set_recvbuf	= ucx_sock_set_recvbuf,
+	.set_sendbuf	= ucx_sock_set_sendbuf,
+	.is_ipv6	= ucx_sock_is_ipv6,
+	.is_ipv4	= ucx_sock_is_ipv4,
+	.is_connected	= ucx_sock_is_connected,
+	.get_placement_id	= ucx_sock_get_placement_id,
+	.group_impl_create	= ucx_sock_group_impl_create,
+	.group_impl_add_sock	= ucx_sock_group_impl_add_sock,
+	.group_impl_remove_sock	= ucx_sock_group_impl_remove_sock,
+	.group_impl_poll	= ucx_sock_group_impl_poll,
+	.group_impl_close	= ucx_sock_group_impl_close,
+};
+
+SPDK_NET_IMPL_REGISTER(ucx, &g_ucx_net_impl, DEFAULT_SOCK_PRIORITY - 1);
+
+static void __attribute__((destructor))
+ucx_sock_fini(void)
+{
+	if (g_ucx_context != NULL) {
+		ucp_cleanup(g_ucx_context);
+		g_ucx_context = NULL;
+	}
+}
+
+SPDK_LOG_REGISTER_COMPONENT("sock_ucx", SPDK_SOCK_UCX)
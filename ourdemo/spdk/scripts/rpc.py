@@ -380,6 +380,29 @@ if __name__ == "__main__":
     p.add_argument('name', help='uring bdev name')
     p.set_defaults(func=bdev_uring_delete)
 
+    def bdev_ucx_create(args):
+        print_json(rpc.bdev.bdev_ucx_create(args.client,
+                                            name=args.name,
+                                            address=args.address,
+                                            port=args.port,
+                                            rma_threshold=args.rma_threshold))
+
+    p = subparsers.add_parser('bdev_ucx_create', help='Create a bdev backed by an ourdemo block server over UCX')
+    p.add_argument('name', help='bdev name')
+    p.add_argument('address', help='IP address of the block server')
+    p.add_argument('--port', help='Port of the block server', type=int)
+    p.add_argument('--rma-threshold', help="""I/O size in bytes from which the payload is
+    moved with RMA instead of the stream. Negative disables RMA.""", type=int)
+    p.set_defaults(func=bdev_ucx_create)
+
+    def bdev_ucx_delete(args):
+        rpc.bdev.bdev_ucx_delete(args.client,
+                                 name=args.name)
+
+    p = subparsers.add_parser('bdev_ucx_delete', help='Delete a UCX bdev')
+    p.add_argument('name', help='UCX bdev name')
+    p.set_defaults(func=bdev_ucx_delete)
+
     def bdev_nvme_set_options(args):
         rpc.bdev.bdev_nvme_set_options(args.client,
                                        action_on_timeout=args.action_on_timeout,
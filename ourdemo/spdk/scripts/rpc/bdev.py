@@ -359,6 +359,39 @@ def bdev_uring_delete(client, name):
     return client.call('bdev_uring_delete', params)
 
 
+def bdev_ucx_create(client, name, address, port=None, rma_threshold=None):
+    """Create a bdev backed by an ourdemo block server reached over UCX.
+
+    Args:
+        name: name of bdev
+        address: IP address of the block server
+        port: port of the block server (optional; default 13337)
+        rma_threshold: I/O size in bytes from which the payload is moved with RMA (optional; negative disables RMA)
+
+    Returns:
+        Name of created bdev.
+    """
+    params = {'name': name,
+              'address': address}
+
+    if port is not None:
+        params['port'] = port
+    if rma_threshold is not None:
+        params['rma_threshold'] = rma_threshold
+
+    return client.call('bdev_ucx_create', params)
+
+
+def bdev_ucx_delete(client, name):
+    """Delete a UCX bdev.
+
+    Args:
+        name: name of UCX bdev to delete
+    """
+    params = {'name': name}
+    return client.call('bdev_ucx_delete', params)
+
+
 @deprecated_alias('set_bdev_nvme_options')
 def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, retry_count=None,
                           arbitration_burst=None, low_priority_weight=None,
@@ -0,0 +1,1201 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_cunit.h"
+
+#include "common/lib/test_env.c"
+#include "spdk_internal/mock.h"
+
+#include "bdev/ucx/bdev_ucx.c"
+#include "bdev/ucx/bdev_ucx_rpc.c"
+
+#define UT_UCP_REQS 64
+#define UT_RKEY_LEN 32
+#define UT_STREAM_LEN 16384
+#define UT_BLOCK_SIZE 512
+#define UT_NUM_BLOCKS 2048
+#define UT_MAX_IO_SIZE 65536
+/* Time spent in every ucp_worker_progress(), bounds the waits of the module */
+#define UT_PROGRESS_US 1000
+
+#define UT_RPC_REQUEST ((struct spdk_jsonrpc_request *)0xAB)
+
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB_V(spdk_bdev_destruct_done, (struct spdk_bdev *bdev, int bdeverrno));
+DEFINE_STUB_V(spdk_rpc_register_method, (const char *method, spdk_rpc_method_handler func,
+		uint32_t state_mask));
+DEFINE_STUB_V(spdk_jsonrpc_end_result, (struct spdk_jsonrpc_request *request,
+					struct spdk_json_write_ctx *w));
+DEFINE_STUB(spdk_json_decode_string, int, (const struct spdk_json_val *val, void *out), 0);
+DEFINE_STUB(spdk_json_decode_uint16, int, (const struct spdk_json_val *val, void *out), 0);
+DEFINE_STUB(spdk_json_decode_int32, int, (const struct spdk_json_val *val, void *out), 0);
+DEFINE_STUB(spdk_json_write_object_begin, int, (struct spdk_json_write_ctx *w), 0);
+DEFINE_STUB(spdk_json_write_object_end, int, (struct spdk_json_write_ctx *w), 0);
+DEFINE_STUB(spdk_json_write_named_object_begin, int, (struct spdk_json_write_ctx *w,
+		const char *name), 0);
+DEFINE_STUB(spdk_json_write_named_string, int, (struct spdk_json_write_ctx *w,
+		const char *name, const char *val), 0);
+DEFINE_STUB(spdk_json_write_named_uint32, int, (struct spdk_json_write_ctx *w,
+		const char *name, uint32_t val), 0);
+DEFINE_STUB(spdk_json_write_named_int32, int, (struct spdk_json_write_ctx *w,
+		const char *name, int32_t val), 0);
+
+DEFINE_STUB_V(spdk_ucx_free_mem_map, (struct spdk_ucx_mem_map **map));
+DEFINE_STUB_V(ucp_cleanup, (ucp_context_h context_p));
+DEFINE_STUB(ucs_status_string, const char *, (ucs_status_t status), "");
+
+static struct spdk_thread *g_thread;
+static TAILQ_HEAD(, spdk_bdev) g_bdev_list = TAILQ_HEAD_INITIALIZER(g_bdev_list);
+static struct spdk_io_channel *g_ch_io;
+
+/* RPC outcome */
+static struct rpc_bdev_ucx_create g_create_params;
+static const char *g_delete_name;
+static int g_rpc_err;
+static char *g_rpc_string;
+static int g_rpc_bool;
+
+/* bdev I/O outcome */
+static int g_io_completed;
+static enum spdk_bdev_io_status g_io_status;
+
+/* Every UCP request handed out, so that tests can complete them */
+struct ut_ucp_op {
+	void				*buffer;
+	size_t				count;
+	ucp_datatype_t			datatype;
+	ucp_send_callback_t		send_cb;
+	ucp_stream_recv_callback_t	recv_cb;
+	ucs_status_t			status;
+	bool				freed;
+};
+
+static struct bdev_ucx_request g_ucp_reqs[UT_UCP_REQS];
+static struct ut_ucp_op g_ucp_ops[UT_UCP_REQS];
+static int g_ucp_reqs_posted;
+static int g_ucp_reqs_freed;
+static int g_last_recv_op;
+
+/* Outcome of the next send: done in place, in flight or failed */
+static ucs_status_t g_send_status;
+/* A receive fails with it, or is served from the stream */
+static ucs_status_t g_recv_error;
+/* What the server sent on the stream and was not received yet */
+static uint8_t g_stream[UT_STREAM_LEN];
+static size_t g_stream_len;
+static size_t g_stream_off;
+
+static struct bdev_ucx_cmd g_sent_cmd;
+static size_t g_sent_count;
+static int g_workers;
+static ucs_status_t g_ep_create_status;
+static ucp_err_handler_cb_t g_ep_err_cb;
+static void *g_ep_err_arg;
+static unsigned g_close_mode;
+static int g_translation_rc;
+static int g_rkey_released;
+static int g_mem_unmapped;
+static uint8_t g_rkey_buf[UT_RKEY_LEN];
+
+static void
+ut_reset(void)
+{
+	memset(g_ucp_reqs, 0, sizeof(g_ucp_reqs));
+	memset(g_ucp_ops, 0, sizeof(g_ucp_ops));
+	g_ucp_reqs_posted = 0;
+	g_ucp_reqs_freed = 0;
+	g_last_recv_op = -1;
+	g_send_status = UCS_OK;
+	g_recv_error = UCS_OK;
+	g_stream_len = 0;
+	g_stream_off = 0;
+	memset(&g_sent_cmd, 0, sizeof(g_sent_cmd));
+	g_sent_count = 0;
+	g_ep_create_status = UCS_OK;
+	g_close_mode = 0;
+	g_translation_rc = 0;
+	g_rkey_released = 0;
+	g_mem_unmapped = 0;
+	g_rpc_err = 0;
+	free(g_rpc_string);
+	g_rpc_string = NULL;
+	g_rpc_bool = -1;
+	g_io_completed = 0;
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+}
+
+static void
+ut_stream_push(const void *buf, size_t len)
+{
+	SPDK_CU_ASSERT_FATAL(g_stream_len + len <= sizeof(g_stream));
+	memcpy(g_stream + g_stream_len, buf, len);
+	g_stream_len += len;
+}
+
+static size_t
+ut_dt_length(void *buffer, size_t count, ucp_datatype_t datatype)
+{
+	ucp_dt_iov_t *iov = buffer;
+	size_t i, length = 0;
+
+	if ((datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_CONTIG) {
+		return count * (datatype >> UCP_DATATYPE_SHIFT);
+	}
+
+	CU_ASSERT(datatype == ucp_dt_make_iov());
+	for (i = 0; i < count; i++) {
+		length += iov[i].length;
+	}
+	return length;
+}
+
+/* Receive from the stream if it holds enough data, like WAITALL does */
+static bool
+ut_stream_pull(void *buffer, size_t count, ucp_datatype_t datatype)
+{
+	ucp_dt_iov_t *iov = buffer, contig;
+	size_t i;
+
+	if (g_stream_len - g_stream_off < ut_dt_length(buffer, count, datatype)) {
+		return false;
+	}
+
+	if ((datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_CONTIG) {
+		contig.buffer = buffer;
+		contig.length = count * (datatype >> UCP_DATATYPE_SHIFT);
+		iov = &contig;
+		count = 1;
+	}
+	for (i = 0; i < count; i++) {
+		memcpy(iov[i].buffer, g_stream + g_stream_off, iov[i].length);
+		g_stream_off += iov[i].length;
+	}
+	return true;
+}
+
+static void *
+ut_ucp_post(void *buffer, size_t count, ucp_datatype_t datatype, ucp_send_callback_t send_cb,
+	    ucp_stream_recv_callback_t recv_cb)
+{
+	struct ut_ucp_op *op;
+
+	SPDK_CU_ASSERT_FATAL(g_ucp_reqs_posted < UT_UCP_REQS);
+	op = &g_ucp_ops[g_ucp_reqs_posted];
+	op->buffer = buffer;
+	op->count = count;
+	op->datatype = datatype;
+	op->send_cb = send_cb;
+	op->recv_cb = recv_cb;
+	op->status = UCS_INPROGRESS;
+	if (recv_cb != NULL) {
+		g_last_recv_op = g_ucp_reqs_posted;
+	}
+
+	return &g_ucp_reqs[g_ucp_reqs_posted++];
+}
+
+static int
+ut_ucp_op_index(void *request)
+{
+	int i = (struct bdev_ucx_request *)request - g_ucp_reqs;
+
+	SPDK_CU_ASSERT_FATAL(i >= 0 && i < g_ucp_reqs_posted);
+	return i;
+}
+
+/* Complete a request the way UCP progress would, receives take their data from the stream */
+static void
+ut_ucp_complete(int i, ucs_status_t status)
+{
+	struct ut_ucp_op *op = &g_ucp_ops[i];
+	size_t length = 0;
+
+	SPDK_CU_ASSERT_FATAL(i >= 0 && i < g_ucp_reqs_posted);
+	CU_ASSERT(op->status == UCS_INPROGRESS);
+	if (op->recv_cb != NULL && status == UCS_OK) {
+		SPDK_CU_ASSERT_FATAL(ut_stream_pull(op->buffer, op->count, op->datatype));
+		length = ut_dt_length(op->buffer, op->count, op->datatype);
+	}
+
+	op->status = status;
+	if (op->recv_cb != NULL) {
+		op->recv_cb(&g_ucp_reqs[i], status, length);
+	} else if (op->send_cb != NULL) {
+		op->send_cb(&g_ucp_reqs[i], status);
+	}
+}
+
+ucs_status_t
+ucp_init_version(unsigned api_major_version, unsigned api_minor_version,
+		 const ucp_params_t *params, const ucp_config_t *config,
+		 ucp_context_h *context_p)
+{
+	CU_ASSERT(params->request_size == sizeof(struct bdev_ucx_request));
+	*context_p = (ucp_context_h)0xC0;
+	return UCS_OK;
+}
+
+struct spdk_ucx_mem_map *
+spdk_ucx_create_mem_map(ucp_context_h context)
+{
+	return (struct spdk_ucx_mem_map *)0xAA;
+}
+
+int
+spdk_ucx_get_translation(struct spdk_ucx_mem_map *map, void *address, size_t length,
+			 struct spdk_ucx_memory_translation *translation)
+{
+	if (g_translation_rc != 0) {
+		return g_translation_rc;
+	}
+
+	translation->memh = (ucp_mem_h)0xBB;
+	translation->rkey_buf = g_rkey_buf;
+	translation->rkey_size = sizeof(g_rkey_buf);
+	return 0;
+}
+
+ucs_status_t
+ucp_mem_map(ucp_context_h context, const ucp_mem_map_params_t *params, ucp_mem_h *memh_p)
+{
+	*memh_p = (ucp_mem_h)0xBC;
+	return UCS_OK;
+}
+
+ucs_status_t
+ucp_mem_unmap(ucp_context_h context, ucp_mem_h memh)
+{
+	CU_ASSERT(memh == (ucp_mem_h)0xBC);
+	g_mem_unmapped++;
+	return UCS_OK;
+}
+
+ucs_status_t
+ucp_rkey_pack(ucp_context_h context, ucp_mem_h memh, void **rkey_buffer_p, size_t *size_p)
+{
+	*rkey_buffer_p = g_rkey_buf;
+	*size_p = UT_RKEY_LEN / 2;
+	return UCS_OK;
+}
+
+void
+ucp_rkey_buffer_release(void *rkey_buffer)
+{
+	CU_ASSERT(rkey_buffer == g_rkey_buf);
+	g_rkey_released++;
+}
+
+ucs_status_t
+ucp_worker_create(ucp_context_h context, const ucp_worker_params_t *params,
+		  ucp_worker_h *worker_p)
+{
+	CU_ASSERT(params->thread_mode == UCS_THREAD_MODE_SINGLE);
+	*worker_p = (ucp_worker_h)0xF0;
+	g_workers++;
+	return UCS_OK;
+}
+
+void
+ucp_worker_destroy(ucp_worker_h worker)
+{
+	CU_ASSERT(g_workers > 0);
+	g_workers--;
+}
+
+unsigned
+ucp_worker_progress(ucp_worker_h worker)
+{
+	spdk_delay_us(UT_PROGRESS_US);
+	return 0;
+}
+
+ucs_status_t
+ucp_ep_create(ucp_worker_h worker, const ucp_ep_params_t *params, ucp_ep_h *ep_p)
+{
+	g_ep_err_cb = params->err_handler.cb;
+	g_ep_err_arg = params->err_handler.arg;
+	*ep_p = (ucp_ep_h)0xE1;
+	return g_ep_create_status;
+}
+
+ucs_status_ptr_t
+ucp_ep_close_nb(ucp_ep_h ep, unsigned mode)
+{
+	g_close_mode = mode;
+	return NULL;
+}
+
+ucs_status_t
+ucp_request_check_status(void *request)
+{
+	return g_ucp_ops[ut_ucp_op_index(request)].status;
+}
+
+void
+ucp_request_free(void *request)
+{
+	struct ut_ucp_op *op = &g_ucp_ops[ut_ucp_op_index(request)];
+
+	CU_ASSERT(!op->freed);
+	op->freed = true;
+	g_ucp_reqs_freed++;
+}
+
+ucs_status_ptr_t
+ucp_stream_send_nb(ucp_ep_h ep, const void *buffer, size_t count, ucp_datatype_t datatype,
+		   ucp_send_callback_t cb, unsigned flags)
+{
+	const ucp_dt_iov_t *iov = buffer;
+
+	CU_ASSERT(ep == (ucp_ep_h)0xE1);
+	if (datatype == ucp_dt_make_iov()) {
+		SPDK_CU_ASSERT_FATAL(iov[0].length == sizeof(g_sent_cmd));
+		buffer = iov[0].buffer;
+	}
+	memcpy(&g_sent_cmd, buffer, sizeof(g_sent_cmd));
+	g_sent_count = count;
+
+	if (g_send_status == UCS_OK) {
+		return NULL;
+	} else if (g_send_status != UCS_INPROGRESS) {
+		return UCS_STATUS_PTR(g_send_status);
+	}
+
+	return ut_ucp_post((void *)buffer, count, datatype, cb, NULL);
+}
+
+ucs_status_ptr_t
+ucp_stream_recv_nb(ucp_ep_h ep, void *buffer, size_t count, ucp_datatype_t datatype,
+		   ucp_stream_recv_callback_t cb, size_t *length, unsigned flags)
+{
+	CU_ASSERT(ep == (ucp_ep_h)0xE1);
+	CU_ASSERT(flags == UCP_STREAM_RECV_FLAG_WAITALL);
+	if (g_recv_error != UCS_OK) {
+		return UCS_STATUS_PTR(g_recv_error);
+	}
+
+	if (ut_stream_pull(buffer, count, datatype)) {
+		*length = ut_dt_length(buffer, count, datatype);
+		return NULL;
+	}
+
+	return ut_ucp_post(buffer, count, datatype, NULL, cb);
+}
+
+int
+spdk_bdev_register(struct spdk_bdev *bdev)
+{
+	CU_ASSERT_PTR_NULL(spdk_bdev_get_by_name(bdev->name));
+	TAILQ_INSERT_TAIL(&g_bdev_list, bdev, internal.link);
+
+	return 0;
+}
+
+void
+spdk_bdev_unregister(struct spdk_bdev *bdev, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	CU_ASSERT_EQUAL(spdk_bdev_get_by_name(bdev->name), bdev);
+	TAILQ_REMOVE(&g_bdev_list, bdev, internal.link);
+
+	bdev->fn_table->destruct(bdev->ctxt);
+
+	if (cb_fn) {
+		cb_fn(cb_arg, 0);
+	}
+}
+
+struct spdk_bdev *
+spdk_bdev_get_by_name(const char *bdev_name)
+{
+	struct spdk_bdev *bdev;
+
+	TAILQ_FOREACH(bdev, &g_bdev_list, internal.link) {
+		if (strcmp(bdev_name, bdev->name) == 0) {
+			return bdev;
+		}
+	}
+
+	return NULL;
+}
+
+const char *
+spdk_bdev_get_name(const struct spdk_bdev *bdev)
+{
+	return bdev->name;
+}
+
+void
+spdk_bdev_io_get_buf(struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb, uint64_t len)
+{
+	CU_ASSERT(len == bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+	cb(g_ch_io, bdev_io, true);
+}
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	g_io_completed++;
+	g_io_status = status;
+}
+
+int
+spdk_json_decode_object(const struct spdk_json_val *values,
+			const struct spdk_json_object_decoder *decoders, size_t num_decoders,
+			void *out)
+{
+	struct rpc_bdev_ucx_create *create = out;
+	struct rpc_delete_ucx *delete = out;
+
+	if (decoders == rpc_bdev_ucx_create_decoders) {
+		create->name = strdup(g_create_params.name);
+		create->address = strdup(g_create_params.address);
+		SPDK_CU_ASSERT_FATAL(create->name != NULL && create->address != NULL);
+		if (g_create_params.port != 0) {
+			create->port = g_create_params.port;
+		}
+		if (g_create_params.rma_threshold != 0) {
+			create->rma_threshold = g_create_params.rma_threshold;
+		}
+	} else {
+		CU_ASSERT(decoders == rpc_delete_ucx_decoders);
+		delete->name = strdup(g_delete_name);
+		SPDK_CU_ASSERT_FATAL(delete->name != NULL);
+	}
+
+	return 0;
+}
+
+struct spdk_json_write_ctx *
+spdk_jsonrpc_begin_result(struct spdk_jsonrpc_request *request)
+{
+	CU_ASSERT(request == UT_RPC_REQUEST);
+	return (void *)1;
+}
+
+void
+spdk_jsonrpc_send_error_response(struct spdk_jsonrpc_request *request,
+				 int error_code, const char *msg)
+{
+	CU_ASSERT(request == UT_RPC_REQUEST);
+	g_rpc_err = error_code;
+}
+
+int
+spdk_json_write_string(struct spdk_json_write_ctx *w, const char *val)
+{
+	free(g_rpc_string);
+	g_rpc_string = strdup(val);
+	return 0;
+}
+
+int
+spdk_json_write_bool(struct spdk_json_write_ctx *w, bool val)
+{
+	g_rpc_bool = val;
+	return 0;
+}
+
+static void
+poll_thread(void)
+{
+	while (spdk_thread_poll(g_thread, 0, 0) > 0) {}
+}
+
+/* Answer the INFO a new connection sends with the geometry of the test device */
+static void
+ut_server_info(int32_t status, uint32_t block_size)
+{
+	struct bdev_ucx_rsp rsp = { .id = g_sent_cmd.id, .status = status };
+	struct bdev_ucx_info info = {
+		.block_size = block_size,
+		.max_io_size = UT_MAX_IO_SIZE,
+		.num_blocks = UT_NUM_BLOCKS,
+	};
+
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_INFO);
+	rsp.length = status == 0 ? sizeof(info) : 0;
+	ut_stream_push(&rsp, sizeof(rsp));
+	ut_stream_push(&info, sizeof(info));
+}
+
+static void
+ut_server_rsp(uint64_t id, int32_t status, const void *payload, uint32_t length)
+{
+	struct bdev_ucx_rsp rsp = { .id = id, .status = status, .length = length };
+
+	ut_stream_push(&rsp, sizeof(rsp));
+	if (payload != NULL) {
+		ut_stream_push(payload, length);
+	}
+}
+
+static void
+ut_create_cb(void *cb_arg, struct spdk_bdev *bdev, int status)
+{
+	struct spdk_bdev **bdev_p = cb_arg;
+
+	CU_ASSERT(status == 0);
+	*bdev_p = bdev;
+}
+
+static struct spdk_bdev *
+ut_create_disk(int32_t rma_threshold)
+{
+	struct spdk_bdev_ucx_opts opts = {
+		.name = "ucx0",
+		.address = "127.0.0.1",
+		.port = 4420,
+		.rma_threshold = rma_threshold,
+	};
+	struct spdk_bdev *bdev = NULL;
+
+	CU_ASSERT(create_ucx_disk(&opts, ut_create_cb, &bdev) == 0);
+	ut_server_info(0, UT_BLOCK_SIZE);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	bdev_ucx_conn_poll(NULL);
+	SPDK_CU_ASSERT_FATAL(bdev != NULL);
+
+	return bdev;
+}
+
+static void
+ut_delete_cb(void *cb_arg, int bdeverrno)
+{
+	*(int *)cb_arg = bdeverrno;
+}
+
+static void
+ut_delete_disk(struct spdk_bdev *bdev)
+{
+	int rc = 1;
+
+	delete_ucx_disk(bdev, ut_delete_cb, &rc);
+	poll_thread();
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_list));
+	/* Every worker is gone and no UCP request is left behind */
+	CU_ASSERT(g_workers == 0);
+	CU_ASSERT(g_ucp_reqs_freed == g_ucp_reqs_posted);
+}
+
+static struct bdev_ucx_io_channel *
+ut_get_channel(struct spdk_bdev *bdev)
+{
+	struct bdev_ucx_io_channel *ch;
+
+	g_ch_io = spdk_get_io_channel(bdev->ctxt);
+	SPDK_CU_ASSERT_FATAL(g_ch_io != NULL);
+	ch = spdk_io_channel_get_ctx(g_ch_io);
+	CU_ASSERT(!ch->connected);
+	CU_ASSERT(g_sent_cmd.id == BDEV_UCX_INFO_ID);
+
+	return ch;
+}
+
+static struct bdev_ucx_io_channel *
+ut_connect_channel(struct spdk_bdev *bdev)
+{
+	struct bdev_ucx_io_channel *ch = ut_get_channel(bdev);
+
+	ut_server_info(0, UT_BLOCK_SIZE);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	CU_ASSERT(ch->connected);
+	CU_ASSERT(ch->error == 0);
+
+	return ch;
+}
+
+static void
+ut_put_channel(void)
+{
+	spdk_put_io_channel(g_ch_io);
+	g_ch_io = NULL;
+	poll_thread();
+}
+
+static struct spdk_bdev_io *
+ut_alloc_io(struct spdk_bdev *bdev, enum spdk_bdev_io_type type, struct iovec *iovs, int iovcnt,
+	    uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct bdev_ucx_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = bdev;
+	bdev_io->type = type;
+	bdev_io->u.bdev.iovs = iovs;
+	bdev_io->u.bdev.iovcnt = iovcnt;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+
+	return bdev_io;
+}
+
+static void
+test_rpc_create_delete(void)
+{
+	struct spdk_bdev *bdev;
+	struct bdev_ucx_disk *disk;
+	int send_op;
+
+	ut_reset();
+	g_create_params.name = "ucx0";
+	g_create_params.address = "127.0.0.1";
+	g_create_params.port = 0;
+	g_create_params.rma_threshold = 4096;
+
+	/* The bdev shows up once the server answered the INFO */
+	g_send_status = UCS_INPROGRESS;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	CU_ASSERT(g_rpc_string == NULL);
+	CU_ASSERT(g_conn_poller != NULL);
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_INFO);
+	CU_ASSERT(g_ucp_reqs_posted == 2);
+	send_op = 0;
+
+	bdev_ucx_conn_poll(NULL);
+	CU_ASSERT(g_rpc_string == NULL);
+	CU_ASSERT(spdk_bdev_get_by_name("ucx0") == NULL);
+
+	ut_server_info(0, UT_BLOCK_SIZE);
+	ut_ucp_complete(send_op, UCS_OK);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	g_send_status = UCS_OK;
+	bdev_ucx_conn_poll(NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	SPDK_CU_ASSERT_FATAL(g_rpc_string != NULL);
+	CU_ASSERT(strcmp(g_rpc_string, "ucx0") == 0);
+	CU_ASSERT(g_conn_poller == NULL);
+	/* The connection used to query the device is closed */
+	CU_ASSERT(g_workers == 0);
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_DISCONNECT);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FLUSH);
+	CU_ASSERT(g_ucp_reqs_freed == g_ucp_reqs_posted);
+
+	bdev = spdk_bdev_get_by_name("ucx0");
+	SPDK_CU_ASSERT_FATAL(bdev != NULL);
+	disk = bdev->ctxt;
+	CU_ASSERT(bdev->module == &g_ucx_bdev_module);
+	CU_ASSERT(bdev->blocklen == UT_BLOCK_SIZE);
+	CU_ASSERT(bdev->blockcnt == UT_NUM_BLOCKS);
+	CU_ASSERT(bdev->optimal_io_boundary == UT_MAX_IO_SIZE / UT_BLOCK_SIZE);
+	CU_ASSERT(bdev->split_on_optimal_io_boundary == true);
+	CU_ASSERT(strcmp(disk->address, "127.0.0.1") == 0);
+	CU_ASSERT(disk->port == BDEV_UCX_DEFAULT_PORT);
+	CU_ASSERT(disk->rma_threshold == 4096);
+	CU_ASSERT(bdev_ucx_io_type_supported(disk, SPDK_BDEV_IO_TYPE_READ));
+	CU_ASSERT(bdev_ucx_io_type_supported(disk, SPDK_BDEV_IO_TYPE_WRITE));
+	CU_ASSERT(!bdev_ucx_io_type_supported(disk, SPDK_BDEV_IO_TYPE_UNMAP));
+
+	/* The name is taken */
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_rpc_err == -EEXIST);
+	CU_ASSERT(g_conn_poller == NULL);
+	CU_ASSERT(g_workers == 0);
+
+	g_delete_name = "ucx0";
+	rpc_bdev_ucx_delete(UT_RPC_REQUEST, NULL);
+	poll_thread();
+	CU_ASSERT(g_rpc_bool == true);
+	CU_ASSERT(spdk_bdev_get_by_name("ucx0") == NULL);
+
+	g_rpc_err = 0;
+	rpc_bdev_ucx_delete(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_rpc_err == -ENODEV);
+}
+
+static void
+test_rpc_create_errors(void)
+{
+	ut_reset();
+	g_create_params.name = "ucx0";
+	g_create_params.port = 4420;
+	g_create_params.rma_threshold = 0;
+
+	/* Not a numeric address */
+	g_create_params.address = "localhost:4420";
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_rpc_err == -EINVAL);
+	CU_ASSERT(g_conn_poller == NULL);
+	CU_ASSERT(g_workers == 0);
+
+	/* The endpoint cannot be created */
+	g_rpc_err = 0;
+	g_create_params.address = "127.0.0.1";
+	g_ep_create_status = UCS_ERR_UNREACHABLE;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_rpc_err == -EHOSTUNREACH);
+	CU_ASSERT(g_workers == 0);
+	g_ep_create_status = UCS_OK;
+
+	/* The INFO cannot be sent */
+	g_rpc_err = 0;
+	g_send_status = UCS_ERR_NO_MEMORY;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_rpc_err == -ENOMEM);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(g_workers == 0);
+	g_send_status = UCS_OK;
+
+	/* The server has no device */
+	g_rpc_err = 0;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	ut_server_info(-ENODEV, UT_BLOCK_SIZE);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	bdev_ucx_conn_poll(NULL);
+	CU_ASSERT(g_rpc_err == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+	CU_ASSERT(g_rpc_string == NULL);
+	CU_ASSERT(g_conn_poller == NULL);
+	CU_ASSERT(g_workers == 0);
+
+	/* The server reports a broken geometry */
+	g_rpc_err = 0;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	ut_server_info(0, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	bdev_ucx_conn_poll(NULL);
+	CU_ASSERT(g_rpc_err == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_list));
+	CU_ASSERT(g_workers == 0);
+
+	/* The connection fails */
+	g_rpc_err = 0;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	ut_ucp_complete(g_last_recv_op, UCS_ERR_CONNECTION_RESET);
+	bdev_ucx_conn_poll(NULL);
+	CU_ASSERT(g_rpc_err == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(g_workers == 0);
+
+	/* No answer */
+	g_rpc_err = 0;
+	g_close_mode = 0;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	bdev_ucx_conn_poll(NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	spdk_delay_us(BDEV_UCX_CONN_TIMEOUT_US);
+	bdev_ucx_conn_poll(NULL);
+	CU_ASSERT(g_rpc_err == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(g_conn_poller == NULL);
+	CU_ASSERT(g_workers == 0);
+
+	/* Still connecting when the module goes away */
+	g_rpc_err = 0;
+	rpc_bdev_ucx_create(UT_RPC_REQUEST, NULL);
+	CU_ASSERT(g_conn_poller != NULL);
+	bdev_ucx_finish();
+	CU_ASSERT(g_rpc_err == 0);
+	CU_ASSERT(g_conn_poller == NULL);
+	CU_ASSERT(g_ucx_context == NULL);
+	CU_ASSERT(g_workers == 0);
+	CU_ASSERT(g_ucp_reqs_freed == g_ucp_reqs_posted);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_list));
+}
+
+static void
+test_io_write(void)
+{
+	struct spdk_bdev *bdev;
+	struct bdev_ucx_io_channel *ch;
+	struct spdk_bdev_io *bdev_io;
+	uint8_t buf[4 * UT_BLOCK_SIZE];
+	struct iovec iovs[2] = {
+		{ .iov_base = buf, .iov_len = 1024 },
+		{ .iov_base = buf + 1024, .iov_len = 1024 },
+	};
+	int send_op;
+
+	ut_reset();
+	bdev = ut_create_disk(-1);
+	ch = ut_connect_channel(bdev);
+
+	/* The payload follows the command in the stream */
+	bdev_io = ut_alloc_io(bdev, SPDK_BDEV_IO_TYPE_WRITE, iovs, 2, 8, 4);
+	g_send_status = UCS_INPROGRESS;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	g_send_status = UCS_OK;
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_WRITE);
+	CU_ASSERT(g_sent_cmd.flags == 0);
+	CU_ASSERT(g_sent_cmd.offset == 8 * UT_BLOCK_SIZE);
+	CU_ASSERT(g_sent_cmd.length == 4 * UT_BLOCK_SIZE);
+	CU_ASSERT(g_sent_count == 3);
+	CU_ASSERT(ch->num_free_slots == BDEV_UCX_QUEUE_DEPTH - 1);
+	send_op = g_ucp_reqs_posted - 1;
+
+	/* Done once both the send and the response completed */
+	ut_server_rsp(g_sent_cmd.id, 0, NULL, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 0);
+	ut_ucp_complete(send_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ch->num_free_slots == BDEV_UCX_QUEUE_DEPTH);
+
+	/* The server fails it */
+	g_io_completed = 0;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	ut_server_rsp(g_sent_cmd.id, -EIO, NULL, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(ch->error == 0);
+
+	/* Not supported */
+	g_io_completed = 0;
+	bdev_io->type = SPDK_BDEV_IO_TYPE_UNMAP;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+
+	free(bdev_io);
+	ut_put_channel();
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_DISCONNECT);
+	ut_delete_disk(bdev);
+}
+
+static void
+test_io_read(void)
+{
+	struct spdk_bdev *bdev;
+	struct bdev_ucx_io_channel *ch;
+	struct spdk_bdev_io *bdev_io;
+	uint8_t buf[2 * UT_BLOCK_SIZE], payload[2 * UT_BLOCK_SIZE];
+	struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+	int payload_op;
+
+	ut_reset();
+	bdev = ut_create_disk(sizeof(buf) + 1);
+	ch = ut_connect_channel(bdev);
+	memset(payload, 0x5A, sizeof(payload));
+
+	/* Below the RMA threshold the payload follows the response in the stream */
+	bdev_io = ut_alloc_io(bdev, SPDK_BDEV_IO_TYPE_READ, &iov, 1, 0, 2);
+	memset(buf, 0, sizeof(buf));
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_READ);
+	CU_ASSERT(g_sent_cmd.flags == 0);
+	CU_ASSERT(g_sent_cmd.length == sizeof(buf));
+	CU_ASSERT(g_sent_count == 1);
+	ut_server_rsp(g_sent_cmd.id, 0, payload, sizeof(payload));
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(memcmp(buf, payload, sizeof(buf)) == 0);
+
+	/* The payload arrives after its response */
+	g_io_completed = 0;
+	memset(buf, 0, sizeof(buf));
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	ut_server_rsp(g_sent_cmd.id, 0, NULL, sizeof(payload));
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	/* The next response header is awaited right behind it */
+	payload_op = g_last_recv_op - 1;
+	CU_ASSERT(g_ucp_ops[payload_op].datatype == ucp_dt_make_iov());
+	poll_thread();
+	CU_ASSERT(g_io_completed == 0);
+	ut_stream_push(payload, sizeof(payload));
+	ut_ucp_complete(payload_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(memcmp(buf, payload, sizeof(buf)) == 0);
+
+	/* The response does not match the command */
+	g_io_completed = 0;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	ut_server_rsp(g_sent_cmd.id, 0, NULL, UT_BLOCK_SIZE);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	CU_ASSERT(ch->error == -EPROTO);
+	poll_thread();
+	CU_ASSERT(ch->failed);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+
+	free(bdev_io);
+	ut_put_channel();
+	ut_delete_disk(bdev);
+}
+
+static void
+test_io_rma(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_io *bdev_io;
+	uint8_t buf[4 * UT_BLOCK_SIZE];
+	struct iovec iovs[2] = {
+		{ .iov_base = buf, .iov_len = 1024 },
+		{ .iov_base = buf + 1024, .iov_len = 1024 },
+	};
+
+	ut_reset();
+	bdev = ut_create_disk(UT_BLOCK_SIZE);
+	ut_connect_channel(bdev);
+
+	/* SPDK memory is described with the rkey of its registration */
+	bdev_io = ut_alloc_io(bdev, SPDK_BDEV_IO_TYPE_READ, iovs, 1, 0, 2);
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	CU_ASSERT(g_sent_cmd.flags == BDEV_UCX_CMD_FLAG_RMA);
+	CU_ASSERT(g_sent_cmd.remote_addr == (uintptr_t)buf);
+	CU_ASSERT(g_sent_cmd.rkey_length == UT_RKEY_LEN);
+	CU_ASSERT(g_sent_count == 2);
+	ut_server_rsp(g_sent_cmd.id, 0, NULL, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_rkey_released == 0);
+
+	/* Other memory is registered for the I/O only */
+	g_io_completed = 0;
+	g_translation_rc = -EINVAL;
+	bdev_io->type = SPDK_BDEV_IO_TYPE_WRITE;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_WRITE);
+	CU_ASSERT(g_sent_cmd.flags == BDEV_UCX_CMD_FLAG_RMA);
+	CU_ASSERT(g_sent_cmd.rkey_length == UT_RKEY_LEN / 2);
+	CU_ASSERT(g_sent_count == 2);
+	ut_server_rsp(g_sent_cmd.id, 0, NULL, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_rkey_released == 1);
+	CU_ASSERT(g_mem_unmapped == 1);
+
+	/* Several buffers go through the stream */
+	g_io_completed = 0;
+	bdev_io->u.bdev.iovcnt = 2;
+	bdev_io->u.bdev.num_blocks = 4;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	CU_ASSERT(g_sent_cmd.flags == 0);
+	CU_ASSERT(g_sent_count == 3);
+	ut_server_rsp(g_sent_cmd.id, 0, NULL, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	free(bdev_io);
+	ut_put_channel();
+	ut_delete_disk(bdev);
+}
+
+static void
+test_io_queued(void)
+{
+	struct spdk_bdev *bdev;
+	struct bdev_ucx_io_channel *ch;
+	struct spdk_bdev_io *bdev_io;
+	uint8_t buf[UT_BLOCK_SIZE];
+	struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+
+	ut_reset();
+	bdev = ut_create_disk(-1);
+	ch = ut_get_channel(bdev);
+
+	/* I/O waits for the answer to the INFO of the channel */
+	bdev_io = ut_alloc_io(bdev, SPDK_BDEV_IO_TYPE_WRITE, &iov, 1, 1, 1);
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_INFO);
+	CU_ASSERT(!TAILQ_EMPTY(&ch->queued_ios));
+	poll_thread();
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_INFO);
+
+	ut_server_info(0, UT_BLOCK_SIZE);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	CU_ASSERT(ch->connected);
+	poll_thread();
+	CU_ASSERT(TAILQ_EMPTY(&ch->queued_ios));
+	CU_ASSERT(g_sent_cmd.opcode == BDEV_UCX_OP_WRITE);
+	CU_ASSERT(g_sent_cmd.offset == UT_BLOCK_SIZE);
+	ut_server_rsp(g_sent_cmd.id, 0, NULL, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	free(bdev_io);
+	ut_put_channel();
+	ut_delete_disk(bdev);
+
+	/* The server no longer has the geometry the bdev was created with */
+	ut_reset();
+	bdev = ut_create_disk(-1);
+	ch = ut_get_channel(bdev);
+	bdev_io = ut_alloc_io(bdev, SPDK_BDEV_IO_TYPE_WRITE, &iov, 1, 1, 1);
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	ut_server_info(0, 4096);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	CU_ASSERT(ch->error == -ENODEV);
+	poll_thread();
+	CU_ASSERT(ch->failed);
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+
+	free(bdev_io);
+	ut_put_channel();
+	ut_delete_disk(bdev);
+}
+
+static void
+test_ch_fail(void)
+{
+	struct spdk_bdev *bdev;
+	struct bdev_ucx_io_channel *ch;
+	struct spdk_bdev_io *bdev_io;
+	uint8_t buf[UT_BLOCK_SIZE];
+	struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+
+	ut_reset();
+	bdev = ut_create_disk(-1);
+	ch = ut_connect_channel(bdev);
+	bdev_io = ut_alloc_io(bdev, SPDK_BDEV_IO_TYPE_WRITE, &iov, 1, 0, 1);
+
+	/* The endpoint reports the peer is gone */
+	g_send_status = UCS_INPROGRESS;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	g_send_status = UCS_OK;
+	g_ep_err_cb(g_ep_err_arg, ch->ep, UCS_ERR_CONNECTION_RESET);
+	CU_ASSERT(ch->error == -ECONNRESET);
+	poll_thread();
+	CU_ASSERT(ch->failed);
+	CU_ASSERT(ch->ep == NULL);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	/* The send and the header receive were abandoned */
+	CU_ASSERT(g_ucp_reqs_freed == g_ucp_reqs_posted);
+
+	/* New I/O fails right away */
+	g_io_completed = 0;
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+
+	ut_put_channel();
+	ut_delete_disk(bdev);
+
+	/* Responses stop coming */
+	ut_reset();
+	bdev = ut_create_disk(-1);
+	ch = ut_connect_channel(bdev);
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 0);
+	spdk_delay_us(BDEV_UCX_IO_TIMEOUT_US);
+	poll_thread();
+	CU_ASSERT(ch->failed);
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+
+	ut_put_channel();
+	ut_delete_disk(bdev);
+
+	/* The response names a command that is not outstanding */
+	ut_reset();
+	bdev = ut_create_disk(-1);
+	ch = ut_connect_channel(bdev);
+	bdev_ucx_submit_request(g_ch_io, bdev_io);
+	ut_server_rsp(g_sent_cmd.id + (1ULL << 32), 0, NULL, 0);
+	ut_ucp_complete(g_last_recv_op, UCS_OK);
+	CU_ASSERT(ch->error == -EPROTO);
+	poll_thread();
+	CU_ASSERT(g_io_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+
+	free(bdev_io);
+	ut_put_channel();
+	ut_delete_disk(bdev);
+
+	/* An idle channel does not time out */
+	ut_reset();
+	bdev = ut_create_disk(-1);
+	ch = ut_connect_channel(bdev);
+	spdk_delay_us(BDEV_UCX_IO_TIMEOUT_US);
+	poll_thread();
+	CU_ASSERT(!ch->failed);
+
+	ut_put_channel();
+	ut_delete_disk(bdev);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdev_ucx", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_rpc_create_delete);
+	CU_ADD_TEST(suite, test_rpc_create_errors);
+	CU_ADD_TEST(suite, test_io_write);
+	CU_ADD_TEST(suite, test_io_read);
+	CU_ADD_TEST(suite, test_io_rma);
+	CU_ADD_TEST(suite, test_io_queued);
+	CU_ADD_TEST(suite, test_ch_fail);
+
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+
+	bdev_ucx_finish();
+	ut_reset();
+
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,703 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_cunit.h"
+
+#include "common/lib/test_env.c"
+
+#include "nvme/nvme_ucx.c"
+
+#define UT_QUEUE_SIZE 4
+#define UT_IOCCSZ_BYTES 4096
+#define UT_RKEY_LEN 32
+#define UT_UCP_REQS 8
+
+SPDK_LOG_REGISTER_COMPONENT("nvme", SPDK_LOG_NVME);
+
+DEFINE_STUB(nvme_request_check_timeout, int, (struct nvme_request *req, uint16_t cid,
+		struct spdk_nvme_ctrlr_process *active_proc, uint64_t now_tick), 0);
+DEFINE_STUB_V(nvme_ctrlr_destruct_finish, (struct spdk_nvme_ctrlr *ctrlr));
+DEFINE_STUB(nvme_ctrlr_construct, int, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB_V(nvme_ctrlr_destruct, (struct spdk_nvme_ctrlr *ctrlr));
+DEFINE_STUB_V(nvme_ctrlr_init_cap, (struct spdk_nvme_ctrlr *ctrlr,
+				    const union spdk_nvme_cap_register *cap,
+				    const union spdk_nvme_vs_register *vs));
+DEFINE_STUB(nvme_ctrlr_get_vs, int, (struct spdk_nvme_ctrlr *ctrlr,
+				     union spdk_nvme_vs_register *vs), 0);
+DEFINE_STUB(nvme_ctrlr_get_cap, int, (struct spdk_nvme_ctrlr *ctrlr,
+				      union spdk_nvme_cap_register *cap), 0);
+DEFINE_STUB_V(nvme_qpair_deinit, (struct spdk_nvme_qpair *qpair));
+DEFINE_STUB_V(spdk_nvme_transport_register, (const struct spdk_nvme_transport_ops *ops));
+DEFINE_STUB(nvme_transport_ctrlr_connect_qpair, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair), 0);
+DEFINE_STUB(nvme_ctrlr_get_current_process, struct spdk_nvme_ctrlr_process *,
+	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB(nvme_ctrlr_add_process, int, (struct spdk_nvme_ctrlr *ctrlr, void *devhandle), 0);
+DEFINE_STUB(spdk_nvme_qpair_process_completions, int32_t, (struct spdk_nvme_qpair *qpair,
+		uint32_t max_completions), 0);
+DEFINE_STUB_V(nvme_ctrlr_disconnect_qpair, (struct spdk_nvme_qpair *qpair));
+DEFINE_STUB(nvme_fabric_ctrlr_set_reg_4, int, (struct spdk_nvme_ctrlr *ctrlr, uint32_t offset,
+		uint32_t value), 0);
+DEFINE_STUB(nvme_fabric_ctrlr_set_reg_8, int, (struct spdk_nvme_ctrlr *ctrlr, uint32_t offset,
+		uint64_t value), 0);
+DEFINE_STUB(nvme_fabric_ctrlr_get_reg_4, int, (struct spdk_nvme_ctrlr *ctrlr, uint32_t offset,
+		uint32_t *value), 0);
+DEFINE_STUB(nvme_fabric_ctrlr_get_reg_8, int, (struct spdk_nvme_ctrlr *ctrlr, uint32_t offset,
+		uint64_t *value), 0);
+DEFINE_STUB(nvme_fabric_ctrlr_scan, int, (struct spdk_nvme_probe_ctx *probe_ctx,
+		bool direct_connect), 0);
+DEFINE_STUB(nvme_fabric_qpair_connect, int, (struct spdk_nvme_qpair *qpair, uint32_t num_entries),
+	    0);
+DEFINE_STUB_V(nvme_transport_ctrlr_disconnect_qpair, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair));
+DEFINE_STUB(nvme_poll_group_disconnect_qpair, int, (struct spdk_nvme_qpair *qpair), 0);
+
+DEFINE_STUB_V(ucp_cleanup, (ucp_context_h context_p));
+DEFINE_STUB(ucp_worker_create, ucs_status_t, (ucp_context_h context,
+		const ucp_worker_params_t *params, ucp_worker_h *worker_p), UCS_OK);
+DEFINE_STUB_V(ucp_worker_destroy, (ucp_worker_h worker));
+DEFINE_STUB(ucp_worker_progress, unsigned, (ucp_worker_h worker), 0);
+DEFINE_STUB(ucp_worker_set_am_handler, ucs_status_t, (ucp_worker_h worker, uint16_t id,
+		ucp_am_callback_t cb, void *arg, uint32_t flags), UCS_OK);
+DEFINE_STUB(ucp_request_check_status, ucs_status_t, (void *request), UCS_OK);
+DEFINE_STUB(ucs_status_string, const char *, (ucs_status_t status), "");
+DEFINE_STUB(ucp_mem_map, ucs_status_t, (ucp_context_h context, const ucp_mem_map_params_t *params,
+					ucp_mem_h *memh_p), UCS_OK);
+DEFINE_STUB(ucp_mem_unmap, ucs_status_t, (ucp_context_h context, ucp_mem_h memh), UCS_OK);
+DEFINE_STUB_V(ucp_rkey_buffer_release, (void *rkey_buffer));
+
+/* Outcome of the next non-blocking UCP operation: done in place, in flight or failed */
+static ucs_status_t g_ucp_op_status = UCS_INPROGRESS;
+static struct nvme_ucx_ucp_req g_ucp_reqs[UT_UCP_REQS];
+static int g_ucp_reqs_posted;
+static int g_ucp_reqs_freed;
+static int g_am_count;
+static uint16_t g_am_id;
+static ucs_status_ptr_t g_close_ptr;
+static unsigned g_close_mode;
+static ucs_status_t g_ucp_init_status = UCS_OK;
+static int g_translation_rc;
+static uint8_t g_rkey_buf[UT_RKEY_LEN];
+
+static void
+ut_ucp_reset(void)
+{
+	memset(g_ucp_reqs, 0, sizeof(g_ucp_reqs));
+	g_ucp_op_status = UCS_INPROGRESS;
+	g_ucp_reqs_posted = 0;
+	g_ucp_reqs_freed = 0;
+	g_am_count = 0;
+	g_am_id = 0;
+	g_close_ptr = NULL;
+	g_close_mode = 0;
+	g_translation_rc = 0;
+}
+
+ucs_status_t
+ucp_init_version(unsigned api_major_version, unsigned api_minor_version,
+		 const ucp_params_t *params, const ucp_config_t *config,
+		 ucp_context_h *context_p)
+{
+	if (g_ucp_init_status == UCS_OK) {
+		*context_p = (ucp_context_h)0xC0;
+	}
+	return g_ucp_init_status;
+}
+
+struct spdk_ucx_mem_map *
+spdk_ucx_create_mem_map(ucp_context_h context)
+{
+	return (struct spdk_ucx_mem_map *)0xAA;
+}
+
+int
+spdk_ucx_get_translation(struct spdk_ucx_mem_map *map, void *address, size_t length,
+			 struct spdk_ucx_memory_translation *translation)
+{
+	if (g_translation_rc != 0) {
+		return g_translation_rc;
+	}
+
+	translation->memh = (ucp_mem_h)0xBB;
+	translation->rkey_buf = g_rkey_buf;
+	translation->rkey_size = sizeof(g_rkey_buf);
+	return 0;
+}
+
+ucs_status_t
+ucp_rkey_pack(ucp_context_h context, ucp_mem_h memh, void **rkey_buffer_p, size_t *size_p)
+{
+	*rkey_buffer_p = g_rkey_buf;
+	*size_p = UT_RKEY_LEN / 2;
+	return UCS_OK;
+}
+
+ucs_status_t
+ucp_ep_create(ucp_worker_h worker, const ucp_ep_params_t *params, ucp_ep_h *ep_p)
+{
+	*ep_p = (ucp_ep_h)0xE1;
+	return UCS_OK;
+}
+
+ucs_status_ptr_t
+ucp_ep_close_nb(ucp_ep_h ep, unsigned mode)
+{
+	g_close_mode = mode;
+	return g_close_ptr;
+}
+
+ucs_status_ptr_t
+ucp_am_send_nb(ucp_ep_h ep, uint16_t id, const void *buffer, size_t count,
+	       ucp_datatype_t datatype, ucp_send_callback_t cb, unsigned flags)
+{
+	g_am_count++;
+	g_am_id = id;
+
+	if (g_ucp_op_status == UCS_OK) {
+		return NULL;
+	}
+
+	if (g_ucp_op_status != UCS_INPROGRESS) {
+		return UCS_STATUS_PTR(g_ucp_op_status);
+	}
+
+	SPDK_CU_ASSERT_FATAL(g_ucp_reqs_posted < UT_UCP_REQS);
+	return &g_ucp_reqs[g_ucp_reqs_posted++];
+}
+
+void
+ucp_request_free(void *request)
+{
+	g_ucp_reqs_freed++;
+}
+
+int
+nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id, struct spdk_nvme_ctrlr *ctrlr,
+		enum spdk_nvme_qprio qprio, uint32_t num_requests)
+{
+	qpair->id = id;
+	qpair->ctrlr = ctrlr;
+	qpair->trtype = SPDK_NVME_TRANSPORT_CUSTOM;
+	TAILQ_INIT(&qpair->err_cmd_head);
+	STAILQ_INIT(&qpair->free_req);
+	return 0;
+}
+
+static struct spdk_nvme_cpl g_ut_cpl;
+static int g_ut_cb_count;
+
+static void
+ut_req_cb(void *cb_arg, const struct spdk_nvme_cpl *cpl)
+{
+	g_ut_cpl = *cpl;
+	g_ut_cb_count++;
+}
+
+static void
+ut_req_init(struct nvme_request *req, struct spdk_nvme_qpair *qpair, uint8_t opc, void *buf,
+	    uint32_t size)
+{
+	memset(req, 0, sizeof(*req));
+	req->qpair = qpair;
+	req->cmd.opc = opc;
+	req->payload = NVME_PAYLOAD_CONTIG(buf, NULL);
+	req->payload_size = size;
+	req->cb_fn = ut_req_cb;
+}
+
+static struct nvme_ucx_qpair *
+ut_qpair_create(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid)
+{
+	struct spdk_nvme_qpair *qpair;
+	int rc;
+
+	qpair = nvme_ucx_ctrlr_create_qpair(ctrlr, qid, UT_QUEUE_SIZE, SPDK_NVME_QPRIO_URGENT,
+					    UT_QUEUE_SIZE);
+	SPDK_CU_ASSERT_FATAL(qpair != NULL);
+
+	rc = nvme_ucx_ctrlr_connect_qpair(ctrlr, qpair);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	return nvme_ucx_qpair(qpair);
+}
+
+static void
+ut_ctrlr_init(struct spdk_nvme_ctrlr *ctrlr)
+{
+	memset(ctrlr, 0, sizeof(*ctrlr));
+	ctrlr->trid.trtype = SPDK_NVME_TRANSPORT_CUSTOM;
+	ctrlr->trid.adrfam = SPDK_NVMF_ADRFAM_IPV4;
+	snprintf(ctrlr->trid.traddr, sizeof(ctrlr->trid.traddr), "127.0.0.1");
+	snprintf(ctrlr->trid.trsvcid, sizeof(ctrlr->trid.trsvcid), "4420");
+	ctrlr->ioccsz_bytes = UT_IOCCSZ_BYTES;
+
+	ut_ucp_reset();
+}
+
+static void
+test_nvme_ucx_ctrlr_create_qpair(void)
+{
+	struct spdk_nvme_ctrlr ctrlr;
+	struct spdk_nvme_qpair *qpair;
+	struct nvme_ucx_qpair *tqpair;
+	int rc;
+
+	ut_ctrlr_init(&ctrlr);
+
+	/* UCP fails to initialize */
+	g_ucp_init_status = UCS_ERR_NO_DEVICE;
+	qpair = nvme_ucx_ctrlr_create_qpair(&ctrlr, 1, UT_QUEUE_SIZE, SPDK_NVME_QPRIO_URGENT,
+					    UT_QUEUE_SIZE);
+	CU_ASSERT(qpair == NULL);
+	CU_ASSERT(g_ucx_context == NULL);
+	g_ucp_init_status = UCS_OK;
+
+	/* The worker of the queue pair cannot be created */
+	MOCK_SET(ucp_worker_create, UCS_ERR_NO_MEMORY);
+	qpair = nvme_ucx_ctrlr_create_qpair(&ctrlr, 1, UT_QUEUE_SIZE, SPDK_NVME_QPRIO_URGENT,
+					    UT_QUEUE_SIZE);
+	CU_ASSERT(qpair == NULL);
+	CU_ASSERT(g_ucx_context != NULL);
+	CU_ASSERT(g_ucx_mem_map != NULL);
+	MOCK_SET(ucp_worker_create, UCS_OK);
+
+	/* The handlers cannot be set */
+	MOCK_SET(ucp_worker_set_am_handler, UCS_ERR_INVALID_PARAM);
+	qpair = nvme_ucx_ctrlr_create_qpair(&ctrlr, 1, UT_QUEUE_SIZE, SPDK_NVME_QPRIO_URGENT,
+					    UT_QUEUE_SIZE);
+	CU_ASSERT(qpair == NULL);
+	MOCK_SET(ucp_worker_set_am_handler, UCS_OK);
+
+	qpair = nvme_ucx_ctrlr_create_qpair(&ctrlr, 1, UT_QUEUE_SIZE, SPDK_NVME_QPRIO_URGENT,
+					    UT_QUEUE_SIZE);
+	SPDK_CU_ASSERT_FATAL(qpair != NULL);
+	tqpair = nvme_ucx_qpair(qpair);
+	CU_ASSERT(tqpair->num_entries == UT_QUEUE_SIZE);
+	CU_ASSERT(tqpair->ucx_reqs[UT_QUEUE_SIZE - 1].cid == UT_QUEUE_SIZE - 1);
+	CU_ASSERT(tqpair->ep == NULL);
+
+	/* Unsupported address family */
+	ctrlr.trid.adrfam = SPDK_NVMF_ADRFAM_IB;
+	rc = nvme_ucx_ctrlr_connect_qpair(&ctrlr, qpair);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(tqpair->ep == NULL);
+
+	ctrlr.trid.adrfam = SPDK_NVMF_ADRFAM_IPV4;
+	tqpair->failed = true;
+	rc = nvme_ucx_ctrlr_connect_qpair(&ctrlr, qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair->ep != NULL);
+	CU_ASSERT(tqpair->failed == false);
+
+	/* The target terminates the queue pair */
+	CU_ASSERT(nvme_ucx_term_handler(tqpair, NULL, 0, tqpair->ep, 0) == UCS_OK);
+	CU_ASSERT(tqpair->peer_term == true);
+	CU_ASSERT(tqpair->failed == true);
+
+	/* Endpoint failure */
+	tqpair->failed = false;
+	nvme_ucx_err_cb(tqpair, tqpair->ep, UCS_ERR_ENDPOINT_TIMEOUT);
+	CU_ASSERT(tqpair->failed == true);
+
+	CU_ASSERT(nvme_ucx_ctrlr_delete_io_qpair(&ctrlr, qpair) == 0);
+}
+
+static void
+ut_sgl_reset(void *cb_arg, uint32_t offset)
+{
+}
+
+static uint32_t g_sge_len;
+
+static int
+ut_sgl_next_sge(void *cb_arg, void **address, uint32_t *length)
+{
+	*address = cb_arg;
+	*length = g_sge_len;
+	return 0;
+}
+
+static void
+test_nvme_ucx_req_init(void)
+{
+	struct spdk_nvme_ctrlr ctrlr;
+	struct nvme_ucx_qpair *tqpair, *admin_tqpair;
+	struct nvme_ucx_req *ucx_req;
+	struct nvme_request req;
+	struct spdk_nvme_sgl_descriptor *sgl = &req.cmd.dptr.sgl1;
+	static uint8_t buf[UT_IOCCSZ_BYTES * 4];
+	int rc;
+
+	ut_ctrlr_init(&ctrlr);
+	tqpair = ut_qpair_create(&ctrlr, 1);
+
+	/* Write of in-capsule size */
+	ucx_req = nvme_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	ut_req_init(&req, &tqpair->qpair, SPDK_NVME_OPC_WRITE, buf, UT_IOCCSZ_BYTES);
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(req.cmd.cid == ucx_req->cid);
+	CU_ASSERT(req.cmd.psdt == SPDK_NVME_PSDT_SGL_MPTR_CONTIG);
+	CU_ASSERT(sgl->unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(sgl->unkeyed.subtype == SPDK_NVME_SGL_SUBTYPE_OFFSET);
+	CU_ASSERT(sgl->unkeyed.length == UT_IOCCSZ_BYTES);
+	CU_ASSERT(sgl->address == 0);
+	CU_ASSERT(ucx_req->iovcnt == 2);
+	CU_ASSERT(ucx_req->iov[0].buffer == &ucx_req->capsule);
+	CU_ASSERT(ucx_req->iov[1].buffer == buf);
+	CU_ASSERT(ucx_req->iov[1].length == UT_IOCCSZ_BYTES);
+	CU_ASSERT(ucx_req->capsule.rkey_len == 0);
+	CU_ASSERT(memcmp(&ucx_req->capsule.ccsqe, &req.cmd, sizeof(req.cmd)) == 0);
+	TAILQ_REMOVE(&tqpair->outstanding_reqs, ucx_req, link);
+	nvme_ucx_req_put(tqpair, ucx_req);
+
+	/* Larger writes are described by a keyed SGL, SPDK memory is already mapped */
+	ucx_req = nvme_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	ut_req_init(&req, &tqpair->qpair, SPDK_NVME_OPC_WRITE, buf, UT_IOCCSZ_BYTES + 512);
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sgl->keyed.type == SPDK_NVME_SGL_TYPE_KEYED_DATA_BLOCK);
+	CU_ASSERT(sgl->keyed.subtype == SPDK_NVME_SGL_SUBTYPE_ADDRESS);
+	CU_ASSERT(sgl->keyed.length == UT_IOCCSZ_BYTES + 512);
+	CU_ASSERT(sgl->address == (uint64_t)buf);
+	CU_ASSERT(ucx_req->iovcnt == 2);
+	CU_ASSERT(ucx_req->iov[1].buffer == g_rkey_buf);
+	CU_ASSERT(ucx_req->iov[1].length == UT_RKEY_LEN);
+	CU_ASSERT(ucx_req->capsule.rkey_len == UT_RKEY_LEN);
+	CU_ASSERT(ucx_req->memh == NULL);
+	TAILQ_REMOVE(&tqpair->outstanding_reqs, ucx_req, link);
+	nvme_ucx_req_put(tqpair, ucx_req);
+
+	/* Reads are always keyed, other memory is mapped for the request */
+	ucx_req = nvme_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	ut_req_init(&req, &tqpair->qpair, SPDK_NVME_OPC_READ, buf, 512);
+	g_translation_rc = -EINVAL;
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sgl->keyed.type == SPDK_NVME_SGL_TYPE_KEYED_DATA_BLOCK);
+	CU_ASSERT(sgl->keyed.length == 512);
+	CU_ASSERT(ucx_req->iov[1].buffer == ucx_req->packed_rkey);
+	CU_ASSERT(ucx_req->iov[1].length == UT_RKEY_LEN / 2);
+	CU_ASSERT(ucx_req->capsule.rkey_len == UT_RKEY_LEN / 2);
+	TAILQ_REMOVE(&tqpair->outstanding_reqs, ucx_req, link);
+	nvme_ucx_req_put(tqpair, ucx_req);
+	CU_ASSERT(ucx_req->memh == NULL);
+
+	/* The buffer cannot be mapped */
+	ucx_req = nvme_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	MOCK_SET(ucp_mem_map, UCS_ERR_NO_MEMORY);
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == -EIO);
+	CU_ASSERT(ucx_req->memh == NULL);
+	MOCK_SET(ucp_mem_map, UCS_OK);
+	g_translation_rc = 0;
+	TAILQ_REMOVE(&tqpair->outstanding_reqs, ucx_req, link);
+	nvme_ucx_req_put(tqpair, ucx_req);
+
+	/* No payload */
+	ucx_req = nvme_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	ut_req_init(&req, &tqpair->qpair, SPDK_NVME_OPC_FLUSH, NULL, 0);
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sgl->unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(sgl->unkeyed.length == 0);
+	CU_ASSERT(ucx_req->iovcnt == 1);
+
+	/* An SGL payload has to fit into a single SGE */
+	ut_req_init(&req, &tqpair->qpair, SPDK_NVME_OPC_WRITE, NULL, 512);
+	req.payload = NVME_PAYLOAD_SGL(ut_sgl_reset, ut_sgl_next_sge, buf, NULL);
+	g_sge_len = 256;
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == -EINVAL);
+
+	g_sge_len = 512;
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ucx_req->iov[1].buffer == buf);
+	CU_ASSERT(ucx_req->iov[1].length == 512);
+	TAILQ_REMOVE(&tqpair->outstanding_reqs, ucx_req, link);
+	nvme_ucx_req_put(tqpair, ucx_req);
+
+	/* Admin and fabrics commands carry at most 8 KiB in the capsule */
+	ctrlr.ioccsz_bytes = NVME_UCX_IN_CAPSULE_DATA_MAX_SIZE * 2;
+	admin_tqpair = ut_qpair_create(&ctrlr, 0);
+	ucx_req = nvme_ucx_req_get(admin_tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	ut_req_init(&req, &admin_tqpair->qpair, SPDK_NVME_OPC_SET_FEATURES, buf,
+		    NVME_UCX_IN_CAPSULE_DATA_MAX_SIZE + 512);
+	rc = nvme_ucx_req_init(admin_tqpair, &req, ucx_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sgl->keyed.type == SPDK_NVME_SGL_TYPE_KEYED_DATA_BLOCK);
+	TAILQ_REMOVE(&admin_tqpair->outstanding_reqs, ucx_req, link);
+	nvme_ucx_req_put(admin_tqpair, ucx_req);
+
+	/* The same size fits into the capsule of an I/O queue */
+	ucx_req = nvme_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	ut_req_init(&req, &tqpair->qpair, SPDK_NVME_OPC_WRITE, buf,
+		    NVME_UCX_IN_CAPSULE_DATA_MAX_SIZE + 512);
+	rc = nvme_ucx_req_init(tqpair, &req, ucx_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sgl->unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	TAILQ_REMOVE(&tqpair->outstanding_reqs, ucx_req, link);
+	nvme_ucx_req_put(tqpair, ucx_req);
+
+	nvme_ucx_ctrlr_delete_io_qpair(&ctrlr, &admin_tqpair->qpair);
+	nvme_ucx_ctrlr_delete_io_qpair(&ctrlr, &tqpair->qpair);
+}
+
+static void
+test_nvme_ucx_qpair_submit_request(void)
+{
+	struct spdk_nvme_ctrlr ctrlr;
+	struct nvme_ucx_qpair *tqpair;
+	struct nvme_ucx_req *ucx_req;
+	struct nvme_request req[UT_QUEUE_SIZE + 1];
+	struct spdk_nvme_cpl rsp = {};
+	static uint8_t buf[512];
+	int rc, i;
+
+	ut_ctrlr_init(&ctrlr);
+	tqpair = ut_qpair_create(&ctrlr, 1);
+	ut_req_init(&req[0], &tqpair->qpair, SPDK_NVME_OPC_WRITE, buf, sizeof(buf));
+
+	/* Not connected, or failed */
+	tqpair->ep = NULL;
+	CU_ASSERT(nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[0]) == -ENXIO);
+	CU_ASSERT(nvme_ucx_qpair_process_completions(&tqpair->qpair, 0) == -ENXIO);
+	tqpair->ep = (ucp_ep_h)0xE1;
+	tqpair->failed = true;
+	CU_ASSERT(nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[0]) == -ENXIO);
+	tqpair->failed = false;
+
+	/* The request completes once both its send and its response are done */
+	rc = nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[0]);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_am_count == 1);
+	CU_ASSERT(g_am_id == NVME_UCX_AM_ID_CAPSULE_CMD);
+	ucx_req = TAILQ_FIRST(&tqpair->outstanding_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	CU_ASSERT(ucx_req->req == &req[0]);
+	CU_ASSERT(ucx_req->state == NVME_UCX_REQ_ACTIVE);
+	CU_ASSERT(ucx_req->pending == 2);
+
+	rsp.cid = ucx_req->cid;
+	rsp.status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+	CU_ASSERT(nvme_ucx_capsule_resp_handler(tqpair, &rsp, sizeof(rsp), NULL, 0) == UCS_OK);
+	CU_ASSERT(ucx_req->pending == 1);
+	CU_ASSERT(nvme_ucx_qpair_process_completions(&tqpair->qpair, 0) == 0);
+	CU_ASSERT(g_ut_cb_count == 0);
+
+	nvme_ucx_ucp_req_cb(&g_ucp_reqs[0], UCS_OK);
+	CU_ASSERT(ucx_req->state == NVME_UCX_REQ_COMPLETED);
+	CU_ASSERT(g_ucp_reqs_freed == 1);
+	CU_ASSERT(g_ut_cb_count == 0);
+	CU_ASSERT(nvme_ucx_qpair_process_completions(&tqpair->qpair, 0) == 1);
+	CU_ASSERT(g_ut_cb_count == 1);
+	CU_ASSERT(g_ut_cpl.status.sc == SPDK_NVME_SC_LBA_OUT_OF_RANGE);
+	CU_ASSERT(ucx_req->state == NVME_UCX_REQ_FREE);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair->outstanding_reqs));
+	CU_ASSERT(STAILQ_FIRST(&tqpair->qpair.free_req) == &req[0]);
+
+	/* The send completes in place */
+	ut_ucp_reset();
+	g_ut_cb_count = 0;
+	g_ucp_op_status = UCS_OK;
+	ut_req_init(&req[0], &tqpair->qpair, SPDK_NVME_OPC_WRITE, buf, sizeof(buf));
+	rc = nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[0]);
+	CU_ASSERT(rc == 0);
+	ucx_req = TAILQ_FIRST(&tqpair->outstanding_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	CU_ASSERT(ucx_req->pending == 1);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair->ucp_reqs));
+	rsp.cid = ucx_req->cid;
+	rsp.status.sc = SPDK_NVME_SC_SUCCESS;
+	nvme_ucx_capsule_resp_handler(tqpair, &rsp, sizeof(rsp), NULL, 0);
+	CU_ASSERT(nvme_ucx_qpair_process_completions(&tqpair->qpair, 0) == 1);
+	CU_ASSERT(g_ut_cb_count == 1);
+	CU_ASSERT(g_ut_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+
+	/* The send fails */
+	g_ucp_op_status = UCS_ERR_NO_RESOURCE;
+	ut_req_init(&req[0], &tqpair->qpair, SPDK_NVME_OPC_WRITE, buf, sizeof(buf));
+	rc = nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[0]);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(tqpair->failed == true);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair->outstanding_reqs));
+	CU_ASSERT(tqpair->ucx_reqs[0].state == NVME_UCX_REQ_FREE);
+	CU_ASSERT(tqpair->ucx_reqs[0].pending == 0);
+	CU_ASSERT(nvme_ucx_qpair_process_completions(&tqpair->qpair, 0) == -ENXIO);
+	tqpair->failed = false;
+
+	/* More requests than the queue holds */
+	ut_ucp_reset();
+	for (i = 0; i < UT_QUEUE_SIZE; i++) {
+		ut_req_init(&req[i], &tqpair->qpair, SPDK_NVME_OPC_FLUSH, NULL, 0);
+		CU_ASSERT(nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[i]) == 0);
+	}
+	ut_req_init(&req[i], &tqpair->qpair, SPDK_NVME_OPC_FLUSH, NULL, 0);
+	CU_ASSERT(nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[i]) == -EAGAIN);
+
+	/* Malformed responses fail the queue pair */
+	CU_ASSERT(nvme_ucx_capsule_resp_handler(tqpair, &rsp, sizeof(rsp) - 1, NULL, 0) == UCS_OK);
+	CU_ASSERT(tqpair->failed == true);
+	tqpair->failed = false;
+
+	rsp.cid = UT_QUEUE_SIZE;
+	nvme_ucx_capsule_resp_handler(tqpair, &rsp, sizeof(rsp), NULL, 0);
+	CU_ASSERT(tqpair->failed == true);
+	tqpair->failed = false;
+
+	/* Responses only complete requests in flight */
+	ucx_req = TAILQ_FIRST(&tqpair->outstanding_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	CU_ASSERT(ucx_req->req == &req[0]);
+	rsp.cid = ucx_req->cid;
+	nvme_ucx_capsule_resp_handler(tqpair, &rsp, sizeof(rsp), NULL, 0);
+	CU_ASSERT(tqpair->failed == false);
+	nvme_ucx_ucp_req_cb(&g_ucp_reqs[0], UCS_OK);
+	CU_ASSERT(nvme_ucx_qpair_process_completions(&tqpair->qpair, 0) == 1);
+	CU_ASSERT(ucx_req->state == NVME_UCX_REQ_FREE);
+	nvme_ucx_capsule_resp_handler(tqpair, &rsp, sizeof(rsp), NULL, 0);
+	CU_ASSERT(tqpair->failed == true);
+
+	nvme_ucx_ctrlr_delete_io_qpair(&ctrlr, &tqpair->qpair);
+}
+
+static void
+test_nvme_ucx_ctrlr_disconnect_qpair(void)
+{
+	struct spdk_nvme_ctrlr ctrlr;
+	struct nvme_ucx_qpair *tqpair;
+	struct nvme_request req[2];
+	int close_req;
+
+	ut_ctrlr_init(&ctrlr);
+	g_ut_cb_count = 0;
+	tqpair = ut_qpair_create(&ctrlr, 1);
+
+	ut_req_init(&req[0], &tqpair->qpair, SPDK_NVME_OPC_FLUSH, NULL, 0);
+	CU_ASSERT(nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[0]) == 0);
+
+	/* The endpoint is flushed and the send in flight abandoned */
+	g_close_ptr = &close_req;
+	nvme_ucx_ctrlr_disconnect_qpair(&ctrlr, &tqpair->qpair);
+	CU_ASSERT(g_am_count == 2);
+	CU_ASSERT(g_am_id == NVME_UCX_AM_ID_TERM);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FLUSH);
+	CU_ASSERT(tqpair->ep == NULL);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair->ucp_reqs));
+	CU_ASSERT(g_ucp_reqs_freed == 3);
+	CU_ASSERT(g_ucp_reqs[0].tqpair == NULL);
+	CU_ASSERT(g_ucp_reqs[1].tqpair == NULL);
+
+	/* Its callback may still run */
+	nvme_ucx_ucp_req_cb(&g_ucp_reqs[0], UCS_ERR_CANCELED);
+	CU_ASSERT(g_ucp_reqs_freed == 3);
+
+	/* The request is aborted by the caller */
+	CU_ASSERT(g_ut_cb_count == 0);
+	nvme_ucx_qpair_abort_reqs(&tqpair->qpair, 1);
+	CU_ASSERT(g_ut_cb_count == 1);
+	CU_ASSERT(g_ut_cpl.status.sc == SPDK_NVME_SC_ABORTED_SQ_DELETION);
+	CU_ASSERT(g_ut_cpl.status.dnr == 1);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair->outstanding_reqs));
+	CU_ASSERT(tqpair->ucx_reqs[0].state == NVME_UCX_REQ_FREE);
+
+	/* A failed endpoint is closed without notice */
+	ut_ucp_reset();
+	CU_ASSERT(nvme_ucx_ctrlr_connect_qpair(&ctrlr, &tqpair->qpair) == 0);
+	tqpair->failed = true;
+	nvme_ucx_ctrlr_disconnect_qpair(&ctrlr, &tqpair->qpair);
+	CU_ASSERT(g_am_count == 0);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(tqpair->ep == NULL);
+
+	nvme_ucx_ctrlr_delete_io_qpair(&ctrlr, &tqpair->qpair);
+}
+
+static void
+test_nvme_ucx_admin_qpair_abort_aers(void)
+{
+	struct spdk_nvme_ctrlr ctrlr;
+	struct nvme_ucx_qpair *tqpair;
+	struct nvme_request req[2];
+
+	ut_ctrlr_init(&ctrlr);
+	g_ut_cb_count = 0;
+	tqpair = ut_qpair_create(&ctrlr, 0);
+
+	ut_req_init(&req[0], &tqpair->qpair, SPDK_NVME_OPC_ASYNC_EVENT_REQUEST, NULL, 0);
+	CU_ASSERT(nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[0]) == 0);
+	ut_req_init(&req[1], &tqpair->qpair, SPDK_NVME_OPC_KEEP_ALIVE, NULL, 0);
+	CU_ASSERT(nvme_ucx_qpair_submit_request(&tqpair->qpair, &req[1]) == 0);
+
+	nvme_ucx_admin_qpair_abort_aers(&tqpair->qpair);
+	CU_ASSERT(g_ut_cb_count == 1);
+	CU_ASSERT(g_ut_cpl.status.sc == SPDK_NVME_SC_ABORTED_SQ_DELETION);
+	CU_ASSERT(TAILQ_FIRST(&tqpair->outstanding_reqs) == &tqpair->ucx_reqs[1]);
+	CU_ASSERT(TAILQ_NEXT(&tqpair->ucx_reqs[1], link) == NULL);
+
+	nvme_ucx_qpair_abort_reqs(&tqpair->qpair, 0);
+	CU_ASSERT(g_ut_cb_count == 2);
+	nvme_ucx_ctrlr_delete_io_qpair(&ctrlr, &tqpair->qpair);
+}
+
+int main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("nvme_ucx", NULL, NULL);
+	CU_ADD_TEST(suite, test_nvme_ucx_ctrlr_create_qpair);
+	CU_ADD_TEST(suite, test_nvme_ucx_req_init);
+	CU_ADD_TEST(suite, test_nvme_ucx_qpair_submit_request);
+	CU_ADD_TEST(suite, test_nvme_ucx_ctrlr_disconnect_qpair);
+	CU_ADD_TEST(suite, test_nvme_ucx_admin_qpair_abort_aers);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+	return num_failures;
+}
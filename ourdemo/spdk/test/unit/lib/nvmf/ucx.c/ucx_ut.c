@@ -0,0 +1,780 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk/nvmf_spec.h"
+#include "spdk_cunit.h"
+
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+#include "nvmf/ucx.c"
+#include "nvmf/transport.c"
+
+#define UT_MAX_QUEUE_DEPTH 4
+#define UT_IN_CAPSULE_DATA_SIZE 1024
+#define UT_MAX_IO_SIZE 4096
+#define UT_IO_UNIT_SIZE 1024
+#define UT_RKEY_LEN 16
+#define UT_UCP_REQS 8
+
+SPDK_LOG_REGISTER_COMPONENT("nvmf", SPDK_LOG_NVMF)
+
+DEFINE_STUB_V(spdk_nvmf_ctrlr_data_init, (struct spdk_nvmf_transport_opts *opts,
+		struct spdk_nvmf_ctrlr_data *cdata));
+DEFINE_STUB_V(spdk_nvmf_request_exec, (struct spdk_nvmf_request *req));
+DEFINE_STUB(spdk_nvmf_request_complete, int, (struct spdk_nvmf_request *req), 0);
+DEFINE_STUB(spdk_nvme_transport_id_compare, int, (const struct spdk_nvme_transport_id *trid1,
+		const struct spdk_nvme_transport_id *trid2), 0);
+DEFINE_STUB_V(nvmf_ctrlr_abort_aer, (struct spdk_nvmf_ctrlr *ctrlr));
+DEFINE_STUB(spdk_nvmf_request_get_dif_ctx, bool, (struct spdk_nvmf_request *req,
+		struct spdk_dif_ctx *dif_ctx), false);
+DEFINE_STUB_V(spdk_nvme_trid_populate_transport, (struct spdk_nvme_transport_id *trid,
+		enum spdk_nvme_transport_type trtype));
+DEFINE_STUB_V(spdk_nvmf_tgt_new_qpair, (struct spdk_nvmf_tgt *tgt, struct spdk_nvmf_qpair *qpair));
+DEFINE_STUB(nvmf_ctrlr_abort_request, int, (struct spdk_nvmf_request *req), 0);
+DEFINE_STUB(spdk_nvmf_qpair_disconnect, int, (struct spdk_nvmf_qpair *qpair,
+		nvmf_qpair_disconnect_cb cb_fn, void *ctx), 0);
+DEFINE_STUB(spdk_nvme_transport_id_trtype_str, const char *,
+	    (enum spdk_nvme_transport_type trtype), NULL);
+DEFINE_STUB(spdk_nvme_transport_id_populate_trstring, int,
+	    (struct spdk_nvme_transport_id *trid, const char *trstring), 0);
+
+DEFINE_STUB(ucp_init_version, ucs_status_t, (unsigned api_major_version,
+		unsigned api_minor_version, const ucp_params_t *params,
+		const ucp_config_t *config, ucp_context_h *context_p), UCS_OK);
+DEFINE_STUB_V(ucp_cleanup, (ucp_context_h context_p));
+DEFINE_STUB(ucp_worker_create, ucs_status_t, (ucp_context_h context,
+		const ucp_worker_params_t *params, ucp_worker_h *worker_p), UCS_OK);
+DEFINE_STUB_V(ucp_worker_destroy, (ucp_worker_h worker));
+DEFINE_STUB(ucp_worker_progress, unsigned, (ucp_worker_h worker), 0);
+DEFINE_STUB(ucp_worker_set_am_handler, ucs_status_t, (ucp_worker_h worker, uint16_t id,
+		ucp_am_callback_t cb, void *arg, uint32_t flags), UCS_OK);
+DEFINE_STUB(ucp_listener_create, ucs_status_t, (ucp_worker_h worker,
+		const ucp_listener_params_t *params, ucp_listener_h *listener_p), UCS_OK);
+DEFINE_STUB_V(ucp_listener_destroy, (ucp_listener_h listener));
+DEFINE_STUB(ucp_listener_reject, ucs_status_t, (ucp_listener_h listener,
+		ucp_conn_request_h conn_request), UCS_OK);
+DEFINE_STUB(ucp_request_check_status, ucs_status_t, (void *request), UCS_OK);
+DEFINE_STUB_V(ucp_rkey_destroy, (ucp_rkey_h rkey));
+DEFINE_STUB(ucs_status_string, const char *, (ucs_status_t status), "");
+
+/* Outcome of the next non-blocking UCP operation: done in place, in flight or failed */
+static ucs_status_t g_ucp_op_status = UCS_INPROGRESS;
+static struct nvmf_ucx_request g_ucp_reqs[UT_UCP_REQS];
+static int g_ucp_reqs_posted;
+static int g_ucp_reqs_freed;
+static int g_get_count;
+static int g_put_count;
+static int g_flush_count;
+static int g_am_count;
+static uint16_t g_am_id;
+static ucs_status_t g_put_status = UCS_OK;
+static ucs_status_t g_rkey_unpack_status = UCS_OK;
+static int g_rkey_unpack_count;
+static ucs_status_ptr_t g_close_ptr;
+static unsigned g_close_mode;
+
+static ucs_status_ptr_t
+ut_ucp_op(void)
+{
+	if (g_ucp_op_status == UCS_OK) {
+		return NULL;
+	}
+
+	if (g_ucp_op_status != UCS_INPROGRESS) {
+		return UCS_STATUS_PTR(g_ucp_op_status);
+	}
+
+	SPDK_CU_ASSERT_FATAL(g_ucp_reqs_posted < UT_UCP_REQS);
+	return &g_ucp_reqs[g_ucp_reqs_posted++];
+}
+
+static void
+ut_ucp_reset(void)
+{
+	memset(g_ucp_reqs, 0, sizeof(g_ucp_reqs));
+	g_ucp_op_status = UCS_INPROGRESS;
+	g_ucp_reqs_posted = 0;
+	g_ucp_reqs_freed = 0;
+	g_get_count = 0;
+	g_put_count = 0;
+	g_flush_count = 0;
+	g_am_count = 0;
+	g_am_id = 0;
+	g_put_status = UCS_OK;
+	g_rkey_unpack_status = UCS_OK;
+	g_rkey_unpack_count = 0;
+	g_close_ptr = NULL;
+	g_close_mode = 0;
+}
+
+ucs_status_t
+ucp_ep_create(ucp_worker_h worker, const ucp_ep_params_t *params, ucp_ep_h *ep_p)
+{
+	*ep_p = (ucp_ep_h)0xE1;
+	return UCS_OK;
+}
+
+ucs_status_ptr_t
+ucp_ep_close_nb(ucp_ep_h ep, unsigned mode)
+{
+	g_close_mode = mode;
+	return g_close_ptr;
+}
+
+ucs_status_t
+ucp_ep_rkey_unpack(ucp_ep_h ep, const void *rkey_buffer, ucp_rkey_h *rkey_p)
+{
+	g_rkey_unpack_count++;
+	if (g_rkey_unpack_status != UCS_OK) {
+		return g_rkey_unpack_status;
+	}
+
+	*rkey_p = (ucp_rkey_h)0xAB;
+	return UCS_OK;
+}
+
+ucs_status_ptr_t
+ucp_get_nb(ucp_ep_h ep, void *buffer, size_t length, uint64_t remote_addr, ucp_rkey_h rkey,
+	   ucp_send_callback_t cb)
+{
+	g_get_count++;
+	return ut_ucp_op();
+}
+
+ucs_status_t
+ucp_put_nbi(ucp_ep_h ep, const void *buffer, size_t length, uint64_t remote_addr,
+	    ucp_rkey_h rkey)
+{
+	g_put_count++;
+	return g_put_status;
+}
+
+ucs_status_ptr_t
+ucp_ep_flush_nb(ucp_ep_h ep, unsigned flags, ucp_send_callback_t cb)
+{
+	g_flush_count++;
+	return ut_ucp_op();
+}
+
+ucs_status_ptr_t
+ucp_am_send_nb(ucp_ep_h ep, uint16_t id, const void *buffer, size_t count,
+	       ucp_datatype_t datatype, ucp_send_callback_t cb, unsigned flags)
+{
+	g_am_count++;
+	g_am_id = id;
+	return ut_ucp_op();
+}
+
+void
+ucp_request_free(void *request)
+{
+	g_ucp_reqs_freed++;
+}
+
+static struct {
+	struct nvme_ucx_capsule_cmd	hdr;
+	uint8_t				payload[UT_IN_CAPSULE_DATA_SIZE * 2];
+} g_capsule;
+
+static void
+ut_transport_init(struct spdk_nvmf_ucx_transport *ttransport,
+		  struct spdk_nvmf_ucx_poll_group *tgroup)
+{
+	memset(ttransport, 0, sizeof(*ttransport));
+	nvmf_ucx_opts_init(&ttransport->transport.opts);
+	ttransport->transport.opts.max_queue_depth = UT_MAX_QUEUE_DEPTH;
+	ttransport->transport.opts.in_capsule_data_size = UT_IN_CAPSULE_DATA_SIZE;
+	ttransport->transport.opts.max_io_size = UT_MAX_IO_SIZE;
+	ttransport->transport.opts.io_unit_size = UT_IO_UNIT_SIZE;
+
+	memset(tgroup, 0, sizeof(*tgroup));
+	tgroup->group.transport = &ttransport->transport;
+	STAILQ_INIT(&tgroup->group.pending_buf_queue);
+	STAILQ_INIT(&tgroup->group.buf_cache);
+	TAILQ_INIT(&tgroup->qpairs);
+	TAILQ_INIT(&tgroup->closing);
+	TAILQ_INIT(&tgroup->ready_reqs);
+
+	ut_ucp_reset();
+}
+
+static struct spdk_nvmf_ucx_qpair *
+ut_qpair_create(struct spdk_nvmf_ucx_transport *ttransport,
+		struct spdk_nvmf_ucx_poll_group *tgroup)
+{
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	int rc;
+
+	tqpair = calloc(1, sizeof(*tqpair));
+	SPDK_CU_ASSERT_FATAL(tqpair != NULL);
+	tqpair->qpair.transport = &ttransport->transport;
+	tqpair->qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+	tqpair->qpair.sq_head_max = UT_MAX_QUEUE_DEPTH - 1;
+	tqpair->conn_request = (ucp_conn_request_h)0xC1;
+
+	rc = nvmf_ucx_poll_group_add(&tgroup->group, &tqpair->qpair);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	CU_ASSERT(tqpair->conn_request == NULL);
+	CU_ASSERT(tqpair->in_group == true);
+	CU_ASSERT(tqpair->state_cntr[UCX_REQUEST_STATE_FREE] == UT_MAX_QUEUE_DEPTH);
+
+	return tqpair;
+}
+
+static void
+ut_qpair_destroy(struct spdk_nvmf_ucx_poll_group *tgroup, struct spdk_nvmf_ucx_qpair *tqpair)
+{
+	nvmf_ucx_poll_group_remove(&tgroup->group, &tqpair->qpair);
+	CU_ASSERT(tqpair->in_group == false);
+	nvmf_ucx_qpair_destroy(tqpair);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup->ready_reqs));
+}
+
+/* Deliver a capsule carrying a command with the given SGL and a payload of payload_len bytes */
+static void
+ut_capsule_recv(struct spdk_nvmf_ucx_poll_group *tgroup, ucp_ep_h ep, uint8_t opc, uint16_t cid,
+		bool keyed, uint32_t data_len, uint32_t payload_len)
+{
+	struct spdk_nvme_sgl_descriptor *sgl = &g_capsule.hdr.ccsqe.dptr.sgl1;
+	ucs_status_t status;
+
+	memset(&g_capsule.hdr, 0, sizeof(g_capsule.hdr));
+	g_capsule.hdr.ccsqe.opc = opc;
+	g_capsule.hdr.ccsqe.cid = cid;
+	if (keyed) {
+		sgl->generic.type = SPDK_NVME_SGL_TYPE_KEYED_DATA_BLOCK;
+		sgl->keyed.subtype = SPDK_NVME_SGL_SUBTYPE_ADDRESS;
+		sgl->keyed.length = data_len;
+		sgl->address = 0xF000;
+		g_capsule.hdr.rkey_len = payload_len;
+	} else {
+		sgl->generic.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
+		sgl->unkeyed.subtype = SPDK_NVME_SGL_SUBTYPE_OFFSET;
+		sgl->unkeyed.length = data_len;
+	}
+	memset(g_capsule.payload, 0x5A, payload_len);
+
+	status = nvmf_ucx_capsule_cmd_handler(tgroup, &g_capsule,
+					      sizeof(g_capsule.hdr) + payload_len, ep, 0);
+	CU_ASSERT(status == UCS_OK);
+}
+
+static void
+test_nvmf_ucx_create(void)
+{
+	struct spdk_nvmf_transport_opts opts;
+	struct spdk_nvmf_transport *transport;
+
+	/* Default options */
+	nvmf_ucx_opts_init(&opts);
+	transport = nvmf_ucx_create(&opts);
+	SPDK_CU_ASSERT_FATAL(transport != NULL);
+	CU_ASSERT(transport->ops == &spdk_nvmf_transport_ucx);
+	CU_ASSERT(nvmf_ucx_destroy(transport) == 0);
+
+	/* I/O unit size larger than the max I/O size is clamped */
+	nvmf_ucx_opts_init(&opts);
+	opts.io_unit_size = opts.max_io_size * 2;
+	transport = nvmf_ucx_create(&opts);
+	SPDK_CU_ASSERT_FATAL(transport != NULL);
+	CU_ASSERT(opts.io_unit_size == opts.max_io_size);
+	nvmf_ucx_destroy(transport);
+
+	/* DIF insert/strip is not supported */
+	nvmf_ucx_opts_init(&opts);
+	opts.dif_insert_or_strip = true;
+	CU_ASSERT(nvmf_ucx_create(&opts) == NULL);
+
+	/* I/O unit too small for the max I/O size */
+	nvmf_ucx_opts_init(&opts);
+	opts.io_unit_size = opts.max_io_size / (SPDK_NVMF_MAX_SGL_ENTRIES + 1);
+	CU_ASSERT(nvmf_ucx_create(&opts) == NULL);
+
+	/* UCP fails to initialize */
+	nvmf_ucx_opts_init(&opts);
+	MOCK_SET(ucp_init_version, UCS_ERR_NO_DEVICE);
+	CU_ASSERT(nvmf_ucx_create(&opts) == NULL);
+	MOCK_SET(ucp_init_version, UCS_OK);
+
+	/* The listening worker cannot be created */
+	MOCK_SET(ucp_worker_create, UCS_ERR_NO_MEMORY);
+	CU_ASSERT(nvmf_ucx_create(&opts) == NULL);
+	MOCK_SET(ucp_worker_create, UCS_OK);
+}
+
+static void
+test_nvmf_ucx_capsule_cmd_handler(void)
+{
+	struct spdk_nvmf_ucx_transport ttransport;
+	struct spdk_nvmf_ucx_poll_group tgroup;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	struct spdk_nvmf_ucx_req *ucx_req;
+	ucs_status_t status;
+	int i;
+
+	ut_transport_init(&ttransport, &tgroup);
+	tqpair = ut_qpair_create(&ttransport, &tgroup);
+
+	/* Capsules of unknown endpoints are dropped */
+	ut_capsule_recv(&tgroup, (ucp_ep_h)0xE2, SPDK_NVME_OPC_FLUSH, 1, false, 0, 0);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.ready_reqs));
+	CU_ASSERT(tqpair->failed == false);
+
+	/* Too short to hold the command */
+	status = nvmf_ucx_capsule_cmd_handler(&tgroup, &g_capsule, sizeof(g_capsule.hdr) - 1,
+					      tqpair->ep, 0);
+	CU_ASSERT(status == UCS_OK);
+	CU_ASSERT(tqpair->failed == true);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.ready_reqs));
+
+	/* Capsules of a failed queue pair are dropped */
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_FLUSH, 1, false, 0, 0);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.ready_reqs));
+	tqpair->failed = false;
+
+	/* The rkey must fill the rest of the capsule */
+	memset(&g_capsule.hdr, 0, sizeof(g_capsule.hdr));
+	g_capsule.hdr.rkey_len = UT_RKEY_LEN;
+	status = nvmf_ucx_capsule_cmd_handler(&tgroup, &g_capsule, sizeof(g_capsule.hdr) +
+					      UT_RKEY_LEN + 1, tqpair->ep, 0);
+	CU_ASSERT(status == UCS_OK);
+	CU_ASSERT(tqpair->failed == true);
+	tqpair->failed = false;
+
+	/* rkey too large */
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_READ, 1, true, UT_IO_UNIT_SIZE,
+			NVME_UCX_MAX_RKEY_SIZE + 1);
+	CU_ASSERT(tqpair->failed == true);
+	tqpair->failed = false;
+
+	/* In-capsule data exceeding the in-capsule data size */
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_WRITE, 1, false,
+			UT_IN_CAPSULE_DATA_SIZE + 1, UT_IN_CAPSULE_DATA_SIZE + 1);
+	CU_ASSERT(tqpair->failed == true);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.ready_reqs));
+	CU_ASSERT(tqpair->state_cntr[UCX_REQUEST_STATE_FREE] == UT_MAX_QUEUE_DEPTH);
+	tqpair->failed = false;
+
+	/* In-capsule data is copied into the request */
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_WRITE, 1, false, 512, 512);
+	CU_ASSERT(tqpair->failed == false);
+	ucx_req = TAILQ_FIRST(&tgroup.ready_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_NEW);
+	CU_ASSERT(ucx_req->ready == true);
+	CU_ASSERT(ucx_req->cmd.cid == 1);
+	CU_ASSERT(ucx_req->incapsule_len == 512);
+	CU_ASSERT(ucx_req->packed_rkey_len == 0);
+	CU_ASSERT(memcmp(ucx_req->buf, g_capsule.payload, 512) == 0);
+
+	/* The packed rkey of a keyed SGL is copied into the request */
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_READ, 2, true, UT_IO_UNIT_SIZE,
+			UT_RKEY_LEN);
+	CU_ASSERT(tqpair->failed == false);
+	ucx_req = TAILQ_NEXT(ucx_req, ready_link);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	CU_ASSERT(ucx_req->cmd.cid == 2);
+	CU_ASSERT(ucx_req->incapsule_len == 0);
+	CU_ASSERT(ucx_req->packed_rkey_len == UT_RKEY_LEN);
+	CU_ASSERT(memcmp(ucx_req->packed_rkey, g_capsule.payload, UT_RKEY_LEN) == 0);
+
+	/* The host submits more commands than the queue holds */
+	for (i = 2; i < UT_MAX_QUEUE_DEPTH; i++) {
+		ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_FLUSH, i + 1, false, 0, 0);
+	}
+	CU_ASSERT(tqpair->failed == false);
+	CU_ASSERT(tqpair->state_cntr[UCX_REQUEST_STATE_NEW] == UT_MAX_QUEUE_DEPTH);
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_FLUSH, UT_MAX_QUEUE_DEPTH + 1, false,
+			0, 0);
+	CU_ASSERT(tqpair->failed == true);
+	tqpair->failed = false;
+
+	/* The host terminates the queue pair */
+	status = nvmf_ucx_term_handler(&tgroup, NULL, 0, tqpair->ep, 0);
+	CU_ASSERT(status == UCS_OK);
+	CU_ASSERT(tqpair->peer_term == true);
+	CU_ASSERT(tqpair->failed == true);
+
+	/* Endpoint failure */
+	tqpair->failed = false;
+	nvmf_ucx_err_cb(&tgroup, tqpair->ep, UCS_ERR_ENDPOINT_TIMEOUT);
+	CU_ASSERT(tqpair->failed == true);
+
+	ut_qpair_destroy(&tgroup, tqpair);
+}
+
+static void
+test_nvmf_ucx_req_parse_sgl(void)
+{
+	struct spdk_nvmf_ucx_transport ttransport;
+	struct spdk_nvmf_ucx_poll_group tgroup;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	struct spdk_nvmf_ucx_req *ucx_req, *ucx_req2;
+	struct spdk_nvmf_transport *transport = &ttransport.transport;
+	struct spdk_nvme_sgl_descriptor *sgl;
+	int rc;
+
+	ut_transport_init(&ttransport, &tgroup);
+	tqpair = ut_qpair_create(&ttransport, &tgroup);
+
+	ucx_req = nvmf_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	sgl = &ucx_req->cmd.dptr.sgl1;
+
+	/* Keyed SGL */
+	sgl->generic.type = SPDK_NVME_SGL_TYPE_KEYED_DATA_BLOCK;
+	sgl->keyed.subtype = SPDK_NVME_SGL_SUBTYPE_ADDRESS;
+	sgl->address = 0xF000;
+
+	/* Part 1: longer than the max I/O size */
+	sgl->keyed.length = UT_MAX_IO_SIZE + 1;
+	ucx_req->packed_rkey_len = UT_RKEY_LEN;
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+
+	/* Part 2: no rkey in the capsule */
+	sgl->keyed.length = UT_IO_UNIT_SIZE * 2;
+	ucx_req->packed_rkey_len = 0;
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_SGL_DESCRIPTOR_TYPE_INVALID);
+
+	/* Part 3: the rkey cannot be unpacked, the buffers are returned */
+	ucx_req->packed_rkey_len = UT_RKEY_LEN;
+	memset(ucx_req->packed_rkey, 0x11, UT_RKEY_LEN);
+	g_rkey_unpack_status = UCS_ERR_INVALID_PARAM;
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_DATA_TRANSFER_ERROR);
+	CU_ASSERT(ucx_req->rkey == NULL);
+	CU_ASSERT(ucx_req->req.data_from_pool == false);
+	g_rkey_unpack_status = UCS_OK;
+
+	/* Part 4: buffers from the pool, one per I/O unit */
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ucx_req->req.data_from_pool == true);
+	CU_ASSERT(ucx_req->req.length == UT_IO_UNIT_SIZE * 2);
+	CU_ASSERT(ucx_req->req.iovcnt == 2);
+	CU_ASSERT(ucx_req->req.iov[0].iov_len == UT_IO_UNIT_SIZE);
+	CU_ASSERT(ucx_req->req.data == ucx_req->req.iov[0].iov_base);
+	CU_ASSERT(ucx_req->remote_addr == 0xF000);
+	SPDK_CU_ASSERT_FATAL(ucx_req->rkey != NULL);
+	CU_ASSERT(ucx_req->rkey->refs == 1);
+	CU_ASSERT(g_rkey_unpack_count == 2);
+
+	/* Part 5: the same rkey is served from the cache */
+	ucx_req2 = nvmf_ucx_req_get(tqpair);
+	SPDK_CU_ASSERT_FATAL(ucx_req2 != NULL);
+	ucx_req2->cmd = ucx_req->cmd;
+	ucx_req2->packed_rkey_len = UT_RKEY_LEN;
+	memset(ucx_req2->packed_rkey, 0x11, UT_RKEY_LEN);
+	rc = nvmf_ucx_req_parse_sgl(ucx_req2, transport, &tgroup.group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ucx_req2->rkey == ucx_req->rkey);
+	CU_ASSERT(ucx_req->rkey->refs == 2);
+	CU_ASSERT(g_rkey_unpack_count == 2);
+
+	nvmf_ucx_qpair_put_rkey(ucx_req2->rkey);
+	spdk_nvmf_request_free_buffers(&ucx_req2->req, &tgroup.group, transport);
+	nvmf_ucx_qpair_put_rkey(ucx_req->rkey);
+	CU_ASSERT(ucx_req->rkey->refs == 0);
+	CU_ASSERT(ucx_req->rkey->rkey != NULL);
+	spdk_nvmf_request_free_buffers(&ucx_req->req, &tgroup.group, transport);
+	ucx_req->rkey = NULL;
+	ucx_req2->rkey = NULL;
+
+	/* In-capsule data */
+	memset(sgl, 0, sizeof(*sgl));
+	sgl->generic.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
+	sgl->unkeyed.subtype = SPDK_NVME_SGL_SUBTYPE_OFFSET;
+	ucx_req->incapsule_len = 512;
+
+	/* Part 1: offset beyond the data */
+	sgl->address = 600;
+	sgl->unkeyed.length = 16;
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_INVALID_SGL_OFFSET);
+
+	/* Part 2: length beyond the data */
+	sgl->address = 256;
+	sgl->unkeyed.length = 512;
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+
+	/* Part 3: the data points into the capsule */
+	sgl->unkeyed.length = 256;
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ucx_req->req.data == ucx_req->buf + 256);
+	CU_ASSERT(ucx_req->req.data_from_pool == false);
+	CU_ASSERT(ucx_req->req.length == 256);
+	CU_ASSERT(ucx_req->req.iovcnt == 1);
+
+	/* Unsupported SGL type */
+	sgl->generic.type = SPDK_NVME_SGL_TYPE_BIT_BUCKET;
+	rc = nvmf_ucx_req_parse_sgl(ucx_req, transport, &tgroup.group);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_SGL_DESCRIPTOR_TYPE_INVALID);
+
+	nvmf_ucx_req_set_state(ucx_req, UCX_REQUEST_STATE_FREE);
+	nvmf_ucx_req_set_state(ucx_req2, UCX_REQUEST_STATE_FREE);
+	ut_qpair_destroy(&tgroup, tqpair);
+}
+
+/* Complete the UCP request posted n-th and let the poll group advance the request */
+static void
+ut_ucp_complete(struct spdk_nvmf_ucx_poll_group *tgroup, int n, ucs_status_t status)
+{
+	nvmf_ucx_ucp_req_cb(&g_ucp_reqs[n], status);
+	nvmf_ucx_poll_group_poll(&tgroup->group);
+}
+
+static void
+test_nvmf_ucx_req_process(void)
+{
+	struct spdk_nvmf_ucx_transport ttransport;
+	struct spdk_nvmf_ucx_poll_group tgroup;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	struct spdk_nvmf_ucx_req *ucx_req;
+
+	ut_transport_init(&ttransport, &tgroup);
+	tqpair = ut_qpair_create(&ttransport, &tgroup);
+
+	/* Write with in-capsule data */
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_WRITE, 1, false, 512, 512);
+	ucx_req = TAILQ_FIRST(&tgroup.ready_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.ready_reqs));
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_EXECUTING);
+	CU_ASSERT(ucx_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER);
+	CU_ASSERT(ucx_req->req.data == ucx_req->buf);
+	CU_ASSERT(g_get_count == 0);
+
+	/* The completion waits for its send */
+	nvmf_ucx_req_complete(&ucx_req->req);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	CU_ASSERT(g_am_count == 1);
+	CU_ASSERT(g_am_id == NVME_UCX_AM_ID_CAPSULE_RESP);
+	CU_ASSERT(ucx_req->pending == 1);
+	CU_ASSERT(ucx_req->rsp.sqhd == 1);
+
+	ut_ucp_complete(&tgroup, 0, UCS_OK);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_FREE);
+	CU_ASSERT(ucx_req->pending == 0);
+	CU_ASSERT(g_ucp_reqs_freed == 1);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair->ucp_reqs));
+	CU_ASSERT(tqpair->state_cntr[UCX_REQUEST_STATE_FREE] == UT_MAX_QUEUE_DEPTH);
+
+	/* Read into a keyed SGL: put, flush, then the response */
+	ut_ucp_reset();
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_READ, 2, true, UT_IO_UNIT_SIZE * 2,
+			UT_RKEY_LEN);
+	ucx_req = TAILQ_FIRST(&tgroup.ready_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_EXECUTING);
+	CU_ASSERT(ucx_req->req.xfer == SPDK_NVME_DATA_CONTROLLER_TO_HOST);
+	CU_ASSERT(ucx_req->req.data_from_pool == true);
+	CU_ASSERT(ucx_req->rkey != NULL);
+	CU_ASSERT(STAILQ_EMPTY(&tgroup.group.pending_buf_queue));
+
+	nvmf_ucx_req_complete(&ucx_req->req);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	CU_ASSERT(g_put_count == 2);
+	CU_ASSERT(g_flush_count == 1);
+	CU_ASSERT(g_am_count == 0);
+
+	ut_ucp_complete(&tgroup, 0, UCS_OK);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	CU_ASSERT(g_am_count == 1);
+	CU_ASSERT(ucx_req->rsp_sent == true);
+
+	ut_ucp_complete(&tgroup, 1, UCS_OK);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_FREE);
+	CU_ASSERT(ucx_req->rkey == NULL);
+	CU_ASSERT(ucx_req->req.data_from_pool == false);
+	CU_ASSERT(g_ucp_reqs_freed == 2);
+
+	/* Write from a keyed SGL whose get fails */
+	ut_ucp_reset();
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_WRITE, 3, true, UT_IO_UNIT_SIZE,
+			UT_RKEY_LEN);
+	ucx_req = TAILQ_FIRST(&tgroup.ready_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+	CU_ASSERT(g_get_count == 1);
+	CU_ASSERT(ucx_req->pending == 1);
+
+	ut_ucp_complete(&tgroup, 0, UCS_ERR_IO_ERROR);
+	CU_ASSERT(tqpair->failed == true);
+	CU_ASSERT(tqpair->disconnecting == true);
+	CU_ASSERT(ucx_req->xfer_failed == true);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_DATA_TRANSFER_ERROR);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	CU_ASSERT(g_am_count == 1);
+
+	ut_ucp_complete(&tgroup, 1, UCS_OK);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_FREE);
+	tqpair->failed = false;
+	tqpair->disconnecting = false;
+
+	/* Write from a keyed SGL whose get cannot be posted */
+	ut_ucp_reset();
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_WRITE, 4, true, UT_IO_UNIT_SIZE,
+			UT_RKEY_LEN);
+	ucx_req = TAILQ_FIRST(&tgroup.ready_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	g_ucp_op_status = UCS_ERR_NO_RESOURCE;
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(ucx_req->rsp.status.sc == SPDK_NVME_SC_DATA_TRANSFER_ERROR);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_FREE);
+	CU_ASSERT(tqpair->failed == true);
+	tqpair->failed = false;
+	tqpair->disconnecting = false;
+
+	/* Write from a keyed SGL whose get completes in place */
+	ut_ucp_reset();
+	g_ucp_op_status = UCS_OK;
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_WRITE, 5, true, UT_IO_UNIT_SIZE,
+			UT_RKEY_LEN);
+	ucx_req = TAILQ_FIRST(&tgroup.ready_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_EXECUTING);
+	nvmf_ucx_req_complete(&ucx_req->req);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_FREE);
+	CU_ASSERT(g_am_count == 1);
+
+	ut_qpair_destroy(&tgroup, tqpair);
+}
+
+static void
+test_nvmf_ucx_close_qpair(void)
+{
+	struct spdk_nvmf_ucx_transport ttransport;
+	struct spdk_nvmf_ucx_poll_group tgroup;
+	struct spdk_nvmf_ucx_qpair *tqpair;
+	struct spdk_nvmf_ucx_req *ucx_req;
+	int close_req;
+
+	ut_transport_init(&ttransport, &tgroup);
+	tqpair = ut_qpair_create(&ttransport, &tgroup);
+
+	/* A request waits for its get when the queue pair goes away */
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_WRITE, 1, true, UT_IO_UNIT_SIZE,
+			UT_RKEY_LEN);
+	ucx_req = TAILQ_FIRST(&tgroup.ready_reqs);
+	SPDK_CU_ASSERT_FATAL(ucx_req != NULL);
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+
+	nvmf_ucx_poll_group_remove(&tgroup.group, &tqpair->qpair);
+	tqpair->qpair.state = SPDK_NVMF_QPAIR_DEACTIVATING;
+	g_close_ptr = &close_req;
+	MOCK_SET(ucp_request_check_status, UCS_INPROGRESS);
+	nvmf_ucx_close_qpair(&tqpair->qpair);
+	CU_ASSERT(g_am_id == NVME_UCX_AM_ID_TERM);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FLUSH);
+	CU_ASSERT(TAILQ_FIRST(&tgroup.closing) == tqpair);
+	CU_ASSERT(tqpair->close_req == &close_req);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+
+	/* Not before the endpoint closed, or the close timed out */
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(TAILQ_FIRST(&tgroup.closing) == tqpair);
+	CU_ASSERT(g_ucp_reqs_freed == 0);
+
+	/* The get and the termination notice are abandoned */
+	spdk_delay_us(NVMF_UCX_CLOSE_TIMEOUT_US);
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.closing));
+	CU_ASSERT(g_ucp_reqs_freed == 3);
+	CU_ASSERT(g_ucp_reqs[0].tqpair == NULL);
+	CU_ASSERT(g_ucp_reqs[1].tqpair == NULL);
+	MOCK_SET(ucp_request_check_status, UCS_OK);
+
+	/* Their callbacks may still run */
+	nvmf_ucx_ucp_req_cb(&g_ucp_reqs[0], UCS_ERR_CANCELED);
+	nvmf_ucx_ucp_req_cb(&g_ucp_reqs[1], UCS_ERR_CANCELED);
+	CU_ASSERT(g_ucp_reqs_freed == 3);
+
+	/* A failed endpoint is closed right away, without a termination notice */
+	ut_ucp_reset();
+	tqpair = ut_qpair_create(&ttransport, &tgroup);
+	ut_capsule_recv(&tgroup, tqpair->ep, SPDK_NVME_OPC_FLUSH, 1, false, 0, 0);
+	nvmf_ucx_poll_group_poll(&tgroup.group);
+	CU_ASSERT(tqpair->state_cntr[UCX_REQUEST_STATE_EXECUTING] == 1);
+	ucx_req = TAILQ_FIRST(&tqpair->state_queue[UCX_REQUEST_STATE_EXECUTING]);
+	nvmf_ucx_req_complete(&ucx_req->req);
+	ut_ucp_complete(&tgroup, 0, UCS_OK);
+	CU_ASSERT(ucx_req->state == UCX_REQUEST_STATE_FREE);
+
+	tqpair->failed = true;
+	nvmf_ucx_poll_group_remove(&tgroup.group, &tqpair->qpair);
+	tqpair->qpair.state = SPDK_NVMF_QPAIR_DEACTIVATING;
+	nvmf_ucx_close_qpair(&tqpair->qpair);
+	CU_ASSERT(g_am_count == 1);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.closing));
+}
+
+int main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("nvmf", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_nvmf_ucx_create);
+	CU_ADD_TEST(suite, test_nvmf_ucx_capsule_cmd_handler);
+	CU_ADD_TEST(suite, test_nvmf_ucx_req_parse_sgl);
+	CU_ADD_TEST(suite, test_nvmf_ucx_req_process);
+	CU_ADD_TEST(suite, test_nvmf_ucx_close_qpair);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+	return num_failures;
+}
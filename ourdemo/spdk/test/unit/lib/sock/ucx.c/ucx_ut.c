@@ -0,0 +1,405 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2026 The ourdemo authors.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk/util.h"
+
+#include "spdk_internal/mock.h"
+
+#include "spdk_cunit.h"
+
+#include "sock/ucx/ucx.c"
+
+DEFINE_STUB_V(spdk_net_impl_register, (struct spdk_net_impl *impl, int priority));
+DEFINE_STUB(spdk_sock_close, int, (struct spdk_sock **s), 0);
+DEFINE_STUB(ucp_init_version, ucs_status_t, (unsigned api_major_version,
+		unsigned api_minor_version, const ucp_params_t *params,
+		const ucp_config_t *config, ucp_context_h *context_p), UCS_OK);
+DEFINE_STUB_V(ucp_cleanup, (ucp_context_h context_p));
+DEFINE_STUB(ucp_worker_create, ucs_status_t, (ucp_context_h context,
+		const ucp_worker_params_t *params, ucp_worker_h *worker_p), UCS_OK);
+DEFINE_STUB_V(ucp_worker_destroy, (ucp_worker_h worker));
+DEFINE_STUB(ucp_worker_progress, unsigned, (ucp_worker_h worker), 0);
+DEFINE_STUB(ucp_listener_create, ucs_status_t, (ucp_worker_h worker,
+		const ucp_listener_params_t *params, ucp_listener_h *listener_p), UCS_OK);
+DEFINE_STUB_V(ucp_listener_destroy, (ucp_listener_h listener));
+DEFINE_STUB(ucp_listener_query, ucs_status_t, (ucp_listener_h listener,
+		ucp_listener_attr_t *attr), UCS_OK);
+DEFINE_STUB(ucp_listener_reject, ucs_status_t, (ucp_listener_h listener,
+		ucp_conn_request_h conn_request), UCS_OK);
+DEFINE_STUB(ucp_ep_create, ucs_status_t, (ucp_worker_h worker, const ucp_ep_params_t *params,
+		ucp_ep_h *ep_p), UCS_OK);
+DEFINE_STUB(ucp_ep_flush_nb, ucs_status_ptr_t, (ucp_ep_h ep, unsigned flags,
+		ucp_send_callback_t cb), NULL);
+DEFINE_STUB(ucp_request_check_status, ucs_status_t, (void *request), UCS_OK);
+DEFINE_STUB_V(ucp_request_free, (void *request));
+DEFINE_STUB(ucs_status_string, const char *, (ucs_status_t status), "");
+DEFINE_STUB(ucp_stream_send_nb, ucs_status_ptr_t, (ucp_ep_h ep, const void *buffer, size_t count,
+		ucp_datatype_t datatype, ucp_send_callback_t cb, unsigned flags), NULL);
+DEFINE_STUB(spdk_get_ticks_hz, uint64_t, (void), 1000);
+
+static uint64_t g_ticks;
+
+uint64_t
+spdk_get_ticks(void)
+{
+	g_ticks += 100;
+	return g_ticks;
+}
+
+static unsigned g_close_mode;
+static int g_close_count;
+
+ucs_status_ptr_t
+ucp_ep_close_nb(ucp_ep_h ep, unsigned mode)
+{
+	g_close_mode = mode;
+	g_close_count++;
+	return NULL;
+}
+
+#define UT_MAX_FRAGMENTS 4
+
+static struct {
+	char	*data[UT_MAX_FRAGMENTS];
+	size_t	len[UT_MAX_FRAGMENTS];
+	int	count;
+	int	next;
+	int	released;
+} g_stream;
+
+ucs_status_ptr_t
+ucp_stream_recv_data_nb(ucp_ep_h ep, size_t *length)
+{
+	if (g_stream.next == g_stream.count) {
+		return NULL;
+	}
+
+	*length = g_stream.len[g_stream.next];
+	return g_stream.data[g_stream.next++];
+}
+
+void
+ucp_stream_data_release(ucp_ep_h ep, void *data)
+{
+	CU_ASSERT(data == g_stream.data[g_stream.released]);
+	g_stream.released++;
+}
+
+static void
+_stream_push(char *data)
+{
+	SPDK_CU_ASSERT_FATAL(g_stream.count < UT_MAX_FRAGMENTS);
+	g_stream.data[g_stream.count] = data;
+	g_stream.len[g_stream.count] = strlen(data);
+	g_stream.count++;
+}
+
+static void
+_req_cb(void *cb_arg, int err)
+{
+	*(int *)cb_arg = err;
+}
+
+static void
+_sock_init(struct spdk_ucx_sock *usock)
+{
+	memset(usock, 0, sizeof(*usock));
+	TAILQ_INIT(&usock->base.queued_reqs);
+	TAILQ_INIT(&usock->base.pending_reqs);
+	TAILQ_INIT(&usock->inflight_reqs);
+	TAILQ_INIT(&usock->completed_reqs);
+	usock->ep = (ucp_ep_h)0xDEADBEEF;
+}
+
+static struct spdk_sock_request *
+_req_alloc(int iovcnt, int *cb_arg)
+{
+	struct spdk_sock_request *req;
+	int i;
+
+	req = calloc(1, sizeof(struct spdk_sock_request) + iovcnt * sizeof(struct iovec));
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+	for (i = 0; i < iovcnt; i++) {
+		SPDK_SOCK_REQUEST_IOV(req, i)->iov_base = (void *)(uintptr_t)(100 * (i + 1));
+		SPDK_SOCK_REQUEST_IOV(req, i)->iov_len = 64;
+	}
+	req->iovcnt = iovcnt;
+	req->cb_fn = _req_cb;
+	req->cb_arg = cb_arg;
+	*cb_arg = 1;
+
+	return req;
+}
+
+static void
+readv_stream_data(void)
+{
+	struct spdk_ucx_sock_group_impl group = {};
+	struct spdk_ucx_sock usock;
+	struct spdk_sock *sock = &usock.base;
+	char frag1[] = "abcdef";
+	char frag2[] = "ghij";
+	char buf1[4], buf2[8];
+	struct iovec iov[2];
+	ssize_t rc;
+
+	_sock_init(&usock);
+	sock->group_impl = &group.base;
+	memset(&g_stream, 0, sizeof(g_stream));
+
+	/* Nothing has arrived yet */
+	iov[0].iov_base = buf1;
+	iov[0].iov_len = sizeof(buf1);
+	rc = ucx_sock_readv(sock, iov, 1);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(errno == EAGAIN);
+
+	/* Two fragments gathered into two user buffers with different boundaries */
+	_stream_push(frag1);
+	_stream_push(frag2);
+	iov[1].iov_base = buf2;
+	iov[1].iov_len = sizeof(buf2);
+	rc = ucx_sock_readv(sock, iov, 2);
+	CU_ASSERT(rc == 10);
+	CU_ASSERT(memcmp(buf1, "abcd", 4) == 0);
+	CU_ASSERT(memcmp(buf2, "efghij", 6) == 0);
+	CU_ASSERT(g_stream.released == 2);
+	CU_ASSERT(usock.recv_data == NULL);
+
+	/* A fragment larger than the user buffer is held until it is consumed */
+	_stream_push(frag1);
+	rc = ucx_sock_readv(sock, iov, 1);
+	CU_ASSERT(rc == 4);
+	CU_ASSERT(memcmp(buf1, "abcd", 4) == 0);
+	CU_ASSERT(usock.recv_data == (uint8_t *)frag1);
+	CU_ASSERT(g_stream.released == 2);
+	CU_ASSERT(ucx_sock_readable(&usock) == true);
+
+	rc = ucx_sock_recv(sock, buf2, sizeof(buf2));
+	CU_ASSERT(rc == 2);
+	CU_ASSERT(memcmp(buf2, "ef", 2) == 0);
+	CU_ASSERT(usock.recv_data == NULL);
+	CU_ASSERT(g_stream.released == 3);
+	CU_ASSERT(ucx_sock_readable(&usock) == false);
+
+	/* A failed endpoint looks like an orderly shutdown to the reader */
+	usock.connection_status = -ECONNRESET;
+	rc = ucx_sock_readv(sock, iov, 1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ucx_sock_readable(&usock) == true);
+}
+
+static void
+flush_reqs(void)
+{
+	struct spdk_ucx_sock usock;
+	struct spdk_sock *sock = &usock.base;
+	struct spdk_ucx_sock_request ctx = {};
+	struct spdk_sock_request *req1, *req2;
+	int cb_arg1, cb_arg2;
+	int rc;
+
+	_sock_init(&usock);
+
+	req1 = _req_alloc(1, &cb_arg1);
+	req2 = _req_alloc(3, &cb_arg2);
+
+	/* Both sends complete in place */
+	spdk_sock_request_queue(sock, req1);
+	spdk_sock_request_queue(sock, req2);
+	MOCK_SET(ucp_stream_send_nb, NULL);
+	rc = ucx_sock_flush_reqs(&usock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg1 == 0);
+	CU_ASSERT(cb_arg2 == 0);
+	CU_ASSERT(TAILQ_EMPTY(&sock->queued_reqs));
+	CU_ASSERT(TAILQ_EMPTY(&sock->pending_reqs));
+
+	/* The send is still in flight after the flush */
+	cb_arg1 = 1;
+	spdk_sock_request_queue(sock, req1);
+	MOCK_SET(ucp_stream_send_nb, &ctx);
+	rc = ucx_sock_flush_reqs(&usock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg1 == 1);
+	CU_ASSERT(TAILQ_EMPTY(&sock->queued_reqs));
+	CU_ASSERT(TAILQ_FIRST(&sock->pending_reqs) == req1);
+	CU_ASSERT(TAILQ_FIRST(&usock.inflight_reqs) == &ctx);
+	CU_ASSERT(ctx.req == req1);
+
+	/* UCP completion only moves the request, the user callback runs later */
+	ucx_sock_send_cb(&ctx, UCS_OK);
+	CU_ASSERT(cb_arg1 == 1);
+	CU_ASSERT(TAILQ_EMPTY(&usock.inflight_reqs));
+	CU_ASSERT(TAILQ_FIRST(&usock.completed_reqs) == &ctx);
+
+	rc = ucx_sock_complete_reqs(&usock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg1 == 0);
+	CU_ASSERT(TAILQ_EMPTY(&usock.completed_reqs));
+	CU_ASSERT(TAILQ_EMPTY(&sock->pending_reqs));
+
+	/* A failed completion is reported to the user and fails the connection */
+	cb_arg1 = 1;
+	spdk_sock_request_queue(sock, req1);
+	rc = ucx_sock_flush_reqs(&usock);
+	CU_ASSERT(rc == 0);
+	ucx_sock_send_cb(&ctx, UCS_ERR_CONNECTION_RESET);
+	rc = ucx_sock_complete_reqs(&usock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg1 == -ECONNRESET);
+	CU_ASSERT(usock.connection_status == -ECONNRESET);
+
+	MOCK_SET(ucp_stream_send_nb, NULL);
+	free(req1);
+	free(req2);
+}
+
+static void
+abort_inflight(void)
+{
+	struct spdk_ucx_sock usock;
+	struct spdk_sock *sock = &usock.base;
+	struct spdk_ucx_sock_request ctx = {};
+	struct spdk_sock_request *req1, *req2;
+	int cb_arg1, cb_arg2;
+	int rc;
+
+	_sock_init(&usock);
+
+	req1 = _req_alloc(2, &cb_arg1);
+	req2 = _req_alloc(2, &cb_arg2);
+
+	/* One request in flight in UCP, one still queued */
+	spdk_sock_request_queue(sock, req1);
+	MOCK_SET(ucp_stream_send_nb, &ctx);
+	rc = ucx_sock_flush_reqs(&usock);
+	CU_ASSERT(rc == 0);
+	spdk_sock_request_queue(sock, req2);
+
+	rc = ucx_sock_abort(&usock, -ECONNRESET);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg1 == -ECANCELED);
+	CU_ASSERT(cb_arg2 == -ECANCELED);
+	CU_ASSERT(usock.connection_status == -ECONNRESET);
+	CU_ASSERT(ctx.req == NULL);
+
+	/* The late UCP completion must not reach the user again */
+	cb_arg1 = 1;
+	ucx_sock_send_cb(&ctx, UCS_ERR_CANCELED);
+	rc = ucx_sock_complete_reqs(&usock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg1 == 1);
+	CU_ASSERT(TAILQ_EMPTY(&usock.completed_reqs));
+
+	/* New requests fail right away */
+	cb_arg2 = 1;
+	ucx_sock_writev_async(sock, req2);
+	CU_ASSERT(cb_arg2 == -ECONNRESET);
+	CU_ASSERT(TAILQ_EMPTY(&sock->queued_reqs));
+
+	MOCK_SET(ucp_stream_send_nb, NULL);
+	free(req1);
+	free(req2);
+}
+
+static void
+ep_close(void)
+{
+	struct spdk_ucx_sock usock;
+	struct spdk_ucx_sock_request flush_ctx = {};
+	uint64_t start;
+
+	/* Everything was acknowledged, the endpoint is closed gracefully */
+	_sock_init(&usock);
+	g_close_count = 0;
+	MOCK_SET(ucp_ep_flush_nb, NULL);
+	ucx_sock_ep_close(&usock);
+	CU_ASSERT(g_close_count == 1);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FLUSH);
+	CU_ASSERT(usock.ep == NULL);
+
+	/* A dead peer never acknowledges, the wait is bounded and the close is forced */
+	_sock_init(&usock);
+	g_close_count = 0;
+	MOCK_SET(ucp_ep_flush_nb, &flush_ctx);
+	MOCK_SET(ucp_request_check_status, UCS_INPROGRESS);
+	start = g_ticks;
+	ucx_sock_ep_close(&usock);
+	CU_ASSERT(g_close_count == 1);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+	CU_ASSERT(g_ticks - start >= UCX_SOCK_CLOSE_FLUSH_TIMEOUT_MS);
+	CU_ASSERT(usock.ep == NULL);
+
+	/* The flush failed because the endpoint broke meanwhile */
+	_sock_init(&usock);
+	MOCK_SET(ucp_ep_flush_nb, UCS_STATUS_PTR(UCS_ERR_CONNECTION_RESET));
+	ucx_sock_ep_close(&usock);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+
+	/* A failed endpoint is not flushed at all */
+	_sock_init(&usock);
+	usock.connection_status = -ECONNRESET;
+	MOCK_SET(ucp_ep_flush_nb, NULL);
+	ucx_sock_ep_close(&usock);
+	CU_ASSERT(g_close_mode == UCP_EP_CLOSE_MODE_FORCE);
+
+	MOCK_SET(ucp_request_check_status, UCS_OK);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ucx", NULL, NULL);
+
+	CU_ADD_TEST(suite, readv_stream_data);
+	CU_ADD_TEST(suite, flush_reqs);
+	CU_ADD_TEST(suite, abort_inflight);
+	CU_ADD_TEST(suite, ep_close);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+
+	CU_basic_run_tests();
+
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+
+	return num_failures;
+}
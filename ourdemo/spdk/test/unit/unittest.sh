@@ -104,6 +104,10 @@ function unittest_sock() {
 	if grep -q '#define SPDK_CONFIG_URING 1' $rootdir/include/spdk/config.h; then
 		$valgrind $testdir/lib/sock/uring.c/uring_ut
 	fi
+	# Check whether ucx is configured
+	if grep -q '#define SPDK_CONFIG_UCX 1' $rootdir/include/spdk/config.h; then
+		$valgrind $testdir/lib/sock/ucx.c/ucx_ut
+	fi
 }
 
 function unittest_util() {
@@ -174,6 +178,10 @@ if grep -q '#define SPDK_CONFIG_PMDK 1' $rootdir/include/spdk/config.h; then
 	run_test "unittest_bdev_pmem" $valgrind $testdir/lib/bdev/pmem/bdev_pmem_ut
 fi
 
+if grep -q '#define SPDK_CONFIG_UCX 1' $rootdir/include/spdk/config.h; then
+	run_test "unittest_bdev_ucx" $valgrind $testdir/lib/bdev/ucx.c/ucx_ut
+fi
+
 if grep -q '#define SPDK_CONFIG_RAID5 1' $rootdir/include/spdk/config.h; then
 	run_test "unittest_bdev_raid5" $valgrind $testdir/lib/bdev/raid/raid5.c/raid5_ut
 fi
@@ -197,6 +205,9 @@ run_test "unittest_lvol" $valgrind $testdir/lib/lvol/lvol.c/lvol_ut
 if grep -q '#define SPDK_CONFIG_RDMA 1' $rootdir/include/spdk/config.h; then
 	run_test "unittest_nvme_rdma" $valgrind $testdir/lib/nvme/nvme_rdma.c/nvme_rdma_ut
 fi
+if grep -q '#define SPDK_CONFIG_UCX 1' $rootdir/include/spdk/config.h; then
+	run_test "unittest_nvme_ucx" $valgrind $testdir/lib/nvme/nvme_ucx.c/nvme_ucx_ut
+fi
 
 run_test "unittest_nvmf" unittest_nvmf
 if grep -q '#define SPDK_CONFIG_FC 1' $rootdir/include/spdk/config.h; then
@@ -208,6 +219,10 @@ if grep -q '#define SPDK_CONFIG_RDMA 1' $rootdir/include/spdk/config.h; then
 	run_test "unittest_nvmf_rdma" $valgrind $testdir/lib/nvmf/rdma.c/rdma_ut
 fi
 
+if grep -q '#define SPDK_CONFIG_UCX 1' $rootdir/include/spdk/config.h; then
+	run_test "unittest_nvmf_ucx" $valgrind $testdir/lib/nvmf/ucx.c/ucx_ut
+fi
+
 run_test "unittest_scsi" unittest_scsi
 run_test "unittest_sock" unittest_sock
 run_test "unittest_thread" $valgrind $testdir/lib/thread/thread.c/thread_ut
@@ -580,6 +580,9 @@
 /* Define to 1 if you have the <linux/futex.h> header file. */
 #define HAVE_LINUX_FUTEX_H 1
 
+/* Define to 1 if you have the <linux/io_uring.h> header file. */
+/* #undef HAVE_LINUX_IO_URING_H */
+
 /* Define to 1 if you have the <linux/ip.h> header file. */
 #define HAVE_LINUX_IP_H 1
 
@@ -95,6 +95,12 @@ AC_CHECK_DECLS([ethtool_cmd_speed, SPEED_UNKNOWN], [], [],
                [#include <linux/ethtool.h>])
 
 
+#
+# io_uring definitions, used by the event set in src/ucs/sys/event_set.c
+#
+AC_CHECK_HEADERS([linux/io_uring.h])
+
+
 #
 # PowerPC query for TB frequency
 #
@@ -11,6 +11,7 @@
 #include "ucx_info.h"
 
 #include <ucp/api/ucp.h>
+#include <ucp/core/ucp_thresh_profile.h>
 #include <ucs/time/time.h>
 #include <ucs/sys/string.h>
 #include <sys/resource.h>
@@ -93,10 +94,39 @@ static void print_resource_usage(const resource_usage_t *usage_before,
     printf("#\n");
 }
 
+static void print_thresh_profile(ucp_context_h context, const char *filename)
+{
+    ucs_time_t start_time;
+    ucs_status_t status;
+
+    start_time = ucs_get_time();
+    status     = ucp_thresh_profile_calibrate(context, 1);
+    if (status != UCS_OK) {
+        printf("<Failed to measure protocol thresholds: %s>\n",
+               ucs_status_string(status));
+        return;
+    }
+
+    status = ucp_thresh_profile_save(context, filename);
+    if (status != UCS_OK) {
+        printf("<Failed to save protocol thresholds to %s>\n", filename);
+        return;
+    }
+
+    printf("#\n");
+    printf("# Protocol thresholds saved to %s\n", filename);
+    printf("#\n");
+    ucp_thresh_profile_print(context, stdout);
+    printf("#\n");
+    printf("# calibration time: %.3f ms\n",
+           ucs_time_to_msec(ucs_get_time() - start_time));
+}
+
 void print_ucp_info(int print_opts, ucs_config_print_flags_t print_flags,
                     uint64_t ctx_features, const ucp_ep_params_t *base_ep_params,
                     size_t estimated_num_eps, size_t estimated_num_ppn,
-                    unsigned dev_type_bitmap, const char *mem_size)
+                    unsigned dev_type_bitmap, const char *mem_size,
+                    const char *thresh_profile)
 {
     ucp_config_t *config;
     ucs_status_t status;
@@ -135,6 +165,10 @@ void print_ucp_info(int print_opts, ucs_config_print_flags_t print_flags,
     if (!(dev_type_bitmap & UCS_BIT(UCT_DEVICE_TYPE_NET))) {
         ucp_config_modify(config, "NET_DEVICES", "");
     }
+    if (print_opts & PRINT_THRESH_PROFILE) {
+        /* measure all resources, regardless of an existing profile */
+        ucp_config_modify(config, "THRESH_PROFILE", "");
+    }
 
     status = ucp_init(&params, config, &context);
     if (status != UCS_OK) {
@@ -151,6 +185,10 @@ void print_ucp_info(int print_opts, ucs_config_print_flags_t print_flags,
         print_resource_usage(&usage, "UCP context");
     }
 
+    if ((print_opts & PRINT_THRESH_PROFILE) && (thresh_profile != NULL)) {
+        print_thresh_profile(context, thresh_profile);
+    }
+
     if (!(print_opts & (PRINT_UCP_WORKER|PRINT_UCP_EP))) {
         goto out_cleanup_context;
     }
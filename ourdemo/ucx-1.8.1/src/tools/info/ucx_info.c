@@ -35,6 +35,8 @@ static void usage() {
     printf("  -w              Show UCP worker information\n");
     printf("  -e              Show UCP endpoint configuration\n");
     printf("  -m <size>       Show UCP memory allocation method for a given size\n");
+    printf("  -T <file>       Measure protocol thresholds and save them to a profile file,\n");
+    printf("                  to be loaded with UCX_THRESH_PROFILE (implies -u t)\n");
     printf("  -u <features>   UCP context features to use. String of one or more of:\n");
     printf("                    'a' : atomic operations\n");
     printf("                    'r' : remote memory access\n");
@@ -64,7 +66,7 @@ int main(int argc, char **argv)
     size_t ucp_num_eps;
     size_t ucp_num_ppn;
     unsigned print_opts;
-    char *tl_name, *mem_size;
+    char *tl_name, *mem_size, *thresh_profile;
     const char *f;
     int c;
 
@@ -75,9 +77,10 @@ int main(int argc, char **argv)
     ucp_num_eps              = 1;
     ucp_num_ppn              = 1;
     mem_size                 = NULL;
+    thresh_profile           = NULL;
     dev_type_bitmap          = UINT_MAX;
     ucp_ep_params.field_mask = 0;
-    while ((c = getopt(argc, argv, "fahvcydbswpet:n:u:D:m:N:")) != -1) {
+    while ((c = getopt(argc, argv, "fahvcydbswpet:n:u:D:m:N:T:")) != -1) {
         switch (c) {
         case 'f':
             print_flags |= UCS_CONFIG_PRINT_CONFIG | UCS_CONFIG_PRINT_HEADER | UCS_CONFIG_PRINT_DOC;
@@ -116,6 +119,11 @@ int main(int argc, char **argv)
             print_opts |= PRINT_MEM_MAP;
             mem_size = optarg;
             break;
+        case 'T':
+            print_opts    |= PRINT_THRESH_PROFILE;
+            ucp_features  |= UCP_FEATURE_TAG;
+            thresh_profile = optarg;
+            break;
         case 't':
             tl_name = optarg;
             break;
@@ -205,14 +213,16 @@ int main(int argc, char **argv)
         ucs_config_parser_print_all_opts(stdout, print_flags);
     }
 
-    if (print_opts & (PRINT_UCP_CONTEXT|PRINT_UCP_WORKER|PRINT_UCP_EP|PRINT_MEM_MAP)) {
+    if (print_opts & (PRINT_UCP_CONTEXT|PRINT_UCP_WORKER|PRINT_UCP_EP|PRINT_MEM_MAP|
+                      PRINT_THRESH_PROFILE)) {
         if (ucp_features == 0) {
             printf("Please select UCP features using -u switch: a|r|t|w\n");
             usage();
             return -1;
         }
         print_ucp_info(print_opts, print_flags, ucp_features, &ucp_ep_params,
-                       ucp_num_eps, ucp_num_ppn, dev_type_bitmap, mem_size);
+                       ucp_num_eps, ucp_num_ppn, dev_type_bitmap, mem_size,
+                       thresh_profile);
     }
 
     return 0;
@@ -41,6 +41,7 @@ typedef enum {
     UCX_PERF_CMD_TAG,
     UCX_PERF_CMD_TAG_SYNC,
     UCX_PERF_CMD_STREAM,
+    UCX_PERF_CMD_TAG_BATCH,
     UCX_PERF_CMD_LAST
 } ucx_perf_cmd_t;
 
@@ -83,10 +84,24 @@ enum ucx_perf_test_flags {
     UCX_PERF_TEST_FLAG_TAG_WILDCARD     = UCS_BIT(4), /* For tag tests, use wildcard mask */
     UCX_PERF_TEST_FLAG_TAG_UNEXP_PROBE  = UCS_BIT(5), /* For tag tests, use probe to get unexpected receive */
     UCX_PERF_TEST_FLAG_VERBOSE          = UCS_BIT(7), /* Print error messages */
-    UCX_PERF_TEST_FLAG_STREAM_RECV_DATA = UCS_BIT(8)  /* For stream tests, use recv data API */
+    UCX_PERF_TEST_FLAG_STREAM_RECV_DATA = UCS_BIT(8), /* For stream tests, use recv data API */
+    UCX_PERF_TEST_FLAG_THREAD_WORKER    = UCS_BIT(9), /* For multi-threaded UCP tests, every thread
+                                                         uses its own worker instead of a shared one */
+    UCX_PERF_TEST_FLAG_LAT_HISTOGRAM    = UCS_BIT(10) /* Collect a histogram of per-operation latency */
 };
 
 
+/* Latency percentiles reported when UCX_PERF_TEST_FLAG_LAT_HISTOGRAM is set */
+typedef enum {
+    UCX_PERF_PERCENTILE_50,
+    UCX_PERF_PERCENTILE_90,
+    UCX_PERF_PERCENTILE_99,
+    UCX_PERF_PERCENTILE_99_9,
+    UCX_PERF_PERCENTILE_99_99,
+    UCX_PERF_PERCENTILE_LAST
+} ucx_perf_percentile_t;
+
+
 enum {
     UCT_PERF_TEST_MAX_FC_WINDOW   = 127         /* Maximal flow-control window */
 };
@@ -107,12 +122,22 @@ typedef struct ucx_perf_result {
     ucx_perf_counter_t      iters;
     double                  elapsed_time;
     ucx_perf_counter_t      bytes;
+    ucx_perf_counter_t      msgs;
     struct {
         double              typical;
         double              moment_average; /* Average since last report */
         double              total_average;  /* Average of the whole test */
     }
     latency, bandwidth, msgrate;
+    struct {
+        double              percentile[UCX_PERF_PERCENTILE_LAST];
+        double              max;
+    } latency_hist;                         /* Valid with UCX_PERF_TEST_FLAG_LAT_HISTOGRAM */
+    struct {
+        double              time;           /* CPU time (user+system) of the process */
+        double              per_msg;        /* CPU time per message */
+        double              utilization;    /* CPU time relative to elapsed time */
+    } cpu;
 } ucx_perf_result_t;
 
 
@@ -166,6 +191,8 @@ typedef struct ucx_perf_params {
     ucx_perf_test_type_t   test_type;       /* Test communication type */
     ucs_thread_mode_t      thread_mode;     /* Thread mode for communication objects */
     unsigned               thread_count;    /* Number of threads in the test program */
+    unsigned               ep_count;        /* Number of endpoints to every peer (UCP only),
+                                               operations are spread over them round-robin */
     ucs_async_mode_t       async_mode;      /* how async progress and locking is done */
     ucx_perf_wait_mode_t   wait_mode;       /* How to wait */
     ucs_memory_type_t      send_mem_type;   /* Send memory type */
@@ -203,6 +230,8 @@ typedef struct ucx_perf_params {
         unsigned               nonblocking_mode; /* TBD */
         ucp_perf_datatype_t    send_datatype;
         ucp_perf_datatype_t    recv_datatype;
+        unsigned               batch_size;  /* Number of messages passed to every
+                                               batched send call */
     } ucp;
 
 } ucx_perf_params_t;
@@ -60,6 +60,15 @@ typedef struct {
 
 const ucx_perf_allocator_t* ucx_perf_mem_type_allocators[UCS_MEMORY_TYPE_LAST];
 
+/* Reported latency percentiles, in units of 1/10000 */
+static const unsigned ucx_perf_percentiles[] = {
+    [UCX_PERF_PERCENTILE_50]    = 5000,
+    [UCX_PERF_PERCENTILE_90]    = 9000,
+    [UCX_PERF_PERCENTILE_99]    = 9900,
+    [UCX_PERF_PERCENTILE_99_9]  = 9990,
+    [UCX_PERF_PERCENTILE_99_99] = 9999
+};
+
 static const char *perf_iface_ops[] = {
     [ucs_ilog2(UCT_IFACE_FLAG_AM_SHORT)]         = "am short",
     [ucs_ilog2(UCT_IFACE_FLAG_AM_BCOPY)]         = "am bcopy",
@@ -272,6 +281,7 @@ void ucx_perf_test_start_clock(ucx_perf_context_t *perf)
 {
     ucs_time_t start_time = ucs_get_time();
 
+    perf->start_cpu_time   = ucx_perf_get_cpu_time();
     perf->start_time_acc   = ucs_get_accurate_time();
     perf->end_time         = (perf->params.max_time == 0.0) ? UINT64_MAX :
                               ucs_time_from_sec(perf->params.max_time) + start_time;
@@ -279,6 +289,8 @@ void ucx_perf_test_start_clock(ucx_perf_context_t *perf)
     perf->prev.time        = start_time;
     perf->prev.time_acc    = perf->start_time_acc;
     perf->current.time_acc = perf->start_time_acc;
+    perf->prev.cpu_time    = perf->start_cpu_time;
+    perf->current.cpu_time = perf->start_cpu_time;
 }
 
 /* Initialize/reset all parameters that could be modified by the warm-up run */
@@ -298,10 +310,12 @@ static void ucx_perf_test_prepare_new_run(ucx_perf_context_t *perf,
     perf->prev.bytes        = 0;
     perf->prev.iters        = 0;
     perf->timing_queue_head = 0;
+    perf->lat_hist_max      = 0;
 
     for (i = 0; i < TIMING_QUEUE_SIZE; ++i) {
         perf->timing_queue[i] = 0;
     }
+    memset(perf->lat_hist, 0, sizeof(perf->lat_hist));
     ucx_perf_test_start_clock(perf);
 }
 
@@ -323,19 +337,78 @@ static void ucx_perf_test_init(ucx_perf_context_t *perf,
     ucx_perf_test_prepare_new_run(perf, params);
 }
 
+static double ucx_perf_latency_factor(const ucx_perf_context_t *perf)
+{
+    return (perf->params.test_type == UCX_PERF_TEST_TYPE_PINGPONG) ? 2.0 : 1.0;
+}
+
+/* Value represented by a histogram bucket: the middle of its range */
+static ucs_time_t ucx_perf_hist_bucket_value(unsigned index)
+{
+    unsigned exp, sub;
+
+    if (index < UCX_PERF_HIST_SUB_COUNT) {
+        return index;
+    }
+
+    exp = (index / UCX_PERF_HIST_SUB_COUNT) + UCX_PERF_HIST_SUB_BITS - 1;
+    sub = index % UCX_PERF_HIST_SUB_COUNT;
+    return ((ucs_time_t)(UCX_PERF_HIST_SUB_COUNT + sub) <<
+            (exp - UCX_PERF_HIST_SUB_BITS)) +
+           (UCS_BIT(exp - UCX_PERF_HIST_SUB_BITS) / 2);
+}
+
+static void ucx_perf_calc_hist_result(const uint64_t *hist, ucs_time_t max,
+                                      double factor, ucx_perf_result_t *result)
+{
+    uint64_t total, count, target;
+    unsigned index, p;
+
+    total = 0;
+    for (index = 0; index < UCX_PERF_HIST_SIZE; ++index) {
+        total += hist[index];
+    }
+
+    count = 0;
+    index = 0;
+    for (p = 0; p < UCX_PERF_PERCENTILE_LAST; ++p) {
+        target = ucs_max((uint64_t)1,
+                         ucs_div_round_up(total * ucx_perf_percentiles[p],
+                                          10000));
+        while ((index < UCX_PERF_HIST_SIZE) && (count + hist[index] < target)) {
+            count += hist[index++];
+        }
+
+        if (total == 0) {
+            result->latency_hist.percentile[p] = 0.0;
+        } else {
+            result->latency_hist.percentile[p] =
+                ucs_time_to_sec(ucs_min(ucx_perf_hist_bucket_value(index), max)) /
+                factor;
+        }
+    }
+
+    result->latency_hist.max = ucs_time_to_sec(max) / factor;
+}
+
+static void ucx_perf_calc_cpu_result(double cpu_time, double elapsed_time,
+                                     ucx_perf_result_t *result)
+{
+    result->cpu.time        = cpu_time;
+    result->cpu.per_msg     = (result->msgs > 0) ? (cpu_time / result->msgs) : 0.0;
+    result->cpu.utilization = (elapsed_time > 0) ? (cpu_time / elapsed_time) : 0.0;
+}
+
 void ucx_perf_calc_result(ucx_perf_context_t *perf, ucx_perf_result_t *result)
 {
     ucs_time_t median;
     double factor;
 
-    if (perf->params.test_type == UCX_PERF_TEST_TYPE_PINGPONG) {
-        factor = 2.0;
-    } else {
-        factor = 1.0;
-    }
+    factor = ucx_perf_latency_factor(perf);
 
     result->iters = perf->current.iters;
     result->bytes = perf->current.bytes;
+    result->msgs  = perf->current.msgs;
     result->elapsed_time = perf->current.time_acc - perf->start_time_acc;
 
     /* Latency */
@@ -378,6 +451,19 @@ void ucx_perf_calc_result(ucx_perf_context_t *perf, ucx_perf_result_t *result)
         perf->current.msgs /
         (perf->current.time_acc - perf->start_time_acc) * factor;
 
+    /* Latency distribution */
+
+    if (perf->params.flags & UCX_PERF_TEST_FLAG_LAT_HISTOGRAM) {
+        ucx_perf_calc_hist_result(perf->lat_hist, perf->lat_hist_max, factor,
+                                  result);
+    } else {
+        memset(&result->latency_hist, 0, sizeof(result->latency_hist));
+    }
+
+    /* CPU usage */
+
+    ucx_perf_calc_cpu_result(perf->current.cpu_time - perf->start_cpu_time,
+                             result->elapsed_time, result);
 }
 
 static ucs_status_t ucx_perf_test_check_params(ucx_perf_params_t *params)
@@ -393,6 +479,7 @@ static ucs_status_t ucx_perf_test_check_params(ucx_perf_params_t *params)
           (params->command != UCX_PERF_CMD_AM) &&
           (params->command != UCX_PERF_CMD_TAG) &&
           (params->command != UCX_PERF_CMD_TAG_SYNC) &&
+          (params->command != UCX_PERF_CMD_TAG_BATCH) &&
           (params->command != UCX_PERF_CMD_STREAM))) &&
         ucx_perf_get_message_size(params) < 1) {
         if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
@@ -426,6 +513,34 @@ static ucs_status_t ucx_perf_test_check_params(ucx_perf_params_t *params)
         return UCS_ERR_INVALID_PARAM;
     }
 
+    if (((params->api == UCX_PERF_API_UCP) && (params->ep_count < 1)) ||
+        ((params->api == UCX_PERF_API_UCT) && (params->ep_count > 1))) {
+        if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+            ucs_error("Invalid number of endpoints per peer: %u (UCT tests "
+                      "support only one)", params->ep_count);
+        }
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if ((params->api == UCX_PERF_API_UCP) &&
+        (params->command == UCX_PERF_CMD_TAG_BATCH) &&
+        ((params->ucp.batch_size < 1) ||
+         (params->ucp.send_datatype != UCP_PERF_DATATYPE_CONTIG))) {
+        if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+            ucs_error("Batched sends need at least 1 message per batch and "
+                      "contiguous send datatype");
+        }
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if ((params->flags & UCX_PERF_TEST_FLAG_THREAD_WORKER) &&
+        (params->api != UCX_PERF_API_UCP)) {
+        if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+            ucs_error("Per-thread workers are supported only by UCP tests");
+        }
+        return UCS_ERR_INVALID_PARAM;
+    }
+
     /* check if particular message size fit into stride size */
     if (params->iov_stride) {
         for (it = 0; it < params->msg_size_cnt; ++it) {
@@ -943,6 +1058,7 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
         break;
     case UCX_PERF_CMD_TAG:
     case UCX_PERF_CMD_TAG_SYNC:
+    case UCX_PERF_CMD_TAG_BATCH:
         ucp_params->features    |= UCP_FEATURE_TAG;
         ucp_params->field_mask  |= UCP_PARAM_FIELD_REQUEST_SIZE;
         ucp_params->request_size = sizeof(ucp_perf_request_t);
@@ -959,6 +1075,12 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
         return UCS_ERR_INVALID_PARAM;
     }
 
+    if (params->flags & UCX_PERF_TEST_FLAG_THREAD_WORKER) {
+        /* the context is shared by workers of different threads */
+        ucp_params->field_mask       |= UCP_PARAM_FIELD_MT_WORKERS_SHARED;
+        ucp_params->mt_workers_shared = 1;
+    }
+
     status = ucx_perf_test_check_params(params);
     if (status != UCS_OK) {
         return status;
@@ -1104,23 +1226,30 @@ static void ucp_perf_test_free_mem(ucx_perf_context_t *perf)
 static void ucp_perf_test_destroy_eps(ucx_perf_context_t* perf,
                                       unsigned group_size)
 {
+    unsigned            ep_count = perf->params.ep_count;
     ucs_status_ptr_t    *reqs;
     ucp_tag_recv_info_t info;
     ucs_status_t        status;
-    unsigned i;
+    unsigned i, j;
 
-    reqs = calloc(sizeof(*reqs), group_size);
+    reqs = calloc(sizeof(*reqs), group_size * ep_count);
 
     for (i = 0; i < group_size; ++i) {
-        if (perf->ucp.peers[i].rkey != NULL) {
-            ucp_rkey_destroy(perf->ucp.peers[i].rkey);
+        if (perf->ucp.peers[i].eps == NULL) {
+            continue;
         }
-        if (perf->ucp.peers[i].ep != NULL) {
-            reqs[i] = ucp_disconnect_nb(perf->ucp.peers[i].ep);
+        for (j = 0; j < ep_count; ++j) {
+            if (perf->ucp.peers[i].eps[j].rkey != NULL) {
+                ucp_rkey_destroy(perf->ucp.peers[i].eps[j].rkey);
+            }
+            if (perf->ucp.peers[i].eps[j].ep != NULL) {
+                reqs[(i * ep_count) + j] =
+                        ucp_disconnect_nb(perf->ucp.peers[i].eps[j].ep);
+            }
         }
     }
 
-    for (i = 0; i < group_size; ++i) {
+    for (i = 0; i < group_size * ep_count; ++i) {
         if (!UCS_PTR_IS_PTR(reqs[i])) {
             continue;
         }
@@ -1132,6 +1261,10 @@ static void ucp_perf_test_destroy_eps(ucx_perf_context_t* perf,
         ucp_request_release(reqs[i]);
     }
 
+    for (i = 0; i < group_size; ++i) {
+        free(perf->ucp.peers[i].eps);
+    }
+
     free(reqs);
     free(perf->ucp.peers);
 }
@@ -1173,6 +1306,7 @@ static ucs_status_t ucp_perf_test_setup_endpoints(ucx_perf_context_t *perf,
     void *rkey_buffer;
     void *req = NULL;
     void *buffer;
+    unsigned j;
 
     group_size  = rte_call(perf, group_size);
     group_index = rte_call(perf, group_index);
@@ -1243,25 +1377,40 @@ static ucs_status_t ucp_perf_test_setup_endpoints(ucx_perf_context_t *perf,
         ep_params.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
         ep_params.address    = address;
 
-        status = ucp_ep_create(perf->ucp.worker, &ep_params, &perf->ucp.peers[i].ep);
-        if (status != UCS_OK) {
-            if (perf->params.flags & UCX_PERF_TEST_FLAG_VERBOSE) {
-                ucs_error("ucp_ep_create() failed: %s", ucs_status_string(status));
-            }
+        perf->ucp.peers[i].eps = calloc(perf->params.ep_count,
+                                        sizeof(*perf->ucp.peers[i].eps));
+        if (perf->ucp.peers[i].eps == NULL) {
+            status = UCS_ERR_NO_MEMORY;
             goto err_free_buffer;
         }
 
-        if (remote_info->rkey_size > 0) {
-            status = ucp_ep_rkey_unpack(perf->ucp.peers[i].ep, rkey_buffer,
-                                        &perf->ucp.peers[i].rkey);
+        /* Both sides create the endpoints in the same order, so the j-th
+         * endpoint is connected to the j-th endpoint of the peer. The remote
+         * key is unpacked on every endpoint, since resolving it also resolves
+         * the destination endpoint used by software RMA. */
+        for (j = 0; j < perf->params.ep_count; ++j) {
+            status = ucp_ep_create(perf->ucp.worker, &ep_params,
+                                   &perf->ucp.peers[i].eps[j].ep);
             if (status != UCS_OK) {
                 if (perf->params.flags & UCX_PERF_TEST_FLAG_VERBOSE) {
-                    ucs_fatal("ucp_rkey_unpack() failed: %s", ucs_status_string(status));
+                    ucs_error("ucp_ep_create() failed: %s", ucs_status_string(status));
                 }
                 goto err_free_buffer;
             }
-        } else {
-            perf->ucp.peers[i].rkey = NULL;
+
+            if (remote_info->rkey_size > 0) {
+                status = ucp_ep_rkey_unpack(perf->ucp.peers[i].eps[j].ep,
+                                            rkey_buffer,
+                                            &perf->ucp.peers[i].eps[j].rkey);
+                if (status != UCS_OK) {
+                    if (perf->params.flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+                        ucs_fatal("ucp_rkey_unpack() failed: %s", ucs_status_string(status));
+                    }
+                    goto err_free_buffer;
+                }
+            } else {
+                perf->ucp.peers[i].eps[j].rkey = NULL;
+            }
         }
     }
 
@@ -1300,6 +1449,101 @@ static void ucp_perf_test_cleanup_endpoints(ucx_perf_context_t *perf)
     ucp_perf_test_destroy_eps(perf, group_size);
 }
 
+static ucs_thread_mode_t ucp_perf_test_worker_thread_mode(ucx_perf_context_t *perf)
+{
+    /* A per-thread worker is never accessed concurrently */
+    return (perf->params.flags & UCX_PERF_TEST_FLAG_THREAD_WORKER) ?
+           UCS_THREAD_MODE_SINGLE : perf->params.thread_mode;
+}
+
+/*
+ * Destroy the workers of threads 1..count-1 and their endpoints. Thread 0
+ * uses the main worker, which is released by the caller.
+ */
+static void ucp_perf_test_destroy_thread_workers(ucx_perf_context_t *perf,
+                                                 unsigned count)
+{
+    ucp_worker_h main_worker = perf->ucp.worker;
+    ucp_peer_t   *main_peers = perf->ucp.peers;
+    unsigned group_size, i;
+
+    group_size = rte_call(perf, group_size);
+
+    for (i = 1; i < count; ++i) {
+        perf->ucp.worker = perf->ucp.thread_workers[i];
+        perf->ucp.peers  = perf->ucp.thread_peers[i];
+        ucp_perf_test_destroy_eps(perf, group_size);
+        ucp_worker_destroy(perf->ucp.worker);
+    }
+
+    perf->ucp.worker = main_worker;
+    perf->ucp.peers  = main_peers;
+
+    free(perf->ucp.thread_peers);
+    free(perf->ucp.thread_workers);
+    perf->ucp.thread_peers   = NULL;
+    perf->ucp.thread_workers = NULL;
+}
+
+/*
+ * Create a worker for every additional thread and connect it to the worker of
+ * the same thread on the peer. The addresses are exchanged one worker at a
+ * time, since the RTE is used only by the main thread.
+ */
+static ucs_status_t ucp_perf_test_setup_thread_workers(ucx_perf_context_t *perf,
+                                                       uint64_t features)
+{
+    unsigned thread_count    = perf->params.thread_count;
+    ucp_worker_h main_worker = perf->ucp.worker;
+    ucp_peer_t   *main_peers = perf->ucp.peers;
+    ucp_worker_params_t worker_params;
+    ucs_status_t status;
+    unsigned i;
+
+    perf->ucp.thread_workers = calloc(thread_count,
+                                      sizeof(*perf->ucp.thread_workers));
+    perf->ucp.thread_peers   = calloc(thread_count,
+                                      sizeof(*perf->ucp.thread_peers));
+    if ((perf->ucp.thread_workers == NULL) || (perf->ucp.thread_peers == NULL)) {
+        i      = 1;
+        status = UCS_ERR_NO_MEMORY;
+        goto err;
+    }
+
+    perf->ucp.thread_workers[0] = main_worker;
+    perf->ucp.thread_peers[0]   = main_peers;
+
+    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+    worker_params.thread_mode = ucp_perf_test_worker_thread_mode(perf);
+
+    for (i = 1; i < thread_count; ++i) {
+        status = ucp_worker_create(perf->ucp.context, &worker_params,
+                                   &perf->ucp.worker);
+        if (status != UCS_OK) {
+            goto err;
+        }
+
+        status = ucp_perf_test_setup_endpoints(perf, features);
+        if (status != UCS_OK) {
+            ucp_worker_destroy(perf->ucp.worker);
+            goto err;
+        }
+
+        perf->ucp.thread_workers[i] = perf->ucp.worker;
+        perf->ucp.thread_peers[i]   = perf->ucp.peers;
+    }
+
+    perf->ucp.worker = main_worker;
+    perf->ucp.peers  = main_peers;
+    return UCS_OK;
+
+err:
+    perf->ucp.worker = main_worker;
+    perf->ucp.peers  = main_peers;
+    ucp_perf_test_destroy_thread_workers(perf, i);
+    return status;
+}
+
 static void ucx_perf_set_warmup(ucx_perf_context_t* perf, ucx_perf_params_t* params)
 {
     perf->max_iter = ucs_min(params->warmup_iter, ucs_div_round_up(params->max_iter, 10));
@@ -1398,10 +1642,30 @@ void uct_perf_barrier(ucx_perf_context_t *perf)
              (void*)perf->uct.worker);
 }
 
+/*
+ * With per-thread workers, the barrier has to progress the workers of all
+ * threads: a peer thread may still be waiting for a software RMA completion
+ * from a worker whose thread already reached the barrier. Only the master
+ * thread calls it, while the others are blocked in the barrier.
+ */
+static void ucp_perf_thread_workers_progress(void *arg)
+{
+    ucx_perf_context_t *perf = arg;
+    unsigned i;
+
+    for (i = 0; i < perf->params.thread_count; ++i) {
+        ucp_worker_progress(perf->ucp.thread_workers[i]);
+    }
+}
+
 void ucp_perf_barrier(ucx_perf_context_t *perf)
 {
-    rte_call(perf, barrier, (void(*)(void*))ucp_worker_progress,
-             (void*)perf->ucp.worker);
+    if (perf->ucp.thread_workers != NULL) {
+        rte_call(perf, barrier, ucp_perf_thread_workers_progress, perf);
+    } else {
+        rte_call(perf, barrier, (void(*)(void*))ucp_worker_progress,
+                 (void*)perf->ucp.worker);
+    }
 }
 
 static ucs_status_t uct_perf_setup(ucx_perf_context_t *perf)
@@ -1531,7 +1795,7 @@ static ucs_status_t ucp_perf_setup(ucx_perf_context_t *perf)
     }
 
     worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
-    worker_params.thread_mode = perf->params.thread_mode;
+    worker_params.thread_mode = ucp_perf_test_worker_thread_mode(perf);
 
     status = ucp_worker_create(perf->ucp.context, &worker_params,
                                &perf->ucp.worker);
@@ -1539,6 +1803,9 @@ static ucs_status_t ucp_perf_setup(ucx_perf_context_t *perf)
         goto err_cleanup;
     }
 
+    perf->ucp.thread_workers = NULL;
+    perf->ucp.thread_peers   = NULL;
+
     status = ucp_perf_test_alloc_mem(perf);
     if (status != UCS_OK) {
         ucs_warn("ucp test failed to alocate memory");
@@ -1553,8 +1820,22 @@ static ucs_status_t ucp_perf_setup(ucx_perf_context_t *perf)
         goto err_free_mem;
     }
 
+    if ((perf->params.flags & UCX_PERF_TEST_FLAG_THREAD_WORKER) &&
+        (perf->params.thread_count > 1)) {
+        status = ucp_perf_test_setup_thread_workers(perf, ucp_params.features);
+        if (status != UCS_OK) {
+            if (perf->params.flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+                ucs_error("Failed to setup per-thread workers: %s",
+                          ucs_status_string(status));
+            }
+            goto err_cleanup_endpoints;
+        }
+    }
+
     return UCS_OK;
 
+err_cleanup_endpoints:
+    ucp_perf_test_destroy_eps(perf, rte_call(perf, group_size));
 err_free_mem:
     ucp_perf_test_free_mem(perf);
 err_destroy_worker:
@@ -1568,6 +1849,9 @@ err:
 static void ucp_perf_cleanup(ucx_perf_context_t *perf)
 {
     ucp_perf_test_cleanup_endpoints(perf);
+    if (perf->ucp.thread_workers != NULL) {
+        ucp_perf_test_destroy_thread_workers(perf, perf->params.thread_count);
+    }
     ucp_perf_barrier(perf);
     ucp_perf_test_free_mem(perf);
     ucp_worker_destroy(perf->ucp.worker);
@@ -1717,18 +2001,70 @@ static void* ucx_perf_thread_run_test(void* arg)
             goto out;
         }
     }
-#pragma omp master
-    {
-        /* Assuming all threads are fairly treated, reporting only tid==0
-            TODO: aggregate reports */
-        ucx_perf_calc_result(perf, result);
-        rte_call(perf, report, result, perf->params.report_arg, 1);
-    }
+
+    /* The results of all threads are reported together by the caller */
+    ucx_perf_calc_result(perf, result);
 
 out:
     return &statuses[tid];
 }
 
+/*
+ * Combine the results of the threads: message rate, bandwidth and operation
+ * counts are summed, latency is averaged. Latency percentiles are taken from
+ * the merged histograms, and CPU time is measured for the whole process.
+ */
+static void ucx_perf_thread_calc_result(ucx_perf_thread_context_t *tctx,
+                                        int nti, ucx_perf_result_t *result)
+{
+    ucx_perf_context_t *perf = &tctx[0].perf;
+    const ucx_perf_result_t *tres;
+    uint64_t hist[UCX_PERF_HIST_SIZE];
+    ucs_time_t hist_max;
+    unsigned i;
+    int ti;
+
+    memset(result, 0, sizeof(*result));
+    for (ti = 0; ti < nti; ti++) {
+        tres = &tctx[ti].result;
+
+        result->iters                    += tres->iters;
+        result->bytes                    += tres->bytes;
+        result->msgs                     += tres->msgs;
+        result->cpu.time                  = ucs_max(result->cpu.time,
+                                                    tres->cpu.time);
+        result->elapsed_time              = ucs_max(result->elapsed_time,
+                                                    tres->elapsed_time);
+        result->latency.typical          += tres->latency.typical / nti;
+        result->latency.moment_average   += tres->latency.moment_average / nti;
+        result->latency.total_average    += tres->latency.total_average / nti;
+        result->bandwidth.typical        += tres->bandwidth.typical;
+        result->bandwidth.moment_average += tres->bandwidth.moment_average;
+        result->bandwidth.total_average  += tres->bandwidth.total_average;
+        result->msgrate.typical          += tres->msgrate.typical;
+        result->msgrate.moment_average   += tres->msgrate.moment_average;
+        result->msgrate.total_average    += tres->msgrate.total_average;
+    }
+
+    ucx_perf_calc_cpu_result(result->cpu.time, result->elapsed_time, result);
+
+    if (!(perf->params.flags & UCX_PERF_TEST_FLAG_LAT_HISTOGRAM)) {
+        return;
+    }
+
+    memset(hist, 0, sizeof(hist));
+    hist_max = 0;
+    for (ti = 0; ti < nti; ti++) {
+        for (i = 0; i < UCX_PERF_HIST_SIZE; ++i) {
+            hist[i] += tctx[ti].perf.lat_hist[i];
+        }
+        hist_max = ucs_max(hist_max, tctx[ti].perf.lat_hist_max);
+    }
+
+    ucx_perf_calc_hist_result(hist, hist_max, ucx_perf_latency_factor(perf),
+                              result);
+}
+
 static ucs_status_t ucx_perf_thread_spawn(ucx_perf_context_t *perf,
                                           ucx_perf_result_t* result)
 {
@@ -1762,6 +2098,11 @@ static ucs_status_t ucx_perf_thread_spawn(ucx_perf_context_t *perf,
     tctx[ti].perf.recv_buffer = UCS_PTR_BYTE_OFFSET(tctx[ti].perf.recv_buffer,
                                                     ti * message_size);
     tctx[ti].perf.offset = ti * message_size;
+    if ((perf->params.api == UCX_PERF_API_UCP) &&
+        (perf->ucp.thread_workers != NULL)) {
+        tctx[ti].perf.ucp.worker = perf->ucp.thread_workers[ti];
+        tctx[ti].perf.ucp.peers  = perf->ucp.thread_peers[ti];
+    }
     ucx_perf_thread_run_test((void*)&tctx[ti]);
 }
 
@@ -1774,6 +2115,11 @@ static ucs_status_t ucx_perf_thread_spawn(ucx_perf_context_t *perf,
         }
     }
 
+    if (status == UCS_OK) {
+        ucx_perf_thread_calc_result(tctx, nti, result);
+        rte_call(&tctx[0].perf, report, result, perf->params.report_arg, 1);
+    }
+
 out_free:
     free(statuses);
     free(tctx);
@@ -15,8 +15,10 @@ BEGIN_C_DECLS
 
 /** @file libperf_int.h */
 
+#include <ucs/arch/bitops.h>
 #include <ucs/time/time.h>
 #include <ucs/async/async.h>
+#include <time.h>
 
 #if _OPENMP
 #include <omp.h>
@@ -26,9 +28,19 @@ BEGIN_C_DECLS
 #define TIMING_QUEUE_SIZE    2048
 #define UCT_PERF_TEST_AM_ID  5
 
+/*
+ * Latency histogram: log-linear buckets, every power of 2 is split into
+ * UCX_PERF_HIST_SUB_COUNT linear sub-buckets (~6% relative error).
+ */
+#define UCX_PERF_HIST_SUB_BITS   4
+#define UCX_PERF_HIST_SUB_COUNT  UCS_BIT(UCX_PERF_HIST_SUB_BITS)
+#define UCX_PERF_HIST_SIZE       ((64 - UCX_PERF_HIST_SUB_BITS + 1) * \
+                                  UCX_PERF_HIST_SUB_COUNT)
+
 
 typedef struct ucx_perf_context  ucx_perf_context_t;
 typedef struct uct_peer          uct_peer_t;
+typedef struct ucp_peer_ep       ucp_peer_ep_t;
 typedef struct ucp_peer          ucp_peer_t;
 typedef struct ucp_perf_request  ucp_perf_request_t;
 
@@ -72,10 +84,16 @@ struct ucx_perf_context {
         ucx_perf_counter_t       iters;   /* number of iterations */
         ucs_time_t               time;    /* inaccurate time (for median and report interval) */
         double                   time_acc; /* accurate time (for avg latency/bw/msgrate) */
+        double                   cpu_time; /* CPU time of the process */
     } current, prev;
 
     ucs_time_t                   timing_queue[TIMING_QUEUE_SIZE];
     unsigned                     timing_queue_head;
+    double                       start_cpu_time;  /* CPU time of the process at start */
+
+    /* Per-operation latency histogram, if UCX_PERF_TEST_FLAG_LAT_HISTOGRAM */
+    uint64_t                     lat_hist[UCX_PERF_HIST_SIZE];
+    ucs_time_t                   lat_hist_max;
     const ucx_perf_allocator_t   *allocator;
 
     union {
@@ -99,6 +117,8 @@ struct ucx_perf_context {
             ucp_mem_h            recv_memh;
             ucp_dt_iov_t         *send_iov;
             ucp_dt_iov_t         *recv_iov;
+            ucp_worker_h         *thread_workers; /* Per-thread workers and their */
+            ucp_peer_t           **thread_peers;  /* peers, NULL if shared */
         } ucp;
     };
 };
@@ -111,10 +131,15 @@ struct uct_peer {
 };
 
 
-struct ucp_peer {
+struct ucp_peer_ep {
     ucp_ep_h                     ep;
+    ucp_rkey_h                   rkey;        /* unpacked on this endpoint */
+};
+
+
+struct ucp_peer {
+    ucp_peer_ep_t                *eps;        /* params.ep_count endpoints */
     unsigned long                remote_addr;
-    ucp_rkey_h                   rkey;
 };
 
 
@@ -158,28 +183,66 @@ static UCS_F_ALWAYS_INLINE int ucx_perf_context_done(ucx_perf_context_t *perf)
 }
 
 
+/* CPU time consumed by all threads of the process, in seconds */
+static inline double ucx_perf_get_cpu_time()
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+        return 0.0;
+    }
+
+    return ts.tv_sec + (ts.tv_nsec * 1e-9);
+}
+
 static inline void ucx_perf_get_time(ucx_perf_context_t *perf)
 {
     perf->current.time_acc = ucs_get_accurate_time();
+    perf->current.cpu_time = ucx_perf_get_cpu_time();
+}
+
+static inline unsigned ucx_perf_hist_index(ucs_time_t value)
+{
+    unsigned exp;
+
+    if (value < UCX_PERF_HIST_SUB_COUNT) {
+        return value;
+    }
+
+    exp = ucs_ilog2(value);
+    return ((exp - UCX_PERF_HIST_SUB_BITS + 1) * UCX_PERF_HIST_SUB_COUNT) +
+           ((value >> (exp - UCX_PERF_HIST_SUB_BITS)) &
+            (UCX_PERF_HIST_SUB_COUNT - 1));
+}
+
+static inline void ucx_perf_hist_add(ucx_perf_context_t *perf, ucs_time_t value)
+{
+    ++perf->lat_hist[ucx_perf_hist_index(value)];
+    perf->lat_hist_max = ucs_max(perf->lat_hist_max, value);
 }
 
 static inline void ucx_perf_update(ucx_perf_context_t *perf,
                                    ucx_perf_counter_t iters, size_t bytes)
 {
     ucx_perf_result_t result;
+    ucs_time_t delta;
 
     perf->current.time   = ucs_get_time();
     perf->current.iters += iters;
     perf->current.bytes += bytes;
     perf->current.msgs  += 1;
 
-    perf->timing_queue[perf->timing_queue_head] =
-                    perf->current.time - perf->prev_time;
+    delta = perf->current.time - perf->prev_time;
+    perf->timing_queue[perf->timing_queue_head] = delta;
     ++perf->timing_queue_head;
     if (perf->timing_queue_head == TIMING_QUEUE_SIZE) {
         perf->timing_queue_head = 0;
     }
 
+    if (perf->params.flags & UCX_PERF_TEST_FLAG_LAT_HISTOGRAM) {
+        ucx_perf_hist_add(perf, delta);
+    }
+
     perf->prev_time = perf->current.time;
 
     if (perf->current.time - perf->prev.time >= perf->report_interval) {
@@ -10,6 +10,7 @@
 
 extern "C" {
 #include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/sys.h>
 }
@@ -30,10 +31,23 @@ public:
     ucp_perf_test_runner(ucx_perf_context_t &perf) :
         m_perf(perf),
         m_outstanding(0),
-        m_max_outstanding(m_perf.params.max_outstanding)
-
+        m_max_outstanding(m_perf.params.max_outstanding),
+        m_batch(NULL),
+        m_batch_count(0),
+        m_yield(is_oversubscribed(m_perf.params))
     {
         ucs_assert_always(m_max_outstanding > 0);
+        if (CMD == UCX_PERF_CMD_TAG_BATCH) {
+            m_batch = (ucp_send_batch_elem_t*)
+                      ucs_malloc(sizeof(*m_batch) * m_perf.params.ucp.batch_size,
+                                 "ucp_perf_send_batch");
+            ucs_assert_always(m_batch != NULL);
+        }
+    }
+
+    ~ucp_perf_test_runner()
+    {
+        ucs_free(m_batch);
     }
 
     void create_iov_buffer(ucp_dt_iov_t *iov, void *buffer)
@@ -82,16 +96,38 @@ public:
         }
     }
 
+    /*
+     * More test threads than CPUs: a thread which polls without making
+     * progress would otherwise use up the time slices of the threads it is
+     * waiting for.
+     */
+    static bool is_oversubscribed(const ucx_perf_params_t &params)
+    {
+        ucs_sys_cpuset_t cpuset;
+
+        if ((params.thread_count <= 1) || (ucs_sys_getaffinity(&cpuset) != 0)) {
+            return false;
+        }
+
+        return params.thread_count > (unsigned)CPU_COUNT(&cpuset);
+    }
+
+    void UCS_F_ALWAYS_INLINE progress() {
+        if (!ucp_worker_progress(m_perf.ucp.worker) && m_yield) {
+            sched_yield();
+        }
+    }
+
     void UCS_F_ALWAYS_INLINE progress_responder() {
         if (!(FLAGS & UCX_PERF_TEST_FLAG_ONE_SIDED) &&
             !(m_perf.params.flags & UCX_PERF_TEST_FLAG_ONE_SIDED))
         {
-            ucp_worker_progress(m_perf.ucp.worker);
+            progress();
         }
     }
 
     void UCS_F_ALWAYS_INLINE progress_requestor() {
-        ucp_worker_progress(m_perf.ucp.worker);
+        progress();
     }
 
     ucs_status_t UCS_F_ALWAYS_INLINE wait(void *request, bool is_requestor)
@@ -136,6 +172,17 @@ public:
         ucp_request_release(request);
     }
 
+    /* Operations are spread round-robin over all endpoints to the peer */
+    void UCS_F_ALWAYS_INLINE next_ep(const ucp_peer_t *peer, unsigned *ep_index,
+                                     ucp_ep_h *ep, ucp_rkey_h *rkey)
+    {
+        if (++(*ep_index) == m_perf.params.ep_count) {
+            *ep_index = 0;
+        }
+        *ep   = peer->eps[*ep_index].ep;
+        *rkey = peer->eps[*ep_index].rkey;
+    }
+
     void UCS_F_ALWAYS_INLINE wait_window(unsigned n)
     {
         while (m_outstanding >= (m_max_outstanding - n + 1)) {
@@ -143,6 +190,26 @@ public:
         }
     }
 
+    /* Post all messages collected since the previous batched send */
+    ucs_status_t UCS_F_ALWAYS_INLINE send_batch()
+    {
+        void *request;
+
+        if (m_batch_count == 0) {
+            return UCS_OK;
+        }
+
+        wait_window(1);
+        request       = ucp_tag_send_batch_nb(m_batch, m_batch_count, send_cb);
+        m_batch_count = 0;
+        if (ucs_likely(!UCS_PTR_IS_PTR(request))) {
+            return UCS_PTR_STATUS(request);
+        }
+        reinterpret_cast<ucp_perf_request_t*>(request)->context = this;
+        send_started();
+        return UCS_OK;
+    }
+
     ucs_status_t UCS_F_ALWAYS_INLINE
     send(ucp_ep_h ep, void *buffer, unsigned length, ucp_datatype_t datatype,
          uint8_t sn, uint64_t remote_addr, ucp_rkey_h rkey)
@@ -179,6 +246,16 @@ public:
             reinterpret_cast<ucp_perf_request_t*>(request)->context = this;
             send_started();
             return UCS_OK;
+        case UCX_PERF_CMD_TAG_BATCH:
+            m_batch[m_batch_count].ep     = ep;
+            m_batch[m_batch_count].buffer = buffer;
+            m_batch[m_batch_count].length = length;
+            m_batch[m_batch_count].tag    = TAG;
+            m_batch[m_batch_count].am_id  = 0;
+            if (++m_batch_count < m_perf.params.ucp.batch_size) {
+                return UCS_OK;
+            }
+            return send_batch();
         case UCX_PERF_CMD_PUT:
             *((uint8_t*)buffer + length - 1) = sn;
             return ucp_put(ep, buffer, length, remote_addr, rkey);
@@ -232,6 +309,7 @@ public:
         switch (CMD) {
         case UCX_PERF_CMD_TAG:
         case UCX_PERF_CMD_TAG_SYNC:
+        case UCX_PERF_CMD_TAG_BATCH:
             if (FLAGS & UCX_PERF_TEST_FLAG_TAG_UNEXP_PROBE) {
                 ucp_tag_recv_info_t tag_info;
                 while (ucp_tag_probe_nb(worker, TAG, TAG_MASK, 0, &tag_info) == NULL) {
@@ -282,8 +360,9 @@ public:
     ucs_status_t run_pingpong()
     {
         const psn_t unknown_psn = std::numeric_limits<psn_t>::max();
-        unsigned my_index;
+        unsigned my_index, ep_index;
         ucp_worker_h worker;
+        const ucp_peer_t *peer;
         ucp_ep_h ep;
         void *send_buffer, *recv_buffer;
         ucp_datatype_t send_datatype, recv_datatype;
@@ -313,9 +392,11 @@ public:
         send_buffer   = m_perf.send_buffer;
         recv_buffer   = m_perf.recv_buffer;
         worker        = m_perf.ucp.worker;
-        ep            = m_perf.ucp.peers[1 - my_index].ep;
-        remote_addr   = m_perf.ucp.peers[1 - my_index].remote_addr + m_perf.offset;
-        rkey          = m_perf.ucp.peers[1 - my_index].rkey;
+        peer          = &m_perf.ucp.peers[1 - my_index];
+        ep_index      = 0;
+        ep            = peer->eps[ep_index].ep;
+        remote_addr   = peer->remote_addr + m_perf.offset;
+        rkey          = peer->eps[ep_index].rkey;
         sn            = 0;
         send_length   = length;
         recv_length   = length;
@@ -331,6 +412,7 @@ public:
                 send(ep, send_buffer, send_length, send_datatype, sn, remote_addr, rkey);
                 recv(worker, ep, recv_buffer, recv_length, recv_datatype, sn);
                 ucx_perf_update(&m_perf, 1, length);
+                next_ep(peer, &ep_index, &ep, &rkey);
                 ++sn;
             }
         } else if (my_index == 1) {
@@ -338,6 +420,7 @@ public:
                 recv(worker, ep, recv_buffer, recv_length, recv_datatype, sn);
                 send(ep, send_buffer, send_length, send_datatype, sn, remote_addr, rkey);
                 ucx_perf_update(&m_perf, 1, length);
+                next_ep(peer, &ep_index, &ep, &rkey);
                 ++sn;
             }
         }
@@ -351,8 +434,9 @@ public:
 
     ucs_status_t run_stream_uni()
     {
-        unsigned my_index;
+        unsigned my_index, ep_index;
         ucp_worker_h worker;
+        const ucp_peer_t *peer;
         ucp_ep_h ep;
         void *send_buffer, *recv_buffer;
         ucp_datatype_t send_datatype, recv_datatype;
@@ -375,9 +459,11 @@ public:
         send_buffer   = m_perf.send_buffer;
         recv_buffer   = m_perf.recv_buffer;
         worker        = m_perf.ucp.worker;
-        ep            = m_perf.ucp.peers[1 - my_index].ep;
-        remote_addr   = m_perf.ucp.peers[1 - my_index].remote_addr + m_perf.offset;
-        rkey          = m_perf.ucp.peers[1 - my_index].rkey;
+        peer          = &m_perf.ucp.peers[1 - my_index];
+        ep_index      = 0;
+        ep            = peer->eps[ep_index].ep;
+        remote_addr   = peer->remote_addr + m_perf.offset;
+        rkey          = peer->eps[ep_index].rkey;
         sn            = 0;
         send_length   = length;
         recv_length   = length;
@@ -392,6 +478,7 @@ public:
             UCX_PERF_TEST_FOREACH(&m_perf) {
                 recv(worker, ep, recv_buffer, recv_length, recv_datatype, sn);
                 ucx_perf_update(&m_perf, 1, length);
+                next_ep(peer, &ep_index, &ep, &rkey);
                 ++sn;
             }
         } else if (my_index == 1) {
@@ -399,8 +486,10 @@ public:
                 send(ep, send_buffer, send_length, send_datatype, sn,
                      remote_addr, rkey);
                 ucx_perf_update(&m_perf, 1, length);
+                next_ep(peer, &ep_index, &ep, &rkey);
                 ++sn;
             }
+            send_batch();
         }
 
         wait_window(m_max_outstanding);
@@ -457,7 +546,7 @@ private:
             rreq = ucp_stream_recv_nb(ep, (char *)buf + total, length - total,
                                       datatype,
                                       (ucp_stream_recv_callback_t)ucs_empty_function,
-                                      &rlength, 0);
+                                      &rlength, UCP_STREAM_RECV_FLAG_WAITALL);
             if (ucs_likely(rreq == NULL)) {
                 total += rlength;
             } else if (UCS_PTR_IS_PTR(rreq)) {
@@ -484,9 +573,12 @@ private:
         --m_outstanding;
     }
 
-    ucx_perf_context_t &m_perf;
-    unsigned           m_outstanding;
-    const unsigned     m_max_outstanding;
+    ucx_perf_context_t    &m_perf;
+    unsigned              m_outstanding;
+    const unsigned        m_max_outstanding;
+    ucp_send_batch_elem_t *m_batch;       /* Messages of the next batched send */
+    unsigned              m_batch_count;
+    const bool            m_yield;        /* Yield the CPU when idle */
 };
 
 
@@ -543,7 +635,8 @@ ucs_status_t ucp_perf_test_dispatch(ucx_perf_context_t *perf)
         (UCX_PERF_CMD_TAG,      UCX_PERF_TEST_TYPE_PINGPONG),
         (UCX_PERF_CMD_TAG,      UCX_PERF_TEST_TYPE_STREAM_UNI),
         (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_PINGPONG),
-        (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI)
+        (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI),
+        (UCX_PERF_CMD_TAG_BATCH, UCX_PERF_TEST_TYPE_STREAM_UNI)
         );
 
     UCS_PP_FOREACH(TEST_CASE_ALL_STREAM, perf,
@@ -39,7 +39,7 @@
 
 #define MAX_BATCH_FILES         32
 #define TL_RESOURCE_NAME_NONE   "<none>"
-#define TEST_PARAMS_ARGS        "t:n:s:W:O:w:D:i:H:oSCqM:r:T:d:x:A:BUm:"
+#define TEST_PARAMS_ARGS        "t:n:s:W:O:w:D:i:H:oSCqM:r:T:d:x:A:BUm:E:eg:"
 
 
 enum {
@@ -48,7 +48,8 @@ enum {
     TEST_FLAG_SET_AFFINITY  = UCS_BIT(8),
     TEST_FLAG_NUMERIC_FMT   = UCS_BIT(9),
     TEST_FLAG_PRINT_FINAL   = UCS_BIT(10),
-    TEST_FLAG_PRINT_CSV     = UCS_BIT(11)
+    TEST_FLAG_PRINT_CSV     = UCS_BIT(11),
+    TEST_FLAG_PRINT_LAT_CPU = UCS_BIT(12)
 };
 
 typedef struct sock_rte_group {
@@ -125,6 +126,9 @@ test_type_t tests[] = {
     {"tag_sync_bw", UCX_PERF_API_UCP, UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI,
      "tag sync match bandwidth"},
 
+    {"tag_batch_mr", UCX_PERF_API_UCP, UCX_PERF_CMD_TAG_BATCH, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "tag match message rate with batched sends"},
+
     {"ucp_put_lat", UCX_PERF_API_UCP, UCX_PERF_CMD_PUT, UCX_PERF_TEST_TYPE_PINGPONG,
      "put latency"},
 
@@ -210,9 +214,17 @@ static void print_progress(char **test_names, unsigned num_names,
                            const ucx_perf_result_t *result, unsigned flags,
                            int final)
 {
-    static const char *fmt_csv     =  "%.0f,%.3f,%.3f,%.3f,%.2f,%.2f,%.0f,%.0f\n";
-    static const char *fmt_numeric =  "%'14.0f %9.3f %9.3f %9.3f %10.2f %10.2f %'11.0f %'11.0f\n";
-    static const char *fmt_plain   =  "%14.0f %9.3f %9.3f %9.3f %10.2f %10.2f %11.0f %11.0f\n";
+    static const char *fmt_csv     =  "%.0f,%.3f,%.3f,%.3f,%.2f,%.2f,%.0f,%.0f";
+    static const char *fmt_numeric =  "%'14.0f %9.3f %9.3f %9.3f %10.2f %10.2f %'11.0f %'11.0f";
+    static const char *fmt_plain   =  "%14.0f %9.3f %9.3f %9.3f %10.2f %10.2f %11.0f %11.0f";
+    static const char *percentile_names[] = {
+        [UCX_PERF_PERCENTILE_50]    = "50%",
+        [UCX_PERF_PERCENTILE_90]    = "90%",
+        [UCX_PERF_PERCENTILE_99]    = "99%",
+        [UCX_PERF_PERCENTILE_99_9]  = "99.9%",
+        [UCX_PERF_PERCENTILE_99_99] = "99.99%"
+    };
+    const double *percentile = result->latency_hist.percentile;
     unsigned i;
 
     if (!(flags & TEST_FLAG_PRINT_RESULTS) ||
@@ -238,6 +250,30 @@ static void print_progress(char **test_names, unsigned num_names,
            result->bandwidth.total_average / (1024.0 * 1024.0),
            result->msgrate.moment_average,
            result->msgrate.total_average);
+
+    if (!(flags & TEST_FLAG_PRINT_LAT_CPU)) {
+        printf("\n");
+    } else if (flags & TEST_FLAG_PRINT_CSV) {
+        /* CSV lines get the percentiles and CPU usage as extra columns */
+        for (i = 0; i < UCX_PERF_PERCENTILE_LAST; ++i) {
+            printf(",%.3f", percentile[i] * 1000000.0);
+        }
+        printf(",%.3f,%.4f,%.1f\n", result->latency_hist.max * 1000000.0,
+               result->cpu.per_msg * 1000000.0, result->cpu.utilization * 100.0);
+    } else {
+        printf("\n");
+        if (final) {
+            printf("  latency percentiles (usec):");
+            for (i = 0; i < UCX_PERF_PERCENTILE_LAST; ++i) {
+                printf(" %s %.3f", percentile_names[i],
+                       percentile[i] * 1000000.0);
+            }
+            printf(" max %.3f\n", result->latency_hist.max * 1000000.0);
+            printf("  cpu usage: %.4f usec/msg, %.1f%% of elapsed time\n",
+                   result->cpu.per_msg * 1000000.0,
+                   result->cpu.utilization * 100.0);
+        }
+    }
     fflush(stdout);
 }
 
@@ -293,7 +329,12 @@ static void print_header(struct perftest_context *ctx)
             for (i = 0; i < ctx->num_batch_files; ++i) {
                 printf("%s,", basename(ctx->batch_files[i]));
             }
-            printf("iterations,typical_lat,avg_lat,overall_lat,avg_bw,overall_bw,avg_mr,overall_mr\n");
+            printf("iterations,typical_lat,avg_lat,overall_lat,avg_bw,overall_bw,avg_mr,overall_mr");
+            if (ctx->flags & TEST_FLAG_PRINT_LAT_CPU) {
+                printf(",lat_p50,lat_p90,lat_p99,lat_p99.9,lat_p99.99,lat_max,"
+                       "cpu_per_msg,cpu_util");
+            }
+            printf("\n");
         }
     } else {
         if (ctx->flags & TEST_FLAG_PRINT_RESULTS) {
@@ -392,6 +433,8 @@ static void usage(const struct perftest_context *ctx, const char *program)
                                 ctx->params.iov_stride);
     printf("     -T <threads>   number of threads in the test (%d), if >1 implies \"-M multi\"\n",
                                 ctx->params.thread_count);
+    printf("                    the threads share one worker unless \"-e\" is given; the\n");
+    printf("                    reported rates are the sum over all threads\n");
     printf("     -B             register memory with NONBLOCK flag\n");
     printf("     -b <file>      read and execute tests from a batch file: every line in the\n");
     printf("                    file is a test to run, first word is test name, the rest of\n");
@@ -406,6 +449,8 @@ static void usage(const struct perftest_context *ctx, const char *program)
     printf("     -N             use numeric formatting (thousands separator)\n");
     printf("     -f             print only final numbers\n");
     printf("     -v             print CSV-formatted output\n");
+    printf("     -l             collect per-operation latency histogram, print latency\n");
+    printf("                    percentiles and CPU time per message\n");
     printf("\n");
     printf("  UCT only:\n");
     printf("     -d <device>    device to use for testing\n");
@@ -438,6 +483,11 @@ static void usage(const struct perftest_context *ctx, const char *program)
     printf("     -r <mode>      receive mode for stream tests (recv)\n");
     printf("                        recv       : Use ucp_stream_recv_nb\n");
     printf("                        recv_data  : Use ucp_stream_recv_data_nb\n");
+    printf("     -E <count>     number of endpoints to the peer, operations are spread\n");
+    printf("                    over them round-robin (%u)\n", ctx->params.ep_count);
+    printf("     -e             with \"-T\", every thread uses its own worker\n");
+    printf("     -g <count>     number of messages passed to every batched send call\n");
+    printf("                    (%u)\n", ctx->params.ucp.batch_size);
     printf("\n");
     printf("   NOTE: When running UCP tests, transport and device should be specified by\n");
     printf("         environment variables: UCX_TLS and UCX_[SELF|SHM|NET]_DEVICES.\n");
@@ -549,6 +599,7 @@ static ucs_status_t init_test_params(ucx_perf_params_t *params)
     params->test_type         = UCX_PERF_TEST_TYPE_LAST;
     params->thread_mode       = UCS_THREAD_MODE_SINGLE;
     params->thread_count      = 1;
+    params->ep_count          = 1;
     params->async_mode        = UCS_ASYNC_THREAD_LOCK_TYPE;
     params->wait_mode         = UCX_PERF_WAIT_MODE_LAST;
     params->max_outstanding   = 1;
@@ -567,6 +618,7 @@ static ucs_status_t init_test_params(ucx_perf_params_t *params)
     params->iov_stride        = 0;
     params->ucp.send_datatype = UCP_PERF_DATATYPE_CONTIG;
     params->ucp.recv_datatype = UCP_PERF_DATATYPE_CONTIG;
+    params->ucp.batch_size    = 16;
     strcpy(params->uct.dev_name, TL_RESOURCE_NAME_NONE);
     strcpy(params->uct.tl_name,  TL_RESOURCE_NAME_NONE);
 
@@ -683,6 +735,15 @@ static ucs_status_t parse_test_params(ucx_perf_params_t *params, char opt, const
         params->thread_count = atoi(optarg);
         params->thread_mode = UCS_THREAD_MODE_MULTI;
         return UCS_OK;
+    case 'E':
+        params->ep_count = atoi(optarg);
+        return UCS_OK;
+    case 'e':
+        params->flags |= UCX_PERF_TEST_FLAG_THREAD_WORKER;
+        return UCS_OK;
+    case 'g':
+        params->ucp.batch_size = atoi(optarg);
+        return UCS_OK;
     case 'A':
         if (!strcmp(optarg, "thread") || !strcmp(optarg, "thread_spinlock")) {
             params->async_mode = UCS_ASYNC_MODE_THREAD_SPINLOCK;
@@ -782,7 +843,7 @@ static ucs_status_t parse_opts(struct perftest_context *ctx, int mpi_initialized
     ctx->mpi                    = mpi_initialized;
 
     optind = 1;
-    while ((c = getopt (argc, argv, "p:b:Nfvc:P:h" TEST_PARAMS_ARGS)) != -1) {
+    while ((c = getopt (argc, argv, "p:b:Nfvlc:P:h" TEST_PARAMS_ARGS)) != -1) {
         switch (c) {
         case 'p':
             ctx->port = atoi(optarg);
@@ -801,6 +862,10 @@ static ucs_status_t parse_opts(struct perftest_context *ctx, int mpi_initialized
         case 'v':
             ctx->flags |= TEST_FLAG_PRINT_CSV;
             break;
+        case 'l':
+            ctx->flags        |= TEST_FLAG_PRINT_LAT_CPU;
+            ctx->params.flags |= UCX_PERF_TEST_FLAG_LAT_HISTOGRAM;
+            break;
         case 'c':
             ctx->flags |= TEST_FLAG_SET_AFFINITY;
             ctx->cpu = atoi(optarg);
@@ -370,8 +370,10 @@ enum ucp_dt_type {
                                         user-defined pack/unpack routines */
     UCP_DATATYPE_SHIFT   = 3,      /**< Number of bits defining
                                         the datatype classification */
-    UCP_DATATYPE_CLASS_MASK = UCS_MASK(UCP_DATATYPE_SHIFT) /**< Data-type class
-                                                                mask */
+    UCP_DATATYPE_CLASS_MASK = UCS_MASK(UCP_DATATYPE_SHIFT), /**< Data-type class
+                                                                 mask */
+    UCP_DATATYPE_STRIDE_SHIFT = 32 /**< Bit offset of the stride in a
+                                        strided datatype identifier */
 };
 
 
@@ -404,12 +406,21 @@ enum {
  * @brief Flags for a UCP Active Message callback.
  *
  * Flags that indicate how to handle UCP Active Messages
- * Currently only UCP_AM_FLAG_WHOLE_MSG is supported,
- * which indicates the entire message is handled in one
- * callback.
+ * UCP_AM_FLAG_WHOLE_MSG indicates the entire message is
+ * handled in one callback.
  */
 enum ucp_am_cb_flags {
-    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0)
+    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0),
+    UCP_AM_FLAG_RNDV      = UCS_BIT(1)  /**< Messages which @ref ucp_am_send_nb
+                                             sends by rendezvous are passed to
+                                             the callback with
+                                             UCP_CB_PARAM_FLAG_RNDV and no user
+                                             header, so the receiver chooses
+                                             where the payload lands. Without
+                                             this flag UCP fetches the payload
+                                             to a buffer of its own and the
+                                             callback gets it as a whole
+                                             message. */
 };
 
 
@@ -438,7 +449,13 @@ enum ucp_send_am_flags {
  * no longer needed.
  */
 enum ucp_cb_param_flags {
-    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0)
+    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0),
+    UCP_CB_PARAM_FLAG_RNDV = UCS_BIT(1)  /**< The Active Message was sent by
+                                              rendezvous. The callback data
+                                              is the user header, and the
+                                              payload is still
+                                              on the sender until it is
+                                              fetched by @ref ucp_am_rndv_recv_nb */
 };
 
 
@@ -527,6 +544,35 @@ typedef enum {
 #define ucp_dt_make_iov() (UCP_DATATYPE_IOV)
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Generate an identifier for strided data type.
+ *
+ * This macro creates an identifier for a datatype which consists of elements
+ * of @a _elem_size bytes, placed @a _stride bytes apart from each other. The
+ * buffer passed to a communication routine points to the first element, and
+ * the count argument specifies the number of elements. The packed
+ * representation of the data is the elements placed one after another,
+ * so it is compatible with a contiguous datatype on the remote side.
+ *
+ * @param [in]  _elem_size    Size of an element in bytes, must be less than
+ *                            2^29.
+ * @param [in]  _stride       Distance between the starts of two consecutive
+ *                            elements in bytes, must be not less than
+ *                            @a _elem_size and less than 2^32.
+ *
+ * @return Data-type identifier.
+ *
+ * @note The buffer must be accessible by the CPU (host memory).
+ * @note In case of partial receive, the elements will be filled in order, and
+ *       the last element may be filled partially.
+ */
+#define ucp_dt_make_strided(_elem_size, _stride) \
+    (((ucp_datatype_t)(_stride) << UCP_DATATYPE_STRIDE_SHIFT) | \
+     ((ucp_datatype_t)(_elem_size) << UCP_DATATYPE_SHIFT) | \
+     UCP_DATATYPE_STRIDED)
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Structure for scatter-gather I/O.
@@ -1014,6 +1060,41 @@ typedef struct ucp_stream_poll_ep {
 } ucp_stream_poll_ep_t;
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Message of a batched send operation.
+ *
+ * The structure describes one message of @ref ucp_tag_send_batch_nb,
+ * @ref ucp_am_send_batch_nb or @ref ucp_stream_send_batch_nb.
+ */
+typedef struct ucp_send_batch_elem {
+    /**
+     * Destination endpoint handle.
+     */
+    ucp_ep_h    ep;
+
+    /**
+     * Pointer to the message payload, a contiguous buffer in host memory.
+     */
+    const void  *buffer;
+
+    /**
+     * Length of the message payload, in bytes.
+     */
+    size_t      length;
+
+    /**
+     * Message tag, used by @ref ucp_tag_send_batch_nb.
+     */
+    ucp_tag_t   tag;
+
+    /**
+     * Active Message id, used by @ref ucp_am_send_batch_nb.
+     */
+    uint16_t    am_id;
+} ucp_send_batch_elem_t;
+
+
 /**
  * @ingroup UCP_MEM
  * @brief Tuning parameters for the UCP memory mapping.
@@ -1422,6 +1503,9 @@ void ucp_worker_release_address(ucp_worker_h worker, ucp_address_t *address);
  * @li The state of communication can be advanced (progressed) by blocking
  * routines. Nevertheless, the non-blocking routines can not be used for
  * communication progress.
+ * @li If the worker was created with @ref UCS_THREAD_MODE_MULTI and another
+ * thread is currently using it, this routine returns 0 immediately instead of
+ * waiting for the other thread.
  *
  * @param [in]  worker    Worker to progress.
  *
@@ -2196,10 +2280,9 @@ void ucp_rkey_destroy(ucp_rkey_h rkey);
  *                          in to every invocation of the callback as the
  *                          arg argument.
  * @param [in]  flags       Dictates how an Active Message is handled on the
- *                          remote endpoint. Currently only
- *                          UCP_AM_FLAG_WHOLE_MSG is supported, which
- *                          indicates the callback will not be invoked
- *                          until all data has arrived.
+ *                          remote endpoint, see @ref ucp_am_cb_flags.
+ *                          UCP_AM_FLAG_WHOLE_MSG indicates the callback
+ *                          will not be invoked until all data has arrived.
  *
  * @return error code if the worker does not support Active Messages or
  *         requested callback flags.
@@ -2214,7 +2297,9 @@ ucs_status_t ucp_worker_set_am_handler(ucp_worker_h worker, uint16_t id,
  * @brief Send Active Message.
  *
  * This routine sends an Active Message to an ep. It does not support
- * CUDA memory.
+ * CUDA memory. Payloads above the rendezvous threshold of the endpoint are
+ * sent as with @ref ucp_am_send_rndv_nb, without a user header, and are
+ * fetched by the receiver; see UCP_AM_FLAG_RNDV.
  *
  * @param [in]  ep          UCP endpoint where the Active Message will be run.
  * @param [in]  id          Active Message id. Specifies which registered
@@ -2238,6 +2323,130 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
                                 ucp_send_callback_t cb, unsigned flags);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Send a batch of Active Messages.
+ *
+ * Same as calling @ref ucp_am_send_nb for every element of @a elems, in
+ * order, with a contiguous byte datatype, except that one request tracks the
+ * whole batch. Consecutive small messages to the same endpoint are packed
+ * into a single transport message, and the receiver invokes the callback
+ * separately for each one of them.
+ *
+ * @param [in]  elems       Messages to send. The endpoints must belong to the
+ *                          same worker, and the array may be reused after the
+ *                          call returns.
+ * @param [in]  count       Number of elements in @a elems.
+ * @param [in]  cb          Callback that is invoked once all messages are
+ *                          sent, if it is not completed immediately.
+ * @param [in]  flags       Flags passed to @ref ucp_am_send_nb for each
+ *                          message. Messages with UCP_AM_SEND_REPLY are
+ *                          never packed together.
+ *
+ * @return NULL             All messages were sent immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) Error sending the batch. Some of the messages
+ *                          may have been sent.
+ * @return otherwise        Pointer to request, which completes with the
+ *                          status of the first failed message, if any. The
+ *                          application is responsible for releasing it using
+ *                          @ref ucp_request_free.
+ */
+ucs_status_ptr_t ucp_am_send_batch_nb(const ucp_send_batch_elem_t *elems,
+                                      size_t count, ucp_send_callback_t cb,
+                                      unsigned flags);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Send Active Message with a rendezvous payload.
+ *
+ * This routine sends a small user header to an ep, and lets the receiver
+ * fetch the payload described by @a buffer into a buffer of its own choice.
+ * The Active Message callback on the receiver is invoked with the header as
+ * @a data and with the UCP_CB_PARAM_FLAG_RNDV flag set. The receiver then
+ * passes the data to @ref ucp_am_rndv_recv_nb, which moves the payload with
+ * the same zero-copy get/put protocols as a tag rendezvous, or to
+ * @ref ucp_am_data_release if it does not want the payload. Payloads smaller
+ * than the rendezvous threshold are better sent with @ref ucp_am_send_nb.
+ *
+ * @param [in]  ep            UCP endpoint where the Active Message will be
+ *                            run.
+ * @param [in]  id            Active Message id. Specifies which registered
+ *                            callback to run.
+ * @param [in]  header        User header passed to the callback. It must
+ *                            remain valid until the operation completes.
+ * @param [in]  header_length Length of the user header. Together with the
+ *                            rendezvous headers it must fit a single
+ *                            fragment of the Active Message lane.
+ * @param [in]  buffer        Pointer to the payload.
+ * @param [in]  count         Number of elements to send.
+ * @param [in]  datatype      Datatype descriptor for the elements in the
+ *                            buffer.
+ * @param [in]  cb            Callback that is invoked once the receiver has
+ *                            fetched or released the payload.
+ * @param [in]  flags         Only UCP_AM_SEND_REPLY is supported.
+ *
+ * @return UCS_PTR_IS_ERR(_ptr) Error sending Active Message.
+ * @return otherwise        Pointer to request, and the payload buffer may be
+ *                          reused after cb is run. The status passed to cb
+ *                          is UCS_OK, or the error returned by the remote
+ *                          callback if it did not keep the data.
+ */
+ucs_status_ptr_t ucp_am_send_rndv_nb(ucp_ep_h ep, uint16_t id,
+                                     const void *header, size_t header_length,
+                                     const void *buffer, size_t count,
+                                     ucp_datatype_t datatype,
+                                     ucp_send_callback_t cb, unsigned flags);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Receive the payload of a rendezvous Active Message.
+ *
+ * This routine fetches the payload of an Active Message sent by
+ * @ref ucp_am_send_rndv_nb into @a buffer, and consumes @a data_desc. It may
+ * be called from the Active Message callback, which must then return
+ * UCS_INPROGRESS, or later if the callback returned UCS_INPROGRESS.
+ *
+ * @param [in]  worker      Worker which received the Active Message.
+ * @param [in]  data_desc   Data that was passed into the Active Message
+ *                          callback with UCP_CB_PARAM_FLAG_RNDV set.
+ * @param [in]  buffer      Pointer to the buffer to receive the payload to.
+ *                          Its size can be found with
+ *                          @ref ucp_am_rndv_get_length.
+ * @param [in]  count       Number of elements to receive.
+ * @param [in]  datatype    Datatype descriptor for the elements in the
+ *                          buffer.
+ * @param [in]  cb          Callback that is invoked whenever the receive
+ *                          operation is completed. The info length is the
+ *                          payload length and the sender tag is the Active
+ *                          Message id. It may be called before this routine
+ *                          returns.
+ *
+ * @return UCS_PTR_IS_ERR(_ptr) The receive operation failed, and @a data_desc
+ *                          is still owned by the user.
+ * @return otherwise        Receive request handle, which must be released
+ *                          with @ref ucp_request_free once completed.
+ */
+ucs_status_ptr_t ucp_am_rndv_recv_nb(ucp_worker_h worker, void *data_desc,
+                                     void *buffer, size_t count,
+                                     ucp_datatype_t datatype,
+                                     ucp_tag_recv_callback_t cb);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Get the payload length of a rendezvous Active Message.
+ *
+ * @param [in]  data_desc   Data that was passed into the Active Message
+ *                          callback with UCP_CB_PARAM_FLAG_RNDV set, and was
+ *                          not consumed yet.
+ *
+ * @return Length in bytes of the payload which is still on the sender.
+ */
+size_t ucp_am_rndv_get_length(const void *data_desc);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Releases Active Message data.
@@ -2248,7 +2457,9 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
  * @param [in] worker       Worker which received the Active Message.
  * @param [in] data         Pointer to data that was passed into
  *                          the Active Message callback as the data
- *                          parameter.
+ *                          parameter. If the data belongs to a
+ *                          rendezvous Active Message, its payload is
+ *                          dropped and the sender is completed.
  */
 void ucp_am_data_release(ucp_worker_h worker, void *data);
 
@@ -2296,6 +2507,35 @@ ucs_status_ptr_t ucp_stream_send_nb(ucp_ep_h ep, const void *buffer, size_t coun
                                     unsigned flags);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking batched stream send operation.
+ *
+ * Same as calling @ref ucp_stream_send_nb for every element of @a elems, in
+ * order, with a contiguous byte datatype, except that one request tracks the
+ * whole batch. Consecutive small messages to the same endpoint are packed
+ * into a single transport message.
+ *
+ * @param [in]  elems       Messages to send. The endpoints must belong to the
+ *                          same worker, and the array may be reused after the
+ *                          call returns.
+ * @param [in]  count       Number of elements in @a elems.
+ * @param [in]  cb          Callback function that is invoked once all
+ *                          messages are sent, if the batch is not completed
+ *                          in place.
+ *
+ * @return NULL             - All messages were sent immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The batch failed. Some of the messages may
+ *                          have been sent.
+ * @return otherwise        - Request handle, which completes with the status
+ *                          of the first failed message, if any. The
+ *                          application is responsible for releasing the
+ *                          handle using @ref ucp_request_free routine.
+ */
+ucs_status_ptr_t ucp_stream_send_batch_nb(const ucp_send_batch_elem_t *elems,
+                                          size_t count, ucp_send_callback_t cb);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking tagged-send operations
@@ -2457,6 +2697,41 @@ ucs_status_ptr_t ucp_tag_send_sync_nb(ucp_ep_h ep, const void *buffer, size_t co
                                       ucp_send_callback_t cb);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking batched tagged-send operation.
+ *
+ * Same as calling @ref ucp_tag_send_nb for every element of @a elems, in
+ * order, with a contiguous byte datatype, except that one request tracks the
+ * whole batch. This amortizes the per-call overhead of sending many small
+ * messages. Consecutive messages to the same endpoint which are sent by the
+ * eager protocol are packed into a single transport message, which is then
+ * matched on the receiver as separate messages. Endpoints which use hardware
+ * tag matching send each message on its own.
+ *
+ * @note The user should not modify the message buffers after this operation
+ *       is called, until the operation completes.
+ *
+ * @param [in]  elems       Messages to send. The endpoints must belong to the
+ *                          same worker, and the array may be reused after the
+ *                          call returns.
+ * @param [in]  count       Number of elements in @a elems.
+ * @param [in]  cb          Callback function that is invoked once all
+ *                          messages are sent, if the batch is not completed
+ *                          in place.
+ *
+ * @return NULL             - All messages were sent immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The batch failed. Some of the messages may
+ *                          have been sent.
+ * @return otherwise        - Request handle, which completes with the status
+ *                          of the first failed message, if any. The
+ *                          application is responsible for releasing the
+ *                          handle using @ref ucp_request_free routine.
+ */
+ucs_status_ptr_t ucp_tag_send_batch_nb(const ucp_send_batch_elem_t *elems,
+                                       size_t count, ucp_send_callback_t cb);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking stream receive operation of structured data into a
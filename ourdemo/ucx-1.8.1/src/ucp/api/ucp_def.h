@@ -488,6 +488,11 @@ typedef enum ucp_wakeup_event_types {
  * @param [in]  flags    If this flag is set to UCP_CB_PARAM_FLAG_DATA,
  *                       the callback can return UCS_INPROGRESS and
  *                       data will persist after the callback returns.
+ *                       If UCP_CB_PARAM_FLAG_RNDV is also set, @a data
+ *                       is the user header of a rendezvous Active Message,
+ *                       empty if it was sent by @ref ucp_am_send_nb, and
+ *                       its payload is received with
+ *                       @ref ucp_am_rndv_recv_nb.
  *
  * @return UCS_OK        @a data will not persist after the callback returns.
  *
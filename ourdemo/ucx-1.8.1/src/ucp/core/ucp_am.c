@@ -17,6 +17,7 @@
 #include <ucp/core/ucp_worker.h>
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto_am.inl>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
 
@@ -42,6 +43,12 @@ void ucp_am_ep_cleanup(ucp_ep_h ep)
     }
 }
 
+static UCS_F_ALWAYS_INLINE const ucp_rndv_rts_hdr_t *
+ucp_am_rndv_rdesc_rts(ucp_recv_desc_t *rdesc)
+{
+    return UCS_PTR_BYTE_OFFSET(rdesc + 1, rdesc->payload_offset);
+}
+
 UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
                       (worker, data),
                       ucp_worker_h worker, void *data)
@@ -49,7 +56,14 @@ UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
     ucp_recv_desc_t *rdesc = (ucp_recv_desc_t *)data - 1;
     ucp_recv_desc_t *desc;
 
-    if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_RNDV) {
+        /* payload was not wanted, let the sender complete */
+        UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+        ucp_rndv_send_ats(worker, ucp_am_rndv_rdesc_rts(rdesc), UCS_OK);
+        ucp_recv_desc_release(rdesc);
+        UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+        return;
+    } else if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
         ucs_free(rdesc);
         return;
     } else if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_HDR) {
@@ -407,6 +421,106 @@ ucp_am_send_req(ucp_request_t *req, size_t count,
     return req + 1;
 }
 
+static size_t ucp_am_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq     = arg;
+    size_t header_length    = sreq->send.am.header_length;
+    size_t rts_offset       = ucs_align_up_pow2(header_length, sizeof(uint64_t));
+    ucp_rndv_rts_hdr_t *rts = UCS_PTR_BYTE_OFFSET(dest, rts_offset);
+    ucp_am_rndv_hdr_t *hdr;
+    size_t rts_length;
+
+    /* the user header goes first, so that the receiver can hand it out in
+     * place, and the AM header trails the rendezvous RTS */
+    memcpy(dest, sreq->send.am.header, header_length);
+    hdr                = UCS_PTR_BYTE_OFFSET(rts, ucp_tag_rndv_rts_pack(rts,
+                                                                        sreq));
+    rts->super.tag     = sreq->send.am.am_id;
+    hdr->header_length = header_length;
+    hdr->rts_offset    = rts_offset;
+    hdr->am_id         = sreq->send.am.am_id;
+    hdr->flags         = sreq->send.am.flags;
+    rts_length         = UCS_PTR_BYTE_DIFF(rts, hdr) + sizeof(*hdr);
+
+    return rts_offset + rts_length;
+}
+
+static size_t ucp_am_rndv_rts_max_size(ucp_ep_h ep, size_t header_length)
+{
+    return ucs_align_up_pow2(header_length, sizeof(uint64_t)) +
+           sizeof(ucp_rndv_rts_hdr_t) + ucp_ep_config(ep)->tag.rndv.rkey_size +
+           sizeof(ucp_am_rndv_hdr_t);
+}
+
+static ucs_status_t ucp_am_rndv_progress_rts(uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+
+    return ucp_do_am_single(self, UCP_AM_ID_AM_RTS, ucp_am_rndv_rts_pack,
+                            ucp_am_rndv_rts_max_size(sreq->send.ep,
+                                                     sreq->send.am.header_length));
+}
+
+static ucs_status_ptr_t
+ucp_am_send_rndv_req(ucp_request_t *req, const void *header,
+                     size_t header_length, ucp_send_callback_t cb)
+{
+    ucp_ep_h ep = req->send.ep;
+    ucs_status_t status;
+
+    req->send.am.header        = header;
+    req->send.am.header_length = header_length;
+    req->send.mem_type         = ucp_memory_type_detect(ep->worker->context,
+                                                        req->send.buffer,
+                                                        req->send.length);
+    req->send.pending_lane     = UCP_NULL_LANE;
+    req->send.uct.func         = ucp_am_rndv_progress_rts;
+
+    status = ucp_tag_rndv_reg_send_buffer(req);
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucp_request_put(req);
+        return UCS_STATUS_PTR(status);
+    }
+
+    UCP_EP_STAT_TAG_OP(ep, RNDV);
+
+    /* the request is completed by the ATS, or when the payload was pushed to
+     * the receiver, so it is never done by the time the RTS is out */
+    ucp_request_send(req, 0);
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        status = req->status;
+        ucp_request_put(req);
+        return UCS_STATUS_PTR(status);
+    }
+
+    ucp_request_set_callback(req, send.cb, cb);
+    return req + 1;
+}
+
+/* Payload size from which ucp_am_send_nb switches to rendezvous. It uses the
+ * thresholds of the tag rendezvous over the AM lane, which has the same
+ * cost, and requires the whole RTS to fit a single fragment */
+static size_t ucp_am_rndv_thresh(ucp_request_t *req)
+{
+    ucp_ep_h ep             = req->send.ep;
+    ucp_ep_config_t *config = ucp_ep_config(ep);
+
+    if (ucp_ep_is_tag_offload_enabled(config) ||
+        (ucp_am_rndv_rts_max_size(ep, 0) >
+         ucp_ep_get_max_bcopy(ep, ep->am_lane))) {
+        return SIZE_MAX;
+    }
+
+    switch (req->send.datatype & UCP_DATATYPE_CLASS_MASK) {
+    case UCP_DATATYPE_CONTIG:
+    case UCP_DATATYPE_IOV:
+        return ucs_min(config->tag.rndv.rma_thresh,
+                       config->tag.rndv.am_thresh);
+    default:
+        return config->tag.rndv.am_thresh;
+    }
+}
+
 UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_nb, 
                  (ep, id, payload, count, datatype, cb, flags),
                  ucp_ep_h ep, uint16_t id, const void *payload, 
@@ -454,7 +568,10 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_nb,
         goto out;
     }
 
-    if (flags & UCP_AM_SEND_REPLY) {
+    if (ucs_unlikely(req->send.length >= ucp_am_rndv_thresh(req))) {
+        req->send.am.flags |= UCP_AM_SEND_FLAG_AUTO_RNDV;
+        ret = ucp_am_send_rndv_req(req, NULL, 0, cb);
+    } else if (flags & UCP_AM_SEND_REPLY) {
         ret = ucp_am_send_req(req, count, &ucp_ep_config(ep)->am, cb,
                               ucp_ep_config(ep)->am_u.reply_proto);
     } else {
@@ -467,6 +584,192 @@ out:
     return ret;
 }
 
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_rndv_nb,
+                 (ep, id, header, header_length, buffer, count, datatype, cb,
+                  flags),
+                 ucp_ep_h ep, uint16_t id, const void *header,
+                 size_t header_length, const void *buffer, size_t count,
+                 uintptr_t datatype, ucp_send_callback_t cb, unsigned flags)
+{
+    ucs_status_t status;
+    ucs_status_ptr_t ret;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    if (ucs_unlikely((flags != 0) && !(flags & UCP_AM_SEND_REPLY))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    /* the whole RTS, user header included, must fit a single fragment */
+    if (ucs_unlikely(ucp_am_rndv_rts_max_size(ep, header_length) >
+                     ucp_ep_get_max_bcopy(ep, ep->am_lane))) {
+        ret = UCS_STATUS_PTR(UCS_ERR_EXCEEDS_LIMIT);
+        goto out;
+    }
+
+    req = ucp_request_get(ep->worker);
+    if (ucs_unlikely(req == NULL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    ucp_am_send_req_init(req, ep, buffer, datatype, count, flags, id);
+    status = ucp_ep_resolve_dest_ep_ptr(ep, ep->am_lane);
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucp_request_put(req);
+        ret = UCS_STATUS_PTR(status);
+        goto out;
+    }
+
+    ret = ucp_am_send_rndv_req(req, header, header_length, cb);
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return ret;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_rndv_recv_nb,
+                 (worker, data_desc, buffer, count, datatype, cb),
+                 ucp_worker_h worker, void *data_desc, void *buffer,
+                 size_t count, uintptr_t datatype, ucp_tag_recv_callback_t cb)
+{
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t *)data_desc - 1;
+    ucs_status_ptr_t ret;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    if (ucs_unlikely(!(rdesc->flags & UCP_RECV_DESC_FLAG_AM_RNDV))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    req = ucp_request_get(worker);
+    if (ucs_unlikely(req == NULL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    req->flags         = UCP_REQUEST_FLAG_RECV | UCP_REQUEST_FLAG_CALLBACK;
+    req->status        = UCS_OK;
+    req->recv.worker   = worker;
+    req->recv.buffer   = buffer;
+    req->recv.datatype = datatype;
+    ucp_dt_recv_state_init(&req->recv.state, buffer, datatype, count);
+    req->recv.length   = ucp_dt_length(datatype, count, buffer,
+                                       &req->recv.state);
+    req->recv.mem_type = ucp_memory_type_detect(worker->context, buffer,
+                                                req->recv.length);
+    req->recv.tag.cb   = cb;
+
+    /* same as an unexpected tag RTS: the RTS is consumed by the match */
+    ucp_rndv_matched(worker, req, ucp_am_rndv_rdesc_rts(rdesc));
+    ucp_recv_desc_release(rdesc);
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
+size_t ucp_am_rndv_get_length(const void *data_desc)
+{
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t *)data_desc - 1;
+
+    ucs_assert(rdesc->flags & UCP_RECV_DESC_FLAG_AM_RNDV);
+    return ucp_am_rndv_rdesc_rts(rdesc)->size;
+}
+
+static void ucp_am_rndv_fetch_completion(void *request, ucs_status_t status,
+                                         ucp_tag_recv_info_t *info)
+{
+    ucp_request_t *freq    = (ucp_request_t*)request - 1;
+    ucp_worker_h worker    = freq->recv.worker;
+    uint16_t am_id         = freq->recv.tag.am_id;
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t*)freq->recv.buffer - 1;
+
+    /* internal request, released by ucp_request_complete() */
+    freq->flags |= UCP_REQUEST_FLAG_RELEASED;
+
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucs_error("worker %p: failed to fetch active message %u of %u bytes: "
+                  "%s", worker, am_id, rdesc->length,
+                  ucs_status_string(status));
+        ucs_free(rdesc);
+        return;
+    }
+
+    if (ucs_unlikely((am_id >= worker->am_cb_array_len) ||
+                     (worker->am_cbs[am_id].cb == NULL))) {
+        ucs_warn("UCP Active Message was received with id : %u, but there"
+                 "is no registered callback for that id", am_id);
+        ucs_free(rdesc);
+        return;
+    }
+
+    status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
+                                      rdesc + 1, rdesc->length,
+                                      freq->recv.tag.am_reply_ep,
+                                      UCP_CB_PARAM_FLAG_DATA);
+    if (status != UCS_INPROGRESS) {
+        ucs_free(rdesc);
+    }
+}
+
+/* The callback of a message which ucp_am_send_nb sent by rendezvous did not
+ * ask for the descriptor, so fetch the payload to a buffer of our own and
+ * hand it out as a whole message, like a multi-fragment one */
+static void ucp_am_rndv_fetch(ucp_worker_h worker,
+                              const ucp_rndv_rts_hdr_t *rts, uint16_t am_id,
+                              ucp_ep_h reply_ep)
+{
+    ucp_recv_desc_t *rdesc;
+    ucp_request_t *freq;
+
+    rdesc = ucs_malloc(sizeof(*rdesc) + rts->size, "ucp recv desc for rndv AM");
+    if (ucs_unlikely(rdesc == NULL)) {
+        ucs_error("worker %p: failed to allocate %zu bytes for active message "
+                  "%u", worker, rts->size, am_id);
+        ucp_rndv_send_ats(worker, rts, UCS_ERR_NO_MEMORY);
+        return;
+    }
+
+    freq = ucp_request_get(worker);
+    if (ucs_unlikely(freq == NULL)) {
+        ucs_error("worker %p: failed to allocate active message rendezvous "
+                  "request", worker);
+        ucs_free(rdesc);
+        ucp_rndv_send_ats(worker, rts, UCS_ERR_NO_MEMORY);
+        return;
+    }
+
+    rdesc->flags                = UCP_RECV_DESC_FLAG_MALLOC;
+    rdesc->length               = rts->size;
+    rdesc->payload_offset       = 0;
+
+    freq->flags                 = UCP_REQUEST_FLAG_RECV |
+                                  UCP_REQUEST_FLAG_CALLBACK;
+    freq->status                = UCS_OK;
+    freq->recv.worker           = worker;
+    freq->recv.buffer           = rdesc + 1;
+    freq->recv.datatype         = ucp_dt_make_contig(1);
+    ucp_dt_recv_state_init(&freq->recv.state, freq->recv.buffer,
+                           freq->recv.datatype, rts->size);
+    freq->recv.length           = rts->size;
+    freq->recv.mem_type         = UCS_MEMORY_TYPE_HOST;
+    freq->recv.tag.cb           = ucp_am_rndv_fetch_completion;
+    freq->recv.tag.am_reply_ep  = reply_ep;
+    freq->recv.tag.am_id        = am_id;
+
+    ucp_rndv_matched(worker, freq, rts);
+}
+
 static ucs_status_t
 ucp_am_handler_common(ucp_worker_h worker, void *hdr_end,
                       size_t hdr_size, size_t args_length,
@@ -687,6 +990,69 @@ ucp_am_long_handler(void *am_arg, void *am_data, size_t am_length,
                                       NULL); 
 }
 
+static ucs_status_t
+ucp_am_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                        unsigned am_flags)
+{
+    ucp_worker_h worker      = (ucp_worker_h)am_arg;
+    ucp_am_rndv_hdr_t *hdr   = UCS_PTR_BYTE_OFFSET(am_data, am_length -
+                                                   sizeof(*hdr));
+    ucp_rndv_rts_hdr_t *rts  = UCS_PTR_BYTE_OFFSET(am_data, hdr->rts_offset);
+    uint16_t am_id           = hdr->am_id;
+    ucp_ep_h reply_ep        = NULL;
+    ucp_recv_desc_t *desc;
+    ucs_status_t status;
+
+    if (ucs_unlikely((am_id >= worker->am_cb_array_len) ||
+                     (worker->am_cbs[am_id].cb == NULL))) {
+        ucs_warn("UCP Active Message was received with id : %u, but there" 
+                 "is no registered callback for that id", am_id);
+        /* do not leave the sender waiting for the payload to be fetched */
+        ucp_rndv_send_ats(worker, rts, UCS_ERR_NO_ELEM);
+        return UCS_OK;
+    }
+
+    if (hdr->flags & UCP_AM_SEND_REPLY) {
+        reply_ep = ucp_worker_get_ep_by_ptr(worker, rts->sreq.ep_ptr);
+    }
+
+    if ((hdr->flags & UCP_AM_SEND_FLAG_AUTO_RNDV) &&
+        !(worker->am_cbs[am_id].flags & UCP_AM_FLAG_RNDV)) {
+        ucp_am_rndv_fetch(worker, rts, am_id, reply_ep);
+        return UCS_OK;
+    }
+
+    /* the user header is at the start of the descriptor data, and the RTS
+     * follows it at payload_offset */
+    status = ucp_recv_desc_init(worker, am_data, am_length, 0, am_flags,
+                                hdr->rts_offset, UCP_RECV_DESC_FLAG_AM_RNDV,
+                                0, &desc);
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
+        ucs_error("worker %p  could not allocate descriptor for active message"
+                  "on callback : %u", worker, am_id);
+        ucp_rndv_send_ats(worker, rts, status);
+        return UCS_OK;
+    }
+
+    status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
+                                      desc + 1, hdr->header_length, reply_ep,
+                                      UCP_CB_PARAM_FLAG_DATA |
+                                      UCP_CB_PARAM_FLAG_RNDV);
+    if (status == UCS_INPROGRESS) {
+        /* the descriptor is now owned by the user, until it passes it to
+         * ucp_am_rndv_recv_nb or ucp_am_data_release */
+        return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
+    }
+
+    /* payload not wanted, report the callback status to the sender */
+    ucp_rndv_send_ats(worker, rts, status);
+    if (!(am_flags & UCT_CB_PARAM_FLAG_DESC)) {
+        ucp_recv_desc_release(desc);
+    }
+
+    return UCS_OK;
+}
+
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE,
               ucp_am_handler, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI,
@@ -695,6 +1061,10 @@ UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE_REPLY,
               ucp_am_handler_reply, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI_REPLY,
               ucp_am_long_handler_reply, NULL, 0);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_RTS,
+              ucp_am_rndv_rts_handler, NULL, 0);
+
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_AM_RTS);
 
 const ucp_request_send_proto_t ucp_am_proto = {
     .contig_short           = ucp_am_contig_short,
@@ -41,6 +41,18 @@ typedef struct {
     uint16_t          am_id;      /* index into callback array */
 } UCS_S_PACKED ucp_am_long_hdr_t;
 
+typedef struct {
+    uint32_t          header_length; /* length of the user header, which starts
+                                        the message */
+    uint32_t          rts_offset;    /* where the rendezvous RTS starts */
+    uint16_t          am_id;         /* index into callback array */
+    uint16_t          flags;         /* @ref ucp_send_am_flags */
+} UCS_S_PACKED ucp_am_rndv_hdr_t;    /* trails the RTS of a rendezvous AM */
+
+/* Internal flag of ucp_am_rndv_hdr_t, the rendezvous was chosen by
+ * ucp_am_send_nb for a large payload, and there is no user header */
+#define UCP_AM_SEND_FLAG_AUTO_RNDV UCS_BIT(15)
+
 typedef struct {
     ucs_list_link_t   list;       /* entry into list of unfinished AM's */
     ucp_recv_desc_t  *all_data;   /* buffer for all parts of the AM */
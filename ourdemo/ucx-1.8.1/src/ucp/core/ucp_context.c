@@ -12,6 +12,7 @@
 
 #include "ucp_context.h"
 #include "ucp_request.h"
+#include "ucp_thresh_profile.h"
 
 #include <ucs/config/parser.h>
 #include <ucs/algorithm/crc.h>
@@ -121,6 +122,13 @@ static ucs_config_field_t ucp_config_table[] = {
    "Threshold for switching from eager to rendezvous protocol",
    ucs_offsetof(ucp_config_t, ctx.rndv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"STREAM_RNDV_THRESH", "inf",
+   "Threshold for switching stream sends from eager to rendezvous protocol. The\n"
+   "payload lands directly in a receive posted with UCP_STREAM_RECV_FLAG_WAITALL.\n"
+   "\"auto\" uses the RMA rendezvous threshold of tag sends, \"inf\" disables\n"
+   "rendezvous for stream sends.",
+   ucs_offsetof(ucp_config_t, ctx.stream_rndv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"RNDV_SEND_NBR_THRESH", "256k",
    "Threshold for switching from eager to rendezvous protocol in ucp_tag_send_nbr().\n"
    "Relevant only if UCX_RNDV_THRESH is set to \"auto\".",
@@ -161,6 +169,21 @@ static ucs_config_field_t ucp_config_table[] = {
    "Threshold for switching from buffer copy to zero copy protocol",
    ucs_offsetof(ucp_config_t, ctx.zcopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"THRESH_PROFILE", "",
+   "File with zero-copy and rendezvous thresholds measured on this host. The\n"
+   "thresholds it lists replace the estimated ones of the respective transports\n"
+   "when UCX_ZCOPY_THRESH or UCX_RNDV_THRESH are \"auto\". The file is created\n"
+   "by \"ucx_info -T <file>\", or when UCX_THRESH_CALIBRATE is enabled.\n"
+   "%h in the name is replaced by the host name.",
+   ucs_offsetof(ucp_config_t, thresh_profile), UCS_CONFIG_TYPE_STRING},
+
+  {"THRESH_CALIBRATE", "n",
+   "Measure the thresholds of the transports which are missing from\n"
+   "UCX_THRESH_PROFILE when the first worker of the context is created, and add\n"
+   "them to the file, so later processes on this host load them instead of\n"
+   "measuring again.",
+   ucs_offsetof(ucp_config_t, thresh_calibrate), UCS_CONFIG_TYPE_BOOL},
+
   {"BCOPY_BW", "auto",
    "Estimation of buffer copy bandwidth",
    ucs_offsetof(ucp_config_t, ctx.bcopy_bw), UCS_CONFIG_TYPE_BW},
@@ -1496,6 +1519,11 @@ ucs_status_t ucp_init_version(unsigned api_major_version, unsigned api_minor_ver
         goto err_free_config;
     }
 
+    status = ucp_thresh_profile_init(context, config);
+    if (status != UCS_OK) {
+        goto err_free_resources;
+    }
+
     if (dfl_config != NULL) {
         ucp_config_release(dfl_config);
     }
@@ -1507,6 +1535,8 @@ ucs_status_t ucp_init_version(unsigned api_major_version, unsigned api_minor_ver
     *context_p = context;
     return UCS_OK;
 
+err_free_resources:
+    ucp_free_resources(context);
 err_free_config:
     ucp_free_config(context);
 err_free_ctx:
@@ -1521,6 +1551,7 @@ err:
 
 void ucp_cleanup(ucp_context_h context)
 {
+    ucp_thresh_profile_cleanup(context);
     ucp_free_resources(context);
     ucp_free_config(context);
     UCP_THREAD_LOCK_FINALIZE(&context->mt_lock);
@@ -37,6 +37,8 @@ typedef struct ucp_context_config {
     size_t                                 bcopy_thresh;
     /** Threshold for switching UCP to rendezvous protocol */
     size_t                                 rndv_thresh;
+    /** Threshold for switching UCP stream sends to rendezvous protocol */
+    size_t                                 stream_rndv_thresh;
     /** Threshold for switching UCP to rendezvous protocol
      *  in ucp_tag_send_nbr() */
     size_t                                 rndv_send_nbr_thresh;
@@ -108,6 +110,10 @@ struct ucp_config {
     UCS_CONFIG_STRING_ARRAY_FIELD(cm_tls)  sockaddr_cm_tls;
     /** Warn on invalid configuration */
     int                                    warn_invalid_config;
+    /** File with protocol thresholds measured on this host */
+    char                                   *thresh_profile;
+    /** Measure the thresholds which are missing from the profile */
+    int                                    thresh_calibrate;
     /** Configuration saved directly in the context */
     ucp_context_config_t                   ctx;
 };
@@ -126,6 +132,17 @@ typedef struct ucp_tl_resource_desc {
 } ucp_tl_resource_desc_t;
 
 
+/**
+ * Protocol thresholds of a resource, measured on this host.
+ * UCS_MEMUNITS_AUTO means the threshold is estimated from the resource
+ * attributes.
+ */
+typedef struct ucp_tl_thresh {
+    size_t                        zcopy;      /* Eager zero-copy threshold */
+    size_t                        rndv;       /* Rendezvous threshold */
+} ucp_tl_thresh_t;
+
+
 /**
  * Transport aliases.
  */
@@ -226,6 +243,23 @@ typedef struct ucp_context {
         /* Configuration supplied by the user */
         ucp_context_config_t      ext;
 
+        /* Array of per-resource thresholds from the profile file */
+        ucp_tl_thresh_t           *tl_thresh;
+
+        /* Map of resources which are listed in the profile file */
+        uint64_t                  tl_thresh_map;
+
+        /* Profile file to save the thresholds to after the first worker
+         * measures them, NULL if no calibration is pending */
+        char                      *thresh_calib_file;
+
+        /* Whether the calibration is running */
+        int                       thresh_calib_running;
+
+        /* Protects the calibration state regardless of the thread mode.
+         * Recursive, since the calibration creates a worker on this context */
+        pthread_mutex_t           thresh_calib_lock;
+
     } config;
 
     /* All configurations about multithreading support */
@@ -1078,6 +1078,11 @@ static size_t ucp_ep_config_calc_rndv_thresh(ucp_worker_t *worker,
     eager_rsc_index  = config->key.lanes[eager_lanes[0]].rsc_index;
     eager_iface_attr = ucp_worker_iface_get_attr(worker, eager_rsc_index);
 
+    if (context->config.tl_thresh[eager_rsc_index].rndv != UCS_MEMUNITS_AUTO) {
+        /* measured on this host */
+        return context->config.tl_thresh[eager_rsc_index].rndv;
+    }
+
     /* RTS/RTR latency is used from lanes[0] */
     rts_latency      = ucp_tl_iface_latency(context, eager_iface_attr);
 
@@ -1232,6 +1237,31 @@ static void ucp_ep_config_set_rndv_thresh(ucp_worker_t *worker,
               config->tag.rndv.rma_thresh, config->tag.rndv_send_nbr.rma_thresh);
 }
 
+static void ucp_ep_config_set_stream_rndv_thresh(ucp_worker_h worker,
+                                                 ucp_ep_config_t *config)
+{
+    ucp_context_h context = worker->context;
+
+    if (!(context->config.features & UCP_FEATURE_STREAM) ||
+        !ucp_ep_config_test_rndv_support(config)) {
+        return;
+    }
+
+    if (context->config.ext.stream_rndv_thresh != UCS_MEMUNITS_AUTO) {
+        config->stream.rndv_thresh = context->config.ext.stream_rndv_thresh;
+    } else if (config->key.rma_bw_lanes[0] != UCP_NULL_LANE) {
+        /* auto - rendezvous pays off only when the payload is moved by RMA
+         * straight into the receive buffer */
+        config->stream.rndv_thresh = ucp_ep_config_calc_rndv_thresh(worker,
+                                                                    config,
+                                                                    config->key.am_bw_lanes,
+                                                                    config->key.rma_bw_lanes,
+                                                                    1);
+    }
+
+    ucs_trace("stream rndv threshold is %zu", config->stream.rndv_thresh);
+}
+
 static void ucp_ep_config_set_memtype_thresh(ucp_memtype_thresh_t *max_eager_short,
                                              ssize_t max_short, int num_mem_type_mds)
 {
@@ -1253,7 +1283,7 @@ static void ucp_ep_config_init_attrs(ucp_worker_t *worker, ucp_rsc_index_t rsc_i
     const uct_md_attr_t *md_attr;
     uct_iface_attr_t *iface_attr;
     size_t it;
-    size_t zcopy_thresh;
+    size_t zcopy_thresh, tuned_thresh;
     int mem_type;
 
     iface_attr = ucp_worker_iface_get_attr(worker, rsc_index);
@@ -1282,12 +1312,23 @@ static void ucp_ep_config_init_attrs(ucp_worker_t *worker, ucp_rsc_index_t rsc_i
 
     if (context->config.ext.zcopy_thresh == UCS_MEMUNITS_AUTO) {
         config->zcopy_auto_thresh = 1;
+        tuned_thresh              = context->config.tl_thresh[rsc_index].zcopy;
         for (it = 0; it < UCP_MAX_IOV; ++it) {
-            zcopy_thresh = ucp_ep_config_get_zcopy_auto_thresh(it + 1,
-                                                               &md_attr->reg_cost,
-                                                               context,
-                                                               ucp_tl_iface_bandwidth(context,
-                                                                                      &iface_attr->bandwidth));
+            if (tuned_thresh == UCS_MEMUNITS_AUTO) {
+                zcopy_thresh = ucp_ep_config_get_zcopy_auto_thresh(it + 1,
+                                                                   &md_attr->reg_cost,
+                                                                   context,
+                                                                   ucp_tl_iface_bandwidth(context,
+                                                                                          &iface_attr->bandwidth));
+            } else if (tuned_thresh == UCS_MEMUNITS_INF) {
+                zcopy_thresh = SIZE_MAX;
+            } else {
+                /* measured with a single buffer; the registration cost,
+                 * which makes zcopy lose on small sizes, grows with the
+                 * number of buffers */
+                zcopy_thresh = (tuned_thresh > (SIZE_MAX / (it + 1))) ?
+                               SIZE_MAX : (tuned_thresh * (it + 1));
+            }
             zcopy_thresh = ucs_min(zcopy_thresh, adjust_min_val);
             config->sync_zcopy_thresh[it] = zcopy_thresh;
             config->zcopy_thresh[it]      = zcopy_thresh;
@@ -1395,6 +1436,7 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
 
     config->tag.rndv.rkey_ptr_dst_mds   = 0;
     config->stream.proto                = &ucp_stream_am_proto;
+    config->stream.rndv_thresh          = SIZE_MAX;
     config->am_u.proto                  = &ucp_am_proto;
     config->am_u.reply_proto            = &ucp_am_reply_proto;
     max_rndv_thresh                     = SIZE_MAX;
@@ -1584,6 +1626,8 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
             ucp_ep_config_set_am_rndv_thresh(worker, iface_attr, md_attr, config,
                                              min_am_rndv_thresh,
                                              max_am_rndv_thresh);
+
+            ucp_ep_config_set_stream_rndv_thresh(worker, config);
         } else {
             /* Stub endpoint */
             config->am.max_bcopy = UCP_MIN_BCOPY;
@@ -52,6 +52,9 @@ enum {
     UCP_EP_FLAG_CLOSED                 = UCS_BIT(10),/* EP was closed */
     UCP_EP_FLAG_CLOSE_REQ_VALID        = UCS_BIT(11),/* close protocol is started and
                                                         close_req is valid */
+    UCP_EP_FLAG_STREAM_RNDV_BLOCKED    = UCS_BIT(12),/* stream data is held in
+                                                        ext.stream.rndv_q until a
+                                                        rendezvous fetch completes */
 
     /* DEBUG bits */
     UCP_EP_FLAG_CONNECT_REQ_SENT       = UCS_BIT(16),/* DEBUG: Connection request was sent */
@@ -284,6 +287,8 @@ typedef struct ucp_ep_config {
         /* Protocols used for stream operations
          * (currently it's only AM based). */
         const ucp_request_send_proto_t   *proto;
+        /* Threshold for switching from eager to rendezvous */
+        size_t                           rndv_thresh;
     } stream;
     
     struct {
@@ -367,6 +372,9 @@ typedef struct {
         ucs_list_link_t           ready_list;    /* List entry in worker's EP list */
         ucs_queue_head_t          match_q;       /* Queue of receive data or requests,
                                                     depends on UCP_EP_FLAG_STREAM_HAS_DATA */
+        ucs_queue_head_t          rndv_q;        /* Data and RTS which arrived after a
+                                                    rendezvous fetched into a bounce
+                                                    buffer, see UCP_EP_FLAG_STREAM_RNDV_BLOCKED */
     } stream;
 
     struct {
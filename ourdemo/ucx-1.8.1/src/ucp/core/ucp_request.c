@@ -66,10 +66,22 @@ static UCS_F_ALWAYS_INLINE void
 ucp_request_release_common(void *request, uint8_t cb_flag, const char *debug_name)
 {
     ucp_request_t *req = (ucp_request_t*)request - 1;
-    ucp_worker_h UCS_V_UNUSED worker = ucs_container_of(ucs_mpool_obj_owner(req),
-                                                        ucp_worker_t, req_mp);
+    ucp_worker_h worker = ucs_container_of(ucs_mpool_obj_owner(req),
+                                           ucp_worker_t, req_mp);
     uint32_t flags;
 
+    /* A completed request is not accessed by UCP anymore, so there is no need
+     * to wait for the worker lock to release it */
+    if ((worker->flags & UCP_WORKER_FLAG_MT) &&
+        (req->flags & UCP_REQUEST_FLAG_COMPLETED)) {
+        ucs_trace_req("%s request %p (%p) "UCP_REQUEST_FLAGS_FMT, debug_name,
+                      req, req + 1, UCP_REQUEST_FLAGS_ARG(req->flags));
+        ucs_assert(!(req->flags & UCP_REQUEST_DEBUG_FLAG_EXTERNAL));
+        ucs_assert(!(req->flags & UCP_REQUEST_FLAG_RELEASED));
+        ucp_request_put_deferred(worker, req);
+        return;
+    }
+
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
 
     flags = req->flags;
@@ -227,6 +239,17 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_request_memory_reg,
         ucp_trace_req(req_dbg, "mem reg md_map 0x%"PRIx64"/0x%"PRIx64,
                       state->dt.contig.md_map, md_map);
         break;
+    case UCP_DATATYPE_STRIDED:
+        /* register the whole extent once, the elements share its memh */
+        ucs_assert(ucs_popcount(md_map) <= UCP_MAX_OP_MDS);
+        status = ucp_mem_rereg_mds(context, md_map, buffer,
+                                   ucp_dt_strided_extent(datatype, length),
+                                   flags, NULL, mem_type, NULL,
+                                   state->dt.contig.memh,
+                                   &state->dt.contig.md_map);
+        ucp_trace_req(req_dbg, "mem reg strided md_map 0x%"PRIx64"/0x%"PRIx64,
+                      state->dt.contig.md_map, md_map);
+        break;
     case UCP_DATATYPE_IOV:
         iovcnt = state->dt.iov.iovcnt;
         iov    = buffer;
@@ -280,6 +303,7 @@ UCS_PROFILE_FUNC_VOID(ucp_request_memory_dereg, (context, datatype, state, req_d
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
+    case UCP_DATATYPE_STRIDED:
         ucp_request_dt_dereg(context, &state->dt.contig, 1, req_dbg);
         break;
     case UCP_DATATYPE_IOV:
@@ -363,6 +387,9 @@ ucp_request_send_start(ucp_request_t *req, ssize_t max_short,
                 multi = ucp_dt_iov_count_nonempty(req->send.buffer, dt_count) >
                         msg_config->max_iov;
             }
+        } else if (ucs_unlikely(UCP_DT_IS_STRIDED(req->send.datatype))) {
+            /* every element takes an iov entry */
+            multi = dt_count > msg_config->max_iov;
         } else {
             multi = 0;
         }
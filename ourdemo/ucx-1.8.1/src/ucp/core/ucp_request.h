@@ -84,7 +84,12 @@ enum {
                                                        uct and the ucp level am header must
                                                        be accounted for when releasing
                                                        descriptors */
-    UCP_RECV_DESC_FLAG_AM_REPLY       = UCS_BIT(9)  /* AM that needed a reply */
+    UCP_RECV_DESC_FLAG_AM_REPLY       = UCS_BIT(9), /* AM that needed a reply */
+    UCP_RECV_DESC_FLAG_AM_RNDV        = UCS_BIT(10),/* AM whose payload is still
+                                                       on the sender, see
+                                                       @ref ucp_am_rndv_recv_nb */
+    UCP_RECV_DESC_FLAG_STREAM_RTS     = UCS_BIT(11) /* Stream rendezvous RTS held
+                                                       behind a rendezvous fetch */
 };
 
 
@@ -115,6 +120,8 @@ struct ucp_request {
             size_t                length;   /* Total length, in bytes */
             ucs_memory_type_t     mem_type; /* Memory type */
             ucp_send_callback_t   cb;       /* Completion callback */
+            ucp_request_t         *batch_req; /* Batch send request this one
+                                                 is a part of, if any */
 
             union {
 
@@ -217,6 +224,8 @@ struct ucp_request {
                     uint64_t message_id;  /* used to identify matching parts
                                              of a large message */
                     unsigned flags;
+                    const void *header;   /* user header of rendezvous AM */
+                    size_t   header_length;
                 } am;
             };
 
@@ -260,6 +269,20 @@ struct ucp_request {
                      * while non_contig_buf is used in unexpected flow only. */
                     union {
                         ucp_mem_desc_t      *rdesc;   /* Offload bounce buffer */
+                        struct {
+                            ucp_request_t   *stream_req; /* Stream receive request
+                                                            a rendezvous fetches
+                                                            into, if any */
+                            ucp_ep_h        stream_ep;  /* Endpoint the fetch is
+                                                           for, NULL once it was
+                                                           destroyed */
+                        };
+                        struct {
+                            ucp_ep_h        am_reply_ep; /* Reply endpoint of
+                                                            an Active Message
+                                                            fetched by UCP */
+                            uint16_t        am_id;       /* Its callback id */
+                        };
                         void                *non_contig_buf; /* Used for assembling
                                                                 multi-fragment
                                                                 non-contig unexpected
@@ -279,6 +302,8 @@ struct ucp_request {
                     ucp_stream_recv_callback_t cb;     /* Completion callback */
                     size_t                     offset; /* Receive data offset */
                     size_t                     length; /* Completion info to fill */
+                    unsigned                   rndv_count; /* Rendezvous fetches
+                                                              in flight */
                 } stream;
             };
         } recv;
@@ -290,6 +315,20 @@ struct ucp_request {
             int                   comp_count; /* Countdown to request completion */
             ucp_ep_ext_gen_t      *next_ep; /* Next endpoint to flush */
         } flush_worker;
+
+        /* "send_batch" part - used for ucp_*_send_batch_nb operations */
+        struct {
+            ucp_send_callback_t   cb;         /* Completion callback */
+            int                   comp_count; /* Countdown to request completion */
+            ucs_status_t          status;     /* Status of the first failed send */
+        } send_batch;
+
+        /* "release" part - used after the request was completed and released
+         * by a thread which did not hold the worker lock */
+        struct {
+            ucp_request_t         *next;    /* Next request on the worker's
+                                               release list */
+        } release;
     };
 };
 
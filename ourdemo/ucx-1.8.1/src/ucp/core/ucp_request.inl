@@ -13,6 +13,7 @@
 
 #include <ucp/core/ucp_worker.h>
 #include <ucp/dt/dt.h>
+#include <ucs/arch/atomic.h>
 #include <ucs/profile/profile.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucp/dt/dt.inl>
@@ -87,6 +88,25 @@ ucp_request_put(ucp_request_t *req)
     ucs_mpool_put_inline(req);
 }
 
+/*
+ * Return a completed request to the worker memory pool without taking the
+ * worker lock. The request is pushed to a lock-free list, which is moved to
+ * the memory pool by the next ucp_worker_progress().
+ */
+static UCS_F_ALWAYS_INLINE void
+ucp_request_put_deferred(ucp_worker_h worker, ucp_request_t *req)
+{
+    ucp_request_t *head;
+
+    ucs_trace_req("put request %p deferred", req);
+    do {
+        head              = worker->req_release_list;
+        req->release.next = head;
+    } while (ucs_atomic_cswap64((volatile uint64_t*)&worker->req_release_list,
+                                (uintptr_t)head, (uintptr_t)req) !=
+             (uintptr_t)head);
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_request_complete_send(ucp_request_t *req, ucs_status_t status)
 {
@@ -132,6 +152,11 @@ ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
 static UCS_F_ALWAYS_INLINE int
 ucp_request_can_complete_stream_recv(ucp_request_t *req)
 {
+    /* a rendezvous is still fetching data into the buffer */
+    if (ucs_unlikely(req->recv.stream.rndv_count != 0)) {
+        return 0;
+    }
+
     /* NOTE: first check is needed to avoid heavy "%" operation if request is
      *       completely filled */
     if (req->recv.stream.offset == req->recv.length) {
@@ -245,6 +270,7 @@ ucp_request_send_state_init(ucp_request_t *req, ucp_datatype_t datatype,
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
+    case UCP_DATATYPE_STRIDED:
         req->send.state.dt.dt.contig.md_map     = 0;
         return;
     case UCP_DATATYPE_IOV:
@@ -462,6 +488,11 @@ ucp_request_recv_data_unpack(ucp_request_t *req, const void *data,
         req->recv.state.offset += length;
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_scatter, req->recv.buffer, data,
+                              req->recv.datatype, length, offset);
+        return UCS_OK;
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(req->recv.datatype);
         status = UCS_PROFILE_NAMED_CALL("dt_unpack", dt_gen->ops.unpack,
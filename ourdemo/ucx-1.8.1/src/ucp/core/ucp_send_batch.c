@@ -0,0 +1,477 @@
+/**
+ * Copyright (C) The ourdemo authors 2026.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "ucp_am.h"
+#include "ucp_context.h"
+#include "ucp_worker.h"
+#include "ucp_request.inl"
+
+#include <ucp/stream/stream.h>
+#include <ucp/tag/eager.h>
+#include <ucs/debug/log.h>
+#include <string.h>
+
+
+/*
+ * UCP_AM_ID_BATCH carries a sequence of messages, each one preceded by this
+ * header. A message is built exactly as if it was sent as an Active Message
+ * of its own, and the receiver passes it to the handler of that Active
+ * Message.
+ */
+typedef struct {
+    uint32_t                     length;  /* Message length */
+    uint8_t                      am_id;   /* Active Message id of the message */
+} UCS_S_PACKED ucp_send_batch_hdr_t;
+
+
+/*
+ * Consecutive messages to the same endpoint, which are sent by a single
+ * UCP_AM_ID_BATCH
+ */
+typedef struct {
+    ucp_ep_h                     ep;
+    uint8_t                      am_id;
+    const ucp_send_batch_elem_t  *elems;
+    size_t                       count;
+} ucp_send_batch_pack_ctx_t;
+
+
+static UCS_F_ALWAYS_INLINE size_t ucp_send_batch_msg_hdr_size(uint8_t am_id)
+{
+    switch (am_id) {
+    case UCP_AM_ID_EAGER_ONLY:
+        return sizeof(ucp_eager_hdr_t);
+    case UCP_AM_ID_SINGLE:
+        return sizeof(ucp_am_hdr_t);
+    default:
+        ucs_assert(am_id == UCP_AM_ID_STREAM_DATA);
+        return sizeof(ucp_stream_am_hdr_t);
+    }
+}
+
+/*
+ * Check if a message can be packed with others, instead of being sent by the
+ * protocol which the regular send routine selects for it
+ */
+static UCS_F_ALWAYS_INLINE int
+ucp_send_batch_is_packable(ucp_ep_h ep, uint8_t am_id, unsigned flags,
+                           const ucp_send_batch_elem_t *elem)
+{
+    ucp_ep_config_t *config = ucp_ep_config(ep);
+
+    switch (am_id) {
+    case UCP_AM_ID_EAGER_ONLY:
+        /* messages sent by hardware tag matching can not be reordered with
+         * the packed ones */
+        return !ucp_ep_is_tag_offload_enabled(config) &&
+               (elem->length < ucs_min(config->tag.rndv.rma_thresh,
+                                       config->tag.rndv.am_thresh));
+    case UCP_AM_ID_SINGLE:
+        return !(flags & UCP_AM_SEND_REPLY);
+    default:
+        /* the stream header is built when the messages are packed */
+        return (ep->flags & UCP_EP_FLAG_DEST_EP) &&
+               (elem->length < config->stream.rndv_thresh);
+    }
+}
+
+static size_t ucp_send_batch_pack_msg(void *dest, ucp_ep_h ep, uint8_t am_id,
+                                      const ucp_send_batch_elem_t *elem)
+{
+    ucp_send_batch_hdr_t *hdr = dest;
+    ucp_stream_am_hdr_t *stream_hdr;
+    ucp_eager_hdr_t *eager_hdr;
+    ucp_am_hdr_t *am_hdr;
+    void *payload;
+
+    switch (am_id) {
+    case UCP_AM_ID_EAGER_ONLY:
+        eager_hdr            = (ucp_eager_hdr_t*)(hdr + 1);
+        eager_hdr->super.tag = elem->tag;
+        payload              = eager_hdr + 1;
+        break;
+    case UCP_AM_ID_SINGLE:
+        am_hdr                = (ucp_am_hdr_t*)(hdr + 1);
+        am_hdr->am_hdr.am_id  = elem->am_id;
+        am_hdr->am_hdr.length = elem->length;
+        am_hdr->am_hdr.flags  = 0;
+        payload               = am_hdr + 1;
+        break;
+    default:
+        stream_hdr         = (ucp_stream_am_hdr_t*)(hdr + 1);
+        stream_hdr->ep_ptr = ucp_ep_dest_ep_ptr(ep);
+        payload            = stream_hdr + 1;
+        break;
+    }
+
+    memcpy(payload, elem->buffer, elem->length);
+    hdr->am_id  = am_id;
+    hdr->length = ucp_send_batch_msg_hdr_size(am_id) + elem->length;
+    return sizeof(*hdr) + hdr->length;
+}
+
+static size_t ucp_send_batch_pack(void *dest, void *arg)
+{
+    ucp_send_batch_pack_ctx_t *ctx = arg;
+    void *p                        = dest;
+    size_t i;
+
+    for (i = 0; i < ctx->count; ++i) {
+        p = UCS_PTR_BYTE_OFFSET(p, ucp_send_batch_pack_msg(p, ctx->ep,
+                                                           ctx->am_id,
+                                                           &ctx->elems[i]));
+    }
+
+    return UCS_PTR_BYTE_DIFF(dest, p);
+}
+
+static size_t ucp_send_batch_pack_copy(void *dest, void *arg)
+{
+    ucp_request_t *req = arg;
+
+    memcpy(dest, req->send.buffer, req->send.length);
+    return req->send.length;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_send_batch_set_status(ucp_request_t *req, ucs_status_t status)
+{
+    if (ucs_unlikely(status != UCS_OK) &&
+        (req->send_batch.status == UCS_OK)) {
+        req->send_batch.status = status;
+    }
+}
+
+static void ucp_send_batch_op_completed(ucp_request_t *req,
+                                        ucs_status_t status)
+{
+    ucp_send_batch_set_status(req, status);
+    if (--req->send_batch.comp_count == 0) {
+        ucs_trace_req("completing send batch request %p (%p) %s", req, req + 1,
+                      ucs_status_string(req->send_batch.status));
+        ucp_request_complete(req, send_batch.cb, req->send_batch.status);
+    }
+}
+
+static void ucp_send_batch_elem_completed(void *request, ucs_status_t status)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+
+    ucp_send_batch_op_completed(req->send.batch_req, status);
+}
+
+static void ucp_send_batch_copy_completed(void *request, ucs_status_t status)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+
+    ucs_free(req->send.buffer);
+    ucp_send_batch_op_completed(req->send.batch_req, status);
+}
+
+static ucs_status_t ucp_send_batch_progress_copy(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ssize_t packed_len;
+
+    req->send.lane = ucp_ep_get_am_lane(req->send.ep);
+    packed_len     = uct_ep_am_bcopy(req->send.ep->uct_eps[req->send.lane],
+                                     UCP_AM_ID_BATCH, ucp_send_batch_pack_copy,
+                                     req, 0);
+    if (packed_len == UCS_ERR_NO_RESOURCE) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    ucp_request_complete_send(req, (packed_len < 0) ?
+                                   (ucs_status_t)packed_len : UCS_OK);
+    return UCS_OK;
+}
+
+/*
+ * Send a copy of the packed messages from the pending queue, when the
+ * endpoint is out of resources
+ */
+static void ucp_send_batch_start_copy(ucp_request_t *req,
+                                      ucp_send_batch_pack_ctx_t *ctx,
+                                      size_t length)
+{
+    ucp_request_t *creq;
+    void *buffer;
+
+    creq = ucp_request_get(ctx->ep->worker);
+    if (creq == NULL) {
+        ucp_send_batch_set_status(req, UCS_ERR_NO_MEMORY);
+        return;
+    }
+
+    buffer = ucs_malloc(length, "send batch copy");
+    if (buffer == NULL) {
+        ucp_request_put(creq);
+        ucp_send_batch_set_status(req, UCS_ERR_NO_MEMORY);
+        return;
+    }
+
+    ucp_send_batch_pack(buffer, ctx);
+
+    creq->flags             = UCP_REQUEST_FLAG_RELEASED;
+    creq->send.ep           = ctx->ep;
+    creq->send.buffer       = buffer;
+    creq->send.length       = length;
+    creq->send.batch_req    = req;
+    creq->send.lane         = ucp_ep_get_am_lane(ctx->ep);
+    creq->send.pending_lane = UCP_NULL_LANE;
+    creq->send.uct.func     = ucp_send_batch_progress_copy;
+    creq->send.state.uct_comp.func = NULL;
+    ucp_request_set_callback(creq, send.cb, ucp_send_batch_copy_completed);
+
+    ++req->send_batch.comp_count;
+    ucp_request_send(creq, 0);
+}
+
+static void ucp_send_batch_start_packed(ucp_request_t *req,
+                                        ucp_send_batch_pack_ctx_t *ctx,
+                                        size_t length)
+{
+    ssize_t packed_len;
+    size_t i;
+
+    packed_len = uct_ep_am_bcopy(ucp_ep_get_am_uct_ep(ctx->ep), UCP_AM_ID_BATCH,
+                                 ucp_send_batch_pack, ctx, 0);
+    if (ucs_likely(packed_len >= 0)) {
+        ucs_assertv((size_t)packed_len == length, "packed_len=%zd length=%zu",
+                    packed_len, length);
+    } else if (packed_len == UCS_ERR_NO_RESOURCE) {
+        ucp_send_batch_start_copy(req, ctx, length);
+    } else {
+        ucp_send_batch_set_status(req, (ucs_status_t)packed_len);
+        return;
+    }
+
+    if (ctx->am_id == UCP_AM_ID_EAGER_ONLY) {
+        for (i = 0; i < ctx->count; ++i) {
+            UCP_EP_STAT_TAG_OP(ctx->ep, EAGER);
+        }
+    }
+}
+
+/*
+ * Send a message which is not packed with others by the regular send routine
+ */
+static void ucp_send_batch_start_elem(ucp_request_t *req, uint8_t am_id,
+                                      unsigned flags,
+                                      const ucp_send_batch_elem_t *elem)
+{
+    ucs_status_ptr_t status_ptr;
+    ucp_request_t *ereq;
+
+    switch (am_id) {
+    case UCP_AM_ID_EAGER_ONLY:
+        status_ptr = ucp_tag_send_nb(elem->ep, elem->buffer, elem->length,
+                                     ucp_dt_make_contig(1), elem->tag,
+                                     ucp_send_batch_elem_completed);
+        break;
+    case UCP_AM_ID_SINGLE:
+        status_ptr = ucp_am_send_nb(elem->ep, elem->am_id, elem->buffer,
+                                    elem->length, ucp_dt_make_contig(1),
+                                    ucp_send_batch_elem_completed, flags);
+        break;
+    default:
+        status_ptr = ucp_stream_send_nb(elem->ep, elem->buffer, elem->length,
+                                        ucp_dt_make_contig(1),
+                                        ucp_send_batch_elem_completed, 0);
+        break;
+    }
+
+    if (UCS_PTR_IS_PTR(status_ptr)) {
+        /* keep the callback, which completes the batch, and release the
+         * request when it is called */
+        ereq                 = (ucp_request_t*)status_ptr - 1;
+        ereq->send.batch_req = req;
+        ereq->flags         |= UCP_REQUEST_FLAG_RELEASED;
+        ++req->send_batch.comp_count;
+    } else {
+        ucp_send_batch_set_status(req, UCS_PTR_STATUS(status_ptr));
+    }
+}
+
+static ucs_status_ptr_t
+ucp_send_batch(const ucp_send_batch_elem_t *elems, size_t count,
+               uint8_t am_id, unsigned flags, ucp_send_callback_t cb)
+{
+    ucp_worker_h worker = elems[0].ep->worker;
+    ucp_send_batch_pack_ctx_t ctx;
+    size_t first, last, length, msg_length, max_length;
+    ucs_status_ptr_t ret;
+    ucp_request_t *req;
+    ucs_status_t status;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("send_batch count %zu am_id %u cb %p", count, am_id, cb);
+
+    req = ucp_request_get(worker);
+    if (req == NULL) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    /* the extra count is released when all sends are started */
+    req->flags                 = 0;
+    req->send_batch.comp_count = 1;
+    req->send_batch.status     = UCS_OK;
+
+    ctx.am_id = am_id;
+    for (first = 0; first < count; first = last) {
+        ctx.ep     = elems[first].ep;
+        max_length = ucp_ep_config(ctx.ep)->am.max_bcopy;
+        length     = 0;
+        ucs_assertv(ctx.ep->worker == worker, "ep=%p worker=%p expected=%p",
+                    ctx.ep, ctx.ep->worker, worker);
+
+        /* find the longest run of messages to the endpoint which fits in a
+         * single bcopy */
+        for (last = first; last < count; ++last) {
+            msg_length = sizeof(ucp_send_batch_hdr_t) +
+                         ucp_send_batch_msg_hdr_size(am_id) +
+                         elems[last].length;
+            if ((elems[last].ep != ctx.ep) ||
+                ((length + msg_length) > max_length) ||
+                !ucp_send_batch_is_packable(ctx.ep, am_id, flags,
+                                            &elems[last])) {
+                break;
+            }
+            length += msg_length;
+        }
+
+        if ((last - first) > 1) {
+            ctx.elems = &elems[first];
+            ctx.count = last - first;
+            ucp_send_batch_start_packed(req, &ctx, length);
+        } else {
+            ucp_send_batch_start_elem(req, am_id, flags, &elems[first]);
+            last = first + 1;
+        }
+    }
+
+    if (--req->send_batch.comp_count == 0) {
+        status = req->send_batch.status;
+        ucs_trace_req("releasing send batch request %p, returning status %s",
+                      req, ucs_status_string(status));
+        ucp_request_put(req);
+        ret = UCS_STATUS_PTR(status);
+        goto out;
+    }
+
+    ucp_request_set_callback(req, send_batch.cb, cb);
+    ucs_trace_req("returning send batch request %p", req);
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_batch_nb, (elems, count, cb),
+                 const ucp_send_batch_elem_t *elems, size_t count,
+                 ucp_send_callback_t cb)
+{
+    if (count == 0) {
+        return UCS_STATUS_PTR(UCS_OK);
+    }
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(elems[0].ep->worker->context,
+                                    UCP_FEATURE_TAG,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    return ucp_send_batch(elems, count, UCP_AM_ID_EAGER_ONLY, 0, cb);
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_batch_nb,
+                 (elems, count, cb, flags),
+                 const ucp_send_batch_elem_t *elems, size_t count,
+                 ucp_send_callback_t cb, unsigned flags)
+{
+    if (count == 0) {
+        return UCS_STATUS_PTR(UCS_OK);
+    }
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(elems[0].ep->worker->context,
+                                    UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    if (ucs_unlikely((flags != 0) && !(flags & UCP_AM_SEND_REPLY))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    return ucp_send_batch(elems, count, UCP_AM_ID_SINGLE, flags, cb);
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_send_batch_nb,
+                 (elems, count, cb),
+                 const ucp_send_batch_elem_t *elems, size_t count,
+                 ucp_send_callback_t cb)
+{
+    if (count == 0) {
+        return UCS_STATUS_PTR(UCS_OK);
+    }
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(elems[0].ep->worker->context,
+                                    UCP_FEATURE_STREAM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    return ucp_send_batch(elems, count, UCP_AM_ID_STREAM_DATA, 0, cb);
+}
+
+static ucs_status_t
+ucp_send_batch_handler(void *arg, void *data, size_t length, unsigned am_flags)
+{
+    ucp_send_batch_hdr_t *hdr;
+    ucs_status_t status UCS_V_UNUSED;
+
+    while (length > 0) {
+        hdr = data;
+        ucs_assert(length >= (sizeof(*hdr) + hdr->length));
+        ucs_assert((hdr->am_id == UCP_AM_ID_EAGER_ONLY) ||
+                   (hdr->am_id == UCP_AM_ID_SINGLE) ||
+                   (hdr->am_id == UCP_AM_ID_STREAM_DATA));
+
+        /* the message is not passed with the UCT descriptor flag, so the
+         * handler copies it if it has to be kept */
+        status = ucp_am_handlers[hdr->am_id].cb(arg, hdr + 1, hdr->length, 0);
+        ucs_assertv(status != UCS_INPROGRESS, "am_id=%u", hdr->am_id);
+
+        data    = UCS_PTR_BYTE_OFFSET(data, sizeof(*hdr) + hdr->length);
+        length -= sizeof(*hdr) + hdr->length;
+    }
+
+    return UCS_OK;
+}
+
+static void ucp_send_batch_dump(ucp_worker_h worker, uct_am_trace_type_t type,
+                                uint8_t id, const void *data, size_t length,
+                                char *buffer, size_t max)
+{
+    const ucp_send_batch_hdr_t *hdr;
+    unsigned count = 0;
+    size_t offset;
+
+    for (offset = 0; offset < length;
+         offset += sizeof(*hdr) + hdr->length) {
+        hdr = UCS_PTR_BYTE_OFFSET(data, offset);
+        ++count;
+    }
+
+    hdr = data;
+    snprintf(buffer, max, "BATCH am_id %u count %u", hdr->am_id, count);
+}
+
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_BATCH, ucp_send_batch_handler, ucp_send_batch_dump, 0);
+
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_BATCH);
@@ -0,0 +1,862 @@
+/**
+ * Copyright (C) The ourdemo authors 2026.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "ucp_thresh_profile.h"
+#include "ucp_worker.h"
+#include "ucp_ep.inl"
+
+#include <ucs/datastruct/string_buffer.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/string.h>
+#include <ucs/sys/sys.h>
+#include <ucs/time/time.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+
+
+/* Message sizes are measured from 1k to 4m, with two points per power of 2 */
+#define UCP_THRESH_CALIB_MIN_SIZE_LOG   10
+#define UCP_THRESH_CALIB_NUM_SIZES      25
+#define UCP_THRESH_CALIB_MAX_SIZE       \
+    ucp_thresh_calib_size(UCP_THRESH_CALIB_NUM_SIZES - 1)
+
+/* Time to spend on a single batch of transfers, and number of batches
+ * per message size; the fastest batch is taken to filter out noise */
+#define UCP_THRESH_CALIB_BATCH_TIME     2e-3
+#define UCP_THRESH_CALIB_MAX_ITERS      128
+#define UCP_THRESH_CALIB_NUM_BATCHES    5
+
+#define UCP_THRESH_CALIB_TAG            0x7471
+
+
+typedef enum {
+    UCP_THRESH_CALIB_BCOPY,
+    UCP_THRESH_CALIB_ZCOPY,
+    UCP_THRESH_CALIB_RNDV,
+    UCP_THRESH_CALIB_LAST
+} ucp_thresh_calib_proto_t;
+
+
+typedef struct {
+    char                        tl_name[UCT_TL_NAME_MAX];
+    char                        dev_name[UCT_DEVICE_NAME_MAX];
+    ucp_tl_thresh_t             thresh;
+} ucp_thresh_profile_entry_t;
+
+
+/* Values of UCX_ZCOPY_THRESH and UCX_RNDV_THRESH which force a protocol */
+static const char *ucp_thresh_calib_proto_config[][2] = {
+    [UCP_THRESH_CALIB_BCOPY] = {"inf",  "inf"},
+    [UCP_THRESH_CALIB_ZCOPY] = {"0",    "inf"},
+    [UCP_THRESH_CALIB_RNDV]  = {"auto", "0"}
+};
+
+static const char *ucp_thresh_calib_proto_names[] = {
+    [UCP_THRESH_CALIB_BCOPY] = "eager bcopy",
+    [UCP_THRESH_CALIB_ZCOPY] = "eager zcopy",
+    [UCP_THRESH_CALIB_RNDV]  = "rendezvous"
+};
+
+static const char *ucp_thresh_calib_devices_config[] = {
+    [UCT_DEVICE_TYPE_NET]  = "NET_DEVICES",
+    [UCT_DEVICE_TYPE_SHM]  = "SHM_DEVICES",
+    [UCT_DEVICE_TYPE_ACC]  = "ACC_DEVICES",
+    [UCT_DEVICE_TYPE_SELF] = "SELF_DEVICES"
+};
+
+
+static size_t ucp_thresh_calib_size(int index)
+{
+    size_t size = UCS_BIT(UCP_THRESH_CALIB_MIN_SIZE_LOG + (index / 2));
+
+    return (index % 2) ? (size + (size / 2)) : size;
+}
+
+static int ucp_thresh_profile_entry_match(const ucp_thresh_profile_entry_t *entry,
+                                          const uct_tl_resource_desc_t *tl_rsc)
+{
+    return !strcmp(entry->tl_name, tl_rsc->tl_name) &&
+           !strcmp(entry->dev_name, tl_rsc->dev_name);
+}
+
+static void ucp_thresh_profile_entry_print(FILE *stream, const char *tl_name,
+                                           const char *dev_name,
+                                           const ucp_tl_thresh_t *thresh)
+{
+    fprintf(stream, "%s/%s", tl_name, dev_name);
+    if (thresh->zcopy == UCS_MEMUNITS_INF) {
+        fprintf(stream, " zcopy_thresh=inf");
+    } else if (thresh->zcopy != UCS_MEMUNITS_AUTO) {
+        fprintf(stream, " zcopy_thresh=%zu", thresh->zcopy);
+    }
+    if (thresh->rndv == UCS_MEMUNITS_INF) {
+        fprintf(stream, " rndv_thresh=inf");
+    } else if (thresh->rndv != UCS_MEMUNITS_AUTO) {
+        fprintf(stream, " rndv_thresh=%zu", thresh->rndv);
+    }
+    fprintf(stream, "\n");
+}
+
+static ucs_status_t
+ucp_thresh_profile_parse_line(const char *filename, unsigned lineno, char *line,
+                              ucp_thresh_profile_entry_t *entry)
+{
+    char *saveptr, *token, *value;
+    ucs_status_t status;
+    size_t *thresh_p;
+
+    token = strtok_r(line, " \t\n", &saveptr);
+    value = (token == NULL) ? NULL : strchr(token, '/');
+    if (value == NULL) {
+        ucs_error("%s:%u: expected <tl_name>/<dev_name>", filename, lineno);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    *value = '\0';
+    ucs_strncpy_zero(entry->tl_name, token, sizeof(entry->tl_name));
+    ucs_strncpy_zero(entry->dev_name, value + 1, sizeof(entry->dev_name));
+    entry->thresh.zcopy = UCS_MEMUNITS_AUTO;
+    entry->thresh.rndv  = UCS_MEMUNITS_AUTO;
+
+    while ((token = strtok_r(NULL, " \t\n", &saveptr)) != NULL) {
+        value = strchr(token, '=');
+        if (value == NULL) {
+            ucs_error("%s:%u: expected <key>=<value>, got '%s'", filename,
+                      lineno, token);
+            return UCS_ERR_INVALID_PARAM;
+        }
+
+        *(value++) = '\0';
+        if (!strcmp(token, "zcopy_thresh")) {
+            thresh_p = &entry->thresh.zcopy;
+        } else if (!strcmp(token, "rndv_thresh")) {
+            thresh_p = &entry->thresh.rndv;
+        } else {
+            ucs_warn("%s:%u: ignoring unknown key '%s'", filename, lineno,
+                     token);
+            continue;
+        }
+
+        status = ucs_str_to_memunits(value, thresh_p);
+        if (status != UCS_OK) {
+            ucs_error("%s:%u: invalid %s value '%s'", filename, lineno, token,
+                      value);
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
+/* Returns UCS_ERR_NO_ELEM if the file does not exist */
+static ucs_status_t
+ucp_thresh_profile_read(const char *filename,
+                        ucp_thresh_profile_entry_t **entries_p,
+                        unsigned *num_entries_p)
+{
+    ucp_thresh_profile_entry_t *entries, *tmp;
+    unsigned num_entries, max_entries, lineno;
+    ucs_status_t status;
+    char line[1024];
+    char *p;
+    FILE *file;
+
+    file = fopen(filename, "r");
+    if (file == NULL) {
+        if (errno == ENOENT) {
+            return UCS_ERR_NO_ELEM;
+        }
+
+        ucs_error("failed to open threshold profile '%s': %m", filename);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    entries     = NULL;
+    num_entries = 0;
+    max_entries = 0;
+    lineno      = 0;
+    status      = UCS_OK;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        ++lineno;
+
+        p = line + strspn(line, " \t");
+        if ((*p == '#') || (*p == '\n') || (*p == '\0')) {
+            continue;
+        }
+
+        if (num_entries == max_entries) {
+            max_entries = ucs_max(8, max_entries * 2);
+            tmp         = ucs_realloc(entries, max_entries * sizeof(*entries),
+                                      "thresh_profile_entries");
+            if (tmp == NULL) {
+                status = UCS_ERR_NO_MEMORY;
+                break;
+            }
+            entries = tmp;
+        }
+
+        status = ucp_thresh_profile_parse_line(filename, lineno, p,
+                                               &entries[num_entries]);
+        if (status != UCS_OK) {
+            break;
+        }
+
+        ++num_entries;
+    }
+
+    fclose(file);
+
+    if (status != UCS_OK) {
+        ucs_free(entries);
+        return status;
+    }
+
+    *entries_p     = entries;
+    *num_entries_p = num_entries;
+    return UCS_OK;
+}
+
+static void ucp_thresh_profile_apply(ucp_context_h context,
+                                     const ucp_thresh_profile_entry_t *entries,
+                                     unsigned num_entries)
+{
+    ucp_rsc_index_t rsc_index;
+    unsigned i;
+
+    for (rsc_index = 0; rsc_index < context->num_tls; ++rsc_index) {
+        for (i = 0; i < num_entries; ++i) {
+            if (ucp_thresh_profile_entry_match(&entries[i],
+                                               &context->tl_rscs[rsc_index].tl_rsc)) {
+                context->config.tl_thresh[rsc_index] = entries[i].thresh;
+                context->config.tl_thresh_map       |= UCS_BIT(rsc_index);
+                ucs_debug("loaded thresholds of " UCT_TL_RESOURCE_DESC_FMT
+                          ": zcopy %zu rndv %zu",
+                          UCT_TL_RESOURCE_DESC_ARG(&context->tl_rscs[rsc_index].tl_rsc),
+                          entries[i].thresh.zcopy, entries[i].thresh.rndv);
+                break;
+            }
+        }
+    }
+}
+
+static int ucp_thresh_profile_is_eligible(ucp_context_h context,
+                                          ucp_rsc_index_t rsc_index)
+{
+    /* auxiliary and client-server resources never carry eager data */
+    return !(context->tl_rscs[rsc_index].flags &
+             (UCP_TL_RSC_FLAG_AUX | UCP_TL_RSC_FLAG_SOCKADDR));
+}
+
+static void ucp_thresh_calib_send_cb(void *request, ucs_status_t status)
+{
+}
+
+static void ucp_thresh_calib_recv_cb(void *request, ucs_status_t status,
+                                     ucp_tag_recv_info_t *info)
+{
+}
+
+static ucs_status_t ucp_thresh_calib_wait(ucp_worker_h worker,
+                                          ucs_status_ptr_t status_ptr)
+{
+    ucs_status_t status;
+
+    if (UCS_PTR_IS_ERR(status_ptr)) {
+        return UCS_PTR_STATUS(status_ptr);
+    } else if (status_ptr == NULL) {
+        return UCS_OK;
+    }
+
+    do {
+        ucp_worker_progress(worker);
+        status = ucp_request_check_status(status_ptr);
+    } while (status == UCS_INPROGRESS);
+
+    ucp_request_free(status_ptr);
+    return status;
+}
+
+static ucs_status_t ucp_thresh_calib_xfer(ucp_worker_h worker, ucp_ep_h ep,
+                                          void *send_buffer, void *recv_buffer,
+                                          size_t size)
+{
+    ucs_status_ptr_t send_req, recv_req;
+    ucs_status_t status;
+
+    recv_req = ucp_tag_recv_nb(worker, recv_buffer, size,
+                               ucp_dt_make_contig(1), UCP_THRESH_CALIB_TAG,
+                               (ucp_tag_t)-1, ucp_thresh_calib_recv_cb);
+    if (UCS_PTR_IS_ERR(recv_req)) {
+        return UCS_PTR_STATUS(recv_req);
+    }
+
+    send_req = ucp_tag_send_nb(ep, send_buffer, size, ucp_dt_make_contig(1),
+                               UCP_THRESH_CALIB_TAG, ucp_thresh_calib_send_cb);
+    status   = ucp_thresh_calib_wait(worker, send_req);
+    if (status != UCS_OK) {
+        ucp_request_cancel(worker, recv_req);
+    }
+
+    return ucs_max(ucp_thresh_calib_wait(worker, recv_req), status);
+}
+
+/* Returns the average time of a single transfer, in seconds */
+static ucs_status_t ucp_thresh_calib_measure(ucp_worker_h worker, ucp_ep_h ep,
+                                             void *send_buffer,
+                                             void *recv_buffer, size_t size,
+                                             double *time_p)
+{
+    unsigned batch, iter, num_iters;
+    ucs_time_t start_time;
+    ucs_status_t status;
+    double time;
+
+    /* warm-up, also estimates the number of iterations per batch */
+    start_time = ucs_get_time();
+    status     = ucp_thresh_calib_xfer(worker, ep, send_buffer, recv_buffer,
+                                       size);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    time      = ucs_time_to_sec(ucs_get_time() - start_time);
+    num_iters = ucs_max(1, ucs_min(UCP_THRESH_CALIB_MAX_ITERS,
+                                   UCP_THRESH_CALIB_BATCH_TIME / time));
+    *time_p   = time;
+
+    for (batch = 0; batch < UCP_THRESH_CALIB_NUM_BATCHES; ++batch) {
+        start_time = ucs_get_time();
+        for (iter = 0; iter < num_iters; ++iter) {
+            status = ucp_thresh_calib_xfer(worker, ep, send_buffer,
+                                           recv_buffer, size);
+            if (status != UCS_OK) {
+                return status;
+            }
+        }
+
+        time    = ucs_time_to_sec(ucs_get_time() - start_time) / num_iters;
+        *time_p = ucs_min(*time_p, time);
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucp_thresh_calib_ep_close(ucp_worker_h worker, ucp_ep_h ep)
+{
+    return ucp_thresh_calib_wait(worker,
+                                 ucp_ep_close_nb(ep, UCP_EP_CLOSE_MODE_FLUSH));
+}
+
+/*
+ * Measure the transfer times of a single protocol, over a loop-back endpoint
+ * in a temporary context which is restricted to the resource and its helper
+ * transports. Unsupported protocols are reported with infinite times.
+ */
+static ucs_status_t
+ucp_thresh_calib_proto(const uct_tl_resource_desc_t *tl_rsc, const char *tls,
+                       ucp_thresh_calib_proto_t proto, void *send_buffer,
+                       void *recv_buffer, double *times)
+{
+    ucp_worker_params_t worker_params;
+    const uct_tl_resource_desc_t *am_rsc;
+    ucp_ep_params_t ep_params;
+    ucp_params_t params;
+    ucp_address_t *address;
+    size_t address_length;
+    ucp_context_h context;
+    ucp_config_t *config;
+    ucp_worker_h worker;
+    ucp_ep_config_t *ep_config;
+    ucs_status_t status;
+    int supported;
+    ucp_ep_h ep;
+    int i;
+
+    status = ucp_config_read(NULL, NULL, &config);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucp_config_modify(config, "TLS", tls);
+    ucp_config_modify(config, ucp_thresh_calib_devices_config[tl_rsc->dev_type],
+                      tl_rsc->dev_name);
+    ucp_config_modify(config, "THRESH_PROFILE", "");
+    ucp_config_modify(config, "WARN_INVALID_CONFIG", "n");
+    ucp_config_modify(config, "ZCOPY_THRESH",
+                      ucp_thresh_calib_proto_config[proto][0]);
+    ucp_config_modify(config, "RNDV_THRESH",
+                      ucp_thresh_calib_proto_config[proto][1]);
+
+    params.field_mask = UCP_PARAM_FIELD_FEATURES;
+    params.features   = UCP_FEATURE_TAG;
+
+    status = ucp_init(&params, config, &context);
+    ucp_config_release(config);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
+    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+    worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+
+    status = ucp_worker_create(context, &worker_params, &worker);
+    if (status != UCS_OK) {
+        goto out_cleanup_context;
+    }
+
+    status = ucp_worker_get_address(worker, &address, &address_length);
+    if (status != UCS_OK) {
+        goto out_destroy_worker;
+    }
+
+    ep_params.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
+    ep_params.address    = address;
+
+    status = ucp_ep_create(worker, &ep_params, &ep);
+    ucp_worker_release_address(worker, address);
+    if (status != UCS_OK) {
+        goto out_destroy_worker;
+    }
+
+    /* eager data must go through the resource being measured */
+    am_rsc = &context->tl_rscs[ucp_ep_get_rsc_index(ep, ucp_ep_get_am_lane(ep))].tl_rsc;
+    if (strcmp(am_rsc->tl_name, tl_rsc->tl_name) ||
+        strcmp(am_rsc->dev_name, tl_rsc->dev_name)) {
+        ucs_debug("calibration of " UCT_TL_RESOURCE_DESC_FMT " selected "
+                  UCT_TL_RESOURCE_DESC_FMT " for active messages",
+                  UCT_TL_RESOURCE_DESC_ARG(tl_rsc),
+                  UCT_TL_RESOURCE_DESC_ARG(am_rsc));
+        status = UCS_ERR_UNSUPPORTED;
+        goto out_close_ep;
+    }
+
+    ep_config = ucp_ep_config(ep);
+    switch (proto) {
+    case UCP_THRESH_CALIB_ZCOPY:
+        supported = ep_config->tag.eager.zcopy_thresh[0] != SIZE_MAX;
+        break;
+    case UCP_THRESH_CALIB_RNDV:
+        supported = ucs_min(ep_config->tag.rndv.am_thresh,
+                            ep_config->tag.rndv.rma_thresh) != SIZE_MAX;
+        break;
+    default:
+        supported = 1;
+        break;
+    }
+
+    for (i = 0; i < UCP_THRESH_CALIB_NUM_SIZES; ++i) {
+        if (!supported) {
+            times[i] = INFINITY;
+            continue;
+        }
+
+        status = ucp_thresh_calib_measure(worker, ep, send_buffer, recv_buffer,
+                                          ucp_thresh_calib_size(i), &times[i]);
+        if (status != UCS_OK) {
+            goto out_close_ep;
+        }
+
+        ucs_trace("calibration of " UCT_TL_RESOURCE_DESC_FMT ": %s %zu bytes "
+                  "%.3f usec", UCT_TL_RESOURCE_DESC_ARG(tl_rsc),
+                  ucp_thresh_calib_proto_names[proto], ucp_thresh_calib_size(i),
+                  times[i] * 1e6);
+    }
+
+out_close_ep:
+    ucp_thresh_calib_ep_close(worker, ep);
+out_destroy_worker:
+    ucp_worker_destroy(worker);
+out_cleanup_context:
+    ucp_cleanup(context);
+out:
+    return status;
+}
+
+/*
+ * Find the size from which to switch to the @a fast protocol. Every candidate
+ * is scored by the slowdown it causes over all measured sizes, relative to
+ * the better protocol at each size, so a few noisy measurements do not move
+ * the threshold far. Returns UCS_MEMUNITS_AUTO if switching does not pay off
+ * within the measured range.
+ */
+static size_t ucp_thresh_calib_crossover(const double *slow, const double *fast)
+{
+    double cost, best_cost;
+    int i, j, best_index;
+
+    best_index = UCP_THRESH_CALIB_NUM_SIZES;
+    best_cost  = INFINITY;
+    for (i = UCP_THRESH_CALIB_NUM_SIZES; i >= 0; --i) {
+        cost = 0;
+        for (j = 0; j < UCP_THRESH_CALIB_NUM_SIZES; ++j) {
+            cost += ((j < i) ? slow[j] : fast[j]) / ucs_min(slow[j], fast[j]);
+        }
+
+        /* on a tie, prefer the larger threshold */
+        if (cost < best_cost) {
+            best_cost  = cost;
+            best_index = i;
+        }
+    }
+
+    if (best_index == UCP_THRESH_CALIB_NUM_SIZES) {
+        return UCS_MEMUNITS_AUTO;
+    }
+
+    return ucp_thresh_calib_size(best_index);
+}
+
+static ucs_status_t
+ucp_thresh_calib_resource(const uct_tl_resource_desc_t *tl_rsc,
+                          const char *tls, void *send_buffer, void *recv_buffer,
+                          ucp_tl_thresh_t *thresh)
+{
+    double times[UCP_THRESH_CALIB_LAST][UCP_THRESH_CALIB_NUM_SIZES];
+    double eager_times[UCP_THRESH_CALIB_NUM_SIZES];
+    ucp_thresh_calib_proto_t proto;
+    ucs_status_t status;
+    int i;
+
+    for (proto = 0; proto < UCP_THRESH_CALIB_LAST; ++proto) {
+        status = ucp_thresh_calib_proto(tl_rsc, tls, proto, send_buffer,
+                                        recv_buffer, times[proto]);
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
+
+    thresh->zcopy = ucp_thresh_calib_crossover(times[UCP_THRESH_CALIB_BCOPY],
+                                               times[UCP_THRESH_CALIB_ZCOPY]);
+
+    /* rendezvous competes with the eager protocol which would be selected */
+    for (i = 0; i < UCP_THRESH_CALIB_NUM_SIZES; ++i) {
+        if ((thresh->zcopy != UCS_MEMUNITS_AUTO) &&
+            (ucp_thresh_calib_size(i) >= thresh->zcopy)) {
+            eager_times[i] = times[UCP_THRESH_CALIB_ZCOPY][i];
+        } else {
+            eager_times[i] = times[UCP_THRESH_CALIB_BCOPY][i];
+        }
+    }
+
+    thresh->rndv = ucp_thresh_calib_crossover(eager_times,
+                                              times[UCP_THRESH_CALIB_RNDV]);
+    return UCS_OK;
+}
+
+ucs_status_t ucp_thresh_profile_calibrate(ucp_context_h context, int force)
+{
+    uint64_t am_tl_bitmap, helper_tl_bitmap, eligible_bitmap;
+    ucp_worker_params_t worker_params;
+    const uct_tl_resource_desc_t *tl_rsc;
+    void *send_buffer, *recv_buffer;
+    ucp_rsc_index_t rsc_index, i;
+    uint64_t cap_flags;
+    ucs_status_t status;
+    ucp_worker_h worker;
+    ucs_string_buffer_t tls;
+
+    /* open the interfaces once to find which resources can send eager data,
+     * and which ones can only help the rendezvous protocol on their device */
+    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+    worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+
+    status = ucp_worker_create(context, &worker_params, &worker);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    am_tl_bitmap     = 0;
+    helper_tl_bitmap = 0;
+    eligible_bitmap  = 0;
+    ucs_for_each_bit(rsc_index, context->tl_bitmap) {
+        if (!ucp_thresh_profile_is_eligible(context, rsc_index)) {
+            continue;
+        }
+
+        eligible_bitmap |= UCS_BIT(rsc_index);
+        cap_flags        = ucp_worker_iface_get_attr(worker, rsc_index)->cap.flags;
+        if (cap_flags & UCT_IFACE_FLAG_AM_BCOPY) {
+            am_tl_bitmap |= UCS_BIT(rsc_index);
+        } else if (cap_flags & (UCT_IFACE_FLAG_GET_ZCOPY |
+                                UCT_IFACE_FLAG_PUT_ZCOPY)) {
+            helper_tl_bitmap |= UCS_BIT(rsc_index);
+        }
+    }
+
+    ucp_worker_destroy(worker);
+
+    if (!force) {
+        am_tl_bitmap    &= ~context->config.tl_thresh_map;
+        eligible_bitmap &= ~context->config.tl_thresh_map;
+    }
+
+    /* resources which cannot send eager data are listed without thresholds,
+     * so they do not trigger another calibration */
+    context->config.tl_thresh_map |= eligible_bitmap;
+
+    send_buffer = ucs_malloc(UCP_THRESH_CALIB_MAX_SIZE, "thresh_calib_send");
+    recv_buffer = ucs_malloc(UCP_THRESH_CALIB_MAX_SIZE, "thresh_calib_recv");
+    if ((send_buffer == NULL) || (recv_buffer == NULL)) {
+        status = UCS_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    memset(send_buffer, 0, UCP_THRESH_CALIB_MAX_SIZE);
+    memset(recv_buffer, 0, UCP_THRESH_CALIB_MAX_SIZE);
+
+    ucs_for_each_bit(rsc_index, am_tl_bitmap) {
+        tl_rsc = &context->tl_rscs[rsc_index].tl_rsc;
+
+        ucs_string_buffer_init(&tls);
+        ucs_string_buffer_appendf(&tls, "%s", tl_rsc->tl_name);
+        ucs_for_each_bit(i, helper_tl_bitmap) {
+            if (!strcmp(context->tl_rscs[i].tl_rsc.dev_name, tl_rsc->dev_name)) {
+                ucs_string_buffer_appendf(&tls, ",%s",
+                                          context->tl_rscs[i].tl_rsc.tl_name);
+            }
+        }
+
+        ucs_debug("calibrating thresholds of " UCT_TL_RESOURCE_DESC_FMT
+                  " with tls %s", UCT_TL_RESOURCE_DESC_ARG(tl_rsc),
+                  ucs_string_buffer_cstr(&tls));
+
+        status = ucp_thresh_calib_resource(tl_rsc, ucs_string_buffer_cstr(&tls),
+                                           send_buffer, recv_buffer,
+                                           &context->config.tl_thresh[rsc_index]);
+        ucs_string_buffer_cleanup(&tls);
+        if (status != UCS_OK) {
+            ucs_info("failed to calibrate thresholds of " UCT_TL_RESOURCE_DESC_FMT
+                     ": %s", UCT_TL_RESOURCE_DESC_ARG(tl_rsc),
+                     ucs_status_string(status));
+            context->config.tl_thresh[rsc_index].zcopy = UCS_MEMUNITS_AUTO;
+            context->config.tl_thresh[rsc_index].rndv  = UCS_MEMUNITS_AUTO;
+            continue;
+        }
+
+        ucs_debug("calibrated thresholds of " UCT_TL_RESOURCE_DESC_FMT
+                  ": zcopy %zu rndv %zu", UCT_TL_RESOURCE_DESC_ARG(tl_rsc),
+                  context->config.tl_thresh[rsc_index].zcopy,
+                  context->config.tl_thresh[rsc_index].rndv);
+    }
+
+    status = UCS_OK;
+
+out:
+    ucs_free(recv_buffer);
+    ucs_free(send_buffer);
+    return status;
+}
+
+ucs_status_t ucp_thresh_profile_save(ucp_context_h context,
+                                     const char *filename)
+{
+    ucp_thresh_profile_entry_t *entries;
+    char tmp_filename[PATH_MAX];
+    ucp_rsc_index_t rsc_index;
+    unsigned i, num_entries;
+    ucs_status_t status;
+    FILE *file;
+
+    status = ucp_thresh_profile_read(filename, &entries, &num_entries);
+    if (status == UCS_ERR_NO_ELEM) {
+        entries     = NULL;
+        num_entries = 0;
+    } else if (status != UCS_OK) {
+        return status;
+    }
+
+    /* write to a temporary file and rename it, so concurrent readers never
+     * see a partial profile */
+    ucs_snprintf_zero(tmp_filename, sizeof(tmp_filename), "%s.%d", filename,
+                      getpid());
+    file = fopen(tmp_filename, "w");
+    if (file == NULL) {
+        ucs_error("failed to create threshold profile '%s': %m", tmp_filename);
+        status = UCS_ERR_IO_ERROR;
+        goto out;
+    }
+
+    fprintf(file, "# UCX protocol thresholds of host %s\n", ucs_get_host_name());
+
+    /* keep the entries of resources which this context does not use */
+    for (i = 0; i < num_entries; ++i) {
+        for (rsc_index = 0; rsc_index < context->num_tls; ++rsc_index) {
+            if ((context->config.tl_thresh_map & UCS_BIT(rsc_index)) &&
+                ucp_thresh_profile_entry_match(&entries[i],
+                                               &context->tl_rscs[rsc_index].tl_rsc)) {
+                break;
+            }
+        }
+
+        if (rsc_index == context->num_tls) {
+            ucp_thresh_profile_entry_print(file, entries[i].tl_name,
+                                           entries[i].dev_name,
+                                           &entries[i].thresh);
+        }
+    }
+
+    ucp_thresh_profile_print(context, file);
+
+    if (fclose(file) != 0) {
+        ucs_error("failed to write threshold profile '%s': %m", tmp_filename);
+        unlink(tmp_filename);
+        status = UCS_ERR_IO_ERROR;
+        goto out;
+    }
+
+    if (rename(tmp_filename, filename) != 0) {
+        ucs_error("failed to rename '%s' to '%s': %m", tmp_filename, filename);
+        unlink(tmp_filename);
+        status = UCS_ERR_IO_ERROR;
+        goto out;
+    }
+
+    status = UCS_OK;
+
+out:
+    ucs_free(entries);
+    return status;
+}
+
+void ucp_thresh_profile_print(ucp_context_h context, FILE *stream)
+{
+    ucp_rsc_index_t rsc_index;
+
+    ucs_for_each_bit(rsc_index, context->config.tl_thresh_map) {
+        ucp_thresh_profile_entry_print(stream,
+                                       context->tl_rscs[rsc_index].tl_rsc.tl_name,
+                                       context->tl_rscs[rsc_index].tl_rsc.dev_name,
+                                       &context->config.tl_thresh[rsc_index]);
+    }
+}
+
+ucs_status_t ucp_thresh_profile_init(ucp_context_h context,
+                                     const ucp_config_t *config)
+{
+    ucp_thresh_profile_entry_t *entries;
+    pthread_mutexattr_t attr;
+    ucp_rsc_index_t rsc_index;
+    char filename[PATH_MAX];
+    unsigned num_entries;
+    ucs_status_t status;
+    int missing;
+    int ret;
+
+    context->config.tl_thresh = ucs_malloc(ucs_max(1, context->num_tls) *
+                                           sizeof(*context->config.tl_thresh),
+                                           "ucp_tl_thresh");
+    if (context->config.tl_thresh == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    for (rsc_index = 0; rsc_index < context->num_tls; ++rsc_index) {
+        context->config.tl_thresh[rsc_index].zcopy = UCS_MEMUNITS_AUTO;
+        context->config.tl_thresh[rsc_index].rndv  = UCS_MEMUNITS_AUTO;
+    }
+    context->config.tl_thresh_map        = 0;
+    context->config.thresh_calib_file    = NULL;
+    context->config.thresh_calib_running = 0;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    ret = pthread_mutex_init(&context->config.thresh_calib_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (ret != 0) {
+        ucs_error("failed to initialize calibration lock: %s", strerror(ret));
+        ucs_free(context->config.tl_thresh);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if (!strlen(config->thresh_profile)) {
+        return UCS_OK;
+    }
+
+    ucs_fill_filename_template(config->thresh_profile, filename,
+                               sizeof(filename));
+
+    status = ucp_thresh_profile_read(filename, &entries, &num_entries);
+    if (status == UCS_OK) {
+        ucp_thresh_profile_apply(context, entries, num_entries);
+        ucs_free(entries);
+    } else if (status != UCS_ERR_NO_ELEM) {
+        /* a broken profile falls back to the estimated thresholds */
+        ucs_warn("ignoring threshold profile '%s'", filename);
+        return UCS_OK;
+    }
+
+    if (!config->thresh_calibrate) {
+        return UCS_OK;
+    }
+
+    missing = 0;
+    for (rsc_index = 0; rsc_index < context->num_tls; ++rsc_index) {
+        if (ucp_thresh_profile_is_eligible(context, rsc_index) &&
+            !(context->config.tl_thresh_map & UCS_BIT(rsc_index))) {
+            missing = 1;
+        }
+    }
+
+    if (missing) {
+        /* measuring requires a worker, so it is deferred to the first one */
+        context->config.thresh_calib_file = ucs_strdup(filename,
+                                                       "thresh_calib_file");
+    }
+
+    return UCS_OK;
+}
+
+void ucp_thresh_profile_calibrate_pending(ucp_context_h context)
+{
+    ucs_status_t status;
+
+    /* other threads creating workers wait for the thresholds, even if the
+     * context is not shared between threads, since the workers may be */
+    pthread_mutex_lock(&context->config.thresh_calib_lock);
+
+    /* the calibration creates a worker on this context to probe the
+     * interfaces, which must not calibrate again */
+    if ((context->config.thresh_calib_file == NULL) ||
+        context->config.thresh_calib_running) {
+        goto out;
+    }
+
+    context->config.thresh_calib_running = 1;
+
+    /* calibration is best effort, the context is usable without it */
+    status = ucp_thresh_profile_calibrate(context, 0);
+    if (status != UCS_OK) {
+        ucs_warn("failed to calibrate protocol thresholds: %s",
+                 ucs_status_string(status));
+    } else if (ucp_thresh_profile_save(context,
+                                       context->config.thresh_calib_file) ==
+               UCS_OK) {
+        ucs_info("saved protocol thresholds to '%s'",
+                 context->config.thresh_calib_file);
+    }
+
+    context->config.thresh_calib_running = 0;
+    ucs_free(context->config.thresh_calib_file);
+    context->config.thresh_calib_file    = NULL;
+
+out:
+    pthread_mutex_unlock(&context->config.thresh_calib_lock);
+}
+
+void ucp_thresh_profile_cleanup(ucp_context_h context)
+{
+    pthread_mutex_destroy(&context->config.thresh_calib_lock);
+    ucs_free(context->config.thresh_calib_file);
+    ucs_free(context->config.tl_thresh);
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) The ourdemo authors 2026.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCP_THRESH_PROFILE_H_
+#define UCP_THRESH_PROFILE_H_
+
+#include "ucp_context.h"
+
+#include <stdio.h>
+
+
+/*
+ * Protocol thresholds profile
+ *
+ * The profile is a text file which holds the zero-copy and rendezvous
+ * thresholds measured on a host, one line per transport resource:
+ *
+ *   <tl_name>/<dev_name> zcopy_thresh=<size> rndv_thresh=<size>
+ *
+ * Empty lines and lines starting with '#' are ignored, and a missing key means
+ * the threshold was not measured. Thresholds of the resources listed in the
+ * profile replace the estimated ones when UCX_ZCOPY_THRESH or UCX_RNDV_THRESH
+ * are set to "auto".
+ */
+
+
+/**
+ * Initialize the per-resource thresholds of the context: load them from the
+ * profile file, and schedule a calibration of the ones which are missing if it
+ * is enabled in @a config.
+ */
+ucs_status_t ucp_thresh_profile_init(ucp_context_h context,
+                                     const ucp_config_t *config);
+
+
+void ucp_thresh_profile_cleanup(ucp_context_h context);
+
+
+/**
+ * Run the calibration scheduled by @ref ucp_thresh_profile_init, if any, and
+ * save the results to the profile file. Called when a worker is created, so
+ * the context is complete and the thresholds are known before the first
+ * endpoint configuration is built.
+ */
+void ucp_thresh_profile_calibrate_pending(ucp_context_h context);
+
+
+/**
+ * Measure the protocol thresholds of the context resources by transferring
+ * messages of growing sizes over a loop-back endpoint.
+ *
+ * @param [in]  context     Context whose resources to measure.
+ * @param [in]  force       Measure also the resources which already have
+ *                          thresholds.
+ */
+ucs_status_t ucp_thresh_profile_calibrate(ucp_context_h context, int force);
+
+
+/**
+ * Save the thresholds of the context resources to a profile file. Entries of
+ * other resources which already exist in the file are preserved.
+ */
+ucs_status_t ucp_thresh_profile_save(ucp_context_h context,
+                                     const char *filename);
+
+
+/**
+ * Print the thresholds of the context resources in the profile file format.
+ */
+void ucp_thresh_profile_print(ucp_context_h context, FILE *stream);
+
+#endif
@@ -92,6 +92,14 @@ enum {
     UCP_AM_ID_SINGLE_REPLY      =  25, /* For user defined AM when a reply
                                           is needed */
     UCP_AM_ID_MULTI_REPLY       =  26,
+    UCP_AM_ID_AM_RTS            =  27, /* Ready-to-Send of a user defined AM
+                                          whose payload is fetched with
+                                          rendezvous */
+    UCP_AM_ID_STREAM_RTS        =  28, /* Ready-to-Send of a rendezvous STREAM
+                                          send */
+    UCP_AM_ID_BATCH             =  29, /* Several eager TAG, STREAM or user
+                                          defined Active Messages packed
+                                          together */
     UCP_AM_ID_LAST
 };
 
@@ -13,6 +13,7 @@
 #include "ucp_worker.h"
 #include "ucp_mm.h"
 #include "ucp_request.inl"
+#include "ucp_thresh_profile.h"
 
 #include <ucp/wireup/address.h>
 #include <ucp/wireup/wireup_cm.h>
@@ -1654,6 +1655,9 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     ucp_worker_h worker;
     ucs_status_t status;
 
+    /* endpoints of the worker need the thresholds measured on this host */
+    ucp_thresh_profile_calibrate_pending(context);
+
     config_count = ucs_min((context->num_tls + 1) * (context->num_tls + 1) * context->num_tls,
                            UINT8_MAX);
 
@@ -1688,6 +1692,7 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     worker->uuid              = ucs_generate_uuid((uintptr_t)worker);
     worker->flush_ops_count   = 0;
     worker->inprogress        = 0;
+    worker->req_release_list  = NULL;
     worker->ep_config_max     = config_count;
     worker->ep_config_count   = 0;
     worker->num_active_ifaces = 0;
@@ -1695,6 +1700,7 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     worker->am_message_id     = ucs_generate_uuid(0);
     ucs_list_head_init(&worker->arm_ifaces);
     ucs_list_head_init(&worker->stream_ready_eps);
+    ucs_queue_head_init(&worker->stream_fetch_q);
     ucs_list_head_init(&worker->all_eps);
     ucp_ep_match_init(&worker->ep_match_ctx);
 
@@ -1867,6 +1873,24 @@ static void ucp_worker_destroy_ep_configs(ucp_worker_h worker)
     worker->ep_config_count = 0;
 }
 
+/* Worker lock must be held */
+static void ucp_worker_put_released_requests(ucp_worker_h worker)
+{
+    ucp_request_t *req, *next;
+
+    if (ucs_likely(worker->req_release_list == NULL)) {
+        return;
+    }
+
+    req = (ucp_request_t*)ucs_atomic_swap64(
+                    (volatile uint64_t*)&worker->req_release_list, 0);
+    while (req != NULL) {
+        next = req->release.next;
+        ucp_request_put(req);
+        req  = next;
+    }
+}
+
 void ucp_worker_destroy(ucp_worker_h worker)
 {
     ucs_trace_func("worker=%p", worker);
@@ -1876,6 +1900,7 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucp_worker_destroy_eps(worker);
     ucp_worker_remove_am_handlers(worker);
     ucp_worker_close_cms(worker);
+    ucp_worker_put_released_requests(worker);
     UCS_ASYNC_UNBLOCK(&worker->async);
 
     ucp_worker_destroy_ep_configs(worker);
@@ -1941,13 +1966,18 @@ unsigned ucp_worker_progress(ucp_worker_h worker)
 {
     unsigned count;
 
+    /* If another thread is holding the worker, return instead of waiting for
+     * it; the caller is going to call progress again anyway.
+     */
+    if (!UCP_WORKER_THREAD_CS_TRY_ENTER_CONDITIONAL(worker)) {
+        return 0;
+    }
+
     /* worker->inprogress is used only for assertion check.
      * coverity[assert_side_effect]
      */
-    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
-
-    /* check that ucp_worker_progress is not called from within ucp_worker_progress */
     ucs_assert(worker->inprogress++ == 0);
+    ucp_worker_put_released_requests(worker);
     count = uct_worker_progress(worker->uct);
     ucs_async_check_miss(&worker->async);
 
@@ -44,10 +44,16 @@
     } while (0)
 
 
+#define UCP_WORKER_THREAD_CS_TRY_ENTER_CONDITIONAL(_worker)             \
+    (!((_worker)->flags & UCP_WORKER_FLAG_MT) ||                        \
+     ucs_async_try_block(&(_worker)->async))
+
+
 #else
 
 #define UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(_worker)
 #define UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(_worker)
+#define UCP_WORKER_THREAD_CS_TRY_ENTER_CONDITIONAL(_worker)             1
 
 #endif
 
@@ -208,6 +214,8 @@ typedef struct ucp_worker {
     uint64_t                      uuid;          /* Unique ID for wireup */
     uct_worker_h                  uct;           /* UCT worker handle */
     ucs_mpool_t                   req_mp;        /* Memory pool for requests */
+    ucp_request_t * volatile      req_release_list; /* Completed requests released
+                                                       without the worker lock */
     ucs_mpool_t                   rkey_mp;       /* Pool for small memory keys */
     uint64_t                      atomic_tls;    /* Which resources can be used for atomics */
 
@@ -225,6 +233,7 @@ typedef struct ucp_worker {
     void                          *user_data;    /* User-defined data */
     ucs_strided_alloc_t           ep_alloc;      /* Endpoint allocator */
     ucs_list_link_t               stream_ready_eps; /* List of EPs with received stream data */
+    ucs_queue_head_t              stream_fetch_q; /* Stream rendezvous fetches in flight */
     ucs_list_link_t               all_eps;       /* List of all endpoints */
     ucp_ep_match_ctx_t            ep_match_ctx;  /* Endpoint-to-endpoint matching context */
     ucp_worker_iface_t            **ifaces;      /* Array of pointers to interfaces,
@@ -126,6 +126,13 @@ size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
         result_len = length;
         break;
 
+    case UCP_DATATYPE_STRIDED:
+        ucs_assert(UCP_MEM_IS_ACCESSIBLE_FROM_CPU(mem_type));
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_gather, dest, src, datatype,
+                              length, state->offset);
+        result_len = length;
+        break;
+
     case UCP_DATATYPE_GENERIC:
         dt = ucp_dt_generic(datatype);
         result_len = UCS_PROFILE_NAMED_CALL("dt_pack", dt->ops.pack,
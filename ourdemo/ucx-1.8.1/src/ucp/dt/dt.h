@@ -11,6 +11,7 @@
 #include "dt_contig.h"
 #include "dt_iov.h"
 #include "dt_generic.h"
+#include "dt_strided.h"
 
 #include <ucp/core/ucp_types.h>
 #include <uct/api/uct.h>
@@ -32,7 +33,8 @@ typedef struct ucp_dt_reg {
 typedef struct ucp_dt_state {
     size_t                        offset;  /* Total offset in overall payload. */
     union {
-        ucp_dt_reg_t              contig;
+        ucp_dt_reg_t              contig;  /* Also used by strided, which
+                                              registers the whole extent */
         struct {
             size_t                iov_offset;     /* Offset in the IOV item */
             size_t                iovcnt_offset;  /* The IOV item to start copy */
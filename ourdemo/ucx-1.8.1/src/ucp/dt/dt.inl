@@ -26,6 +26,9 @@ size_t ucp_dt_length(ucp_datatype_t datatype, size_t count,
         ucs_assert(NULL != iov);
         return ucp_dt_iov_length(iov, count);
 
+    case UCP_DATATYPE_STRIDED:
+        return ucp_dt_strided_length(datatype, count);
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(datatype);
         ucs_assert(NULL != state);
@@ -73,6 +76,15 @@ ucp_dt_unpack_only(ucp_worker_h worker, void *buffer, size_t count,
                          &iov_offset, &iovcnt_offset);
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        if (truncation &&
+            ucs_unlikely(length > (buffer_size = ucp_dt_strided_length(datatype, count)))) {
+            goto err_truncated;
+        }
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_scatter, buffer, data, datatype,
+                              length, 0);
+        return UCS_OK;
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(datatype);
         state  = UCS_PROFILE_NAMED_CALL("dt_start", dt_gen->ops.start_unpack,
@@ -105,6 +117,7 @@ ucp_dt_recv_state_init(ucp_dt_state_t *dt_state, void *buffer,
 
     switch (dt & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
+    case UCP_DATATYPE_STRIDED:
         dt_state->dt.contig.md_map     = 0;
         break;
    case UCP_DATATYPE_IOV:
@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) The ourdemo authors 2026.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "dt_strided.h"
+
+#include <ucs/arch/cpu.h>
+#include <ucs/sys/math.h>
+
+#include <string.h>
+
+
+/* Fixed-size memcpy() is expanded by the compiler to a few (vector) moves,
+ * so the common element sizes get a dedicated loop without a function call
+ * per element */
+#define UCP_DT_STRIDED_COPY_ELEMS(_size, _dst, _dst_step, _src, _src_step, \
+                                  _count) \
+    { \
+        size_t _i; \
+        for (_i = 0; _i < (_count); ++_i) { \
+            memcpy(UCS_PTR_BYTE_OFFSET(_dst, _i * (_dst_step)), \
+                   UCS_PTR_BYTE_OFFSET(_src, _i * (_src_step)), _size); \
+        } \
+    }
+
+
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy_elems(void *dst, size_t dst_step, const void *src,
+                          size_t src_step, size_t elem_size, size_t count)
+{
+    size_t i;
+
+    switch (elem_size) {
+    case 1:
+        UCP_DT_STRIDED_COPY_ELEMS(1, dst, dst_step, src, src_step, count);
+        break;
+    case 2:
+        UCP_DT_STRIDED_COPY_ELEMS(2, dst, dst_step, src, src_step, count);
+        break;
+    case 4:
+        UCP_DT_STRIDED_COPY_ELEMS(4, dst, dst_step, src, src_step, count);
+        break;
+    case 8:
+        UCP_DT_STRIDED_COPY_ELEMS(8, dst, dst_step, src, src_step, count);
+        break;
+    case 16:
+        UCP_DT_STRIDED_COPY_ELEMS(16, dst, dst_step, src, src_step, count);
+        break;
+    case 32:
+        UCP_DT_STRIDED_COPY_ELEMS(32, dst, dst_step, src, src_step, count);
+        break;
+    default:
+        for (i = 0; i < count; ++i) {
+            ucs_memcpy_relaxed(UCS_PTR_BYTE_OFFSET(dst, i * dst_step),
+                               UCS_PTR_BYTE_OFFSET(src, i * src_step),
+                               elem_size);
+        }
+        break;
+    }
+}
+
+/*
+ * Copy @a length bytes between the packed buffer and the strided buffer,
+ * starting at @a offset in the packed data.
+ */
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy(void *packed, void *buffer, ucp_datatype_t datatype,
+                    size_t length, size_t offset, int is_pack)
+{
+    size_t elem_size = ucp_dt_strided_elem_size(datatype);
+    size_t stride    = ucp_dt_strided_stride(datatype);
+    size_t elem_offset, count, len;
+    void *elem;
+
+    ucs_assert(elem_size > 0);
+    ucs_assert(stride >= elem_size);
+
+    if (stride == elem_size) {
+        /* dense layout, same as contiguous */
+        elem = UCS_PTR_BYTE_OFFSET(buffer, offset);
+        if (is_pack) {
+            ucs_memcpy_relaxed(packed, elem, length);
+        } else {
+            ucs_memcpy_relaxed(elem, packed, length);
+        }
+        return;
+    }
+
+    elem        = UCS_PTR_BYTE_OFFSET(buffer, (offset / elem_size) * stride);
+    elem_offset = offset % elem_size;
+
+    /* head: the rest of a partially copied element */
+    if (elem_offset != 0) {
+        len = ucs_min(elem_size - elem_offset, length);
+        if (is_pack) {
+            memcpy(packed, UCS_PTR_BYTE_OFFSET(elem, elem_offset), len);
+        } else {
+            memcpy(UCS_PTR_BYTE_OFFSET(elem, elem_offset), packed, len);
+        }
+        packed  = UCS_PTR_BYTE_OFFSET(packed, len);
+        elem    = UCS_PTR_BYTE_OFFSET(elem, stride);
+        length -= len;
+    }
+
+    /* body: whole elements */
+    count = length / elem_size;
+    if (is_pack) {
+        ucp_dt_strided_copy_elems(packed, elem_size, elem, stride, elem_size,
+                                  count);
+    } else {
+        ucp_dt_strided_copy_elems(elem, stride, packed, elem_size, elem_size,
+                                  count);
+    }
+
+    /* tail: the beginning of the last element */
+    len = length - (count * elem_size);
+    if (len != 0) {
+        packed = UCS_PTR_BYTE_OFFSET(packed, count * elem_size);
+        elem   = UCS_PTR_BYTE_OFFSET(elem, count * stride);
+        if (is_pack) {
+            memcpy(packed, elem, len);
+        } else {
+            memcpy(elem, packed, len);
+        }
+    }
+}
+
+void ucp_dt_strided_gather(void *dest, const void *src, ucp_datatype_t datatype,
+                           size_t length, size_t offset)
+{
+    ucp_dt_strided_copy(dest, (void*)src, datatype, length, offset, 1);
+}
+
+void ucp_dt_strided_scatter(void *dest, const void *src, ucp_datatype_t datatype,
+                            size_t length, size_t offset)
+{
+    ucp_dt_strided_copy((void*)src, dest, datatype, length, offset, 0);
+}
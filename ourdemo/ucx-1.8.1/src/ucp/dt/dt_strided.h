@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) The ourdemo authors 2026.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+
+#ifndef UCP_DT_STRIDED_H_
+#define UCP_DT_STRIDED_H_
+
+#include <ucp/api/ucp.h>
+#include <ucs/debug/assert.h>
+
+
+#define UCP_DT_IS_STRIDED(_datatype) \
+    (((_datatype) & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_STRIDED)
+
+
+static inline size_t ucp_dt_strided_elem_size(ucp_datatype_t datatype)
+{
+    return (datatype >> UCP_DATATYPE_SHIFT) &
+           UCS_MASK(UCP_DATATYPE_STRIDE_SHIFT - UCP_DATATYPE_SHIFT);
+}
+
+static inline size_t ucp_dt_strided_stride(ucp_datatype_t datatype)
+{
+    return datatype >> UCP_DATATYPE_STRIDE_SHIFT;
+}
+
+/**
+ * Get the packed length of @a count elements
+ */
+static inline size_t ucp_dt_strided_length(ucp_datatype_t datatype,
+                                           size_t count)
+{
+    ucs_assert(UCP_DT_IS_STRIDED(datatype));
+    return count * ucp_dt_strided_elem_size(datatype);
+}
+
+/**
+ * Get the size of the memory region which holds @a length bytes of packed
+ * data, from the start of the first element to the end of the last one.
+ */
+static inline size_t ucp_dt_strided_extent(ucp_datatype_t datatype,
+                                           size_t length)
+{
+    size_t elem_size = ucp_dt_strided_elem_size(datatype);
+    size_t count     = length / elem_size;
+
+    if (length == 0) {
+        return 0;
+    } else if ((length % elem_size) != 0) {
+        return count * ucp_dt_strided_stride(datatype) + (length % elem_size);
+    } else {
+        return (count - 1) * ucp_dt_strided_stride(datatype) + elem_size;
+    }
+}
+
+/**
+ * Get the number of memory pieces which hold packed data in range
+ * [@a offset, @a offset + @a length)
+ */
+static inline size_t ucp_dt_strided_iovcnt(ucp_datatype_t datatype,
+                                           size_t offset, size_t length)
+{
+    size_t elem_size = ucp_dt_strided_elem_size(datatype);
+
+    if (length == 0) {
+        return 0;
+    }
+
+    return ((offset + length - 1) / elem_size) - (offset / elem_size) + 1;
+}
+
+/**
+ * Copy strided elements from @a src to contiguous buffer @a dest
+ *
+ * @param [in]     dest           Destination contiguous buffer
+ *                                (no offset applicable)
+ * @param [in]     src            Source buffer, points to the first element
+ * @param [in]     datatype       Strided datatype of @a src
+ * @param [in]     length         Total data length to copy in bytes
+ * @param [in]     offset         Offset in the packed data to start copying
+ *                                from, does not have to be aligned to the
+ *                                element size
+ */
+void ucp_dt_strided_gather(void *dest, const void *src, ucp_datatype_t datatype,
+                           size_t length, size_t offset);
+
+/**
+ * Copy contiguous buffer @a src into strided elements of @a dest
+ *
+ * @param [in]     dest           Destination buffer, points to the first
+ *                                element
+ * @param [in]     src            Source contiguous buffer
+ *                                (no offset applicable)
+ * @param [in]     datatype       Strided datatype of @a dest
+ * @param [in]     length         Total data length to copy in bytes
+ * @param [in]     offset         Offset in the packed data to start copying
+ *                                to, does not have to be aligned to the
+ *                                element size
+ */
+void ucp_dt_strided_scatter(void *dest, const void *src, ucp_datatype_t datatype,
+                            size_t length, size_t offset);
+
+#endif
@@ -127,8 +127,10 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
                          ucp_mem_desc_t *mdesc)
 {
     size_t iov_offset, max_src_iov, src_it, dst_it;
+    size_t elem_size, stride, offset;
     size_t length_it = 0;
     ucp_md_index_t memh_index;
+    uct_mem_h memh;
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
@@ -181,6 +183,37 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
         state->dt.iov.iovcnt_offset = src_it;
         *iovcnt                     = dst_it;
         break;
+    case UCP_DATATYPE_STRIDED:
+        /* UCT transports do not support strided iov items, so every element
+         * is passed as a separate item, all of them covered by the memh of
+         * the registered extent */
+        if (context->tl_mds[md_index].attr.cap.flags & UCT_MD_FLAG_REG) {
+            memh_index = ucs_bitmap2idx(state->dt.contig.md_map, md_index);
+            memh       = state->dt.contig.memh[memh_index];
+        } else {
+            memh       = UCT_MEM_HANDLE_NULL;
+        }
+        elem_size = ucp_dt_strided_elem_size(datatype);
+        stride    = ucp_dt_strided_stride(datatype);
+        offset    = state->offset;
+        dst_it    = 0;
+        while ((dst_it < max_dst_iov) && (length_it < length_max)) {
+            iov_offset          = offset % elem_size;
+            iov[dst_it].buffer  = UCS_PTR_BYTE_OFFSET(src_iov,
+                                                      (offset / elem_size) *
+                                                      stride + iov_offset);
+            iov[dst_it].length  = ucs_min(elem_size - iov_offset,
+                                          length_max - length_it);
+            iov[dst_it].memh    = memh;
+            iov[dst_it].stride  = 0;
+            iov[dst_it].count   = 1;
+            length_it          += iov[dst_it].length;
+            offset             += iov[dst_it].length;
+            ++dst_it;
+        }
+
+        *iovcnt = dst_it;
+        break;
     default:
         ucs_error("Invalid data type");
     }
@@ -266,8 +299,9 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             req->send.lane = ucp_ep_get_am_lane(ep);
         }
     } else {
-        ucs_assert(UCP_DT_IS_IOV(req->send.datatype));
-        /* disable multilane for IOV datatype.
+        ucs_assert(UCP_DT_IS_IOV(req->send.datatype) ||
+                   UCP_DT_IS_STRIDED(req->send.datatype));
+        /* disable multilane for IOV and strided datatypes.
          * TODO: add IOV processing for multilane */
         req->send.lane = ucp_ep_get_am_lane(ep);
     }
@@ -286,6 +320,10 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             /* This flag should guarantee middle stage usage if iovcnt exceeded */
             flag_iov_mid = ((state.dt.iov.iovcnt_offset + max_iov) <
                             state.dt.iov.iovcnt);
+        } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+            flag_iov_mid = (ucp_dt_strided_iovcnt(req->send.datatype, offset,
+                                                  req->send.length - offset) >
+                            max_iov);
         } else {
             ucs_assert(UCP_DT_IS_CONTIG(req->send.datatype));
         }
@@ -408,6 +446,18 @@ ucp_proto_get_zcopy_threshold(const ucp_request_t *req,
                               ucp_worker_iface_bandwidth(worker, rsc_index));
         }
         return ucs_min(max_zcopy, zcopy_thresh);
+    } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+        /* The extent is registered as a single buffer, but every element
+         * takes an iov entry. Avoid zcopy if it would be split to more
+         * fragments than bcopy, or to fragments below the threshold. */
+        zcopy_thresh = msg_config->zcopy_thresh[0];
+        if ((count > msg_config->max_iov) &&
+            ((ucp_dt_strided_elem_size(req->send.datatype) *
+              msg_config->max_iov) < ucs_max(zcopy_thresh,
+                                             msg_config->max_bcopy))) {
+            return max_zcopy;
+        }
+        return ucs_min(max_zcopy, zcopy_thresh);
     } else if (UCP_DT_IS_GENERIC(req->send.datatype)) {
         return max_zcopy;
     }
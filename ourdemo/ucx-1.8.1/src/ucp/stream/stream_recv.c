@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_request.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/profile/profile.h>
@@ -43,6 +44,12 @@
  *                'ucp_recv_desc_t *' inside @ref ucp_stream_release_data after
  *                the buffer was returned to user by
  *                @ref ucp_stream_recv_data_nb as a pointer to 'paylod'
+ *
+ * A rendezvous payload which could not be fetched directly to a user buffer
+ * is fetched to a malloc'ed descriptor of the same layout. Until the fetch is
+ * done, the endpoint is UCP_EP_FLAG_STREAM_RNDV_BLOCKED and any data or RTS
+ * arriving after it waits in the rndv_q, so the byte order of the stream is
+ * kept. A failed fetch fails the endpoint, which then stays blocked.
  */
 
 
@@ -125,6 +132,17 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_recv_data_nb, (ep, length),
     return status_ptr;
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_rdesc_release(ucp_recv_desc_t *rdesc)
+{
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC)) {
+        /* rendezvous bounce buffer */
+        ucs_free(rdesc);
+    } else {
+        ucp_recv_desc_release(rdesc);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_stream_rdesc_dequeue_and_release(ucp_recv_desc_t *rdesc,
                                      ucp_ep_ext_proto_t *ep_ext)
@@ -134,7 +152,7 @@ ucp_stream_rdesc_dequeue_and_release(ucp_recv_desc_t *rdesc,
                                                       ucp_recv_desc_t,
                                                       stream_queue));
     ucp_stream_rdesc_dequeue(ep_ext);
-    ucp_recv_desc_release(rdesc);
+    ucp_stream_rdesc_release(rdesc);
 }
 
 UCS_PROFILE_FUNC_VOID(ucp_stream_data_release, (ep, data),
@@ -144,7 +162,7 @@ UCS_PROFILE_FUNC_VOID(ucp_stream_data_release, (ep, data),
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
 
-    ucp_recv_desc_release(rdesc);
+    ucp_stream_rdesc_release(rdesc);
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
 }
@@ -243,6 +261,7 @@ ucp_stream_recv_request_init(ucp_request_t *req, ucp_ep_h ep, void *buffer,
     req->recv.stream.cb     = cb;
     req->recv.stream.length = 0;
     req->recv.stream.offset = 0;
+    req->recv.stream.rndv_count = 0;
 
     ucp_dt_recv_state_init(&req->recv.state, buffer, datatype, count);
 
@@ -344,16 +363,87 @@ out:
     return req;
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_recv_request_progress(ucp_request_t *req, ucp_ep_ext_proto_t *ep_ext)
+{
+    ucp_request_t *check_req UCS_V_UNUSED;
+
+    if (ucp_request_can_complete_stream_recv(req)) {
+        ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
+    } else if (req->recv.stream.offset == req->recv.length) {
+        /* full, but a rendezvous still fetches into it - the fetch completes
+         * the request, and the next data goes to the next one */
+        check_req = ucs_queue_pull_elem_non_empty(&ep_ext->stream.match_q,
+                                                  ucp_request_t, recv.queue);
+        ucs_assert(check_req == req);
+    }
+}
+
+/* Unpack as much as possible of the data at @a base + rdesc->payload_offset to
+ * the posted requests. Returns UCS_OK if all of it was consumed, otherwise the
+ * rdesc is advanced past the consumed part. */
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_stream_rdata_deliver(ucp_ep_ext_proto_t *ep_ext, void *base,
+                         ucp_recv_desc_t *rdesc)
+{
+    ucp_request_t *req;
+    ssize_t        unpacked;
+
+    /* requests are posted only if there is no data */
+    if (ucp_stream_ep_has_data(ep_ext)) {
+        return UCS_INPROGRESS;
+    }
+
+    while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
+        req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                                 ucp_request_t, recv.queue);
+        unpacked = ucp_stream_rdata_unpack(UCS_PTR_BYTE_OFFSET(base,
+                                                               rdesc->payload_offset),
+                                           rdesc->length, req);
+        if (ucs_unlikely(unpacked < 0)) {
+            ucs_fatal("failed to unpack from %p with offset %u to request %p",
+                      base, rdesc->payload_offset, req);
+        }
+
+        ucp_stream_recv_request_progress(req, ep_ext);
+        if (unpacked == rdesc->length) {
+            return UCS_OK;
+        }
+
+        /* This request is full, try next one */
+        rdesc->length         -= unpacked;
+        rdesc->payload_offset += unpacked;
+    }
+
+    return UCS_INPROGRESS;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_rdesc_enqueue(ucp_ep_ext_proto_t *ep_ext, ucp_recv_desc_t *rdesc)
+{
+    ucp_ep_h ep = ucp_ep_from_ext_proto(ep_ext);
+
+    ep->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
+    ucs_queue_push(&ep_ext->stream.match_q, &rdesc->stream_queue);
+
+    if (!ucp_stream_ep_is_queued(ep_ext) && (ep->flags & UCP_EP_FLAG_USED)) {
+        ucp_stream_ep_enqueue(ep_ext, ep->worker);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_ep_rndv_is_blocked(ucp_ep_ext_proto_t *ep_ext)
+{
+    return ucp_ep_from_ext_proto(ep_ext)->flags & UCP_EP_FLAG_STREAM_RNDV_BLOCKED;
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_t
 ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
                            ucp_stream_am_data_t *am_data, size_t length,
                            unsigned am_flags)
 {
     ucp_recv_desc_t  rdesc_tmp;
-    void            *payload;
     ucp_recv_desc_t *rdesc;
-    ucp_request_t   *req;
-    ssize_t          unpacked;
 
     rdesc_tmp.length         = length;
     rdesc_tmp.payload_offset = sizeof(*am_data); /* add sizeof(*rdesc) only if
@@ -361,26 +451,9 @@ ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
                                                     place */
 
     /* First, process expected requests */
-    if (!ucp_stream_ep_has_data(ep_ext)) {
-        while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
-            req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
-                                                     ucp_request_t, recv.queue);
-            payload  = UCS_PTR_BYTE_OFFSET(am_data, rdesc_tmp.payload_offset);
-            unpacked = ucp_stream_rdata_unpack(payload, rdesc_tmp.length, req);
-            if (ucs_unlikely(unpacked < 0)) {
-                ucs_fatal("failed to unpack from am_data %p with offset %u to request %p",
-                          am_data, rdesc_tmp.payload_offset, req);
-            } else if (unpacked == rdesc_tmp.length) {
-                if (ucp_request_can_complete_stream_recv(req)) {
-                    ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
-                }
-                return UCS_OK;
-            }
-            ucp_stream_rdesc_advance(&rdesc_tmp, unpacked, ep_ext);
-            /* This request is full, try next one */
-            ucs_assert(ucp_request_can_complete_stream_recv(req));
-            ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
-        }
+    if (ucs_likely(!ucp_stream_ep_rndv_is_blocked(ep_ext)) &&
+        (ucp_stream_rdata_deliver(ep_ext, am_data, &rdesc_tmp) == UCS_OK)) {
+        return UCS_OK;
     }
 
     ucs_assert(rdesc_tmp.length > 0);
@@ -406,12 +479,202 @@ ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
         rdesc->flags          = UCP_RECV_DESC_FLAG_UCT_DESC;
     }
 
-    ucp_ep_from_ext_proto(ep_ext)->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
-    ucs_queue_push(&ep_ext->stream.match_q, &rdesc->stream_queue);
+    if (ucs_unlikely(ucp_stream_ep_rndv_is_blocked(ep_ext))) {
+        ucs_queue_push(&ep_ext->stream.rndv_q, &rdesc->stream_queue);
+    } else {
+        ucp_stream_rdesc_enqueue(ep_ext, rdesc);
+    }
 
     return UCS_INPROGRESS;
 }
 
+static void ucp_stream_rndv_process_rts(ucp_worker_h worker, ucp_ep_h ep,
+                                        const ucp_rndv_rts_hdr_t *rts);
+
+static void ucp_stream_rndv_progress_rndv_q(ucp_ep_h ep)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_recv_desc_t    *rdesc;
+
+    while (!ucp_stream_ep_rndv_is_blocked(ep_ext) &&
+           !ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+        rdesc = ucs_queue_pull_elem_non_empty(&ep_ext->stream.rndv_q,
+                                              ucp_recv_desc_t, stream_queue);
+        if (rdesc->flags & UCP_RECV_DESC_FLAG_STREAM_RTS) {
+            ucp_stream_rndv_process_rts(ep->worker, ep,
+                                        (const ucp_rndv_rts_hdr_t*)(rdesc + 1));
+            ucp_recv_desc_release(rdesc);
+        } else if (ucp_stream_rdata_deliver(ep_ext, rdesc, rdesc) == UCS_OK) {
+            ucp_stream_rdesc_release(rdesc);
+        } else {
+            ucp_stream_rdesc_enqueue(ep_ext, rdesc);
+        }
+    }
+}
+
+static void ucp_stream_rndv_fetch_completion(void *request, ucs_status_t status,
+                                             ucp_tag_recv_info_t *info)
+{
+    ucp_request_t        *freq = (ucp_request_t*)request - 1;
+    ucp_request_t        *req  = freq->recv.tag.stream_req;
+    ucp_ep_h              ep   = freq->recv.tag.stream_ep;
+    ucp_recv_desc_t      *rdesc;
+    ucp_stream_am_data_t *am_data;
+
+    ucs_queue_remove(&freq->recv.worker->stream_fetch_q, &freq->recv.queue);
+
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucs_error("stream rendezvous fetch of %zu bytes failed: %s",
+                  freq->recv.length, ucs_status_string(status));
+        if (ep != NULL) {
+            /* the stream has a hole now, nothing after it may be delivered */
+            ucp_worker_set_ep_failed(freq->recv.worker, ep, NULL,
+                                     UCP_NULL_LANE, status);
+        }
+    }
+
+    if (req != NULL) {
+        /* fetched directly to a receive request */
+        ucs_assert(req->recv.stream.rndv_count > 0);
+        if (ucs_unlikely(status != UCS_OK)) {
+            req->status = status;
+        }
+
+        if ((--req->recv.stream.rndv_count == 0) &&
+            (req->recv.stream.offset == req->recv.length)) {
+            /* already removed from match_q, once it became full */
+            req->recv.stream.length = req->recv.stream.offset;
+            ucs_trace_req("completing stream receive request %p (%p) "
+                          "count %zu after rendezvous, %s", req, req + 1,
+                          req->recv.stream.length,
+                          ucs_status_string(req->status));
+            ucp_request_complete(req, recv.stream.cb, req->status,
+                                 req->recv.stream.length);
+        }
+    } else {
+        /* fetched to a bounce buffer */
+        rdesc   = UCS_PTR_BYTE_OFFSET(freq->recv.buffer,
+                                      -(sizeof(*rdesc) + sizeof(*am_data)));
+
+        if (ucs_unlikely((ep == NULL) || (status != UCS_OK))) {
+            /* the endpoint is gone, or stays blocked after the failure until
+             * ucp_stream_ep_cleanup() drops the held data */
+            ucs_free(rdesc);
+        } else {
+            ucs_assert(ep->flags & UCP_EP_FLAG_STREAM_RNDV_BLOCKED);
+            ep->flags &= ~UCP_EP_FLAG_STREAM_RNDV_BLOCKED;
+
+            if (ucp_stream_rdata_deliver(ucp_ep_ext_proto(ep), rdesc,
+                                         rdesc) == UCS_OK) {
+                ucs_free(rdesc);
+            } else {
+                ucp_stream_rdesc_enqueue(ucp_ep_ext_proto(ep), rdesc);
+            }
+
+            ucp_stream_rndv_progress_rndv_q(ep);
+        }
+    }
+
+    /* internal request, released by ucp_request_complete() */
+    freq->flags |= UCP_REQUEST_FLAG_RELEASED;
+}
+
+static ucp_request_t *
+ucp_stream_rndv_fetch_req_get(ucp_ep_h ep, void *buffer, size_t length,
+                              ucp_request_t *stream_req)
+{
+    ucp_worker_h   worker = ep->worker;
+    ucp_request_t *freq;
+
+    freq = ucp_request_get(worker);
+    if (ucs_unlikely(freq == NULL)) {
+        ucs_error("failed to allocate stream rendezvous receive request");
+        return NULL;
+    }
+
+    freq->flags               = UCP_REQUEST_FLAG_RECV |
+                                UCP_REQUEST_FLAG_CALLBACK;
+    freq->status              = UCS_OK;
+    freq->recv.worker         = worker;
+    freq->recv.buffer         = buffer;
+    freq->recv.datatype       = ucp_dt_make_contig(1);
+    ucp_dt_recv_state_init(&freq->recv.state, buffer, freq->recv.datatype,
+                           length);
+    freq->recv.length         = length;
+    freq->recv.mem_type       = ucp_memory_type_detect(worker->context, buffer,
+                                                       length);
+    freq->recv.tag.cb         = ucp_stream_rndv_fetch_completion;
+    freq->recv.tag.stream_req = stream_req;
+    freq->recv.tag.stream_ep  = ep;
+    ucs_queue_push(&worker->stream_fetch_q, &freq->recv.queue);
+    return freq;
+}
+
+static void ucp_stream_rndv_process_rts(ucp_worker_h worker, ucp_ep_h ep,
+                                        const ucp_rndv_rts_hdr_t *rts)
+{
+    ucp_ep_ext_proto_t   *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_stream_am_data_t *am_data;
+    ucp_recv_desc_t      *rdesc;
+    ucp_request_t        *req, *freq;
+
+    ucs_assert(!ucp_stream_ep_rndv_is_blocked(ep_ext));
+
+    /* Zero copy, if the payload fits a WAITALL request which is next to get
+     * data */
+    if (!ucp_stream_ep_has_data(ep_ext) &&
+        !ucs_queue_is_empty(&ep_ext->stream.match_q)) {
+        req = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                            ucp_request_t, recv.queue);
+        if ((req->flags & UCP_REQUEST_FLAG_STREAM_RECV_WAITALL) &&
+            UCP_DT_IS_CONTIG(req->recv.datatype) &&
+            ((req->recv.length - req->recv.stream.offset) >= rts->size)) {
+            freq = ucp_stream_rndv_fetch_req_get(ep,
+                                                 UCS_PTR_BYTE_OFFSET(req->recv.buffer,
+                                                                     req->recv.stream.offset),
+                                                 rts->size, req);
+            if (ucs_unlikely(freq == NULL)) {
+                goto err;
+            }
+
+            ucp_trace_req(req, "stream rndv fetch %zu bytes at offset %zu",
+                          rts->size, req->recv.stream.offset);
+            req->recv.stream.offset += rts->size;
+            ++req->recv.stream.rndv_count;
+            ucp_stream_recv_request_progress(req, ep_ext);
+            ucp_rndv_matched(worker, freq, rts);
+            return;
+        }
+    }
+
+    /* Otherwise, fetch to a bounce buffer and hold the rest of the stream */
+    rdesc = ucs_malloc(sizeof(*rdesc) + sizeof(*am_data) + rts->size,
+                       "stream_rndv_rdesc");
+    if (ucs_unlikely(rdesc == NULL)) {
+        ucs_error("failed to allocate stream rendezvous buffer of %zu bytes",
+                  rts->size);
+        goto err;
+    }
+
+    rdesc->length         = rts->size;
+    rdesc->payload_offset = sizeof(*rdesc) + sizeof(*am_data);
+    rdesc->flags          = UCP_RECV_DESC_FLAG_MALLOC;
+
+    freq = ucp_stream_rndv_fetch_req_get(ep, ucp_stream_rdesc_payload(rdesc),
+                                         rts->size, NULL);
+    if (ucs_unlikely(freq == NULL)) {
+        ucs_free(rdesc);
+        goto err;
+    }
+
+    ep->flags |= UCP_EP_FLAG_STREAM_RNDV_BLOCKED;
+    ucp_rndv_matched(worker, freq, rts);
+    return;
+
+err:
+    ucp_rndv_send_ats(worker, rts, UCS_ERR_NO_MEMORY);
+}
+
 void ucp_stream_ep_init(ucp_ep_h ep)
 {
     ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
@@ -420,11 +683,15 @@ void ucp_stream_ep_init(ucp_ep_h ep)
         ep_ext->stream.ready_list.prev = NULL;
         ep_ext->stream.ready_list.next = NULL;
         ucs_queue_head_init(&ep_ext->stream.match_q);
+        ucs_queue_head_init(&ep_ext->stream.rndv_q);
     }
 }
 
 void ucp_stream_ep_cleanup(ucp_ep_h ep)
 {
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_recv_desc_t *rdesc;
+    ucp_request_t *freq;
     size_t length;
     void *data;
 
@@ -434,6 +701,22 @@ void ucp_stream_ep_cleanup(ucp_ep_h ep)
             ucp_stream_data_release(ep, data);
         }
 
+        /* data and RTS held behind a rendezvous fetch */
+        while (!ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+            rdesc = ucs_queue_pull_elem_non_empty(&ep_ext->stream.rndv_q,
+                                                  ucp_recv_desc_t,
+                                                  stream_queue);
+            ucp_stream_rdesc_release(rdesc);
+        }
+
+        /* fetches still in flight complete after the endpoint is gone, so
+         * detach them from it */
+        ucs_queue_for_each(freq, &ep->worker->stream_fetch_q, recv.queue) {
+            if (freq->recv.tag.stream_ep == ep) {
+                freq->recv.tag.stream_ep = NULL;
+            }
+        }
+
         if (ucp_stream_ep_is_queued(ucp_ep_ext_proto(ep))) {
             ucp_stream_ep_dequeue(ucp_ep_ext_proto(ep));
         }
@@ -481,11 +764,43 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
 
     ucs_assert(status == UCS_INPROGRESS);
 
-    if (!ucp_stream_ep_is_queued(ep_ext) && (ep->flags & UCP_EP_FLAG_USED)) {
-        ucp_stream_ep_enqueue(ep_ext, worker);
+    return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
+}
+
+static ucs_status_t
+ucp_stream_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                            unsigned am_flags)
+{
+    ucp_worker_h        worker = am_arg;
+    ucp_rndv_rts_hdr_t *rts    = am_data;
+    ucp_recv_desc_t    *rdesc;
+    ucp_ep_h            ep;
+    ucs_status_t        status;
+
+    ep = ucp_worker_get_ep_by_ptr(worker, rts->sreq.ep_ptr);
+    if (ucs_unlikely(ep->flags & UCP_EP_FLAG_CLOSED)) {
+        ucs_trace_data("ep %p: stream is invalid", ep);
+        /* drop the data, but let the sender complete */
+        ucp_rndv_send_ats(worker, rts, UCS_OK);
+        return UCS_OK;
     }
 
-    return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
+    if (ucs_likely(!ucp_stream_ep_rndv_is_blocked(ucp_ep_ext_proto(ep)))) {
+        ucp_stream_rndv_process_rts(worker, ep, rts);
+        return UCS_OK;
+    }
+
+    /* keep the order with the payload being fetched */
+    status = ucp_recv_desc_init(worker, am_data, am_length, 0, am_flags, 0,
+                                UCP_RECV_DESC_FLAG_STREAM_RTS, 0, &rdesc);
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
+        ucs_error("ep %p: failed to hold stream rendezvous RTS", ep);
+        ucp_rndv_send_ats(worker, rts, status);
+        return UCS_OK;
+    }
+
+    ucs_queue_push(&ucp_ep_ext_proto(ep)->stream.rndv_q, &rdesc->stream_queue);
+    return status;
 }
 
 static void ucp_stream_am_dump(ucp_worker_h worker, uct_am_trace_type_t type,
@@ -507,4 +822,8 @@ static void ucp_stream_am_dump(ucp_worker_h worker, uct_am_trace_type_t type,
 UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_DATA, ucp_stream_am_handler,
               ucp_stream_am_dump, 0);
 
+UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_RTS,
+              ucp_stream_rndv_rts_handler, NULL, 0);
+
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_DATA);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_RTS);
@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
 
@@ -75,7 +76,53 @@ ucp_stream_send_req(ucp_request_t *req, size_t count,
         return UCS_STATUS_PTR(status);
     }
 
-    ucp_request_set_callback(req, send.cb, cb)
+    ucp_request_set_callback(req, send.cb, cb);
+    ucs_trace_req("returning send request %p", req);
+    return req + 1;
+}
+
+static ucs_status_t ucp_stream_progress_rndv_rts(uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+    size_t packed_rkey_size;
+
+    /* same RTS as for tag rendezvous, the receiver finds the stream by
+     * sreq.ep_ptr and ignores the tag */
+    packed_rkey_size = ucp_ep_config(sreq->send.ep)->tag.rndv.rkey_size;
+    return ucp_do_am_single(self, UCP_AM_ID_STREAM_RTS, ucp_tag_rndv_rts_pack,
+                            sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+}
+
+static ucs_status_ptr_t
+ucp_stream_send_rndv(ucp_request_t *req, ucp_send_callback_t cb)
+{
+    ucs_status_t status;
+
+    ucp_trace_req(req, "stream start_rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(req->send.ep), req->send.buffer,
+                  req->send.length);
+
+    req->send.tag.tag      = 0;
+    req->send.pending_lane = UCP_NULL_LANE;
+    req->send.uct.func     = ucp_stream_progress_rndv_rts;
+
+    status = ucp_tag_rndv_reg_send_buffer(req);
+    if (status != UCS_OK) {
+        ucp_request_put(req);
+        return UCS_STATUS_PTR(status);
+    }
+
+    UCP_EP_STAT_TAG_OP(req->send.ep, RNDV);
+
+    /* completed by the ATS, or when the payload was pushed to the receiver */
+    ucp_request_send(req, 0);
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        status = req->status;
+        ucp_request_put(req);
+        return UCS_STATUS_PTR(status);
+    }
+
+    ucp_request_set_callback(req, send.cb, cb);
     ucs_trace_req("returning send request %p", req);
     return req + 1;
 }
@@ -130,8 +177,12 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_send_nb,
 
     ucp_stream_send_req_init(req, ep, buffer, datatype, count, flags);
 
-    ret = ucp_stream_send_req(req, count, &ucp_ep_config(ep)->am, cb,
-                              ucp_ep_config(ep)->stream.proto);
+    if (ucs_unlikely(req->send.length >= ucp_ep_config(ep)->stream.rndv_thresh)) {
+        ret = ucp_stream_send_rndv(req, cb);
+    } else {
+        ret = ucp_stream_send_req(req, count, &ucp_ep_config(ep)->am, cb,
+                                  ucp_ep_config(ep)->stream.proto);
+    }
 
 out:
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
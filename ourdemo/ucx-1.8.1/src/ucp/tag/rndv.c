@@ -230,6 +230,27 @@ static void ucp_rndv_req_send_ats(ucp_request_t *rndv_req, ucp_request_t *rreq,
     ucp_request_send(rndv_req, 0);
 }
 
+void ucp_rndv_send_ats(ucp_worker_h worker,
+                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                       ucs_status_t status)
+{
+    ucp_request_t *rndv_req;
+
+    rndv_req = ucp_request_get(worker);
+    if (rndv_req == NULL) {
+        ucs_error("failed to allocate rendezvous reply");
+        return;
+    }
+
+    rndv_req->send.ep           = ucp_worker_get_ep_by_ptr(worker,
+                                                           rndv_rts_hdr->sreq.ep_ptr);
+    rndv_req->flags             = 0;
+    rndv_req->send.mdesc        = NULL;
+    rndv_req->send.pending_lane = UCP_NULL_LANE;
+
+    ucp_rndv_req_send_ats(rndv_req, NULL, rndv_rts_hdr->sreq.reqptr, status);
+}
+
 UCS_PROFILE_FUNC_VOID(ucp_rndv_complete_rma_put_zcopy, (sreq),
                       ucp_request_t *sreq)
 {
@@ -1472,14 +1493,14 @@ static void ucp_rndv_dump(ucp_worker_h worker, uct_am_trace_type_t type,
 
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTS, ucp_rndv_rts_handler,
               ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATS, ucp_rndv_ats_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATP, ucp_rndv_atp_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTR, ucp_rndv_rtr_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_DATA, ucp_rndv_data_handler,
-              ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_ATS, ucp_rndv_ats_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_ATP, ucp_rndv_atp_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_RTR, ucp_rndv_rtr_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_DATA, ucp_rndv_data_handler, ucp_rndv_dump, 0);
 
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_RTS);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_ATS);
@@ -36,6 +36,13 @@ ucp_tag_get_rndv_threshold(const ucp_request_t *req, size_t count,
         /* Fall through */
     case UCP_DATATYPE_CONTIG:
         return ucs_min(rndv_rma_thresh, rndv_am_thresh);
+    case UCP_DATATYPE_STRIDED:
+        if ((count > max_iov) &&
+            ucp_ep_is_tag_offload_enabled(ucp_ep_config(req->send.ep))) {
+            return 1;
+        }
+        /* Strided data is not sent by RMA rendezvous */
+        return rndv_am_thresh;
     case UCP_DATATYPE_GENERIC:
         return rndv_am_thresh;
     default:
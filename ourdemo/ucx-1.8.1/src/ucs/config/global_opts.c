@@ -42,9 +42,12 @@ ucs_global_opts_t ucs_global_opts = {
     .stats_trigger         = "exit",
     .profile_mode          = 0,
     .profile_file          = "",
+    .profile_format        = UCS_PROFILE_FORMAT_BINARY,
+    .profile_trigger       = "exit",
     .stats_filter          = { NULL, 0 },
     .stats_format          = UCS_STATS_FULL,
     .rcache_check_pfn      = 0,
+    .rcache_thread_cache   = 8,
     .module_dir            = UCX_MODULE_DIR, /* defined in Makefile.am */
     .module_log_level      = UCS_LOG_LEVEL_TRACE,
     .arch                  = UCS_ARCH_GLOBAL_OPTS_INITALIZER
@@ -151,7 +154,11 @@ static ucs_config_field_t ucs_global_opts_table[] = {
   "  udp:<host>[:<port>]   - send over UDP to the given host:port.\n"
   "  stdout                - print to standard output.\n"
   "  stderr                - print to standard error.\n"
-  "  file:<filename>[:bin] - save to a file (%h: host, %p: pid, %c: cpu, %t: time, %u: user, %e: exe)",
+  "  file:<filename>[:bin] - save to a file (%h: host, %p: pid, %c: cpu, %t: time, %u: user, %e: exe)\n"
+  "  shm[:<dir>]           - keep the counters in a shared memory file <dir>/ucx_stats.<pid>,\n"
+  "                          which can be sampled by ucs_stats_reader (default dir: /dev/shm).\n"
+  "                          The file is accessible only by the user running the process.\n"
+  "                          STATS_TRIGGER is ignored in this mode.",
   ucs_offsetof(ucs_global_opts_t, stats_dest), UCS_CONFIG_TYPE_STRING},
 
  {"STATS_TRIGGER", "exit",
@@ -208,11 +215,34 @@ static ucs_config_field_t ucs_global_opts_table[] = {
    "Maximal size of profiling log. New records will replace old records.",
    ucs_offsetof(ucs_global_opts_t, profile_log_size), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"PROFILE_FORMAT", "binary",
+   "Format of the profiling data file:\n"
+   " - binary - UCX profiling format, which can be read by ucx_read_profile.\n"
+   " - chrome - Chrome trace event JSON, which can be opened by chrome://tracing\n"
+   "            or Perfetto UI. Contains only records of the 'log' mode.",
+   ucs_offsetof(ucs_global_opts_t, profile_format),
+   UCS_CONFIG_TYPE_ENUM(ucs_profile_format_names)},
+
+  {"PROFILE_TRIGGER", "exit",
+   "Trigger to save profiling data while the program is running. The data is\n"
+   "always saved when the program exits, and profiling continues after every\n"
+   "save. Use %t in PROFILE_FILE to keep every saved file.\n"
+   "  exit              - save only when the program exits.\n"
+   "  signal:<signo>    - save when process is signaled.\n"
+   "  timer:<interval>  - save in specified intervals (in seconds).",
+   ucs_offsetof(ucs_global_opts_t, profile_trigger), UCS_CONFIG_TYPE_STRING},
+
   {"RCACHE_CHECK_PFN", "n",
    "Registration cache to check that the physical page frame number of a found\n"
    "memory region was not changed since the time the region was registered.\n",
    ucs_offsetof(ucs_global_opts_t, rcache_check_pfn), UCS_CONFIG_TYPE_BOOL},
 
+  {"RCACHE_THREAD_CACHE", "8",
+   "Number of registration cache regions each thread keeps in a private lookup\n"
+   "table, so that repeated hits do not take the shared registration cache lock.\n"
+   "0 - disable the per-thread lookup table.\n",
+   ucs_offsetof(ucs_global_opts_t, rcache_thread_cache), UCS_CONFIG_TYPE_UINT},
+
   {"MODULE_DIR", UCX_MODULE_DIR,
    "Directory to search for loadable modules",
    ucs_offsetof(ucs_global_opts_t, module_dir), UCS_CONFIG_TYPE_STRING},
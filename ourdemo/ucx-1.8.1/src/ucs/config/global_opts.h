@@ -103,6 +103,12 @@ typedef struct {
     /* Limit for profiling log size */
     size_t                   profile_log_size;
 
+    /* Profiling output file format (ucs_profile_format_t) */
+    unsigned                 profile_format;
+
+    /* Trigger to save profiling data while running */
+    char                     *profile_trigger;
+
     /* Counters to be included in statistics summary */
     ucs_config_names_array_t stats_filter;
 
@@ -112,6 +118,9 @@ typedef struct {
     /* registration cache checks if physical page is not moved */
     int                      rcache_check_pfn;
 
+    /* number of regions in the per-thread registration cache lookup table */
+    unsigned                 rcache_thread_cache;
+
     /* directory for loadable modules */
     char                     *module_dir;
 
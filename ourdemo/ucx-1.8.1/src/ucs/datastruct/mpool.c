@@ -11,11 +11,68 @@
 #include "mpool.h"
 #include "mpool.inl"
 #include "queue.h"
+#include "list.h"
 
 #include <ucs/debug/log.h>
+#include <ucs/memory/numa.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/checker.h>
 #include <ucs/sys/sys.h>
+#include <ucs/type/spinlock.h>
+#include <pthread.h>
+
+
+/* Maximal number of memory pools with thread cache which can exist at once */
+#define UCS_MPOOL_TCACHE_MAX_POOLS  1024
+
+
+/*
+ * Free elements of a memory pool, which are private to one thread.
+ */
+typedef struct ucs_mpool_tcache {
+    ucs_mpool_elem_t       *freelist;  /* Thread-private free list */
+    unsigned               count;      /* Number of elements on the free list */
+    ucs_mpool_t            *mp;        /* Owning pool, NULL if it was destroyed */
+    ucs_list_link_t        list;       /* Entry in the pool's list of caches */
+} ucs_mpool_tcache_t;
+
+
+/*
+ * Per-thread array of caches, indexed by the pool's cache slot.
+ */
+typedef struct ucs_mpool_tcache_table {
+    unsigned               size;       /* Number of entries in the array */
+    ucs_mpool_tcache_t     *caches[0]; /* Thread caches */
+} ucs_mpool_tcache_table_t;
+
+
+/*
+ * Thread cache state of a memory pool. When the thread cache is enabled,
+ * mp->freelist is set to UCS_MPOOL_FREELIST_TCACHE, so ucs_mpool_get_inline()
+ * falls back to ucs_mpool_get_grow(), and the shared free list is kept here
+ * instead.
+ */
+struct ucs_mpool_tcache_shared {
+    ucs_spinlock_t         lock;       /* Protects freelist and pool growth */
+    ucs_mpool_elem_t       *freelist;  /* Shared free list */
+    unsigned               size;       /* Maximal number of elements per thread */
+    unsigned               batch;      /* How many elements to move at once */
+    unsigned               slot;       /* Index in per-thread cache tables */
+    ucs_list_link_t        caches;     /* List of thread caches of this pool,
+                                          protected by the global lock */
+};
+
+
+static struct {
+    pthread_mutex_t           lock;     /* Protects the fields below and the
+                                           caches lists of all pools */
+    int                       key_valid;
+    pthread_key_t             key;      /* Thread-specific cache table */
+    ucs_mpool_tcache_shared_t *slots[UCS_MPOOL_TCACHE_MAX_POOLS];
+} ucs_mpool_tcache_global = {
+    .lock      = PTHREAD_MUTEX_INITIALIZER,
+    .key_valid = 0
+};
 
 
 static inline unsigned ucs_mpool_elem_total_size(ucs_mpool_data_t *data)
@@ -45,6 +102,403 @@ static void ucs_mpool_chunk_leak_check(ucs_mpool_t *mp, ucs_mpool_chunk_t *chunk
     }
 }
 
+/*
+ * Allocate a new chunk and add its elements to the given free list. If the
+ * thread cache is enabled, must be called with the shared lock held.
+ */
+static void ucs_mpool_grow_freelist(ucs_mpool_t *mp, unsigned num_elems,
+                                    ucs_mpool_elem_t **freelist_p)
+{
+    ucs_mpool_data_t *data = mp->data;
+    size_t chunk_size, chunk_padding;
+    ucs_mpool_chunk_t *chunk;
+    ucs_mpool_elem_t *elem;
+    ucs_status_t status;
+    unsigned i;
+    void *ptr;
+
+    if (data->quota == 0) {
+        return;
+    }
+
+    chunk_size = sizeof(ucs_mpool_chunk_t) + data->alignment +
+                 (num_elems * ucs_mpool_elem_total_size(data));
+    status = data->ops->chunk_alloc(mp, &chunk_size, &ptr);
+    if (status != UCS_OK) {
+        ucs_error("Failed to allocate memory pool (name=%s) chunk: %s",
+                  ucs_mpool_name(mp), ucs_status_string(status));
+        return;
+    }
+
+    /* Calculate padding, and update element count according to allocated size */
+    chunk            = ptr;
+    chunk_padding    = ucs_padding((uintptr_t)(chunk + 1) + data->align_offset,
+                                   data->alignment);
+    chunk->elems     = UCS_PTR_BYTE_OFFSET(chunk + 1, chunk_padding);
+    chunk->num_elems = ucs_min(data->quota, (chunk_size - chunk_padding - sizeof(*chunk)) /
+                       ucs_mpool_elem_total_size(data));
+
+    ucs_debug("mpool %s: allocated chunk %p of %lu bytes with %u elements",
+              ucs_mpool_name(mp), chunk, chunk_size, chunk->num_elems);
+
+    for (i = 0; i < chunk->num_elems; ++i) {
+        elem         = ucs_mpool_chunk_elem(data, chunk, i);
+        if (data->ops->obj_init != NULL) {
+            data->ops->obj_init(mp, elem + 1, chunk);
+        }
+
+        if (freelist_p == &mp->freelist) {
+            ucs_mpool_add_to_freelist(mp, elem, 0);
+            if (data->tail == NULL) {
+                data->tail = elem;
+            }
+        } else {
+            elem->next  = *freelist_p;
+            *freelist_p = elem;
+        }
+    }
+
+    chunk->next  = data->chunks;
+    data->chunks = chunk;
+
+    if (data->quota == UINT_MAX) {
+        /* Infinite memory pool */
+    } else if (data->quota >= chunk->num_elems) {
+        data->quota -= chunk->num_elems;
+    } else {
+        data->quota = 0;
+    }
+
+    VALGRIND_MAKE_MEM_NOACCESS(chunk + 1, chunk_size - sizeof(*chunk));
+}
+
+/*
+ * Move up to 'count' elements from the head of a thread cache to the shared
+ * free list.
+ */
+static void ucs_mpool_tcache_flush(ucs_mpool_tcache_shared_t *tcache,
+                                   ucs_mpool_tcache_t *cache, unsigned count)
+{
+    ucs_mpool_elem_t *first, *last;
+    unsigned n;
+
+    if (cache->freelist == NULL) {
+        return;
+    }
+
+    first = last = cache->freelist;
+    VALGRIND_MAKE_MEM_DEFINED(last, sizeof *last);
+    for (n = 1; (n < count) && (last->next != NULL); ++n) {
+        last = last->next;
+        VALGRIND_MAKE_MEM_DEFINED(last, sizeof *last);
+    }
+
+    cache->freelist = last->next;
+    cache->count   -= n;
+
+    ucs_spin_lock(&tcache->lock);
+    last->next       = tcache->freelist;
+    tcache->freelist = first;
+    ucs_spin_unlock(&tcache->lock);
+}
+
+/* Move a batch of elements from the shared free list to a thread cache */
+static void ucs_mpool_tcache_refill(ucs_mpool_t *mp, ucs_mpool_tcache_t *cache)
+{
+    ucs_mpool_tcache_shared_t *tcache = mp->data->tcache;
+    ucs_mpool_elem_t *elem;
+
+    ucs_spin_lock(&tcache->lock);
+
+    if (tcache->freelist == NULL) {
+        ucs_mpool_grow_freelist(mp, mp->data->elems_per_chunk,
+                                &tcache->freelist);
+    }
+
+    while ((cache->count < tcache->batch) && (tcache->freelist != NULL)) {
+        elem             = tcache->freelist;
+        VALGRIND_MAKE_MEM_DEFINED(elem, sizeof *elem);
+        tcache->freelist = elem->next;
+        elem->next       = cache->freelist;
+        cache->freelist  = elem;
+        ++cache->count;
+    }
+
+    ucs_spin_unlock(&tcache->lock);
+}
+
+/* Called on thread exit, returns all cached elements to their pools */
+static void ucs_mpool_tcache_table_release(void *arg)
+{
+    ucs_mpool_tcache_table_t *table = arg;
+    ucs_mpool_tcache_t *cache;
+    unsigned slot;
+
+    pthread_mutex_lock(&ucs_mpool_tcache_global.lock);
+    for (slot = 0; slot < table->size; ++slot) {
+        cache = table->caches[slot];
+        if (cache == NULL) {
+            continue;
+        }
+
+        if (cache->mp != NULL) {
+            ucs_mpool_tcache_flush(cache->mp->data->tcache, cache, cache->count);
+            ucs_list_del(&cache->list);
+        }
+        ucs_free(cache);
+    }
+    pthread_mutex_unlock(&ucs_mpool_tcache_global.lock);
+
+    ucs_free(table);
+}
+
+static ucs_mpool_tcache_t *ucs_mpool_tcache_create(ucs_mpool_t *mp)
+{
+    ucs_mpool_tcache_shared_t *tcache = mp->data->tcache;
+    ucs_mpool_tcache_table_t *table;
+    ucs_mpool_tcache_t *cache;
+    unsigned old_size, size;
+
+    pthread_mutex_lock(&ucs_mpool_tcache_global.lock);
+
+    table    = pthread_getspecific(ucs_mpool_tcache_global.key);
+    old_size = (table == NULL) ? 0 : table->size;
+    if (tcache->slot >= old_size) {
+        size  = ucs_max(tcache->slot + 1, ucs_max(old_size * 2, 16));
+        table = ucs_realloc(table, sizeof(*table) + (size * sizeof(cache)),
+                            "mpool_tcache_table");
+        if (table == NULL) {
+            ucs_error("failed to allocate thread cache table for mpool %s",
+                      ucs_mpool_name(mp));
+            goto err;
+        }
+
+        memset(&table->caches[old_size], 0, (size - old_size) * sizeof(cache));
+        table->size = size;
+        pthread_setspecific(ucs_mpool_tcache_global.key, table);
+    }
+
+    /* A cache which is left in the slot belongs to a destroyed pool */
+    ucs_assert((table->caches[tcache->slot] == NULL) ||
+               (table->caches[tcache->slot]->mp == NULL));
+    ucs_free(table->caches[tcache->slot]);
+    table->caches[tcache->slot] = NULL;
+
+    cache = ucs_malloc(sizeof(*cache), "mpool_tcache");
+    if (cache == NULL) {
+        ucs_error("failed to allocate thread cache for mpool %s",
+                  ucs_mpool_name(mp));
+        goto err;
+    }
+
+    cache->freelist = NULL;
+    cache->count    = 0;
+    cache->mp       = mp;
+    ucs_list_add_tail(&tcache->caches, &cache->list);
+    table->caches[tcache->slot] = cache;
+
+    pthread_mutex_unlock(&ucs_mpool_tcache_global.lock);
+    return cache;
+
+err:
+    pthread_mutex_unlock(&ucs_mpool_tcache_global.lock);
+    return NULL;
+}
+
+static UCS_F_ALWAYS_INLINE ucs_mpool_tcache_t *
+ucs_mpool_tcache_local(ucs_mpool_t *mp)
+{
+    unsigned slot = mp->data->tcache->slot;
+    ucs_mpool_tcache_table_t *table;
+    ucs_mpool_tcache_t *cache;
+
+    table = pthread_getspecific(ucs_mpool_tcache_global.key);
+    if (ucs_likely((table != NULL) && (slot < table->size))) {
+        cache = table->caches[slot];
+        if (ucs_likely((cache != NULL) && (cache->mp == mp))) {
+            return cache;
+        }
+    }
+
+    return ucs_mpool_tcache_create(mp);
+}
+
+static void *ucs_mpool_tcache_get(ucs_mpool_t *mp)
+{
+    ucs_mpool_tcache_t *cache;
+    ucs_mpool_elem_t *elem;
+    void *obj;
+
+    cache = ucs_mpool_tcache_local(mp);
+    if (ucs_unlikely(cache == NULL)) {
+        return NULL;
+    }
+
+    if (cache->freelist == NULL) {
+        ucs_mpool_tcache_refill(mp, cache);
+        if (cache->freelist == NULL) {
+            return NULL;
+        }
+    }
+
+    elem = cache->freelist;
+    VALGRIND_MAKE_MEM_DEFINED(elem, sizeof *elem);
+    cache->freelist = elem->next;
+    --cache->count;
+    elem->mpool = mp;
+    VALGRIND_MAKE_MEM_NOACCESS(elem, sizeof *elem);
+
+    obj = elem + 1;
+    VALGRIND_MEMPOOL_ALLOC(mp, obj, mp->data->elem_size - sizeof(ucs_mpool_elem_t));
+    return obj;
+}
+
+void ucs_mpool_tcache_put(ucs_mpool_t *mp, ucs_mpool_elem_t *elem)
+{
+    ucs_mpool_tcache_shared_t *tcache = mp->data->tcache;
+    ucs_mpool_tcache_t *cache;
+
+    cache = ucs_mpool_tcache_local(mp);
+    if (ucs_unlikely(cache == NULL)) {
+        /* No thread cache, return the element directly to the shared list */
+        ucs_spin_lock(&tcache->lock);
+        elem->next       = tcache->freelist;
+        tcache->freelist = elem;
+        ucs_spin_unlock(&tcache->lock);
+        return;
+    }
+
+    elem->next      = cache->freelist;
+    cache->freelist = elem;
+    if (++cache->count > tcache->size) {
+        ucs_mpool_tcache_flush(tcache, cache, tcache->batch);
+    }
+}
+
+ucs_status_t ucs_mpool_thread_cache_enable(ucs_mpool_t *mp, unsigned cache_size)
+{
+    ucs_mpool_tcache_shared_t *tcache;
+    ucs_status_t status;
+    unsigned slot;
+    int ret;
+
+    if ((cache_size == 0) || (mp->data->tcache != NULL)) {
+        ucs_error("mpool %s: invalid thread cache size %u", ucs_mpool_name(mp),
+                  cache_size);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    tcache = ucs_malloc(sizeof(*tcache), "mpool_tcache_shared");
+    if (tcache == NULL) {
+        ucs_error("failed to allocate thread cache for mpool %s",
+                  ucs_mpool_name(mp));
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    status = ucs_spinlock_init(&tcache->lock);
+    if (status != UCS_OK) {
+        goto err_free;
+    }
+
+    tcache->size  = cache_size;
+    tcache->batch = ucs_max(cache_size / 2, 1);
+    ucs_list_head_init(&tcache->caches);
+
+    pthread_mutex_lock(&ucs_mpool_tcache_global.lock);
+
+    if (!ucs_mpool_tcache_global.key_valid) {
+        ret = pthread_key_create(&ucs_mpool_tcache_global.key,
+                                 ucs_mpool_tcache_table_release);
+        if (ret != 0) {
+            ucs_error("pthread_key_create() failed: %m");
+            status = UCS_ERR_IO_ERROR;
+            goto err_unlock;
+        }
+        ucs_mpool_tcache_global.key_valid = 1;
+    }
+
+    for (slot = 0; slot < UCS_MPOOL_TCACHE_MAX_POOLS; ++slot) {
+        if (ucs_mpool_tcache_global.slots[slot] == NULL) {
+            break;
+        }
+    }
+
+    if (slot == UCS_MPOOL_TCACHE_MAX_POOLS) {
+        ucs_error("mpool %s: too many memory pools with thread cache (%d)",
+                  ucs_mpool_name(mp), UCS_MPOOL_TCACHE_MAX_POOLS);
+        status = UCS_ERR_EXCEEDS_LIMIT;
+        goto err_unlock;
+    }
+
+    ucs_mpool_tcache_global.slots[slot] = tcache;
+    tcache->slot                        = slot;
+
+    pthread_mutex_unlock(&ucs_mpool_tcache_global.lock);
+
+    /* Elements which are already free move to the shared list */
+    tcache->freelist = mp->freelist;
+    mp->freelist     = UCS_MPOOL_FREELIST_TCACHE;
+    mp->data->tail   = NULL;
+    mp->data->tcache = tcache;
+
+    ucs_debug("mpool %s: thread cache of %u elements, slot %u",
+              ucs_mpool_name(mp), cache_size, slot);
+    return UCS_OK;
+
+err_unlock:
+    pthread_mutex_unlock(&ucs_mpool_tcache_global.lock);
+    ucs_spinlock_destroy(&tcache->lock);
+err_free:
+    ucs_free(tcache);
+    return status;
+}
+
+/*
+ * Return the elements of all thread caches to the pool free list, and detach
+ * the caches from the pool. The caches themselves are released by their
+ * threads, except for the calling thread which releases its cache right away.
+ */
+static void ucs_mpool_tcache_disable(ucs_mpool_t *mp)
+{
+    ucs_mpool_tcache_shared_t *tcache = mp->data->tcache;
+    ucs_mpool_tcache_t *cache, *tmp;
+    ucs_mpool_tcache_table_t *table;
+    unsigned slot;
+
+    pthread_mutex_lock(&ucs_mpool_tcache_global.lock);
+
+    ucs_list_for_each_safe(cache, tmp, &tcache->caches, list) {
+        ucs_mpool_tcache_flush(tcache, cache, cache->count);
+        cache->mp = NULL;
+        ucs_list_del(&cache->list);
+    }
+
+    ucs_mpool_tcache_global.slots[tcache->slot] = NULL;
+
+    table = pthread_getspecific(ucs_mpool_tcache_global.key);
+    if ((table != NULL) && (tcache->slot < table->size)) {
+        ucs_free(table->caches[tcache->slot]);
+        table->caches[tcache->slot] = NULL;
+
+        for (slot = 0; slot < table->size; ++slot) {
+            if (table->caches[slot] != NULL) {
+                break;
+            }
+        }
+        if (slot == table->size) {
+            pthread_setspecific(ucs_mpool_tcache_global.key, NULL);
+            ucs_free(table);
+        }
+    }
+
+    pthread_mutex_unlock(&ucs_mpool_tcache_global.lock);
+
+    mp->freelist     = tcache->freelist;
+    mp->data->tcache = NULL;
+    ucs_spinlock_destroy(&tcache->lock);
+    ucs_free(tcache);
+}
+
 ucs_status_t ucs_mpool_init(ucs_mpool_t *mp, size_t priv_size,
                             size_t elem_size, size_t align_offset, size_t alignment,
                             unsigned elems_per_chunk, unsigned max_elems,
@@ -75,6 +529,7 @@ ucs_status_t ucs_mpool_init(ucs_mpool_t *mp, size_t priv_size,
     mp->data->tail            = NULL;
     mp->data->chunks          = NULL;
     mp->data->ops             = ops;
+    mp->data->tcache          = NULL;
     mp->data->name            = ucs_strdup(name, "mpool_data_name");
 
     if (mp->data->name == NULL) {
@@ -101,6 +556,10 @@ void ucs_mpool_cleanup(ucs_mpool_t *mp, int leak_check)
     ucs_mpool_data_t *data = mp->data;
     void *obj;
 
+    if (data->tcache != NULL) {
+        ucs_mpool_tcache_disable(mp);
+    }
+
     /* Cleanup all elements in the freelist and set their header to NULL to mark
      * them as released for the leak check.
      */
@@ -157,6 +616,12 @@ const char *ucs_mpool_name(ucs_mpool_t *mp)
 
 int ucs_mpool_is_empty(ucs_mpool_t *mp)
 {
+    ucs_mpool_tcache_shared_t *tcache = mp->data->tcache;
+
+    if (tcache != NULL) {
+        return (tcache->freelist == NULL) && (mp->data->quota == 0);
+    }
+
     return (mp->freelist == NULL) && (mp->data->quota == 0);
 }
 
@@ -172,68 +637,25 @@ void ucs_mpool_put(void *obj)
 
 void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
 {
-    ucs_mpool_data_t *data = mp->data;
-    size_t chunk_size, chunk_padding;
-    ucs_mpool_chunk_t *chunk;
-    ucs_mpool_elem_t *elem;
-    ucs_status_t status;
-    unsigned i;
-    void *ptr;
-
-    if (data->quota == 0) {
-        return;
-    }
-
-    chunk_size = sizeof(ucs_mpool_chunk_t) + data->alignment +
-                 (num_elems * ucs_mpool_elem_total_size(data));
-    status = data->ops->chunk_alloc(mp, &chunk_size, &ptr);
-    if (status != UCS_OK) {
-        ucs_error("Failed to allocate memory pool (name=%s) chunk: %s",
-                  ucs_mpool_name(mp), ucs_status_string(status));
-        return;
-    }
-
-    /* Calculate padding, and update element count according to allocated size */
-    chunk            = ptr;
-    chunk_padding    = ucs_padding((uintptr_t)(chunk + 1) + data->align_offset,
-                                   data->alignment);
-    chunk->elems     = UCS_PTR_BYTE_OFFSET(chunk + 1, chunk_padding);
-    chunk->num_elems = ucs_min(data->quota, (chunk_size - chunk_padding - sizeof(*chunk)) /
-                       ucs_mpool_elem_total_size(data));
-
-    ucs_debug("mpool %s: allocated chunk %p of %lu bytes with %u elements",
-              ucs_mpool_name(mp), chunk, chunk_size, chunk->num_elems);
-
-    for (i = 0; i < chunk->num_elems; ++i) {
-        elem         = ucs_mpool_chunk_elem(data, chunk, i);
-        if (data->ops->obj_init != NULL) {
-            data->ops->obj_init(mp, elem + 1, chunk);
-        }
-
-        ucs_mpool_add_to_freelist(mp, elem, 0);
-        if (data->tail == NULL) {
-            data->tail = elem;
-        }
-    }
-
-    chunk->next  = data->chunks;
-    data->chunks = chunk;
+    ucs_mpool_tcache_shared_t *tcache = mp->data->tcache;
 
-    if (data->quota == UINT_MAX) {
-        /* Infinite memory pool */
-    } else if (data->quota >= chunk->num_elems) {
-        data->quota -= chunk->num_elems;
+    if (tcache == NULL) {
+        ucs_mpool_grow_freelist(mp, num_elems, &mp->freelist);
     } else {
-        data->quota = 0;
+        ucs_spin_lock(&tcache->lock);
+        ucs_mpool_grow_freelist(mp, num_elems, &tcache->freelist);
+        ucs_spin_unlock(&tcache->lock);
     }
-
-    VALGRIND_MAKE_MEM_NOACCESS(chunk + 1, chunk_size - sizeof(*chunk));
 }
 
 void *ucs_mpool_get_grow(ucs_mpool_t *mp)
 {
     ucs_mpool_data_t *data = mp->data;
 
+    if (data->tcache != NULL) {
+        return ucs_mpool_tcache_get(mp);
+    }
+
     ucs_mpool_grow(mp, data->elems_per_chunk);
     if (mp->freelist == NULL) {
         return NULL;
@@ -283,6 +705,29 @@ void ucs_mpool_chunk_munmap(ucs_mpool_t *mp, void *chunk)
     ucs_munmap(hdr, hdr->size);
 }
 
+ucs_status_t ucs_mpool_chunk_mmap_numa(ucs_mpool_t *mp, size_t *size_p,
+                                       void **chunk_p)
+{
+    ucs_mmap_mpool_chunk_hdr_t *hdr;
+    ucs_status_t status;
+
+    status = ucs_mpool_chunk_mmap(mp, size_p, chunk_p);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    /* Only the header page was touched so far, the elements are populated by
+     * ucs_mpool_grow() on the same thread */
+    hdr = (ucs_mmap_mpool_chunk_hdr_t*)*chunk_p - 1;
+    status = ucs_numa_mem_prefer_local(hdr, hdr->size);
+    if (status != UCS_OK) {
+        ucs_debug("mpool %s: failed to set NUMA policy of chunk %p: %s",
+                  ucs_mpool_name(mp), *chunk_p, ucs_status_string(status));
+    }
+
+    return UCS_OK;
+}
+
 
 typedef struct ucs_hugetlb_mpool_chunk_hdr {
     int hugetlb;
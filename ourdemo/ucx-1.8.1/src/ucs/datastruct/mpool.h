@@ -20,6 +20,7 @@ typedef union  ucs_mpool_elem    ucs_mpool_elem_t;
 typedef struct ucs_mpool         ucs_mpool_t;
 typedef struct ucs_mpool_data    ucs_mpool_data_t;
 typedef struct ucs_mpool_ops     ucs_mpool_ops_t;
+typedef struct ucs_mpool_tcache_shared ucs_mpool_tcache_shared_t;
 
 
 /**
@@ -62,11 +63,20 @@ struct ucs_mpool_chunk {
  * Memory pool structure.
  */
 struct ucs_mpool {
-    ucs_mpool_elem_t       *freelist;  /* List of available elements */
+    ucs_mpool_elem_t       *freelist;  /* List of available elements, or
+                                          UCS_MPOOL_FREELIST_TCACHE */
     ucs_mpool_data_t       *data;      /* Slow-path data */
 };
 
 
+/*
+ * Value of mp->freelist while the thread cache is enabled. Keeping it in the
+ * pool structure lets the fast path find out about the thread cache without
+ * loading mp->data.
+ */
+#define UCS_MPOOL_FREELIST_TCACHE  ((ucs_mpool_elem_t*)0x1)
+
+
 /**
  * Memory pool slow-path data.
  */
@@ -79,6 +89,7 @@ struct ucs_mpool_data {
     ucs_mpool_elem_t       *tail;           /* Free list tail */
     ucs_mpool_chunk_t      *chunks;         /* List of allocated chunks */
     ucs_mpool_ops_t        *ops;            /* Memory pool operations */
+    ucs_mpool_tcache_shared_t *tcache;      /* Thread cache state, NULL if disabled */
     char                   *name;           /* Name - used for debugging */
 };
 
@@ -162,6 +173,26 @@ ucs_status_t ucs_mpool_init(ucs_mpool_t *mp, size_t priv_size,
 void ucs_mpool_cleanup(ucs_mpool_t *mp, int leak_check);
 
 
+/**
+ * Enable per-thread caching of free elements, which makes the memory pool
+ * thread-safe. Every thread keeps up to @a cache_size free elements in a
+ * private list, and moves elements to/from the shared free list in batches of
+ * @a cache_size / 2, so the shared list lock is taken once per batch rather
+ * than once per get/put operation.
+ *
+ * Must not be called concurrently with other operations on the memory pool.
+ * Elements held in the caches of other threads are not visible to the calling
+ * thread, so a pool with a limited number of elements may appear empty while
+ * some elements are still free.
+ *
+ * @param mp               Memory pool structure.
+ * @param cache_size       Maximal number of free elements in each thread cache.
+ *
+ * @return UCS status code.
+ */
+ucs_status_t ucs_mpool_thread_cache_enable(ucs_mpool_t *mp, unsigned cache_size);
+
+
 /**
  * @param mp               Memory pool structure.
  *
@@ -226,6 +257,16 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems);
 void *ucs_mpool_get_grow(ucs_mpool_t *mp);
 
 
+/**
+ * Return an element to the calling thread's cache.
+ * Used internally by ucs_mpool_put() if the thread cache is enabled.
+ *
+ * @param mp               Memory pool structure.
+ * @param elem             Element to return.
+ */
+void ucs_mpool_tcache_put(ucs_mpool_t *mp, ucs_mpool_elem_t *elem);
+
+
 /**
  * heap-based chunk allocator.
  */
@@ -240,6 +281,14 @@ ucs_status_t ucs_mpool_chunk_mmap(ucs_mpool_t *mp, size_t *size_p, void **chunk_
 void ucs_mpool_chunk_munmap(ucs_mpool_t *mp, void *chunk);
 
 
+/*
+ * mmap chunk allocator, which places the chunk memory on the NUMA node of the
+ * CPU the pool is grown on. Chunks are released by ucs_mpool_chunk_munmap().
+ */
+ucs_status_t ucs_mpool_chunk_mmap_numa(ucs_mpool_t *mp, size_t *size_p,
+                                       void **chunk_p);
+
+
 /**
  * hugetlb chunk allocator.
  */
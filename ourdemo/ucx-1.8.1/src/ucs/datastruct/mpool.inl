@@ -19,7 +19,9 @@ static inline void *ucs_mpool_get_inline(ucs_mpool_t *mp)
     ucs_mpool_elem_t *elem;
     void *obj;
 
-    if (ucs_unlikely(mp->freelist == NULL)) {
+    /* Also takes the slow path if the thread cache is enabled */
+    if (ucs_unlikely((uintptr_t)mp->freelist <=
+                     (uintptr_t)UCS_MPOOL_FREELIST_TCACHE)) {
         return ucs_mpool_get_grow(mp);
     }
 
@@ -76,8 +78,12 @@ static inline void ucs_mpool_put_inline(void *obj)
 
     elem = ucs_mpool_obj_to_elem(obj);
     mp   = elem->mpool;
-    ucs_mpool_add_to_freelist(mp, elem,
-                              ENABLE_DEBUG_DATA && ucs_global_opts.mpool_fifo);
+    if (ucs_unlikely(mp->freelist == UCS_MPOOL_FREELIST_TCACHE)) {
+        ucs_mpool_tcache_put(mp, elem);
+    } else {
+        ucs_mpool_add_to_freelist(mp, elem,
+                                  ENABLE_DEBUG_DATA && ucs_global_opts.mpool_fifo);
+    }
     VALGRIND_MAKE_MEM_NOACCESS(elem, sizeof *elem);
     VALGRIND_MEMPOOL_FREE(mp, obj);
 }
@@ -67,4 +67,53 @@ int ucs_numa_node_of_cpu(int cpu)
     return cpu_numa_nodes[cpu] - 1;
 }
 
+ucs_status_t ucs_numa_mem_prefer_local(void *address, size_t length)
+{
+    struct bitmask *nodemask;
+    ucs_status_t status;
+    int cpu, node, ret;
+
+    if (numa_available() < 0) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    cpu = sched_getcpu();
+    if (cpu < 0) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    node = ucs_numa_node_of_cpu(cpu);
+    if (node < 0) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    nodemask = numa_allocate_nodemask();
+    if (nodemask == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    numa_bitmask_clearall(nodemask);
+    numa_bitmask_setbit(nodemask, node);
+
+    ret = mbind(address, length, MPOL_PREFERRED, numa_nodemask_p(nodemask),
+                numa_nodemask_size(nodemask), 0);
+    if (ret < 0) {
+        ucs_debug("mbind(addr=%p length=%zu node=%d) failed: %m", address,
+                  length, node);
+        status = UCS_ERR_IO_ERROR;
+    } else {
+        status = UCS_OK;
+    }
+
+    numa_free_nodemask(nodemask);
+    return status;
+}
+
+#else
+
+ucs_status_t ucs_numa_mem_prefer_local(void *address, size_t length)
+{
+    return UCS_ERR_UNSUPPORTED;
+}
+
 #endif
@@ -12,6 +12,7 @@
 #endif
 
 #include <ucs/debug/memtrack.h>
+#include <ucs/type/status.h>
 
 #if HAVE_NUMA
 #include <numaif.h>
@@ -62,4 +63,17 @@ extern const char *ucs_numa_policy_names[];
 int ucs_numa_node_of_cpu(int cpu);
 
 
+/**
+ * Set the memory policy of an address range to prefer the NUMA node of the CPU
+ * which the calling thread is currently running on. Pages which were already
+ * faulted in are not moved.
+ *
+ * @param address  Page-aligned start address.
+ * @param length   Length of the range.
+ *
+ * @return UCS_OK, or UCS_ERR_UNSUPPORTED if NUMA support is not available.
+ */
+ucs_status_t ucs_numa_mem_prefer_local(void *address, size_t length);
+
+
 #endif
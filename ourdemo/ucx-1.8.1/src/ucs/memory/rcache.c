@@ -6,6 +6,7 @@
 
 
 #include <ucs/arch/atomic.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/type/class.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/debug/log.h>
@@ -48,6 +49,35 @@ typedef struct ucs_rcache_inv_entry {
 } ucs_rcache_inv_entry_t;
 
 
+typedef struct ucs_rcache_tcache_entry {
+    ucs_pgt_addr_t           start;
+    ucs_pgt_addr_t           end;
+    int                      prot;
+    uint32_t                 refs;     /* References kept for the owner thread */
+    ucs_rcache_region_t      *region;  /* Holds a reference, NULL if unused */
+} ucs_rcache_tcache_entry_t;
+
+
+/*
+ * Per-thread lookup table in front of the page table. Only the owner thread
+ * looks up and adds entries, so its lock is not contended and the cache line
+ * stays local. Other threads take the lock only when they invalidate a region
+ * (with the page table lock held in write mode), and remove the region from
+ * all lookup tables before it is taken out of the page table.
+ *
+ * Besides its own reference, an entry keeps the references the owner thread
+ * put back to it, and hands them out again on a hit, so a get and put pair on
+ * the same thread does not touch the shared region refcount.
+ */
+typedef struct ucs_rcache_tcache {
+    ucs_spinlock_t            lock;     /* Protects entries[] */
+    ucs_list_link_t           list;     /* Entry in rcache->tcache_list */
+    ucs_rcache_t              *rcache;
+    unsigned                  next;     /* Next entry to replace */
+    ucs_rcache_tcache_entry_t entries[0];
+} ucs_rcache_tcache_t;
+
+
 #if ENABLE_STATS
 static ucs_stats_class_t ucs_rcache_stats_class = {
     .name = "rcache",
@@ -237,6 +267,220 @@ static inline void ucs_rcache_region_put_internal(ucs_rcache_t *rcache,
     }
 }
 
+/* Drop the references held by a lookup table entry */
+static void ucs_rcache_tcache_entry_put(ucs_rcache_t *rcache,
+                                        ucs_rcache_region_t *region,
+                                        uint32_t refs, int lock)
+{
+    if (refs > 0) {
+        /* the entry's own reference keeps the region alive */
+        ucs_assert(region->refcount > refs);
+        ucs_atomic_sub32(&region->refcount, refs);
+    }
+    ucs_rcache_region_put_internal(rcache, region, lock, 0);
+}
+
+/* Lock must be held in write mode */
+static void ucs_rcache_tcache_release(ucs_rcache_t *rcache,
+                                      ucs_rcache_tcache_t *tcache)
+{
+    ucs_status_t status;
+    unsigned i;
+
+    ucs_list_del(&tcache->list);
+    for (i = 0; i < rcache->tcache_size; ++i) {
+        if (tcache->entries[i].region != NULL) {
+            ucs_rcache_tcache_entry_put(rcache, tcache->entries[i].region,
+                                        tcache->entries[i].refs, 0);
+        }
+    }
+
+    status = ucs_spinlock_destroy(&tcache->lock);
+    if (status != UCS_OK) {
+        ucs_warn("ucs_spinlock_destroy() failed (%d)", status);
+    }
+    ucs_free(tcache);
+}
+
+static void ucs_rcache_tcache_destructor(void *arg)
+{
+    ucs_rcache_tcache_t *tcache = arg;
+    ucs_rcache_t *rcache        = tcache->rcache;
+
+    pthread_rwlock_wrlock(&rcache->lock);
+    ucs_rcache_tcache_release(rcache, tcache);
+    pthread_rwlock_unlock(&rcache->lock);
+}
+
+static ucs_rcache_tcache_t *ucs_rcache_tcache_create(ucs_rcache_t *rcache)
+{
+    ucs_rcache_tcache_t *tcache;
+    ucs_status_t status;
+    int error;
+
+    error = ucs_posix_memalign((void**)&tcache, UCS_SYS_CACHE_LINE_SIZE,
+                               sizeof(*tcache) + (rcache->tcache_size *
+                                                  sizeof(*tcache->entries)),
+                               "rcache_tcache");
+    if (error != 0) {
+        return NULL;
+    }
+
+    status = ucs_spinlock_init(&tcache->lock);
+    if (status != UCS_OK) {
+        ucs_free(tcache);
+        return NULL;
+    }
+
+    tcache->rcache = rcache;
+    tcache->next   = 0;
+    memset(tcache->entries, 0, rcache->tcache_size * sizeof(*tcache->entries));
+
+    pthread_rwlock_wrlock(&rcache->lock);
+    ucs_list_add_tail(&rcache->tcache_list, &tcache->list);
+    pthread_rwlock_unlock(&rcache->lock);
+
+    pthread_setspecific(rcache->tcache_key, tcache);
+    return tcache;
+}
+
+static int ucs_rcache_tcache_lookup(ucs_rcache_t *rcache, ucs_pgt_addr_t start,
+                                    size_t length, int prot,
+                                    ucs_rcache_region_t **region_p)
+{
+    ucs_rcache_tcache_entry_t *entry;
+    ucs_rcache_tcache_t *tcache;
+
+    tcache = pthread_getspecific(rcache->tcache_key);
+    if (tcache == NULL) {
+        return 0;
+    }
+
+    ucs_spin_lock(&tcache->lock);
+    for (entry = tcache->entries;
+         entry < tcache->entries + rcache->tcache_size; ++entry) {
+        if ((entry->region != NULL) && (start >= entry->start) &&
+            ((start + length) <= entry->end) &&
+            ucs_test_all_flags(entry->prot, prot))
+        {
+            if (entry->refs > 0) {
+                --entry->refs;
+                ucs_rcache_region_trace(rcache, entry->region, "hold_local");
+            } else {
+                ucs_rcache_region_hold(rcache, entry->region);
+            }
+            *region_p = entry->region;
+            ucs_spin_unlock(&tcache->lock);
+            return 1;
+        }
+    }
+    ucs_spin_unlock(&tcache->lock);
+    return 0;
+}
+
+/* Put a region reference back to the lookup table of the calling thread */
+static int ucs_rcache_tcache_put(ucs_rcache_t *rcache,
+                                 ucs_rcache_region_t *region)
+{
+    ucs_rcache_tcache_entry_t *entry;
+    ucs_rcache_tcache_t *tcache;
+
+    if (rcache->tcache_size == 0) {
+        return 0;
+    }
+
+    tcache = pthread_getspecific(rcache->tcache_key);
+    if (tcache == NULL) {
+        return 0;
+    }
+
+    ucs_spin_lock(&tcache->lock);
+    for (entry = tcache->entries;
+         entry < tcache->entries + rcache->tcache_size; ++entry) {
+        if (entry->region == region) {
+            ++entry->refs;
+            ucs_rcache_region_trace(rcache, region, "put_local");
+            ucs_spin_unlock(&tcache->lock);
+            return 1;
+        }
+    }
+    ucs_spin_unlock(&tcache->lock);
+    return 0;
+}
+
+/*
+ * Add a registered region, which the caller holds, to the lookup table of the
+ * calling thread. 'gen' is the value of rcache->tcache_gen before the region
+ * was found; if any region was removed from the page table since then, the
+ * region is not added because it could be already invalidated.
+ */
+static void ucs_rcache_tcache_add(ucs_rcache_t *rcache,
+                                  ucs_rcache_region_t *region, uint64_t gen)
+{
+    ucs_rcache_region_t *evicted;
+    ucs_rcache_tcache_entry_t *entry;
+    ucs_rcache_tcache_t *tcache;
+    uint32_t evicted_refs;
+
+    if (rcache->tcache_size == 0) {
+        return;
+    }
+
+    tcache = pthread_getspecific(rcache->tcache_key);
+    if (tcache == NULL) {
+        tcache = ucs_rcache_tcache_create(rcache);
+        if (tcache == NULL) {
+            return;
+        }
+    }
+
+    ucs_spin_lock(&tcache->lock);
+    if (rcache->tcache_gen != gen) {
+        ucs_spin_unlock(&tcache->lock);
+        return;
+    }
+
+    entry         = &tcache->entries[tcache->next];
+    tcache->next  = (tcache->next + 1) % rcache->tcache_size;
+    evicted       = entry->region;
+    evicted_refs  = entry->refs;
+    entry->start  = region->super.start;
+    entry->end    = region->super.end;
+    entry->prot   = region->prot;
+    entry->refs   = 0;
+    entry->region = region;
+    ucs_rcache_region_hold(rcache, region);
+    ucs_spin_unlock(&tcache->lock);
+
+    /* May destroy the region, so must not be called with tcache lock held */
+    if (evicted != NULL) {
+        ucs_rcache_tcache_entry_put(rcache, evicted, evicted_refs, 1);
+    }
+}
+
+/* Lock must be held in write mode */
+static void ucs_rcache_tcache_invalidate(ucs_rcache_t *rcache,
+                                         ucs_rcache_region_t *region)
+{
+    ucs_rcache_tcache_t *tcache;
+    unsigned i;
+
+    ucs_atomic_add64(&rcache->tcache_gen, 1);
+
+    ucs_list_for_each(tcache, &rcache->tcache_list, list) {
+        ucs_spin_lock(&tcache->lock);
+        for (i = 0; i < rcache->tcache_size; ++i) {
+            if (tcache->entries[i].region == region) {
+                /* The page table still holds a reference */
+                tcache->entries[i].region = NULL;
+                ucs_rcache_tcache_entry_put(rcache, region,
+                                            tcache->entries[i].refs, 0);
+            }
+        }
+        ucs_spin_unlock(&tcache->lock);
+    }
+}
+
 /* Lock must be held in write mode */
 static void ucs_rcache_region_invalidate(ucs_rcache_t *rcache,
                                          ucs_rcache_region_t *region,
@@ -249,6 +493,7 @@ static void ucs_rcache_region_invalidate(ucs_rcache_t *rcache,
 
     /* Remove the memory region from page table, if it's there */
     if (region->flags & UCS_RCACHE_REGION_FLAG_PGTABLE) {
+        ucs_rcache_tcache_invalidate(rcache, region);
         status = ucs_pgtable_remove(&rcache->pgtable, &region->super);
         if (status != UCS_OK) {
             ucs_rcache_region_warn(rcache, region, "failed to remove (%s)",
@@ -585,13 +830,24 @@ void ucs_rcache_region_hold(ucs_rcache_t *rcache, ucs_rcache_region_t *region)
 ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
                             int prot, void *arg, ucs_rcache_region_t **region_p)
 {
+    uint64_t tcache_gen  = rcache->tcache_gen;
     ucs_pgt_addr_t start = (uintptr_t)address;
     ucs_pgt_region_t *pgt_region;
     ucs_rcache_region_t *region;
+    ucs_status_t status;
 
     ucs_trace_func("rcache=%s, address=%p, length=%zu", rcache->name, address,
                    length);
 
+    /* Try the lookup table of the calling thread, without the page table lock */
+    if (ucs_queue_is_empty(&rcache->inv_q) &&
+        ucs_rcache_tcache_lookup(rcache, start, length, prot, region_p)) {
+        ucs_rcache_region_validate_pfn(rcache, *region_p);
+        UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_GETS, 1);
+        UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_HITS_FAST, 1);
+        return UCS_OK;
+    }
+
     pthread_rwlock_rdlock(&rcache->lock);
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_GETS, 1);
     if (ucs_queue_is_empty(&rcache->inv_q)) {
@@ -607,6 +863,7 @@ ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
                 *region_p = region;
                 UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_HITS_FAST, 1);
                 pthread_rwlock_unlock(&rcache->lock);
+                ucs_rcache_tcache_add(rcache, region, tcache_gen);
                 return UCS_OK;
             }
         }
@@ -618,13 +875,19 @@ ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
      * - could not find cached region
      * - found unregistered region
      */
-    return UCS_PROFILE_CALL(ucs_rcache_create_region, rcache, address, length,
-                            prot, arg, region_p);
+    status = UCS_PROFILE_CALL(ucs_rcache_create_region, rcache, address, length,
+                              prot, arg, region_p);
+    if (status == UCS_OK) {
+        ucs_rcache_tcache_add(rcache, *region_p, tcache_gen);
+    }
+    return status;
 }
 
 void ucs_rcache_region_put(ucs_rcache_t *rcache, ucs_rcache_region_t *region)
 {
-    ucs_rcache_region_put_internal(rcache, region, 1, 0);
+    if (!ucs_rcache_tcache_put(rcache, region)) {
+        ucs_rcache_region_put_internal(rcache, region, 1, 0);
+    }
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_PUTS, 1);
 }
 
@@ -690,14 +953,27 @@ static UCS_CLASS_INIT_FUNC(ucs_rcache_t, const ucs_rcache_params_t *params,
 
     ucs_queue_head_init(&self->inv_q);
 
+    ret = pthread_key_create(&self->tcache_key, ucs_rcache_tcache_destructor);
+    if (ret) {
+        ucs_error("pthread_key_create() failed: %m");
+        status = UCS_ERR_NO_RESOURCE;
+        goto err_destroy_mp;
+    }
+
+    ucs_list_head_init(&self->tcache_list);
+    self->tcache_gen  = 0;
+    self->tcache_size = ucs_global_opts.rcache_thread_cache;
+
     status = ucm_set_event_handler(params->ucm_events, params->ucm_event_priority,
                                    ucs_rcache_unmapped_callback, self);
     if (status != UCS_OK) {
-        goto err_destroy_mp;
+        goto err_delete_key;
     }
 
     return UCS_OK;
 
+err_delete_key:
+    pthread_key_delete(self->tcache_key);
 err_destroy_mp:
     ucs_mpool_cleanup(&self->inv_mp, 1);
 err_cleanup_pgtable:
@@ -719,10 +995,21 @@ err:
 
 static UCS_CLASS_CLEANUP_FUNC(ucs_rcache_t)
 {
+    ucs_rcache_tcache_t *tcache, *tmp;
     ucs_status_t status;
 
     ucm_unset_event_handler(self->params.ucm_events, ucs_rcache_unmapped_callback,
                             self);
+
+    /* Threads which exit after this point do not release their lookup tables,
+     * so release all of them here. The rcache must not be destroyed while other
+     * threads are still using it or exiting.
+     */
+    pthread_key_delete(self->tcache_key);
+    ucs_list_for_each_safe(tcache, tmp, &self->tcache_list, list) {
+        ucs_rcache_tcache_release(self, tcache);
+    }
+
     ucs_rcache_check_inv_queue(self);
     ucs_rcache_purge(self);
 
@@ -7,6 +7,7 @@
 #ifndef UCS_REG_CACHE_INT_H_
 #define UCS_REG_CACHE_INT_H_
 
+#include <ucs/datastruct/list.h>
 #include <ucs/type/spinlock.h>
 
 /* Names of rcache stats counters */
@@ -42,6 +43,13 @@ struct ucs_rcache {
                                           since we cannot use regulat malloc().
                                           The backing storage is original mmap()
                                           which does not generate memory events */
+    pthread_key_t          tcache_key; /**< Per-thread lookup table of this rcache */
+    ucs_list_link_t        tcache_list; /**< All per-thread lookup tables, protected
+                                             by the page table lock */
+    volatile uint64_t      tcache_gen; /**< Incremented whenever a region is removed
+                                            from the page table, to prevent adding
+                                            stale regions to a lookup table */
+    unsigned               tcache_size; /**< Number of entries in a lookup table */
     char                   *name;
     UCS_STATS_NODE_DECLARE(stats)
 };
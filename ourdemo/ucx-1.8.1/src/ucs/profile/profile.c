@@ -6,6 +6,8 @@
 
 #include "profile.h"
 
+#include <ucs/async/pipe.h>
+#include <ucs/config/parser.h>
 #include <ucs/datastruct/list.h>
 #include <ucs/debug/debug.h>
 #include <ucs/debug/log.h>
@@ -13,6 +15,8 @@
 #include <ucs/sys/sys.h>
 #include <ucs/time/time.h>
 #include <pthread.h>
+#include <signal.h>
+#include <poll.h>
 
 
 typedef struct ucs_profile_global_location {
@@ -31,6 +35,15 @@ typedef struct ucs_profile_global_context {
     pthread_mutex_t               mutex;         /**< Protects updating the locations array */
     pthread_key_t                 tls_key;       /**< TLS key for per-thread context */
     ucs_list_link_t               thread_list;   /**< List of all thread contexts */
+
+    struct {
+        int                       active;        /**< Whether the thread is running */
+        volatile int              stop;          /**< Set to stop the thread */
+        pthread_t                 thread;        /**< Thread which saves the data */
+        ucs_async_pipe_t          pipe;          /**< Wakes up the thread */
+        double                    interval;      /**< Timer interval, or 0 */
+        int                       signo;         /**< Signal number, or 0 */
+    } trigger;
 } ucs_profile_global_context_t;
 
 
@@ -47,7 +60,9 @@ typedef struct ucs_profile_thread_context {
         ucs_profile_record_t          *start;        /**< Circular log buffer start */
         ucs_profile_record_t          *end;          /**< Circular log buffer end */
         ucs_profile_record_t          *current;      /**< Current log pointer */
-        int                           wraparound;    /**< Whether log was rotated */
+        volatile uint64_t             count;         /**< Total number of records
+                                                          written, used to copy the
+                                                          log of a running thread */
     } log;
 
     struct {
@@ -59,6 +74,15 @@ typedef struct ucs_profile_thread_context {
 } ucs_profile_thread_context_t;
 
 
+/* Copy of a thread's circular log */
+typedef struct ucs_profile_log_snapshot {
+    ucs_profile_record_t              *records;      /**< Copy of the log buffer */
+    size_t                            size;          /**< Log buffer size */
+    uint64_t                          first;         /**< Number of the first valid record */
+    uint64_t                          last;          /**< Number of the last valid record + 1 */
+} ucs_profile_log_snapshot_t;
+
+
 #define ucs_profile_for_each_location(_var) \
     for ((_var) = ucs_profile_global_ctx.locations; \
          (_var) < (ucs_profile_global_ctx.locations + \
@@ -72,6 +96,12 @@ const char *ucs_profile_mode_names[] = {
     [UCS_PROFILE_MODE_LAST]  = NULL
 };
 
+const char *ucs_profile_format_names[] = {
+    [UCS_PROFILE_FORMAT_BINARY] = "binary",
+    [UCS_PROFILE_FORMAT_CHROME] = "chrome",
+    [UCS_PROFILE_FORMAT_LAST]   = NULL
+};
+
 static ucs_profile_global_context_t ucs_profile_global_ctx = {
     .locations     = NULL,
     .num_locations = 0,
@@ -100,11 +130,73 @@ static ucs_status_t ucs_profile_file_write_data(int fd, void *data, size_t size)
     return UCS_OK;
 }
 
+/*
+ * Copy the log of a thread, which may still be recording. Records which were
+ * overwritten while copying are dropped.
+ */
+static void ucs_profile_thread_log_snapshot(ucs_profile_thread_context_t *ctx,
+                                            ucs_profile_log_snapshot_t *snapshot)
+{
+    uint64_t last, count, margin;
+
+    snapshot->size    = ctx->log.end - ctx->log.start;
+    snapshot->first   = snapshot->last = 0;
+    snapshot->records = ucs_malloc(snapshot->size * sizeof(*snapshot->records),
+                                   "profile_log_snapshot");
+    if (snapshot->records == NULL) {
+        ucs_error("failed to allocate profiling log snapshot");
+        return;
+    }
+
+    last = ctx->log.count;
+    ucs_memory_cpu_load_fence();
+    memcpy(snapshot->records, ctx->log.start,
+           snapshot->size * sizeof(*snapshot->records));
+    ucs_memory_cpu_load_fence();
+    count = ctx->log.count;
+
+    /* A running thread could be in the middle of writing record 'count', which
+     * replaces the oldest one */
+    margin          = (ctx->is_completed ||
+                       pthread_equal(ctx->pthread_id, pthread_self())) ? 0 : 1;
+    snapshot->first = (count + margin > snapshot->size) ?
+                      (count + margin - snapshot->size) : 0;
+    snapshot->last  = ucs_max(last, snapshot->first);
+}
+
+static inline ucs_profile_record_t *
+ucs_profile_log_snapshot_record(ucs_profile_log_snapshot_t *snapshot,
+                                uint64_t index)
+{
+    return &snapshot->records[index % snapshot->size];
+}
+
 static ucs_status_t
-ucs_profile_file_write_records(int fd, ucs_profile_record_t *begin,
-                               ucs_profile_record_t *end)
+ucs_profile_file_write_records(int fd, ucs_profile_log_snapshot_t *snapshot)
 {
-    return ucs_profile_file_write_data(fd, begin, UCS_PTR_BYTE_DIFF(begin, end));
+    uint64_t num_records = snapshot->last - snapshot->first;
+    size_t tail_records;
+    ucs_status_t status;
+
+    if (num_records == 0) {
+        return UCS_OK;
+    }
+
+    /* Records from the first one to the end of the buffer, then from the
+     * beginning of the buffer */
+    tail_records = ucs_min(num_records,
+                           snapshot->size - (snapshot->first % snapshot->size));
+    status = ucs_profile_file_write_data(fd,
+                                         ucs_profile_log_snapshot_record(snapshot,
+                                                                         snapshot->first),
+                                         tail_records * sizeof(ucs_profile_record_t));
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    return ucs_profile_file_write_data(fd, snapshot->records,
+                                       (num_records - tail_records) *
+                                       sizeof(ucs_profile_record_t));
 }
 
 /* Global lock must be held */
@@ -113,21 +205,23 @@ ucs_profile_file_write_thread(int fd, ucs_profile_thread_context_t *ctx,
                               ucs_time_t default_end_time)
 {
     ucs_profile_thread_location_t empty_location = { .total_time = 0, .count = 0 };
+    ucs_profile_log_snapshot_t snapshot = { .records = NULL, .first = 0, .last = 0 };
     ucs_profile_thread_header_t thread_hdr;
     unsigned i, num_locations;
     ucs_status_t status;
 
     /*
-     * NOTE: There is no protection against a race with a thread which is still
-     * producing profiling data (e.g updating the context structure without a
-     * lock).
-     * To avoid excess locking on fast-path, we assume that when we dump the
-     * profiling data (at program exit), the profiled threads are not calling
-     * ucs_profile_record() anymore.
+     * NOTE: To avoid excess locking on fast-path, a thread which is still
+     * producing profiling data is not stopped. Its log records are copied
+     * consistently, but accumulated counters may be slightly off.
      */
 
     ucs_debug("profiling context %p: write to file", ctx);
 
+    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
+        ucs_profile_thread_log_snapshot(ctx, &snapshot);
+    }
+
     /* write thread header */
     thread_hdr.tid          = ctx->tid;
     thread_hdr.start_time   = ctx->start_time;
@@ -137,17 +231,11 @@ ucs_profile_file_write_thread(int fd, ucs_profile_thread_context_t *ctx,
         thread_hdr.end_time = default_end_time;
     }
 
-    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
-        thread_hdr.num_records = ctx->log.wraparound ?
-                             (ctx->log.end     - ctx->log.start) :
-                             (ctx->log.current - ctx->log.start);
-    } else {
-        thread_hdr.num_records = 0;
-    }
+    thread_hdr.num_records  = snapshot.last - snapshot.first;
 
     status = ucs_profile_file_write_data(fd, &thread_hdr, sizeof(thread_hdr));
     if (status != UCS_OK) {
-        return status;
+        goto out;
     }
 
     /* If accumulate mode is not enabled, there are no location entries */
@@ -169,28 +257,16 @@ ucs_profile_file_write_thread(int fd, ucs_profile_thread_context_t *ctx,
         status = ucs_profile_file_write_data(fd, &empty_location,
                                              sizeof(empty_location));
         if (status != UCS_OK) {
-            return status;
+            goto out;
         }
     }
 
     /* write profiling records */
-    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
-        if (ctx->log.wraparound) {
-            status = ucs_profile_file_write_records(fd, ctx->log.current,
-                                                    ctx->log.end);
-            if (status != UCS_OK) {
-                return status;
-            }
-        }
+    status = ucs_profile_file_write_records(fd, &snapshot);
 
-        status = ucs_profile_file_write_records(fd, ctx->log.start,
-                                                ctx->log.current);
-        if (status != UCS_OK) {
-            return status;
-        }
-    }
-
-    return UCS_OK;
+out:
+    ucs_free(snapshot.records);
+    return status;
 }
 
 static ucs_status_t ucs_profile_write_locations(int fd)
@@ -208,32 +284,18 @@ static ucs_status_t ucs_profile_write_locations(int fd)
     return UCS_OK;
 }
 
-static void ucs_profile_write()
+/* Global lock must be held */
+static void ucs_profile_write_binary(const char *path, ucs_time_t write_time)
 {
     ucs_profile_thread_context_t *ctx;
     ucs_profile_header_t header;
-    char fullpath[1024] = {0};
-    char filename[1024] = {0};
-    ucs_time_t write_time;
     ucs_status_t status;
     int fd;
 
-    if (!ucs_global_opts.profile_mode) {
-        return;
-    }
-
-    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
-
-    write_time = ucs_get_time();
-
-    ucs_fill_filename_template(ucs_global_opts.profile_file,
-                               filename, sizeof(filename));
-    ucs_expand_path(filename, fullpath, sizeof(fullpath) - 1);
-
-    fd = open(fullpath, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+    fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0600);
     if (fd < 0) {
-        ucs_error("failed to write profiling data to '%s': %m", fullpath);
-        goto out_unlock;
+        ucs_error("failed to write profiling data to '%s': %m", path);
+        return;
     }
 
     /* write header */
@@ -265,7 +327,202 @@ static void ucs_profile_write()
 
 out_close_fd:
     close(fd);
-out_unlock:
+}
+
+static void ucs_profile_chrome_write_string(FILE *stream, const char *str)
+{
+    fputc('"', stream);
+    for (; *str != '\0'; ++str) {
+        if ((*str == '"') || (*str == '\\')) {
+            fprintf(stream, "\\%c", *str);
+        } else if ((unsigned char)*str < ' ') {
+            fprintf(stream, "\\u%04x", (unsigned char)*str);
+        } else {
+            fputc(*str, stream);
+        }
+    }
+    fputc('"', stream);
+}
+
+/*
+ * Write the beginning of a trace event, up to and including the "args" key.
+ * The caller completes the args object and closes the event.
+ */
+static void ucs_profile_chrome_write_event(FILE *stream, int *is_first,
+                                           const char *ph, const char *name,
+                                           int tid, double ts)
+{
+    fprintf(stream, "%s\n{\"ph\":\"%s\",\"name\":", *is_first ? "" : ",", ph);
+    ucs_profile_chrome_write_string(stream, name);
+    fprintf(stream, ",\"pid\":%d,\"tid\":%d,\"ts\":%.3f", getpid(), tid, ts);
+    *is_first = 0;
+}
+
+static void ucs_profile_chrome_write_loc_args(FILE *stream,
+                                              const ucs_profile_location_t *loc,
+                                              const ucs_profile_record_t *rec)
+{
+    fprintf(stream, ",\"args\":{\"location\":\"%s:%d\",\"function\":\"%s\","
+            "\"param32\":%u,\"param64\":%"PRIu64"}}", loc->file, loc->line,
+            loc->function, rec->param32, rec->param64);
+}
+
+/*
+ * Write the log of a thread as trace events:
+ * - scopes as complete ("X") events,
+ * - samples as instant ("i") events,
+ * - requests as async events ("b", "n", "e") with the request pointer as id,
+ *   so a request is shown as one slice from its creation to its release.
+ */
+static void ucs_profile_chrome_write_thread(FILE *stream,
+                                            ucs_profile_thread_context_t *ctx,
+                                            ucs_time_t base_time, int *is_first)
+{
+    ucs_profile_log_snapshot_t snapshot;
+    double stack[UCS_PROFILE_STACK_MAX];
+    const ucs_profile_location_t *loc;
+    const ucs_profile_record_t *rec;
+    const char *name;
+    uint64_t num_skipped;
+    int stack_top;
+    uint64_t i;
+    double ts;
+
+    ucs_profile_chrome_write_event(stream, is_first, "M", "thread_name",
+                                   ctx->tid, 0);
+    fprintf(stream, ",\"args\":{\"name\":\"thread %d\"}}", ctx->tid);
+
+    if (!(ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG))) {
+        return;
+    }
+
+    ucs_profile_thread_log_snapshot(ctx, &snapshot);
+
+    stack_top   = -1;
+    num_skipped = 0;
+    for (i = snapshot.first; i < snapshot.last; ++i) {
+        rec = ucs_profile_log_snapshot_record(&snapshot, i);
+        if (rec->location >= ucs_profile_global_ctx.num_locations) {
+            /* torn by a concurrent writer, or otherwise corrupt */
+            ++num_skipped;
+            continue;
+        }
+
+        loc  = &ucs_profile_global_ctx.locations[rec->location].super;
+        name = strlen(loc->name) ? loc->name : loc->function;
+        ts   = ucs_time_to_usec(rec->timestamp - base_time);
+
+        switch (loc->type) {
+        case UCS_PROFILE_TYPE_SCOPE_BEGIN:
+            if (stack_top < (UCS_PROFILE_STACK_MAX - 1)) {
+                stack[++stack_top] = ts;
+            }
+            break;
+        case UCS_PROFILE_TYPE_SCOPE_END:
+            /* the scope could begin before the oldest record */
+            if (stack_top >= 0) {
+                ucs_profile_chrome_write_event(stream, is_first, "X", name,
+                                               ctx->tid, stack[stack_top]);
+                fprintf(stream, ",\"dur\":%.3f", ts - stack[stack_top]);
+                ucs_profile_chrome_write_loc_args(stream, loc, rec);
+                --stack_top;
+            }
+            break;
+        case UCS_PROFILE_TYPE_SAMPLE:
+            ucs_profile_chrome_write_event(stream, is_first, "i", name,
+                                           ctx->tid, ts);
+            fprintf(stream, ",\"s\":\"t\"");
+            ucs_profile_chrome_write_loc_args(stream, loc, rec);
+            break;
+        case UCS_PROFILE_TYPE_REQUEST_NEW:
+        case UCS_PROFILE_TYPE_REQUEST_EVENT:
+        case UCS_PROFILE_TYPE_REQUEST_FREE:
+            if (loc->type == UCS_PROFILE_TYPE_REQUEST_NEW) {
+                ucs_profile_chrome_write_event(stream, is_first, "b", "request",
+                                               ctx->tid, ts);
+            } else if (loc->type == UCS_PROFILE_TYPE_REQUEST_EVENT) {
+                ucs_profile_chrome_write_event(stream, is_first, "n", name,
+                                               ctx->tid, ts);
+            } else {
+                ucs_profile_chrome_write_event(stream, is_first, "e", "request",
+                                               ctx->tid, ts);
+            }
+            fprintf(stream, ",\"cat\":\"request\",\"id\":\"0x%"PRIx64"\"",
+                    rec->param64);
+            ucs_profile_chrome_write_loc_args(stream, loc, rec);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (num_skipped > 0) {
+        ucs_warn("skipped %"PRIu64" corrupt profiling records of thread %d",
+                 num_skipped, ctx->tid);
+    }
+
+    ucs_free(snapshot.records);
+}
+
+/* Global lock must be held */
+static void ucs_profile_write_chrome(const char *path)
+{
+    ucs_profile_thread_context_t *ctx;
+    ucs_time_t base_time;
+    int is_first;
+    FILE *stream;
+
+    stream = fopen(path, "w");
+    if (stream == NULL) {
+        ucs_error("failed to write profiling data to '%s': %m", path);
+        return;
+    }
+
+    /* Timestamps are relative to the start of the earliest thread */
+    base_time = UINT64_MAX;
+    ucs_list_for_each(ctx, &ucs_profile_global_ctx.thread_list, list) {
+        base_time = ucs_min(base_time, ctx->start_time);
+    }
+
+    is_first = 1;
+    fprintf(stream, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    ucs_profile_chrome_write_event(stream, &is_first, "M", "process_name", 0, 0);
+    fprintf(stream, ",\"args\":{\"name\":");
+    ucs_profile_chrome_write_string(stream, ucs_get_host_name());
+    fprintf(stream, "}}");
+
+    ucs_list_for_each(ctx, &ucs_profile_global_ctx.thread_list, list) {
+        ucs_profile_chrome_write_thread(stream, ctx, base_time, &is_first);
+    }
+
+    fprintf(stream, "\n]}\n");
+    fclose(stream);
+}
+
+static void ucs_profile_write()
+{
+    char fullpath[1024] = {0};
+    char filename[1024] = {0};
+    ucs_time_t write_time;
+
+    if (!ucs_global_opts.profile_mode) {
+        return;
+    }
+
+    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
+
+    write_time = ucs_get_time();
+
+    ucs_fill_filename_template(ucs_global_opts.profile_file,
+                               filename, sizeof(filename));
+    ucs_expand_path(filename, fullpath, sizeof(fullpath) - 1);
+
+    if (ucs_global_opts.profile_format == UCS_PROFILE_FORMAT_CHROME) {
+        ucs_profile_write_chrome(fullpath);
+    } else {
+        ucs_profile_write_binary(fullpath, write_time);
+    }
+
     pthread_mutex_unlock(&ucs_profile_global_ctx.mutex);
 }
 
@@ -287,6 +544,7 @@ ucs_profile_thread_context_t* ucs_profile_thread_init()
     ctx->start_time = ucs_get_time();
     ctx->end_time   = 0;
     ctx->pthread_id = pthread_self();
+    ctx->is_completed = 0;
 
     ucs_debug("profiling context %p: start on thread 0x%lx tid %d mode %d",
               ctx, (unsigned long)pthread_self(), ucs_get_tid(), 
@@ -304,7 +562,7 @@ ucs_profile_thread_context_t* ucs_profile_thread_init()
 
         ctx->log.end        = ctx->log.start + num_records;
         ctx->log.current    = ctx->log.start;
-        ctx->log.wraparound = 0;
+        ctx->log.count      = 0;
     }
 
     /* Initialize accumulate mode */
@@ -445,6 +703,10 @@ static void ucs_profile_thread_expand_locations(int loc_id)
     ctx = pthread_getspecific(ucs_profile_global_ctx.tls_key);
     ucs_assert(ctx != NULL);
 
+    /* The locations array may be read by another thread which saves the
+     * profiling data */
+    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
+
     new_num_locations = ucs_max(loc_id, ctx->accum.num_locations);
     ctx->accum.locations = ucs_realloc(ctx->accum.locations,
                                        sizeof(*ctx->accum.locations) *
@@ -460,6 +722,8 @@ static void ucs_profile_thread_expand_locations(int loc_id)
     }
 
     ctx->accum.num_locations = new_num_locations;
+
+    pthread_mutex_unlock(&ucs_profile_global_ctx.mutex);
 }
 
 void ucs_profile_record(ucs_profile_type_t type, const char *name,
@@ -522,9 +786,11 @@ void ucs_profile_record(ucs_profile_type_t type, const char *name,
         rec->param64     = param64;
         rec->param32     = param32;
         rec->location    = loc_id - 1;
+        /* the record must be complete before it's counted */
+        ucs_memory_cpu_store_fence();
+        ++ctx->log.count;
         if (++ctx->log.current >= ctx->log.end) {
-            ctx->log.current    = ctx->log.start;
-            ctx->log.wraparound = 1;
+            ctx->log.current = ctx->log.start;
         }
     }
 }
@@ -590,6 +856,123 @@ void ucs_profile_dump()
     ucs_profile_cleanup_completed_threads();
 }
 
+void ucs_profile_snapshot()
+{
+    ucs_profile_write();
+}
+
+static void ucs_profile_trigger_sighandler(int signo)
+{
+    ucs_async_pipe_push(&ucs_profile_global_ctx.trigger.pipe);
+}
+
+static void *ucs_profile_trigger_thread_func(void *arg)
+{
+    struct pollfd pfd;
+    int timeout_ms;
+    int ret;
+
+    pfd.fd     = ucs_async_pipe_rfd(&ucs_profile_global_ctx.trigger.pipe);
+    pfd.events = POLLIN;
+    timeout_ms = (ucs_profile_global_ctx.trigger.interval > 0) ?
+                 (int)(ucs_profile_global_ctx.trigger.interval * UCS_MSEC_PER_SEC + 0.5) :
+                 -1;
+
+    for (;;) {
+        ret = poll(&pfd, 1, timeout_ms);
+        if (ucs_profile_global_ctx.trigger.stop) {
+            break;
+        }
+
+        if (ret < 0) {
+            if (errno != EINTR) {
+                ucs_error("poll() on profiling trigger failed: %m");
+                break;
+            }
+            continue;
+        }
+
+        /* Woken up by the signal handler, or timer expired */
+        ucs_async_pipe_drain(&ucs_profile_global_ctx.trigger.pipe);
+        ucs_debug("saving profiling data");
+        ucs_profile_snapshot();
+    }
+
+    return NULL;
+}
+
+static void ucs_profile_set_trigger()
+{
+    const char *trigger = ucs_global_opts.profile_trigger;
+    ucs_status_t status;
+    int ret;
+
+    ucs_profile_global_ctx.trigger.active   = 0;
+    ucs_profile_global_ctx.trigger.stop     = 0;
+    ucs_profile_global_ctx.trigger.interval = 0;
+    ucs_profile_global_ctx.trigger.signo    = 0;
+
+    if (!strcmp(trigger, "exit") || !strcmp(trigger, "")) {
+        return;
+    } else if (!strncmp(trigger, "timer:", 6)) {
+        if (!ucs_config_sscanf_time(trigger + 6,
+                                    &ucs_profile_global_ctx.trigger.interval,
+                                    NULL) ||
+            (ucs_profile_global_ctx.trigger.interval <= 0)) {
+            ucs_error("Invalid profiling interval time format: %s", trigger + 6);
+            return;
+        }
+    } else if (!strncmp(trigger, "signal:", 7)) {
+        if (!ucs_config_sscanf_signo(trigger + 7,
+                                     &ucs_profile_global_ctx.trigger.signo,
+                                     NULL)) {
+            ucs_error("Invalid profiling signal specification: %s", trigger + 7);
+            return;
+        }
+    } else {
+        ucs_error("Invalid profiling trigger: %s", trigger);
+        return;
+    }
+
+    status = ucs_async_pipe_create(&ucs_profile_global_ctx.trigger.pipe);
+    if (status != UCS_OK) {
+        return;
+    }
+
+    ret = pthread_create(&ucs_profile_global_ctx.trigger.thread, NULL,
+                         ucs_profile_trigger_thread_func, NULL);
+    if (ret != 0) {
+        ucs_error("failed to create profiling trigger thread: %s",
+                  strerror(ret));
+        ucs_async_pipe_destroy(&ucs_profile_global_ctx.trigger.pipe);
+        return;
+    }
+
+    if (ucs_profile_global_ctx.trigger.signo != 0) {
+        signal(ucs_profile_global_ctx.trigger.signo,
+               ucs_profile_trigger_sighandler);
+    }
+
+    ucs_profile_global_ctx.trigger.active = 1;
+}
+
+static void ucs_profile_unset_trigger()
+{
+    if (!ucs_profile_global_ctx.trigger.active) {
+        return;
+    }
+
+    if (ucs_profile_global_ctx.trigger.signo != 0) {
+        signal(ucs_profile_global_ctx.trigger.signo, SIG_DFL);
+    }
+
+    ucs_profile_global_ctx.trigger.stop = 1;
+    ucs_async_pipe_push(&ucs_profile_global_ctx.trigger.pipe);
+    pthread_join(ucs_profile_global_ctx.trigger.thread, NULL);
+    ucs_async_pipe_destroy(&ucs_profile_global_ctx.trigger.pipe);
+    ucs_profile_global_ctx.trigger.active = 0;
+}
+
 void ucs_profile_global_init()
 {
     if (ucs_global_opts.profile_mode && !strlen(ucs_global_opts.profile_file)) {
@@ -597,12 +980,22 @@ void ucs_profile_global_init()
         ucs_warn("profiling file not specified");
     }
 
+    if ((ucs_global_opts.profile_format == UCS_PROFILE_FORMAT_CHROME) &&
+        !(ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG))) {
+        ucs_warn("chrome profiling format requires 'log' profiling mode");
+    }
+
     pthread_key_create(&ucs_profile_global_ctx.tls_key,
                        ucs_profile_thread_key_destr);
+
+    if (ucs_global_opts.profile_mode) {
+        ucs_profile_set_trigger();
+    }
 }
 
 void ucs_profile_global_cleanup()
 {
+    ucs_profile_unset_trigger();
     ucs_profile_dump();
     ucs_profile_check_active_threads();
     pthread_key_delete(ucs_profile_global_ctx.tls_key);
@@ -30,6 +30,16 @@ enum {
 };
 
 
+/**
+ * Profiling output file formats
+ */
+typedef enum {
+    UCS_PROFILE_FORMAT_BINARY, /**< UCX profile file, see below */
+    UCS_PROFILE_FORMAT_CHROME, /**< Chrome trace event JSON */
+    UCS_PROFILE_FORMAT_LAST
+} ucs_profile_format_t;
+
+
 /**
  * Profiling location type
  */
@@ -118,6 +128,7 @@ typedef struct ucs_profile_record {
 
 
 extern const char *ucs_profile_mode_names[];
+extern const char *ucs_profile_format_names[];
 
 
 /**
@@ -137,6 +148,13 @@ void ucs_profile_global_cleanup();
  */
 void ucs_profile_dump();
 
+
+/**
+ * Save profiling data of all threads, without stopping or resetting
+ * profiling. May be called while other threads are recording.
+ */
+void ucs_profile_snapshot();
+
 END_C_DECLS
 
 #endif
@@ -41,6 +41,8 @@ enum {
 
 typedef struct ucs_stats_server    *ucs_stats_server_h; /* Handle to server */
 typedef struct ucs_stats_client    *ucs_stats_client_h; /* Handle to client */
+typedef struct ucs_stats_shm       *ucs_stats_shm_h;    /* Handle to shared memory
+                                                           segment */
 
 
 typedef enum ucs_stats_children_sel {
@@ -140,6 +142,80 @@ struct ucs_stats_filter_node {
     uint64_t                  counters_bitmask;   /* which counters to print */
 };
 
+/*
+ * Shared memory statistics segment
+ *
+ * The segment is a file, by default in /dev/shm, which is mapped by the process
+ * and holds the statistics nodes themselves, so the counters are updated in
+ * place and can be sampled by another process at any time. It starts with
+ * ucs_stats_shm_header_t, followed by records of ucs_stats_shm_record_t type.
+ * Class records describe the counter names, and node records hold a
+ * ucs_stats_node_t with its counters. The parent of a node is referenced by
+ * the offset of its record, 0 being the root node of the process.
+ *
+ * The header generation is odd while records are added or removed, and a
+ * reader should retry if it changed while the segment was being copied.
+ * The node part of the record is only valid for a reader built from the same
+ * UCX version, which is checked by the header version and node size fields.
+ */
+#define UCS_STATS_SHM_MAGIC        0x31544154534d4853ul /* "SHMSTAT1" */
+#define UCS_STATS_SHM_VERSION      1
+#define UCS_STATS_SHM_DEFAULT_DIR  "/dev/shm"
+#define UCS_STATS_SHM_FILE_FMT     "%s/ucx_stats.%d"    /* directory, pid */
+#define UCS_STATS_SHM_SIZE         (16 * UCS_MBYTE)
+
+
+enum {
+    UCS_STATS_SHM_RECORD_FREE,
+    UCS_STATS_SHM_RECORD_CLASS,
+    UCS_STATS_SHM_RECORD_NODE
+};
+
+
+typedef struct ucs_stats_shm_header {
+    uint64_t                 magic;
+    uint32_t                 version;
+    uint32_t                 node_size;   /* sizeof(ucs_stats_node_t) */
+    volatile uint64_t        generation;  /* Odd while the layout is changed */
+    volatile uint64_t        used;        /* End of the last record */
+    uint64_t                 records;     /* Offset of the first record */
+    uint64_t                 size;        /* Total segment size */
+    uint64_t                 start_time;  /* Seconds since the Epoch */
+    int32_t                  pid;
+    char                     host[64];
+} ucs_stats_shm_header_t;
+
+
+typedef struct ucs_stats_shm_record {
+    uint32_t                 type;        /* UCS_STATS_SHM_RECORD_xx */
+    uint32_t                 size;        /* Including this header */
+} ucs_stats_shm_record_t;
+
+
+typedef struct ucs_stats_shm_class {
+    ucs_stats_shm_record_t   super;
+    uint32_t                 num_counters;
+    char                     name[UCS_STAT_NAME_MAX + 1];
+    char                     counter_names[0][UCS_STAT_NAME_MAX + 1];
+} ucs_stats_shm_class_t;
+
+
+typedef struct ucs_stats_shm_node {
+    ucs_stats_shm_record_t   super;
+    uint32_t                 parent;      /* Parent node record, 0 - root */
+    uint32_t                 cls;         /* Class record */
+    ucs_stats_node_t         node;        /* Must be last, counters follow */
+} ucs_stats_shm_node_t;
+
+
+#define ucs_stats_shm_for_each_record(_record, _hdr) \
+    for (_record = (ucs_stats_shm_record_t*) \
+                   UCS_PTR_BYTE_OFFSET(_hdr, (_hdr)->records); \
+         (void*)(_record) < UCS_PTR_BYTE_OFFSET(_hdr, (_hdr)->used); \
+         _record = (ucs_stats_shm_record_t*) \
+                   UCS_PTR_BYTE_OFFSET(_record, (_record)->size))
+
+
 /**
  * Initialize statistics node.
  *
@@ -260,4 +336,67 @@ void ucs_stats_server_purge_stats(ucs_stats_server_h server);
 unsigned long ucs_stats_server_rcvd_packets(ucs_stats_server_h server);
 
 
+/**
+ * Create a shared memory statistics segment for the current process.
+ *
+ * @param dir        Directory to create the segment file in.
+ * @param p_shm      Filled with handle to the segment.
+ */
+ucs_status_t ucs_stats_shm_open(const char *dir, ucs_stats_shm_h *p_shm);
+
+
+/**
+ * Remove shared memory statistics segment.
+ */
+void ucs_stats_shm_close(ucs_stats_shm_h shm);
+
+
+/**
+ * Allocate a statistics node in the shared memory segment. The node is not
+ * visible to readers until it is published.
+ *
+ * @param shm        Segment to allocate the node in.
+ * @param cls        Class of the node, defines the number of counters.
+ *
+ * @return The new node, or NULL if the segment is full.
+ */
+ucs_stats_node_t *ucs_stats_shm_node_alloc(ucs_stats_shm_h shm,
+                                           ucs_stats_class_t *cls);
+
+
+/**
+ * Make an initialized node visible to readers of the segment.
+ *
+ * @param shm        Segment which holds the node.
+ * @param node       Node to publish.
+ * @param parent     Parent of the node, or NULL if it's the root node. If the
+ *                   parent is not in the segment, the node is not published.
+ */
+void ucs_stats_shm_node_publish(ucs_stats_shm_h shm, ucs_stats_node_t *node,
+                                ucs_stats_node_t *parent);
+
+
+/**
+ * Release a node allocated by @ref ucs_stats_shm_node_alloc.
+ */
+void ucs_stats_shm_node_free(ucs_stats_shm_h shm, ucs_stats_node_t *node);
+
+
+/**
+ * @return Whether the node was allocated in the segment.
+ */
+int ucs_stats_shm_is_node(ucs_stats_shm_h shm, const ucs_stats_node_t *node);
+
+
+/**
+ * Take a consistent copy of a shared memory statistics segment of another
+ * process. The copy starts with ucs_stats_shm_header_t.
+ *
+ * @param filename   Segment file name.
+ * @param p_hdr      Filled with the copy, which should be released with free().
+ */
+ucs_status_t ucs_stats_shm_snapshot(const char *filename,
+                                    ucs_stats_shm_header_t **p_hdr);
+
+
 #endif /* LIBSTATS_H_ */
@@ -0,0 +1,389 @@
+/**
+* Copyright (C) The ourdemo authors 2026.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "libstats.h"
+
+#include <ucs/arch/bitops.h>
+#include <ucs/arch/cpu.h>
+#include <ucs/datastruct/khash.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/string.h>
+#include <ucs/sys/sys.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+
+
+/* Records are allocated in power-of-2 sizes, to reuse released ones */
+#define UCS_STATS_SHM_MIN_RECORD_SHIFT  6
+#define UCS_STATS_SHM_NUM_BINS          32
+
+
+/* Link of a released record in its size bin */
+typedef struct ucs_stats_shm_free {
+    ucs_stats_shm_record_t   super;
+    uint32_t                 next;
+} ucs_stats_shm_free_t;
+
+
+KHASH_MAP_INIT_STR(ucs_stats_shm_cls, uint32_t)
+
+
+/* Shared memory segment context */
+typedef struct ucs_stats_shm {
+    ucs_stats_shm_header_t   *hdr;
+    char                     filename[PATH_MAX];
+    pthread_mutex_t          lock;
+    uint32_t                 free_list[UCS_STATS_SHM_NUM_BINS];
+    khash_t(ucs_stats_shm_cls) cls;     /* Class name -> class record */
+    int                      full_warned;
+} ucs_stats_shm_t;
+
+
+static inline ucs_stats_shm_node_t *
+ucs_stats_shm_node_record(const ucs_stats_node_t *node)
+{
+    return ucs_container_of(node, ucs_stats_shm_node_t, node);
+}
+
+static inline uint32_t ucs_stats_shm_offset(ucs_stats_shm_t *shm, void *ptr)
+{
+    return UCS_PTR_BYTE_DIFF(shm->hdr, ptr);
+}
+
+static inline void *ucs_stats_shm_ptr(ucs_stats_shm_t *shm, uint32_t offset)
+{
+    return UCS_PTR_BYTE_OFFSET(shm->hdr, offset);
+}
+
+/* Mark the beginning of a layout change for the readers */
+static void ucs_stats_shm_modify_start(ucs_stats_shm_t *shm)
+{
+    ++shm->hdr->generation;
+    ucs_memory_cpu_store_fence();
+}
+
+static void ucs_stats_shm_modify_end(ucs_stats_shm_t *shm)
+{
+    ucs_memory_cpu_store_fence();
+    ++shm->hdr->generation;
+}
+
+ucs_status_t ucs_stats_shm_open(const char *dir, ucs_stats_shm_h *p_shm)
+{
+    ucs_stats_shm_t *shm;
+    ucs_status_t status;
+    void *ptr;
+    int fd, ret;
+
+    shm = ucs_calloc(1, sizeof(*shm), "stats_shm");
+    if (shm == NULL) {
+        ucs_error("failed to allocate statistics shared memory context");
+        status = UCS_ERR_NO_MEMORY;
+        goto err;
+    }
+
+    ucs_snprintf_zero(shm->filename, sizeof(shm->filename),
+                      UCS_STATS_SHM_FILE_FMT, dir, getpid());
+
+    /* The path is predictable, so never reuse or follow whatever is there: a
+     * file left by a previous process with the same pid is removed, and the
+     * new one is created exclusively and readable only by our user.
+     */
+    if ((unlink(shm->filename) < 0) && (errno != ENOENT)) {
+        ucs_debug("failed to remove stale statistics file '%s': %m",
+                  shm->filename);
+    }
+
+    fd = open(shm->filename,
+              O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        ucs_error("failed to create statistics file '%s': %m", shm->filename);
+        status = UCS_ERR_IO_ERROR;
+        goto err_free;
+    }
+
+    /* The file is sparse, so only the pages of existing records take memory */
+    ret = ftruncate(fd, UCS_STATS_SHM_SIZE);
+    if (ret < 0) {
+        ucs_error("failed to resize statistics file '%s': %m", shm->filename);
+        status = UCS_ERR_IO_ERROR;
+        goto err_close;
+    }
+
+    ptr = mmap(NULL, UCS_STATS_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+               fd, 0);
+    if (ptr == MAP_FAILED) {
+        ucs_error("failed to map statistics file '%s': %m", shm->filename);
+        status = UCS_ERR_IO_ERROR;
+        goto err_close;
+    }
+
+    close(fd);
+
+    shm->hdr             = ptr;
+    shm->hdr->version    = UCS_STATS_SHM_VERSION;
+    shm->hdr->node_size  = sizeof(ucs_stats_node_t);
+    shm->hdr->generation = 0;
+    shm->hdr->records    = ucs_align_up_pow2(sizeof(*shm->hdr),
+                                             UCS_SYS_CACHE_LINE_SIZE);
+    shm->hdr->used       = shm->hdr->records;
+    shm->hdr->size       = UCS_STATS_SHM_SIZE;
+    shm->hdr->start_time = time(NULL);
+    shm->hdr->pid        = getpid();
+    ucs_strncpy_zero(shm->hdr->host, ucs_get_host_name(),
+                     sizeof(shm->hdr->host));
+    ucs_memory_cpu_store_fence();
+    shm->hdr->magic      = UCS_STATS_SHM_MAGIC;
+
+    pthread_mutex_init(&shm->lock, NULL);
+    kh_init_inplace(ucs_stats_shm_cls, &shm->cls);
+
+    ucs_debug("statistics are exported to '%s'", shm->filename);
+    *p_shm = shm;
+    return UCS_OK;
+
+err_close:
+    close(fd);
+    unlink(shm->filename);
+err_free:
+    ucs_free(shm);
+err:
+    return status;
+}
+
+void ucs_stats_shm_close(ucs_stats_shm_h shm)
+{
+    /* Readers which already opened the file would see it has no nodes */
+    ucs_stats_shm_modify_start(shm);
+    shm->hdr->used = shm->hdr->records;
+    ucs_stats_shm_modify_end(shm);
+
+    unlink(shm->filename);
+    munmap(shm->hdr, UCS_STATS_SHM_SIZE);
+    kh_destroy_inplace(ucs_stats_shm_cls, &shm->cls);
+    pthread_mutex_destroy(&shm->lock);
+    ucs_free(shm);
+}
+
+/* Called with the lock held */
+static void *ucs_stats_shm_record_alloc(ucs_stats_shm_t *shm, size_t size)
+{
+    ucs_stats_shm_free_t *record;
+    unsigned bin;
+
+    bin  = ucs_max(ucs_ilog2(size - 1) + 1, UCS_STATS_SHM_MIN_RECORD_SHIFT);
+    size = UCS_BIT(bin);
+
+    if (shm->free_list[bin] != 0) {
+        record = ucs_stats_shm_ptr(shm, shm->free_list[bin]);
+        ucs_assert(record->super.type == UCS_STATS_SHM_RECORD_FREE);
+        ucs_assert(record->super.size == size);
+        shm->free_list[bin] = record->next;
+        return record;
+    }
+
+    if (shm->hdr->used + size > shm->hdr->size) {
+        if (!shm->full_warned) {
+            ucs_warn("statistics file '%s' is full, new nodes are not exported",
+                     shm->filename);
+            shm->full_warned = 1;
+        }
+        return NULL;
+    }
+
+    /* A free record is ignored by the readers until it's published */
+    record             = ucs_stats_shm_ptr(shm, shm->hdr->used);
+    record->super.type = UCS_STATS_SHM_RECORD_FREE;
+    record->super.size = size;
+    ucs_memory_cpu_store_fence();
+    shm->hdr->used    += size;
+    return record;
+}
+
+/* Called with the lock held */
+static void ucs_stats_shm_record_free(ucs_stats_shm_t *shm,
+                                      ucs_stats_shm_record_t *record)
+{
+    ucs_stats_shm_free_t *free_record = (ucs_stats_shm_free_t*)record;
+    unsigned bin                      = ucs_ilog2(record->size);
+
+    free_record->super.type = UCS_STATS_SHM_RECORD_FREE;
+    free_record->next       = shm->free_list[bin];
+    shm->free_list[bin]     = ucs_stats_shm_offset(shm, record);
+}
+
+/* Called with the lock held, while the layout is being modified */
+static uint32_t ucs_stats_shm_get_class(ucs_stats_shm_t *shm,
+                                        ucs_stats_class_t *cls)
+{
+    ucs_stats_shm_class_t *shm_cls;
+    khiter_t iter;
+    unsigned i;
+    int ret;
+
+    iter = kh_get(ucs_stats_shm_cls, &shm->cls, cls->name);
+    if (iter != kh_end(&shm->cls)) {
+        return kh_val(&shm->cls, iter);
+    }
+
+    shm_cls = ucs_stats_shm_record_alloc(shm, sizeof(*shm_cls) +
+                                         (cls->num_counters *
+                                          sizeof(shm_cls->counter_names[0])));
+    if (shm_cls == NULL) {
+        return 0;
+    }
+
+    shm_cls->num_counters = cls->num_counters;
+    ucs_strncpy_zero(shm_cls->name, cls->name, sizeof(shm_cls->name));
+    for (i = 0; i < cls->num_counters; ++i) {
+        ucs_strncpy_zero(shm_cls->counter_names[i], cls->counter_names[i],
+                         sizeof(shm_cls->counter_names[i]));
+    }
+    shm_cls->super.type = UCS_STATS_SHM_RECORD_CLASS;
+
+    /* The key is the class name in the segment, which is never released */
+    iter = kh_put(ucs_stats_shm_cls, &shm->cls, shm_cls->name, &ret);
+    ucs_assert_always(ret != 0);
+    kh_val(&shm->cls, iter) = ucs_stats_shm_offset(shm, shm_cls);
+    return kh_val(&shm->cls, iter);
+}
+
+ucs_stats_node_t *ucs_stats_shm_node_alloc(ucs_stats_shm_h shm,
+                                           ucs_stats_class_t *cls)
+{
+    ucs_stats_shm_node_t *shm_node;
+
+    pthread_mutex_lock(&shm->lock);
+    shm_node = ucs_stats_shm_record_alloc(shm, sizeof(*shm_node) +
+                                          (sizeof(ucs_stats_counter_t) *
+                                           cls->num_counters));
+    pthread_mutex_unlock(&shm->lock);
+
+    return (shm_node != NULL) ? &shm_node->node : NULL;
+}
+
+void ucs_stats_shm_node_publish(ucs_stats_shm_h shm, ucs_stats_node_t *node,
+                                ucs_stats_node_t *parent)
+{
+    ucs_stats_shm_node_t *shm_node = ucs_stats_shm_node_record(node);
+
+    if ((parent != NULL) && !ucs_stats_shm_is_node(shm, parent)) {
+        return;
+    }
+
+    pthread_mutex_lock(&shm->lock);
+    ucs_stats_shm_modify_start(shm);
+
+    shm_node->cls = ucs_stats_shm_get_class(shm, node->cls);
+    if (shm_node->cls != 0) {
+        shm_node->parent     = (parent == NULL) ? 0 :
+                               ucs_stats_shm_offset(shm,
+                                                    ucs_stats_shm_node_record(parent));
+        shm_node->super.type = UCS_STATS_SHM_RECORD_NODE;
+    }
+
+    ucs_stats_shm_modify_end(shm);
+    pthread_mutex_unlock(&shm->lock);
+}
+
+void ucs_stats_shm_node_free(ucs_stats_shm_h shm, ucs_stats_node_t *node)
+{
+    ucs_stats_shm_node_t *shm_node = ucs_stats_shm_node_record(node);
+
+    pthread_mutex_lock(&shm->lock);
+    ucs_stats_shm_modify_start(shm);
+    ucs_stats_shm_record_free(shm, &shm_node->super);
+    ucs_stats_shm_modify_end(shm);
+    pthread_mutex_unlock(&shm->lock);
+}
+
+int ucs_stats_shm_is_node(ucs_stats_shm_h shm, const ucs_stats_node_t *node)
+{
+    return ((void*)node > (void*)shm->hdr) &&
+           ((void*)node < UCS_PTR_BYTE_OFFSET(shm->hdr, shm->hdr->size));
+}
+
+ucs_status_t ucs_stats_shm_snapshot(const char *filename,
+                                    ucs_stats_shm_header_t **p_hdr)
+{
+    const ucs_stats_shm_header_t *hdr;
+    ucs_stats_shm_header_t *copy;
+    uint64_t generation, used;
+    ucs_status_t status;
+    struct stat st;
+    int fd;
+
+    fd = open(filename, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        ucs_error("failed to open statistics file '%s': %m", filename);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    if ((fstat(fd, &st) < 0) || (st.st_size < sizeof(*hdr))) {
+        ucs_error("'%s' is not a statistics file", filename);
+        status = UCS_ERR_INVALID_PARAM;
+        goto out_close;
+    }
+
+    hdr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (hdr == MAP_FAILED) {
+        ucs_error("failed to map statistics file '%s': %m", filename);
+        status = UCS_ERR_IO_ERROR;
+        goto out_close;
+    }
+
+    if ((hdr->magic != UCS_STATS_SHM_MAGIC) ||
+        (hdr->version != UCS_STATS_SHM_VERSION) ||
+        (hdr->node_size != sizeof(ucs_stats_node_t)) ||
+        (hdr->size != st.st_size) || (hdr->records < sizeof(*hdr))) {
+        ucs_error("'%s' is not a statistics file of this UCX version", filename);
+        status = UCS_ERR_UNSUPPORTED;
+        goto out_unmap;
+    }
+
+    copy = malloc(hdr->size);
+    if (copy == NULL) {
+        ucs_error("failed to allocate statistics snapshot");
+        status = UCS_ERR_NO_MEMORY;
+        goto out_unmap;
+    }
+
+    /* Retry until the records were not changed during the copy */
+    for (;;) {
+        generation = hdr->generation;
+        if (!(generation & 1)) {
+            ucs_memory_cpu_load_fence();
+            used = ucs_min(hdr->used, hdr->size);
+            memcpy(copy, hdr, used);
+            ucs_memory_cpu_load_fence();
+            if (generation == hdr->generation) {
+                break;
+            }
+        }
+        sched_yield();
+    }
+
+    copy->used = used;
+    *p_hdr     = copy;
+    status     = UCS_OK;
+
+out_unmap:
+    munmap((void*)hdr, st.st_size);
+out_close:
+    close(fd);
+    return status;
+}
@@ -41,6 +41,7 @@ enum {
     UCS_STATS_FLAG_STREAM         = UCS_BIT(9),
     UCS_STATS_FLAG_STREAM_CLOSE   = UCS_BIT(10),
     UCS_STATS_FLAG_STREAM_BINARY  = UCS_BIT(11),
+    UCS_STATS_FLAG_SHM            = UCS_BIT(12),
 };
 
 enum {
@@ -61,6 +62,7 @@ typedef struct {
     union {
         FILE             *stream;         /* Output stream */
         ucs_stats_client_h client;       /* UDP client */
+        ucs_stats_shm_h  shm;            /* Shared memory segment */
     };
 
     union {
@@ -195,6 +197,16 @@ static ucs_stats_class_t *ucs_stats_get_class(ucs_stats_class_t *cls)
     return dup;
 }
 
+static void ucs_stats_node_release(ucs_stats_node_t *node)
+{
+    if ((ucs_stats_context.flags & UCS_STATS_FLAG_SHM) &&
+        ucs_stats_shm_is_node(ucs_stats_context.shm, node)) {
+        ucs_stats_shm_node_free(ucs_stats_context.shm, node);
+    } else {
+        ucs_free(node);
+    }
+}
+
 static void ucs_stats_node_remove(ucs_stats_node_t *node, int make_inactive)
 {
     ucs_assert(node != &ucs_stats_context.root_node);
@@ -226,7 +238,7 @@ static void ucs_stats_node_remove(ucs_stats_node_t *node, int make_inactive)
         if (!node->filter_node->type_list_len) {
             ucs_free(node->filter_node);
         }
-        ucs_free(node);
+        ucs_stats_node_release(node);
     }
 }   
 
@@ -267,6 +279,15 @@ static ucs_status_t ucs_stats_node_new(ucs_stats_class_t *cls, ucs_stats_node_t
 {
     ucs_stats_node_t *node;
 
+    /* If the shared memory segment is full, the node is not exported */
+    if (ucs_stats_context.flags & UCS_STATS_FLAG_SHM) {
+        node = ucs_stats_shm_node_alloc(ucs_stats_context.shm, cls);
+        if (node != NULL) {
+            *p_node = node;
+            return UCS_OK;
+        }
+    }
+
     node = ucs_malloc(sizeof(ucs_stats_node_t) +
                       sizeof(ucs_stats_counter_t) *
                       (cls->num_counters > 0 ? cls->num_counters - 1 : 0),
@@ -384,6 +405,12 @@ static ucs_status_t ucs_stats_node_add(ucs_stats_node_t *node,
     node->parent = parent;
     ucs_stats_add_to_filter(node, filter_node);
 
+    if (ucs_stats_context.flags & UCS_STATS_FLAG_SHM) {
+        ucs_stats_shm_node_publish(ucs_stats_context.shm, node,
+                                   (parent == &ucs_stats_context.root_node) ?
+                                   NULL : parent);
+    }
+
     pthread_mutex_unlock(&ucs_stats_context.lock);
 
     return UCS_OK;
@@ -412,13 +439,13 @@ ucs_status_t ucs_stats_node_alloc(ucs_stats_node_t** p_node, ucs_stats_class_t *
     va_end(ap);
 
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         return status;
     }
 
     status = ucs_stats_filter_node_new(node->cls, &filter_node);
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         return status;
     }
 
@@ -426,7 +453,7 @@ ucs_status_t ucs_stats_node_alloc(ucs_stats_node_t** p_node, ucs_stats_class_t *
 
     status = ucs_stats_node_add(node, parent, filter_node);
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         ucs_free(filter_node);
         return status;
     }
@@ -569,6 +596,17 @@ static void ucs_stats_open_dest()
         }
 
         ucs_stats_context.flags |= UCS_STATS_FLAG_SOCKET;
+    } else if (!strcmp(ucs_global_opts.stats_dest, "shm") ||
+               !strncmp(ucs_global_opts.stats_dest, "shm:", 4)) {
+        status = ucs_stats_shm_open((ucs_global_opts.stats_dest[3] == ':') ?
+                                    &ucs_global_opts.stats_dest[4] :
+                                    UCS_STATS_SHM_DEFAULT_DIR,
+                                    &ucs_stats_context.shm);
+        if (status != UCS_OK) {
+            goto out_free;
+        }
+
+        ucs_stats_context.flags |= UCS_STATS_FLAG_SHM;
     } else if (strcmp(ucs_global_opts.stats_dest, "") != 0) {
         status = ucs_open_output_stream(ucs_global_opts.stats_dest,
                                         UCS_LOG_LEVEL_ERROR,
@@ -600,6 +638,10 @@ static void ucs_stats_close_dest()
         ucs_stats_context.flags &= ~UCS_STATS_FLAG_SOCKET;
         ucs_stats_client_cleanup(ucs_stats_context.client);
     }
+    if (ucs_stats_context.flags & UCS_STATS_FLAG_SHM) {
+        ucs_stats_context.flags &= ~UCS_STATS_FLAG_SHM;
+        ucs_stats_shm_close(ucs_stats_context.shm);
+    }
     if (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM) {
         fflush(ucs_stats_context.stream);
         if (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_CLOSE) {
@@ -708,14 +750,18 @@ void ucs_stats_init()
 
     UCS_STATS_START_TIME(ucs_stats_context.start_time);
     ucs_stats_node_init_root("%s:%d", ucs_get_host_name(), getpid());
-    ucs_stats_set_trigger();
+    if (!(ucs_stats_context.flags & UCS_STATS_FLAG_SHM)) {
+        /* Shared memory is read by another process, nothing to dump */
+        ucs_stats_set_trigger();
+    }
     kh_init_inplace(ucs_stats_cls, &ucs_stats_context.cls);
 
-    ucs_debug("statistics enabled, flags: %c%c%c%c%c%c%c",
+    ucs_debug("statistics enabled, flags: %c%c%c%c%c%c%c%c",
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_TIMER)      ? 't' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_EXIT)       ? 'e' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_SIGNAL)     ? 's' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_SOCKET)        ? 'u' : '-',
+              (ucs_stats_context.flags & UCS_STATS_FLAG_SHM)           ? 'm' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM)        ? 'f' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_BINARY) ? 'b' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_CLOSE)  ? 'c' : '-');
@@ -750,7 +796,8 @@ void ucs_stats_dump()
 
 int ucs_stats_is_active()
 {
-    return ucs_stats_context.flags & (UCS_STATS_FLAG_SOCKET|UCS_STATS_FLAG_STREAM);
+    return ucs_stats_context.flags & (UCS_STATS_FLAG_SOCKET|UCS_STATS_FLAG_STREAM|
+                                      UCS_STATS_FLAG_SHM);
 }
 
 ucs_stats_node_t * ucs_stats_get_root() {
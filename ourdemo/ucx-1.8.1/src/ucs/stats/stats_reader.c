@@ -0,0 +1,216 @@
+/**
+* Copyright (C) The ourdemo authors 2026.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include "stats.h"
+
+#include <ucs/sys/string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+
+/*
+ * Print statistics exported to shared memory (UCX_STATS_DEST=shm) by running
+ * processes.
+ * Usage: ucs_stats_reader [ -i <interval> ] [ -n <count> ] <pid|file> ...
+ */
+
+typedef struct {
+    ucs_stats_shm_header_t *hdr;
+    ucs_stats_shm_node_t   **nodes;      /* Node records, by offset */
+    unsigned               *first_child; /* Index + 1, 0 - none */
+    unsigned               *next;        /* Next sibling index + 1, 0 - none */
+    unsigned               num_nodes;
+} stats_tree_t;
+
+
+static int node_offset_cmp(const void *key, const void *elem)
+{
+    uintptr_t offset = (uintptr_t)key;
+    uintptr_t other  = (uintptr_t)*(ucs_stats_shm_node_t* const*)elem;
+
+    return (offset > other) - (offset < other);
+}
+
+static void print_node(const stats_tree_t *tree, unsigned index,
+                       unsigned indent)
+{
+    const ucs_stats_shm_node_t *shm_node = tree->nodes[index];
+    const ucs_stats_shm_class_t *cls;
+    unsigned i, child;
+
+    cls = UCS_PTR_BYTE_OFFSET(tree->hdr, shm_node->cls);
+    printf("%*s%s%s:\n", indent * 2, "", cls->name, shm_node->node.name);
+    for (i = 0; i < cls->num_counters; ++i) {
+        printf("%*s%s: %"PRIu64"\n", (indent + 1) * 2, "",
+               cls->counter_names[i], shm_node->node.counters[i]);
+    }
+
+    for (child = tree->first_child[index]; child != 0;
+         child = tree->next[child - 1]) {
+        print_node(tree, child - 1, indent + 1);
+    }
+}
+
+static ucs_status_t print_file(const char *filename)
+{
+    ucs_stats_shm_record_t *record;
+    ucs_stats_shm_node_t **parent;
+    unsigned i, *last_child, root_children;
+    stats_tree_t tree;
+    ucs_status_t status;
+
+    status = ucs_stats_shm_snapshot(filename, &tree.hdr);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    tree.num_nodes = 0;
+    ucs_stats_shm_for_each_record(record, tree.hdr) {
+        tree.num_nodes += (record->type == UCS_STATS_SHM_RECORD_NODE);
+    }
+
+    tree.nodes       = calloc(tree.num_nodes + 1, sizeof(*tree.nodes));
+    tree.first_child = calloc(tree.num_nodes + 1, sizeof(*tree.first_child));
+    tree.next        = calloc(tree.num_nodes + 1, sizeof(*tree.next));
+    last_child       = calloc(tree.num_nodes + 1, sizeof(*last_child));
+    if ((tree.nodes == NULL) || (tree.first_child == NULL) ||
+        (tree.next == NULL) || (last_child == NULL)) {
+        fprintf(stderr, "Failed to allocate statistics tree\n");
+        status = UCS_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    /* Records are walked by increasing offset, so the array is sorted */
+    i = 0;
+    ucs_stats_shm_for_each_record(record, tree.hdr) {
+        if (record->type == UCS_STATS_SHM_RECORD_NODE) {
+            tree.nodes[i++] = (ucs_stats_shm_node_t*)record;
+        }
+    }
+
+    /* Link every node to its parent, keeping the creation order */
+    root_children = 0;
+    for (i = 0; i < tree.num_nodes; ++i) {
+        parent = NULL;
+        if (tree.nodes[i]->parent != 0) {
+            parent = bsearch((void*)(uintptr_t)
+                             UCS_PTR_BYTE_OFFSET(tree.hdr,
+                                                 tree.nodes[i]->parent),
+                             tree.nodes, tree.num_nodes, sizeof(*tree.nodes),
+                             node_offset_cmp);
+            if (parent == NULL) {
+                continue; /* Parent was released while the child remains */
+            }
+        }
+
+        if (parent == NULL) {
+            if (root_children == 0) {
+                root_children = i + 1;
+            } else {
+                tree.next[last_child[tree.num_nodes] - 1] = i + 1;
+            }
+            last_child[tree.num_nodes] = i + 1;
+        } else if (tree.first_child[parent - tree.nodes] == 0) {
+            tree.first_child[parent - tree.nodes] = i + 1;
+            last_child[parent - tree.nodes]       = i + 1;
+        } else {
+            tree.next[last_child[parent - tree.nodes] - 1] = i + 1;
+            last_child[parent - tree.nodes]                = i + 1;
+        }
+    }
+
+    printf("%s:%d:\n", tree.hdr->host, tree.hdr->pid);
+    for (i = root_children; i != 0; i = tree.next[i - 1]) {
+        print_node(&tree, i - 1, 1);
+    }
+    status = UCS_OK;
+
+out:
+    free(last_child);
+    free(tree.next);
+    free(tree.first_child);
+    free(tree.nodes);
+    free(tree.hdr);
+    return status;
+}
+
+static void usage()
+{
+    printf("Usage: ucs_stats_reader [ options ] <pid|file> ...\n");
+    printf("Print statistics of processes running with UCX_STATS_DEST=shm\n");
+    printf("  -i <interval>  Print every <interval> seconds\n");
+    printf("  -n <count>     Number of times to print, 0 - unlimited\n");
+    printf("                 (1, or unlimited if an interval is set)\n");
+    printf("  -d <dir>       Directory of the statistics files (%s)\n",
+           UCS_STATS_SHM_DEFAULT_DIR);
+    printf("  -h             Show this help message\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir   = UCS_STATS_SHM_DEFAULT_DIR;
+    double interval   = 0;
+    long num          = -1;
+    long iter;
+    char filename[PATH_MAX];
+    char *endptr;
+    long pid;
+    int c, i;
+
+    while ((c = getopt(argc, argv, "i:n:d:h")) != -1) {
+        switch (c) {
+        case 'i':
+            interval = atof(optarg);
+            break;
+        case 'n':
+            num = strtol(optarg, NULL, 0);
+            break;
+        case 'd':
+            dir = optarg;
+            break;
+        case 'h':
+        default:
+            usage();
+            return (c == 'h') ? 0 : -1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage();
+        return -1;
+    }
+
+    if (num < 0) {
+        num = (interval > 0) ? 0 : 1;
+    }
+
+    for (iter = 0; (num == 0) || (iter < num); ++iter) {
+        if (iter > 0) {
+            usleep(interval * 1e6);
+            printf("\n");
+        }
+
+        for (i = optind; i < argc; ++i) {
+            pid = strtol(argv[i], &endptr, 10);
+            if (*endptr == '\0') {
+                ucs_snprintf_zero(filename, sizeof(filename),
+                                  UCS_STATS_SHM_FILE_FMT, dir, (int)pid);
+            } else {
+                ucs_strncpy_zero(filename, argv[i], sizeof(filename));
+            }
+
+            if (print_file(filename) != UCS_OK) {
+                return -1;
+            }
+        }
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -15,20 +15,37 @@
 #include <ucs/debug/assert.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/compiler.h>
+#include <ucs/arch/cpu.h>
+#include <ucs/time/time.h>
 
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/epoll.h>
 
+#if HAVE_LINUX_IO_URING_H
+#  include <linux/io_uring.h>
+#  include <sys/syscall.h>
+#  include <sys/mman.h>
+#  include <poll.h>
+#  if defined(__NR_io_uring_setup) && defined(IORING_FEAT_NODROP)
+#    define UCS_EVENT_SET_HAVE_URING 1
+#  endif
+#endif
+
+#ifndef UCS_EVENT_SET_HAVE_URING
+#  define UCS_EVENT_SET_HAVE_URING 0
+#endif
+
 
 enum {
     UCS_SYS_EVENT_SET_EXTERNAL_EVENT_FD = UCS_BIT(0),
 };
 
 struct ucs_sys_event_set {
-    int      event_fd;
-    unsigned flags;
+    int                        event_fd; /* epoll or io_uring fd */
+    unsigned                   flags;
+    struct ucs_event_set_uring *uring;   /* io_uring state, NULL for epoll */
 };
 
 const unsigned ucs_sys_event_set_max_wait_events =
@@ -85,6 +102,7 @@ static ucs_sys_event_set_t *ucs_event_set_alloc(int event_fd, unsigned flags)
 
     event_set->flags    = flags;
     event_set->event_fd = event_fd;
+    event_set->uring    = NULL;
     return event_set;
 }
 
@@ -125,12 +143,826 @@ err_close_event_fd:
     return status;
 }
 
+#if UCS_EVENT_SET_HAVE_URING
+
+/* File descriptor is added to io_uring event set */
+#define UCS_EVENT_SET_URING_FD_ADDED    UCS_BIT(0)
+/* Poll request of the file descriptor is posted and not completed yet */
+#define UCS_EVENT_SET_URING_FD_ARMED    UCS_BIT(1)
+
+/* user_data of requests which completions are not interesting */
+#define UCS_EVENT_SET_URING_IGNORE      UINT64_MAX
+
+/* How long the SQ polling kernel thread spins before going to sleep */
+#define UCS_EVENT_SET_URING_SQ_IDLE_MS  1000
+
+/* How many times io_uring_enter() is retried when the kernel can't take
+ * new submissions, before leaving them for the next wait */
+#define UCS_EVENT_SET_URING_SUBMIT_RETRIES 16
+
+
+typedef struct ucs_event_set_uring_fd {
+    void                  *callback_data;
+    uint32_t              gen;      /* Generation of the poll request, used to
+                                     * drop completions of removed requests */
+    uint8_t               events;   /* Requested ucs_event_set_type_t events */
+    uint8_t               flags;    /* UCS_EVENT_SET_URING_FD_xx */
+} ucs_event_set_uring_fd_t;
+
+
+/* Completion moved out of the CQ ring before it could be handled */
+typedef struct ucs_event_set_uring_cqe {
+    uint64_t              user_data;
+    int                   res;
+} ucs_event_set_uring_cqe_t;
+
+
+struct ucs_event_set_uring {
+    unsigned              setup_flags;
+    /* Submission queue */
+    unsigned              *sq_head;
+    unsigned              *sq_tail;
+    unsigned              *sq_flags;
+    unsigned              sq_mask;
+    unsigned              sq_entries;
+    unsigned              sq_prepared;  /* Tail of SQEs prepared by us */
+    unsigned              sq_published; /* Tail of SQEs accepted by the kernel,
+                                         * or visible to it with SQPOLL */
+    struct io_uring_sqe   *sqes;
+    /* Completion queue */
+    unsigned              *cq_head;
+    unsigned              *cq_tail;
+    unsigned              cq_mask;
+    struct io_uring_cqe   *cqes;
+    /* Mapped rings */
+    void                  *sq_ring;
+    size_t                sq_ring_size;
+    void                  *cq_ring;
+    size_t                cq_ring_size;
+    size_t                sqes_size;
+    /* Poll requests, indexed by file descriptor */
+    ucs_event_set_uring_fd_t *fds;
+    int                   fds_count;
+    /* Some added fds could not get an SQE for their poll request */
+    int                   arm_pending;
+    /* Completions reaped to let the kernel take new submissions */
+    ucs_event_set_uring_cqe_t *backlog;
+    unsigned              backlog_count;
+    unsigned              backlog_size;
+};
+
+
+static int ucs_event_set_uring_enter(int ring_fd, unsigned to_submit,
+                                     unsigned min_complete, unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                   flags, NULL, 0);
+}
+
+/* Move the completions out of the CQ ring, and the overflowed ones into it,
+ * so that the kernel accepts new submissions. They are handled by the next
+ * wait. */
+static ucs_status_t ucs_event_set_uring_reap(ucs_sys_event_set_t *event_set)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    ucs_event_set_uring_cqe_t *backlog;
+    struct io_uring_cqe *cqe;
+    unsigned head, size;
+
+    do {
+        head = *uring->cq_head;
+        while (head != *(volatile unsigned*)uring->cq_tail) {
+            if (uring->backlog_count == uring->backlog_size) {
+                size    = ucs_max(uring->backlog_size * 2, uring->cq_mask + 1);
+                backlog = ucs_realloc(uring->backlog, sizeof(*backlog) * size,
+                                      "event_set_uring_backlog");
+                if (backlog == NULL) {
+                    ucs_error("unable to allocate memory for %u io_uring "
+                              "completions", size);
+                    return UCS_ERR_NO_MEMORY;
+                }
+
+                uring->backlog      = backlog;
+                uring->backlog_size = size;
+            }
+
+            ucs_memory_cpu_load_fence();
+            cqe = &uring->cqes[head & uring->cq_mask];
+            uring->backlog[uring->backlog_count].user_data = cqe->user_data;
+            uring->backlog[uring->backlog_count].res       = cqe->res;
+            ++uring->backlog_count;
+            ++head;
+        }
+
+        ucs_memory_cpu_fence();
+        *(volatile unsigned*)uring->cq_head = head;
+
+        if (!(*(volatile unsigned*)uring->sq_flags & IORING_SQ_CQ_OVERFLOW)) {
+            break;
+        }
+
+        ucs_event_set_uring_enter(event_set->event_fd, 0, 0,
+                                  IORING_ENTER_GETEVENTS);
+    } while (head != *(volatile unsigned*)uring->cq_tail);
+
+    return UCS_OK;
+}
+
+/**
+ * Pass the prepared SQEs to the kernel.
+ *
+ * @return UCS_OK if all of them were accepted, UCS_ERR_NO_RESOURCE if the
+ *         kernel can't take some of them now. Those are kept and submitted
+ *         again by the next call.
+ */
+static ucs_status_t ucs_event_set_uring_submit(ucs_sys_event_set_t *event_set)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    unsigned retries                  = UCS_EVENT_SET_URING_SUBMIT_RETRIES;
+    unsigned to_submit;
+    ucs_status_t status;
+    int ret;
+
+    if (uring->sq_prepared == uring->sq_published) {
+        return UCS_OK;
+    }
+
+    /* Make the SQEs visible before the tail */
+    ucs_memory_cpu_store_fence();
+    *(volatile unsigned*)uring->sq_tail = uring->sq_prepared;
+
+    if (uring->setup_flags & IORING_SETUP_SQPOLL) {
+        /* The kernel thread picks up everything up to the tail */
+        uring->sq_published = uring->sq_prepared;
+
+        /* The tail store must be ordered with the flags load, otherwise
+         * the kernel thread may go to sleep and miss the new SQEs */
+        __sync_synchronize();
+        if (!(*(volatile unsigned*)uring->sq_flags & IORING_SQ_NEED_WAKEUP)) {
+            return UCS_OK;
+        }
+
+        ret = ucs_event_set_uring_enter(event_set->event_fd, 0, 0,
+                                        IORING_ENTER_SQ_WAKEUP);
+        if ((ret < 0) && (errno != EINTR) && (errno != EAGAIN) &&
+            (errno != EBUSY)) {
+            ucs_error("io_uring_enter(ring_fd=%d, SQ_WAKEUP) failed: %m",
+                      event_set->event_fd);
+            return UCS_ERR_IO_ERROR;
+        }
+
+        return UCS_OK;
+    }
+
+    /* Only the SQEs the kernel consumed are accounted as submitted, the
+     * rest stays between its head and our tail */
+    while (uring->sq_prepared != uring->sq_published) {
+        to_submit = uring->sq_prepared - uring->sq_published;
+        ret       = ucs_event_set_uring_enter(event_set->event_fd, to_submit,
+                                              0, 0);
+        if (ret > 0) {
+            uring->sq_published += ret;
+            continue;
+        }
+
+        if ((ret == 0) || (errno == EAGAIN) || (errno == EBUSY)) {
+            /* No room for the completions, or for kernel allocations */
+            if (--retries == 0) {
+                ucs_debug("io_uring_enter(ring_fd=%d, to_submit=%u): %u "
+                          "SQEs are left for the next attempt",
+                          event_set->event_fd, to_submit, to_submit);
+                return UCS_ERR_NO_RESOURCE;
+            }
+
+            status = ucs_event_set_uring_reap(event_set);
+            if (status != UCS_OK) {
+                return status;
+            }
+        } else if (errno != EINTR) {
+            ucs_error("io_uring_enter(ring_fd=%d, to_submit=%u) failed: %m",
+                      event_set->event_fd, to_submit);
+            return UCS_ERR_IO_ERROR;
+        }
+    }
+
+    return UCS_OK;
+}
+
+/**
+ * @return An SQE to fill, or NULL with the status set if the SQ is full and
+ *         the kernel can't free up space in it now.
+ */
+static struct io_uring_sqe *
+ucs_event_set_uring_get_sqe(ucs_sys_event_set_t *event_set,
+                            ucs_status_t *status_p)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    unsigned retries                  = UCS_EVENT_SET_URING_SUBMIT_RETRIES;
+    struct io_uring_sqe *sqe;
+    ucs_status_t status;
+
+    while ((uring->sq_prepared - *(volatile unsigned*)uring->sq_head) >=
+           uring->sq_entries) {
+        /* Without SQPOLL the head moves when the kernel accepts SQEs */
+        status = ucs_event_set_uring_submit(event_set);
+        if (status != UCS_OK) {
+            *status_p = status;
+            return NULL;
+        }
+
+        if (!(uring->setup_flags & IORING_SETUP_SQPOLL)) {
+            continue;
+        }
+
+        /* The kernel thread does not consume SQEs while the CQ ring is
+         * overflown, so make room in it and wait for the thread */
+        if (--retries == 0) {
+            *status_p = UCS_ERR_NO_RESOURCE;
+            return NULL;
+        }
+
+        status = ucs_event_set_uring_reap(event_set);
+        if (status != UCS_OK) {
+            *status_p = status;
+            return NULL;
+        }
+
+#ifdef IORING_ENTER_SQ_WAIT
+        ucs_event_set_uring_enter(event_set->event_fd, 0, 0,
+                                  IORING_ENTER_SQ_WAIT);
+#else
+        sched_yield();
+#endif
+        ucs_memory_cpu_load_fence();
+    }
+
+    sqe = &uring->sqes[uring->sq_prepared & uring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ++uring->sq_prepared;
+    return sqe;
+}
+
+static inline uint64_t ucs_event_set_uring_user_data(int fd, uint32_t gen)
+{
+    return ((uint64_t)gen << 32) | (uint32_t)fd;
+}
+
+static ucs_status_t
+ucs_event_set_uring_arm(ucs_sys_event_set_t *event_set, int fd)
+{
+    ucs_event_set_uring_fd_t *uring_fd = &event_set->uring->fds[fd];
+    struct io_uring_sqe *sqe;
+    uint32_t poll_mask;
+    ucs_status_t status;
+
+    sqe = ucs_event_set_uring_get_sqe(event_set, &status);
+    if (sqe == NULL) {
+        if (status == UCS_ERR_NO_RESOURCE) {
+            /* The fd stays unarmed, the next wait posts its poll request */
+            event_set->uring->arm_pending = 1;
+            return UCS_OK;
+        }
+        return status;
+    }
+
+    /* poll(2) and epoll(7) share the values of the event bits */
+    poll_mask = ucs_event_set_map_to_raw_events(uring_fd->events);
+#if __BYTE_ORDER == __BIG_ENDIAN
+    poll_mask = (poll_mask << 16) | (poll_mask >> 16);
+#endif
+
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = fd;
+#ifdef IORING_FEAT_POLL_32BITS
+    sqe->poll32_events = poll_mask;
+#else
+    sqe->poll_events   = poll_mask;
+#endif
+    sqe->user_data     = ucs_event_set_uring_user_data(fd, uring_fd->gen);
+    uring_fd->flags   |= UCS_EVENT_SET_URING_FD_ARMED;
+    return UCS_OK;
+}
+
+/* Cancel the in-flight poll request of the file descriptor, its completion
+ * is dropped since the generation is changed */
+static ucs_status_t
+ucs_event_set_uring_disarm(ucs_sys_event_set_t *event_set, int fd)
+{
+    ucs_event_set_uring_fd_t *uring_fd = &event_set->uring->fds[fd];
+    struct io_uring_sqe *sqe;
+    ucs_status_t status;
+
+    if (uring_fd->flags & UCS_EVENT_SET_URING_FD_ARMED) {
+        sqe = ucs_event_set_uring_get_sqe(event_set, &status);
+        if (sqe != NULL) {
+            sqe->opcode    = IORING_OP_POLL_REMOVE;
+            sqe->fd        = -1;
+            sqe->addr      = ucs_event_set_uring_user_data(fd, uring_fd->gen);
+            sqe->user_data = UCS_EVENT_SET_URING_IGNORE;
+        } else if (status != UCS_ERR_NO_RESOURCE) {
+            return status;
+        }
+        /* Without an SQE the request stays in the kernel until the fd
+         * becomes ready, and its completion is dropped by the generation */
+        uring_fd->flags &= ~UCS_EVENT_SET_URING_FD_ARMED;
+    }
+
+    ++uring_fd->gen;
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucs_event_set_uring_fd_check(ucs_sys_event_set_t *event_set, int fd,
+                             ucs_event_set_type_t events, const char *name)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    ucs_event_set_uring_fd_t *fds;
+    int fds_count;
+
+    if (events & UCS_EVENT_SET_EDGE_TRIGGERED) {
+        ucs_error("io_uring event set (ring_fd=%d) does not support "
+                  "edge-triggered events", event_set->event_fd);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    if (fd < uring->fds_count) {
+        return UCS_OK;
+    }
+
+    fds_count = ucs_max(ucs_roundup_pow2(fd + 1), 64);
+    fds       = ucs_realloc(uring->fds, sizeof(*fds) * fds_count,
+                            "event_set_uring_fds");
+    if (fds == NULL) {
+        ucs_error("%s(ring_fd=%d, fd=%d): failed to allocate fds table",
+                  name, event_set->event_fd, fd);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    memset(&fds[uring->fds_count], 0,
+           sizeof(*fds) * (fds_count - uring->fds_count));
+    uring->fds       = fds;
+    uring->fds_count = fds_count;
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucs_event_set_uring_add(ucs_sys_event_set_t *event_set, int fd,
+                        ucs_event_set_type_t events, void *callback_data)
+{
+    ucs_event_set_uring_fd_t *uring_fd;
+    ucs_status_t status;
+
+    status = ucs_event_set_uring_fd_check(event_set, fd, events, "add");
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    uring_fd = &event_set->uring->fds[fd];
+    if (uring_fd->flags & UCS_EVENT_SET_URING_FD_ADDED) {
+        ucs_error("io_uring event set (ring_fd=%d): fd %d is already added",
+                  event_set->event_fd, fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    uring_fd->callback_data = callback_data;
+    uring_fd->events        = events;
+    uring_fd->flags         = UCS_EVENT_SET_URING_FD_ADDED;
+    return ucs_event_set_uring_arm(event_set, fd);
+}
+
+static ucs_status_t
+ucs_event_set_uring_mod(ucs_sys_event_set_t *event_set, int fd,
+                        ucs_event_set_type_t events, void *callback_data)
+{
+    ucs_event_set_uring_fd_t *uring_fd;
+    ucs_status_t status;
+
+    status = ucs_event_set_uring_fd_check(event_set, fd, events, "mod");
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    uring_fd = &event_set->uring->fds[fd];
+    if (!(uring_fd->flags & UCS_EVENT_SET_URING_FD_ADDED)) {
+        ucs_error("io_uring event set (ring_fd=%d): fd %d is not added",
+                  event_set->event_fd, fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    uring_fd->callback_data = callback_data;
+    if (!(uring_fd->flags & UCS_EVENT_SET_URING_FD_ARMED)) {
+        /* Called from the event handler of this fd, the poll request is
+         * armed with the new events after the handler returns */
+        uring_fd->events = events;
+        return UCS_OK;
+    }
+
+    if (uring_fd->events == events) {
+        return UCS_OK;
+    }
+
+    status = ucs_event_set_uring_disarm(event_set, fd);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    uring_fd->events = events;
+    return ucs_event_set_uring_arm(event_set, fd);
+}
+
+static ucs_status_t ucs_event_set_uring_del(ucs_sys_event_set_t *event_set,
+                                            int fd)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    ucs_status_t status;
+
+    if ((fd >= uring->fds_count) ||
+        !(uring->fds[fd].flags & UCS_EVENT_SET_URING_FD_ADDED)) {
+        ucs_error("io_uring event set (ring_fd=%d): fd %d is not added",
+                  event_set->event_fd, fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    status = ucs_event_set_uring_disarm(event_set, fd);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    uring->fds[fd].flags = 0;
+    return UCS_OK;
+}
+
+static int ucs_event_set_uring_handle_cqe(ucs_sys_event_set_t *event_set,
+                                          uint64_t user_data, int res,
+                                          ucs_event_set_handler_t handler,
+                                          void *arg)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    int fd                            = (int)(uint32_t)user_data;
+    ucs_event_set_uring_fd_t *uring_fd;
+
+    if ((user_data == UCS_EVENT_SET_URING_IGNORE) ||
+        (fd >= uring->fds_count)) {
+        return 0;
+    }
+
+    uring_fd = &uring->fds[fd];
+    if (!(uring_fd->flags & UCS_EVENT_SET_URING_FD_ADDED) ||
+        (uring_fd->gen != (uint32_t)(user_data >> 32))) {
+        return 0; /* the request was removed */
+    }
+
+    uring_fd->flags &= ~UCS_EVENT_SET_URING_FD_ARMED;
+
+    if (res < 0) {
+        ucs_error("io_uring poll(ring_fd=%d, fd=%d) failed: %s",
+                  event_set->event_fd, fd, strerror(-res));
+        return 0;
+    }
+
+    handler(uring_fd->callback_data, ucs_event_set_map_to_events(res), arg);
+
+    /* Poll requests are one-shot to keep the level-triggered semantics
+     * of epoll, re-arm the request unless the handler removed the fd.
+     * The fds table may be reallocated by the handler */
+    uring_fd = &uring->fds[fd];
+    if ((uring_fd->flags & UCS_EVENT_SET_URING_FD_ADDED) &&
+        !(uring_fd->flags & UCS_EVENT_SET_URING_FD_ARMED) &&
+        (ucs_event_set_uring_arm(event_set, fd) != UCS_OK)) {
+        uring->arm_pending = 1;
+    }
+
+    return 1;
+}
+
+/* Post the poll requests which could not get an SQE before */
+static ucs_status_t
+ucs_event_set_uring_arm_pending(ucs_sys_event_set_t *event_set)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    ucs_status_t status;
+    int fd;
+
+    uring->arm_pending = 0;
+    for (fd = 0; fd < uring->fds_count; ++fd) {
+        if ((uring->fds[fd].flags & (UCS_EVENT_SET_URING_FD_ADDED |
+                                     UCS_EVENT_SET_URING_FD_ARMED)) ==
+            UCS_EVENT_SET_URING_FD_ADDED) {
+            status = ucs_event_set_uring_arm(event_set, fd);
+            if ((status != UCS_OK) || uring->arm_pending) {
+                /* Still no room, the rest is armed by a later wait */
+                uring->arm_pending = 1;
+                return status;
+            }
+        }
+    }
+
+    return UCS_OK;
+}
+
+/* Handle the completions reaped while submitting */
+static unsigned
+ucs_event_set_uring_handle_backlog(ucs_sys_event_set_t *event_set,
+                                   unsigned max_events,
+                                   ucs_event_set_handler_t handler, void *arg)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    unsigned count                    = 0;
+    unsigned i                        = 0;
+    ucs_event_set_uring_cqe_t cqe;
+
+    /* Handlers may append to the backlog */
+    while ((count < max_events) && (i < uring->backlog_count)) {
+        cqe    = uring->backlog[i++];
+        count += ucs_event_set_uring_handle_cqe(event_set, cqe.user_data,
+                                                cqe.res, handler, arg);
+    }
+
+    memmove(uring->backlog, uring->backlog + i,
+            sizeof(*uring->backlog) * (uring->backlog_count - i));
+    uring->backlog_count -= i;
+    return count;
+}
+
+static ucs_status_t
+ucs_event_set_uring_wait(ucs_sys_event_set_t *event_set,
+                         unsigned *num_events, int timeout_ms,
+                         ucs_event_set_handler_t event_set_handler,
+                         void *arg)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+    unsigned count                    = 0;
+    int poll_timeout_ms               = timeout_ms;
+    ucs_time_t deadline               = 0;
+    struct pollfd pfd;
+    struct io_uring_cqe *cqe;
+    ucs_status_t status;
+    ucs_time_t now;
+    unsigned head;
+    uint64_t user_data;
+    int res, ret;
+
+    if (timeout_ms > 0) {
+        deadline = ucs_get_time() + ucs_time_from_msec(timeout_ms);
+    }
+
+    for (;;) {
+        if (uring->arm_pending) {
+            status = ucs_event_set_uring_arm_pending(event_set);
+            if (status != UCS_OK) {
+                *num_events = 0;
+                return status;
+            }
+        }
+
+        status = ucs_event_set_uring_submit(event_set);
+        if (status == UCS_ERR_NO_RESOURCE) {
+            /* Handle the completions below and try again, don't sleep
+             * with poll requests which the kernel has not seen */
+            poll_timeout_ms = 0;
+        } else if (status != UCS_OK) {
+            *num_events = 0;
+            return status;
+        }
+
+        count += ucs_event_set_uring_handle_backlog(event_set,
+                                                    *num_events - count,
+                                                    event_set_handler, arg);
+
+        if (*(volatile unsigned*)uring->sq_flags & IORING_SQ_CQ_OVERFLOW) {
+            /* Flush the completions that didn't fit the CQ ring */
+            ucs_event_set_uring_enter(event_set->event_fd, 0, 0,
+                                      IORING_ENTER_GETEVENTS);
+        }
+
+        head = *uring->cq_head;
+        if ((head == *(volatile unsigned*)uring->cq_tail) &&
+            (count == 0) && (poll_timeout_ms != 0)) {
+            pfd.fd     = event_set->event_fd;
+            pfd.events = POLLIN;
+            ret        = poll(&pfd, 1, poll_timeout_ms);
+            if (ucs_unlikely(ret < 0)) {
+                *num_events = 0;
+                if (errno == EINTR) {
+                    return UCS_INPROGRESS;
+                }
+                ucs_error("poll(ring_fd=%d) failed: %m", event_set->event_fd);
+                return UCS_ERR_IO_ERROR;
+            }
+        }
+
+        /* The head is read again every time, since a handler may move
+         * completions to the backlog to submit its requests */
+        while ((count < *num_events) &&
+               ((head = *(volatile unsigned*)uring->cq_head) !=
+                *(volatile unsigned*)uring->cq_tail)) {
+            ucs_memory_cpu_load_fence();
+            cqe       = &uring->cqes[head & uring->cq_mask];
+            user_data = cqe->user_data;
+            res       = cqe->res;
+
+            /* Release the CQE before calling the handler, which may post
+             * new requests */
+            ++head;
+            ucs_memory_cpu_fence();
+            *(volatile unsigned*)uring->cq_head = head;
+
+            count += ucs_event_set_uring_handle_cqe(event_set, user_data, res,
+                                                    event_set_handler, arg);
+        }
+
+        if ((count > 0) || (timeout_ms == 0)) {
+            break;
+        }
+
+        /* Only completions of removed requests were found, wait for the
+         * rest of the timeout */
+        if (timeout_ms > 0) {
+            now = ucs_get_time();
+            if (now >= deadline) {
+                break;
+            }
+
+            poll_timeout_ms = (int)ucs_time_to_msec(deadline - now) + 1;
+        } else {
+            poll_timeout_ms = timeout_ms;
+        }
+    }
+
+    ucs_trace_poll("io_uring wait(ring_fd=%d, num_events=%u, timeout=%d) "
+                   "returned %u", event_set->event_fd, *num_events,
+                   timeout_ms, count);
+
+    /* Re-armed requests are submitted by the next wait, so the poll state
+     * is checked after the handlers consumed the events */
+    *num_events = count;
+    return UCS_OK;
+}
+
+static void ucs_event_set_uring_cleanup(ucs_sys_event_set_t *event_set)
+{
+    struct ucs_event_set_uring *uring = event_set->uring;
+
+    munmap(uring->sqes, uring->sqes_size);
+    if (uring->cq_ring != uring->sq_ring) {
+        munmap(uring->cq_ring, uring->cq_ring_size);
+    }
+    munmap(uring->sq_ring, uring->sq_ring_size);
+    ucs_free(uring->backlog);
+    ucs_free(uring->fds);
+    ucs_free(uring);
+}
+
+ucs_status_t ucs_event_set_create_uring(ucs_sys_event_set_t **event_set_p,
+                                        unsigned num_entries, int sq_poll)
+{
+    struct io_uring_params params;
+    struct ucs_event_set_uring *uring;
+    ucs_sys_event_set_t *event_set;
+    ucs_status_t status;
+    unsigned i;
+    int ring_fd;
+
+    memset(&params, 0, sizeof(params));
+    if (sq_poll) {
+        params.flags         |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = UCS_EVENT_SET_URING_SQ_IDLE_MS;
+    }
+
+    ring_fd = syscall(__NR_io_uring_setup, num_entries, &params);
+    if (ring_fd < 0) {
+        ucs_debug("io_uring_setup(entries=%u, flags=0x%x) failed: %m",
+                  num_entries, params.flags);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    /* Without NODROP poll completions could be lost on CQ overflow */
+    if (!(params.features & IORING_FEAT_NODROP)) {
+        ucs_debug("io_uring does not support IORING_FEAT_NODROP");
+        status = UCS_ERR_UNSUPPORTED;
+        goto err_close_ring_fd;
+    }
+
+    uring = ucs_calloc(1, sizeof(*uring), "event_set_uring");
+    if (uring == NULL) {
+        ucs_error("unable to allocate memory for io_uring event set");
+        status = UCS_ERR_NO_MEMORY;
+        goto err_close_ring_fd;
+    }
+
+    uring->setup_flags  = params.flags;
+    uring->sq_ring_size = params.sq_off.array +
+                          (params.sq_entries * sizeof(unsigned));
+    uring->cq_ring_size = params.cq_off.cqes +
+                          (params.cq_entries * sizeof(struct io_uring_cqe));
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        uring->sq_ring_size = ucs_max(uring->sq_ring_size,
+                                      uring->cq_ring_size);
+        uring->cq_ring_size = uring->sq_ring_size;
+    }
+
+    uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd,
+                          IORING_OFF_SQ_RING);
+    if (uring->sq_ring == MAP_FAILED) {
+        ucs_error("failed to map io_uring SQ ring: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err_free_uring;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        uring->cq_ring = uring->sq_ring;
+    } else {
+        uring->cq_ring = mmap(NULL, uring->cq_ring_size,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring_fd,
+                              IORING_OFF_CQ_RING);
+        if (uring->cq_ring == MAP_FAILED) {
+            ucs_error("failed to map io_uring CQ ring: %m");
+            status = UCS_ERR_IO_ERROR;
+            goto err_unmap_sq_ring;
+        }
+    }
+
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes      = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd,
+                            IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        ucs_error("failed to map io_uring SQEs: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err_unmap_cq_ring;
+    }
+
+    uring->sq_head    = UCS_PTR_BYTE_OFFSET(uring->sq_ring, params.sq_off.head);
+    uring->sq_tail    = UCS_PTR_BYTE_OFFSET(uring->sq_ring, params.sq_off.tail);
+    uring->sq_flags   = UCS_PTR_BYTE_OFFSET(uring->sq_ring, params.sq_off.flags);
+    uring->sq_mask    = *(unsigned*)UCS_PTR_BYTE_OFFSET(uring->sq_ring,
+                                                        params.sq_off.ring_mask);
+    uring->sq_entries = params.sq_entries;
+    uring->cq_head    = UCS_PTR_BYTE_OFFSET(uring->cq_ring, params.cq_off.head);
+    uring->cq_tail    = UCS_PTR_BYTE_OFFSET(uring->cq_ring, params.cq_off.tail);
+    uring->cq_mask    = *(unsigned*)UCS_PTR_BYTE_OFFSET(uring->cq_ring,
+                                                        params.cq_off.ring_mask);
+    uring->cqes       = UCS_PTR_BYTE_OFFSET(uring->cq_ring, params.cq_off.cqes);
+
+    /* SQ array is an identity map, since SQEs are used in order */
+    for (i = 0; i < uring->sq_entries; ++i) {
+        ((unsigned*)UCS_PTR_BYTE_OFFSET(uring->sq_ring,
+                                        params.sq_off.array))[i] = i;
+    }
+
+    uring->sq_prepared  = *uring->sq_tail;
+    uring->sq_published = uring->sq_prepared;
+
+    event_set = ucs_event_set_alloc(ring_fd, 0);
+    if (event_set == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err_unmap_sqes;
+    }
+
+    event_set->uring = uring;
+    *event_set_p     = event_set;
+    return UCS_OK;
+
+err_unmap_sqes:
+    munmap(uring->sqes, uring->sqes_size);
+err_unmap_cq_ring:
+    if (uring->cq_ring != uring->sq_ring) {
+        munmap(uring->cq_ring, uring->cq_ring_size);
+    }
+err_unmap_sq_ring:
+    munmap(uring->sq_ring, uring->sq_ring_size);
+err_free_uring:
+    ucs_free(uring);
+err_close_ring_fd:
+    close(ring_fd);
+    return status;
+}
+
+#else
+
+ucs_status_t ucs_event_set_create_uring(ucs_sys_event_set_t **event_set_p,
+                                        unsigned num_entries, int sq_poll)
+{
+    ucs_debug("io_uring support is not compiled in");
+    return UCS_ERR_UNSUPPORTED;
+}
+
+#endif
+
 ucs_status_t ucs_event_set_add(ucs_sys_event_set_t *event_set, int fd,
                                ucs_event_set_type_t events, void *callback_data)
 {
     struct epoll_event raw_event;
     int ret;
 
+#if UCS_EVENT_SET_HAVE_URING
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_add(event_set, fd, events, callback_data);
+    }
+#endif
+
     memset(&raw_event, 0, sizeof(raw_event));
     raw_event.events   = ucs_event_set_map_to_raw_events(events);
     raw_event.data.ptr = callback_data;
@@ -151,6 +983,12 @@ ucs_status_t ucs_event_set_mod(ucs_sys_event_set_t *event_set, int fd,
     struct epoll_event raw_event;
     int ret;
 
+#if UCS_EVENT_SET_HAVE_URING
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_mod(event_set, fd, events, callback_data);
+    }
+#endif
+
     memset(&raw_event, 0, sizeof(raw_event));
     raw_event.events   = ucs_event_set_map_to_raw_events(events);
     raw_event.data.ptr = callback_data;
@@ -169,6 +1007,12 @@ ucs_status_t ucs_event_set_del(ucs_sys_event_set_t *event_set, int fd)
 {
     int ret;
 
+#if UCS_EVENT_SET_HAVE_URING
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_del(event_set, fd);
+    }
+#endif
+
     ret = epoll_ctl(event_set->event_fd, EPOLL_CTL_DEL, fd, NULL);
     if (ret < 0) {
         ucs_error("epoll_ctl(event_fd=%d, DEL, fd=%d) failed: %m",
@@ -191,6 +1035,13 @@ ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
     ucs_assert(num_events != NULL);
     ucs_assert(*num_events <= ucs_sys_event_set_max_wait_events);
 
+#if UCS_EVENT_SET_HAVE_URING
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_wait(event_set, num_events, timeout_ms,
+                                        event_set_handler, arg);
+    }
+#endif
+
     events = ucs_alloca(sizeof(*events) * *num_events);
 
     nready = epoll_wait(event_set->event_fd, events, *num_events, timeout_ms);
@@ -217,8 +1068,26 @@ ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
     return UCS_OK;
 }
 
+ucs_status_t ucs_event_set_submit(ucs_sys_event_set_t *event_set)
+{
+#if UCS_EVENT_SET_HAVE_URING
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_submit(event_set);
+    }
+#endif
+
+    /* epoll applies the changes immediately */
+    return UCS_OK;
+}
+
 void ucs_event_set_cleanup(ucs_sys_event_set_t *event_set)
 {
+#if UCS_EVENT_SET_HAVE_URING
+    if (event_set->uring != NULL) {
+        ucs_event_set_uring_cleanup(event_set);
+    }
+#endif
+
     if (!(event_set->flags & UCS_SYS_EVENT_SET_EXTERNAL_EVENT_FD)) {
         close(event_set->event_fd);
     }
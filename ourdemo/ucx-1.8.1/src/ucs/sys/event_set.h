@@ -62,6 +62,24 @@ ucs_status_t ucs_event_set_create_from_fd(ucs_sys_event_set_t **event_set_p,
  */
 ucs_status_t ucs_event_set_create(ucs_sys_event_set_t **event_set_p);
 
+/**
+ * Allocate ucs_sys_event_set_t structure which waits for events by polling
+ * requests posted on an io_uring instance. Requests are batched, so a wait
+ * call issues at most one system call to both submit and reap them, or none
+ * if the kernel polls the submission queue. Edge-triggered events are not
+ * supported.
+ *
+ * @param [out] event_set_p  Event set pointer to initialize.
+ * @param [in]  num_entries  Size of the io_uring submission queue.
+ * @param [in]  sq_poll      Whether to let a kernel thread poll the
+ *                           submission queue.
+ *
+ * @return UCS_OK on success, UCS_ERR_UNSUPPORTED if io_uring is not
+ *         available, or another error code on failure.
+ */
+ucs_status_t ucs_event_set_create_uring(ucs_sys_event_set_t **event_set_p,
+                                        unsigned num_entries, int sq_poll);
+
 /**
  * Register the target event.
  *
@@ -118,6 +136,17 @@ ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
                                 ucs_event_set_handler_t event_set_handler,
                                 void *arg);
 
+/**
+ * Submit the pending changes of the event set. Changes are applied by
+ * ucs_event_set_wait anyway, this is needed only when the event set file
+ * descriptor is watched by an external poll.
+ *
+ * @param [in] event_set    Event set created by ucs_event_set_create.
+ *
+ * @return UCS_OK on success or an error code on failure.
+ */
+ucs_status_t ucs_event_set_submit(ucs_sys_event_set_t *event_set);
+
 /**
  * Cleanup event set
  *
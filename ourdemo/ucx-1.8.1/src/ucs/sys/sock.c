@@ -14,6 +14,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <ifaddrs.h>
+#include <linux/errqueue.h>
 
 #include <unistd.h>
 #include <errno.h>
@@ -22,6 +23,14 @@
 
 #define UCS_SOCKET_MAX_CONN_PATH "/proc/sys/net/core/somaxconn"
 
+/* MSG_ZEROCOPY is available since Linux 4.14 */
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && \
+    defined(SO_EE_ORIGIN_ZEROCOPY)
+#  define UCS_SOCKET_HAVE_MSG_ZEROCOPY 1
+#else
+#  define UCS_SOCKET_HAVE_MSG_ZEROCOPY 0
+#endif
+
 
 typedef ssize_t (*ucs_socket_io_func_t)(int fd, void *data,
                                         size_t size, int flags);
@@ -459,6 +468,103 @@ ucs_socket_sendv_nb(int fd, struct iovec *iov, size_t iov_cnt, size_t *length_p,
                                 "sendv", err_cb, err_cb_arg);
 }
 
+ucs_status_t ucs_socket_zcopy_enable(int fd)
+{
+#if UCS_SOCKET_HAVE_MSG_ZEROCOPY
+    int optval = 1;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &optval, sizeof(optval)) < 0) {
+        ucs_debug("failed to enable SO_ZEROCOPY on fd %d: %m", fd);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    return UCS_OK;
+#else
+    return UCS_ERR_UNSUPPORTED;
+#endif
+}
+
+ucs_status_t
+ucs_socket_sendv_zcopy_nb(int fd, struct iovec *iov, size_t iov_cnt,
+                          size_t *length_p, ucs_socket_io_err_cb_t err_cb,
+                          void *err_cb_arg)
+{
+#if UCS_SOCKET_HAVE_MSG_ZEROCOPY
+    struct msghdr msg = {
+        .msg_iov    = iov,
+        .msg_iovlen = iov_cnt
+    };
+    ssize_t ret;
+
+    ucs_assert(iov_cnt > 0);
+
+    ret = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_ZEROCOPY);
+    if (ucs_likely(ret > 0)) {
+        *length_p = ret;
+        return UCS_OK;
+    }
+
+    *length_p = 0;
+    if ((ret < 0) && (errno == ENOBUFS)) {
+        /* the pinned pages of the socket exceeded the optmem limit */
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    return ucs_socket_handle_io_error(fd, "sendv_zcopy", ret, errno,
+                                      err_cb, err_cb_arg);
+#else
+    *length_p = 0;
+    return UCS_ERR_UNSUPPORTED;
+#endif
+}
+
+ucs_status_t ucs_socket_zcopy_notif_nb(int fd, uint32_t *lo_p, uint32_t *hi_p,
+                                       int *copied_p)
+{
+#if UCS_SOCKET_HAVE_MSG_ZEROCOPY
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err) +
+                            sizeof(struct sockaddr_in6))];
+    struct msghdr msg = {
+        .msg_control    = control,
+        .msg_controllen = sizeof(control)
+    };
+    struct sock_extended_err *serr;
+    struct cmsghdr *cmsg;
+
+    if (recvmsg(fd, &msg, MSG_ERRQUEUE) < 0) {
+        if (ucs_socket_check_errno(errno) == UCS_ERR_NO_PROGRESS) {
+            return UCS_ERR_NO_PROGRESS;
+        }
+
+        ucs_error("recvmsg(fd=%d, MSG_ERRQUEUE) failed: %m", fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if ((cmsg == NULL) ||
+        !(((cmsg->cmsg_level == SOL_IP) && (cmsg->cmsg_type == IP_RECVERR)) ||
+          ((cmsg->cmsg_level == SOL_IPV6) &&
+           (cmsg->cmsg_type == IPV6_RECVERR)))) {
+        ucs_error("fd %d: unexpected message on the error queue", fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    serr = (struct sock_extended_err*)CMSG_DATA(cmsg);
+    if ((serr->ee_errno != 0) || (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)) {
+        ucs_error("fd %d: unexpected error queue notification (origin %d): %s",
+                  fd, serr->ee_origin, strerror(serr->ee_errno));
+        return UCS_ERR_IO_ERROR;
+    }
+
+    *lo_p     = serr->ee_info;
+    *hi_p     = serr->ee_data;
+    *copied_p = !!(serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+    return UCS_OK;
+#else
+    return UCS_ERR_UNSUPPORTED;
+#endif
+}
+
 ucs_status_t ucs_sockaddr_sizeof(const struct sockaddr *addr, size_t *size_p)
 {
     switch (addr->sa_family) {
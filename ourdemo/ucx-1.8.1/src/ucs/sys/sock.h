@@ -269,6 +269,67 @@ ucs_status_t ucs_socket_sendv_nb(int fd, struct iovec *iov, size_t iov_cnt,
                                  void *err_cb_arg);
 
 
+/**
+ * Enable MSG_ZEROCOPY transmission (SO_ZEROCOPY option) on the socket
+ * referred to by the file descriptor `fd`.
+ *
+ * @param [in]      fd              Socket fd.
+ *
+ * @return UCS_OK on success, UCS_ERR_UNSUPPORTED if the system or the socket
+ *         does not support zero-copy transmission.
+ */
+ucs_status_t ucs_socket_zcopy_enable(int fd);
+
+
+/**
+ * Non-blocking zero-copy send operation sends I/O vector on the connected
+ * socket referred to by the file descriptor `fd`, which must have zero-copy
+ * enabled by @ref ucs_socket_zcopy_enable. The buffers must not be modified
+ * until the kernel reports the send as completed by a notification which is
+ * read by @ref ucs_socket_zcopy_notif_nb. Every successful call consumes one
+ * notification ID, starting from 0.
+ *
+ * @param [in]      fd              Socket fd.
+ * @param [in]      iov             A pointer to an array of iovec buffers.
+ * @param [in]      iov_cnt         The number of buffers pointed to by
+ *                                  the iov parameter.
+ * @param [out]     length_p        The amount of data transmitted is written to
+ *                                  this argument.
+ * @param [in]      err_cb          Error callback.
+ * @param [in]      err_cb_arg      User's argument for the error callback.
+ *
+ * @return UCS_OK on success, UCS_ERR_CANCELED if connection closed,
+ *         UCS_ERR_NO_PROGRESS if system call was interrupted or
+ *         would block, UCS_ERR_NO_MEMORY if the socket is out of
+ *         memory for pinned pages (the data may be sent by copy instead),
+ *         UCS_ERR_UNSUPPORTED if zero-copy is not supported by the system,
+ *         UCS_ERR_IO_ERROR on failure.
+ */
+ucs_status_t ucs_socket_sendv_zcopy_nb(int fd, struct iovec *iov,
+                                       size_t iov_cnt, size_t *length_p,
+                                       ucs_socket_io_err_cb_t err_cb,
+                                       void *err_cb_arg);
+
+
+/**
+ * Non-blocking read of a zero-copy completion notification from the error
+ * queue of the socket referred to by the file descriptor `fd`. The
+ * notification reports that the sends with IDs in the range [lo, hi] have
+ * completed and their buffers may be reused.
+ *
+ * @param [in]      fd              Socket fd.
+ * @param [out]     lo_p            The first completed send ID.
+ * @param [out]     hi_p            The last completed send ID.
+ * @param [out]     copied_p        Set to nonzero if the kernel fell back to
+ *                                  copying the data of these sends.
+ *
+ * @return UCS_OK on success, UCS_ERR_NO_PROGRESS if there are no
+ *         notifications, UCS_ERR_IO_ERROR on failure.
+ */
+ucs_status_t ucs_socket_zcopy_notif_nb(int fd, uint32_t *lo_p, uint32_t *hi_p,
+                                       int *copied_p);
+
+
 /**
  * Blocking receive operation receives data from the connected (or bound
  * connectionless) socket referred to by the file descriptor `fd`.
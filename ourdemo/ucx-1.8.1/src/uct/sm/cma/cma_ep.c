@@ -11,13 +11,10 @@
 #include <sys/uio.h>
 
 #include "cma_ep.h"
+#include <ucs/arch/atomic.h>
 #include <ucs/debug/log.h>
 #include <ucs/sys/iovec.h>
 
-typedef ssize_t (*uct_cma_ep_zcopy_fn_t)(pid_t, const struct iovec *,
-                                         unsigned long, const struct iovec *,
-                                         unsigned long, unsigned long);
-
 static UCS_CLASS_INIT_FUNC(uct_cma_ep_t, const uct_ep_params_t *params)
 {
     uct_cma_iface_t *iface = ucs_derived_of(params->iface, uct_cma_iface_t);
@@ -46,7 +43,7 @@ UCS_CLASS_DEFINE_DELETE_FUNC(uct_cma_ep_t, uct_ep_t);
                     (_rkey))
 
 static UCS_F_ALWAYS_INLINE
-ucs_status_t uct_cma_ep_do_zcopy(uct_cma_ep_t *ep, struct iovec *local_iov,
+ucs_status_t uct_cma_ep_do_zcopy(pid_t remote_pid, struct iovec *local_iov,
                                  size_t local_iov_cnt, struct iovec *remote_iov,
                                  uct_cma_ep_zcopy_fn_t fn_p, const char *fn_name)
 {
@@ -55,11 +52,11 @@ ucs_status_t uct_cma_ep_do_zcopy(uct_cma_ep_t *ep, struct iovec *local_iov,
     ssize_t ret;
 
     do {
-        ret = fn_p(ep->remote_pid, &local_iov[local_iov_idx],
+        ret = fn_p(remote_pid, &local_iov[local_iov_idx],
                    local_iov_cnt - local_iov_idx, remote_iov, 1, 0);
         if (ucs_unlikely(ret < 0)) {
             ucs_error("%s(pid=%d length=%zu) returned %zd: %m",
-                      fn_name, ep->remote_pid, remote_iov->iov_len, ret);
+                      fn_name, remote_pid, remote_iov->iov_len, ret);
             return UCS_ERR_IO_ERROR;
         }
 
@@ -71,6 +68,91 @@ ucs_status_t uct_cma_ep_do_zcopy(uct_cma_ep_t *ep, struct iovec *local_iov,
     return UCS_OK;
 }
 
+/*
+ * Fill @a dst_iov with the part of @a iov which starts at @a offset and has
+ * @a length bytes, and return the number of filled items.
+ */
+static size_t uct_cma_iov_slice(const struct iovec *iov, size_t iov_cnt,
+                                size_t offset, size_t length,
+                                struct iovec *dst_iov)
+{
+    size_t iov_idx = 0;
+    size_t dst_cnt = 0;
+    size_t len;
+
+    while (offset >= iov[iov_idx].iov_len) {
+        offset -= iov[iov_idx].iov_len;
+        ++iov_idx;
+        ucs_assert(iov_idx < iov_cnt);
+    }
+
+    while (length > 0) {
+        ucs_assert(iov_idx < iov_cnt);
+        len                       = ucs_min(iov[iov_idx].iov_len - offset,
+                                            length);
+        dst_iov[dst_cnt].iov_base = UCS_PTR_BYTE_OFFSET(iov[iov_idx].iov_base,
+                                                        offset);
+        dst_iov[dst_cnt].iov_len  = len;
+        length                   -= len;
+        offset                    = 0;
+        ++dst_cnt;
+        ++iov_idx;
+    }
+
+    return dst_cnt;
+}
+
+void uct_cma_copy_job_progress(uct_cma_copy_job_t *job)
+{
+    struct iovec local_iov[UCT_SM_MAX_IOV];
+    struct iovec remote_iov;
+    size_t local_iov_cnt;
+    size_t offset;
+    uint32_t chunk;
+    ucs_status_t status;
+
+    while ((chunk = ucs_atomic_fadd32(&job->next_chunk, 1)) < job->num_chunks) {
+        offset              = chunk * job->chunk_size;
+        remote_iov.iov_base = (void*)(job->remote_addr + offset);
+        remote_iov.iov_len  = ucs_min(job->chunk_size, job->length - offset);
+        local_iov_cnt       = uct_cma_iov_slice(job->local_iov,
+                                                job->local_iov_cnt, offset,
+                                                remote_iov.iov_len, local_iov);
+
+        status = uct_cma_ep_do_zcopy(job->remote_pid, local_iov, local_iov_cnt,
+                                     &remote_iov, job->fn_p, job->fn_name);
+        if (ucs_unlikely(status != UCS_OK)) {
+            job->status = status;
+        }
+    }
+}
+
+static ucs_status_t uct_cma_ep_do_zcopy_mt(uct_cma_ep_t *ep,
+                                           struct iovec *local_iov,
+                                           size_t local_iov_cnt,
+                                           uint64_t remote_addr, size_t length,
+                                           uct_cma_ep_zcopy_fn_t fn_p,
+                                           const char *fn_name)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_cma_iface_t);
+    uct_cma_copy_job_t job;
+
+    job.remote_pid    = ep->remote_pid;
+    job.fn_p          = fn_p;
+    job.fn_name       = fn_name;
+    job.local_iov     = local_iov;
+    job.local_iov_cnt = local_iov_cnt;
+    job.remote_addr   = remote_addr;
+    job.length        = length;
+    job.chunk_size    = iface->copy_config.chunk_size;
+    job.num_chunks    = ucs_div_round_up(length, job.chunk_size);
+    job.next_chunk    = 0;
+    job.status        = UCS_OK;
+
+    return uct_cma_iface_copy_mt(iface, &job);
+}
+
 static UCS_F_ALWAYS_INLINE
 ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
                                      const uct_iov_t *iov,
@@ -85,8 +167,9 @@ ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
                                                      unsigned long),
                                      const char *fn_name)
 {
-    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
-    size_t iov_idx   = 0;
+    uct_cma_ep_t *ep       = ucs_derived_of(tl_ep, uct_cma_ep_t);
+    uct_cma_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_cma_iface_t);
+    size_t iov_idx         = 0;
     ucs_status_t status;
     size_t local_iov_cnt;
     size_t length;
@@ -109,10 +192,20 @@ ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
             continue; /* Nothing to deliver */
         }
 
-        remote_iov.iov_len = length;
-
-        status = uct_cma_ep_do_zcopy(ep, local_iov, local_iov_cnt,
-                                     &remote_iov, fn_p, fn_name);
+        if (ucs_unlikely((length >= iface->copy_config.min_length) &&
+                         (iface->copy_config.num_threads > 0))) {
+            status = uct_cma_ep_do_zcopy_mt(ep, local_iov, local_iov_cnt,
+                                            (uintptr_t)remote_iov.iov_base,
+                                            length, fn_p, fn_name);
+            remote_iov.iov_base = UCS_PTR_BYTE_OFFSET(remote_iov.iov_base,
+                                                      length);
+        } else {
+            /* advances remote_iov by the copied length */
+            remote_iov.iov_len  = length;
+            status = uct_cma_ep_do_zcopy(ep->remote_pid, local_iov,
+                                         local_iov_cnt, &remote_iov, fn_p,
+                                         fn_name);
+        }
         if (ucs_unlikely(status != UCS_OK)) {
             return status;
         }
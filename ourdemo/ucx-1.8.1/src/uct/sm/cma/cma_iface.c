@@ -10,6 +10,7 @@
 
 #include <uct/base/uct_md.h>
 #include <ucs/sys/string.h>
+#include <string.h>
 
 
 typedef struct {
@@ -27,6 +28,22 @@ static ucs_config_field_t uct_cma_iface_config_table[] = {
     ucs_offsetof(uct_cma_iface_config_t, super),
     UCS_CONFIG_TYPE_TABLE(uct_sm_iface_config_table)},
 
+    {"COPY_MT_THREADS", "0",
+     "Number of helper threads which copy chunks of a large zcopy operation\n"
+     "in parallel with the calling thread. 0 disables multi-threaded copy.\n"
+     "The threads are created on the first large operation.",
+     ucs_offsetof(uct_cma_iface_config_t, copy_mt_threads), UCS_CONFIG_TYPE_UINT},
+
+    {"COPY_MT_THRESH", "8m",
+     "Minimal zcopy operation size to be copied by multiple threads.",
+     ucs_offsetof(uct_cma_iface_config_t, copy_mt_thresh),
+     UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"COPY_MT_CHUNK", "1m",
+     "Size of a single chunk used in multi-threaded copy.",
+     ucs_offsetof(uct_cma_iface_config_t, copy_mt_chunk),
+     UCS_CONFIG_TYPE_MEMUNITS},
+
     {NULL}
 };
 
@@ -106,6 +123,98 @@ uct_cma_iface_is_reachable(const uct_iface_h tl_iface,
     return ucs_sys_ns_is_default(UCS_SYS_NS_TYPE_PID);
 }
 
+static void *uct_cma_iface_copy_thread_func(void *arg)
+{
+    uct_cma_iface_t *iface = arg;
+    unsigned job_sn        = 0;
+    uct_cma_copy_job_t *job;
+
+    pthread_mutex_lock(&iface->copy.lock);
+    for (;;) {
+        while (!iface->copy.stop &&
+               ((iface->copy.job == NULL) || (iface->copy.job_sn == job_sn))) {
+            pthread_cond_wait(&iface->copy.job_cond, &iface->copy.lock);
+        }
+
+        if (iface->copy.stop) {
+            break;
+        }
+
+        job    = iface->copy.job;
+        job_sn = iface->copy.job_sn;
+        ++iface->copy.active;
+        pthread_mutex_unlock(&iface->copy.lock);
+
+        uct_cma_copy_job_progress(job);
+
+        pthread_mutex_lock(&iface->copy.lock);
+        if (--iface->copy.active == 0) {
+            pthread_cond_signal(&iface->copy.idle_cond);
+        }
+    }
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    return NULL;
+}
+
+static void uct_cma_iface_copy_threads_start(uct_cma_iface_t *iface)
+{
+    int ret;
+
+    while (iface->copy.num_started < iface->copy_config.num_threads) {
+        ret = pthread_create(&iface->copy.threads[iface->copy.num_started],
+                             NULL, uct_cma_iface_copy_thread_func, iface);
+        if (ret != 0) {
+            /* the operation is still completed by the started threads */
+            ucs_warn("failed to create cma copy thread: %s", strerror(ret));
+            iface->copy_config.num_threads = iface->copy.num_started;
+            break;
+        }
+
+        ++iface->copy.num_started;
+    }
+}
+
+static void uct_cma_iface_copy_threads_stop(uct_cma_iface_t *iface)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&iface->copy.lock);
+    iface->copy.stop = 1;
+    pthread_cond_broadcast(&iface->copy.job_cond);
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    for (i = 0; i < iface->copy.num_started; ++i) {
+        pthread_join(iface->copy.threads[i], NULL);
+    }
+}
+
+ucs_status_t uct_cma_iface_copy_mt(uct_cma_iface_t *iface,
+                                   uct_cma_copy_job_t *job)
+{
+    if (ucs_unlikely(iface->copy.num_started < iface->copy_config.num_threads)) {
+        uct_cma_iface_copy_threads_start(iface);
+    }
+
+    pthread_mutex_lock(&iface->copy.lock);
+    iface->copy.job = job;
+    ++iface->copy.job_sn;
+    pthread_cond_broadcast(&iface->copy.job_cond);
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    uct_cma_copy_job_progress(job);
+
+    /* all chunks are taken, wait for the threads which still copy them */
+    pthread_mutex_lock(&iface->copy.lock);
+    iface->copy.job = NULL;
+    while (iface->copy.active > 0) {
+        pthread_cond_wait(&iface->copy.idle_cond, &iface->copy.lock);
+    }
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    return job->status;
+}
+
 static UCS_CLASS_DECLARE_DELETE_FUNC(uct_cma_iface_t, uct_iface_t);
 
 static uct_iface_ops_t uct_cma_iface_ops = {
@@ -133,14 +242,49 @@ static UCS_CLASS_INIT_FUNC(uct_cma_iface_t, uct_md_h md, uct_worker_h worker,
                            const uct_iface_params_t *params,
                            const uct_iface_config_t *tl_config)
 {
+    uct_cma_iface_config_t *config = ucs_derived_of(tl_config,
+                                                    uct_cma_iface_config_t);
+
     UCS_CLASS_CALL_SUPER_INIT(uct_sm_iface_t, &uct_cma_iface_ops, md,
                               worker, params, tl_config);
 
+    if (config->copy_mt_chunk == 0) {
+        ucs_error("cma copy chunk size must be non-zero");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    self->copy_config.num_threads = config->copy_mt_threads;
+    self->copy_config.min_length  = config->copy_mt_thresh;
+    self->copy_config.chunk_size  = config->copy_mt_chunk;
+    self->copy.num_started        = 0;
+    self->copy.job                = NULL;
+    self->copy.job_sn             = 0;
+    self->copy.active             = 0;
+    self->copy.stop               = 0;
+    self->copy.threads            = NULL;
+
+    if (self->copy_config.num_threads > 0) {
+        self->copy.threads = ucs_calloc(self->copy_config.num_threads,
+                                        sizeof(*self->copy.threads),
+                                        "cma_copy_threads");
+        if (self->copy.threads == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+    }
+
+    pthread_mutex_init(&self->copy.lock, NULL);
+    pthread_cond_init(&self->copy.job_cond, NULL);
+    pthread_cond_init(&self->copy.idle_cond, NULL);
     return UCS_OK;
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_cma_iface_t)
 {
+    uct_cma_iface_copy_threads_stop(self);
+    pthread_cond_destroy(&self->copy.idle_cond);
+    pthread_cond_destroy(&self->copy.job_cond);
+    pthread_mutex_destroy(&self->copy.lock);
+    ucs_free(self->copy.threads);
 }
 
 UCS_CLASS_DEFINE(uct_cma_iface_t, uct_base_iface_t);
@@ -10,18 +10,78 @@
 #include <uct/base/uct_iface.h>
 #include <uct/sm/base/sm_iface.h>
 
+#include <pthread.h>
+
 
 #define UCT_CMA_IFACE_ADDR_FLAG_PID_NS UCS_BIT(31) /* use PID NS in address */
 
 
+typedef ssize_t (*uct_cma_ep_zcopy_fn_t)(pid_t, const struct iovec *,
+                                         unsigned long, const struct iovec *,
+                                         unsigned long, unsigned long);
+
+
+/**
+ * Large zcopy operation, which is split to chunks copied by the calling
+ * thread and the copy threads of the interface.
+ */
+typedef struct uct_cma_copy_job {
+    pid_t                         remote_pid;
+    uct_cma_ep_zcopy_fn_t         fn_p;
+    const char                    *fn_name;
+    const struct iovec            *local_iov;
+    size_t                        local_iov_cnt;
+    uint64_t                      remote_addr;
+    size_t                        length;
+    size_t                        chunk_size;
+    uint32_t                      num_chunks;
+    volatile uint32_t             next_chunk;  /* Next chunk to copy */
+    volatile ucs_status_t         status;      /* Error of any chunk */
+} uct_cma_copy_job_t;
+
+
 typedef struct uct_cma_iface_config {
     uct_sm_iface_config_t         super;
+    unsigned                      copy_mt_threads;
+    size_t                        copy_mt_thresh;
+    size_t                        copy_mt_chunk;
 } uct_cma_iface_config_t;
 
 
 typedef struct uct_cma_iface {
     uct_sm_iface_t                super;
+    struct {
+        unsigned                  num_threads;  /* Number of copy threads */
+        size_t                    min_length;   /* Multi-threaded copy threshold */
+        size_t                    chunk_size;   /* Multi-threaded copy chunk */
+    } copy_config;
+    struct {
+        pthread_t                 *threads;
+        unsigned                  num_started;
+        pthread_mutex_t           lock;
+        pthread_cond_t            job_cond;     /* Signaled on a new job or stop */
+        pthread_cond_t            idle_cond;    /* Signaled when no thread runs
+                                                   the current job */
+        uct_cma_copy_job_t        *job;         /* Current job, or NULL */
+        unsigned                  job_sn;       /* Serial number of the job */
+        unsigned                  active;       /* Threads running the job */
+        int                       stop;
+    } copy;
 } uct_cma_iface_t;
 
 
+/**
+ * Copy chunks of the job until no more chunks are left.
+ */
+void uct_cma_copy_job_progress(uct_cma_copy_job_t *job);
+
+
+/**
+ * Run the job by the calling thread and the copy threads of the interface,
+ * and wait until all its chunks are copied.
+ */
+ucs_status_t uct_cma_iface_copy_mt(uct_cma_iface_t *iface,
+                                   uct_cma_copy_job_t *job);
+
+
 #endif
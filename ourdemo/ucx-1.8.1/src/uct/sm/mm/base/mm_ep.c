@@ -8,6 +8,7 @@
 #include "mm_ep.h"
 
 #include <ucs/arch/atomic.h>
+#include <signal.h>
 
 
 /* send modes */
@@ -114,6 +115,118 @@ static void uct_mm_ep_signal_remote(uct_mm_ep_t *ep)
     }
 }
 
+/* An owner in another pid namespace cannot be checked with kill(), since a
+ * live process there may have no pid here, so its lane is never taken over */
+static int uct_mm_ep_lane_owner_is_dead(uint64_t owner, uint64_t self)
+{
+    return (owner != 0) &&
+           (UCT_MM_LANE_OWNER_NS(owner) == UCT_MM_LANE_OWNER_NS(self)) &&
+           (kill(UCT_MM_LANE_OWNER_PID(owner), 0) != 0) && (errno == ESRCH);
+}
+
+/* A process which died holding a lane did not save its head, so find it from
+ * the elements it completed after the last tail reported by the receiver */
+static uint64_t uct_mm_ep_lane_find_head(uct_mm_iface_t *iface,
+                                         uct_mm_lane_ctl_t *lane_ctl)
+{
+    void *elems = UCT_MM_LANE_GET_ELEMS(lane_ctl);
+    uct_mm_fifo_element_t *elem;
+    uint64_t head, tail;
+
+    tail = lane_ctl->tail;
+    ucs_memory_cpu_load_fence();
+
+    for (head = tail; head < tail + iface->config.lane_size; ++head) {
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, elems, head & iface->lane_mask);
+        /* the owner bit is flipped on every wraparound, same as the receiver
+         * checks it */
+        if (!!(head & iface->config.lane_size) !=
+            !!(elem->flags & UCT_MM_FIFO_ELEM_FLAG_OWNER)) {
+            break;
+        }
+    }
+
+    return head;
+}
+
+/* Try to take a free single-producer lane of the remote FIFO, so that sending
+ * would not contend with other senders on the shared FIFO head. A lane held by
+ * a process of our pid namespace which does not exist anymore is taken over. */
+static void uct_mm_ep_lane_claim(uct_mm_ep_t *ep)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_mm_iface_t);
+    uct_mm_lane_ctl_t *lane_ctl;
+    uint32_t num_lanes_used;
+    uint64_t owner, self, head;
+    unsigned lane;
+
+    /* the lanes layout of the remote FIFO must be the same as ours */
+    if ((iface->config.num_lanes == 0) ||
+        (ep->fifo_ctl->num_lanes != iface->config.num_lanes) ||
+        (ep->fifo_ctl->lane_size != iface->config.lane_size)) {
+        return;
+    }
+
+    self = UCT_MM_LANE_OWNER(ucs_sys_get_ns(UCS_SYS_NS_TYPE_PID), getpid());
+    for (lane = 0; lane < iface->config.num_lanes; ++lane) {
+        lane_ctl = UCT_MM_IFACE_GET_LANE_CTL(iface, ep->fifo_elems, lane);
+        owner    = ucs_atomic_cswap64(ucs_unaligned_ptr(&lane_ctl->owner), 0,
+                                      self);
+        if (owner == 0) {
+            /* resume from where the previous owner of the lane stopped */
+            ucs_memory_cpu_load_fence();
+            head = lane_ctl->head;
+            goto claimed;
+        }
+
+        if (uct_mm_ep_lane_owner_is_dead(owner, self) &&
+            (ucs_atomic_cswap64(ucs_unaligned_ptr(&lane_ctl->owner), owner,
+                                self) == owner)) {
+            head = uct_mm_ep_lane_find_head(iface, lane_ctl);
+            ucs_debug("mm ep %p: took over FIFO lane %u of dead process %d",
+                      ep, lane, UCT_MM_LANE_OWNER_PID(owner));
+            goto claimed;
+        }
+    }
+
+    ucs_debug("mm ep %p: all %u FIFO lanes are taken, using the shared FIFO",
+              ep, iface->config.num_lanes);
+    return;
+
+claimed:
+    ep->lane.ctl    = lane_ctl;
+    ep->lane.elems  = UCT_MM_LANE_GET_ELEMS(lane_ctl);
+    ep->lane.head   = head;
+    ep->cached_tail = lane_ctl->tail;
+    ep->fifo_size   = iface->config.lane_size;
+
+    /* let the receiver poll the lane */
+    do {
+        num_lanes_used = ep->fifo_ctl->num_lanes_used;
+        if (num_lanes_used > lane) {
+            break;
+        }
+    } while (ucs_atomic_cswap32(ucs_unaligned_ptr(&ep->fifo_ctl->num_lanes_used),
+                                num_lanes_used, lane + 1) != num_lanes_used);
+
+    ucs_debug("mm ep %p: claimed FIFO lane %u head %"PRIu64, ep, lane,
+              ep->lane.head);
+}
+
+static void uct_mm_ep_lane_release(uct_mm_ep_t *ep)
+{
+    if (ep->lane.ctl == NULL) {
+        return;
+    }
+
+    /* the next owner continues from our head, so the receiver which reads
+     * the lane in order would not notice the change */
+    ep->lane.ctl->head = ep->lane.head;
+    ucs_memory_cpu_store_fence();
+    ep->lane.ctl->owner = 0;
+    ep->lane.ctl        = NULL;
+}
+
 static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
 {
     uct_mm_iface_t            *iface = ucs_derived_of(params->iface, uct_mm_iface_t);
@@ -153,9 +266,15 @@ static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
     /* Initialize remote FIFO control structure */
     uct_mm_iface_set_fifo_ptrs(fifo_ptr, &self->fifo_ctl, &self->fifo_elems);
     self->cached_tail     = self->fifo_ctl->tail;
+    self->fifo_size       = iface->config.fifo_size;
+    self->lane.ctl        = NULL;
+    self->lane.elems      = NULL;
+    self->lane.head       = 0;
     self->signal.addrlen  = self->fifo_ctl->signal_addrlen;
     self->signal.sockaddr = self->fifo_ctl->signal_sockaddr;
 
+    uct_mm_ep_lane_claim(self);
+
     ucs_debug("created mm ep %p, connected to remote FIFO id 0x%lx",
               self, addr->fifo_seg_id);
 
@@ -173,6 +292,7 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_ep_t)
     uct_mm_remote_seg_t remote_seg;
 
     uct_mm_ep_pending_purge(&self->super.super, NULL, NULL);
+    uct_mm_ep_lane_release(self);
 
     kh_foreach_value(&self->remote_segs, remote_seg, {
         uct_mm_iface_mapper_call(iface, mem_detach, &remote_seg);
@@ -207,10 +327,16 @@ static inline ucs_status_t uct_mm_ep_get_remote_elem(uct_mm_ep_t *ep, uint64_t h
     return UCS_OK;
 }
 
+static UCS_F_ALWAYS_INLINE uint64_t uct_mm_ep_fifo_head(uct_mm_ep_t *ep)
+{
+    return (ep->lane.ctl != NULL) ? ep->lane.head : ep->fifo_ctl->head;
+}
+
 static inline void uct_mm_ep_update_cached_tail(uct_mm_ep_t *ep)
 {
     ucs_memory_cpu_load_fence();
-    ep->cached_tail = ep->fifo_ctl->tail;
+    ep->cached_tail = (ep->lane.ctl != NULL) ? ep->lane.ctl->tail :
+                      ep->fifo_ctl->tail;
 }
 
 /* A common mm active message sending function.
@@ -234,9 +360,9 @@ uct_mm_ep_am_common_send(uct_mm_send_op_t send_op, uct_mm_ep_t *ep,
     UCT_CHECK_AM_ID(am_id);
 
 retry:
-    head = ep->fifo_ctl->head;
+    head = uct_mm_ep_fifo_head(ep);
     /* check if there is room in the remote process's receive FIFO to write */
-    if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, iface->config.fifo_size)) {
+    if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, ep->fifo_size)) {
         if (!ucs_arbiter_group_is_empty(&ep->arb_group)) {
             /* pending isn't empty. don't send now to prevent out-of-order sending */
             UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
@@ -245,18 +371,24 @@ retry:
             /* pending is empty */
             /* update the local copy of the tail to its actual value on the remote peer */
             uct_mm_ep_update_cached_tail(ep);
-            if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, iface->config.fifo_size)) {
+            if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, ep->fifo_size)) {
                 UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
                 return UCS_ERR_NO_RESOURCE;
             }
         }
     }
 
-    status = uct_mm_ep_get_remote_elem(ep, head, &elem);
-    if (status != UCS_OK) {
-        ucs_assert(status == UCS_ERR_NO_RESOURCE);
-        ucs_trace_poll("couldn't get an available FIFO element. retrying");
-        goto retry;
+    if (ep->lane.ctl != NULL) {
+        /* the lane has a single producer, so the element is ours */
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, ep->lane.elems,
+                                          head & iface->lane_mask);
+    } else {
+        status = uct_mm_ep_get_remote_elem(ep, head, &elem);
+        if (status != UCS_OK) {
+            ucs_assert(status == UCS_ERR_NO_RESOURCE);
+            ucs_trace_poll("couldn't get an available FIFO element. retrying");
+            goto retry;
+        }
     }
 
     switch (send_op) {
@@ -301,11 +433,15 @@ retry:
 
     /* set the owner bit to indicate that the writing is complete.
      * the owner bit flips after every FIFO wraparound */
-    if (head & iface->config.fifo_size) {
+    if (head & ep->fifo_size) {
         elem_flags |= UCT_MM_FIFO_ELEM_FLAG_OWNER;
     }
     elem->flags = elem_flags;
 
+    if (ep->lane.ctl != NULL) {
+        ep->lane.head = head + 1;
+    }
+
     if (ucs_unlikely(flags & UCT_SEND_FLAG_SIGNALED)) {
         uct_mm_ep_signal_remote(ep);
     }
@@ -347,9 +483,8 @@ ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_
 
 static inline int uct_mm_ep_has_tx_resources(uct_mm_ep_t *ep)
 {
-    uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_mm_iface_t);
-    return UCT_MM_EP_IS_ABLE_TO_SEND(ep->fifo_ctl->head, ep->cached_tail,
-                                     iface->config.fifo_size);
+    return UCT_MM_EP_IS_ABLE_TO_SEND(uct_mm_ep_fifo_head(ep), ep->cached_tail,
+                                     ep->fifo_size);
 }
 
 ucs_status_t uct_mm_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n,
@@ -29,6 +29,16 @@ typedef struct uct_mm_ep {
 
     uint64_t                   cached_tail; /* the sender's own copy of the remote FIFO's tail.
                                                it is not always updated with the actual remote tail value */
+    unsigned                   fifo_size;   /* size of the remote FIFO or lane to which
+                                               the ep posts messages */
+
+    /* Single-producer lane in the remote FIFO, owned by this ep */
+    struct {
+        uct_mm_lane_ctl_t      *ctl;        /* lane control, NULL if the ep posts
+                                               to the shared FIFO */
+        void                   *elems;      /* lane elements */
+        uint64_t               head;        /* where to write next */
+    } lane;
 
     /* mapped remote memory chunks to which remote descriptors belong to.
      * (after attaching to them) */
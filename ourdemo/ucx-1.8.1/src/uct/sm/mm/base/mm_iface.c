@@ -57,6 +57,18 @@ ucs_config_field_t uct_mm_iface_config_table[] = {
      "Size of the FIFO element size (data + header) in the MM UCTs.",
      ucs_offsetof(uct_mm_iface_config_t, fifo_elem_size), UCS_CONFIG_TYPE_UINT},
 
+    {"FIFO_LANES", "0",
+     "Number of single-producer lanes in the receive FIFO. A sender which owns a\n"
+     "lane posts messages to it without atomic operations on the FIFO head shared\n"
+     "by all senders. Senders claim lanes on a first-come basis when connecting,\n"
+     "and use the shared FIFO when all lanes are taken. A lane held by a process\n"
+     "which exited without releasing it is taken over. 0 disables the lanes.",
+     ucs_offsetof(uct_mm_iface_config_t, num_lanes), UCS_CONFIG_TYPE_UINT},
+
+    {"FIFO_LANE_SIZE", "32",
+     "Size of every single-producer lane of the receive FIFO in the memory-map UCTs.",
+     ucs_offsetof(uct_mm_iface_config_t, lane_size), UCS_CONFIG_TYPE_UINT},
+
     {NULL}
 };
 
@@ -242,11 +254,23 @@ static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
     return status;
 }
 
+static inline void uct_mm_iface_recv_elem(uct_mm_iface_t *iface,
+                                          uct_mm_fifo_element_t *elem)
+{
+    ucs_status_t status;
+
+    status = uct_mm_iface_process_recv(iface, elem);
+    if (status != UCS_OK) {
+        /* the last_recv_desc is in use. get a new descriptor for it */
+        UCT_TL_IFACE_GET_RX_DESC(&iface->super.super, &iface->recv_desc_mp,
+                                 iface->last_recv_desc, ucs_debug("recv mpool is empty"));
+    }
+}
+
 static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
 {
     uint64_t read_index_loc, read_index;
     uct_mm_fifo_element_t* read_index_elem;
-    ucs_status_t status;
 
     /* check the memory pool to make sure that there is a new descriptor available */
     if (ucs_unlikely(iface->last_recv_desc == NULL)) {
@@ -267,12 +291,7 @@ static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
         ucs_memory_cpu_load_fence();
         ucs_assert(iface->read_index <= iface->recv_fifo_ctl->head);
 
-        status = uct_mm_iface_process_recv(iface, read_index_elem);
-        if (status != UCS_OK) {
-            /* the last_recv_desc is in use. get a new descriptor for it */
-            UCT_TL_IFACE_GET_RX_DESC(&iface->super.super, &iface->recv_desc_mp,
-                                     iface->last_recv_desc, ucs_debug("recv mpool is empty"));
-        }
+        uct_mm_iface_recv_elem(iface, read_index_elem);
 
         /* raise the read_index. */
         iface->read_index++;
@@ -285,6 +304,45 @@ static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
     }
 }
 
+/* Poll every claimed lane once, so that the lanes are served round-robin */
+static inline unsigned uct_mm_iface_poll_lanes(uct_mm_iface_t *iface)
+{
+    unsigned count = 0;
+    uct_mm_fifo_element_t *elem;
+    uct_mm_rx_lane_t *rx_lane;
+    unsigned num_lanes;
+
+    num_lanes = ucs_min(iface->recv_fifo_ctl->num_lanes_used,
+                        iface->config.num_lanes);
+
+    for (rx_lane = iface->rx_lanes; rx_lane < iface->rx_lanes + num_lanes;
+         ++rx_lane) {
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, rx_lane->elems,
+                                          rx_lane->read_index & iface->lane_mask);
+        if (((rx_lane->read_index >> iface->lane_shift) & 1) !=
+            (elem->flags & 1)) {
+            continue;
+        }
+
+        if (ucs_unlikely(iface->last_recv_desc == NULL)) {
+            UCT_TL_IFACE_GET_RX_DESC(&iface->super.super, &iface->recv_desc_mp,
+                                     iface->last_recv_desc, break);
+        }
+
+        ucs_memory_cpu_load_fence();
+        uct_mm_iface_recv_elem(iface, elem);
+
+        /* release the lane elements in batches, like the shared FIFO */
+        if (!(++rx_lane->read_index & iface->lane_release_factor_mask)) {
+            rx_lane->ctl->tail = rx_lane->read_index;
+        }
+
+        ++count;
+    }
+
+    return count;
+}
+
 unsigned uct_mm_iface_progress(void *arg)
 {
     uct_mm_iface_t *iface = arg;
@@ -292,6 +350,9 @@ unsigned uct_mm_iface_progress(void *arg)
 
     /* progress receive */
     count = uct_mm_iface_poll_fifo(iface);
+    if (iface->config.num_lanes > 0) {
+        count += uct_mm_iface_poll_lanes(iface);
+    }
 
     /* progress the pending sends (if there are any) */
     ucs_arbiter_dispatch(&iface->arbiter, 1, uct_mm_ep_process_pending, NULL);
@@ -388,20 +449,102 @@ static void uct_mm_iface_recv_desc_init(uct_iface_h tl_iface, void *obj,
     desc->info.offset   = offset;
 }
 
-static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface, unsigned num_elems)
+static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface, void *elems,
+                                       unsigned num_elems)
 {
     uct_mm_fifo_element_t *elem;
     uct_mm_recv_desc_t *desc;
     unsigned i;
 
     for (i = 0; i < num_elems; i++) {
-        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elems, i);
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, elems, i);
         desc = (uct_mm_recv_desc_t*)UCS_PTR_BYTE_OFFSET(elem->desc_data,
                                                         -iface->rx_headroom) - 1;
         ucs_mpool_put(desc);
     }
 }
 
+/* Initiate the owner bit in all the FIFO elements and assign a receive
+ * descriptor per every FIFO element */
+static ucs_status_t uct_mm_iface_init_rx_descs(uct_mm_iface_t *iface,
+                                               void *elems, unsigned num_elems)
+{
+    uct_mm_fifo_element_t *elem;
+    ucs_status_t status;
+    unsigned i;
+
+    for (i = 0; i < num_elems; i++) {
+        elem        = UCT_MM_IFACE_GET_FIFO_ELEM(iface, elems, i);
+        elem->flags = UCT_MM_FIFO_ELEM_FLAG_OWNER;
+
+        status = uct_mm_assign_desc_to_fifo_elem(iface, elem, 1);
+        if (status != UCS_OK) {
+            ucs_error("failed to allocate a descriptor for MM");
+            uct_mm_iface_free_rx_descs(iface, elems, i);
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
+static void uct_mm_iface_free_lanes(uct_mm_iface_t *iface, unsigned num_lanes)
+{
+    unsigned lane;
+
+    for (lane = 0; lane < num_lanes; ++lane) {
+        uct_mm_iface_free_rx_descs(iface, iface->rx_lanes[lane].elems,
+                                   iface->config.lane_size);
+    }
+
+    ucs_free(iface->rx_lanes);
+}
+
+static ucs_status_t uct_mm_iface_init_lanes(uct_mm_iface_t *iface)
+{
+    uct_mm_rx_lane_t *rx_lane;
+    ucs_status_t status;
+    unsigned lane;
+
+    iface->recv_fifo_ctl->num_lanes      = iface->config.num_lanes;
+    iface->recv_fifo_ctl->lane_size      = iface->config.lane_size;
+    iface->recv_fifo_ctl->num_lanes_used = 0;
+
+    if (iface->config.num_lanes == 0) {
+        iface->rx_lanes = NULL;
+        return UCS_OK;
+    }
+
+    iface->rx_lanes = ucs_calloc(iface->config.num_lanes,
+                                 sizeof(*iface->rx_lanes), "mm_rx_lanes");
+    if (iface->rx_lanes == NULL) {
+        ucs_error("failed to allocate %u MM receive lanes",
+                  iface->config.num_lanes);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    for (lane = 0; lane < iface->config.num_lanes; ++lane) {
+        rx_lane             = &iface->rx_lanes[lane];
+        rx_lane->ctl        = UCT_MM_IFACE_GET_LANE_CTL(iface,
+                                                        iface->recv_fifo_elems,
+                                                        lane);
+        rx_lane->elems      = UCT_MM_LANE_GET_ELEMS(rx_lane->ctl);
+        rx_lane->read_index = 0;
+        rx_lane->ctl->owner = 0;
+        rx_lane->ctl->head  = 0;
+        rx_lane->ctl->tail  = 0;
+
+        status = uct_mm_iface_init_rx_descs(iface, rx_lane->elems,
+                                            iface->config.lane_size);
+        if (status != UCS_OK) {
+            uct_mm_iface_free_lanes(iface, lane);
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
 void uct_mm_iface_set_fifo_ptrs(void *fifo_mem, uct_mm_fifo_ctl_t **fifo_ctl_p,
                                 void **fifo_elems_p)
 {
@@ -484,9 +627,10 @@ static void uct_mm_iface_log_created(uct_mm_iface_t *iface)
 {
     uct_mm_seg_t UCS_V_UNUSED *seg = iface->recv_fifo_mem.memh;
 
-    ucs_debug("created mm iface %p FIFO id 0x%lx va %p size %zu (%u x %u elems)",
-              iface, seg->seg_id, seg->address, seg->length,
-              iface->config.fifo_elem_size, iface->config.fifo_size);
+    ucs_debug("created mm iface %p FIFO id 0x%lx va %p size %zu (%u x %u elems"
+              ", %u lanes x %u elems)", iface, seg->seg_id, seg->address,
+              seg->length, iface->config.fifo_elem_size, iface->config.fifo_size,
+              iface->config.num_lanes, iface->config.lane_size);
 }
 
 static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
@@ -495,9 +639,7 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
 {
     uct_mm_iface_config_t *mm_config =
                     ucs_derived_of(tl_config, uct_mm_iface_config_t);
-    uct_mm_fifo_element_t* fifo_elem_p;
     ucs_status_t status;
-    unsigned i;
 
     UCS_CLASS_CALL_SUPER_INIT(uct_sm_iface_t, &uct_mm_iface_ops, md,
                               worker, params, tl_config);
@@ -530,6 +672,14 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err;
     }
 
+    /* check that the lane size is a power of two and bigger than 1 */
+    if ((mm_config->num_lanes > 0) &&
+        ((mm_config->lane_size <= 1) || !ucs_is_pow2(mm_config->lane_size))) {
+        ucs_error("The MM FIFO lane size must be a power of two and bigger than 1.");
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
     self->config.fifo_size         = mm_config->fifo_size;
     self->config.fifo_elem_size    = mm_config->fifo_elem_size;
     self->config.seg_size          = mm_config->seg_size;
@@ -539,6 +689,20 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
                                      1)));
     self->fifo_mask                = mm_config->fifo_size - 1;
     self->fifo_shift               = ucs_count_trailing_zero_bits(mm_config->fifo_size);
+    self->config.num_lanes         = mm_config->num_lanes;
+    self->config.lane_size         = (mm_config->num_lanes > 0) ?
+                                     mm_config->lane_size : 0;
+    if (self->config.num_lanes > 0) {
+        self->lane_release_factor_mask = UCS_MASK(ucs_ilog2(ucs_max((int)
+                                         (mm_config->lane_size * mm_config->release_fifo_factor),
+                                         1)));
+        self->lane_mask                = mm_config->lane_size - 1;
+        self->lane_shift               = ucs_count_trailing_zero_bits(mm_config->lane_size);
+    } else {
+        self->lane_release_factor_mask = 0;
+        self->lane_mask                = 0;
+        self->lane_shift               = 0;
+    }
     self->rx_headroom              = (params->field_mask &
                                       UCT_IFACE_PARAM_FIELD_RX_HEADROOM) ?
                                      params->rx_headroom : 0;
@@ -582,7 +746,8 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err_close_signal_fd;
     }
 
-    ucs_mpool_grow(&self->recv_desc_mp, mm_config->fifo_size * 2);
+    ucs_mpool_grow(&self->recv_desc_mp, (mm_config->fifo_size * 2) +
+                   (self->config.num_lanes * self->config.lane_size));
 
     /* set the first receive descriptor */
     self->last_recv_desc = ucs_mpool_get(&self->recv_desc_mp);
@@ -593,17 +758,15 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto destroy_recv_mpool;
     }
 
-    /* initiate the owner bit in all the FIFO elements and assign a receive descriptor
-     * per every FIFO element */
-    for (i = 0; i < mm_config->fifo_size; i++) {
-        fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(self, self->recv_fifo_elems, i);
-        fifo_elem_p->flags = UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    status = uct_mm_iface_init_rx_descs(self, self->recv_fifo_elems,
+                                        mm_config->fifo_size);
+    if (status != UCS_OK) {
+        goto put_last_desc;
+    }
 
-        status = uct_mm_assign_desc_to_fifo_elem(self, fifo_elem_p, 1);
-        if (status != UCS_OK) {
-            ucs_error("failed to allocate a descriptor for MM");
-            goto destroy_descs;
-        }
+    status = uct_mm_iface_init_lanes(self);
+    if (status != UCS_OK) {
+        goto destroy_descs;
     }
 
     ucs_arbiter_init(&self->arbiter);
@@ -612,7 +775,9 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
     return UCS_OK;
 
 destroy_descs:
-    uct_mm_iface_free_rx_descs(self, i);
+    uct_mm_iface_free_rx_descs(self, self->recv_fifo_elems,
+                               mm_config->fifo_size);
+put_last_desc:
     ucs_mpool_put(self->last_recv_desc);
 destroy_recv_mpool:
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
@@ -631,7 +796,9 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_iface_t)
 
     /* return all the descriptors that are now 'assigned' to the FIFO,
      * to their mpool */
-    uct_mm_iface_free_rx_descs(self, self->config.fifo_size);
+    uct_mm_iface_free_rx_descs(self, self->recv_fifo_elems,
+                               self->config.fifo_size);
+    uct_mm_iface_free_lanes(self, self->config.num_lanes);
 
     ucs_mpool_put(self->last_recv_desc);
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
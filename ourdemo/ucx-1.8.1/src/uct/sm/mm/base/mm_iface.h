@@ -31,9 +31,24 @@ enum {
     ucs_align_up(sizeof(uct_mm_fifo_ctl_t), UCS_SYS_CACHE_LINE_SIZE)
 
 
+#define UCT_MM_LANE_CTL_SIZE \
+    ucs_align_up(sizeof(uct_mm_lane_ctl_t), UCS_SYS_CACHE_LINE_SIZE)
+
+
+#define UCT_MM_GET_FIFO_ELEMS_SIZE(_iface) \
+    ucs_align_up((_iface)->config.fifo_size * (_iface)->config.fifo_elem_size, \
+                 UCS_SYS_CACHE_LINE_SIZE)
+
+
+#define UCT_MM_GET_LANE_SIZE(_iface) \
+    (UCT_MM_LANE_CTL_SIZE + \
+     ucs_align_up((_iface)->config.lane_size * (_iface)->config.fifo_elem_size, \
+                  UCS_SYS_CACHE_LINE_SIZE))
+
+
 #define UCT_MM_GET_FIFO_SIZE(_iface) \
-    (UCT_MM_FIFO_CTL_SIZE + \
-     ((_iface)->config.fifo_size * (_iface)->config.fifo_elem_size) + \
+    (UCT_MM_FIFO_CTL_SIZE + UCT_MM_GET_FIFO_ELEMS_SIZE(_iface) + \
+     ((_iface)->config.num_lanes * UCT_MM_GET_LANE_SIZE(_iface)) + \
       (UCS_SYS_CACHE_LINE_SIZE - 1))
 
 
@@ -42,6 +57,32 @@ enum {
      UCS_PTR_BYTE_OFFSET(_fifo, (_index) * (_iface)->config.fifo_elem_size))
 
 
+/* Lanes follow the shared FIFO elements, each lane is its control structure
+ * followed by its elements */
+#define UCT_MM_IFACE_GET_LANE_CTL(_iface, _fifo_elems, _lane) \
+    ((uct_mm_lane_ctl_t*) \
+     UCS_PTR_BYTE_OFFSET(_fifo_elems, UCT_MM_GET_FIFO_ELEMS_SIZE(_iface) + \
+                         ((_lane) * UCT_MM_GET_LANE_SIZE(_iface))))
+
+
+#define UCT_MM_LANE_GET_ELEMS(_lane_ctl) \
+    UCS_PTR_BYTE_OFFSET(_lane_ctl, UCT_MM_LANE_CTL_SIZE)
+
+
+/* Lane owner id: the pid namespace in the upper half and the process id in
+ * the lower half, since a pid means nothing outside of its namespace */
+#define UCT_MM_LANE_OWNER(_pid_ns, _pid) \
+    (((uint64_t)(uint32_t)(_pid_ns) << 32) | (uint32_t)(_pid))
+
+
+#define UCT_MM_LANE_OWNER_NS(_owner) \
+    ((uint32_t)((_owner) >> 32))
+
+
+#define UCT_MM_LANE_OWNER_PID(_owner) \
+    ((pid_t)(uint32_t)(_owner))
+
+
 #define uct_mm_iface_mapper_call(_iface, _func, ...) \
     ({ \
         uct_mm_md_t *md = ucs_derived_of((_iface)->super.super.md, uct_mm_md_t); \
@@ -61,6 +102,8 @@ typedef struct uct_mm_iface_config {
     ucs_ternary_value_t      hugetlb_mode;    /* Enable using huge pages for
                                                * shared memory buffers */
     unsigned                 fifo_elem_size;  /* Size of the FIFO element size */
+    unsigned                 num_lanes;       /* Number of single-producer lanes */
+    unsigned                 lane_size;       /* Size of every lane */
     uct_iface_mpool_config_t mp;
 } uct_mm_iface_config_t;
 
@@ -88,9 +131,33 @@ typedef struct uct_mm_fifo_ctl {
 
     /* 2nd cacheline */
     volatile uint64_t         tail;           /* How much was consumed */
+    uint32_t                  num_lanes;      /* Number of single-producer lanes */
+    uint32_t                  lane_size;      /* Number of elements in a lane */
+    volatile uint32_t         num_lanes_used; /* Upper bound of claimed lanes,
+                                                 the receiver polls only them */
 } UCS_S_PACKED UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) uct_mm_fifo_ctl_t;
 
 
+/**
+ * MM single-producer lane control segment. A sender which owns a lane posts
+ * to it without atomic operations, since no other sender writes to it.
+ */
+typedef struct uct_mm_lane_ctl {
+    /* 1st cacheline - written by the sender */
+    volatile uint64_t         owner;          /* UCT_MM_LANE_OWNER id of the
+                                                 owner, 0 if the lane is free.
+                                                 Taken over if the owner is in
+                                                 our pid namespace and dead */
+    uint64_t                  head;           /* Where to write next, saved
+                                                 when the lane is released */
+    UCS_CACHELINE_PADDING(uint64_t,
+                          uint64_t);
+
+    /* 2nd cacheline - written by the receiver */
+    volatile uint64_t         tail;           /* How much was consumed */
+} UCS_S_PACKED UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) uct_mm_lane_ctl_t;
+
+
 /**
  * MM receive descriptor info in the shared FIFO
  */
@@ -134,6 +201,16 @@ typedef struct uct_mm_recv_desc {
 } uct_mm_recv_desc_t;
 
 
+/**
+ * MM receiver state of a single-producer lane
+ */
+typedef struct uct_mm_rx_lane {
+    uct_mm_lane_ctl_t         *ctl;           /* lane control segment */
+    void                      *elems;         /* first element of the lane */
+    uint64_t                  read_index;     /* actual reading location */
+} uct_mm_rx_lane_t;
+
+
 /**
  * MM trandport interface
  */
@@ -157,6 +234,11 @@ typedef struct uct_mm_iface {
     unsigned                fifo_mask;        /* = 2^fifo_shift - 1 */
     uint64_t                fifo_release_factor_mask;
 
+    uct_mm_rx_lane_t        *rx_lanes;        /* single-producer lanes */
+    uint8_t                 lane_shift;       /* = log2(lane_size) */
+    unsigned                lane_mask;        /* = 2^lane_shift - 1 */
+    uint64_t                lane_release_factor_mask;
+
     ucs_mpool_t             recv_desc_mp;
     uct_mm_recv_desc_t      *last_recv_desc;  /* next receive descriptor to use */
 
@@ -170,6 +252,8 @@ typedef struct uct_mm_iface {
         unsigned            fifo_size;
         unsigned            fifo_elem_size;
         unsigned            seg_size;         /* size of the receive descriptor (for payload)*/
+        unsigned            num_lanes;        /* number of single-producer lanes */
+        unsigned            lane_size;        /* number of elements in a lane */
     } config;
 } uct_mm_iface_t;
 
@@ -249,6 +249,20 @@ typedef struct uct_tcp_ep_put_completion {
 } uct_tcp_ep_put_completion_t;
 
 
+/**
+ * TCP MSG_ZEROCOPY completion
+ */
+typedef struct uct_tcp_ep_msg_zcopy_completion {
+    uct_completion_t              *comp;           /* User's completion passed to
+                                                    * Zcopy operation or uct_ep_flush */
+    uint32_t                      wait_sn;         /* Number of MSG_ZEROCOPY sends that
+                                                    * have to be reported by the kernel
+                                                    * to complete the operation */
+    ucs_queue_elem_t              elem;            /* Element to insert completion into
+                                                    * TCP EP MSG_ZEROCOPY pending queue */
+} uct_tcp_ep_msg_zcopy_completion_t;
+
+
 /**
  * TCP endpoint communication context
  */
@@ -271,6 +285,13 @@ typedef struct uct_tcp_ep_zcopy_tx {
     uct_completion_t              *comp;     /* Local UCT completion object */
     size_t                        iov_index; /* Current IOV index */
     size_t                        iov_cnt;   /* Number of IOVs that should be sent */
+    size_t                        msg_zcopy_iov; /* Index of the first IOV that is sent
+                                                  * with MSG_ZEROCOPY, equal to `iov_cnt`
+                                                  * if the operation is sent by copy */
+    uint32_t                      msg_zcopy_sn;  /* EP MSG_ZEROCOPY send counter before
+                                                  * the operation was started */
+    uct_tcp_ep_msg_zcopy_completion_t *msg_zcopy_comp; /* Completion allocated to wait
+                                                        * for the kernel notification */
     struct iovec                  iov[0];    /* IOVs that should be sent */
 } uct_tcp_ep_zcopy_tx_t;
 
@@ -291,6 +312,15 @@ struct uct_tcp_ep {
     ucs_queue_head_t              pending_q;        /* Pending operations */
     ucs_queue_head_t              put_comp_q;       /* Flush completions waiting for
                                                      * outstanding PUTs acknowledgment */
+    struct {
+        size_t                    thresh;           /* Minimum payload to send with
+                                                     * MSG_ZEROCOPY on this EP */
+        uint32_t                  tx_sn;            /* Number of MSG_ZEROCOPY sends done */
+        uint32_t                  comp_sn;          /* Number of MSG_ZEROCOPY sends reported
+                                                     * as completed by the kernel */
+        ucs_queue_head_t          comp_q;           /* Completions waiting for the kernel
+                                                     * MSG_ZEROCOPY notifications */
+    } msg_zcopy;
     ucs_list_link_t               list;             /* List element to insert into TCP EP list */
 };
 
@@ -312,6 +342,7 @@ typedef struct uct_tcp_iface {
                                                       * + how many non-blocking connections
                                                       * are in progress + how many EPs are
                                                       * waiting for PUT Zcopy operation ACKs
+                                                      * and MSG_ZEROCOPY notifications
                                                       * (0/1 for each EP) */
 
     struct {
@@ -326,6 +357,8 @@ typedef struct uct_tcp_iface {
             size_t                max_hdr;           /* Maximum supported AM Zcopy header */
             size_t                hdr_offset;        /* Offset in TX buffer to empty space that
                                                       * can be used for AM Zcopy header */
+            size_t                msg_zcopy_thresh;  /* Minimum size of user's payload from which
+                                                      * MSG_ZEROCOPY send should be used */
         } zcopy;
         struct sockaddr_in        ifaddr;            /* Network address */
         struct sockaddr_in        netmask;           /* Network address mask */
@@ -355,6 +388,7 @@ typedef struct uct_tcp_iface_config {
     size_t                        rx_seg_size;
     size_t                        max_iov;
     size_t                        sendv_thresh;
+    size_t                        msg_zcopy_thresh;
     int                           prefer_default;
     int                           put_enable;
     int                           conn_nb;
@@ -363,6 +397,11 @@ typedef struct uct_tcp_iface_config {
     int                           sockopt_nodelay;
     size_t                        sockopt_sndbuf;
     size_t                        sockopt_rcvbuf;
+    struct {
+        ucs_ternary_value_t       enable;
+        unsigned                  entries;
+        int                       sq_poll;
+    } io_uring;
     uct_iface_mpool_config_t      tx_mpool;
     uct_iface_mpool_config_t      rx_mpool;
 } uct_tcp_iface_config_t;
@@ -430,6 +469,8 @@ void uct_tcp_ep_add(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep);
 
 void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, int add, int remove);
 
+unsigned uct_tcp_ep_progress_msg_zcopy(uct_tcp_ep_t *ep);
+
 void uct_tcp_ep_pending_queue_dispatch(uct_tcp_ep_t *ep);
 
 ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header,
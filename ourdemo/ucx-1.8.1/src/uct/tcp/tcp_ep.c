@@ -106,6 +106,42 @@ static inline void uct_tcp_ep_ctx_reset(uct_tcp_ep_ctx_t *ctx)
     uct_tcp_ep_ctx_rewind(ctx);
 }
 
+static inline int uct_tcp_ep_msg_zcopy_is_pending(uct_tcp_ep_t *ep)
+{
+    return ep->msg_zcopy.tx_sn != ep->msg_zcopy.comp_sn;
+}
+
+static void uct_tcp_ep_msg_zcopy_init(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    ep->msg_zcopy.tx_sn   = 0;
+    ep->msg_zcopy.comp_sn = 0;
+    ep->msg_zcopy.thresh  = iface->config.zcopy.msg_zcopy_thresh;
+
+    if ((ep->msg_zcopy.thresh != UCS_MEMUNITS_INF) &&
+        (ucs_socket_zcopy_enable(ep->fd) != UCS_OK)) {
+        ep->msg_zcopy.thresh = UCS_MEMUNITS_INF;
+    }
+}
+
+/* Complete the operations that are waiting for MSG_ZEROCOPY notifications,
+ * which can't be received anymore */
+static void uct_tcp_ep_msg_zcopy_purge(uct_tcp_ep_t *ep, ucs_status_t status)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp;
+
+    ucs_queue_for_each_extract(zcopy_comp, &ep->msg_zcopy.comp_q, elem, 1) {
+        uct_invoke_completion(zcopy_comp->comp, status);
+        ucs_free(zcopy_comp);
+    }
+
+    if (uct_tcp_ep_msg_zcopy_is_pending(ep)) {
+        ep->msg_zcopy.comp_sn = ep->msg_zcopy.tx_sn;
+        uct_tcp_iface_outstanding_dec(iface);
+    }
+}
+
 static void uct_tcp_ep_addr_cleanup(struct sockaddr_in *sock_addr)
 {
     memset(sock_addr, 0, sizeof(*sock_addr));
@@ -186,6 +222,7 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
     ucs_list_head_init(&self->list);
     ucs_queue_head_init(&self->pending_q);
     ucs_queue_head_init(&self->put_comp_q);
+    ucs_queue_head_init(&self->msg_zcopy.comp_q);
 
     /* Make a socket non-blocking if an EP is created during accepting
      * a connection or non-blocking connection mode is requested */
@@ -201,6 +238,7 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
         goto err_cleanup;
     }
 
+    uct_tcp_ep_msg_zcopy_init(iface, self);
     uct_tcp_iface_add_ep(self);
 
     ucs_debug("tcp_ep %p: created on iface %p, fd %d", self, iface, self->fd);
@@ -313,6 +351,8 @@ static UCS_CLASS_CLEANUP_FUNC(uct_tcp_ep_t)
         ucs_free(put_comp);
     }
 
+    uct_tcp_ep_msg_zcopy_purge(self, UCS_ERR_CANCELED);
+
     uct_tcp_iface_remove_ep(self);
 
     if (self->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED) {
@@ -389,6 +429,7 @@ uct_tcp_ep_create_socket_and_connect(uct_tcp_iface_t *iface,
     } else {
         ep     = *ep_p;
         ep->fd = fd;
+        uct_tcp_ep_msg_zcopy_init(iface, ep);
     }
 
     status = uct_tcp_cm_conn_start(ep);
@@ -516,6 +557,66 @@ void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, int add, int remove)
     }
 }
 
+unsigned uct_tcp_ep_progress_msg_zcopy(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp;
+    unsigned count = 0;
+    uint32_t lo, hi;
+    int copied;
+
+    /* TCP reports the completed MSG_ZEROCOPY sends in order, so the upper
+     * bound of a notification range is the number of completed sends - 1 */
+    while (uct_tcp_ep_msg_zcopy_is_pending(ep) &&
+           (ucs_socket_zcopy_notif_nb(ep->fd, &lo, &hi, &copied) == UCS_OK)) {
+        ucs_trace_data("tcp_ep %p: MSG_ZEROCOPY sends [%u..%u] completed%s",
+                       ep, lo, hi, copied ? " (copied)" : "");
+        ucs_assertv(UCS_CIRCULAR_COMPARE32(hi, <, ep->msg_zcopy.tx_sn),
+                    "ep=%p hi=%u tx_sn=%u", ep, hi, ep->msg_zcopy.tx_sn);
+        ep->msg_zcopy.comp_sn = hi + 1;
+
+        if (copied && (ep->msg_zcopy.thresh != UCS_MEMUNITS_INF)) {
+            /* The kernel copied the data anyway (e.g. loopback device),
+             * don't pay for notifications on this EP anymore */
+            ucs_debug("tcp_ep %p: disabling MSG_ZEROCOPY, since the kernel "
+                      "copies the data", ep);
+            ep->msg_zcopy.thresh = UCS_MEMUNITS_INF;
+        }
+
+        ++count;
+    }
+
+    ucs_queue_for_each_extract(zcopy_comp, &ep->msg_zcopy.comp_q, elem,
+                               UCS_CIRCULAR_COMPARE32(zcopy_comp->wait_sn, <=,
+                                                      ep->msg_zcopy.comp_sn)) {
+        uct_invoke_completion(zcopy_comp->comp, UCS_OK);
+        ucs_free(zcopy_comp);
+    }
+
+    if ((count > 0) && !uct_tcp_ep_msg_zcopy_is_pending(ep)) {
+        uct_tcp_iface_outstanding_dec(iface);
+        uct_tcp_ep_mod_events(ep, 0, UCS_EVENT_SET_EVERR);
+    }
+
+    return count;
+}
+
+static inline void uct_tcp_ep_msg_zcopy_sent(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    if (!uct_tcp_ep_msg_zcopy_is_pending(ep)) {
+        /* Make flush wait for the notifications and poll the socket
+         * error queue to receive them */
+        uct_tcp_iface_outstanding_inc(iface);
+        uct_tcp_ep_mod_events(ep, UCS_EVENT_SET_EVERR, 0);
+    }
+
+    ep->msg_zcopy.tx_sn++;
+}
+
 static inline void uct_tcp_ep_handle_put_ack(uct_tcp_ep_t *ep,
                                              uct_tcp_ep_put_ack_hdr_t *put_ack)
 {
@@ -565,6 +666,7 @@ static void uct_tcp_ep_handle_disconnected(uct_tcp_ep_t *ep,
 
         uct_tcp_ep_mod_events(ep, 0, ep->events);
         uct_tcp_ep_close_fd(&ep->fd);
+        uct_tcp_ep_msg_zcopy_purge(ep, UCS_ERR_CANCELED);
     } else if ((ep->ctx_caps == 0) ||
                (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX))) {
         /* If the EP supports RX only or no capabilities set, destroy it */
@@ -597,13 +699,89 @@ static inline ssize_t uct_tcp_ep_send(uct_tcp_ep_t *ep)
     return sent_length;
 }
 
+/* Send IOVs of a Zcopy operation, IOVs starting from `copy_iov_cnt` are sent
+ * with MSG_ZEROCOPY. Service headers are always sent by copy, since they
+ * reside in the TX buffer or in the user's memory that may be reused right
+ * after the operation returns */
+static ucs_status_t
+uct_tcp_ep_sendv_iov(uct_tcp_ep_t *ep, struct iovec *iov, size_t iov_cnt,
+                     size_t copy_iov_cnt, size_t *sent_length_p)
+{
+    size_t copy_length = 0;
+    size_t iov_index, sent_length;
+    ucs_status_t status;
+
+    if (ucs_likely(copy_iov_cnt >= iov_cnt)) {
+        return ucs_socket_sendv_nb(ep->fd, iov, iov_cnt, sent_length_p,
+                                   NULL, NULL);
+    }
+
+    *sent_length_p = 0;
+
+    if (copy_iov_cnt > 0) {
+        for (iov_index = 0; iov_index < copy_iov_cnt; ++iov_index) {
+            copy_length += iov[iov_index].iov_len;
+        }
+
+        status = ucs_socket_sendv_nb(ep->fd, iov, copy_iov_cnt,
+                                     sent_length_p, NULL, NULL);
+        if ((status != UCS_OK) || (*sent_length_p < copy_length)) {
+            return status;
+        }
+    }
+
+    status = ucs_socket_sendv_zcopy_nb(ep->fd, iov + copy_iov_cnt,
+                                       iov_cnt - copy_iov_cnt, &sent_length,
+                                       NULL, NULL);
+    if (status == UCS_OK) {
+        uct_tcp_ep_msg_zcopy_sent(ep);
+    } else if (status == UCS_ERR_NO_MEMORY) {
+        /* The socket is out of memory for pinned pages, send by copy */
+        status = ucs_socket_sendv_nb(ep->fd, iov + copy_iov_cnt,
+                                     iov_cnt - copy_iov_cnt, &sent_length,
+                                     NULL, NULL);
+    }
+
+    if (status == UCS_OK) {
+        *sent_length_p += sent_length;
+    } else if ((status == UCS_ERR_NO_PROGRESS) && (*sent_length_p > 0)) {
+        status = UCS_OK;
+    }
+
+    return status;
+}
+
+/* Returns UCS_INPROGRESS if the kernel still uses the buffers of a sent
+ * Zcopy operation, otherwise the status to complete the operation with */
+static inline ucs_status_t
+uct_tcp_ep_zcopy_sent(uct_tcp_ep_t *ep, uct_tcp_ep_zcopy_tx_t *ctx,
+                      ucs_status_t status)
+{
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp = ctx->msg_zcopy_comp;
+
+    if ((status == UCS_OK) && (ep->msg_zcopy.tx_sn != ctx->msg_zcopy_sn)) {
+        if (zcopy_comp != NULL) {
+            zcopy_comp->comp    = ctx->comp;
+            zcopy_comp->wait_sn = ep->msg_zcopy.tx_sn;
+            ucs_queue_push(&ep->msg_zcopy.comp_q, &zcopy_comp->elem);
+        }
+
+        return UCS_INPROGRESS;
+    }
+
+    ucs_free(zcopy_comp);
+    return status;
+}
+
 static inline void uct_tcp_ep_comp_zcopy(uct_tcp_ep_t *ep,
-                                         uct_completion_t *comp,
+                                         uct_tcp_ep_zcopy_tx_t *ctx,
                                          ucs_status_t status)
 {
     ep->ctx_caps &= ~UCS_BIT(UCT_TCP_EP_CTX_TYPE_ZCOPY_TX);
-    if (comp != NULL) {
-        uct_invoke_completion(comp, status);
+
+    status = uct_tcp_ep_zcopy_sent(ep, ctx, status);
+    if ((status != UCS_INPROGRESS) && (ctx->comp != NULL)) {
+        uct_invoke_completion(ctx->comp, status);
     }
 }
 
@@ -617,9 +795,11 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
 
     ucs_assertv(ep->tx.offset < ep->tx.length, "ep=%p", ep);
 
-    status = ucs_socket_sendv_nb(ep->fd, &ctx->iov[ctx->iov_index],
-                                 ctx->iov_cnt - ctx->iov_index,
-                                 &sent_length, NULL, NULL);
+    status = uct_tcp_ep_sendv_iov(ep, &ctx->iov[ctx->iov_index],
+                                  ctx->iov_cnt - ctx->iov_index,
+                                  (ctx->msg_zcopy_iov > ctx->iov_index) ?
+                                  (ctx->msg_zcopy_iov - ctx->iov_index) : 0,
+                                  &sent_length);
 
     if (ucs_unlikely(status != UCS_OK)) {
         if (status == UCS_ERR_NO_PROGRESS) {
@@ -627,7 +807,7 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
             return 0;
         }
 
-        uct_tcp_ep_comp_zcopy(ep, ctx->comp, status);
+        uct_tcp_ep_comp_zcopy(ep, ctx, status);
         return status;
     }
 
@@ -638,7 +818,7 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
         ucs_iov_advance(ctx->iov, ctx->iov_cnt,
                         &ctx->iov_index, sent_length);
     } else {
-        uct_tcp_ep_comp_zcopy(ep, ctx->comp, UCS_OK);
+        uct_tcp_ep_comp_zcopy(ep, ctx, UCS_OK);
     }
 
     ucs_assert(sent_length <= SSIZE_MAX);
@@ -1086,9 +1266,8 @@ err:
 static inline void
 uct_tcp_ep_set_outstanding_zcopy(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
                                  uct_tcp_ep_zcopy_tx_t *ctx, const void *header,
-                                 unsigned header_length, uct_completion_t *comp)
+                                 unsigned header_length)
 {
-    ctx->comp     = comp;
     ep->ctx_caps |= UCS_BIT(UCT_TCP_EP_CTX_TYPE_ZCOPY_TX);
 
     if ((header_length != 0) &&
@@ -1157,7 +1336,7 @@ static inline ucs_status_t
 uct_tcp_ep_am_sendv(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
                     int short_sendv, uct_tcp_am_hdr_t *hdr,
                     size_t send_limit, const void *header,
-                    struct iovec *iov, size_t iov_cnt)
+                    struct iovec *iov, size_t iov_cnt, size_t msg_zcopy_iov)
 {
     ucs_status_t status;
 
@@ -1165,8 +1344,8 @@ uct_tcp_ep_am_sendv(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
 
     ucs_assertv(ep->tx.length <= send_limit, "ep=%p", ep);
 
-    status = ucs_socket_sendv_nb(ep->fd, iov, iov_cnt,
-                                 &ep->tx.offset, NULL, NULL);
+    status = uct_tcp_ep_sendv_iov(ep, iov, iov_cnt, msg_zcopy_iov,
+                                  &ep->tx.offset);
 
     uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, hdr->am_id,
                        /* the function will be invoked only in case of
@@ -1275,7 +1454,8 @@ ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header
 
         status = uct_tcp_ep_am_sendv(iface, ep, 1, hdr,
                                      iface->config.tx_seg_size, &header,
-                                     iov, UCT_TCP_EP_AM_SHORTV_IOV_COUNT);
+                                     iov, UCT_TCP_EP_AM_SHORTV_IOV_COUNT,
+                                     UCT_TCP_EP_AM_SHORTV_IOV_COUNT);
         if ((status == UCS_OK) || (status == UCS_ERR_NO_PROGRESS)) {
             UCT_TL_EP_STAT_OP(&ep->super, AM, SHORT, payload_length);
 
@@ -1340,10 +1520,12 @@ static inline ucs_status_t
 uct_tcp_ep_prepare_zcopy(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep, uint8_t am_id,
                          const void *header, unsigned header_length,
                          const uct_iov_t *iov, size_t iovcnt, const char *name,
-                         size_t *zcopy_payload_p, uct_tcp_ep_zcopy_tx_t **ctx_p)
+                         uct_completion_t *comp, size_t *zcopy_payload_p,
+                         uct_tcp_ep_zcopy_tx_t **ctx_p)
 {
     uct_tcp_am_hdr_t *hdr = NULL;
     uct_tcp_ep_zcopy_tx_t *ctx;
+    size_t payload_iov;
     ucs_status_t status;
 
     UCT_CHECK_IOV_SIZE(iovcnt, iface->config.zcopy.max_iov, name);
@@ -1373,9 +1555,27 @@ uct_tcp_ep_prepare_zcopy(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep, uint8_t am_id
     }
 
     /* User-defined payload */
+    payload_iov   = ctx->iov_cnt;
     ctx->iov_cnt += uct_iovec_fill_iov(&ctx->iov[ctx->iov_cnt], iov,
                                        iovcnt, zcopy_payload_p);
 
+    ctx->comp           = comp;
+    ctx->msg_zcopy_iov  = ctx->iov_cnt;
+    ctx->msg_zcopy_sn   = ep->msg_zcopy.tx_sn;
+    ctx->msg_zcopy_comp = NULL;
+
+    if (*zcopy_payload_p >= ep->msg_zcopy.thresh) {
+        if (comp != NULL) {
+            ctx->msg_zcopy_comp = ucs_malloc(sizeof(*ctx->msg_zcopy_comp),
+                                             "msg_zcopy completion");
+        }
+
+        /* If the completion can't be allocated, send the payload by copy */
+        if ((comp == NULL) || (ctx->msg_zcopy_comp != NULL)) {
+            ctx->msg_zcopy_iov = payload_iov;
+        }
+    }
+
     *ctx_p = ctx;
 
     return UCS_OK;
@@ -1398,8 +1598,8 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
     UCT_CHECK_AM_ID(am_id);
 
     status = uct_tcp_ep_prepare_zcopy(iface, ep, am_id, header, header_length,
-                                      iov, iovcnt, "am_zcopy", &payload_length,
-                                      &ctx);
+                                      iov, iovcnt, "am_zcopy", comp,
+                                      &payload_length, &ctx);
     if (ucs_unlikely(status != UCS_OK)) {
         return status;
     }
@@ -1408,7 +1608,8 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
 
     status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super,
                                  iface->config.rx_seg_size,
-                                 header, ctx->iov, ctx->iov_cnt);
+                                 header, ctx->iov, ctx->iov_cnt,
+                                 ctx->msg_zcopy_iov);
     if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
         goto out;
     }
@@ -1417,13 +1618,14 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
 
     if (uct_tcp_ep_ctx_buf_need_progress(&ep->tx)) {
         uct_tcp_ep_set_outstanding_zcopy(iface, ep, ctx, header,
-                                         header_length, comp);
+                                         header_length);
         return UCS_INPROGRESS;
     }
 
     ucs_assert(status == UCS_OK);
 
 out:
+    status = uct_tcp_ep_zcopy_sent(ep, ctx, status);
     uct_tcp_ep_ctx_reset(&ep->tx);
     return status;
 }
@@ -1444,7 +1646,7 @@ ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
 
     status = uct_tcp_ep_prepare_zcopy(iface, ep, UCT_TCP_EP_PUT_REQ_AM_ID,
                                       &put_req, sizeof(put_req),
-                                      iov, iovcnt, "put_zcopy",
+                                      iov, iovcnt, "put_zcopy", comp,
                                       /* Set a payload length directly to the
                                        * TX length, since PUT Zcopy doesn't
                                        * set the payload length to TCP AM hdr */
@@ -1459,7 +1661,8 @@ ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
     put_req.sn        = ep->tx.put_sn + 1;
 
     status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super, UCT_TCP_EP_PUT_ZCOPY_MAX,
-                                 &put_req, ctx->iov, ctx->iov_cnt);
+                                 &put_req, ctx->iov, ctx->iov_cnt,
+                                 ctx->msg_zcopy_iov);
     if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
         goto out;
     }
@@ -1480,13 +1683,14 @@ ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
 
     if (uct_tcp_ep_ctx_buf_need_progress(&ep->tx)) {
         uct_tcp_ep_set_outstanding_zcopy(iface, ep, ctx, &put_req,
-                                         sizeof(put_req), comp);
+                                         sizeof(put_req));
         return UCS_INPROGRESS;
     }
 
     ucs_assert(status == UCS_OK);
 
 out:
+    status = uct_tcp_ep_zcopy_sent(ep, ctx, status);
     uct_tcp_ep_ctx_reset(&ep->tx);
     return status;
 }
@@ -1517,24 +1721,56 @@ void uct_tcp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_purge_callback_t cb,
 ucs_status_t uct_tcp_ep_flush(uct_ep_h tl_ep, unsigned flags,
                               uct_completion_t *comp)
 {
-    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
-    uct_tcp_ep_put_completion_t *put_comp;
+    uct_tcp_ep_t *ep                              = ucs_derived_of(tl_ep,
+                                                                   uct_tcp_ep_t);
+    uct_tcp_ep_put_completion_t *put_comp         = NULL;
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp = NULL;
+    int wait_put_ack, wait_msg_zcopy;
 
     if (uct_tcp_ep_check_tx_res(ep) == UCS_ERR_NO_RESOURCE) {
         UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
         return UCS_ERR_NO_RESOURCE;
     }
 
-    if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK)) {
+    wait_put_ack   = ep->ctx_caps &
+                     UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK);
+    wait_msg_zcopy = uct_tcp_ep_msg_zcopy_is_pending(ep);
+
+    if (wait_put_ack || wait_msg_zcopy) {
         if (comp != NULL) {
-            put_comp = ucs_calloc(1, sizeof(*put_comp), "put completion");
-            if (put_comp == NULL) {
-                return UCS_ERR_NO_MEMORY;
+            if (wait_put_ack) {
+                put_comp = ucs_calloc(1, sizeof(*put_comp), "put completion");
+                if (put_comp == NULL) {
+                    return UCS_ERR_NO_MEMORY;
+                }
+            }
+
+            if (wait_msg_zcopy) {
+                zcopy_comp = ucs_calloc(1, sizeof(*zcopy_comp),
+                                        "msg_zcopy completion");
+                if (zcopy_comp == NULL) {
+                    ucs_free(put_comp);
+                    return UCS_ERR_NO_MEMORY;
+                }
             }
 
-            put_comp->wait_put_sn = ep->tx.put_sn;
-            put_comp->comp        = comp;
-            ucs_queue_push(&ep->put_comp_q, &put_comp->elem);
+            if (put_comp != NULL) {
+                put_comp->wait_put_sn = ep->tx.put_sn;
+                put_comp->comp        = comp;
+                ucs_queue_push(&ep->put_comp_q, &put_comp->elem);
+            }
+
+            if (zcopy_comp != NULL) {
+                if (put_comp != NULL) {
+                    /* The completion is invoked by both PUT ACK and
+                     * MSG_ZEROCOPY notification */
+                    comp->count++;
+                }
+
+                zcopy_comp->wait_sn = ep->msg_zcopy.tx_sn;
+                zcopy_comp->comp    = comp;
+                ucs_queue_push(&ep->msg_zcopy.comp_q, &zcopy_comp->elem);
+            }
         }
 
         return UCS_INPROGRESS;
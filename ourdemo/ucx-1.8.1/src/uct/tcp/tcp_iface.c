@@ -41,6 +41,13 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "Threshold for switching from send() to sendmsg() for short active messages",
    ucs_offsetof(uct_tcp_iface_config_t, sendv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"MSG_ZCOPY_THRESH", "inf",
+   "Threshold for sending the payload of AM/PUT Zcopy operations with MSG_ZEROCOPY,\n"
+   "so that the kernel doesn't copy the user's buffer. Such operations are\n"
+   "completed when the kernel reports that the buffer is no longer in use.\n"
+   "\"inf\" disables zero-copy send",
+   ucs_offsetof(uct_tcp_iface_config_t, msg_zcopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"PREFER_DEFAULT", "y",
    "Give higher priority to the default network interface on the host",
    ucs_offsetof(uct_tcp_iface_config_t, prefer_default), UCS_CONFIG_TYPE_BOOL},
@@ -76,6 +83,24 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "Socket receive buffer size",
    ucs_offsetof(uct_tcp_iface_config_t, sockopt_rcvbuf), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"IO_URING", "n",
+   "Wait for socket readiness with poll requests batched on an io_uring instance\n"
+   "instead of epoll, so that re-arming and reaping the events of all endpoints\n"
+   "takes at most one system call. Data is still sent and received with\n"
+   "non-blocking send/recv calls on each socket. \"try\" falls back to epoll\n"
+   "if io_uring is not supported by the kernel",
+   ucs_offsetof(uct_tcp_iface_config_t, io_uring.enable), UCS_CONFIG_TYPE_TERNARY},
+
+  {"IO_URING_ENTRIES", "256",
+   "Size of the io_uring submission queue",
+   ucs_offsetof(uct_tcp_iface_config_t, io_uring.entries), UCS_CONFIG_TYPE_UINT},
+
+  {"IO_URING_SQPOLL", "n",
+   "Let a kernel thread poll the io_uring submission queue, so that progress\n"
+   "doesn't issue system calls while the thread is busy. It occupies a CPU core\n"
+   "and may require CAP_SYS_NICE on older kernels",
+   ucs_offsetof(uct_tcp_iface_config_t, io_uring.sq_poll), UCS_CONFIG_TYPE_BOOL},
+
   UCT_IFACE_MPOOL_CONFIG_FIELDS("TX_", -1, 8, "send",
                                 ucs_offsetof(uct_tcp_iface_config_t, tx_mpool), ""),
 
@@ -188,6 +213,16 @@ static ucs_status_t uct_tcp_iface_event_fd_get(uct_iface_h tl_iface, int *fd_p)
     return ucs_event_set_fd_get(iface->event_set, fd_p);
 }
 
+static ucs_status_t uct_tcp_iface_event_arm(uct_iface_h tl_iface,
+                                            unsigned events)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+
+    /* Post the pending changes of the event set before the user starts to
+     * wait on its file descriptor */
+    return ucs_event_set_submit(iface->event_set);
+}
+
 static void uct_tcp_iface_handle_events(void *callback_data,
                                         int events, void *arg)
 {
@@ -196,6 +231,11 @@ static void uct_tcp_iface_handle_events(void *callback_data,
 
     ucs_assertv(ep->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED, "ep=%p", ep);
 
+    /* MSG_ZEROCOPY notifications have to be handled first, since the EP
+     * may be destroyed by RX progress */
+    if ((events & UCS_EVENT_SET_EVERR) && (ep->events & UCS_EVENT_SET_EVERR)) {
+        *count += uct_tcp_ep_progress_msg_zcopy(ep);
+    }
     if (events & UCS_EVENT_SET_EVREAD) {
         *count += uct_tcp_ep_cm_state[ep->conn_state].rx_progress(ep);
     }
@@ -333,7 +373,7 @@ static uct_iface_ops_t uct_tcp_iface_ops = {
     .iface_progress_disable   = uct_base_iface_progress_disable,
     .iface_progress           = uct_tcp_iface_progress,
     .iface_event_fd_get       = uct_tcp_iface_event_fd_get,
-    .iface_event_arm          = ucs_empty_function_return_success,
+    .iface_event_arm          = uct_tcp_iface_event_arm,
     .iface_close              = UCS_CLASS_DELETE_FUNC_NAME(uct_tcp_iface_t),
     .iface_query              = uct_tcp_iface_query,
     .iface_get_address        = uct_tcp_iface_get_address,
@@ -341,6 +381,36 @@ static uct_iface_ops_t uct_tcp_iface_ops = {
     .iface_is_reachable       = uct_tcp_iface_is_reachable
 };
 
+static ucs_status_t
+uct_tcp_iface_event_set_init(uct_tcp_iface_t *iface,
+                             const uct_tcp_iface_config_t *config)
+{
+    ucs_status_t status;
+
+    if (config->io_uring.enable != UCS_NO) {
+        status = ucs_event_set_create_uring(&iface->event_set,
+                                            config->io_uring.entries,
+                                            config->io_uring.sq_poll);
+        if (status == UCS_OK) {
+            return UCS_OK;
+        } else if ((status != UCS_ERR_UNSUPPORTED) ||
+                   (config->io_uring.enable == UCS_YES)) {
+            ucs_error("failed to create io_uring event set for iface %p: %s",
+                      iface, ucs_status_string(status));
+            return status;
+        }
+
+        ucs_debug("iface %p: io_uring is not supported, using epoll", iface);
+    }
+
+    status = ucs_event_set_create(&iface->event_set);
+    if (status != UCS_OK) {
+        return UCS_ERR_IO_ERROR;
+    }
+
+    return UCS_OK;
+}
+
 static ucs_status_t uct_tcp_iface_listener_init(uct_tcp_iface_t *iface)
 {
     struct sockaddr_in bind_addr = iface->config.ifaddr;
@@ -459,6 +529,7 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
 
     self->config.zcopy.max_hdr     = self->config.tx_seg_size -
                                      self->config.zcopy.hdr_offset;
+    self->config.zcopy.msg_zcopy_thresh = config->msg_zcopy_thresh;
     self->config.prefer_default    = config->prefer_default;
     self->config.put_enable        = config->put_enable;
     self->config.conn_nb           = config->conn_nb;
@@ -502,9 +573,8 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
         goto err_cleanup_rx_mpool;
     }
 
-    status = ucs_event_set_create(&self->event_set);
+    status = uct_tcp_iface_event_set_init(self, config);
     if (status != UCS_OK) {
-        status = UCS_ERR_IO_ERROR;
         goto err_cleanup_rx_mpool;
     }
 
@@ -186,6 +186,7 @@ test_perf::test_result test_perf::run_multi_threaded(const test_spec &test, unsi
     params.thread_mode     = UCS_THREAD_MODE_SINGLE;
     params.async_mode      = UCS_ASYNC_THREAD_LOCK_TYPE;
     params.thread_count    = 1;
+    params.ep_count        = 1;
     params.wait_mode       = UCX_PERF_WAIT_MODE_LAST;
     params.flags           = test.test_flags | flags;
     params.am_hdr_size     = 8;
@@ -212,6 +213,7 @@ test_perf::test_result test_perf::run_multi_threaded(const test_spec &test, unsi
     params.iov_stride      = test.msg_stride;
     params.ucp.send_datatype = (ucp_perf_datatype_t)test.data_layout;
     params.ucp.recv_datatype = (ucp_perf_datatype_t)test.data_layout;
+    params.ucp.batch_size    = 16;
 
     thread_arg arg0;
     arg0.params   = params;
@@ -283,3 +283,180 @@ UCS_TEST_P(test_ucp_am, set_am_handler_realloc)
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_am)
+
+
+class test_ucp_am_rndv : public test_ucp_am {
+public:
+    void *rndv_desc;
+    size_t rndv_hdr;
+
+    static ucs_status_t ucp_process_rndv_cb(void *arg, void *data,
+                                            size_t length,
+                                            ucp_ep_h reply_ep,
+                                            unsigned flags)
+    {
+        test_ucp_am_rndv *self = reinterpret_cast<test_ucp_am_rndv*>(arg);
+
+        EXPECT_TRUE(flags & UCP_CB_PARAM_FLAG_RNDV);
+        EXPECT_EQ(sizeof(self->rndv_hdr), length);
+        memcpy(&self->rndv_hdr, data, sizeof(self->rndv_hdr));
+
+        self->rndv_desc = data;
+        self->recv_ams++;
+        return UCS_INPROGRESS;
+    }
+
+protected:
+    void do_send_rndv_test(int drop)
+    {
+        size_t max_size = pow(2, NUM_MESSAGES + 3);
+        std::vector<char> sbuf(max_size);
+        std::vector<char> rbuf(max_size);
+        ucs_status_ptr_t sreq, rreq;
+
+        ucp_worker_set_am_handler(receiver().worker(), UCP_SEND_ID,
+                                  ucp_process_rndv_cb, this,
+                                  UCP_AM_FLAG_WHOLE_MSG);
+        recv_ams = 0;
+
+        for (size_t size = 1; size <= max_size; size *= 4) {
+            size_t hdr = size;
+
+            std::fill(sbuf.begin(), sbuf.begin() + size, (char)size);
+            std::fill(rbuf.begin(), rbuf.end(), 'r');
+
+            rndv_desc = NULL;
+            sreq      = ucp_am_send_rndv_nb(receiver().ep(), UCP_SEND_ID,
+                                            &hdr, sizeof(hdr), sbuf.data(),
+                                            size, ucp_dt_make_contig(1),
+                                            (ucp_send_callback_t)
+                                            ucs_empty_function, 0);
+            ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+
+            while (rndv_desc == NULL) {
+                progress();
+            }
+            EXPECT_EQ(size, rndv_hdr);
+
+            if (drop) {
+                ucp_am_data_release(receiver().worker(), rndv_desc);
+            } else {
+                rreq = ucp_am_rndv_recv_nb(receiver().worker(), rndv_desc,
+                                           rbuf.data(), size,
+                                           ucp_dt_make_contig(1),
+                                           (ucp_tag_recv_callback_t)
+                                           ucs_empty_function);
+                ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+                wait(rreq);
+                EXPECT_TRUE(std::equal(sbuf.begin(), sbuf.begin() + size,
+                                       rbuf.begin()));
+            }
+
+            wait(sreq);
+        }
+    }
+};
+
+UCS_TEST_P(test_ucp_am_rndv, send_recv_rndv)
+{
+    do_send_rndv_test(0);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_drop_rndv)
+{
+    do_send_rndv_test(1);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_rndv)
+
+
+/* ucp_am_send_nb switches to rendezvous above RNDV_THRESH. A callback
+ * without UCP_AM_FLAG_RNDV still gets the whole payload, one with it gets
+ * the descriptor and fetches the payload itself */
+class test_ucp_am_auto_rndv : public test_ucp_am_rndv {
+public:
+    virtual void init() {
+        modify_config("RNDV_THRESH", "4096");
+        test_ucp_am_rndv::init();
+    }
+
+    static ucs_status_t ucp_process_auto_rndv_cb(void *arg, void *data,
+                                                 size_t length,
+                                                 ucp_ep_h reply_ep,
+                                                 unsigned flags)
+    {
+        test_ucp_am_rndv *self = reinterpret_cast<test_ucp_am_rndv*>(arg);
+
+        if (flags & UCP_CB_PARAM_FLAG_RNDV) {
+            EXPECT_EQ(0ul, length);
+            self->rndv_desc = data;
+            return UCS_INPROGRESS;
+        }
+
+        return self->am_handler(self, data, length, flags);
+    }
+
+protected:
+    void do_send_auto_rndv_test(uint32_t handler_flags)
+    {
+        size_t max_size = 65536;
+        std::vector<char> sbuf(max_size);
+        std::vector<char> rbuf(max_size);
+        ucs_status_ptr_t sreq, rreq;
+        size_t size;
+
+        ucp_worker_set_am_handler(receiver().worker(), UCP_SEND_ID,
+                                  ucp_process_auto_rndv_cb, this,
+                                  UCP_AM_FLAG_WHOLE_MSG | handler_flags);
+        recv_ams = 0;
+        release  = 0;
+
+        for (size = 1024; size <= max_size; size *= 4) {
+            std::fill(sbuf.begin(), sbuf.begin() + size, (char)size);
+
+            rndv_desc = NULL;
+            sreq      = ucp_am_send_nb(receiver().ep(), UCP_SEND_ID,
+                                       sbuf.data(), size,
+                                       ucp_dt_make_contig(1),
+                                       (ucp_send_callback_t)
+                                       ucs_empty_function, 0);
+            ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+
+            while ((recv_ams == 0) && (rndv_desc == NULL)) {
+                progress();
+            }
+
+            if (rndv_desc != NULL) {
+                EXPECT_GE(size, 4096ul);
+                EXPECT_EQ(size, ucp_am_rndv_get_length(rndv_desc));
+                std::fill(rbuf.begin(), rbuf.end(), 'r');
+                rreq = ucp_am_rndv_recv_nb(receiver().worker(), rndv_desc,
+                                           rbuf.data(), size,
+                                           ucp_dt_make_contig(1),
+                                           (ucp_tag_recv_callback_t)
+                                           ucs_empty_function);
+                ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+                wait(rreq);
+                EXPECT_TRUE(std::equal(sbuf.begin(), sbuf.begin() + size,
+                                       rbuf.begin()));
+            } else {
+                EXPECT_EQ(1, recv_ams);
+                recv_ams = 0;
+            }
+
+            wait(sreq);
+        }
+    }
+};
+
+UCS_TEST_P(test_ucp_am_auto_rndv, send_whole_msg)
+{
+    do_send_auto_rndv_test(0);
+}
+
+UCS_TEST_P(test_ucp_am_auto_rndv, send_rndv_desc)
+{
+    do_send_auto_rndv_test(UCP_AM_FLAG_RNDV);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_auto_rndv)
@@ -6,9 +6,13 @@
 
 #include "ucp_test.h"
 extern "C" {
+#include <ucp/core/ucp_context.h>
+#include <ucp/core/ucp_ep.inl>
 #include <ucs/sys/sys.h>
 }
 
+#include <fstream>
+
 
 class test_ucp_context : public ucp_test {
 public:
@@ -108,3 +112,118 @@ UCS_TEST_P(test_ucp_version, version_string) {
 }
 
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_version, all, "all")
+
+
+class test_ucp_thresh_profile : public test_ucp_context {
+public:
+    test_ucp_thresh_profile() {
+        std::stringstream ss;
+        ss << "/tmp/ucx_thresh_profile_" << getpid() << ".txt";
+        m_file_name = ss.str();
+    }
+
+    virtual void cleanup() {
+        test_ucp_context::cleanup();
+        unlink(m_file_name.c_str());
+    }
+
+protected:
+    std::string m_file_name;
+};
+
+UCS_TEST_P(test_ucp_thresh_profile, load) {
+    static const size_t zcopy_thresh = 12345;
+    ucp_context_h context            = sender().ucph();
+
+    {
+        std::ofstream f(m_file_name.c_str());
+        f << "# comment" << std::endl << std::endl;
+        for (ucp_rsc_index_t i = 0; i < context->num_tls; ++i) {
+            f << context->tl_rscs[i].tl_rsc.tl_name << "/"
+              << context->tl_rscs[i].tl_rsc.dev_name
+              << " zcopy_thresh=" << zcopy_thresh << " rndv_thresh=inf"
+              << std::endl;
+        }
+    }
+
+    modify_config("THRESH_PROFILE", m_file_name);
+    entity *e = create_entity();
+    context   = e->ucph();
+
+    for (ucp_rsc_index_t i = 0; i < context->num_tls; ++i) {
+        EXPECT_EQ(zcopy_thresh, context->config.tl_thresh[i].zcopy);
+        EXPECT_EQ(UCS_MEMUNITS_INF, context->config.tl_thresh[i].rndv);
+    }
+
+    e->connect(e, get_ep_params());
+
+    const ucp_ep_config_t *config = ucp_ep_config(e->ep());
+    if (config->am.zcopy_thresh[0] != SIZE_MAX) {
+        EXPECT_EQ(zcopy_thresh,     config->am.zcopy_thresh[0]);
+        EXPECT_EQ(2 * zcopy_thresh, config->am.zcopy_thresh[1]);
+    }
+}
+
+UCS_TEST_P(test_ucp_thresh_profile, calibrate, "THRESH_CALIBRATE=y") {
+    modify_config("THRESH_PROFILE", m_file_name);
+    ucp_context_h context = create_entity()->ucph();
+
+    /* every resource which may carry data is listed in the file */
+    std::ifstream f(m_file_name.c_str());
+    ASSERT_TRUE(f.good());
+
+    std::string contents((std::istreambuf_iterator<char>(f)),
+                         std::istreambuf_iterator<char>());
+    for (ucp_rsc_index_t i = 0; i < context->num_tls; ++i) {
+        if (context->tl_rscs[i].flags & (UCP_TL_RSC_FLAG_AUX |
+                                         UCP_TL_RSC_FLAG_SOCKADDR)) {
+            continue;
+        }
+
+        std::string name = std::string(context->tl_rscs[i].tl_rsc.tl_name) +
+                           "/" + context->tl_rscs[i].tl_rsc.dev_name;
+        EXPECT_NE(std::string::npos, contents.find(name)) << name;
+    }
+
+    /* a later context loads the same thresholds */
+    entity *e = create_entity();
+    for (ucp_rsc_index_t i = 0; i < context->num_tls; ++i) {
+        EXPECT_EQ(context->config.tl_thresh[i].zcopy,
+                  e->ucph()->config.tl_thresh[i].zcopy);
+        EXPECT_EQ(context->config.tl_thresh[i].rndv,
+                  e->ucph()->config.tl_thresh[i].rndv);
+    }
+}
+
+UCS_TEST_P(test_ucp_thresh_profile, calibrate_on_worker_create,
+           "THRESH_CALIBRATE=y") {
+    modify_config("THRESH_PROFILE", m_file_name);
+
+    std::string tls;
+    for (size_t i = 0; i < GetParam().transports.size(); ++i) {
+        tls += (i ? "," : "") + GetParam().transports[i];
+    }
+    modify_config("TLS", tls);
+
+    ucs::handle<ucp_context_h> context;
+    UCS_TEST_CREATE_HANDLE(ucp_context_h, context, ucp_cleanup, ucp_init,
+                           &GetParam().ctx_params, m_ucp_config);
+
+    /* nothing is measured before the context is complete */
+    EXPECT_NE(0, access(m_file_name.c_str(), F_OK));
+    EXPECT_TRUE(context.get()->config.thresh_calib_file != NULL);
+
+    ucp_worker_params_t worker_params;
+    worker_params.field_mask = 0;
+
+    ucs::handle<ucp_worker_h> worker;
+    UCS_TEST_CREATE_HANDLE(ucp_worker_h, worker, ucp_worker_destroy,
+                           ucp_worker_create, context, &worker_params);
+
+    EXPECT_EQ(0, access(m_file_name.c_str(), F_OK));
+    EXPECT_TRUE(context.get()->config.thresh_calib_file == NULL);
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_thresh_profile, self, "self")
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_thresh_profile, shm, "shm")
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_thresh_profile, tcp, "tcp")
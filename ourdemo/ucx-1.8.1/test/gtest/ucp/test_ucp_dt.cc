@@ -46,3 +46,64 @@ UCS_TEST_F(test_ucp_dt_iov, seek)
         }
     }
 }
+
+class test_ucp_dt_strided : public ucs::test {
+protected:
+    /* pack by a byte-by-byte reference implementation */
+    void pack_ref(std::vector<char> &packed, const std::vector<char> &buffer,
+                  size_t elem_size, size_t stride) {
+        for (size_t i = 0; i < packed.size(); ++i) {
+            packed[i] = buffer[(i / elem_size) * stride + (i % elem_size)];
+        }
+    }
+};
+
+UCS_TEST_F(test_ucp_dt_strided, pack_unpack)
+{
+    static const size_t elem_sizes[] = {1, 2, 4, 8, 16, 32, 3, 24, 100};
+
+    for (size_t e = 0; e < ucs_static_array_size(elem_sizes); ++e) {
+        size_t elem_size = elem_sizes[e];
+        size_t stride    = elem_size + (ucs::rand() % 3) * elem_size +
+                           (ucs::rand() % 7);
+        size_t count     = (ucs::rand() % 100) + 1;
+        ucp_datatype_t datatype = ucp_dt_make_strided(elem_size, stride);
+
+        ASSERT_EQ(elem_size, ucp_dt_strided_elem_size(datatype));
+        ASSERT_EQ(stride, ucp_dt_strided_stride(datatype));
+
+        std::vector<char> buffer(count * stride);
+        std::vector<char> expected(count * elem_size);
+        std::vector<char> packed(count * elem_size);
+        ucs::fill_random(buffer);
+        pack_ref(expected, buffer, elem_size, stride);
+
+        EXPECT_EQ(expected.size(), ucp_dt_strided_length(datatype, count));
+        EXPECT_EQ((count - 1) * stride + elem_size,
+                  ucp_dt_strided_extent(datatype, expected.size()));
+
+        /* pack in fragments of random size, not aligned to elements */
+        size_t offset = 0;
+        while (offset < packed.size()) {
+            size_t length = ucs_min((size_t)(ucs::rand() % (3 * elem_size)) + 1,
+                                    packed.size() - offset);
+            ucp_dt_strided_gather(&packed[offset], &buffer[0], datatype, length,
+                                  offset);
+            offset += length;
+        }
+        EXPECT_EQ(expected, packed);
+
+        /* unpack the fragments in reverse order */
+        std::vector<char> unpacked(buffer.size(), 0);
+        offset = packed.size();
+        while (offset > 0) {
+            size_t length = ucs_min((size_t)(ucs::rand() % (3 * elem_size)) + 1,
+                                    offset);
+            offset -= length;
+            ucp_dt_strided_scatter(&unpacked[0], &packed[offset], datatype,
+                                   length, offset);
+        }
+        pack_ref(packed, unpacked, elem_size, stride);
+        EXPECT_EQ(expected, packed);
+    }
+}
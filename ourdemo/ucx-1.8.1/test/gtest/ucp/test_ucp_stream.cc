@@ -564,6 +564,43 @@ UCS_TEST_P(test_ucp_stream, send_zero_ending_iov_recv_data) {
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_stream)
 
+class test_ucp_stream_rndv : public test_ucp_stream
+{
+public:
+    virtual void init() {
+        modify_config("STREAM_RNDV_THRESH", "16k");
+        test_ucp_stream::init();
+    }
+};
+
+UCS_TEST_P(test_ucp_stream_rndv, send_recv_data) {
+    do_send_recv_data_test(DATATYPE);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, send_recv_8) {
+    ucp_datatype_t datatype = ucp_dt_make_contig(sizeof(uint8_t));
+
+    do_send_recv_test<uint8_t, 0>(datatype);
+    do_send_recv_test<uint8_t, UCP_STREAM_RECV_FLAG_WAITALL>(datatype);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, send_recv_iov) {
+    do_send_recv_test<uint8_t, UCP_STREAM_RECV_FLAG_WAITALL>(DATATYPE_IOV);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, send_exp_recv_64) {
+    ucp_datatype_t datatype = ucp_dt_make_contig(sizeof(uint64_t));
+
+    do_send_exp_recv_test<uint64_t, 0>(datatype);
+    do_send_exp_recv_test<uint64_t, UCP_STREAM_RECV_FLAG_WAITALL>(datatype);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, send_exp_recv_iov) {
+    do_send_exp_recv_test<uint8_t, UCP_STREAM_RECV_FLAG_WAITALL>(DATATYPE_IOV);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_stream_rndv)
+
 class test_ucp_stream_many2one : public test_ucp_stream_base {
 protected:
     struct request_wrapper_t {
@@ -450,6 +450,96 @@ UCS_TEST_P(test_ucp_tag_match, sync_send_unexp) {
     request_release(my_send_req);
 }
 
+UCS_TEST_P(test_ucp_tag_match, send_batch_recv_unexp) {
+    const unsigned        num_msgs   = 100;
+    const size_t          large_size = 100000;
+    std::vector<uint64_t> send_data(num_msgs);
+    std::vector<char>     large_send(large_size), large_recv(large_size);
+    std::vector<ucp_send_batch_elem_t> elems(num_msgs + 1);
+    ucp_tag_recv_info_t   info;
+    ucs_status_t          status;
+    uint64_t              recv_data;
+
+    /* Small messages with a large one in the middle, which is not packed */
+    for (unsigned i = 0; i < elems.size(); ++i) {
+        elems[i].ep    = sender().ep();
+        elems[i].tag   = 0x1000 + i;
+        elems[i].am_id = 0;
+        if (i == (num_msgs / 2)) {
+            ucs::fill_random(large_send);
+            elems[i].buffer = &large_send[0];
+            elems[i].length = large_size;
+        } else {
+            send_data[i % num_msgs] = ucs::rand();
+            elems[i].buffer = &send_data[i % num_msgs];
+            elems[i].length = sizeof(uint64_t);
+        }
+    }
+
+    request *my_send_req = (request*)ucp_tag_send_batch_nb(&elems[0],
+                                                           elems.size(),
+                                                           send_callback);
+    ASSERT_UCS_PTR_OK(my_send_req);
+
+    short_progress_loop(); /* Receive messages as unexpected */
+
+    for (unsigned i = 0; i < elems.size(); ++i) {
+        if (i == (num_msgs / 2)) {
+            status = recv_b(&large_recv[0], large_size, DATATYPE, 0x1000 + i,
+                            (ucp_tag_t)-1, &info);
+            ASSERT_UCS_OK(status);
+            EXPECT_EQ(large_size, info.length);
+            EXPECT_EQ(large_send, large_recv);
+        } else {
+            recv_data = 0;
+            status    = recv_b(&recv_data, sizeof(recv_data), DATATYPE,
+                               0x1000 + i, (ucp_tag_t)-1, &info);
+            ASSERT_UCS_OK(status);
+            EXPECT_EQ(sizeof(recv_data), info.length);
+            EXPECT_EQ(send_data[i % num_msgs], recv_data);
+        }
+        EXPECT_EQ(elems[i].tag, info.sender_tag);
+    }
+
+    wait_and_validate(my_send_req);
+}
+
+UCS_TEST_P(test_ucp_tag_match, send_batch_recv_exp) {
+    const unsigned        num_msgs = 64;
+    std::vector<uint64_t> send_data(num_msgs), recv_data(num_msgs, 0);
+    std::vector<ucp_send_batch_elem_t> elems(num_msgs);
+    std::vector<request*> recv_reqs(num_msgs);
+
+    for (unsigned i = 0; i < num_msgs; ++i) {
+        send_data[i]    = ucs::rand();
+        elems[i].ep     = sender().ep();
+        elems[i].buffer = &send_data[i];
+        elems[i].length = sizeof(uint64_t);
+        elems[i].tag    = 0x111337;
+        elems[i].am_id  = 0;
+        recv_reqs[i]    = recv_nb(&recv_data[i], sizeof(uint64_t), DATATYPE,
+                                  0x1337, 0xffff);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(recv_reqs[i]));
+        ASSERT_TRUE(recv_reqs[i] != NULL);
+    }
+
+    request *my_send_req = (request*)ucp_tag_send_batch_nb(&elems[0],
+                                                           elems.size(),
+                                                           send_callback);
+    ASSERT_UCS_PTR_OK(my_send_req);
+
+    /* Messages are matched in the order they were passed to the batch */
+    for (unsigned i = 0; i < num_msgs; ++i) {
+        wait(recv_reqs[i]);
+        EXPECT_EQ(UCS_OK, recv_reqs[i]->status);
+        EXPECT_EQ(sizeof(uint64_t), recv_reqs[i]->info.length);
+        EXPECT_EQ(send_data[i], recv_data[i]);
+        request_release(recv_reqs[i]);
+    }
+
+    wait_and_validate(my_send_req);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_match)
 
 class test_ucp_tag_match_rndv : public test_ucp_tag_match {
@@ -87,4 +87,31 @@ UCS_TEST_P(test_ucp_tag_mt, send_recv) {
 #endif
 }
 
+UCS_TEST_P(test_ucp_tag_mt, send_recv_nb_release) {
+#if _OPENMP && ENABLE_MT
+    static const int num_msgs = 100;
+
+#pragma omp parallel for
+    for (int i = 0; i < MT_TEST_NUM_THREADS; i++) {
+        uint64_t send_data, recv_data;
+        request *rreq;
+
+        /* Receive requests are released by all threads concurrently, while
+         * other threads are progressing the same worker */
+        for (int j = 0; j < num_msgs; j++) {
+            send_data = (uint64_t)i * num_msgs + j;
+            recv_data = 0;
+
+            rreq = recv_nb(&recv_data, sizeof(recv_data), DATATYPE, 0x1337 + i,
+                           0xffff, i);
+            send_b(&send_data, sizeof(send_data), DATATYPE, 0x1337 + i, i);
+            wait(rreq, i);
+
+            EXPECT_EQ(send_data, recv_data);
+            request_release(rreq);
+        }
+    }
+#endif
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_mt)
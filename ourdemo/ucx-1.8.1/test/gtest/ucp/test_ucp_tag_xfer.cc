@@ -114,6 +114,7 @@ public:
     void test_xfer_contig(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_generic(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_iov(size_t size, bool expected, bool sync, bool truncated);
+    void test_xfer_strided(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_generic_err(size_t size, bool expected, bool sync, bool truncated);
 
 protected:
@@ -415,6 +416,45 @@ void test_ucp_tag_xfer::test_xfer_iov(size_t size, bool expected, bool sync,
                                "IOV"));
 }
 
+void test_ucp_tag_xfer::test_xfer_strided(size_t size, bool expected, bool sync,
+                                          bool truncated)
+{
+    /* about 64 elements, so large messages are sent by zcopy fragments */
+    const size_t elem_size   = ucs_max(size / 64, 1ul);
+    const size_t send_stride = elem_size * 2 + 3;
+    const size_t recv_stride = elem_size + 5;
+    const size_t count       = size / elem_size;
+    std::vector<char> sendbuf(count * send_stride, 0);
+    std::vector<char> recvbuf(count * recv_stride, 0);
+    std::vector<char> send_packed, recv_packed;
+
+    /* if count is zero, truncation has no effect */
+    if ((truncated) && (!count)) {
+        truncated = false;
+    }
+
+    ucs::fill_random(sendbuf);
+
+    size_t recvd = do_xfer(sendbuf.data(), recvbuf.data(), count,
+                           ucp_dt_make_strided(elem_size, send_stride),
+                           ucp_dt_make_strided(elem_size, recv_stride),
+                           expected, sync, truncated);
+    if (!truncated) {
+        ASSERT_EQ(count * elem_size, recvd);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        send_packed.insert(send_packed.end(),
+                           sendbuf.begin() + (i * send_stride),
+                           sendbuf.begin() + (i * send_stride) + elem_size);
+        recv_packed.insert(recv_packed.end(),
+                           recvbuf.begin() + (i * recv_stride),
+                           recvbuf.begin() + (i * recv_stride) + elem_size);
+    }
+    EXPECT_TRUE(!check_buffers(send_packed, recv_packed, recvd, count, count,
+                               size, expected, sync, "strided"));
+}
+
 void test_ucp_tag_xfer::test_xfer_generic_err(size_t size, bool expected,
                                               bool sync, bool truncated)
 {
@@ -608,6 +648,22 @@ UCS_TEST_P(test_ucp_tag_xfer, iov_unexp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_iov, false, false, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_truncated) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, true);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_unexp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_zcopy, "ZCOPY_THRESH=1000") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, false);
+}
+
 UCS_TEST_P(test_ucp_tag_xfer, generic_err_exp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_generic_err, true, false, false);
 }
@@ -666,6 +722,13 @@ UCS_TEST_P(test_ucp_tag_xfer, iov_unexp_sync) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_iov, false, true, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_sync) {
+    /* because ucp_tag_send_req return status (instead request) if send operation
+     * completed immediately */
+    skip_loopback();
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, true, false);
+}
+
 /* send_contig_recv_contig */
 
 UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_exp, "RNDV_THRESH=1248576") {
@@ -19,6 +19,7 @@ static const int   UCS_EVENT_SET_EXTRA_NUM    = 0xFF;
 
 enum {
     UCS_EVENT_SET_EXTERNAL_FD = UCS_BIT(0),
+    UCS_EVENT_SET_URING       = UCS_BIT(1)
 };
 
 class test_event_set : public ucs::test_base,
@@ -77,6 +78,19 @@ protected:
         ucs_status_t status;
         int ret;
 
+        if (GetParam() & UCS_EVENT_SET_EXTERNAL_FD) {
+            status = ucs_event_set_create_from_fd(&m_event_set, m_ext_fd);
+        } else if (GetParam() & UCS_EVENT_SET_URING) {
+            status = ucs_event_set_create_uring(&m_event_set, 16, 0);
+            if (status == UCS_ERR_UNSUPPORTED) {
+                UCS_TEST_SKIP_R("io_uring is not supported");
+            }
+        } else {
+            status = ucs_event_set_create(&m_event_set);
+        }
+        ASSERT_UCS_OK(status);
+        EXPECT_TRUE(m_event_set != NULL);
+
         if (pipe(m_pipefd) == -1) {
             UCS_TEST_ABORT("pipe() failed with error - " <<
                            strerror(errno));
@@ -93,14 +107,6 @@ protected:
             UCS_TEST_ABORT("pthread_create() failed with error - " <<
                            strerror(errno));
         }
-
-        if (GetParam() & UCS_EVENT_SET_EXTERNAL_FD) {
-            status = ucs_event_set_create_from_fd(&m_event_set, m_ext_fd);
-        } else {
-            status = ucs_event_set_create(&m_event_set);
-        }
-        ASSERT_UCS_OK(status);
-        EXPECT_TRUE(m_event_set != NULL);
     }
 
     void event_set_cleanup() {
@@ -256,18 +262,21 @@ UCS_TEST_P(test_event_set, ucs_event_set_trig_modes) {
         event_set_wait(1u, 0, event_set_func4, NULL);
     }
 
-    /* Test edge-triggered mode */
-    /* Set edge-triggered mode */
-    event_set_ctl(EVENT_SET_OP_MOD, m_pipefd[0],
-                  (ucs_event_set_type_t)(UCS_EVENT_SET_EVREAD |
-                                         UCS_EVENT_SET_EDGE_TRIGGERED));
+    /* Test edge-triggered mode, io_uring event set supports level-triggered
+     * mode only */
+    if (!(GetParam() & UCS_EVENT_SET_URING)) {
+        /* Set edge-triggered mode */
+        event_set_ctl(EVENT_SET_OP_MOD, m_pipefd[0],
+                      (ucs_event_set_type_t)(UCS_EVENT_SET_EVREAD |
+                                             UCS_EVENT_SET_EDGE_TRIGGERED));
 
-    /* Should have only one event to read */
-    event_set_wait(1u, 0, event_set_func4, NULL);
+        /* Should have only one event to read */
+        event_set_wait(1u, 0, event_set_func4, NULL);
 
-    /* Should not read nothing */
-    for (int i = 0; i < 10; i++) {
-        event_set_wait(0u, 0, event_set_func1, arg);
+        /* Should not read nothing */
+        for (int i = 0; i < 10; i++) {
+            event_set_wait(0u, 0, event_set_func1, arg);
+        }
     }
 
     /* Call the function below directly to read
@@ -282,3 +291,6 @@ INSTANTIATE_TEST_CASE_P(ext_fd, test_event_set,
                         ::testing::Values(static_cast<int>(
                                               UCS_EVENT_SET_EXTERNAL_FD)));
 INSTANTIATE_TEST_CASE_P(int_fd, test_event_set, ::testing::Values(0));
+INSTANTIATE_TEST_CASE_P(uring, test_event_set,
+                        ::testing::Values(static_cast<int>(
+                                              UCS_EVENT_SET_URING)));
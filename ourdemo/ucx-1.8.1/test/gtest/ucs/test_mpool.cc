@@ -201,3 +201,103 @@ UCS_TEST_F(test_mpool, infinite) {
 
     ucs_mpool_cleanup(&mp, 1);
 }
+
+UCS_TEST_F(test_mpool, thread_cache) {
+    static const unsigned max_elems = 18;
+    ucs_status_t status;
+    ucs_mpool_t mp;
+
+    ucs_mpool_ops_t ops = {
+       ucs_mpool_chunk_mmap_numa,
+       ucs_mpool_chunk_munmap,
+       NULL,
+       NULL
+    };
+
+    status = ucs_mpool_init(&mp, 0, header_size + data_size, header_size, align,
+                            6, max_elems, &ops, "test");
+    ASSERT_UCS_OK(status);
+
+    status = ucs_mpool_thread_cache_enable(&mp, 4);
+    ASSERT_UCS_OK(status);
+
+    for (unsigned loop = 0; loop < 10; ++loop) {
+        std::vector<void*> objs;
+        for (unsigned i = 0; i < max_elems; ++i) {
+            void *ptr = ucs_mpool_get(&mp);
+            ASSERT_TRUE(ptr != NULL);
+            ASSERT_EQ(0ul, ((uintptr_t)ptr + header_size) % align) << ptr;
+            memset(ptr, 0xAA, header_size + data_size);
+            objs.push_back(ptr);
+        }
+
+        ASSERT_TRUE(NULL == ucs_mpool_get(&mp));
+        EXPECT_TRUE(ucs_mpool_is_empty(&mp));
+
+        for (std::vector<void*>::iterator iter = objs.begin(); iter != objs.end(); ++iter) {
+            ucs_mpool_put(*iter);
+        }
+    }
+
+    ucs_mpool_cleanup(&mp, 1);
+}
+
+class test_mpool_thread_cache : public test_mpool {
+protected:
+    static const unsigned num_threads = 4;
+
+    static void *thread_func(void *arg) {
+        ucs_mpool_t *mp = (ucs_mpool_t*)arg;
+        unsigned seed   = (uintptr_t)pthread_self();
+        std::vector<void*> objs;
+
+        for (unsigned i = 0; i < 10000 / ucs::test_time_multiplier(); ++i) {
+            unsigned count = 1 + (rand_r(&seed) % 64);
+            for (unsigned j = 0; j < count; ++j) {
+                void *ptr = ucs_mpool_get(mp);
+                EXPECT_TRUE(ptr != NULL);
+                *(pthread_t*)ptr = pthread_self();
+                objs.push_back(ptr);
+            }
+
+            while (!objs.empty()) {
+                /* Check no other thread got the same object */
+                EXPECT_TRUE(pthread_equal(pthread_self(), *(pthread_t*)objs.back()));
+                ucs_mpool_put(objs.back());
+                objs.pop_back();
+            }
+        }
+        return NULL;
+    }
+};
+
+UCS_TEST_F(test_mpool_thread_cache, mt) {
+    pthread_t threads[num_threads];
+    ucs_status_t status;
+    ucs_mpool_t mp;
+
+    ucs_mpool_ops_t ops = {
+       ucs_mpool_chunk_malloc,
+       ucs_mpool_chunk_free,
+       NULL,
+       NULL
+    };
+
+    status = ucs_mpool_init(&mp, 0, data_size, 0, align, 32, UINT_MAX, &ops,
+                            "test");
+    ASSERT_UCS_OK(status);
+
+    status = ucs_mpool_thread_cache_enable(&mp, 16);
+    ASSERT_UCS_OK(status);
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+        pthread_create(&threads[i], NULL, thread_func, &mp);
+    }
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* Elements cached by the exited threads must be back in the pool */
+    ucs_mpool_cleanup(&mp, 1);
+}
@@ -13,6 +13,7 @@ extern "C" {
 
 #include <pthread.h>
 #include <fstream>
+#include <map>
 
 #if HAVE_PROFILING
 
@@ -330,6 +331,71 @@ UCS_TEST_P(test_profile, log_accum) {
             "log,accum");
 }
 
+UCS_TEST_P(test_profile, log_wraparound) {
+    const int ITER           = 5;
+    const size_t LOG_SIZE    = 1024;
+    uint64_t exp_num_records = LOG_SIZE / sizeof(ucs_profile_record_t);
+
+    scoped_profile p(*this, PROFILE_FILENAME, "log");
+    modify_config("PROFILE_LOG_SIZE", ucs::to_string(LOG_SIZE).c_str());
+    ASSERT_LT(exp_num_records, NUM_LOCAITONS * ITER);
+    run_profiled_code(ITER);
+
+    std::string data = p.read();
+    const ucs_profile_header_t *hdr =
+                    reinterpret_cast<const ucs_profile_header_t*>(&data[0]);
+    const ucs_profile_location_t *locations =
+                    reinterpret_cast<const ucs_profile_location_t*>(hdr + 1);
+    const void *ptr = locations + hdr->num_locations;
+
+    for (int i = 0; i < num_threads(); ++i) {
+        const ucs_profile_thread_header_t *thread_hdr =
+                        reinterpret_cast<const ucs_profile_thread_header_t*>(ptr);
+        EXPECT_EQ(exp_num_records, thread_hdr->num_records);
+
+        /* Only the most recent records are kept, oldest first */
+        const ucs_profile_record_t *records =
+                        reinterpret_cast<const ucs_profile_record_t*>(thread_hdr + 1);
+        for (uint64_t j = 1; j < thread_hdr->num_records; ++j) {
+            EXPECT_LT(records[j].location, hdr->num_locations);
+            EXPECT_GE(records[j].timestamp, records[j - 1].timestamp);
+        }
+
+        ptr = records + thread_hdr->num_records;
+    }
+
+    EXPECT_EQ(&data[data.size()], ptr) << data.size();
+}
+
+UCS_TEST_P(test_profile, chrome_trace) {
+    const int ITER = 5;
+
+    scoped_profile p(*this, PROFILE_FILENAME, "log");
+    modify_config("PROFILE_FORMAT", "chrome");
+    run_profiled_code(ITER);
+
+    std::string data = p.read();
+    EXPECT_EQ(0ul, data.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    EXPECT_EQ(data.size() - 4, data.rfind("\n]}\n"));
+
+    std::map<std::string, int> counts;
+    counts["\"ph\":\"X\",\"name\":\"profile_test_func1\""] = 0;
+    counts["\"ph\":\"X\",\"name\":\"code\""]               = 0;
+    counts["\"ph\":\"i\",\"name\":\"sample\""]             = 0;
+    counts["\"ph\":\"b\",\"name\":\"request\""]            = 0;
+    counts["\"ph\":\"n\",\"name\":\"work\""]               = 0;
+    counts["\"ph\":\"e\",\"name\":\"request\""]            = 0;
+
+    for (std::map<std::string, int>::iterator iter = counts.begin();
+         iter != counts.end(); ++iter) {
+        for (size_t pos = data.find(iter->first); pos != std::string::npos;
+             pos = data.find(iter->first, pos + 1)) {
+            ++iter->second;
+        }
+        EXPECT_EQ(ITER * num_threads(), iter->second) << iter->first;
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(st, test_profile, ::testing::Values(1));
 INSTANTIATE_TEST_CASE_P(mt, test_profile, ::testing::Values(2, 4, 8));
 
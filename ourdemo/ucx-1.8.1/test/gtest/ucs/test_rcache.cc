@@ -539,6 +539,50 @@ UCS_MT_TEST_F(test_rcache, shared_region, 6) {
     shared_free(mem);
 }
 
+UCS_MT_TEST_F(test_rcache, thread_cache_unmap, 6) {
+    static const size_t size = 1 * 1024 * 1024;
+    uint32_t id, refcount;
+    region *region;
+
+    if (barrier()) {
+        m_ptr = alloc_pages(size, PROT_READ|PROT_WRITE);
+    }
+    barrier();
+
+    /* The put gives the reference back to the per-thread lookup table */
+    region = get(m_ptr, size);
+    id     = region->id;
+    put(region);
+    barrier();
+
+    /* Second get should be found in the per-thread lookup table, and take
+     * that reference instead of one from the shared refcount */
+    refcount = region->super.refcount;
+    barrier();
+    region = get(m_ptr, size);
+    EXPECT_EQ(id, region->id);
+    barrier();
+    EXPECT_EQ(refcount, region->super.refcount);
+    barrier();
+    put(region);
+
+    /* Unmap the memory while all threads have the region cached */
+    barrier();
+    if (barrier()) {
+        munmap(m_ptr, size);
+        m_ptr = alloc_pages(size, PROT_READ|PROT_WRITE);
+    }
+    barrier();
+
+    region = get(m_ptr, size);
+    EXPECT_NE(id, region->id);
+    put(region);
+
+    if (barrier()) {
+        munmap(m_ptr, size);
+    }
+}
+
 class test_rcache_no_register : public test_rcache {
 protected:
     bool m_fail_reg;
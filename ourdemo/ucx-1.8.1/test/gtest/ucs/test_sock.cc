@@ -262,6 +262,79 @@ UCS_TEST_F(test_socket, socket_setopt) {
     close(fd);
 }
 
+UCS_TEST_F(test_socket, socket_sendv_zcopy) {
+    const size_t length = 64 * UCS_KBYTE;
+    struct sockaddr_in saddr;
+    socklen_t saddr_len;
+    int listen_fd, send_fd, recv_fd;
+    uint32_t lo, hi;
+    int copied;
+    ucs_status_t status;
+    size_t sent_length;
+
+    memset(&saddr, 0, sizeof(saddr));
+    saddr.sin_family      = AF_INET;
+    saddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    saddr_len             = sizeof(saddr);
+
+    status = ucs_socket_server_init((struct sockaddr*)&saddr, saddr_len,
+                                    1, &listen_fd);
+    ASSERT_UCS_OK(status);
+    ASSERT_EQ(0, getsockname(listen_fd, (struct sockaddr*)&saddr, &saddr_len));
+
+    status = ucs_socket_create(AF_INET, SOCK_STREAM, &send_fd);
+    ASSERT_UCS_OK(status);
+
+    status = ucs_socket_zcopy_enable(send_fd);
+    if (status == UCS_ERR_UNSUPPORTED) {
+        close(send_fd);
+        close(listen_fd);
+        UCS_TEST_SKIP_R("MSG_ZEROCOPY is not supported");
+    }
+    ASSERT_UCS_OK(status);
+
+    status = ucs_socket_connect(send_fd, (struct sockaddr*)&saddr);
+    ASSERT_UCS_OK(status);
+
+    recv_fd = accept(listen_fd, NULL, NULL);
+    ASSERT_GE(recv_fd, 0);
+
+    std::vector<char> send_buf(length), recv_buf(length);
+    ucs::fill_random(send_buf);
+
+    struct iovec iov[2];
+    iov[0].iov_base = &send_buf[0];
+    iov[0].iov_len  = length / 2;
+    iov[1].iov_base = &send_buf[length / 2];
+    iov[1].iov_len  = length / 2;
+
+    /* no notifications before the first send */
+    EXPECT_EQ(UCS_ERR_NO_PROGRESS,
+              ucs_socket_zcopy_notif_nb(send_fd, &lo, &hi, &copied));
+
+    status = ucs_socket_sendv_zcopy_nb(send_fd, iov, 2, &sent_length,
+                                       NULL, NULL);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(length, sent_length);
+
+    status = ucs_socket_recv(recv_fd, &recv_buf[0], length, NULL, NULL);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(send_buf, recv_buf);
+
+    /* the only send has ID 0 */
+    ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+    do {
+        status = ucs_socket_zcopy_notif_nb(send_fd, &lo, &hi, &copied);
+    } while ((status == UCS_ERR_NO_PROGRESS) && (ucs_get_time() < deadline));
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(0u, lo);
+    EXPECT_EQ(0u, hi);
+
+    close(recv_fd);
+    close(send_fd);
+    close(listen_fd);
+}
+
 static void sockaddr_cmp_test(int sa_family, const char *ip_addr1,
                               const char *ip_addr2, unsigned port1,
                               unsigned port2, struct sockaddr *sa1,
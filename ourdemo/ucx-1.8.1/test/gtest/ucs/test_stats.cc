@@ -7,6 +7,7 @@
 #include <common/test.h>
 extern "C" {
 #include <ucs/stats/stats.h>
+#include <ucs/sys/string.h>
 }
 
 #include <sys/socket.h>
@@ -253,6 +254,79 @@ public:
     }
 };
 
+class stats_shm_test : public stats_test {
+public:
+    virtual void cleanup() {
+        std::string filename = get_filename();
+        stats_test::cleanup();
+        /* the file should be removed when statistics are cleaned up */
+        EXPECT_NE(0, access(filename.c_str(), F_OK)) << filename;
+    }
+
+    virtual std::string stats_dest_config() {
+        return "shm";
+    }
+
+    virtual std::string stats_trigger_config() {
+        return "";
+    }
+
+    std::string get_filename() {
+        char filename[PATH_MAX];
+        ucs_snprintf_zero(filename, sizeof(filename), UCS_STATS_SHM_FILE_FMT,
+                          UCS_STATS_SHM_DEFAULT_DIR, getpid());
+        return filename;
+    }
+
+    /* returns the number of data nodes in a snapshot of the shared memory */
+    unsigned read_and_check_stats(uint64_t counter0) {
+        ucs_stats_shm_header_t *hdr;
+        ucs_status_t status = ucs_stats_shm_snapshot(get_filename().c_str(),
+                                                     &hdr);
+        EXPECT_UCS_OK(status);
+        if (status != UCS_OK) {
+            return 0;
+        }
+
+        EXPECT_EQ(getpid(), hdr->pid);
+
+        ucs_stats_shm_record_t *record;
+        uint32_t cat_offset = 0;
+        unsigned num_data   = 0;
+        ucs_stats_shm_for_each_record(record, hdr) {
+            if (record->type != UCS_STATS_SHM_RECORD_NODE) {
+                continue;
+            }
+
+            ucs_stats_shm_node_t *shm_node = (ucs_stats_shm_node_t*)record;
+            ucs_stats_shm_class_t *cls     =
+                (ucs_stats_shm_class_t*)UCS_PTR_BYTE_OFFSET(hdr, shm_node->cls);
+            EXPECT_EQ(UCS_STATS_SHM_RECORD_CLASS, cls->super.type);
+
+            if (std::string("category") == cls->name) {
+                EXPECT_EQ(0u, shm_node->parent);
+                EXPECT_EQ(0u, cls->num_counters);
+                cat_offset = UCS_PTR_BYTE_DIFF(hdr, shm_node);
+                continue;
+            }
+
+            EXPECT_EQ(std::string("data"), std::string(cls->name));
+            EXPECT_EQ(unsigned(NUM_COUNTERS), cls->num_counters);
+            EXPECT_EQ(std::string("counter3"),
+                      std::string(cls->counter_names[3]));
+            EXPECT_EQ(cat_offset, shm_node->parent);
+            EXPECT_EQ(counter0, shm_node->node.counters[0]);
+            EXPECT_EQ(20u,      shm_node->node.counters[1]);
+            EXPECT_EQ(30u,      shm_node->node.counters[2]);
+            EXPECT_EQ(40u,      shm_node->node.counters[3]);
+            ++num_data;
+        }
+
+        free(hdr);
+        return num_data;
+    }
+};
+
 UCS_TEST_F(stats_on_demand_test, null_root) {
     ucs_stats_node_t       *cat_node;
 
@@ -335,4 +409,33 @@ UCS_MT_TEST_F(stats_file_test, mt_add_remove, 10) {
     }
 }
 
+
+UCS_TEST_F(stats_shm_test, report) {
+    ucs_stats_node_t       *cat_node;
+    ucs_stats_node_t       *data_nodes[NUM_DATA_NODES] = {NULL};
+
+    prepare_nodes(&cat_node, data_nodes);
+    EXPECT_EQ(unsigned(NUM_DATA_NODES), read_and_check_stats(10));
+
+    /* counters are updated in place */
+    for (unsigned i = 0; i < NUM_DATA_NODES; ++i) {
+        UCS_STATS_UPDATE_COUNTER(data_nodes[i], 0, 5);
+    }
+    EXPECT_EQ(unsigned(NUM_DATA_NODES), read_and_check_stats(15));
+
+    free_nodes(cat_node, data_nodes);
+    EXPECT_EQ(0u, read_and_check_stats(15));
+}
+
+UCS_MT_TEST_F(stats_shm_test, mt_add_remove, 10) {
+    ucs_stats_node_t       *cat_node;
+    ucs_stats_node_t       *data_nodes[NUM_DATA_NODES] = {NULL};
+    unsigned i;
+
+    for (i = 0; i < 100; i++) {
+        prepare_nodes(&cat_node, data_nodes);
+        free_nodes(cat_node, data_nodes);
+    }
+}
+
 #endif
@@ -9,6 +9,7 @@
 extern "C" {
 #include <uct/api/uct.h>
 #include <uct/tcp/tcp.h>
+#include <ucs/sys/event_set.h>
 }
 
 class test_uct_tcp : public uct_test {
@@ -256,3 +257,49 @@ UCS_TEST_P(test_uct_tcp, listener_flood_connect_and_close) {
 }
 
 _UCT_INSTANTIATE_TEST_CASE(test_uct_tcp, tcp)
+
+
+/* A tiny ring makes the SQ fill up while the listener floods connections, so
+ * arming falls back to submitting in get_sqe and to deferred arming */
+class test_uct_tcp_io_uring : public test_uct_tcp {
+public:
+    void init() {
+        ucs_sys_event_set_t *event_set;
+        ucs_status_t status;
+
+        status = ucs_event_set_create_uring(&event_set, 4, 0);
+        if (status == UCS_ERR_UNSUPPORTED) {
+            UCS_TEST_SKIP_R("io_uring is not supported");
+        }
+        ASSERT_UCS_OK(status);
+        ucs_event_set_cleanup(event_set);
+
+        modify_config("IO_URING", "y");
+        modify_config("IO_URING_ENTRIES", "4");
+        test_uct_tcp::init();
+    }
+};
+
+UCS_TEST_P(test_uct_tcp_io_uring, listener_flood_connect_and_send_large) {
+    const size_t max_conn =
+        ucs_min(static_cast<size_t>(max_connections()), 128lu) /
+        ucs::test_time_multiplier();
+    const size_t msg_size = m_tcp_iface->config.rx_seg_size * 4;
+    test_listener_flood(*m_ent, max_conn, msg_size);
+}
+
+UCS_TEST_P(test_uct_tcp_io_uring, listener_flood_connect_and_send_small) {
+    const size_t max_conn =
+        ucs_min(static_cast<size_t>(max_connections()), 128lu) /
+        ucs::test_time_multiplier();
+    test_listener_flood(*m_ent, max_conn, 1);
+}
+
+UCS_TEST_P(test_uct_tcp_io_uring, listener_flood_connect_and_close) {
+    const size_t max_conn =
+        ucs_min(static_cast<size_t>(max_connections()), 128lu) /
+        ucs::test_time_multiplier();
+    test_listener_flood(*m_ent, max_conn, 0);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_tcp_io_uring, tcp)
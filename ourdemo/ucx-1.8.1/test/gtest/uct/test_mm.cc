@@ -7,12 +7,15 @@
 extern "C" {
 #include <uct/api/uct.h>
 #include <uct/sm/mm/base/mm_md.h>
+#include <uct/sm/mm/base/mm_ep.h>
 #include <ucs/time/time.h>
 }
 #include "uct_p2p_test.h"
 #include <common/test.h>
 #include "uct_test.h"
 
+#include <sys/wait.h>
+
 
 class test_uct_mm : public uct_test {
 public:
@@ -258,3 +261,228 @@ UCS_TEST_SKIP_COND_P(test_uct_mm, reg,
 _UCT_INSTANTIATE_TEST_CASE(test_uct_mm, posix)
 _UCT_INSTANTIATE_TEST_CASE(test_uct_mm, sysv)
 _UCT_INSTANTIATE_TEST_CASE(test_uct_mm, xpmem)
+
+
+class test_uct_mm_lanes : public test_uct_mm {
+public:
+    enum {
+        NUM_LANES   = 2,
+        NUM_SENDERS = NUM_LANES + 1 /* the last sender uses the shared FIFO */
+    };
+
+    test_uct_mm_lanes() {
+        set_config("FIFO_LANES=" + ucs::to_string(NUM_LANES));
+        set_config("FIFO_LANE_SIZE=4");
+    }
+
+    virtual void init() {
+        uct_test::init();
+
+        m_receiver = uct_test::create_entity(0);
+        m_entities.push_back(m_receiver);
+
+        check_skip_test();
+
+        for (unsigned i = 0; i < NUM_SENDERS; ++i) {
+            m_senders.push_back(uct_test::create_entity(0));
+            m_entities.push_back(m_senders.back());
+            m_senders.back()->connect(0, *m_receiver, 0);
+        }
+
+        m_recv_count = 0;
+        m_recv_seq.assign(NUM_SENDERS, 0);
+        uct_iface_set_am_handler(m_receiver->iface(), 0, am_handler, this, 0);
+    }
+
+    virtual void cleanup() {
+        uct_iface_set_am_handler(m_receiver->iface(), 0, NULL, NULL, 0);
+        uct_test::cleanup();
+    }
+
+    static ucs_status_t am_handler(void *arg, void *data, size_t length,
+                                   unsigned flags) {
+        test_uct_mm_lanes *self = reinterpret_cast<test_uct_mm_lanes*>(arg);
+        uint64_t hdr            = *(uint64_t*)data;
+        unsigned sender         = hdr >> 32;
+        unsigned seq            = hdr & UCS_MASK(32);
+
+        /* every sender's messages are received in order */
+        EXPECT_LT(sender, (unsigned)NUM_SENDERS);
+        if (sender < NUM_SENDERS) {
+            EXPECT_EQ(self->m_recv_seq[sender], seq) << "sender " << sender;
+            self->m_recv_seq[sender] = seq + 1;
+        }
+
+        ++self->m_recv_count;
+        return UCS_OK;
+    }
+
+    static size_t pack_cb(void *dest, void *arg) {
+        *(uint64_t*)dest = *(uint64_t*)arg;
+        return sizeof(uint64_t);
+    }
+
+    void send(unsigned sender, unsigned seq) {
+        uint64_t hdr = ((uint64_t)sender << 32) | seq;
+        ucs_status_t status;
+        ssize_t packed_len;
+
+        for (;;) {
+            if (seq % 2) {
+                packed_len = uct_ep_am_bcopy(m_senders[sender]->ep(0), 0,
+                                             pack_cb, &hdr, 0);
+                status     = (packed_len >= 0) ? UCS_OK :
+                             (ucs_status_t)packed_len;
+            } else {
+                status = uct_ep_am_short(m_senders[sender]->ep(0), 0, hdr,
+                                         NULL, 0);
+            }
+
+            if (status != UCS_ERR_NO_RESOURCE) {
+                break;
+            }
+
+            progress();
+        }
+
+        ASSERT_UCS_OK(status);
+    }
+
+    void send_recv(unsigned num_msgs, unsigned first_seq) {
+        unsigned exp_count = m_recv_count + (num_msgs * NUM_SENDERS);
+
+        for (unsigned seq = first_seq; seq < first_seq + num_msgs; ++seq) {
+            for (unsigned sender = 0; sender < NUM_SENDERS; ++sender) {
+                send(sender, seq);
+            }
+        }
+
+        wait_for_value(&m_recv_count, exp_count, true);
+        EXPECT_EQ(exp_count, m_recv_count);
+    }
+
+    uct_mm_ep_t *sender_ep(unsigned sender) {
+        return ucs_derived_of(m_senders[sender]->ep(0), uct_mm_ep_t);
+    }
+
+    uct_mm_iface_t *receiver_iface() {
+        return ucs_derived_of(m_receiver->iface(), uct_mm_iface_t);
+    }
+
+    static uint64_t lane_owner(pid_t pid) {
+        return UCT_MM_LANE_OWNER(ucs_sys_get_ns(UCS_SYS_NS_TYPE_PID), pid);
+    }
+
+    /* sender i owns lane i, and the last sender has no lane */
+    void check_lanes() {
+        for (unsigned sender = 0; sender < NUM_SENDERS; ++sender) {
+            if (sender < NUM_LANES) {
+                EXPECT_EQ(receiver_iface()->rx_lanes[sender].ctl,
+                          sender_ep(sender)->lane.ctl) << "sender " << sender;
+                EXPECT_EQ(lane_owner(getpid()),
+                          (uint64_t)receiver_iface()->rx_lanes[sender].ctl->owner);
+            } else {
+                EXPECT_TRUE(sender_ep(sender)->lane.ctl == NULL);
+            }
+        }
+
+        EXPECT_EQ((uint32_t)NUM_LANES,
+                  (uint32_t)receiver_iface()->recv_fifo_ctl->num_lanes_used);
+    }
+
+    /* every sender posted 'count' messages to its lane or the shared FIFO */
+    void check_recv_counts(uint64_t count) {
+        for (unsigned lane = 0; lane < NUM_LANES; ++lane) {
+            EXPECT_EQ(count, receiver_iface()->rx_lanes[lane].read_index)
+                      << "lane " << lane;
+        }
+
+        EXPECT_EQ(count, receiver_iface()->read_index);
+    }
+
+protected:
+    entity                 *m_receiver;
+    std::vector<entity*>   m_senders;
+    volatile unsigned      m_recv_count;
+    std::vector<unsigned>  m_recv_seq;
+};
+
+UCS_TEST_SKIP_COND_P(test_uct_mm_lanes, many_to_one,
+                     !check_caps(UCT_IFACE_FLAG_AM_SHORT |
+                                 UCT_IFACE_FLAG_AM_BCOPY))
+{
+    const unsigned num_msgs = 100;
+
+    check_lanes();
+    send_recv(num_msgs, 0);
+    check_recv_counts(num_msgs);
+
+    /* a new endpoint takes over the released lane where its previous owner
+     * has stopped */
+    m_senders[0]->destroy_ep(0);
+    EXPECT_EQ(0ul, (uint64_t)receiver_iface()->rx_lanes[0].ctl->owner);
+    m_senders[0]->connect(0, *m_receiver, 0);
+    check_lanes();
+    send_recv(num_msgs, num_msgs);
+    check_recv_counts(2 * num_msgs);
+}
+
+UCS_TEST_SKIP_COND_P(test_uct_mm_lanes, dead_owner,
+                     !check_caps(UCT_IFACE_FLAG_AM_SHORT |
+                                 UCT_IFACE_FLAG_AM_BCOPY))
+{
+    const unsigned num_msgs = 100;
+    uct_mm_lane_ctl_t *lane_ctl;
+    pid_t pid;
+
+    send_recv(num_msgs, 0);
+
+    /* make lane 0 look like its owner died without releasing it, so the head
+     * saved in the lane is stale */
+    m_senders[0]->destroy_ep(0);
+    pid = fork();
+    if (pid == 0) {
+        _exit(0);
+    }
+    ASSERT_EQ(pid, waitpid(pid, NULL, 0));
+
+    lane_ctl        = receiver_iface()->rx_lanes[0].ctl;
+    lane_ctl->head  = 0;
+    lane_ctl->owner = lane_owner(pid);
+
+    /* a new endpoint takes the lane over and finds where the messages of the
+     * dead owner end */
+    m_senders[0]->connect(0, *m_receiver, 0);
+    check_lanes();
+    send_recv(num_msgs, num_msgs);
+    check_recv_counts(2 * num_msgs);
+}
+
+UCS_TEST_SKIP_COND_P(test_uct_mm_lanes, other_ns_owner,
+                     !check_caps(UCT_IFACE_FLAG_AM_SHORT |
+                                 UCT_IFACE_FLAG_AM_BCOPY))
+{
+    const uint64_t other_ns = UCT_MM_LANE_OWNER_NS(lane_owner(0)) + 1;
+    uct_mm_lane_ctl_t *lane_ctl;
+    pid_t pid;
+
+    /* a pid which does not exist here may belong to a live process of another
+     * pid namespace, so its lane must not be taken over */
+    m_senders[0]->destroy_ep(0);
+    pid = fork();
+    if (pid == 0) {
+        _exit(0);
+    }
+    ASSERT_EQ(pid, waitpid(pid, NULL, 0));
+
+    lane_ctl        = receiver_iface()->rx_lanes[0].ctl;
+    lane_ctl->owner = UCT_MM_LANE_OWNER(other_ns, pid);
+
+    m_senders[0]->connect(0, *m_receiver, 0);
+    EXPECT_TRUE(sender_ep(0)->lane.ctl == NULL);
+    EXPECT_EQ(UCT_MM_LANE_OWNER(other_ns, pid), (uint64_t)lane_ctl->owner);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_mm_lanes, posix)
+_UCT_INSTANTIATE_TEST_CASE(test_uct_mm_lanes, sysv)
+_UCT_INSTANTIATE_TEST_CASE(test_uct_mm_lanes, xpmem)
@@ -134,3 +134,26 @@ UCS_TEST_SKIP_COND_P(uct_p2p_rma_test, get_zcopy,
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test)
+
+class uct_p2p_rma_test_copy_mt : public uct_p2p_rma_test {};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_test_copy_mt, put_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_PUT_ZCOPY),
+                     "COPY_MT_THREADS=2", "COPY_MT_THRESH=64k",
+                     "COPY_MT_CHUNK=16k") {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_test_copy_mt, get_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_GET_ZCOPY),
+                     "COPY_MT_THREADS=2", "COPY_MT_THRESH=64k",
+                     "COPY_MT_CHUNK=16k") {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::get_zcopy),
+                    ucs_max(1ull, sender().iface_attr().cap.get.min_zcopy),
+                    sender().iface_attr().cap.get.max_zcopy,
+                    TEST_UCT_FLAG_RECV_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test_copy_mt, cma)